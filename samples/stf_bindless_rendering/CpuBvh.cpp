@@ -0,0 +1,451 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "CpuBvh.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace donut::math;
+
+namespace
+{
+    constexpr uint32_t c_BinCount = 16;
+    constexpr uint32_t c_MaxLeafSize = 8;
+    // Traversal pushes at most one node per level, this bounds the stack
+    constexpr uint32_t c_MaxDepth = 64;
+    constexpr uint32_t c_MinSubtreeSize = 4096;
+
+    struct Bounds
+    {
+        float3 min = float3(FLT_MAX);
+        float3 max = float3(-FLT_MAX);
+
+        void Grow(float3 p)
+        {
+            min = donut::math::min(min, p);
+            max = donut::math::max(max, p);
+        }
+
+        void Grow(const Bounds& other)
+        {
+            min = donut::math::min(min, other.min);
+            max = donut::math::max(max, other.max);
+        }
+
+        [[nodiscard]] float HalfArea() const
+        {
+            if (min.x > max.x)
+                return 0.f;
+            const float3 d = max - min;
+            return d.x * d.y + d.y * d.z + d.z * d.x;
+        }
+    };
+
+    struct BuildPrimitive
+    {
+        Bounds bounds;
+        float3 centroid;
+        uint32_t index = 0;
+    };
+
+    struct Subtree
+    {
+        uint32_t node = 0;
+        uint32_t first = 0;
+        uint32_t count = 0;
+        uint32_t depth = 0;
+    };
+
+    int GetBin(float centroid, float origin, float scale)
+    {
+        return std::min(int((centroid - origin) * scale), int(c_BinCount) - 1);
+    }
+
+    // Best binned SAH split of the primitives, false when keeping them in one leaf is cheaper
+    bool FindSahSplit(const BuildPrimitive* primitives, uint32_t count, const Bounds& bounds, const Bounds& centroidBounds,
+        int& bestAxis, int& bestBin)
+    {
+        float bestCost = FLT_MAX;
+        bestAxis = -1;
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+            if (extent <= 0.f)
+                continue;
+
+            const float origin = centroidBounds.min[axis];
+            const float scale = float(c_BinCount) / extent;
+
+            Bounds binBounds[c_BinCount];
+            uint32_t binCounts[c_BinCount] = {};
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const int bin = GetBin(primitives[i].centroid[axis], origin, scale);
+                binBounds[bin].Grow(primitives[i].bounds);
+                binCounts[bin]++;
+            }
+
+            // Cost of the primitives left of each plane, then sweep the right side back
+            float leftCosts[c_BinCount - 1];
+            Bounds left;
+            uint32_t leftCount = 0;
+            for (uint32_t plane = 0; plane < c_BinCount - 1; plane++)
+            {
+                left.Grow(binBounds[plane]);
+                leftCount += binCounts[plane];
+                leftCosts[plane] = leftCount > 0 && leftCount < count ? left.HalfArea() * float(leftCount) : FLT_MAX;
+            }
+
+            Bounds right;
+            uint32_t rightCount = 0;
+            for (uint32_t plane = c_BinCount - 1; plane > 0; plane--)
+            {
+                right.Grow(binBounds[plane]);
+                rightCount += binCounts[plane];
+                if (leftCosts[plane - 1] == FLT_MAX || rightCount == 0)
+                    continue;
+
+                const float cost = leftCosts[plane - 1] + right.HalfArea() * float(rightCount);
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = int(plane);
+                }
+            }
+        }
+
+        if (bestAxis < 0)
+            return false;
+
+        // One traversal step costs about as much as one triangle test
+        const float leafCost = bounds.HalfArea() * float(count);
+        return count > c_MaxLeafSize || bestCost + bounds.HalfArea() < leafCost;
+    }
+
+    // Builds the subtree of nodes[nodeIndex] over primitives [first, first + count). With 'subtrees' set, ranges of
+    // subtreeSize primitives or less are not split but returned, for the caller to build them in parallel.
+    void Subdivide(std::vector<CpuBvh::Node>& nodes, uint32_t nodeIndex, BuildPrimitive* primitives,
+        uint32_t first, uint32_t count, uint32_t depth, uint32_t subtreeSize, std::vector<Subtree>* subtrees)
+    {
+        Bounds bounds;
+        Bounds centroidBounds;
+        for (uint32_t i = first; i < first + count; i++)
+        {
+            bounds.Grow(primitives[i].bounds);
+            centroidBounds.Grow(primitives[i].centroid);
+        }
+
+        nodes[nodeIndex].boundsMin = bounds.min;
+        nodes[nodeIndex].boundsMax = bounds.max;
+
+        if (subtrees && count <= subtreeSize)
+        {
+            subtrees->push_back({ nodeIndex, first, count, depth });
+            return;
+        }
+
+        int axis = 0;
+        int splitBin = 0;
+        if (count <= 1 || depth >= c_MaxDepth || !FindSahSplit(primitives + first, count, bounds, centroidBounds, axis, splitBin))
+        {
+            nodes[nodeIndex].firstChildOrTriangle = first;
+            nodes[nodeIndex].count = count;
+            return;
+        }
+
+        const float origin = centroidBounds.min[axis];
+        const float scale = float(c_BinCount) / (centroidBounds.max[axis] - centroidBounds.min[axis]);
+        BuildPrimitive* middle = std::partition(primitives + first, primitives + first + count, [&](const BuildPrimitive& primitive)
+        {
+            return GetBin(primitive.centroid[axis], origin, scale) < splitBin;
+        });
+        const uint32_t leftCount = uint32_t(middle - (primitives + first));
+
+        const uint32_t leftChild = uint32_t(nodes.size());
+        nodes.resize(nodes.size() + 2);
+        nodes[nodeIndex].firstChildOrTriangle = leftChild;
+        nodes[nodeIndex].count = 0;
+
+        Subdivide(nodes, leftChild, primitives, first, leftCount, depth + 1, subtreeSize, subtrees);
+        Subdivide(nodes, leftChild + 1, primitives, first + leftCount, count - leftCount, depth + 1, subtreeSize, subtrees);
+    }
+}
+
+void CpuBvh::Build(ThreadPool& pool, const std::vector<CpuBvhTriangle>& triangles)
+{
+    m_Nodes.clear();
+    m_Triangles.clear();
+
+    if (triangles.empty())
+        return;
+
+    std::vector<BuildPrimitive> primitives(triangles.size());
+    pool.ParallelFor(uint32_t(triangles.size()), [&](uint32_t i)
+    {
+        BuildPrimitive& primitive = primitives[i];
+        primitive.bounds.Grow(triangles[i].v0);
+        primitive.bounds.Grow(triangles[i].v1);
+        primitive.bounds.Grow(triangles[i].v2);
+        primitive.centroid = (primitive.bounds.min + primitive.bounds.max) * 0.5f;
+        primitive.index = i;
+    });
+
+    // Enough subtrees to balance the threads, but not so small that the serial top part dominates
+    const uint32_t threadCount = std::max(pool.GetThreadCount(), 1u) + 1;
+    const uint32_t subtreeSize = std::max(uint32_t(triangles.size()) / (threadCount * 4), c_MinSubtreeSize);
+
+    std::vector<Subtree> subtrees;
+    m_Nodes.resize(1);
+    Subdivide(m_Nodes, 0, primitives.data(), 0, uint32_t(primitives.size()), 0, subtreeSize, &subtrees);
+
+    std::vector<std::vector<Node>> subtreeNodes(subtrees.size());
+    pool.ParallelFor(uint32_t(subtrees.size()), [&](uint32_t i)
+    {
+        const Subtree& subtree = subtrees[i];
+        subtreeNodes[i].resize(1);
+        Subdivide(subtreeNodes[i], 0, primitives.data(), subtree.first, subtree.count, subtree.depth, 0, nullptr);
+    });
+
+    // Each subtree root replaces its placeholder, the other nodes are appended with their child indices rebased
+    for (size_t i = 0; i < subtrees.size(); i++)
+    {
+        const uint32_t base = uint32_t(m_Nodes.size()) - 1;
+        for (Node& node : subtreeNodes[i])
+        {
+            if (node.count == 0)
+                node.firstChildOrTriangle += base;
+        }
+
+        m_Nodes[subtrees[i].node] = subtreeNodes[i][0];
+        m_Nodes.insert(m_Nodes.end(), subtreeNodes[i].begin() + 1, subtreeNodes[i].end());
+    }
+
+    m_Triangles.resize(primitives.size());
+    pool.ParallelFor(uint32_t(primitives.size()), [&](uint32_t i)
+    {
+        const CpuBvhTriangle& source = triangles[primitives[i].index];
+        Triangle& triangle = m_Triangles[i];
+        triangle.v0 = source.v0;
+        triangle.edge1 = source.v1 - source.v0;
+        triangle.edge2 = source.v2 - source.v0;
+        triangle.index = primitives[i].index;
+        triangle.opaque = source.opaque;
+    });
+}
+
+void CpuBvh::SetupPacket(const CpuRay* rays, uint32_t rayCount, Packet& packet) const
+{
+    // Avoids 0 * inf in the slab test for axis-parallel rays
+    auto safeInverse = [](float d)
+    {
+        return 1.f / (std::abs(d) > 1e-20f ? d : std::copysign(1e-20f, d));
+    };
+
+    for (uint32_t lane = 0; lane < PacketWidth; lane++)
+    {
+        // Unused lanes repeat the first ray, their results are masked
+        const CpuRay& ray = rays[lane < rayCount ? lane : 0];
+        packet.originX[lane] = ray.origin.x;
+        packet.originY[lane] = ray.origin.y;
+        packet.originZ[lane] = ray.origin.z;
+        packet.directionX[lane] = ray.direction.x;
+        packet.directionY[lane] = ray.direction.y;
+        packet.directionZ[lane] = ray.direction.z;
+        packet.invDirX[lane] = safeInverse(ray.direction.x);
+        packet.invDirY[lane] = safeInverse(ray.direction.y);
+        packet.invDirZ[lane] = safeInverse(ray.direction.z);
+        packet.tMin[lane] = ray.tMin;
+        packet.tMax[lane] = ray.tMax;
+    }
+}
+
+uint32_t CpuBvh::IntersectNode(const Node& node, const Packet& packet, uint32_t activeMask, float& nearest) const
+{
+    float tNear[PacketWidth];
+    float tFar[PacketWidth];
+
+    for (uint32_t lane = 0; lane < PacketWidth; lane++)
+    {
+        const float x0 = (node.boundsMin.x - packet.originX[lane]) * packet.invDirX[lane];
+        const float x1 = (node.boundsMax.x - packet.originX[lane]) * packet.invDirX[lane];
+        const float y0 = (node.boundsMin.y - packet.originY[lane]) * packet.invDirY[lane];
+        const float y1 = (node.boundsMax.y - packet.originY[lane]) * packet.invDirY[lane];
+        const float z0 = (node.boundsMin.z - packet.originZ[lane]) * packet.invDirZ[lane];
+        const float z1 = (node.boundsMax.z - packet.originZ[lane]) * packet.invDirZ[lane];
+
+        tNear[lane] = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), packet.tMin[lane]));
+        tFar[lane] = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::min(std::max(z0, z1), packet.tMax[lane]));
+    }
+
+    uint32_t mask = 0;
+    nearest = FLT_MAX;
+    for (uint32_t lane = 0; lane < PacketWidth; lane++)
+    {
+        if ((activeMask & (1u << lane)) && tNear[lane] <= tFar[lane])
+        {
+            mask |= 1u << lane;
+            nearest = std::min(nearest, tNear[lane]);
+        }
+    }
+
+    return mask;
+}
+
+template<bool AnyHit>
+uint32_t CpuBvh::IntersectLeaf(const Node& node, Packet& packet, uint32_t activeMask,
+    const AnyHitFunction& anyHit, CpuRayHit* hits) const
+{
+    uint32_t accepted = 0;
+
+    for (uint32_t i = node.firstChildOrTriangle; i < node.firstChildOrTriangle + node.count; i++)
+    {
+        const Triangle& triangle = m_Triangles[i];
+
+        // Moller-Trumbore for all lanes
+        float t[PacketWidth];
+        float u[PacketWidth];
+        float v[PacketWidth];
+        bool inside[PacketWidth];
+
+        for (uint32_t lane = 0; lane < PacketWidth; lane++)
+        {
+            const float3 direction(packet.directionX[lane], packet.directionY[lane], packet.directionZ[lane]);
+            const float3 offset = float3(packet.originX[lane], packet.originY[lane], packet.originZ[lane]) - triangle.v0;
+
+            const float3 p = cross(direction, triangle.edge2);
+            const float determinant = dot(triangle.edge1, p);
+            const float invDeterminant = 1.f / (determinant != 0.f ? determinant : FLT_MIN);
+            const float3 q = cross(offset, triangle.edge1);
+
+            u[lane] = dot(offset, p) * invDeterminant;
+            v[lane] = dot(direction, q) * invDeterminant;
+            t[lane] = dot(triangle.edge2, q) * invDeterminant;
+
+            inside[lane] = determinant != 0.f && u[lane] >= 0.f && v[lane] >= 0.f && u[lane] + v[lane] <= 1.f &&
+                t[lane] >= packet.tMin[lane] && t[lane] < packet.tMax[lane];
+        }
+
+        for (uint32_t lane = 0; lane < PacketWidth; lane++)
+        {
+            if (!(activeMask & (1u << lane)) || !inside[lane])
+                continue;
+
+            const float2 barycentrics(u[lane], v[lane]);
+            if (!triangle.opaque && anyHit && !anyHit(lane, triangle.index, barycentrics))
+                continue;
+
+            packet.tMax[lane] = t[lane];
+            accepted |= 1u << lane;
+
+            if constexpr (!AnyHit)
+            {
+                hits[lane].triangle = triangle.index;
+                hits[lane].t = t[lane];
+                hits[lane].barycentrics = barycentrics;
+            }
+        }
+
+        if constexpr (AnyHit)
+        {
+            activeMask &= ~accepted;
+            if (activeMask == 0)
+                break;
+        }
+    }
+
+    return accepted;
+}
+
+template<bool AnyHit>
+void CpuBvh::Traverse(const CpuRay* rays, uint32_t rayCount, const AnyHitFunction& anyHit, CpuRayHit* hits, bool* occluded) const
+{
+    rayCount = std::min(rayCount, PacketWidth);
+    for (uint32_t lane = 0; lane < rayCount; lane++)
+    {
+        if constexpr (AnyHit)
+            occluded[lane] = false;
+        else
+            hits[lane] = CpuRayHit();
+    }
+
+    if (m_Nodes.empty() || rayCount == 0)
+        return;
+
+    Packet packet;
+    SetupPacket(rays, rayCount, packet);
+
+    uint32_t activeMask = (1u << rayCount) - 1;
+    uint32_t stack[c_MaxDepth + 2];
+    uint32_t stackSize = 0;
+
+    float nearest;
+    if (IntersectNode(m_Nodes[0], packet, activeMask, nearest))
+        stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const Node& node = m_Nodes[stack[--stackSize]];
+
+        if (node.count > 0)
+        {
+            const uint32_t accepted = IntersectLeaf<AnyHit>(node, packet, activeMask, anyHit, hits);
+
+            if constexpr (AnyHit)
+            {
+                for (uint32_t lane = 0; lane < rayCount; lane++)
+                {
+                    if (accepted & (1u << lane))
+                        occluded[lane] = true;
+                }
+
+                activeMask &= ~accepted;
+                if (activeMask == 0)
+                    return;
+            }
+            continue;
+        }
+
+        // Both children are tested here so the nearer one is visited first
+        const uint32_t leftChild = node.firstChildOrTriangle;
+        float nearestLeft;
+        float nearestRight;
+        const bool hitLeft = IntersectNode(m_Nodes[leftChild], packet, activeMask, nearestLeft) != 0;
+        const bool hitRight = IntersectNode(m_Nodes[leftChild + 1], packet, activeMask, nearestRight) != 0;
+
+        if (hitLeft && hitRight)
+        {
+            const bool leftFirst = nearestLeft <= nearestRight;
+            stack[stackSize++] = leftFirst ? leftChild + 1 : leftChild;
+            stack[stackSize++] = leftFirst ? leftChild : leftChild + 1;
+        }
+        else if (hitLeft)
+        {
+            stack[stackSize++] = leftChild;
+        }
+        else if (hitRight)
+        {
+            stack[stackSize++] = leftChild + 1;
+        }
+    }
+}
+
+void CpuBvh::TraceClosest(const CpuRay* rays, uint32_t rayCount, const AnyHitFunction& anyHit, CpuRayHit* hits) const
+{
+    Traverse<false>(rays, rayCount, anyHit, hits, nullptr);
+}
+
+void CpuBvh::TraceAny(const CpuRay* rays, uint32_t rayCount, const AnyHitFunction& anyHit, bool* occluded) const
+{
+    Traverse<true>(rays, rayCount, anyHit, nullptr, occluded);
+}
@@ -0,0 +1,117 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "TaskGraph.h"
+
+#include <donut/core/math/math.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct CpuBvhTriangle
+{
+    dm::float3 v0;
+    dm::float3 v1;
+    dm::float3 v2;
+    // Non-opaque triangles go through the any-hit function, like geometries built without GeometryFlags::Opaque
+    bool opaque = true;
+};
+
+struct CpuRay
+{
+    dm::float3 origin;
+    dm::float3 direction;
+    float tMin = 0.f;
+    float tMax = 1000.f;
+};
+
+struct CpuRayHit
+{
+    uint32_t triangle = ~0u;        // index into the triangles given to Build, ~0u on a miss
+    float t = 0.f;
+    dm::float2 barycentrics = 0.f;  // weights of v1 and v2, like the DXR triangle barycentrics
+};
+
+// Bounding volume hierarchy over world space triangles for CPU ray tracing.
+// Built with a 16-bin SAH; the upper levels are split on the calling thread, the subtrees below them in parallel.
+// Rays are traced in packets of up to 8 with their data in SoA layout, so the per-lane loops vectorize.
+class CpuBvh
+{
+public:
+    static constexpr uint32_t PacketWidth = 8;
+
+    // Inner nodes have count == 0 and their children at firstChildOrTriangle and firstChildOrTriangle + 1.
+    // Leaves reference count triangles in leaf order starting at firstChildOrTriangle. Node 0 is the root.
+    struct Node
+    {
+        dm::float3 boundsMin;
+        uint32_t firstChildOrTriangle = 0;
+        dm::float3 boundsMax;
+        uint32_t count = 0;
+    };
+
+    // Called for candidate hits on non-opaque triangles that are closer than the current hit.
+    // Returns true to accept the hit, like CommitNonOpaqueTriangleHit after the alpha test.
+    using AnyHitFunction = std::function<bool(uint32_t lane, uint32_t triangle, dm::float2 barycentrics)>;
+
+    void Build(ThreadPool& pool, const std::vector<CpuBvhTriangle>& triangles);
+
+    // Closest accepted hit for each of the rayCount <= PacketWidth rays
+    void TraceClosest(const CpuRay* rays, uint32_t rayCount, const AnyHitFunction& anyHit, CpuRayHit* hits) const;
+
+    // Whether each ray has any accepted hit, rays stop at the first one
+    void TraceAny(const CpuRay* rays, uint32_t rayCount, const AnyHitFunction& anyHit, bool* occluded) const;
+
+    [[nodiscard]] const std::vector<Node>& GetNodes() const { return m_Nodes; }
+    [[nodiscard]] uint32_t GetTriangleCount() const { return uint32_t(m_Triangles.size()); }
+
+private:
+    // In leaf order, with the edges precomputed for the intersection test
+    struct Triangle
+    {
+        dm::float3 v0;
+        dm::float3 edge1;
+        dm::float3 edge2;
+        uint32_t index = 0;
+        bool opaque = true;
+    };
+
+    struct alignas(32) Packet
+    {
+        float originX[PacketWidth];
+        float originY[PacketWidth];
+        float originZ[PacketWidth];
+        float directionX[PacketWidth];
+        float directionY[PacketWidth];
+        float directionZ[PacketWidth];
+        float invDirX[PacketWidth];
+        float invDirY[PacketWidth];
+        float invDirZ[PacketWidth];
+        float tMin[PacketWidth];
+        float tMax[PacketWidth];
+    };
+
+    std::vector<Node> m_Nodes;
+    std::vector<Triangle> m_Triangles;
+
+    void SetupPacket(const CpuRay* rays, uint32_t rayCount, Packet& packet) const;
+    uint32_t IntersectNode(const Node& node, const Packet& packet, uint32_t activeMask, float& nearest) const;
+
+    // Returns the mask of lanes that accepted a hit in the leaf, shrinking tMax for them
+    template<bool AnyHit>
+    uint32_t IntersectLeaf(const Node& node, Packet& packet, uint32_t activeMask,
+        const AnyHitFunction& anyHit, CpuRayHit* hits) const;
+
+    template<bool AnyHit>
+    void Traverse(const CpuRay* rays, uint32_t rayCount, const AnyHitFunction& anyHit, CpuRayHit* hits, bool* occluded) const;
+};
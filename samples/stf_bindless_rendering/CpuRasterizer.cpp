@@ -0,0 +1,676 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "CpuRasterizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+
+using namespace donut::math;
+
+#include "lighting_cb.h"
+#include "stf_decorrelation.h"
+#include "gbuffer_texel_id.h"
+
+struct CpuRasterizer::SetupTriangle
+{
+    uint32_t triangle = 0;      // index into the scene triangles
+    bool frontFacing = true;
+    float2 screen[3];           // pixel coordinates, counter-clockwise on screen
+    float invW[3] = {};
+    float2 barycentrics[3];     // barycentrics of the scene triangle at each vertex, they differ from the corners after clipping
+    float invArea = 0.f;
+    int2 boundsMin;             // inclusive pixel bounds, inside the viewport
+    int2 boundsMax;
+};
+
+struct CpuRasterizer::QuadInvocation
+{
+    uint32_t setupTriangle = 0;
+    uint32_t waveKey = 0;       // invocations with different keys never share a wave
+    uint2 position;             // top-left pixel of the quad
+};
+
+namespace
+{
+    constexpr uint32_t c_TileSize = 32;
+    constexpr uint32_t c_SetupChunkSize = 4096;
+    constexpr uint32_t c_MaxWaveLanes = 128;
+    constexpr uint32_t c_MaxClipVertices = 5;
+    static_assert(c_TileSize % 2 == 0, "Tiles hold whole quads");
+
+    struct ClipVertex
+    {
+        float4 position;
+        float2 barycentrics;
+    };
+
+    // Sutherland-Hodgman against the half space dot(plane, position) >= 0
+    uint32_t ClipPolygon(const ClipVertex* input, uint32_t inputCount, float4 plane, ClipVertex* output)
+    {
+        uint32_t outputCount = 0;
+        for (uint32_t i = 0; i < inputCount; i++)
+        {
+            const ClipVertex& a = input[i];
+            const ClipVertex& b = input[(i + 1) % inputCount];
+            const float distanceA = dot(plane, a.position);
+            const float distanceB = dot(plane, b.position);
+
+            if (distanceA >= 0.f)
+                output[outputCount++] = a;
+
+            if ((distanceA >= 0.f) != (distanceB >= 0.f))
+            {
+                const float t = distanceA / (distanceA - distanceB);
+                output[outputCount].position = lerp(a.position, b.position, t);
+                output[outputCount].barycentrics = lerp(a.barycentrics, b.barycentrics, t);
+                outputCount++;
+            }
+        }
+        return outputCount;
+    }
+
+    float EdgeFunction(float2 a, float2 b, float2 p)
+    {
+        return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+    }
+
+    // D3D top-left rule for the winding that gives EdgeFunction(s0, s1, s2) > 0 with y pointing down
+    bool IsTopLeftEdge(float2 a, float2 b)
+    {
+        const float2 edge = b - a;
+        return edge.y < 0.f || (edge.y == 0.f && edge.x > 0.f);
+    }
+
+    // Screen space and perspective correct weights of the setup vertices at a pixel center, extrapolated outside
+    void GetPixelWeights(const float2 screen[3], const float invW[3], float invArea, float2 pixelCenter,
+        float3& edges, float3& perspectiveWeights)
+    {
+        edges = float3(EdgeFunction(screen[1], screen[2], pixelCenter),
+            EdgeFunction(screen[2], screen[0], pixelCenter),
+            EdgeFunction(screen[0], screen[1], pixelCenter));
+
+        const float3 weights = edges * invArea;
+        const float3 weightsOverW = float3(weights.x * invW[0], weights.y * invW[1], weights.z * invW[2]);
+        const float interpolatedInvW = weightsOverW.x + weightsOverW.y + weightsOverW.z;
+        perspectiveWeights = weightsOverW / interpolatedInvW;
+    }
+}
+
+CpuRasterizer::CpuRasterizer(ThreadPool& pool, const CpuScene& scene)
+    : m_Pool(pool)
+    , m_Scene(scene)
+{
+}
+
+void CpuRasterizer::Render(const LightingConstants& constants, bool stfEnabled, const CpuRasterizerOptions& options,
+    std::vector<CpuGBufferTexel>& output, CpuRasterizerStats& stats) const
+{
+    assert(options.waveWidth >= 4 && options.waveWidth <= c_MaxWaveLanes && options.waveWidth % 4 == 0);
+
+    stats = CpuRasterizerStats();
+
+    const PlanarViewConstants& view = constants.view;
+    const uint32_t width = uint32_t(view.viewportSize.x);
+    const uint32_t height = uint32_t(view.viewportSize.y);
+
+    output.assign(size_t(width) * height, CpuGBufferTexel());
+    if (width == 0 || height == 0 || m_Scene.GetTriangles().empty())
+        return;
+
+    // The texel ID targets, 0 is a pixel without a texel ID
+    std::vector<uint2> texelIds;
+    std::vector<uint32_t> tangentFrames;
+    if (options.deferredTexels)
+    {
+        texelIds.assign(size_t(width) * height, uint2(0u));
+        tangentFrames.assign(size_t(width) * height, 0u);
+    }
+
+    const auto rasterStart = std::chrono::high_resolution_clock::now();
+
+    const std::vector<CpuScene::Triangle>& triangles = m_Scene.GetTriangles();
+    const std::vector<CpuScene::Geometry>& geometries = m_Scene.GetGeometries();
+    const std::vector<CpuScene::Material>& materials = m_Scene.GetMaterials();
+    const float3 cameraPosition = view.cameraDirectionOrPosition.xyz();
+
+    // Setup: cull, clip against 0 <= z <= w and project, in chunks that keep the submission order
+    const uint32_t chunkCount = (uint32_t(triangles.size()) + c_SetupChunkSize - 1) / c_SetupChunkSize;
+    std::vector<std::vector<SetupTriangle>> chunks(chunkCount);
+
+    m_Pool.ParallelFor(chunkCount, [&](uint32_t chunk)
+    {
+        const uint32_t first = chunk * c_SetupChunkSize;
+        const uint32_t last = std::min(first + c_SetupChunkSize, uint32_t(triangles.size()));
+
+        for (uint32_t index = first; index < last; index++)
+        {
+            const CpuScene::Triangle& triangle = triangles[index];
+            const CpuScene::Material& material = materials[geometries[triangle.geometry].material];
+
+            const bool frontFacing = dot(triangle.normal, cameraPosition - triangle.positions[0]) > 0.f;
+            if (!frontFacing && !material.doubleSided)
+                continue;
+
+            ClipVertex polygon[c_MaxClipVertices];
+            ClipVertex clipped[c_MaxClipVertices];
+            const float2 corners[3] = { float2(0.f, 0.f), float2(1.f, 0.f), float2(0.f, 1.f) };
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                polygon[i].position = float4(triangle.positions[i], 1.f) * view.matWorldToClip;
+                polygon[i].barycentrics = corners[i];
+            }
+
+            uint32_t count = ClipPolygon(polygon, 3, float4(0.f, 0.f, 1.f, 0.f), clipped);
+            count = ClipPolygon(clipped, count, float4(0.f, 0.f, -1.f, 1.f), polygon);
+            if (count < 3)
+                continue;
+
+            // Fan of the clipped polygon
+            for (uint32_t i = 1; i + 1 < count; i++)
+            {
+                const ClipVertex* vertices[3] = { &polygon[0], &polygon[i], &polygon[i + 1] };
+
+                SetupTriangle setup;
+                setup.triangle = index;
+                setup.frontFacing = frontFacing;
+
+                float2 boundsMin = float2(FLT_MAX);
+                float2 boundsMax = float2(-FLT_MAX);
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    const float4 position = vertices[k]->position;
+                    setup.invW[k] = 1.f / position.w;
+                    setup.screen[k] = float2((position.x * setup.invW[k] * 0.5f + 0.5f) * float(width),
+                        (0.5f - position.y * setup.invW[k] * 0.5f) * float(height));
+                    setup.barycentrics[k] = vertices[k]->barycentrics;
+                    boundsMin = min(boundsMin, setup.screen[k]);
+                    boundsMax = max(boundsMax, setup.screen[k]);
+                }
+
+                float area = EdgeFunction(setup.screen[0], setup.screen[1], setup.screen[2]);
+                if (area == 0.f || !std::isfinite(area))
+                    continue;
+
+                if (area < 0.f)
+                {
+                    std::swap(setup.screen[1], setup.screen[2]);
+                    std::swap(setup.invW[1], setup.invW[2]);
+                    std::swap(setup.barycentrics[1], setup.barycentrics[2]);
+                    area = -area;
+                }
+                setup.invArea = 1.f / area;
+
+                // Pixels whose centers can be inside
+                setup.boundsMin = int2(int(std::max(std::ceil(boundsMin.x - 0.5f), 0.f)), int(std::max(std::ceil(boundsMin.y - 0.5f), 0.f)));
+                setup.boundsMax = int2(int(std::min(std::floor(boundsMax.x - 0.5f), float(width - 1))),
+                    int(std::min(std::floor(boundsMax.y - 0.5f), float(height - 1))));
+                if (setup.boundsMin.x > setup.boundsMax.x || setup.boundsMin.y > setup.boundsMax.y)
+                    continue;
+
+                chunks[chunk].push_back(setup);
+            }
+        }
+    });
+
+    std::vector<SetupTriangle> setupTriangles;
+    for (std::vector<SetupTriangle>& chunk : chunks)
+        setupTriangles.insert(setupTriangles.end(), chunk.begin(), chunk.end());
+
+    // Binning: every tile row scans the setup triangles, so the bins stay in submission order
+    const uint32_t tilesX = (width + c_TileSize - 1) / c_TileSize;
+    const uint32_t tilesY = (height + c_TileSize - 1) / c_TileSize;
+    std::vector<std::vector<uint32_t>> bins(tilesX * tilesY);
+
+    m_Pool.ParallelFor(tilesY, [&](uint32_t tileY)
+    {
+        const int rowMin = int(tileY * c_TileSize);
+        const int rowMax = int(std::min((tileY + 1) * c_TileSize, height)) - 1;
+
+        for (uint32_t index = 0; index < uint32_t(setupTriangles.size()); index++)
+        {
+            const SetupTriangle& setup = setupTriangles[index];
+            if (setup.boundsMax.y < rowMin || setup.boundsMin.y > rowMax)
+                continue;
+
+            for (uint32_t tileX = uint32_t(setup.boundsMin.x) / c_TileSize; tileX <= uint32_t(setup.boundsMax.x) / c_TileSize; tileX++)
+                bins[tileY * tilesX + tileX].push_back(index);
+        }
+    });
+
+    // Visibility: nearest covered triangle per pixel center that passes the alpha test
+    std::vector<uint32_t> visibleTriangles(size_t(width) * height, ~0u);
+    std::vector<float> depth(size_t(width) * height, 0.f); // 1/w, larger is closer
+
+    m_Pool.ParallelFor(tilesX * tilesY, [&](uint32_t tile)
+    {
+        const int2 tileMin = int2(int((tile % tilesX) * c_TileSize), int((tile / tilesX) * c_TileSize));
+        const int2 tileMax = int2(std::min(tileMin.x + int(c_TileSize), int(width)) - 1, std::min(tileMin.y + int(c_TileSize), int(height)) - 1);
+
+        for (uint32_t index : bins[tile])
+        {
+            const SetupTriangle& setup = setupTriangles[index];
+            const bool alphaTested = materials[geometries[triangles[setup.triangle].geometry].material].alphaTested;
+            const bool topLeft[3] = {
+                IsTopLeftEdge(setup.screen[1], setup.screen[2]),
+                IsTopLeftEdge(setup.screen[2], setup.screen[0]),
+                IsTopLeftEdge(setup.screen[0], setup.screen[1]) };
+
+            const int2 pixelMin = max(setup.boundsMin, tileMin);
+            const int2 pixelMax = min(setup.boundsMax, tileMax);
+            for (int y = pixelMin.y; y <= pixelMax.y; y++)
+            {
+                for (int x = pixelMin.x; x <= pixelMax.x; x++)
+                {
+                    float3 edges, weights;
+                    GetPixelWeights(setup.screen, setup.invW, setup.invArea, float2(float(x) + 0.5f, float(y) + 0.5f), edges, weights);
+
+                    bool covered = true;
+                    for (uint32_t k = 0; k < 3; k++)
+                        covered = covered && (edges[k] > 0.f || (edges[k] == 0.f && topLeft[k]));
+                    if (!covered)
+                        continue;
+
+                    const size_t pixel = size_t(y) * width + x;
+                    const float invW = (edges.x * setup.invW[0] + edges.y * setup.invW[1] + edges.z * setup.invW[2]) * setup.invArea;
+                    if (invW <= depth[pixel])
+                        continue;
+
+                    if (alphaTested)
+                    {
+                        const float2 barycentrics = setup.barycentrics[0] * weights.x + setup.barycentrics[1] * weights.y + setup.barycentrics[2] * weights.z;
+                        if (!m_Scene.ConsiderTransparentMaterial(setup.triangle, barycentrics))
+                            continue;
+                    }
+
+                    depth[pixel] = invW;
+                    visibleTriangles[pixel] = index;
+                }
+            }
+        }
+    });
+
+    const auto shadingStart = std::chrono::high_resolution_clock::now();
+    stats.rasterMilliseconds = std::chrono::duration<double, std::milli>(shadingStart - rasterStart).count();
+
+    // Shading: quads per visible triangle, packed into waves, sampled like SampleMaterialTextures
+    std::vector<CpuRasterizerStats> tileStats(tilesX * tilesY);
+
+    m_Pool.ParallelFor(tilesX * tilesY, [&](uint32_t tile)
+    {
+        const uint2 tileMin = uint2((tile % tilesX) * c_TileSize, (tile / tilesX) * c_TileSize);
+        const uint2 tileEnd = uint2(std::min(tileMin.x + c_TileSize, width), std::min(tileMin.y + c_TileSize, height));
+        CpuRasterizerStats& localStats = tileStats[tile];
+        localStats.textureSampling.resize(m_Scene.GetTextures().size());
+
+        auto getVisible = [&](uint32_t x, uint32_t y)
+        {
+            return (x < width && y < height) ? visibleTriangles[size_t(y) * width + x] : ~0u;
+        };
+
+        std::vector<QuadInvocation> invocations;
+        for (uint32_t y = tileMin.y; y < tileEnd.y; y += 2)
+        {
+            for (uint32_t x = tileMin.x; x < tileEnd.x; x += 2)
+            {
+                const uint32_t quad[4] = { getVisible(x, y), getVisible(x + 1, y), getVisible(x, y + 1), getVisible(x + 1, y + 1) };
+                for (uint32_t i = 0; i < 4; i++)
+                {
+                    if (quad[i] == ~0u || std::find(quad, quad + i, quad[i]) != quad + i)
+                        continue;
+
+                    const uint32_t sceneTriangle = setupTriangles[quad[i]].triangle;
+                    QuadInvocation invocation;
+                    invocation.setupTriangle = quad[i];
+                    invocation.waveKey = options.wavePacking == CpuWavePacking::Draw ? triangles[sceneTriangle].geometry : sceneTriangle;
+                    invocation.position = uint2(x, y);
+                    invocations.push_back(invocation);
+                }
+            }
+        }
+
+        // Draw order first, raster order within a draw or triangle
+        std::stable_sort(invocations.begin(), invocations.end(), [](const QuadInvocation& a, const QuadInvocation& b)
+        {
+            return a.waveKey < b.waveKey;
+        });
+
+        const uint32_t quadsPerWave = options.waveWidth / 4;
+        for (size_t waveStart = 0; waveStart < invocations.size(); )
+        {
+            size_t waveEnd = waveStart + 1;
+            while (waveEnd < invocations.size() && waveEnd - waveStart < quadsPerWave && invocations[waveEnd].waveKey == invocations[waveStart].waveKey)
+                waveEnd++;
+
+            const uint32_t laneCount = uint32_t(waveEnd - waveStart) * 4;
+            const uint32_t materialIndex = geometries[triangles[setupTriangles[invocations[waveStart].setupTriangle].triangle].geometry].material;
+            const CpuScene::Material& material = materials[materialIndex];
+
+            StfCpuWaveLane lanes[c_MaxWaveLanes];
+            StfCpuSamplerState samplerStates[c_MaxWaveLanes];
+            float3 noise[c_MaxWaveLanes];
+            CpuScene::GeometrySample samples[c_MaxWaveLanes];
+            CpuScene::MaterialTextures textures[c_MaxWaveLanes];
+            uint2 pixels[c_MaxWaveLanes];
+
+            for (uint32_t lane = 0; lane < laneCount; lane++)
+            {
+                const QuadInvocation& invocation = invocations[waveStart + lane / 4];
+                const SetupTriangle& setup = setupTriangles[invocation.setupTriangle];
+                const uint2 pixel = invocation.position + uint2(lane & 1, (lane >> 1) & 1);
+                const float2 pixelPosition = float2(pixel) + 0.5f; // SV_Position
+
+                float3 edges, weights;
+                GetPixelWeights(setup.screen, setup.invW, setup.invArea, pixelPosition, edges, weights);
+                const float2 barycentrics = setup.barycentrics[0] * weights.x + setup.barycentrics[1] * weights.y + setup.barycentrics[2] * weights.z;
+
+                pixels[lane] = pixel;
+                samples[lane] = m_Scene.GetGeometrySample(setup.triangle, barycentrics);
+
+                StfCpuWaveLane& waveLane = lanes[lane];
+                waveLane.helper = getVisible(pixel.x, pixel.y) != invocation.setupTriangle;
+                waveLane.uv = samples[lane].texcoord;
+
+                // The split line returns before sampling, also in helper lanes
+                waveLane.participates = true;
+                if (stfEnabled && constants.stfSplitScreen)
+                {
+                    const float x = pixelPosition.x * view.viewportSizeInv.x;
+                    waveLane.participates = !(x > 0.499f && x < 0.501f);
+                }
+
+                waveLane.stfEnabled = stfEnabled && !material.alphaTested &&
+                    !(constants.stfSplitScreen && pixelPosition.x > view.viewportSize.x / 2.f);
+
+                // InitSTF
+                const float3 u = m_Scene.GetNoise(pixel, constants.stfFrameIndex, constants.stfUseWhiteNoise != 0,
+                    constants.stfTemporalStrata, constants.stfTemporalGenerator);
+                noise[lane] = u;
+                StfCpuSamplerState& samplerState = samplerStates[lane];
+                samplerState.u = float4(u.x, u.y, 0.f, u.z);
+                samplerState.filterType = constants.stfFilterMode;
+                samplerState.addressMode = constants.stfAddressMode;
+                samplerState.sigma = constants.stfSigma;
+                samplerState.sigmaLodTarget = constants.stfSigmaLodTarget;
+                samplerState.filterKernel = constants.stfFilterKernel;
+                samplerState.filterKernelEnabled = constants.stfFilterKernelEnabled != 0;
+                samplerState.anisoMethod = constants.stfMinificationMethod;
+                samplerState.ewaEnabled = constants.stfEwaEnabled != 0;
+                samplerState.reseedOnSample = constants.stfReseedOnSample != 0;
+                samplerState.constantFootprints = constants.stfConstantFootprints != 0;
+                waveLane.state = &samplerState;
+
+                localStats.activeLanes += waveLane.helper ? 0 : 1;
+                localStats.helperLanes += waveLane.helper ? 1 : 0;
+            }
+
+            // Coarse derivatives: the top-left lane against its horizontal and vertical neighbors
+            for (uint32_t quad = 0; quad < laneCount; quad += 4)
+            {
+                const float2 ddx = lanes[quad + 1].uv - lanes[quad].uv;
+                const float2 ddy = lanes[quad + 2].uv - lanes[quad].uv;
+                for (uint32_t lane = quad; lane < quad + 4; lane++)
+                {
+                    lanes[lane].ddx = ddx;
+                    lanes[lane].ddy = ddy;
+                }
+            }
+
+            // GetMaterialTexelId: lanes with STF, helper lanes too, store where STF samples the first texture of the
+            // material and return before sampling. ResolveTexelIds shades their pixels.
+            bool deferred[c_MaxWaveLanes] = {};
+            if (options.deferredTexels && constants.stfDeferredTexels)
+            {
+                const int slotTextures[] = { material.baseTexture, material.metalRoughTexture, material.emissiveTexture, material.normalTexture };
+                const uint32_t slots[] = { STF_TEXTURE_SLOT_BASE_OR_DIFFUSE, STF_TEXTURE_SLOT_METAL_ROUGH_OR_SPECULAR, STF_TEXTURE_SLOT_EMISSIVE,
+                    STF_TEXTURE_SLOT_NORMAL };
+
+                uint32_t slot = 0;
+                while (slot < 4 && slotTextures[slot] < 0)
+                    slot++;
+
+                for (uint32_t lane = 0; slot < 4 && lane < laneCount; lane++)
+                {
+                    StfCpuWaveLane& waveLane = lanes[lane];
+                    if (!waveLane.participates || !waveLane.stfEnabled)
+                        continue;
+
+                    deferred[lane] = true;
+                    waveLane.participates = false;
+                    if (waveLane.helper)
+                        continue;
+
+                    StfCpuSamplerState state = samplerStates[lane];
+                    if (constants.stfDecorrelateTextures)
+                    {
+                        const float3 u = DecorrelateStfRandom(noise[lane], slots[slot]);
+                        state.u = float4(u.x, u.y, 0.f, u.z);
+                    }
+
+                    const StfCpuTexture& texture = m_Scene.GetTextures()[slotTextures[slot]];
+                    const StfCpuTap tap = state.GetTapGrad(texture, waveLane.uv, waveLane.ddx, waveLane.ddy);
+                    const bool backFace = !setupTriangles[invocations[waveStart + lane / 4].setupTriangle].frontFacing;
+                    const CpuScene::GeometrySample& sample = samples[lane];
+
+                    const size_t index = size_t(pixels[lane].y) * width + pixels[lane].x;
+                    texelIds[index] = PackGBufferTexelId(float2(tap.texel), float2(texture.GetSize(tap.mip)), tap.mip, uint32_t(texture.GetSize(0).x),
+                        materialIndex, backFace);
+                    tangentFrames[index] = PackGBufferTangentFrame(sample.geometryNormal, sample.tangent.xyz(), sample.tangent.w);
+                }
+            }
+
+            StfCpuMultiTap multiTap;
+            multiTap.maxTaps = constants.stfMaxTaps;
+            multiTap.threshold = constants.stfTapContrast;
+
+            // Same order as SampleMaterialTextures
+            auto sampleTexture = [&](int textureIndex, uint32_t textureSlot, float4 CpuScene::MaterialTextures::* value)
+            {
+                if (textureIndex < 0)
+                    return;
+
+                // DecorrelateSTF
+                if (constants.stfDecorrelateTextures)
+                {
+                    for (uint32_t lane = 0; lane < laneCount; lane++)
+                    {
+                        const float3 u = DecorrelateStfRandom(noise[lane], textureSlot);
+                        samplerStates[lane].u = float4(u.x, u.y, 0.f, u.z);
+                    }
+                }
+
+                // The random numbers of the first tap, before reseeding
+                float4 firstRandom[c_MaxWaveLanes];
+                for (uint32_t lane = 0; lane < laneCount; lane++)
+                    firstRandom[lane] = samplerStates[lane].u;
+
+                const StfCpuTexture& texture = m_Scene.GetTextures()[textureIndex];
+                StfSamplingCounters counters;
+                StfCpuSampleWaveGrad(texture, constants.stfMagnificationMethod, options.includeHelperLanes, lanes, laneCount, counters);
+
+                // StfMultiTap::AddTapsGrad: lanes that took the constant footprint early-out have returned, and helper
+                // lanes only take part in the quad contrast with [WaveOpsIncludeHelperLanes]
+                if (multiTap.IsEnabled())
+                {
+                    bool tapping[c_MaxWaveLanes];
+                    for (uint32_t lane = 0; lane < laneCount; lane++)
+                    {
+                        const StfCpuWaveLane& waveLane = lanes[lane];
+                        StfCpuTap constantTap;
+                        tapping[lane] = waveLane.participates && waveLane.stfEnabled && (!waveLane.helper || options.includeHelperLanes) &&
+                            !(waveLane.state->constantFootprints &&
+                                waveLane.state->GetConstantTapGrad(texture, waveLane.uv, waveLane.ddx, waveLane.ddy, constantTap));
+                    }
+
+                    uint32_t tapCounts[c_MaxWaveLanes];
+                    for (uint32_t lane = 0; lane < laneCount; lane++)
+                    {
+                        float4 minValue = lanes[lane].result;
+                        float4 maxValue = lanes[lane].result;
+                        for (uint32_t i = 1; i < 4; i++)
+                        {
+                            const uint32_t other = lane ^ i;
+                            if (tapping[other])
+                            {
+                                minValue = min(minValue, lanes[other].result);
+                                maxValue = max(maxValue, lanes[other].result);
+                            }
+                        }
+                        tapCounts[lane] = multiTap.GetTapCount(StfCpuMultiTap::GetContrast(minValue, maxValue));
+                    }
+
+                    for (uint32_t lane = 0; lane < laneCount; lane++)
+                    {
+                        if (!tapping[lane])
+                            continue;
+
+                        StfCpuWaveLane& waveLane = lanes[lane];
+                        waveLane.result = StfCpuMultiTap::AddTapsGrad(*waveLane.state, firstRandom[lane], waveLane.result, tapCounts[lane],
+                            texture, waveLane.uv, waveLane.ddx, waveLane.ddy);
+                        counters.extraTaps += tapCounts[lane] - 1;
+                        counters.texelsFetched += tapCounts[lane] - 1;
+                    }
+                }
+
+                localStats.sampling.Add(counters);
+                localStats.textureSampling[textureIndex].Add(counters);
+
+                for (uint32_t lane = 0; lane < laneCount; lane++)
+                    textures[lane].*value = lanes[lane].result;
+            };
+
+            sampleTexture(material.baseTexture, STF_TEXTURE_SLOT_BASE_OR_DIFFUSE, &CpuScene::MaterialTextures::baseOrDiffuse);
+            sampleTexture(material.metalRoughTexture, STF_TEXTURE_SLOT_METAL_ROUGH_OR_SPECULAR, &CpuScene::MaterialTextures::metalRoughOrSpecular);
+            sampleTexture(material.emissiveTexture, STF_TEXTURE_SLOT_EMISSIVE, &CpuScene::MaterialTextures::emissive);
+            sampleTexture(material.normalTexture, STF_TEXTURE_SLOT_NORMAL, &CpuScene::MaterialTextures::normal);
+
+            for (uint32_t lane = 0; lane < laneCount; lane++)
+            {
+                if (lanes[lane].helper || deferred[lane])
+                    continue;
+
+                const uint2 pixel = pixels[lane];
+                CpuGBufferTexel& texel = output[size_t(pixel.y) * width + pixel.x];
+
+                if (!lanes[lane].participates)
+                {
+                    texel.channel0 = float4(1.f, 0.f, 0.f, 1.f);
+                    texel.channel1 = float4(0.f);
+                    texel.channel2 = float4(1.f, 0.f, 0.f, 0.f);
+                    texel.channel3 = float4(1.f, 0.f, 0.f, 0.f);
+                    continue;
+                }
+
+                CpuScene::MaterialSample surface = m_Scene.EvaluateMaterial(samples[lane], textures[lane]);
+                if (!setupTriangles[invocations[waveStart + lane / 4].setupTriangle].frontFacing)
+                    surface.shadingNormal = -surface.shadingNormal;
+
+                texel.channel0 = float4(surface.diffuseAlbedo, surface.opacity);
+                texel.channel1 = float4(surface.specularF0, 1.f);
+                texel.channel2 = float4(surface.shadingNormal, surface.roughness);
+                texel.channel3 = float4(surface.emissiveColor, 0.f);
+            }
+
+            localStats.quads += laneCount / 4;
+            localStats.waves++;
+            waveStart = waveEnd;
+        }
+    });
+
+    for (const CpuRasterizerStats& local : tileStats)
+    {
+        stats.quads += local.quads;
+        stats.waves += local.waves;
+        stats.activeLanes += local.activeLanes;
+        stats.helperLanes += local.helperLanes;
+        stats.sampling.Add(local.sampling);
+
+        stats.textureSampling.resize(local.textureSampling.size());
+        for (size_t i = 0; i < local.textureSampling.size(); i++)
+            stats.textureSampling[i].Add(local.textureSampling[i]);
+    }
+
+    stats.shadingMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - shadingStart).count();
+
+    if (options.deferredTexels)
+        ResolveTexelIds(texelIds, tangentFrames, width, output, stats);
+}
+
+void CpuRasterizer::ResolveTexelIds(const std::vector<uint2>& texelIds, const std::vector<uint32_t>& tangentFrames, uint32_t width,
+    std::vector<CpuGBufferTexel>& output, CpuRasterizerStats& stats) const
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    const uint32_t height = uint32_t(output.size() / width);
+    const std::vector<CpuScene::Material>& materials = m_Scene.GetMaterials();
+    const std::vector<StfCpuTexture>& textures = m_Scene.GetTextures();
+    std::vector<uint64_t> rowPixels(height, 0);
+    std::vector<uint64_t> rowFetches(height, 0);
+
+    // Screen order like the full screen pass
+    m_Pool.ParallelFor(height, [&](uint32_t y)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            const size_t index = size_t(y) * width + x;
+            const GBufferTexelId id = UnpackGBufferTexelId(texelIds[index]);
+            if (!id.resolve)
+                continue;
+
+            const CpuScene::Material& material = materials[id.materialId];
+            const GBufferTangentFrame frame = UnpackGBufferTangentFrame(tangentFrames[index]);
+
+            // LoadMaterialTexture
+            auto load = [&](int textureIndex, float4& value)
+            {
+                if (textureIndex < 0)
+                    return;
+
+                const StfCpuTexture& texture = textures[textureIndex];
+                const uint32_t mip = GetGBufferTexelMip(id, uint32_t(texture.GetSize(0).x), texture.GetMipCount());
+                value = texture.Load(mip, GetGBufferTexel(id.uv, texture.GetSize(mip)));
+                rowFetches[y]++;
+            };
+
+            CpuScene::MaterialTextures values;
+            load(material.baseTexture, values.baseOrDiffuse);
+            load(material.metalRoughTexture, values.metalRoughOrSpecular);
+            load(material.emissiveTexture, values.emissive);
+            load(material.normalTexture, values.normal);
+
+            CpuScene::GeometrySample sample;
+            sample.material = &material;
+            sample.geometryNormal = frame.normal;
+            sample.tangent = frame.tangent;
+
+            CpuScene::MaterialSample surface = m_Scene.EvaluateMaterial(sample, CpuScene::DecodeMaterial(material, values));
+            if (id.backFace)
+                surface.shadingNormal = -surface.shadingNormal;
+
+            CpuGBufferTexel& texel = output[index];
+            texel.channel0 = float4(surface.diffuseAlbedo, surface.opacity);
+            texel.channel1 = float4(surface.specularF0, 1.f);
+            texel.channel2 = float4(surface.shadingNormal, surface.roughness);
+            texel.channel3 = float4(surface.emissiveColor, 0.f);
+            rowPixels[y]++;
+        }
+    });
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        stats.resolvedPixels += rowPixels[y];
+        stats.resolveTexelsFetched += rowFetches[y];
+    }
+
+    stats.resolveMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
@@ -0,0 +1,89 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "CpuScene.h"
+#include "StfCpuSampler.h"
+#include "TaskGraph.h"
+
+#include <donut/core/math/math.h>
+
+#include <vector>
+
+struct LightingConstants;
+
+// How the quads of a tile are packed into waves
+enum class CpuWavePacking
+{
+    Draw,       // quads of the same draw share waves, like the pixel shader waves of one draw call
+    Triangle,   // every triangle starts a new wave
+};
+
+struct CpuRasterizerOptions
+{
+    uint32_t waveWidth = 32;            // lanes per wave, a multiple of 4 up to 128
+    CpuWavePacking wavePacking = CpuWavePacking::Draw;
+    bool includeHelperLanes = false;    // ALLOW_HELPER_LANES, i.e. [WaveOpsIncludeHelperLanes]
+    bool deferredTexels = false;        // DEFERRED_TEXELS, the fill stores texel IDs and Render resolves them before it returns
+};
+
+struct CpuRasterizerStats
+{
+    uint64_t quads = 0;
+    uint64_t waves = 0;
+    uint64_t activeLanes = 0;
+    uint64_t helperLanes = 0;
+    StfSamplingCounters sampling;
+    std::vector<StfSamplingCounters> textureSampling;    // per CpuScene texture
+    double rasterMilliseconds = 0.0;    // setup, binning and visibility
+    double shadingMilliseconds = 0.0;
+    uint64_t resolvedPixels = 0;        // pixels shaded by the texel resolve with deferredTexels
+    uint64_t resolveTexelsFetched = 0;
+    double resolveMilliseconds = 0.0;
+};
+
+// The outputs of gbuffer_stf_ps for one pixel
+struct CpuGBufferTexel
+{
+    dm::float4 channel0 = 0.f;  // diffuse albedo, opacity
+    dm::float4 channel1 = 0.f;  // specular F0, occlusion
+    dm::float4 channel2 = 0.f;  // shading normal, roughness
+    dm::float4 channel3 = 0.f;  // emissive
+};
+
+// CPU version of the Raster pipeline's G-buffer fill with gbuffer_stf_ps.
+// Triangles are clipped and set up in parallel, binned into screen tiles, and every tile resolves visibility with a
+// depth test and alpha test first. Each triangle visible in a 2x2 quad then launches a quad: pixels where it is not
+// visible become helper lanes evaluated at their pixel centers, ddx/ddy are the coarse differences inside the quad,
+// and the quads are packed into waves that sample the material textures through StfCpuSampleWaveGrad.
+// With deferredTexels and stfDeferredTexels, STF pixels store the texel ID and tangent frame of gbuffer_texel_id.h
+// instead, from the tap of the first texture of the material, and the resolve of gbuffer_texel_resolve_ps loads and
+// evaluates the material once per pixel.
+class CpuRasterizer
+{
+public:
+    CpuRasterizer(ThreadPool& pool, const CpuScene& scene);
+
+    // One frame for every pixel of constants.view. stfEnabled is STF_ENABLED of the shader permutation.
+    // output receives viewportSize.x * viewportSize.y texels row by row, cleared to 0 where nothing is visible.
+    void Render(const LightingConstants& constants, bool stfEnabled, const CpuRasterizerOptions& options,
+        std::vector<CpuGBufferTexel>& output, CpuRasterizerStats& stats) const;
+
+private:
+    struct SetupTriangle;
+    struct QuadInvocation;
+
+    void ResolveTexelIds(const std::vector<dm::uint2>& texelIds, const std::vector<uint32_t>& tangentFrames, uint32_t width,
+        std::vector<CpuGBufferTexel>& output, CpuRasterizerStats& stats) const;
+
+    ThreadPool& m_Pool;
+    const CpuScene& m_Scene;
+};
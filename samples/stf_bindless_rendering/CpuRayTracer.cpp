@@ -0,0 +1,1355 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "CpuRayTracer.h"
+#include "OpacityMicromap.h"
+#include "TexelShadingCache.h"
+
+#include <donut/core/log.h>
+#include <donut/engine/SceneTypes.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <unordered_set>
+
+using namespace donut;
+using namespace donut::math;
+
+#include "lighting_cb.h"
+#include "stf_decorrelation.h"
+#include "stf_ewa.h"
+
+struct CpuRayTracer::SamplingParameters
+{
+    const LightingConstants* constants = nullptr;
+    bool stfEnabled = false; // STF_ENABLED
+    uint2 pixel;
+    float3 u;
+};
+
+namespace
+{
+    constexpr uint32_t c_TileWidth = 16;
+    constexpr uint32_t c_TileHeight = 8;
+    constexpr uint32_t c_PacketWidth = 4;
+    constexpr uint32_t c_PacketHeight = 2;
+    constexpr uint32_t c_MaxWaveLanes = 128;
+    static_assert(c_PacketWidth * c_PacketHeight == CpuBvh::PacketWidth, "One packet covers a block of pixels");
+
+    CpuRay SetupPrimaryRay(uint2 pixelPosition, const PlanarViewConstants& view)
+    {
+        const float2 uv = (float2(pixelPosition) + 0.5f) * view.viewportSizeInv;
+        const float4 clipPos = float4(uv.x * 2.f - 1.f, 1.f - uv.y * 2.f, 0.5f, 1.f);
+        const float4 worldPos = clipPos * view.matClipToWorld;
+
+        CpuRay ray;
+        ray.origin = view.cameraDirectionOrPosition.xyz();
+        ray.direction = normalize(worldPos.xyz() / worldPos.w - ray.origin);
+        ray.tMin = 0.f;
+        ray.tMax = 1000.f;
+        return ray;
+    }
+
+    CpuRay SetupShadowRay(float3 surfacePos, float3 viewIncident, const LightConstants& light)
+    {
+        CpuRay ray;
+        ray.origin = surfacePos - viewIncident * 0.001f;
+        ray.direction = -light.direction;
+        ray.tMin = 0.f;
+        ray.tMax = 1000.f;
+        return ray;
+    }
+
+    float3 ComputeRayIntersectionBarycentrics(const float3 vertices[3], float3 rayOrigin, float3 rayDirection)
+    {
+        const float3 edge1 = vertices[1] - vertices[0];
+        const float3 edge2 = vertices[2] - vertices[0];
+        const float3 pvec = cross(rayDirection, edge2);
+        const float invDet = 1.f / dot(edge1, pvec);
+        const float3 tvec = rayOrigin - vertices[0];
+        const float alpha = dot(tvec, pvec) * invDet;
+        const float3 qvec = cross(tvec, edge1);
+        const float beta = dot(rayDirection, qvec) * invDet;
+        return float3(1.f - alpha - beta, alpha, beta);
+    }
+
+    float3 GetBentNormal(float3 geometryNormal, float3 shadingNormal, float3 viewDirection)
+    {
+        // Flip the normals when looking at the back side of the geometry
+        if (dot(geometryNormal, viewDirection) > 0.f)
+        {
+            geometryNormal = -geometryNormal;
+            shadingNormal = -shadingNormal;
+        }
+
+        // Bend the shading normal when its reflection points below the geometry
+        const float3 reflected = viewDirection - shadingNormal * (2.f * dot(viewDirection, shadingNormal));
+        const float a = dot(geometryNormal, reflected);
+        if (a < 0.f)
+        {
+            const float b = std::max(0.001f, dot(shadingNormal, geometryNormal));
+            return normalize(-viewDirection + normalize(reflected - shadingNormal * (a / b)));
+        }
+
+        return shadingNormal;
+    }
+
+    float3 GgxTimesNdotL(float3 viewIncident, float3 lightDirection, float3 normal, float roughness, float3 specularF0)
+    {
+        const float3 halfVector = normalize(lightDirection - viewIncident);
+        const float NdotL = std::clamp(dot(normal, lightDirection), 0.f, 1.f);
+        const float NdotV = std::clamp(-dot(normal, viewIncident), 0.f, 1.f);
+        const float NdotH = std::clamp(dot(normal, halfVector), 0.f, 1.f);
+        const float VdotH = std::clamp(-dot(viewIncident, halfVector), 0.f, 1.f);
+
+        if (NdotL <= 0.f || NdotV <= 0.f)
+            return float3(0.f);
+
+        const float alpha = std::max(roughness * roughness, 0.01f);
+        const float alpha2 = alpha * alpha;
+        const float denominator = NdotH * NdotH * (alpha2 - 1.f) + 1.f;
+        const float D = alpha2 / (PI_f * denominator * denominator);
+
+        const float k = alpha * 0.5f;
+        const float G = (NdotL / (NdotL * (1.f - k) + k)) * (NdotV / (NdotV * (1.f - k) + k));
+
+        const float fresnel = std::pow(1.f - VdotH, 5.f);
+        const float3 F = specularF0 + (float3(1.f) - specularF0) * fresnel;
+
+        // D * G * F / (4 * NdotL * NdotV), times NdotL
+        return F * (D * G / (4.f * NdotV));
+    }
+
+    // ShadeSurface for the directional sun, the only light of the sample. The angular size of the sun does not widen
+    // the specular lobe here.
+    void ShadeSurface(const LightConstants& light, float3 shadingNormal, float3 diffuseAlbedo, float3 specularF0, float roughness,
+        float3 viewIncident, float3& diffuseRadiance, float3& specularRadiance)
+    {
+        diffuseRadiance = 0.f;
+        specularRadiance = 0.f;
+
+        if (light.intensity <= 0.f)
+            return;
+
+        const float3 lightDirection = -light.direction;
+        const float3 radiance = light.color * light.intensity;
+
+        diffuseRadiance = diffuseAlbedo * radiance * (std::max(0.f, dot(shadingNormal, lightDirection)) / PI_f);
+        specularRadiance = GgxTimesNdotL(viewIncident, lightDirection, shadingNormal, roughness, specularF0) * radiance;
+    }
+
+    // InitSTF
+    StfCpuSamplerState CreateSamplerState(const LightingConstants& constants, float3 u)
+    {
+        StfCpuSamplerState samplerState;
+        samplerState.u = float4(u.x, u.y, 0.f, u.z);
+        samplerState.filterType = constants.stfFilterMode;
+        samplerState.addressMode = constants.stfAddressMode;
+        samplerState.sigma = constants.stfSigma;
+        samplerState.sigmaLodTarget = constants.stfSigmaLodTarget;
+        samplerState.filterKernel = constants.stfFilterKernel;
+        samplerState.filterKernelEnabled = constants.stfFilterKernelEnabled != 0;
+        samplerState.anisoMethod = constants.stfMinificationMethod;
+        samplerState.ewaEnabled = constants.stfEwaEnabled != 0;
+        samplerState.reseedOnSample = constants.stfReseedOnSample != 0;
+        samplerState.constantFootprints = constants.stfConstantFootprints != 0;
+        return samplerState;
+    }
+}
+
+CpuRayTracer::CpuRayTracer(ThreadPool& pool, const CpuScene& scene)
+    : m_Pool(pool)
+    , m_Scene(scene)
+{
+}
+
+void CpuRayTracer::Init()
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    const std::vector<CpuScene::Triangle>& triangles = m_Scene.GetTriangles();
+    const std::vector<CpuScene::Material>& materials = m_Scene.GetMaterials();
+    const std::vector<CpuScene::Geometry>& geometries = m_Scene.GetGeometries();
+
+    // Geometries are non-opaque exactly when their material is alpha tested, like in GetMeshBlasDesc
+    std::vector<CpuBvhTriangle> bvhTriangles(triangles.size());
+    for (size_t i = 0; i < triangles.size(); i++)
+    {
+        bvhTriangles[i].v0 = triangles[i].positions[0];
+        bvhTriangles[i].v1 = triangles[i].positions[1];
+        bvhTriangles[i].v2 = triangles[i].positions[2];
+        bvhTriangles[i].opaque = !materials[geometries[triangles[i].geometry].material].alphaTested;
+    }
+
+    m_Bvh.Build(m_Pool, bvhTriangles);
+
+    log::info("CPU ray tracer ready in %.1f ms: %d BVH nodes",
+        std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(),
+        int(m_Bvh.GetNodes().size()));
+}
+
+bool CpuRayTracer::ConsiderTransparentMaterial(uint32_t triangle, float2 barycentrics) const
+{
+    // Known micromap states need no alpha test, like hits the hardware resolves without invoking the any-hit shader
+    if (m_Micromaps)
+    {
+        const OmmState state = m_Micromaps->GetState(triangle, barycentrics);
+        if (OpacityMicromaps::IsKnown(state))
+            return state == OmmState::Opaque;
+    }
+
+    return m_Scene.ConsiderTransparentMaterial(triangle, barycentrics);
+}
+
+CpuScene::MaterialSample CpuRayTracer::SampleMaterial(const CpuScene::GeometrySample& gs, float2 texGradX, float2 texGradY,
+    bool forceMipLevel, float mipLevel, const SamplingParameters& sampling) const
+{
+    const CpuScene::Material& material = *gs.material;
+    const LightingConstants& constants = *sampling.constants;
+
+    StfCpuSamplerState samplerState = CreateSamplerState(constants, sampling.u);
+
+    bool stfEnabled = sampling.stfEnabled && !material.alphaTested;
+    if (constants.stfSplitScreen && float(sampling.pixel.x) > constants.view.viewportSize.x / 2.f)
+        stfEnabled = false;
+
+    // Reseeding and decorrelation give every texture its own random numbers and so its own tap
+    const bool shareFootprints = constants.stfShareFootprints != 0 && !samplerState.reseedOnSample && constants.stfDecorrelateTextures == 0;
+    StfCpuSharedFootprint footprint = forceMipLevel
+        ? StfCpuSharedFootprint(samplerState, gs.texcoord, mipLevel)
+        : StfCpuSharedFootprint(samplerState, gs.texcoord, texGradX, texGradY);
+
+    StfCpuMultiTap multiTap;
+    multiTap.maxTaps = constants.stfMaxTaps;
+    multiTap.threshold = constants.stfTapContrast;
+
+    auto sampleTexture = [&](int textureIndex, uint32_t textureSlot, float4 defaultValue)
+    {
+        if (textureIndex < 0)
+            return defaultValue;
+
+        // DecorrelateSTF
+        if (constants.stfDecorrelateTextures)
+            samplerState = CreateSamplerState(constants, DecorrelateStfRandom(sampling.u, textureSlot));
+
+        const StfCpuTexture& texture = m_Scene.GetTextures()[textureIndex];
+        if (stfEnabled)
+        {
+            const float4 u = samplerState.u;
+            float4 value;
+            if (shareFootprints)
+                value = footprint.Sample(texture);
+            else if (forceMipLevel)
+                value = samplerState.SampleLevel(texture, gs.texcoord, mipLevel);
+            else
+                value = samplerState.SampleGrad(texture, gs.texcoord, texGradX, texGradY);
+
+            // A single ray has no quad to measure the contrast in, so every sample takes the most taps
+            if (multiTap.IsEnabled())
+            {
+                uint32_t tapCount = multiTap.GetTapCount(std::numeric_limits<float>::max());
+                value = forceMipLevel
+                    ? StfCpuMultiTap::AddTapsLevel(samplerState, u, value, tapCount, texture, gs.texcoord, mipLevel)
+                    : StfCpuMultiTap::AddTapsGrad(samplerState, u, value, tapCount, texture, gs.texcoord, texGradX, texGradY);
+            }
+            return value;
+        }
+
+        return forceMipLevel
+            ? SampleHardwareLevel(texture, gs.texcoord, mipLevel)
+            : SampleHardwareGrad(texture, gs.texcoord, texGradX, texGradY);
+    };
+
+    // Same order as sampleGeometryMaterial: with reseeding, every sample changes the random numbers of the next one.
+    // The emissive texture does not contribute to the output but is still sampled for that reason.
+    CpuScene::MaterialTextures textures;
+    textures.baseOrDiffuse = sampleTexture(material.baseTexture, STF_TEXTURE_SLOT_BASE_OR_DIFFUSE, textures.baseOrDiffuse);
+    textures.emissive = sampleTexture(material.emissiveTexture, STF_TEXTURE_SLOT_EMISSIVE, textures.emissive);
+    textures.normal = sampleTexture(material.normalTexture, STF_TEXTURE_SLOT_NORMAL, textures.normal);
+    textures.metalRoughOrSpecular = sampleTexture(material.metalRoughTexture, STF_TEXTURE_SLOT_METAL_ROUGH_OR_SPECULAR, textures.metalRoughOrSpecular);
+
+    return m_Scene.EvaluateMaterial(gs, textures);
+}
+
+void CpuRayTracer::ComputeTextureGradients(const CpuRayHit& hit, float3 rayDirection, uint2 pixel, const PlanarViewConstants& view,
+    float2& texGradX, float2& texGradY) const
+{
+    const CpuScene::Triangle& triangle = m_Scene.GetTriangles()[hit.triangle];
+
+    const RayDifferential differential = GetPrimaryRayDifferential(pixel, view.matClipToWorld, view.viewportSizeInv,
+        view.cameraDirectionOrPosition.xyz());
+
+    float3 dPdx, dPdy;
+    TransferRayDifferential(differential, rayDirection, hit.t, triangle.normal, dPdx, dPdy);
+    GetTextureGradients(triangle.texcoordJacobian, dPdx, dPdy, texGradX, texGradY);
+}
+
+void CpuRayTracer::ComputeNeighborRayTextureGradients(const CpuRayHit& hit, uint2 pixel, const PlanarViewConstants& view,
+    float2& texGradX, float2& texGradY) const
+{
+    const CpuScene::Triangle& triangle = m_Scene.GetTriangles()[hit.triangle];
+    const engine::BufferGroup& buffers = *m_Scene.GetGeometries()[triangle.geometry].buffers;
+
+    texGradX = 0.f;
+    texGradY = 0.f;
+    if (buffers.texcoord1Data.empty())
+        return;
+
+    float2 texcoords[3];
+    for (uint32_t i = 0; i < 3; i++)
+        texcoords[i] = buffers.texcoord1Data[triangle.vertices[i]];
+
+    const CpuRay ray0 = SetupPrimaryRay(pixel, view);
+    const CpuRay rayX = SetupPrimaryRay(pixel + uint2(1, 0), view);
+    const CpuRay rayY = SetupPrimaryRay(pixel + uint2(0, 1), view);
+
+    const float2 texcoord0 = CpuScene::Interpolate(texcoords, ComputeRayIntersectionBarycentrics(triangle.positions, ray0.origin, ray0.direction));
+    const float2 texcoordX = CpuScene::Interpolate(texcoords, ComputeRayIntersectionBarycentrics(triangle.positions, rayX.origin, rayX.direction));
+    const float2 texcoordY = CpuScene::Interpolate(texcoords, ComputeRayIntersectionBarycentrics(triangle.positions, rayY.origin, rayY.direction));
+    texGradX = texcoordX - texcoord0;
+    texGradY = texcoordY - texcoord0;
+}
+
+void CpuRayTracer::Render(const LightingConstants& constants, bool stfEnabled, std::vector<float4>& output) const
+{
+    const PlanarViewConstants& view = constants.view;
+    const uint32_t width = uint32_t(view.viewportSize.x);
+    const uint32_t height = uint32_t(view.viewportSize.y);
+
+    output.assign(size_t(width) * height, float4(0.f));
+    if (width == 0 || height == 0 || m_Scene.GetTriangles().empty())
+        return;
+
+    const CpuBvh::AnyHitFunction anyHit = [this](uint32_t, uint32_t triangle, float2 barycentrics)
+    {
+        return ConsiderTransparentMaterial(triangle, barycentrics);
+    };
+
+    const bool forceMipLevel = constants.stfUseMipLevelOverride == 1;
+    const float mipLevel = constants.stfMipLevelOverride;
+
+    const uint32_t tilesX = (width + c_TileWidth - 1) / c_TileWidth;
+    const uint32_t tilesY = (height + c_TileHeight - 1) / c_TileHeight;
+
+    m_Pool.ParallelFor(tilesX * tilesY, [&](uint32_t tile)
+    {
+        const uint32_t tileX = (tile % tilesX) * c_TileWidth;
+        const uint32_t tileY = (tile / tilesX) * c_TileHeight;
+
+        for (uint32_t blockY = tileY; blockY < std::min(tileY + c_TileHeight, height); blockY += c_PacketHeight)
+        {
+            for (uint32_t blockX = tileX; blockX < std::min(tileX + c_TileWidth, width); blockX += c_PacketWidth)
+            {
+                uint2 pixels[CpuBvh::PacketWidth];
+                CpuRay rays[CpuBvh::PacketWidth];
+                uint32_t rayCount = 0;
+
+                for (uint32_t y = blockY; y < std::min(blockY + c_PacketHeight, height); y++)
+                {
+                    for (uint32_t x = blockX; x < std::min(blockX + c_PacketWidth, width); x++)
+                    {
+                        if (stfEnabled && constants.stfSplitScreen)
+                        {
+                            const float pixelPos = float(x) * view.viewportSizeInv.x;
+                            if (pixelPos > 0.499f && pixelPos < 0.501f)
+                            {
+                                output[size_t(y) * width + x] = float4(1.f, 0.f, 0.f, 0.f);
+                                continue;
+                            }
+                        }
+
+                        pixels[rayCount] = uint2(x, y);
+                        rays[rayCount] = SetupPrimaryRay(pixels[rayCount], view);
+                        rayCount++;
+                    }
+                }
+
+                CpuRayHit hits[CpuBvh::PacketWidth];
+                m_Bvh.TraceClosest(rays, rayCount, anyHit, hits);
+
+                // shadeSurface up to the shadow ray, then one packet for the shadow rays of all hit lanes
+                CpuScene::MaterialSample samples[CpuBvh::PacketWidth];
+                float3 worldPositions[CpuBvh::PacketWidth];
+                CpuRay shadowRays[CpuBvh::PacketWidth];
+                uint32_t shadowLanes[CpuBvh::PacketWidth];
+                uint32_t shadowRayCount = 0;
+
+                for (uint32_t lane = 0; lane < rayCount; lane++)
+                {
+                    if (hits[lane].triangle == ~0u)
+                        continue;
+
+                    const uint2 pixel = pixels[lane];
+                    const float3 viewDirection = rays[lane].direction;
+                    const CpuScene::GeometrySample gs = m_Scene.GetGeometrySample(hits[lane].triangle, hits[lane].barycentrics);
+
+                    float2 texGradX, texGradY;
+                    ComputeTextureGradients(hits[lane], rays[lane].direction, pixel, view, texGradX, texGradY);
+
+                    SamplingParameters sampling;
+                    sampling.constants = &constants;
+                    sampling.stfEnabled = stfEnabled;
+                    sampling.pixel = pixel;
+                    sampling.u = m_Scene.GetNoise(pixel, constants.stfFrameIndex, constants.stfUseWhiteNoise != 0,
+                        constants.stfTemporalStrata, constants.stfTemporalGenerator);
+
+                    CpuScene::MaterialSample ms = SampleMaterial(gs, texGradX, texGradY, forceMipLevel, mipLevel, sampling);
+                    ms.shadingNormal = GetBentNormal(gs.flatNormal, ms.shadingNormal, viewDirection);
+
+                    samples[lane] = ms;
+                    worldPositions[lane] = gs.transform->transformPoint(gs.objectSpacePosition);
+                    shadowRays[shadowRayCount] = SetupShadowRay(worldPositions[lane], viewDirection, constants.light);
+                    shadowLanes[shadowRayCount] = lane;
+                    shadowRayCount++;
+                }
+
+                bool occluded[CpuBvh::PacketWidth];
+                m_Bvh.TraceAny(shadowRays, shadowRayCount, anyHit, occluded);
+
+                for (uint32_t i = 0; i < shadowRayCount; i++)
+                {
+                    const uint32_t lane = shadowLanes[i];
+                    const CpuScene::MaterialSample& ms = samples[lane];
+
+                    float3 diffuseTerm = 0.f;
+                    float3 specularTerm = 0.f;
+                    if (!occluded[i])
+                    {
+                        ShadeSurface(constants.light, ms.shadingNormal, ms.diffuseAlbedo, ms.specularF0, ms.roughness,
+                            rays[lane].direction, diffuseTerm, specularTerm);
+                    }
+
+                    const float3 color = diffuseTerm + specularTerm + (ms.diffuseAlbedo + ms.specularF0) * constants.ambientColor.xyz();
+                    output[size_t(pixels[lane].y) * width + pixels[lane].x] = float4(color, 0.f);
+                }
+            }
+        }
+    });
+}
+
+void CpuRayTracer::TracePrimaryHits(const PlanarViewConstants& view, std::vector<PrimaryHit>& primaryHits) const
+{
+    const uint32_t width = uint32_t(view.viewportSize.x);
+    const uint32_t height = uint32_t(view.viewportSize.y);
+
+    const CpuBvh::AnyHitFunction anyHit = [this](uint32_t, uint32_t triangle, float2 barycentrics)
+    {
+        return ConsiderTransparentMaterial(triangle, barycentrics);
+    };
+
+    // Rows in packets, each row fills its own part of the list
+    std::vector<std::vector<PrimaryHit>> rowHits(height);
+    m_Pool.ParallelFor(height, [&](uint32_t y)
+    {
+        for (uint32_t blockX = 0; blockX < width; blockX += CpuBvh::PacketWidth)
+        {
+            CpuRay rays[CpuBvh::PacketWidth];
+            const uint32_t rayCount = std::min(width - blockX, CpuBvh::PacketWidth);
+            for (uint32_t lane = 0; lane < rayCount; lane++)
+                rays[lane] = SetupPrimaryRay(uint2(blockX + lane, y), view);
+
+            CpuRayHit hits[CpuBvh::PacketWidth];
+            m_Bvh.TraceClosest(rays, rayCount, anyHit, hits);
+
+            for (uint32_t lane = 0; lane < rayCount; lane++)
+            {
+                if (hits[lane].triangle != ~0u)
+                    rowHits[y].push_back({ hits[lane], rays[lane].direction, uint2(blockX + lane, y) });
+            }
+        }
+    });
+
+    primaryHits.clear();
+    for (const std::vector<PrimaryHit>& row : rowHits)
+        primaryHits.insert(primaryHits.end(), row.begin(), row.end());
+}
+
+void CpuRayTracer::BenchmarkTextureGradients(const LightingConstants& constants) const
+{
+    const PlanarViewConstants& view = constants.view;
+    const uint32_t width = uint32_t(view.viewportSize.x);
+    const uint32_t height = uint32_t(view.viewportSize.y);
+    if (width == 0 || height == 0 || m_Scene.GetTriangles().empty())
+        return;
+
+    std::vector<PrimaryHit> primaryHits;
+    TracePrimaryHits(view, primaryHits);
+
+    if (primaryHits.empty())
+    {
+        log::warning("No primary hits to benchmark the texture gradients with");
+        return;
+    }
+
+    // Single threaded, so the times are the per-pixel cost of each method
+    constexpr uint32_t passCount = 8;
+    std::vector<float4> analytic(primaryHits.size());
+    std::vector<float4> neighborRays(primaryHits.size());
+
+    auto timePasses = [&](std::vector<float4>& gradients, auto&& compute)
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t pass = 0; pass < passCount; pass++)
+        {
+            for (size_t i = 0; i < primaryHits.size(); i++)
+            {
+                float2 texGradX, texGradY;
+                compute(primaryHits[i], texGradX, texGradY);
+                gradients[i] = float4(texGradX.x, texGradX.y, texGradY.x, texGradY.y);
+            }
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count()
+            / (double(passCount) * double(primaryHits.size()));
+    };
+
+    const double neighborRayTime = timePasses(neighborRays, [&](const PrimaryHit& primary, float2& texGradX, float2& texGradY)
+    {
+        ComputeNeighborRayTextureGradients(primary.hit, primary.pixel, view, texGradX, texGradY);
+    });
+    const double analyticTime = timePasses(analytic, [&](const PrimaryHit& primary, float2& texGradX, float2& texGradY)
+    {
+        ComputeTextureGradients(primary.hit, primary.direction, primary.pixel, view, texGradX, texGradY);
+    });
+
+    // Difference in the level of detail the two footprints select, in mip levels
+    double sumLodDifference = 0.0;
+    double maxLodDifference = 0.0;
+    uint32_t comparedCount = 0;
+    for (size_t i = 0; i < primaryHits.size(); i++)
+    {
+        const float analyticFootprint = std::max(length(analytic[i].xy()), length(float2(analytic[i].z, analytic[i].w)));
+        const float neighborRayFootprint = std::max(length(neighborRays[i].xy()), length(float2(neighborRays[i].z, neighborRays[i].w)));
+        if (!(analyticFootprint > 0.f) || !(neighborRayFootprint > 0.f) || !std::isfinite(analyticFootprint) || !std::isfinite(neighborRayFootprint))
+            continue;
+
+        const double lodDifference = std::abs(std::log2(double(analyticFootprint) / double(neighborRayFootprint)));
+        sumLodDifference += lodDifference;
+        maxLodDifference = std::max(maxLodDifference, lodDifference);
+        comparedCount++;
+    }
+
+    log::info("Texture gradients for %d primary hits: ray differentials %.1f ns/pixel, neighbor rays %.1f ns/pixel (%.2fx)",
+        int(primaryHits.size()), analyticTime, neighborRayTime, analyticTime > 0.0 ? neighborRayTime / analyticTime : 0.0);
+    log::info("Level of detail difference between the two: mean %.4f, max %.4f mip levels over %d textured hits",
+        comparedCount ? sumLodDifference / comparedCount : 0.0, maxLodDifference, int(comparedCount));
+}
+
+void CpuRayTracer::BenchmarkMaterialSampling(const LightingConstants& constants) const
+{
+    const PlanarViewConstants& view = constants.view;
+    if (uint32_t(view.viewportSize.x) == 0 || uint32_t(view.viewportSize.y) == 0 || m_Scene.GetTriangles().empty())
+        return;
+
+    std::vector<PrimaryHit> primaryHits;
+    TracePrimaryHits(view, primaryHits);
+
+    // The inputs of SampleMaterial for the STF hits, prepared up front so that only the texture sampling is timed
+    struct MaterialHit
+    {
+        const CpuScene::Material* material;
+        float2 texcoord;
+        float2 texGradX;
+        float2 texGradY;
+        StfCpuSamplerState samplerState;
+    };
+
+    std::vector<MaterialHit> materialHits;
+    uint64_t textureCount = 0;
+    for (const PrimaryHit& primary : primaryHits)
+    {
+        const CpuScene::GeometrySample gs = m_Scene.GetGeometrySample(primary.hit.triangle, primary.hit.barycentrics);
+        if (gs.material->alphaTested)
+            continue;
+
+        MaterialHit materialHit;
+        materialHit.material = gs.material;
+        materialHit.texcoord = gs.texcoord;
+        ComputeTextureGradients(primary.hit, primary.direction, primary.pixel, view, materialHit.texGradX, materialHit.texGradY);
+        materialHit.samplerState = CreateSamplerState(constants, m_Scene.GetNoise(primary.pixel, constants.stfFrameIndex, constants.stfUseWhiteNoise != 0,
+            constants.stfTemporalStrata, constants.stfTemporalGenerator));
+        materialHit.samplerState.reseedOnSample = false;
+        materialHits.push_back(materialHit);
+
+        for (int texture : { gs.material->baseTexture, gs.material->emissiveTexture, gs.material->normalTexture, gs.material->metalRoughTexture })
+            textureCount += texture >= 0 ? 1 : 0;
+    }
+
+    if (materialHits.empty())
+    {
+        log::warning("No STF material samples to benchmark");
+        return;
+    }
+
+    // Single threaded, so the times are the per-material cost of each method
+    constexpr uint32_t passCount = 8;
+    const std::vector<StfCpuTexture>& textures = m_Scene.GetTextures();
+    std::vector<float4> separate(materialHits.size());
+    std::vector<float4> shared(materialHits.size());
+    uint64_t footprintCount = 0;
+
+    auto timePasses = [&](std::vector<float4>& results, auto&& sample)
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t pass = 0; pass < passCount; pass++)
+        {
+            for (size_t i = 0; i < materialHits.size(); i++)
+                results[i] = sample(materialHits[i]);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count()
+            / (double(passCount) * double(materialHits.size()));
+    };
+
+    const double separateTime = timePasses(separate, [&](const MaterialHit& hit)
+    {
+        float4 sum = 0.f;
+        for (int texture : { hit.material->baseTexture, hit.material->emissiveTexture, hit.material->normalTexture, hit.material->metalRoughTexture })
+        {
+            if (texture < 0)
+                continue;
+
+            const StfCpuTap tap = hit.samplerState.GetTapGrad(textures[texture], hit.texcoord, hit.texGradX, hit.texGradY);
+            sum += textures[texture].Load(tap);
+        }
+        return sum;
+    });
+    const double sharedTime = timePasses(shared, [&](const MaterialHit& hit)
+    {
+        StfCpuSharedFootprint footprint(hit.samplerState, hit.texcoord, hit.texGradX, hit.texGradY);
+        float4 sum = 0.f;
+        for (int texture : { hit.material->baseTexture, hit.material->emissiveTexture, hit.material->normalTexture, hit.material->metalRoughTexture })
+        {
+            if (texture >= 0)
+                sum += footprint.Sample(textures[texture]);
+        }
+        footprintCount += footprint.GetFootprintCount();
+        return sum;
+    });
+
+    uint32_t mismatches = 0;
+    for (size_t i = 0; i < materialHits.size(); i++)
+        mismatches += any(separate[i] != shared[i]) ? 1 : 0;
+
+    const double materials = double(materialHits.size());
+    const double footprintsPerMaterial = double(footprintCount) / (double(passCount) * materials);
+    log::info("Material sampling for %d STF hits: %.2f textures and %.2f footprint classes per material",
+        int(materialHits.size()), double(textureCount) / materials, footprintsPerMaterial);
+    log::info("Separate footprints %.1f ns/material, shared footprints %.1f ns/material: %.2f footprint evaluations and %.1f ns saved per material, %d results differ",
+        separateTime, sharedTime, double(textureCount) / materials - footprintsPerMaterial, separateTime - sharedTime, int(mismatches));
+}
+
+void CpuRayTracer::BenchmarkTexelShadingCache(const LightingConstants& constants, uint32_t frameCount) const
+{
+    const PlanarViewConstants& view = constants.view;
+    if (uint32_t(view.viewportSize.x) == 0 || uint32_t(view.viewportSize.y) == 0 || m_Scene.GetTriangles().empty())
+        return;
+
+    std::vector<PrimaryHit> primaryHits;
+    TracePrimaryHits(view, primaryHits);
+
+    struct MaterialHit
+    {
+        CpuScene::GeometrySample gs;
+        uint32_t material;
+        float2 texGradX;
+        float2 texGradY;
+        uint2 pixel;
+    };
+
+    const std::vector<CpuScene::Material>& materials = m_Scene.GetMaterials();
+    std::vector<MaterialHit> materialHits;
+    for (const PrimaryHit& primary : primaryHits)
+    {
+        MaterialHit materialHit;
+        materialHit.gs = m_Scene.GetGeometrySample(primary.hit.triangle, primary.hit.barycentrics);
+        if (materialHit.gs.material->alphaTested)
+            continue;
+
+        materialHit.material = uint32_t(materialHit.gs.material - materials.data());
+        materialHit.pixel = primary.pixel;
+        ComputeTextureGradients(primary.hit, primary.direction, primary.pixel, view, materialHit.texGradX, materialHit.texGradY);
+        materialHits.push_back(materialHit);
+    }
+
+    if (materialHits.empty())
+    {
+        log::warning("No STF material samples to run the texel shading cache on");
+        return;
+    }
+
+    const std::vector<StfCpuTexture>& textures = m_Scene.GetTextures();
+
+    // The taps of SampleMaterial with shared footprints. The decode only depends on the key when all textures of the
+    // material load the same mip and texel with a weight of 1, which excludes custom kernels with negative lobes.
+    auto sampleHit = [&](const MaterialHit& hit, uint32_t frame, TexelShadingCache* cache, TexelShadingCacheStats& stats)
+    {
+        StfCpuSamplerState samplerState = CreateSamplerState(constants, m_Scene.GetNoise(hit.pixel, constants.stfFrameIndex + frame,
+            constants.stfUseWhiteNoise != 0, constants.stfTemporalStrata, constants.stfTemporalGenerator));
+        samplerState.reseedOnSample = false;
+        StfCpuSharedFootprint footprint(samplerState, hit.gs.texcoord, hit.texGradX, hit.texGradY);
+
+        const CpuScene::Material& material = *hit.gs.material;
+        const int textureIndices[] = { material.baseTexture, material.emissiveTexture, material.normalTexture, material.metalRoughTexture };
+        StfCpuTap taps[4];
+        StfCpuTap keyTap;
+        bool oneTap = true;
+        bool firstTap = true;
+        for (uint32_t slot = 0; slot < 4; slot++)
+        {
+            if (textureIndices[slot] < 0)
+                continue;
+
+            taps[slot] = footprint.GetTap(textures[textureIndices[slot]]);
+            if (firstTap)
+                keyTap = taps[slot];
+            oneTap = oneTap && taps[slot].weight == 1.f && taps[slot].mip == keyTap.mip && all(taps[slot].texel == keyTap.texel);
+            firstTap = false;
+        }
+
+        auto decode = [&]()
+        {
+            CpuScene::MaterialTextures values;
+            float4* outputs[] = { &values.baseOrDiffuse, &values.emissive, &values.normal, &values.metalRoughOrSpecular };
+            for (uint32_t slot = 0; slot < 4; slot++)
+            {
+                if (textureIndices[slot] >= 0)
+                    *outputs[slot] = textures[textureIndices[slot]].Load(taps[slot]);
+            }
+            return CpuScene::DecodeMaterial(material, values);
+        };
+
+        stats.samples++;
+        CpuScene::DecodedMaterial decoded;
+        if (!cache || !oneTap)
+        {
+            stats.bypassed += cache ? 1 : 0;
+            decoded = decode();
+        }
+        else
+        {
+            const uint64_t key = TexelShadingCache::MakeKey(hit.material, keyTap.mip, keyTap.texel);
+            uint32_t insertFrame = 0;
+            stats.lookups++;
+            if (cache->Find(key, decoded, insertFrame))
+            {
+                stats.hits++;
+                stats.frameHits += insertFrame != frame ? 1 : 0;
+            }
+            else
+            {
+                decoded = decode();
+                if (cache->Insert(key, decoded, frame))
+                    stats.inserts++;
+                else
+                    stats.dropped++;
+            }
+        }
+
+        return m_Scene.EvaluateMaterial(hit.gs, decoded);
+    };
+
+    // Room for twice the samples of a frame, so the first frame fills at most half of the table
+    TexelShadingCache cache(uint32_t(std::min<size_t>(2 * materialHits.size(), size_t(1) << 24)));
+
+    constexpr uint32_t blockSize = 1024;
+    const uint32_t blockCount = uint32_t((materialHits.size() + blockSize - 1) / blockSize);
+    std::vector<TexelShadingCacheStats> blockStats(blockCount);
+    std::vector<CpuScene::MaterialSample> decodedSamples(materialHits.size());
+    std::vector<CpuScene::MaterialSample> cachedSamples(materialHits.size());
+
+    auto timeFrame = [&](uint32_t frame, TexelShadingCache* frameCache, std::vector<CpuScene::MaterialSample>& results)
+    {
+        std::fill(blockStats.begin(), blockStats.end(), TexelShadingCacheStats());
+        const auto start = std::chrono::high_resolution_clock::now();
+        m_Pool.ParallelFor(blockCount, [&](uint32_t block)
+        {
+            const size_t end = std::min(size_t(block + 1) * blockSize, materialHits.size());
+            for (size_t i = size_t(block) * blockSize; i < end; i++)
+                results[i] = sampleHit(materialHits[i], frame, frameCache, blockStats[block]);
+        });
+        return std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count()
+            / double(materialHits.size());
+    };
+
+    auto sameSample = [](const CpuScene::MaterialSample& a, const CpuScene::MaterialSample& b)
+    {
+        return all(a.shadingNormal == b.shadingNormal) && all(a.diffuseAlbedo == b.diffuseAlbedo) && all(a.specularF0 == b.specularF0)
+            && all(a.emissiveColor == b.emissiveColor) && a.roughness == b.roughness && a.opacity == b.opacity;
+    };
+
+    log::info("Texel shading cache for %d STF hits on %d threads: %d slots",
+        int(materialHits.size()), int(m_Pool.GetThreadCount() + 1), int(cache.GetCapacity()));
+
+    TexelShadingCacheStats total;
+    uint32_t clears = 0;
+    uint32_t mismatches = 0;
+    double decodedTime = 0.0;
+    double cachedTime = 0.0;
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        // Entries stay valid while the textures and materials do not change, the table is only emptied when it fills
+        if (cache.GetSize() > cache.GetCapacity() / 2)
+        {
+            cache.Clear();
+            clears++;
+        }
+
+        const double frameDecodedTime = timeFrame(frame, nullptr, decodedSamples);
+        const double frameCachedTime = timeFrame(frame, &cache, cachedSamples);
+        decodedTime += frameDecodedTime;
+        cachedTime += frameCachedTime;
+
+        TexelShadingCacheStats stats;
+        for (const TexelShadingCacheStats& block : blockStats)
+            stats += block;
+        total += stats;
+
+        for (size_t i = 0; i < materialHits.size(); i++)
+            mismatches += sameSample(decodedSamples[i], cachedSamples[i]) ? 0 : 1;
+
+        log::info("Frame %d: hit rate %.1f%%, %.1f%% of the hits from earlier frames, %d entries, decoded %.1f ns/sample, cached %.1f ns/sample",
+            int(frame), stats.GetHitRate() * 100.0, stats.hits ? double(stats.frameHits) / double(stats.hits) * 100.0 : 0.0,
+            int(cache.GetSize()), frameDecodedTime, frameCachedTime);
+    }
+
+    log::info("Over %d frames: %.1f%% of the samples bypassed the cache, hit rate %.1f%% (%.1f%% within a frame, %.1f%% across frames), "
+        "%d inserts, %d dropped, %d clears, decoded %.1f ns/sample, cached %.1f ns/sample, %d results differ",
+        int(frameCount), double(total.bypassed) / double(total.samples) * 100.0, total.GetHitRate() * 100.0,
+        total.lookups ? double(total.hits - total.frameHits) / double(total.lookups) * 100.0 : 0.0,
+        total.lookups ? double(total.frameHits) / double(total.lookups) * 100.0 : 0.0,
+        int(total.inserts), int(total.dropped), int(clears), decodedTime / double(frameCount), cachedTime / double(frameCount), int(mismatches));
+}
+
+void CpuRayTracer::BenchmarkGaussianSigmaLod(const LightingConstants& constants) const
+{
+    const PlanarViewConstants& view = constants.view;
+    if (uint32_t(view.viewportSize.x) == 0 || uint32_t(view.viewportSize.y) == 0 || m_Scene.GetTriangles().empty())
+        return;
+
+    std::vector<PrimaryHit> primaryHits;
+    TracePrimaryHits(view, primaryHits);
+
+    struct TextureHit
+    {
+        const StfCpuTexture* texture;
+        float2 texcoord;
+        float2 texGradX;
+        float2 texGradY;
+    };
+
+    // A subset spread over the frame, every hit costs gridSize^2 * mipStrata taps per sigma and method
+    constexpr size_t maxHits = 256;
+    std::vector<TextureHit> textureHits;
+    const size_t stride = std::max<size_t>(primaryHits.size() / maxHits, 1);
+    for (size_t i = 0; i < primaryHits.size() && textureHits.size() < maxHits; i += stride)
+    {
+        const PrimaryHit& primary = primaryHits[i];
+        const CpuScene::GeometrySample gs = m_Scene.GetGeometrySample(primary.hit.triangle, primary.hit.barycentrics);
+        if (gs.material->baseTexture < 0)
+            continue;
+
+        TextureHit textureHit;
+        textureHit.texture = &m_Scene.GetTextures()[gs.material->baseTexture];
+        textureHit.texcoord = gs.texcoord;
+        ComputeTextureGradients(primary.hit, primary.direction, primary.pixel, view, textureHit.texGradX, textureHit.texGradY);
+        textureHits.push_back(textureHit);
+    }
+
+    if (textureHits.empty())
+    {
+        log::warning("No textured hits to benchmark the Gaussian sigma LOD on");
+        return;
+    }
+
+    const float targetSigma = constants.stfSigmaLodTarget > 0.f ? constants.stfSigmaLodTarget : 1.f;
+    const float3 lumaWeights = float3(0.2126f, 0.7152f, 0.0722f);
+    constexpr uint32_t gridSize = 32;
+    constexpr uint32_t mipStrata = 4;
+    constexpr float tapCount = float(gridSize * gridSize * mipStrata);
+
+    struct Moments
+    {
+        float mean = 0.f;
+        float variance = 0.f;
+        size_t texels = 0;
+        float mip = 0.f;
+    };
+
+    // The expected luma of the taps of one hit and its variance, from a midpoint grid over the random numbers
+    auto integrate = [&](const TextureHit& hit, StfCpuSamplerState state)
+    {
+        Moments moments;
+        std::unordered_set<uint64_t> texels;
+        float sum = 0.f;
+        float sumSquares = 0.f;
+        for (uint32_t w = 0; w < mipStrata; w++)
+        {
+            for (uint32_t y = 0; y < gridSize; y++)
+            {
+                for (uint32_t x = 0; x < gridSize; x++)
+                {
+                    state.u = float4((float(x) + 0.5f) / gridSize, (float(y) + 0.5f) / gridSize, 0.f, (float(w) + 0.5f) / mipStrata);
+                    const StfCpuTap tap = state.GetTapGrad(*hit.texture, hit.texcoord, hit.texGradX, hit.texGradY);
+                    const float luma = dot(hit.texture->Load(tap).xyz(), lumaWeights);
+                    sum += luma;
+                    sumSquares += luma * luma;
+                    moments.mip += float(tap.mip);
+                    texels.insert((uint64_t(tap.mip) << 48) | (uint64_t(uint32_t(tap.texel.y)) << 24) | uint64_t(uint32_t(tap.texel.x)));
+                }
+            }
+        }
+        moments.mean = sum / tapCount;
+        moments.variance = std::max(sumSquares / tapCount - moments.mean * moments.mean, 0.f);
+        moments.texels = texels.size();
+        moments.mip /= tapCount;
+        return moments;
+    };
+
+    StfCpuSamplerState baseState;
+    baseState.filterType = STF_FILTER_TYPE_GAUSSIAN;
+    baseState.addressMode = constants.stfAddressMode;
+    baseState.anisoMethod = constants.stfMinificationMethod;
+
+    log::info("Gaussian sigma LOD on %d textured hits, target sigma %.2f, %d taps per hit:", int(textureHits.size()), targetSigma, int(tapCount));
+    for (float sigma : { 0.5f, 1.f, 2.f, 4.f, 8.f, 16.f, 32.f, 64.f })
+    {
+        StfCpuSamplerState footprintState = baseState;
+        footprintState.sigma = sigma;
+        StfCpuSamplerState lodState = footprintState;
+        lodState.sigmaLodTarget = targetSigma;
+
+        std::vector<Moments> footprint(textureHits.size());
+        std::vector<Moments> lod(textureHits.size());
+        const auto start = std::chrono::high_resolution_clock::now();
+        m_Pool.ParallelFor(uint32_t(textureHits.size()), [&](uint32_t i)
+        {
+            footprint[i] = integrate(textureHits[i], footprintState);
+            lod[i] = integrate(textureHits[i], lodState);
+        });
+        const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        double squaredError = 0.0;
+        double footprintVariance = 0.0;
+        double lodVariance = 0.0;
+        double footprintTexels = 0.0;
+        double lodTexels = 0.0;
+        double mipOffset = 0.0;
+        for (size_t i = 0; i < textureHits.size(); i++)
+        {
+            const double error = double(lod[i].mean) - double(footprint[i].mean);
+            squaredError += error * error;
+            footprintVariance += footprint[i].variance;
+            lodVariance += lod[i].variance;
+            footprintTexels += double(footprint[i].texels);
+            lodTexels += double(lod[i].texels);
+            mipOffset += double(lod[i].mip) - double(footprint[i].mip);
+        }
+
+        const double hits = double(textureHits.size());
+        const double frameVariance = 1.0 / (255.0 * 255.0);
+        log::info("  sigma %5.1f: %+.2f mips, luma RMSE %.5f of the expectation, one tap std dev %.4f on the footprint mip and %.4f with LOD "
+            "(%.0f and %.0f frames to 1/255), %.0f and %.0f texels per pixel, %.0f ms",
+            sigma, mipOffset / hits, std::sqrt(squaredError / hits), std::sqrt(footprintVariance / hits), std::sqrt(lodVariance / hits),
+            std::ceil(footprintVariance / hits / frameVariance), std::ceil(lodVariance / hits / frameVariance), footprintTexels / hits,
+            lodTexels / hits, milliseconds);
+    }
+}
+
+void CpuRayTracer::BenchmarkAnisotropicFiltering(const LightingConstants& constants) const
+{
+    const PlanarViewConstants& view = constants.view;
+    if (uint32_t(view.viewportSize.x) == 0 || uint32_t(view.viewportSize.y) == 0 || m_Scene.GetTriangles().empty())
+        return;
+
+    std::vector<PrimaryHit> primaryHits;
+    TracePrimaryHits(view, primaryHits);
+
+    struct TextureHit
+    {
+        const StfCpuTexture* texture;
+        float2 texcoord;
+        float2 texGradX;
+        float2 texGradY;
+    };
+
+    // The anisotropy of the ellipse before the clamp, in texels of the base level
+    constexpr float grazingAnisotropy = 4.f;
+    std::vector<TextureHit> allHits;
+    std::vector<TextureHit> grazingHits;
+    for (const PrimaryHit& primary : primaryHits)
+    {
+        const CpuScene::GeometrySample gs = m_Scene.GetGeometrySample(primary.hit.triangle, primary.hit.barycentrics);
+        if (gs.material->baseTexture < 0)
+            continue;
+
+        TextureHit textureHit;
+        textureHit.texture = &m_Scene.GetTextures()[gs.material->baseTexture];
+        textureHit.texcoord = gs.texcoord;
+        ComputeTextureGradients(primary.hit, primary.direction, primary.pixel, view, textureHit.texGradX, textureHit.texGradY);
+        allHits.push_back(textureHit);
+
+        const float2 size = float2(textureHit.texture->GetSize(0));
+        const float2 dx = textureHit.texGradX * size;
+        const float2 dy = textureHit.texGradY * size;
+        const float area = std::abs(dx.x * dy.y - dx.y * dy.x);
+        const float a = dot(dx, dx) + dot(dy, dy);
+        // major / minor from the sum of the squared semi-axes and their product, the area
+        const float root = std::sqrt(std::max(a * a - 4.f * area * area, 0.f));
+        const float major2 = 0.5f * (a + root);
+        const float minor2 = 0.5f * (a - root);
+        if (minor2 * grazingAnisotropy * grazingAnisotropy <= major2)
+            grazingHits.push_back(textureHit);
+    }
+
+    if (allHits.empty())
+    {
+        log::warning("No textured hits to benchmark the anisotropic filtering on");
+        return;
+    }
+
+    // A subset spread over each group, every hit costs gridSize^2 * mipStrata taps per method plus the reference
+    constexpr size_t maxHits = 256;
+    auto subsample = [&](const std::vector<TextureHit>& hits)
+    {
+        std::vector<TextureHit> subset;
+        const size_t stride = std::max<size_t>(hits.size() / maxHits, 1);
+        for (size_t i = 0; i < hits.size() && subset.size() < maxHits; i += stride)
+            subset.push_back(hits[i]);
+        return subset;
+    };
+
+    const float3 lumaWeights = float3(0.2126f, 0.7152f, 0.0722f);
+    constexpr uint32_t gridSize = 32;
+    constexpr uint32_t mipStrata = 4;
+    constexpr float tapCount = float(gridSize * gridSize * mipStrata);
+
+    struct Moments
+    {
+        float mean = 0.f;
+        float variance = 0.f;
+        size_t texels = 0;
+    };
+
+    // The expected luma of the taps of one hit and its variance, from a midpoint grid over the random numbers
+    auto integrate = [&](const TextureHit& hit, StfCpuSamplerState state)
+    {
+        Moments moments;
+        std::unordered_set<uint64_t> texels;
+        float sum = 0.f;
+        float sumSquares = 0.f;
+        for (uint32_t w = 0; w < mipStrata; w++)
+        {
+            for (uint32_t y = 0; y < gridSize; y++)
+            {
+                for (uint32_t x = 0; x < gridSize; x++)
+                {
+                    state.u = float4((float(x) + 0.5f) / gridSize, (float(y) + 0.5f) / gridSize, 0.f, (float(w) + 0.5f) / mipStrata);
+                    const StfCpuTap tap = state.GetTapGrad(*hit.texture, hit.texcoord, hit.texGradX, hit.texGradY);
+                    const float luma = dot(hit.texture->Load(tap).xyz(), lumaWeights);
+                    sum += luma;
+                    sumSquares += luma * luma;
+                    texels.insert((uint64_t(tap.mip) << 48) | (uint64_t(uint32_t(tap.texel.y)) << 24) | uint64_t(uint32_t(tap.texel.x)));
+                }
+            }
+        }
+        moments.mean = sum / tapCount;
+        moments.variance = std::max(sumSquares / tapCount - moments.mean * moments.mean, 0.f);
+        moments.texels = texels.size();
+        return moments;
+    };
+
+    struct Method
+    {
+        const char* name;
+        uint32_t anisoMethod;
+        bool ewaEnabled;
+    };
+    const Method methods[] = {
+        { "None", STF_ANISO_LOD_METHOD_NONE, false }, { "Aniso", STF_ANISO_LOD_METHOD_DEFAULT, false }, { "Ewa", STF_ANISO_LOD_METHOD_DEFAULT, true }
+    };
+
+    StfCpuSamplerState baseState;
+    baseState.filterType = STF_FILTER_TYPE_LINEAR;
+    baseState.addressMode = constants.stfAddressMode;
+
+    log::info("Anisotropic filtering on %d textured hits, %d with an anisotropy of at least %.0f, %d taps per hit, against deterministic EWA:",
+        int(allHits.size()), int(grazingHits.size()), grazingAnisotropy, int(tapCount));
+    struct Group
+    {
+        const char* name;
+        const std::vector<TextureHit>* hits;
+    };
+    const Group groups[] = { { "grazing", &grazingHits }, { "all", &allHits } };
+
+    for (const Group& group : groups)
+    {
+        const std::vector<TextureHit> hits = subsample(*group.hits);
+        if (hits.empty())
+            continue;
+
+        std::vector<float> reference(hits.size());
+        m_Pool.ParallelFor(uint32_t(hits.size()), [&](uint32_t i)
+        {
+            const float4 value = SampleEwaReference(*hits[i].texture, hits[i].texcoord, hits[i].texGradX, hits[i].texGradY, baseState.addressMode);
+            reference[i] = dot(value.xyz(), lumaWeights);
+        });
+
+        for (const Method& method : methods)
+        {
+            StfCpuSamplerState state = baseState;
+            state.anisoMethod = method.anisoMethod;
+            state.ewaEnabled = method.ewaEnabled;
+
+            std::vector<Moments> moments(hits.size());
+            m_Pool.ParallelFor(uint32_t(hits.size()), [&](uint32_t i)
+            {
+                moments[i] = integrate(hits[i], state);
+            });
+
+            double squaredError = 0.0;
+            double variance = 0.0;
+            double texels = 0.0;
+            for (size_t i = 0; i < hits.size(); i++)
+            {
+                const double error = double(moments[i].mean) - double(reference[i]);
+                squaredError += error * error;
+                variance += moments[i].variance;
+                texels += double(moments[i].texels);
+            }
+
+            const double count = double(hits.size());
+            log::info("  %-7s %-5s: luma RMSE %.5f of the expectation, one tap std dev %.4f, %.1f texels per pixel",
+                group.name, method.name, std::sqrt(squaredError / count), std::sqrt(variance / count), texels / count);
+        }
+    }
+}
+
+void CpuRayTracer::BenchmarkOpacityMicromaps(const LightingConstants& constants, const OpacityMicromaps& micromaps) const
+{
+    const PlanarViewConstants& view = constants.view;
+    const uint32_t width = uint32_t(view.viewportSize.x);
+    const uint32_t height = uint32_t(view.viewportSize.y);
+    if (width == 0 || height == 0 || m_Scene.GetTriangles().empty())
+        return;
+
+    struct PassResult
+    {
+        std::vector<uint32_t> hitTriangles;     // per pixel
+        std::vector<uint8_t> shadowed;
+        std::atomic<uint64_t> candidates = 0;   // any-hit invocations without micromaps
+        std::atomic<uint64_t> alphaTests = 0;   // the ones that still sample the opacity
+        double milliseconds = 0.0;
+    };
+
+    // The primary and shadow rays of a frame, counting the candidate hits on alpha-tested triangles
+    auto tracePass = [&](const OpacityMicromaps* passMicromaps, PassResult& result)
+    {
+        result.hitTriangles.assign(size_t(width) * height, ~0u);
+        result.shadowed.assign(size_t(width) * height, 0);
+
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        m_Pool.ParallelFor(height, [&](uint32_t y)
+        {
+            uint64_t candidates = 0;
+            uint64_t alphaTests = 0;
+            const CpuBvh::AnyHitFunction anyHit = [&](uint32_t, uint32_t triangle, float2 barycentrics)
+            {
+                candidates++;
+                if (passMicromaps)
+                {
+                    const OmmState state = passMicromaps->GetState(triangle, barycentrics);
+                    if (OpacityMicromaps::IsKnown(state))
+                        return state == OmmState::Opaque;
+                }
+
+                alphaTests++;
+                return m_Scene.ConsiderTransparentMaterial(triangle, barycentrics);
+            };
+
+            for (uint32_t blockX = 0; blockX < width; blockX += CpuBvh::PacketWidth)
+            {
+                CpuRay rays[CpuBvh::PacketWidth];
+                const uint32_t rayCount = std::min(width - blockX, CpuBvh::PacketWidth);
+                for (uint32_t lane = 0; lane < rayCount; lane++)
+                    rays[lane] = SetupPrimaryRay(uint2(blockX + lane, y), view);
+
+                CpuRayHit hits[CpuBvh::PacketWidth];
+                m_Bvh.TraceClosest(rays, rayCount, anyHit, hits);
+
+                CpuRay shadowRays[CpuBvh::PacketWidth];
+                uint32_t shadowLanes[CpuBvh::PacketWidth];
+                uint32_t shadowRayCount = 0;
+                for (uint32_t lane = 0; lane < rayCount; lane++)
+                {
+                    result.hitTriangles[size_t(y) * width + blockX + lane] = hits[lane].triangle;
+                    if (hits[lane].triangle == ~0u)
+                        continue;
+
+                    const CpuScene::GeometrySample gs = m_Scene.GetGeometrySample(hits[lane].triangle, hits[lane].barycentrics);
+                    shadowRays[shadowRayCount] = SetupShadowRay(gs.transform->transformPoint(gs.objectSpacePosition), rays[lane].direction, constants.light);
+                    shadowLanes[shadowRayCount] = lane;
+                    shadowRayCount++;
+                }
+
+                bool occluded[CpuBvh::PacketWidth];
+                m_Bvh.TraceAny(shadowRays, shadowRayCount, anyHit, occluded);
+                for (uint32_t i = 0; i < shadowRayCount; i++)
+                    result.shadowed[size_t(y) * width + blockX + shadowLanes[i]] = occluded[i] ? 1 : 0;
+            }
+
+            result.candidates += candidates;
+            result.alphaTests += alphaTests;
+        });
+
+        result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    };
+
+    PassResult reference;
+    PassResult baked;
+    tracePass(nullptr, reference);
+    tracePass(&micromaps, baked);
+
+    uint32_t differences = 0;
+    for (size_t i = 0; i < reference.hitTriangles.size(); i++)
+    {
+        if (reference.hitTriangles[i] != baked.hitTriangles[i] || reference.shadowed[i] != baked.shadowed[i])
+            differences++;
+    }
+
+    const uint64_t candidates = reference.candidates;
+    const uint64_t alphaTests = baked.alphaTests;
+    log::info("Alpha-tested candidate hits of the primary and shadow rays: %llu, %llu still alpha tested with opacity micromaps (%.1f%% skipped)",
+        (unsigned long long)candidates, (unsigned long long)alphaTests,
+        candidates ? 100.0 * double(candidates - alphaTests) / double(candidates) : 0.0);
+    log::info("Frame traced in %.1f ms without and %.1f ms with opacity micromaps, %d pixels differ",
+        reference.milliseconds, baked.milliseconds, int(differences));
+}
+
+void CpuRayTracer::RecordTexelTrace(const LightingConstants& constants, bool stfEnabled, const CpuDispatchOrder& order, TexelTrace& trace) const
+{
+    const PlanarViewConstants& view = constants.view;
+    const uint2 viewportSize = uint2(uint32_t(view.viewportSize.x), uint32_t(view.viewportSize.y));
+
+    trace.SetTextures(m_Scene.GetTextures());
+    trace.Clear();
+    if (viewportSize.x == 0 || viewportSize.y == 0 || m_Scene.GetTriangles().empty())
+        return;
+
+    assert(order.waveWidth >= 4 && order.waveWidth <= c_MaxWaveLanes && order.waveWidth % 4 == 0);
+
+    const CpuBvh::AnyHitFunction anyHit = [this](uint32_t, uint32_t triangle, float2 barycentrics)
+    {
+        return ConsiderTransparentMaterial(triangle, barycentrics);
+    };
+
+    const std::vector<CpuScene::Material>& materials = m_Scene.GetMaterials();
+    const std::vector<CpuScene::Geometry>& geometries = m_Scene.GetGeometries();
+    const uint2 groupCount = order.GetGroupCount(viewportSize);
+
+    // Every group records its own requests, appended in group order afterwards
+    std::vector<TexelTrace> groupTraces(size_t(groupCount.x) * groupCount.y, TexelTrace(trace.GetLayout()));
+    m_Pool.ParallelFor(uint32_t(groupTraces.size()), [&](uint32_t groupIndex)
+    {
+        TexelTrace& groupTrace = groupTraces[groupIndex];
+        std::vector<uint2> pixels;
+        order.GetGroupPixels(order.GetGroup(groupIndex, groupCount), viewportSize, pixels);
+
+        std::vector<StfCpuTap> fetches;
+        for (uint32_t waveStart = 0; waveStart < uint32_t(pixels.size()); waveStart += order.waveWidth)
+        {
+            const uint32_t threadCount = std::min(order.waveWidth, uint32_t(pixels.size()) - waveStart);
+            const uint32_t laneCount = (threadCount + 3) & ~3u;
+
+            StfCpuWaveLane lanes[c_MaxWaveLanes];
+            StfCpuSamplerState samplerStates[c_MaxWaveLanes];
+            const CpuScene::Material* laneMaterials[c_MaxWaveLanes] = {};
+
+            for (uint32_t packetStart = 0; packetStart < threadCount; packetStart += CpuBvh::PacketWidth)
+            {
+                CpuRay rays[CpuBvh::PacketWidth];
+                uint32_t rayLanes[CpuBvh::PacketWidth];
+                uint32_t rayCount = 0;
+                for (uint32_t lane = packetStart; lane < std::min(packetStart + CpuBvh::PacketWidth, threadCount); lane++)
+                {
+                    const uint2 pixel = pixels[waveStart + lane];
+                    if (pixel.x == ~0u)
+                        continue;
+
+                    rays[rayCount] = SetupPrimaryRay(pixel, view);
+                    rayLanes[rayCount] = lane;
+                    rayCount++;
+                }
+
+                CpuRayHit hits[CpuBvh::PacketWidth];
+                m_Bvh.TraceClosest(rays, rayCount, anyHit, hits);
+
+                for (uint32_t i = 0; i < rayCount; i++)
+                {
+                    if (hits[i].triangle == ~0u)
+                        continue;
+
+                    const uint32_t lane = rayLanes[i];
+                    const uint2 pixel = pixels[waveStart + lane];
+                    const CpuScene::GeometrySample gs = m_Scene.GetGeometrySample(hits[i].triangle, hits[i].barycentrics);
+                    laneMaterials[lane] = &materials[geometries[m_Scene.GetTriangles()[hits[i].triangle].geometry].material];
+
+                    StfCpuWaveLane& waveLane = lanes[lane];
+                    ComputeTextureGradients(hits[i], rays[i].direction, pixel, view, waveLane.ddx, waveLane.ddy);
+                    waveLane.uv = gs.texcoord;
+                    waveLane.stfEnabled = stfEnabled && !laneMaterials[lane]->alphaTested &&
+                        !(constants.stfSplitScreen && float(pixel.x) > view.viewportSize.x / 2.f);
+
+                    samplerStates[lane] = CreateSamplerState(constants, m_Scene.GetNoise(pixel, constants.stfFrameIndex, constants.stfUseWhiteNoise != 0,
+                        constants.stfTemporalStrata, constants.stfTemporalGenerator));
+                    waveLane.state = &samplerStates[lane];
+                }
+            }
+
+            // Same order as SampleMaterial, one request per distinct texture of a slot
+            auto sampleTexture = [&](int CpuScene::Material::* slot)
+            {
+                bool done[c_MaxWaveLanes] = {};
+                for (uint32_t first = 0; first < threadCount; first++)
+                {
+                    if (done[first] || !laneMaterials[first] || laneMaterials[first]->*slot < 0)
+                        continue;
+
+                    const int textureIndex = laneMaterials[first]->*slot;
+                    for (uint32_t lane = 0; lane < laneCount; lane++)
+                    {
+                        lanes[lane].participates = laneMaterials[lane] && laneMaterials[lane]->*slot == textureIndex;
+                        done[lane] = done[lane] || lanes[lane].participates;
+                    }
+
+                    StfSamplingCounters counters;
+                    fetches.clear();
+                    StfCpuSampleWaveGrad(m_Scene.GetTextures()[textureIndex], constants.stfMagnificationMethod, false,
+                        lanes, laneCount, counters, &fetches);
+
+                    groupTrace.BeginRequest(groupIndex);
+                    for (const StfCpuTap& fetch : fetches)
+                        groupTrace.Add(trace.GetAddress(uint32_t(textureIndex), fetch));
+                }
+            };
+
+            sampleTexture(&CpuScene::Material::baseTexture);
+            sampleTexture(&CpuScene::Material::emissiveTexture);
+            sampleTexture(&CpuScene::Material::normalTexture);
+            sampleTexture(&CpuScene::Material::metalRoughTexture);
+        }
+    });
+
+    for (const TexelTrace& groupTrace : groupTraces)
+        trace.Append(groupTrace);
+}
@@ -0,0 +1,108 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "CpuBvh.h"
+#include "CpuScene.h"
+#include "TaskGraph.h"
+#include "TexelTrace.h"
+
+#include <donut/core/math/math.h>
+
+#include <vector>
+
+class OpacityMicromaps;
+struct LightingConstants;
+struct PlanarViewConstants;
+
+// CPU port of stf_bindless_rendering.hlsl main(): primary rays, alpha-tested any-hit, STF or hardware-like material
+// sampling with texture gradients from ray differentials, bent normals, one shadow ray and sun plus ambient
+// shading. Meant for STF frames on machines without a ray tracing GPU.
+class CpuRayTracer
+{
+public:
+    CpuRayTracer(ThreadPool& pool, const CpuScene& scene);
+
+    // Builds the BVH over the scene triangles
+    void Init();
+
+    // Alpha-tested hits on micro-triangles of a known state skip the alpha test, null tests every hit
+    void SetOpacityMicromaps(const OpacityMicromaps* micromaps) { m_Micromaps = micromaps; }
+
+    // One frame for every pixel of constants.view. stfEnabled is STF_ENABLED of the shader permutation.
+    // output receives viewportSize.x * viewportSize.y linear values, row by row.
+    void Render(const LightingConstants& constants, bool stfEnabled, std::vector<dm::float4>& output) const;
+
+    // Traces the primary hits of one frame, then times the texture gradients from the ray differentials against the
+    // gradients from intersecting the neighbor pixel rays with the hit triangle, and logs the cost per pixel and the
+    // difference between the two.
+    void BenchmarkTextureGradients(const LightingConstants& constants) const;
+
+    // Times the STF material samples of the primary hits of one frame with a footprint per texture against one per
+    // footprint class (StfCpuSharedFootprint), and logs the footprint evaluations and time saved per material.
+    void BenchmarkMaterialSampling(const LightingConstants& constants) const;
+
+    // Samples the STF materials of the primary hits of frameCount frames, the camera held still, once decoding every
+    // sample and once through a TexelShadingCache kept across the frames, and logs per frame the hit rate, the share of
+    // hits on entries of earlier frames and the time per sample of both. Both use shared footprints without reseeding
+    // or multi-tap, like BenchmarkMaterialSampling; samples whose textures do not share one tap bypass the cache.
+    void BenchmarkTexelShadingCache(const LightingConstants& constants, uint32_t frameCount) const;
+
+    // Integrates the Gaussian STF taps of the base color of the primary hits of one frame over a grid of random
+    // numbers for a range of sigmas, on the mip of the footprint and with the sigma LOD of stf_sigma_lod.h at the
+    // target of the constants, and logs the luma error of the expected values between the two, the standard deviation
+    // of one tap and the distinct texels per pixel of both.
+    void BenchmarkGaussianSigmaLod(const LightingConstants& constants) const;
+
+    // Integrates the bilinear STF taps of the base color of the primary hits of one frame over a grid of random
+    // numbers with STF_ANISO_LOD_METHOD_NONE, DEFAULT and the EWA of stf_ewa.h, and logs the luma error of the
+    // expected values against SampleEwaReference, the standard deviation of one tap and the distinct texels per pixel,
+    // for the grazing hits whose footprint is at least 4 times longer than wide and for all hits.
+    void BenchmarkAnisotropicFiltering(const LightingConstants& constants) const;
+
+    // Traces the primary and shadow rays of one frame with and without the micromaps, and logs how many candidate
+    // hits on alpha-tested triangles still run the alpha test, the trace times and the pixels whose hit or shadow
+    // changed, which should be none.
+    void BenchmarkOpacityMicromaps(const LightingConstants& constants, const OpacityMicromaps& micromaps) const;
+
+    // Records the texel fetches of the STF material samples of one frame, wave by wave in the dispatch order of the
+    // compute pipeline, with the magnification method of the constants. Lanes sampling different textures record
+    // one request per texture. Shading, shadow rays and the hardware sampler fetches of non-STF lanes are left out.
+    void RecordTexelTrace(const LightingConstants& constants, bool stfEnabled, const CpuDispatchOrder& order, TexelTrace& trace) const;
+
+private:
+    struct SamplingParameters;
+
+    struct PrimaryHit
+    {
+        CpuRayHit hit;
+        dm::float3 direction;
+        dm::uint2 pixel;
+    };
+
+    ThreadPool& m_Pool;
+    const CpuScene& m_Scene;
+    CpuBvh m_Bvh;
+    const OpacityMicromaps* m_Micromaps = nullptr;
+
+    // The any-hit function of the traces, CpuScene::ConsiderTransparentMaterial after the micromap lookup
+    bool ConsiderTransparentMaterial(uint32_t triangle, dm::float2 barycentrics) const;
+
+    CpuScene::MaterialSample SampleMaterial(const CpuScene::GeometrySample& gs, dm::float2 texGradX, dm::float2 texGradY,
+        bool forceMipLevel, float mipLevel, const SamplingParameters& sampling) const;
+    void TracePrimaryHits(const PlanarViewConstants& view, std::vector<PrimaryHit>& primaryHits) const;
+    // texGrad_x/y of shadeSurface for a primary hit, from the camera ray differential and the triangle's Jacobian
+    void ComputeTextureGradients(const CpuRayHit& hit, dm::float3 rayDirection, dm::uint2 pixel, const PlanarViewConstants& view,
+        dm::float2& texGradX, dm::float2& texGradY) const;
+    // The same from the texture coordinates where the rays of the right and lower neighbor pixels cross the hit triangle
+    void ComputeNeighborRayTextureGradients(const CpuRayHit& hit, dm::uint2 pixel, const PlanarViewConstants& view,
+        dm::float2& texGradX, dm::float2& texGradY) const;
+};
@@ -0,0 +1,362 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "CpuScene.h"
+
+#include <donut/core/log.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/SceneTypes.h>
+#include <donut/engine/TextureCache.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <unordered_map>
+
+using namespace donut;
+using namespace donut::math;
+
+#include "stf_temporal_strata.h"
+
+namespace
+{
+    constexpr float c_DielectricSpecular = 0.04f;
+
+    // Unpack_RGB8_SNORM and Unpack_RGBA8_SNORM
+    float4 UnpackRgba8Snorm(uint32_t value)
+    {
+        const int x = int32_t(value << 24) >> 24;
+        const int y = int32_t(value << 16) >> 24;
+        const int z = int32_t(value << 8) >> 24;
+        const int w = int32_t(value) >> 24;
+        return float4(float(x), float(y), float(z), float(w)) / 127.f;
+    }
+
+    // Block compressed DDS files have no CPU decoder, glTF files using MSFT_texture_dds usually ship the source image too
+    bool DecodeTextureFile(engine::TextureCache& textureCache, const std::filesystem::path& fileName, bool sRGB, CpuImage& image)
+    {
+        if (DecodeImageFile(textureCache, fileName, sRGB, image))
+            return true;
+
+        for (const char* extension : { ".png", ".jpg", ".jpeg", ".tga" })
+        {
+            std::filesystem::path sibling = fileName;
+            sibling.replace_extension(extension);
+
+            std::error_code ec;
+            if (sibling != fileName && std::filesystem::exists(sibling, ec) && DecodeImageFile(textureCache, sibling, sRGB, image))
+                return true;
+        }
+
+        return false;
+    }
+}
+
+CpuScene::CpuScene(ThreadPool& pool)
+    : m_Pool(pool)
+{
+}
+
+bool CpuScene::Init(const engine::SceneGraph& sceneGraph, engine::TextureCache& textureCache, const std::filesystem::path& blueNoiseFileName)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    m_Materials.clear();
+    m_Geometries.clear();
+    m_Triangles.clear();
+    m_Textures.clear();
+    m_TextureNames.clear();
+
+    struct TextureRequest
+    {
+        std::filesystem::path path;
+        bool sRGB = false;
+    };
+    std::vector<TextureRequest> textureRequests;
+    std::map<std::pair<std::string, bool>, int> textureIndices;
+    std::unordered_map<const engine::Material*, uint32_t> materialIndices;
+
+    auto getTexture = [&](const std::shared_ptr<engine::LoadedTexture>& texture, bool enabled, bool sRGB)
+    {
+        if (!texture || !enabled || texture->path.empty())
+            return -1;
+
+        auto [it, inserted] = textureIndices.try_emplace({ texture->path, sRGB }, int(textureRequests.size()));
+        if (inserted)
+            textureRequests.push_back({ texture->path, sRGB });
+        return it->second;
+    };
+
+    // The MaterialConstants the shader reads, for the metal-rough model
+    auto getMaterial = [&](const std::shared_ptr<engine::Material>& source)
+    {
+        auto [it, inserted] = materialIndices.try_emplace(source.get(), uint32_t(m_Materials.size()));
+        if (!inserted)
+            return it->second;
+
+        Material material;
+        if (source)
+        {
+            material.alphaTested = source->domain == engine::MaterialDomain::AlphaTested;
+            material.doubleSided = source->doubleSided;
+            material.baseColor = source->baseOrDiffuseColor;
+            material.opacity = source->opacity;
+            material.alphaCutoff = source->alphaCutoff;
+            material.metalness = source->metalness;
+            material.roughness = source->roughness;
+            material.normalTextureScale = source->normalTextureScale;
+            material.emissiveColor = source->emissiveColor * source->emissiveIntensity;
+            material.baseTexture = getTexture(source->baseOrDiffuseTexture, source->enableBaseOrDiffuseTexture, true);
+            material.metalRoughTexture = getTexture(source->metalRoughOrSpecularTexture, source->enableMetalRoughOrSpecularTexture, false);
+            material.normalTexture = getTexture(source->normalTexture, source->enableNormalTexture, false);
+            material.emissiveTexture = getTexture(source->emissiveTexture, source->enableEmissiveTexture, true);
+        }
+
+        m_Materials.push_back(material);
+        return it->second;
+    };
+
+    for (const auto& instance : sceneGraph.GetMeshInstances())
+    {
+        const std::shared_ptr<engine::MeshInfo>& mesh = instance->GetMesh();
+        if (!mesh || !mesh->buffers || mesh->skinPrototype || mesh->buffers->hasAttribute(engine::VertexAttribute::JointWeights))
+            continue;
+
+        const engine::BufferGroup& buffers = *mesh->buffers;
+        if (buffers.indexData.empty() || buffers.positionData.empty())
+            continue;
+
+        const affine3 transform = instance->GetNode()->GetLocalToWorldTransformFloat();
+
+        for (const auto& meshGeometry : mesh->geometries)
+        {
+            const uint32_t geometryIndex = uint32_t(m_Geometries.size());
+
+            Geometry geometry;
+            geometry.buffers = mesh->buffers;
+            geometry.transform = transform;
+            geometry.material = getMaterial(meshGeometry->material);
+            m_Geometries.push_back(geometry);
+
+            const uint32_t firstIndex = mesh->indexOffset + meshGeometry->indexOffsetInMesh;
+            const uint32_t firstVertex = mesh->vertexOffset + meshGeometry->vertexOffsetInMesh;
+
+            for (uint32_t i = 0; i + 2 < meshGeometry->numIndices; i += 3)
+            {
+                Triangle triangle;
+                triangle.geometry = geometryIndex;
+                for (uint32_t k = 0; k < 3; k++)
+                    triangle.vertices[k] = firstVertex + buffers.indexData[firstIndex + i + k];
+
+                for (uint32_t k = 0; k < 3; k++)
+                    triangle.positions[k] = transform.transformPoint(buffers.positionData[triangle.vertices[k]]);
+
+                triangle.normal = cross(triangle.positions[1] - triangle.positions[0], triangle.positions[2] - triangle.positions[0]);
+                if (!buffers.texcoord1Data.empty())
+                {
+                    float2 texcoords[3];
+                    for (uint32_t k = 0; k < 3; k++)
+                        texcoords[k] = buffers.texcoord1Data[triangle.vertices[k]];
+                    triangle.texcoordJacobian = ComputeTexcoordJacobian(triangle.positions, texcoords);
+                }
+
+                m_Triangles.push_back(triangle);
+            }
+        }
+    }
+
+    if (m_Triangles.empty())
+    {
+        log::error("Found no static geometry with CPU vertex data in the scene");
+        return false;
+    }
+
+    m_Textures.resize(textureRequests.size());
+    for (const TextureRequest& request : textureRequests)
+        m_TextureNames.push_back(request.path.filename().generic_string());
+    m_Pool.ParallelFor(uint32_t(textureRequests.size()), [&](uint32_t i)
+    {
+        CpuImage image;
+        if (DecodeTextureFile(textureCache, textureRequests[i].path, textureRequests[i].sRGB, image))
+            m_Textures[i] = StfCpuTexture(std::move(image));
+        else
+            log::warning("Cannot decode '%s' on the CPU, materials use their untextured values instead", textureRequests[i].path.generic_string().c_str());
+    });
+
+    for (Material& material : m_Materials)
+    {
+        for (int* texture : { &material.baseTexture, &material.metalRoughTexture, &material.normalTexture, &material.emissiveTexture })
+        {
+            if (*texture >= 0 && !m_Textures[*texture].IsValid())
+                *texture = -1;
+        }
+    }
+
+    m_BlueNoise = CpuImage();
+    if (!DecodeImageFile(textureCache, blueNoiseFileName, false, m_BlueNoise) || m_BlueNoise.width < 128 || m_BlueNoise.height < 128 * 64)
+    {
+        log::warning("Cannot load the blue noise texture '%s', the CPU renderers use white noise", blueNoiseFileName.generic_string().c_str());
+        m_BlueNoise = CpuImage();
+    }
+
+    log::info("CPU scene ready in %.1f ms: %d triangles, %d materials, %d textures",
+        std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(),
+        int(m_Triangles.size()), int(m_Materials.size()), int(m_Textures.size()));
+
+    return true;
+}
+
+CpuScene::GeometrySample CpuScene::GetGeometrySample(uint32_t triangleIndex, float2 rayBarycentrics) const
+{
+    const Triangle& triangle = m_Triangles[triangleIndex];
+    const Geometry& geometry = m_Geometries[triangle.geometry];
+    const engine::BufferGroup& buffers = *geometry.buffers;
+
+    GeometrySample gs;
+    gs.material = &m_Materials[geometry.material];
+    gs.transform = &geometry.transform;
+
+    const float3 barycentrics(1.f - (rayBarycentrics.x + rayBarycentrics.y), rayBarycentrics.x, rayBarycentrics.y);
+
+    for (uint32_t i = 0; i < 3; i++)
+        gs.vertexPositions[i] = buffers.positionData[triangle.vertices[i]];
+    gs.objectSpacePosition = Interpolate(gs.vertexPositions, barycentrics);
+
+    if (!buffers.texcoord1Data.empty())
+    {
+        for (uint32_t i = 0; i < 3; i++)
+            gs.vertexTexcoords[i] = buffers.texcoord1Data[triangle.vertices[i]];
+        gs.texcoord = Interpolate(gs.vertexTexcoords, barycentrics);
+    }
+
+    if (!buffers.normalData.empty())
+    {
+        float3 normals[3];
+        for (uint32_t i = 0; i < 3; i++)
+            normals[i] = UnpackRgba8Snorm(buffers.normalData[triangle.vertices[i]]).xyz();
+        gs.geometryNormal = normalize(geometry.transform.transformVector(Interpolate(normals, barycentrics)));
+    }
+
+    if (!buffers.tangentData.empty())
+    {
+        float4 tangents[3];
+        for (uint32_t i = 0; i < 3; i++)
+            tangents[i] = UnpackRgba8Snorm(buffers.tangentData[triangle.vertices[i]]);
+        const float3 tangent = normalize(geometry.transform.transformVector(Interpolate(tangents, barycentrics).xyz()));
+        gs.tangent = float4(tangent, tangents[0].w);
+    }
+
+    const float3 objectSpaceFlatNormal = normalize(cross(
+        gs.vertexPositions[1] - gs.vertexPositions[0],
+        gs.vertexPositions[2] - gs.vertexPositions[0]));
+    gs.flatNormal = normalize(geometry.transform.transformVector(objectSpaceFlatNormal));
+
+    return gs;
+}
+
+CpuScene::MaterialSample CpuScene::EvaluateMaterial(const GeometrySample& gs, const MaterialTextures& textures) const
+{
+    return EvaluateMaterial(gs, DecodeMaterial(*gs.material, textures));
+}
+
+CpuScene::DecodedMaterial CpuScene::DecodeMaterial(const Material& material, const MaterialTextures& textures)
+{
+    const float4& baseOrDiffuse = textures.baseOrDiffuse;
+    const float4& metalRough = textures.metalRoughOrSpecular;
+
+    DecodedMaterial decoded;
+    const float3 baseColor = material.baseColor * baseOrDiffuse.xyz();
+    const float metalness = material.metalness * metalRough.z;
+    decoded.roughness = material.roughness * metalRough.y;
+    decoded.opacity = material.opacity * baseOrDiffuse.w;
+    decoded.diffuseAlbedo = baseColor * ((1.f - c_DielectricSpecular) * (1.f - metalness));
+    decoded.specularF0 = float3(c_DielectricSpecular) * (1.f - metalness) + baseColor * metalness;
+    decoded.emissiveColor = material.emissiveColor * textures.emissive.xyz();
+
+    decoded.localNormal = textures.normal.xyz() * 2.f - 1.f;
+    decoded.localNormal.x *= material.normalTextureScale;
+    decoded.localNormal.y *= material.normalTextureScale;
+
+    return decoded;
+}
+
+CpuScene::MaterialSample CpuScene::EvaluateMaterial(const GeometrySample& gs, const DecodedMaterial& decoded) const
+{
+    const Material& material = *gs.material;
+
+    MaterialSample ms;
+    ms.geometryNormal = normalize(gs.geometryNormal);
+    ms.shadingNormal = ms.geometryNormal;
+    ms.diffuseAlbedo = decoded.diffuseAlbedo;
+    ms.specularF0 = decoded.specularF0;
+    ms.emissiveColor = decoded.emissiveColor;
+    ms.roughness = decoded.roughness;
+    ms.opacity = decoded.opacity;
+
+    // ApplyNormalMap
+    const float tangentLengthSquared = dot(gs.tangent.xyz(), gs.tangent.xyz());
+    if (material.normalTexture >= 0 && tangentLengthSquared > 0.f && material.normalTextureScale != 0.f)
+    {
+        const float3& localNormal = decoded.localNormal;
+        const float3 tangent = gs.tangent.xyz() / std::sqrt(tangentLengthSquared);
+        const float3 bitangent = cross(ms.geometryNormal, tangent) * gs.tangent.w;
+        ms.shadingNormal = normalize(tangent * localNormal.x + bitangent * localNormal.y + ms.geometryNormal * localNormal.z);
+    }
+
+    return ms;
+}
+
+bool CpuScene::ConsiderTransparentMaterial(uint32_t triangleIndex, float2 rayBarycentrics) const
+{
+    const Triangle& triangle = m_Triangles[triangleIndex];
+    const Geometry& geometry = m_Geometries[triangle.geometry];
+    const Material& material = m_Materials[geometry.material];
+
+    if (!material.alphaTested)
+        return true;
+
+    // STF is off for alpha-tested materials, so this is the hardware sampler at mip 0
+    float opacity = material.opacity;
+    if (material.baseTexture >= 0 && !geometry.buffers->texcoord1Data.empty())
+    {
+        const float3 barycentrics(1.f - (rayBarycentrics.x + rayBarycentrics.y), rayBarycentrics.x, rayBarycentrics.y);
+        float2 texcoords[3];
+        for (uint32_t i = 0; i < 3; i++)
+            texcoords[i] = geometry.buffers->texcoord1Data[triangle.vertices[i]];
+
+        opacity *= SampleHardwareLevel(m_Textures[material.baseTexture], Interpolate(texcoords, barycentrics), 0.f).w;
+    }
+
+    return opacity >= material.alphaCutoff;
+}
+
+float3 CpuScene::GetNoise(uint2 pixel, uint32_t frameIndex, bool whiteNoise, uint32_t temporalStrata, uint32_t temporalGenerator) const
+{
+    const uint32_t noiseFrame = GetStfTemporalStrataFrame(frameIndex, temporalStrata);
+
+    float3 u;
+    if (whiteNoise || m_BlueNoise.rgba.empty())
+    {
+        u = CpuRng::SpatioTemporalWhiteNoise3D(pixel, noiseFrame);
+    }
+    else
+    {
+        // RNG::SpatioTemporalBlueNoise2D: the 64 slices of 128x128 are stacked vertically, z is white noise
+        const uint32_t x = pixel.x % 128;
+        const uint32_t y = (noiseFrame % 64) * 128 + pixel.y % 128;
+        const uint8_t* texel = &m_BlueNoise.rgba[(size_t(y) * m_BlueNoise.width + x) * 4];
+
+        uint32_t hash = CpuRng::Hash32Combine(CpuRng::Hash32(noiseFrame + 0x035F9F29u), (pixel.x << 16) | pixel.y);
+        u = float3(float(texel[0]) / 255.f, float(texel[1]) / 255.f, CpuRng::SampleNext1D(hash));
+    }
+
+    return StratifyStfRandom(u, frameIndex, temporalStrata, temporalGenerator);
+}
@@ -0,0 +1,166 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "RayDifferentials.h"
+#include "StfCpuSampler.h"
+#include "TaskGraph.h"
+#include "TextureProcessing.h"
+
+#include <donut/core/math/math.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace donut::engine
+{
+    class SceneGraph;
+    class TextureCache;
+    struct BufferGroup;
+}
+
+// The static meshes of a scene graph in world space, their materials and CPU copies of their textures.
+// Shared by the CPU ray tracer and the CPU rasterizer.
+class CpuScene
+{
+public:
+    struct Material
+    {
+        bool alphaTested = false;
+        bool doubleSided = false;
+        dm::float3 baseColor = 1.f;
+        float opacity = 1.f;
+        float alphaCutoff = 0.5f;
+        float metalness = 0.f;
+        float roughness = 0.f;
+        float normalTextureScale = 1.f;
+        dm::float3 emissiveColor = 0.f;
+        // Indices into the scene textures, -1 when the material does not use the texture
+        int baseTexture = -1;
+        int metalRoughTexture = -1;
+        int normalTexture = -1;
+        int emissiveTexture = -1;
+    };
+
+    // One geometry of one instance
+    struct Geometry
+    {
+        std::shared_ptr<donut::engine::BufferGroup> buffers;
+        dm::affine3 transform;
+        uint32_t material = 0;
+    };
+
+    // Vertex indices into the geometry's buffer group, and the world space values the renderers need
+    struct Triangle
+    {
+        uint32_t geometry = 0;
+        uint32_t vertices[3] = {};
+        dm::float3 positions[3];
+        dm::float3 normal = 0.f; // not normalized, front facing for counter-clockwise vertices
+        TexcoordJacobian texcoordJacobian;
+    };
+
+    // getGeometryFromHit
+    struct GeometrySample
+    {
+        const Material* material = nullptr;
+        const dm::affine3* transform = nullptr;
+
+        dm::float3 vertexPositions[3];  // object space
+        dm::float2 vertexTexcoords[3];
+
+        dm::float3 objectSpacePosition;
+        dm::float2 texcoord;
+        dm::float3 flatNormal;
+        dm::float3 geometryNormal;
+        dm::float4 tangent;
+    };
+
+    // MaterialTextureSample, with the defaults of DefaultMaterialTextures
+    struct MaterialTextures
+    {
+        dm::float4 baseOrDiffuse = 1.f;
+        dm::float4 metalRoughOrSpecular = 1.f;
+        dm::float4 normal = dm::float4(0.5f, 0.5f, 1.f, 0.f);
+        dm::float4 emissive = 1.f;
+    };
+
+    struct MaterialSample
+    {
+        dm::float3 shadingNormal;
+        dm::float3 geometryNormal;
+        dm::float3 diffuseAlbedo;
+        dm::float3 specularF0;
+        dm::float3 emissiveColor;
+        float roughness = 0.f;
+        float opacity = 1.f;
+    };
+
+    // The part of a material sample that only depends on the material and its texels: the albedo conversions of
+    // the metal-rough model and the decoded, scaled tangent space normal. The tangent frame of the hit is applied later.
+    struct DecodedMaterial
+    {
+        dm::float3 diffuseAlbedo;
+        dm::float3 specularF0;
+        dm::float3 emissiveColor;
+        dm::float3 localNormal;
+        float roughness = 0.f;
+        float opacity = 1.f;
+    };
+
+    explicit CpuScene(ThreadPool& pool);
+
+    // Takes the static mesh instances of the graph in their current pose and decodes their textures.
+    // Skinned instances are skipped, their vertices only exist on the GPU.
+    bool Init(const donut::engine::SceneGraph& sceneGraph, donut::engine::TextureCache& textureCache,
+        const std::filesystem::path& blueNoiseFileName);
+
+    // barycentrics are the weights of vertex 1 and 2, like the DXR triangle barycentrics
+    [[nodiscard]] GeometrySample GetGeometrySample(uint32_t triangle, dm::float2 barycentrics) const;
+
+    // EvaluateSceneMaterial for the metal-rough model, including ApplyNormalMap
+    [[nodiscard]] MaterialSample EvaluateMaterial(const GeometrySample& gs, const MaterialTextures& textures) const;
+
+    // The same in two steps: the texel decode, which TexelShadingCache can reuse, then ApplyNormalMap for the hit
+    [[nodiscard]] static DecodedMaterial DecodeMaterial(const Material& material, const MaterialTextures& textures);
+    [[nodiscard]] MaterialSample EvaluateMaterial(const GeometrySample& gs, const DecodedMaterial& decoded) const;
+
+    // The alpha test of alpha-tested materials. STF is off for them, so this is the hardware sampler at mip 0.
+    [[nodiscard]] bool ConsiderTransparentMaterial(uint32_t triangle, dm::float2 barycentrics) const;
+
+    // RNG::SpatioTemporalBlueNoise2D, or the white noise when asked for or when the blue noise texture is missing.
+    // With temporalStrata > 1, the noise of the cycle stratified like StratifyStfRandom of stf_temporal_strata.h.
+    [[nodiscard]] dm::float3 GetNoise(dm::uint2 pixel, uint32_t frameIndex, bool whiteNoise, uint32_t temporalStrata = 1,
+        uint32_t temporalGenerator = 1) const;
+
+    [[nodiscard]] const std::vector<Material>& GetMaterials() const { return m_Materials; }
+    [[nodiscard]] const std::vector<Geometry>& GetGeometries() const { return m_Geometries; }
+    [[nodiscard]] const std::vector<Triangle>& GetTriangles() const { return m_Triangles; }
+    [[nodiscard]] const std::vector<StfCpuTexture>& GetTextures() const { return m_Textures; }
+    [[nodiscard]] const std::string& GetTextureName(uint32_t texture) const { return m_TextureNames[texture]; }
+
+    template<typename T>
+    static T Interpolate(const T values[3], dm::float3 barycentrics)
+    {
+        return values[0] * barycentrics.x + values[1] * barycentrics.y + values[2] * barycentrics.z;
+    }
+
+private:
+    ThreadPool& m_Pool;
+    std::vector<Material> m_Materials;
+    std::vector<Geometry> m_Geometries;
+    std::vector<Triangle> m_Triangles;
+    std::vector<StfCpuTexture> m_Textures;
+    std::vector<std::string> m_TextureNames;   // file names
+    CpuImage m_BlueNoise;
+};
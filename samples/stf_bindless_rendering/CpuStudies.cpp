@@ -0,0 +1,861 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "CpuStudies.h"
+#include "CpuRayTracer.h"
+#include "DispatchAutotuner.h"
+#include "ImageMetrics.h"
+#include "NoiseSpectrum.h"
+#include "SceneLoader.h"
+#include "StfConstants.h"
+#include "StfSamplingStats.h"
+#include "TextureProcessing.h"
+#include "../../libraries/RTXTF-Library/STFDefinitions.h"
+
+#include <donut/app/ApplicationBase.h>
+#include <donut/app/Camera.h>
+#include <donut/core/log.h>
+#include <donut/core/vfs/VFS.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/TextureCache.h>
+#include <donut/engine/View.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+using namespace donut;
+using namespace donut::engine;
+using namespace donut::math;
+
+#include "lighting_cb.h"
+#include "stf_temporal_strata.h"
+
+static const float3 c_LumaWeights = float3(0.2126f, 0.7152f, 0.0722f);
+
+// Root mean square over count pixels of the luma of difference(pixel)
+template<typename Difference>
+static double GetLumaRmse(size_t count, Difference difference)
+{
+    double squaredError = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const float error = dot(difference(i), c_LumaWeights);
+        squaredError += double(error) * double(error);
+    }
+    return std::sqrt(squaredError / double(std::max<size_t>(count, 1)));
+}
+
+// The frame loop of the studies: the constants of the UI settings for frame indices firstFrame and on, then
+// renderFrame(). The view stays the one of frame 0.
+template<typename RenderFrame>
+static void RunStudyFrames(const UIData& ui, uint32_t firstFrame, uint32_t frameCount, LightingConstants& constants, RenderFrame renderFrame)
+{
+    for (uint32_t frameIndex = firstFrame; frameIndex < firstFrame + frameCount; frameIndex++)
+    {
+        FillStfConstants(ui, frameIndex, constants);
+        renderFrame();
+    }
+}
+
+// Luma RMSE of the running average of a study's frames against a reference after 1, 2, 4, ... frames and the
+// last frame, as "1: 0.01234, 2: 0.00876, ..."
+class ConvergenceReport
+{
+public:
+    ConvergenceReport(const std::vector<float4>& reference, uint32_t frameCount)
+        : m_Reference(reference)
+        , m_FrameCount(frameCount)
+        , m_Sum(reference.size(), float4(0.f))
+    {
+    }
+
+    void AddFrame(const std::vector<float4>& frame)
+    {
+        for (size_t i = 0; i < m_Sum.size(); i++)
+            m_Sum[i] += frame[i];
+
+        // Powers of two and the last frame
+        const uint32_t frames = ++m_Frames;
+        if ((frames & (frames - 1)) != 0 && frames != m_FrameCount)
+            return;
+
+        const double rmse = GetLumaRmse(m_Sum.size(), [this, frames](size_t i) { return m_Sum[i].xyz() / float(frames) - m_Reference[i].xyz(); });
+
+        char text[64];
+        snprintf(text, sizeof(text), "%s%d: %.5f", m_Text.empty() ? "" : ", ", int(frames), rmse);
+        m_Text += text;
+    }
+
+    [[nodiscard]] const std::string& GetText() const { return m_Text; }
+
+private:
+    const std::vector<float4>& m_Reference;
+    uint32_t m_FrameCount;
+    uint32_t m_Frames = 0;
+    std::vector<float4> m_Sum;
+    std::string m_Text;
+};
+
+static void LogCpuRasterizerStats(const CpuRasterizerStats& stats, const CpuRasterizerOptions& options, uint32_t frameCount)
+{
+    const double lanes = double(std::max<uint64_t>(stats.waves * options.waveWidth, 1));
+    const double samples = double(std::max<uint64_t>(stats.sampling.magnifiedSamples, 1));
+
+    log::info("CPU raster: %.1f ms raster, %.1f ms shading per frame, %.0f quads and %.0f waves of %d lanes (%s packing) per frame",
+        stats.rasterMilliseconds / frameCount, stats.shadingMilliseconds / frameCount, double(stats.quads) / frameCount,
+        double(stats.waves) / frameCount, int(options.waveWidth), options.wavePacking == CpuWavePacking::Draw ? "draw" : "triangle");
+    log::info("CPU raster: %.1f%% active lanes, %.1f%% helper lanes, %.1f%% idle lanes",
+        100.0 * double(stats.activeLanes) / lanes, 100.0 * double(stats.helperLanes) / lanes,
+        100.0 * (1.0 - double(stats.activeLanes + stats.helperLanes) / lanes));
+    log::info("CPU raster: %.0f magnified samples per frame, %.1f%% wave filtered, %.1f%% quad filtered, %.1f%% fallback",
+        double(stats.sampling.magnifiedSamples) / frameCount, 100.0 * double(stats.sampling.waveFilteredSamples) / samples,
+        100.0 * double(stats.sampling.quadFilteredSamples) / samples, 100.0 * double(stats.sampling.fallbackSamples) / samples);
+    log::info("CPU raster: %.2f texels per STF sample, %.1f%% of the lanes sharing loads, %.1f distinct texels per wave",
+        stats.sampling.GetTexelsPerSample(),
+        100.0 * double(stats.sampling.sharingLanes) / double(std::max<uint64_t>(stats.sampling.waves * options.waveWidth, 1)),
+        stats.sampling.GetDistinctTexelsPerWave());
+    if (stats.sampling.constantSamples != 0)
+        log::info("CPU raster: %.1f%% of the STF samples took the constant footprint early-out", 100.0 * stats.sampling.GetConstantRate());
+    if (stats.sampling.extraTaps != 0)
+        log::info("CPU raster: %.2f taps per STF sample with multi-tap STF", stats.sampling.GetTapsPerSample());
+    if (options.deferredTexels)
+        log::info("CPU raster: %.0f resolved pixels and %.0f texels loaded per frame, %.1f ms resolve per frame",
+            double(stats.resolvedPixels) / frameCount, double(stats.resolveTexelsFetched) / frameCount, stats.resolveMilliseconds / frameCount);
+}
+
+static void LogTextureCacheResult(const char* name, const TextureCacheResult& result, const TexelTrace& trace)
+{
+    log::info("%s: %.0f requests, %.0f texels, L1 %.1f%% hits of %.0f lines, L2 %.1f%% hits of %.0f lines, %.2f MB DRAM per frame (textures %.1f MB)",
+        name, double(result.requests), double(result.fetches), 100.0 * result.GetL1HitRate(), double(result.l1Accesses),
+        100.0 * result.GetL2HitRate(), double(result.l2Accesses), double(result.dramBytes) / (1024.0 * 1024.0),
+        double(trace.GetFootprintBytes()) / (1024.0 * 1024.0));
+}
+
+// Records the texel trace of the first frame for every thread group size and lane layout of the compute pipeline
+// and replays each through the cache simulator
+static bool RunTextureCacheStudy(const CpuRayTracer& rayTracer, const LightingConstants& constants, bool stfEnabled, const CpuRenderSettings& settings)
+{
+    const dm::uint2 groupSizes[] = { dm::uint2(8, 8), dm::uint2(16, 8), dm::uint2(8, 16), dm::uint2(16, 16) };
+    const char* const layoutNames[] = { "None", "RowLinear16x2", "QuadZ16x2" };
+    static_assert(std::size(groupSizes) == size_t(StfThreadGroupSize::_16x16) + 1);
+
+    const TextureCacheConfig& config = settings.cacheConfig;
+    bool succeeded = true;
+    TexelTrace trace;
+
+    if (!settings.texelTraceFileName.empty())
+    {
+        CpuDispatchOrder order;
+        order.groupSize = groupSizes[uint32_t(settings.ui.stfGroupSize)];
+        order.laneLayout = CpuLaneLayout(settings.ui.stfWaveLaneLayoutOverride);
+        order.swizzle = constants.stfGroupSwizzle;
+        order.swizzleSize = constants.stfGroupSwizzleSize;
+        rayTracer.RecordTexelTrace(constants, stfEnabled, order, trace);
+        if (!trace.Write(settings.texelTraceFileName))
+        {
+            log::error("Cannot write '%s'", settings.texelTraceFileName.generic_string().c_str());
+            succeeded = false;
+        }
+    }
+
+    if (settings.cacheReportFileName.empty())
+        return succeeded;
+
+    std::ofstream report(settings.cacheReportFileName);
+    if (!report.is_open())
+    {
+        log::error("Cannot write '%s'", settings.cacheReportFileName.generic_string().c_str());
+        return false;
+    }
+
+    report << "groupSize,laneLayout,magMethod,requests,fetches,l1Accesses,l1HitRate,l2Accesses,l2HitRate,dramBytes\n";
+
+    for (uint32_t layout = 0; layout < uint32_t(std::size(layoutNames)); layout++)
+    {
+        for (const dm::uint2 groupSize : groupSizes)
+        {
+            CpuDispatchOrder order;
+            order.groupSize = groupSize;
+            order.laneLayout = CpuLaneLayout(layout);
+            rayTracer.RecordTexelTrace(constants, stfEnabled, order, trace);
+
+            const TextureCacheResult result = SimulateTextureCache(trace, config);
+            const std::string name = std::to_string(groupSize.x) + "x" + std::to_string(groupSize.y) + " " + layoutNames[layout];
+            LogTextureCacheResult(name.c_str(), result, trace);
+
+            report << groupSize.x << "x" << groupSize.y << "," << layoutNames[layout] << "," << GetStfMagMethodName(constants.stfMagnificationMethod) << ","
+                << result.requests << "," << result.fetches << "," << result.l1Accesses << "," << result.GetL1HitRate() << ","
+                << result.l2Accesses << "," << result.GetL2HitRate() << "," << result.dramBytes << "\n";
+        }
+    }
+
+    return succeeded && report.good();
+}
+
+// Compares the Aniso and Ewa minification methods on the first frame: the error of their expectation against
+// deterministic EWA, grazing hits separately, then the texel fetches of the frame in the UI's dispatch order
+// through the cache simulator
+static void RunAnisoStudy(const CpuRayTracer& rayTracer, LightingConstants constants, bool stfEnabled, const CpuRenderSettings& settings)
+{
+    const dm::uint2 groupSizes[] = { dm::uint2(8, 8), dm::uint2(16, 8), dm::uint2(8, 16), dm::uint2(16, 16) };
+
+    rayTracer.BenchmarkAnisotropicFiltering(constants);
+
+    // Only the tap positions differ: the shared footprints do not support EWA, and no mip level override
+    constants.stfShareFootprints = 0;
+    constants.stfUseMipLevelOverride = 0;
+
+    CpuDispatchOrder order;
+    order.groupSize = groupSizes[uint32_t(settings.ui.stfGroupSize)];
+    order.laneLayout = CpuLaneLayout(settings.ui.stfWaveLaneLayoutOverride);
+    order.swizzle = constants.stfGroupSwizzle;
+    order.swizzleSize = constants.stfGroupSwizzleSize;
+
+    struct Method
+    {
+        const char* name;
+        bool ewaEnabled;
+    };
+    const Method methods[] = { { "Aniso", false }, { "Ewa", true } };
+
+    TexelTrace trace;
+    for (const Method& method : methods)
+    {
+        constants.stfMinificationMethod = STF_ANISO_LOD_METHOD_DEFAULT;
+        constants.stfEwaEnabled = method.ewaEnabled ? 1 : 0;
+        rayTracer.RecordTexelTrace(constants, stfEnabled, order, trace);
+        LogTextureCacheResult(method.name, SimulateTextureCache(trace, settings.cacheConfig), trace);
+    }
+}
+
+// Renders frameCount frames with the random numbers stratified over cycles of 1 (new noise every frame), 2, 4, 8 and
+// 16 frames, and logs the RMSE of the running average after 1, 2, 4, ... frames against the converged STF image.
+// The hardware sampler differs from the STF expectation by the anisotropic filter, which would hide the convergence.
+static void RunTemporalStrataStudy(const CpuRayTracer& rayTracer, LightingConstants constants, const CpuRenderSettings& settings)
+{
+    // The average of 8 times as many frames, after the frame indices of the study
+    const uint32_t referenceFrames = 8 * settings.frameCount;
+    UIData referenceUi = settings.ui;
+    referenceUi.stfTemporalStrata = STF_TEMPORAL_STRATA_MAX;
+
+    std::vector<float4> frame;
+    std::vector<float4> reference;
+    RunStudyFrames(referenceUi, settings.frameCount, referenceFrames, constants, [&]()
+    {
+        rayTracer.Render(constants, true, frame);
+        reference.resize(frame.size(), float4(0.f));
+        for (size_t i = 0; i < reference.size(); i++)
+            reference[i] += frame[i] / float(referenceFrames);
+    });
+
+    for (int strata = 1; strata <= STF_TEMPORAL_STRATA_MAX; strata *= 2)
+    {
+        UIData ui = settings.ui;
+        ui.stfTemporalStrata = strata;
+
+        ConvergenceReport report(reference, settings.frameCount);
+        RunStudyFrames(ui, 0, settings.frameCount, constants, [&]()
+        {
+            rayTracer.Render(constants, true, frame);
+            report.AddFrame(frame);
+        });
+
+        log::info("Temporal strata %2d (generator %u): luma RMSE against %d converged frames after %s frames",
+            strata, constants.stfTemporalGenerator, int(referenceFrames), report.GetText().c_str());
+    }
+}
+
+// Renders frameCount frames with the random numbers of the pixel shared by all material textures, reseeded per
+// sample and rotated per texture slot (Decorrelate Textures), and logs the RMSE of the running average against the
+// hardware sampler after 1, 2, 4, ... frames and the render time per frame of each
+static void RunTextureDecorrelationStudy(const CpuRayTracer& rayTracer, LightingConstants constants, const CpuRenderSettings& settings)
+{
+    struct Mode
+    {
+        const char* name;
+        bool reseedOnSample;
+        bool decorrelateTextures;
+    };
+    const Mode modes[] = { { "shared", false, false }, { "reseeded", true, false }, { "decorrelated", false, true } };
+
+    std::vector<float4> reference;
+    rayTracer.Render(constants, false, reference);
+
+    std::vector<float4> frame;
+    for (const Mode& mode : modes)
+    {
+        UIData ui = settings.ui;
+        ui.stfReseedOnSample = mode.reseedOnSample;
+        ui.stfDecorrelateTextures = mode.decorrelateTextures;
+
+        ConvergenceReport report(reference, settings.frameCount);
+        double renderMilliseconds = 0.0;
+        RunStudyFrames(ui, 0, settings.frameCount, constants, [&]()
+        {
+            const auto start = std::chrono::high_resolution_clock::now();
+            rayTracer.Render(constants, true, frame);
+            renderMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            report.AddFrame(frame);
+        });
+
+        log::info("Texture random numbers %s: %.1f ms per frame, luma RMSE against the hardware sampler after %s frames",
+            mode.name, renderMilliseconds / settings.frameCount, report.GetText().c_str());
+    }
+}
+
+// Rasterizes frameCount frames with a single STF tap, a fixed 2 and 4 taps and adaptive multi-tap up to 2 and 4 taps
+// at the contrast of the UI, and logs the texels fetched per STF sample against the mean luma RMSE of the albedo of a
+// single frame against the hardware sampler. The adaptive modes should reach most of the error reduction of the
+// fixed ones at a fraction of the extra fetches.
+static void RunMultiTapStudy(CpuRasterizer& rasterizer, LightingConstants constants, const CpuRenderSettings& settings)
+{
+    struct Mode
+    {
+        const char* name;
+        int maxTaps;
+        bool adaptive;
+    };
+    const Mode modes[] = { { "1 tap", 1, false }, { "2 taps", 2, false }, { "4 taps", 4, false }, { "adaptive 2 taps", 2, true },
+        { "adaptive 4 taps", 4, true } };
+
+    std::vector<CpuGBufferTexel> gbuffer;
+    CpuRasterizerStats stats;
+    rasterizer.Render(constants, false, settings.rasterizerOptions, gbuffer, stats);
+
+    std::vector<float3> reference(gbuffer.size());
+    for (size_t i = 0; i < gbuffer.size(); i++)
+        reference[i] = gbuffer[i].channel0.xyz();
+
+    for (const Mode& mode : modes)
+    {
+        UIData ui = settings.ui;
+        ui.stfMaxTaps = mode.maxTaps;
+        ui.stfTapContrast = mode.adaptive ? settings.ui.stfTapContrast : 0.f;
+
+        StfSamplingCounters counters;
+        double rmse = 0.0;
+        double shadingMilliseconds = 0.0;
+        RunStudyFrames(ui, 0, settings.frameCount, constants, [&]()
+        {
+            rasterizer.Render(constants, true, settings.rasterizerOptions, gbuffer, stats);
+            counters.Add(stats.sampling);
+            shadingMilliseconds += stats.shadingMilliseconds;
+            rmse += GetLumaRmse(gbuffer.size(), [&](size_t i) { return gbuffer[i].channel0.xyz() - reference[i]; }) / settings.frameCount;
+        });
+
+        log::info("Multi-tap %s: %.2f taps and %.2f texels per STF sample, %.1f ms shading per frame, luma RMSE %.5f against the hardware sampler",
+            mode.name, counters.GetTapsPerSample(), counters.GetTexelsPerSample(), shadingMilliseconds / settings.frameCount, rmse);
+    }
+}
+
+// The forward fill samples every material texture in every lane, helper lanes included; with deferred texels the fill
+// only stores texel IDs and the resolve loads each texture once per visible pixel. Both use the same random numbers,
+// so the difference is the shared sample position and the quantization of the tangent frame.
+static void RunDeferredTexelStudy(CpuRasterizer& rasterizer, LightingConstants constants, const CpuRenderSettings& settings)
+{
+    if (!constants.stfDeferredTexels)
+    {
+        log::warning("Deferred texels are off with the filter kernel, sigma LOD, EWA and multi-tap settings");
+        return;
+    }
+
+    CpuRasterizerOptions forwardOptions = settings.rasterizerOptions;
+    forwardOptions.deferredTexels = false;
+    CpuRasterizerOptions deferredOptions = settings.rasterizerOptions;
+    deferredOptions.deferredTexels = true;
+
+    std::vector<CpuGBufferTexel> forward;
+    std::vector<CpuGBufferTexel> deferred;
+    CpuRasterizerStats forwardStats;
+    CpuRasterizerStats deferredStats;
+
+    double forwardTexels = 0.0;
+    double deferredTexels = 0.0;
+    double forwardMilliseconds = 0.0;
+    double deferredMilliseconds = 0.0;
+    double resolvedPixels = 0.0;
+    double albedoError = 0.0;
+    float maxAlbedoError = 0.f;
+    double normalAngle = 0.0;
+    float maxNormalAngle = 0.f;
+    uint64_t differingPixels = 0;
+    uint64_t comparedPixels = 0;
+
+    RunStudyFrames(settings.ui, 0, settings.frameCount, constants, [&]()
+    {
+        rasterizer.Render(constants, true, forwardOptions, forward, forwardStats);
+        rasterizer.Render(constants, true, deferredOptions, deferred, deferredStats);
+
+        forwardTexels += double(forwardStats.sampling.texelsFetched);
+        deferredTexels += double(deferredStats.sampling.texelsFetched + deferredStats.resolveTexelsFetched);
+        forwardMilliseconds += forwardStats.shadingMilliseconds;
+        deferredMilliseconds += deferredStats.shadingMilliseconds + deferredStats.resolveMilliseconds;
+        resolvedPixels += double(deferredStats.resolvedPixels);
+
+        for (size_t i = 0; i < forward.size(); i++)
+        {
+            const float3 albedoDifference = abs(deferred[i].channel0.xyz() - forward[i].channel0.xyz());
+            const float albedo = std::max(albedoDifference.x, std::max(albedoDifference.y, albedoDifference.z));
+            albedoError += albedo;
+            maxAlbedoError = std::max(maxAlbedoError, albedo);
+            if (albedo > 1.f / 255.f)
+                differingPixels++;
+
+            const float3 forwardNormal = forward[i].channel2.xyz();
+            const float3 deferredNormal = deferred[i].channel2.xyz();
+            if (dot(forwardNormal, forwardNormal) > 0.f && dot(deferredNormal, deferredNormal) > 0.f)
+            {
+                const float cosAngle = std::min(std::max(dot(normalize(forwardNormal), normalize(deferredNormal)), -1.f), 1.f);
+                const float angle = std::acos(cosAngle) * 180.f / dm::PI_f;
+                normalAngle += angle;
+                maxNormalAngle = std::max(maxNormalAngle, angle);
+                comparedPixels++;
+            }
+        }
+    });
+
+    const double frames = double(settings.frameCount);
+    const double pixels = double(std::max<size_t>(forward.size(), 1)) * frames;
+    log::info("Deferred texels: %.0f texels per frame forward, %.0f deferred (%.1f%%), %.0f resolved pixels per frame",
+        forwardTexels / frames, deferredTexels / frames, 100.0 * deferredTexels / std::max(forwardTexels, 1.0), resolvedPixels / frames);
+    log::info("Deferred texels: %.1f ms shading per frame forward, %.1f ms fill and resolve deferred",
+        forwardMilliseconds / frames, deferredMilliseconds / frames);
+    log::info("Deferred texels: albedo difference %.5f mean, %.5f max, %.2f%% of the pixels above 1/255",
+        albedoError / pixels, maxAlbedoError, 100.0 * double(differingPixels) / pixels);
+    log::info("Deferred texels: shading normal %.3f degrees mean, %.3f max",
+        normalAngle / double(std::max<uint64_t>(comparedPixels, 1)), maxNormalAngle);
+}
+
+// Scores every candidate of the dispatch autotuner by the texel trace of the first frame instead of GPU timings:
+// L2 accesses, with the misses counted again four times as a DRAM access costs several L2 hits
+static bool RunCpuDispatchAutotune(const CpuRayTracer& rayTracer, const LightingConstants& constants, bool stfEnabled, dm::uint2 resolution,
+    const CpuRenderSettings& settings)
+{
+    DispatchAutotuner tuner;
+    std::string error;
+    if (std::filesystem::exists(settings.dispatchTuningFileName) && !tuner.Load(settings.dispatchTuningFileName, error))
+        log::warning("%s", error.c_str());
+
+    TexelTrace trace;
+    tuner.Start(resolution, "cacheScore", 0, 1);
+    while (tuner.IsSearching())
+    {
+        const uint32_t index = tuner.GetCurrentIndex();
+        rayTracer.RecordTexelTrace(constants, stfEnabled, tuner.GetCandidate(index), trace);
+
+        const TextureCacheResult result = SimulateTextureCache(trace, settings.cacheConfig);
+        const float cost = float(result.l2Accesses + 4 * (result.l2Accesses - result.l2Hits));
+        log::info("%s: %.0f", DispatchAutotuner::GetCandidateName(tuner.GetCandidate(index)).c_str(), cost);
+        tuner.Report(index, cost);
+    }
+
+    const DispatchTuning* tuning = tuner.FindResult(resolution);
+    log::info("Best dispatch at %dx%d: %s", int(resolution.x), int(resolution.y), DispatchAutotuner::GetCandidateName(tuning->order).c_str());
+
+    if (!tuner.Save(settings.dispatchTuningFileName, error))
+    {
+        log::error("%s", error.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool ReplayTexelTrace(const std::filesystem::path& fileName, const TextureCacheConfig& config)
+{
+    TexelTrace trace;
+    if (!trace.Read(fileName))
+    {
+        log::error("Cannot read texel trace '%s'", fileName.generic_string().c_str());
+        return false;
+    }
+
+    LogTextureCacheResult(fileName.filename().generic_string().c_str(), SimulateTextureCache(trace, config), trace);
+    return true;
+}
+
+// Bakes the opacity micromaps of the alpha-tested triangles, checks their known states against the alpha test and
+// logs how many alpha tests of the first frame they remove
+static bool RunCpuOpacityMicromapBake(ThreadPool& pool, const CpuScene& scene, const CpuRayTracer& rayTracer,
+    const LightingConstants& constants, const CpuRenderSettings& settings)
+{
+    OpacityMicromaps micromaps;
+    micromaps.Bake(pool, scene, settings.ommBakeSettings);
+
+    const OmmBakeStats& stats = micromaps.GetStats();
+    const double microTriangles = double(std::max<uint64_t>(stats.microTriangles[0] + stats.microTriangles[1] +
+        stats.microTriangles[2] + stats.microTriangles[3], 1));
+    log::info("Opacity micromaps baked in %.1f ms: %d alpha-tested triangles, %d with a special index, %d micromaps of %d bytes",
+        stats.milliseconds, int(stats.alphaTestedTriangles), int(stats.specialIndexTriangles), int(stats.micromaps), int(micromaps.GetData().size()));
+    log::info("Micro-triangles %.1f%% opaque, %.1f%% transparent, %.1f%% unknown, %.1f%% of the alpha-tested area has a known state",
+        100.0 * double(stats.microTriangles[uint32_t(OmmState::Opaque)]) / microTriangles,
+        100.0 * double(stats.microTriangles[uint32_t(OmmState::Transparent)]) / microTriangles,
+        100.0 * double(stats.microTriangles[uint32_t(OmmState::UnknownOpaque)] + stats.microTriangles[uint32_t(OmmState::UnknownTransparent)]) / microTriangles,
+        100.0 * stats.knownArea);
+    for (const OmmUsageCount& usage : micromaps.GetUsageCounts())
+        log::info("  %d micromaps of subdivision level %d", int(usage.count), int(usage.subdivisionLevel));
+
+    const uint32_t samplesPerMicroTriangle = 4;
+    const uint64_t mismatches = micromaps.Validate(pool, scene, samplesPerMicroTriangle);
+    if (mismatches != 0)
+        log::warning("%llu samples on micro-triangles of a known state disagree with the alpha test", (unsigned long long)mismatches);
+    else
+        log::info("Known micro-triangle states agree with the alpha test at %d random points each", int(samplesPerMicroTriangle));
+
+    if (!micromaps.Write(settings.ommBakeFileName))
+    {
+        log::error("Cannot write '%s'", settings.ommBakeFileName.generic_string().c_str());
+        return false;
+    }
+
+    rayTracer.BenchmarkOpacityMicromaps(constants, micromaps);
+    return true;
+}
+
+bool RunCpuRender(const CpuRenderSettings& settings)
+{
+    const uint32_t width = 1280;
+    const uint32_t height = 720;
+
+    const std::filesystem::path mediaPath = app::GetDirectoryWithExecutable().parent_path() / "assets/media";
+    auto nativeFS = std::make_shared<vfs::NativeFileSystem>();
+
+    // No device: only the CPU decoders of the cache are used
+    TextureCache textureCache(nullptr, nativeFS, nullptr);
+
+    std::string error;
+    std::shared_ptr<SceneGraph> sceneGraph = LoadSceneGraphWithoutDevice(mediaPath / "sponza-plus.scene.json", textureCache, error);
+    if (!sceneGraph)
+    {
+        log::error("%s", error.c_str());
+        return false;
+    }
+
+    auto sunLight = std::make_shared<DirectionalLight>();
+    sceneGraph->AttachLeafNode(sceneGraph->GetRootNode(), sunLight);
+    sunLight->SetDirection(double3(0.1f, -1.0f, -0.15f));
+    sunLight->angularSize = 0.53f;
+    sunLight->irradiance = 5.f;
+    sceneGraph->Refresh(0);
+
+    ThreadPool pool;
+    CpuScene scene(pool);
+    if (!scene.Init(*sceneGraph, textureCache, mediaPath / "STBN/STBlueNoise_vec2_128x128x64.png"))
+        return false;
+
+    app::FirstPersonCamera camera;
+    camera.LookAt(float3(0.f, 1.8f, 0.f), float3(1.f, 1.8f, 0.f));
+
+    PlanarView view;
+    const nvrhi::Viewport viewport{ float(width), float(height) };
+    view.SetViewport(viewport);
+    view.SetMatrices(camera.GetWorldToViewMatrix(), perspProjD3DStyleReverse(dm::PI_f * 0.25f, viewport.width() / viewport.height(), 0.1f));
+    view.UpdateCache();
+
+    const UIData& ui = settings.ui;
+    const bool stfEnabled = GetStfOn(ui.samplerType);
+    LightingConstants constants = {};
+    constants.ambientColor = float4(0.2f);
+    sunLight->FillLightConstants(constants.light);
+
+    // Resolved frames are jittered with the sequence of the GPU temporal pass
+    auto setupFrame = [&](uint32_t frameIndex)
+    {
+        view.SetPixelOffset(settings.temporalResolve ? GetHaltonPixelOffset(frameIndex) : dm::float2::zero());
+        view.UpdateCache();
+        view.FillPlanarViewConstants(constants.view);
+        FillStfConstants(ui, frameIndex, constants);
+    };
+
+    std::unique_ptr<CpuRayTracer> rayTracer;
+    std::unique_ptr<CpuRasterizer> rasterizer;
+    if (settings.raster)
+    {
+        rasterizer = std::make_unique<CpuRasterizer>(pool, scene);
+    }
+    else
+    {
+        rayTracer = std::make_unique<CpuRayTracer>(pool, scene);
+        rayTracer->Init();
+    }
+
+    OpacityMicromaps micromaps;
+    if (!settings.ommFileName.empty() && rayTracer)
+    {
+        if (micromaps.Read(settings.ommFileName) && micromaps.GetIndices().size() == scene.GetTriangles().size())
+            rayTracer->SetOpacityMicromaps(&micromaps);
+        else
+            log::warning("Cannot use the opacity micromaps of '%s', alpha testing every hit", settings.ommFileName.generic_string().c_str());
+    }
+
+    // The benchmarks and studies of the first frame's view
+    setupFrame(0);
+
+    if (!settings.ommBakeFileName.empty())
+    {
+        if (!rayTracer)
+        {
+            log::error("-bakeOmm validates the micromaps with the ray tracer, not -cpuRaster");
+            return false;
+        }
+
+        return RunCpuOpacityMicromapBake(pool, scene, *rayTracer, constants, settings);
+    }
+
+    if (settings.gradientBenchmark && rayTracer)
+    {
+        rayTracer->BenchmarkTextureGradients(constants);
+        return true;
+    }
+
+    if (settings.materialBenchmark && rayTracer)
+    {
+        rayTracer->BenchmarkMaterialSampling(constants);
+        return true;
+    }
+
+    if (settings.sigmaLodBenchmark && rayTracer)
+    {
+        rayTracer->BenchmarkGaussianSigmaLod(constants);
+        return true;
+    }
+
+    if (settings.anisoStudy && rayTracer)
+    {
+        RunAnisoStudy(*rayTracer, constants, stfEnabled, settings);
+        return true;
+    }
+
+    if (settings.decorrelationStudy && rayTracer)
+    {
+        RunTextureDecorrelationStudy(*rayTracer, constants, settings);
+        return true;
+    }
+
+    if (settings.temporalStrataStudy && rayTracer)
+    {
+        RunTemporalStrataStudy(*rayTracer, constants, settings);
+        return true;
+    }
+
+    if (settings.shadingCacheStudy && rayTracer)
+    {
+        rayTracer->BenchmarkTexelShadingCache(constants, settings.frameCount);
+        return true;
+    }
+
+    if (settings.multiTapStudy)
+    {
+        if (!rasterizer)
+        {
+            log::error("Adaptive multi-tap STF measures the contrast per quad and needs -cpuRaster");
+            return false;
+        }
+
+        RunMultiTapStudy(*rasterizer, constants, settings);
+        return true;
+    }
+
+    if (settings.deferredTexelStudy)
+    {
+        if (!rasterizer)
+        {
+            log::error("Deferred texels replace the G-buffer fill of the Raster pipeline and need -cpuRaster");
+            return false;
+        }
+
+        RunDeferredTexelStudy(*rasterizer, constants, settings);
+        return true;
+    }
+
+    if (!settings.cacheReportFileName.empty() || !settings.texelTraceFileName.empty() || settings.dispatchAutotune)
+    {
+        if (!rayTracer)
+        {
+            log::error("Texel traces follow the dispatch order of the compute pipeline and need the ray tracer, not -cpuRaster");
+            return false;
+        }
+
+        if (settings.dispatchAutotune)
+            return RunCpuDispatchAutotune(*rayTracer, constants, stfEnabled, dm::uint2(width, height), settings);
+
+        return RunTextureCacheStudy(*rayTracer, constants, stfEnabled, settings);
+    }
+
+    std::vector<float4> frame;
+    std::vector<float4> referenceFrame;
+    std::vector<float4> average(size_t(width) * height, float4(0.f));
+    std::vector<CpuGBufferTexel> gbuffer;
+    CpuTemporalResolver resolver(pool);
+    CpuTemporalResolver referenceResolver(pool);
+    CpuRasterizerStats stats;
+    StfSamplingStats samplingStats;
+    double renderMilliseconds = 0.0;
+    double resolveMilliseconds = 0.0;
+
+    ImageMetrics metrics(pool);
+    TemporalInstabilityMetric instability(pool);
+    const ImageMetricsOptions metricsOptions;
+    ImageMetricsResult frameMetrics;
+    ImageMetricsResult meanMetrics;
+    NoiseSpectrumAnalyzer spectrumAnalyzer(pool, NoiseSpectrumOptions());
+    std::vector<float> lumaError;
+
+    auto getAlbedo = [&](std::vector<float4>& albedo)
+    {
+        albedo.resize(gbuffer.size());
+        for (size_t i = 0; i < gbuffer.size(); i++)
+            albedo[i] = float4(gbuffer[i].channel0.xyz(), 1.f);
+    };
+
+    for (uint32_t frameIndex = 0; frameIndex < settings.frameCount; frameIndex++)
+    {
+        setupFrame(frameIndex);
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        if (rasterizer)
+        {
+            CpuRasterizerStats frameStats;
+            rasterizer->Render(constants, stfEnabled, settings.rasterizerOptions, gbuffer, frameStats);
+            getAlbedo(frame);
+
+            stats.quads += frameStats.quads;
+            stats.waves += frameStats.waves;
+            stats.activeLanes += frameStats.activeLanes;
+            stats.helperLanes += frameStats.helperLanes;
+            stats.sampling.Add(frameStats.sampling);
+            for (size_t texture = 0; texture < frameStats.textureSampling.size(); texture++)
+            {
+                if (frameStats.textureSampling[texture].waves != 0)
+                    samplingStats.Add(uint32_t(texture), constants.stfMagnificationMethod, frameStats.textureSampling[texture]);
+            }
+            stats.rasterMilliseconds += frameStats.rasterMilliseconds;
+            stats.shadingMilliseconds += frameStats.shadingMilliseconds;
+        }
+        else
+        {
+            rayTracer->Render(constants, stfEnabled, frame);
+        }
+
+        const auto resolveStart = std::chrono::high_resolution_clock::now();
+        if (settings.temporalResolve)
+        {
+            resolver.Resolve(width, height, frame.data(), nullptr, settings.temporalParameters);
+        }
+        else
+        {
+            for (size_t i = 0; i < average.size(); i++)
+                average[i] += frame[i] / float(settings.frameCount);
+        }
+        const auto resolveEnd = std::chrono::high_resolution_clock::now();
+
+        renderMilliseconds += std::chrono::duration<double, std::milli>(resolveStart - start).count();
+        resolveMilliseconds += std::chrono::duration<double, std::milli>(resolveEnd - resolveStart).count();
+
+        if (rasterizer)
+        {
+            // The hardware sampler through the same jitter and resolve
+            CpuRasterizerStats referenceStats;
+            rasterizer->Render(constants, false, settings.rasterizerOptions, gbuffer, referenceStats);
+            getAlbedo(referenceFrame);
+
+            // Luminance error of the raw STF frame, before any resolve
+            lumaError.resize(frame.size());
+            for (size_t i = 0; i < frame.size(); i++)
+                lumaError[i] = dot(frame[i].xyz() - referenceFrame[i].xyz(), c_LumaWeights);
+            spectrumAnalyzer.AddFrame(width, height, lumaError.data());
+
+            if (settings.temporalResolve)
+                referenceResolver.Resolve(width, height, referenceFrame.data(), nullptr, settings.temporalParameters);
+
+            const std::vector<float4>& tested = settings.temporalResolve ? resolver.GetOutput() : frame;
+            const std::vector<float4>& reference = settings.temporalResolve ? referenceResolver.GetOutput() : referenceFrame;
+
+            metrics.Compare(MetricImage{ tested.data(), width, height }, MetricImage{ reference.data(), width, height },
+                metricsOptions, frameMetrics);
+            meanMetrics.psnr += frameMetrics.psnr / settings.frameCount;
+            meanMetrics.ssim += frameMetrics.ssim / settings.frameCount;
+            meanMetrics.msSsim += frameMetrics.msSsim / settings.frameCount;
+            meanMetrics.flip += frameMetrics.flip / settings.frameCount;
+            meanMetrics.milliseconds += frameMetrics.milliseconds / settings.frameCount;
+        }
+
+        instability.AddFrame(MetricImage{ settings.temporalResolve ? resolver.GetOutput().data() : frame.data(), width, height }, metricsOptions);
+    }
+
+    if (rasterizer)
+    {
+        log::info("CPU rasterized %d frames of %dx%d on %d threads, %.1f ms per frame",
+            int(settings.frameCount), int(width), int(height), int(pool.GetThreadCount()), renderMilliseconds / settings.frameCount);
+        log::info("Albedo per %s frame against the hardware sampler: PSNR %.2f dB, SSIM %.4f, MS-SSIM %.4f, FLIP %.4f (%.1f ms per frame)",
+            settings.temporalResolve ? "resolved" : "single", meanMetrics.psnr, meanMetrics.ssim, meanMetrics.msSsim, meanMetrics.flip,
+            meanMetrics.milliseconds);
+        LogCpuRasterizerStats(stats, settings.rasterizerOptions, settings.frameCount);
+
+        NoiseSpectrum spectrum;
+        spectrumAnalyzer.GetResult(spectrum);
+        log::info("STF error spectrum: variance %.6f, %.4f of the energy below %.2f of Nyquist (white noise %.4f), temporal %.4f (white noise %.4f)",
+            spectrum.spatialVariance, spectrum.spatialLowFrequencyRatio, NoiseSpectrumOptions().lowFrequencyCutoff, spectrum.spatialWhiteNoiseRatio,
+            spectrum.temporalLowFrequencyRatio, spectrum.temporalWhiteNoiseRatio);
+        if (!settings.spectrumFileName.empty() && !NoiseSpectrumAnalyzer::WriteCsv(settings.spectrumFileName, spectrum))
+            log::warning("Cannot write '%s'", settings.spectrumFileName.generic_string().c_str());
+
+        if (!settings.samplingStatsFileName.empty() &&
+            !samplingStats.WriteCsv(settings.samplingStatsFileName, [&scene](uint32_t texture) { return scene.GetTextureName(texture); }))
+        {
+            log::warning("Cannot write '%s'", settings.samplingStatsFileName.generic_string().c_str());
+        }
+
+        if (!settings.heatmapFileName.empty())
+        {
+            // FLIP of the last frame per tile
+            const ImageMetricsTiles& tiles = frameMetrics.tiles;
+            std::vector<float4> heatmap(tiles.flip.size());
+            for (size_t i = 0; i < heatmap.size(); i++)
+                heatmap[i] = float4(tiles.flip[i], tiles.flip[i], tiles.flip[i], 1.f);
+
+            if (heatmap.empty() || !WritePfmImage(settings.heatmapFileName, tiles.tilesX, tiles.tilesY, &heatmap[0].x))
+                log::warning("Cannot write '%s'", settings.heatmapFileName.generic_string().c_str());
+        }
+    }
+    else
+    {
+        log::info("CPU rendered %d frames of %dx%d on %d threads, %.1f ms per frame",
+            int(settings.frameCount), int(width), int(height), int(pool.GetThreadCount()), renderMilliseconds / settings.frameCount);
+    }
+
+    if (settings.temporalResolve)
+    {
+        const double milliseconds = resolveMilliseconds / settings.frameCount;
+        const double megapixelsPerSecond = double(width) * height / (milliseconds * 1000.0);
+        log::info("CPU temporal resolve: %.2f ms per frame, %.0f Mpixel/s, %.1f 3840x2160 frames per second",
+            milliseconds, megapixelsPerSecond, megapixelsPerSecond * 1e6 / (3840.0 * 2160.0));
+    }
+
+    TemporalInstabilityResult flicker;
+    instability.GetResult(metricsOptions, flicker);
+    if (flicker.frameCount > 1)
+    {
+        log::info("Temporal instability over %d %s frames: luma variance %.6f, frame to frame luma change %.5f",
+            int(flicker.frameCount), settings.temporalResolve ? "resolved" : "single", flicker.luminanceVariance, flicker.frameDifference);
+    }
+
+    const std::vector<float4>& result = settings.temporalResolve ? resolver.GetOutput() : average;
+    if (!WritePfmImage(settings.outputFileName, width, height, &result[0].x))
+    {
+        log::error("Cannot write '%s'", settings.outputFileName.generic_string().c_str());
+        return false;
+    }
+
+    return true;
+}
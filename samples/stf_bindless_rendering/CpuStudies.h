@@ -0,0 +1,75 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "CpuRasterizer.h"
+#include "CpuTemporalResolver.h"
+#include "OpacityMicromap.h"
+#include "TextureCacheSimulator.h"
+#include "UserInterface.h"
+
+#include <filesystem>
+
+// Command line of stf_bindless_rendering_studies: the frames to render, or the one benchmark or study to run instead
+struct CpuRenderSettings
+{
+    std::filesystem::path outputFileName;
+    uint32_t frameCount = 1;
+    bool gradientBenchmark = false;     // only compare the texture gradient methods on the first frame's primary hits
+    bool materialBenchmark = false;     // only compare separate and shared STF footprints on the first frame's primary hits
+    bool sigmaLodBenchmark = false;     // only compare wide Gaussians on the footprint mip and with sigma LOD on the first frame's primary hits
+    bool anisoStudy = false;            // only compare the error and cache behaviour of the Aniso and Ewa minification methods
+    bool decorrelationStudy = false;    // only compare the convergence of shared, reseeded and decorrelated random numbers
+    bool temporalStrataStudy = false;   // only compare the convergence of random numbers stratified over 1 to 16 frames
+    bool multiTapStudy = false;         // only compare fetches and error of single, fixed and adaptive multi-tap STF
+    bool shadingCacheStudy = false;     // only measure the reuse of decoded materials keyed by the STF texel over the frames
+    bool deferredTexelStudy = false;    // only compare the forward G-buffer fill with deferred texels and the texel resolve
+    bool raster = false;                // the G-buffer fill of the Raster pipeline instead of the ray traced frame
+    // Per-tile FLIP of the last rasterized frame
+    std::filesystem::path heatmapFileName;
+    // Power spectra of the rasterized STF error
+    std::filesystem::path spectrumFileName;
+    // STF sampling counters of the rasterized frames per texture
+    std::filesystem::path samplingStatsFileName;
+    bool temporalResolve = false;       // resolve jittered frames like the TAA pass instead of averaging them
+    CpuTemporalResolveParameters temporalParameters;
+    UIData ui;
+    CpuRasterizerOptions rasterizerOptions;
+    // Texel traces of the ray traced frame: every thread group size and lane layout replayed through the cache
+    // simulator, and the trace of the UI's group size and lane layout
+    std::filesystem::path cacheReportFileName;
+    std::filesystem::path texelTraceFileName;
+    TextureCacheConfig cacheConfig;
+    // Dispatch autotuning with the cache simulator, the result is merged into the tuning file
+    bool dispatchAutotune = false;
+    std::filesystem::path dispatchTuningFileName;
+    // Opacity micromaps: baked, validated and written to ommBakeFileName, or read from ommFileName for rendering
+    std::filesystem::path ommBakeFileName;
+    OmmBakeSettings ommBakeSettings;
+    std::filesystem::path ommFileName;
+
+    // Any of the CPU renders, benchmarks and studies
+    bool IsRequested() const
+    {
+        return !outputFileName.empty() || gradientBenchmark || materialBenchmark || sigmaLodBenchmark || anisoStudy || decorrelationStudy ||
+            temporalStrataStudy || multiTapStudy || shadingCacheStudy || deferredTexelStudy || !cacheReportFileName.empty() ||
+            !texelTraceFileName.empty() || dispatchAutotune || !ommBakeFileName.empty();
+    }
+};
+
+// Renders the startup view of the sample on the CPU and writes the average of frameCount frames, frame index 0 to
+// frameCount - 1, or their temporal resolve. The ray tracer writes the lit frame, the rasterizer the diffuse albedo
+// of the G-buffer, and its frames are compared against the hardware sampler. A benchmark or study of the settings
+// runs instead of the frames. Nothing here needs a graphics device.
+bool RunCpuRender(const CpuRenderSettings& settings);
+
+// Replays a trace written with -cpuTexelTrace, no scene needed
+bool ReplayTexelTrace(const std::filesystem::path& fileName, const TextureCacheConfig& config);
@@ -0,0 +1,197 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "CpuTemporalResolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <xmmintrin.h>
+
+using namespace donut::math;
+
+namespace
+{
+    constexpr uint32_t c_TileSize = 64;
+
+    float VanDerCorput(uint32_t base, uint32_t index)
+    {
+        float result = 0.f;
+        float fraction = 1.f / float(base);
+        while (index > 0)
+        {
+            result += float(index % base) * fraction;
+            index /= base;
+            fraction /= float(base);
+        }
+        return result;
+    }
+
+    __m128 Load(const float4* pixels, uint32_t width, uint32_t height, int x, int y)
+    {
+        x = std::clamp(x, 0, int(width) - 1);
+        y = std::clamp(y, 0, int(height) - 1);
+        return _mm_loadu_ps(&pixels[size_t(y) * width + x].x);
+    }
+
+    // Catmull-Rom weights of the 4 texels around a sample with the given fraction, the bicubic history filter of
+    // the GPU resolve
+    void GetCatmullRomWeights(float t, float weights[4])
+    {
+        const float t2 = t * t;
+        const float t3 = t2 * t;
+        weights[0] = 0.5f * (-t3 + 2.f * t2 - t);
+        weights[1] = 0.5f * (3.f * t3 - 5.f * t2 + 2.f);
+        weights[2] = 0.5f * (-3.f * t3 + 4.f * t2 + t);
+        weights[3] = 0.5f * (t3 - t2);
+    }
+
+    // History at a position in pixels, where pixel centers are at integers
+    __m128 SampleHistory(const float4* history, uint32_t width, uint32_t height, float2 position)
+    {
+        const float2 base = floor(position);
+        const float2 fraction = position - base;
+        const int x0 = int(base.x);
+        const int y0 = int(base.y);
+
+        if (fraction.x == 0.f && fraction.y == 0.f)
+            return Load(history, width, height, x0, y0);
+
+        float weightsX[4];
+        float weightsY[4];
+        GetCatmullRomWeights(fraction.x, weightsX);
+        GetCatmullRomWeights(fraction.y, weightsY);
+
+        __m128 result = _mm_setzero_ps();
+        for (int j = 0; j < 4; j++)
+        {
+            __m128 row = _mm_setzero_ps();
+            for (int i = 0; i < 4; i++)
+                row = _mm_add_ps(row, _mm_mul_ps(Load(history, width, height, x0 + i - 1, y0 + j - 1), _mm_set1_ps(weightsX[i])));
+            result = _mm_add_ps(result, _mm_mul_ps(row, _mm_set1_ps(weightsY[j])));
+        }
+
+        // The negative lobes can ring below zero next to bright pixels
+        return _mm_max_ps(result, _mm_setzero_ps());
+    }
+}
+
+float2 GetHaltonPixelOffset(uint32_t frameIndex)
+{
+    // Same 16 frame cycle as TemporalAntiAliasingPass, skipping the 0 of the sequence
+    const uint32_t index = (frameIndex % 16) + 1;
+    return float2(VanDerCorput(2, index), VanDerCorput(3, index)) - 0.5f;
+}
+
+CpuTemporalResolver::CpuTemporalResolver(ThreadPool& pool)
+    : m_Pool(pool)
+{
+}
+
+void CpuTemporalResolver::Reset()
+{
+    m_HistoryValid = false;
+}
+
+void CpuTemporalResolver::Resolve(uint32_t width, uint32_t height, const float4* color, const float2* motionVectors,
+    const CpuTemporalResolveParameters& params)
+{
+    if (width != m_Width || height != m_Height)
+    {
+        m_Width = width;
+        m_Height = height;
+        m_History[0].assign(size_t(width) * height, float4(0.f));
+        m_History[1].assign(size_t(width) * height, float4(0.f));
+        m_HistoryValid = false;
+    }
+
+    if (width == 0 || height == 0)
+        return;
+
+    const float4* history = m_History[m_Current].data();
+    float4* output = m_History[1 - m_Current].data();
+    const bool historyValid = m_HistoryValid;
+
+    const uint32_t tilesX = (width + c_TileSize - 1) / c_TileSize;
+    const uint32_t tilesY = (height + c_TileSize - 1) / c_TileSize;
+
+    m_Pool.ParallelFor(tilesX * tilesY, [&](uint32_t tile)
+    {
+        const uint32_t tileX = (tile % tilesX) * c_TileSize;
+        const uint32_t tileY = (tile / tilesX) * c_TileSize;
+        const uint32_t endX = std::min(tileX + c_TileSize, width);
+        const uint32_t endY = std::min(tileY + c_TileSize, height);
+
+        const __m128 maxRadiance = _mm_set1_ps(params.maxRadiance);
+        const __m128 newFrameWeight = _mm_set1_ps(params.newFrameWeight);
+        const __m128 gamma = _mm_set1_ps(params.varianceGamma);
+        const __m128 ninth = _mm_set1_ps(1.f / 9.f);
+
+        for (uint32_t y = tileY; y < endY; y++)
+        {
+            for (uint32_t x = tileX; x < endX; x++)
+            {
+                const size_t index = size_t(y) * width + x;
+                const __m128 current = _mm_min_ps(_mm_loadu_ps(&color[index].x), maxRadiance);
+
+                float2 previousPosition = float2(float(x), float(y));
+                if (motionVectors)
+                    previousPosition += motionVectors[index];
+
+                const bool onScreen = previousPosition.x > -0.5f && previousPosition.y > -0.5f &&
+                    previousPosition.x < float(width) - 0.5f && previousPosition.y < float(height) - 0.5f;
+
+                if (!historyValid || !onScreen)
+                {
+                    _mm_storeu_ps(&output[index].x, current);
+                    continue;
+                }
+
+                __m128 previous = SampleHistory(history, width, height, previousPosition);
+
+                if (params.clamp != CpuTemporalClamp::None)
+                {
+                    __m128 low = current;
+                    __m128 high = current;
+                    __m128 sum = _mm_setzero_ps();
+                    __m128 sumSquares = _mm_setzero_ps();
+
+                    for (int dy = -1; dy <= 1; dy++)
+                    {
+                        for (int dx = -1; dx <= 1; dx++)
+                        {
+                            const __m128 neighbor = _mm_min_ps(Load(color, width, height, int(x) + dx, int(y) + dy), maxRadiance);
+                            low = _mm_min_ps(low, neighbor);
+                            high = _mm_max_ps(high, neighbor);
+                            sum = _mm_add_ps(sum, neighbor);
+                            sumSquares = _mm_add_ps(sumSquares, _mm_mul_ps(neighbor, neighbor));
+                        }
+                    }
+
+                    if (params.clamp == CpuTemporalClamp::Variance)
+                    {
+                        const __m128 mean = _mm_mul_ps(sum, ninth);
+                        const __m128 variance = _mm_max_ps(_mm_sub_ps(_mm_mul_ps(sumSquares, ninth), _mm_mul_ps(mean, mean)), _mm_setzero_ps());
+                        const __m128 extent = _mm_mul_ps(_mm_sqrt_ps(variance), gamma);
+                        low = _mm_sub_ps(mean, extent);
+                        high = _mm_add_ps(mean, extent);
+                    }
+
+                    previous = _mm_min_ps(_mm_max_ps(previous, low), high);
+                }
+
+                const __m128 resolved = _mm_add_ps(previous, _mm_mul_ps(_mm_sub_ps(current, previous), newFrameWeight));
+                _mm_storeu_ps(&output[index].x, resolved);
+            }
+        }
+    });
+
+    m_Current = 1 - m_Current;
+    m_HistoryValid = true;
+}
@@ -0,0 +1,64 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "TaskGraph.h"
+
+#include <donut/core/math/math.h>
+
+#include <vector>
+
+// How the reprojected history is limited to the colors around the current pixel
+enum class CpuTemporalClamp
+{
+    None,
+    MinMax,     // the bounding box of the 3x3 neighborhood, like TemporalAntiAliasingPass
+    Variance,   // mean +- varianceGamma standard deviations of the 3x3 neighborhood
+};
+
+struct CpuTemporalResolveParameters
+{
+    float newFrameWeight = 0.1f;    // TemporalAntiAliasingParameters::newFrameWeight
+    CpuTemporalClamp clamp = CpuTemporalClamp::MinMax;
+    float varianceGamma = 1.f;
+    float maxRadiance = 10000.f;    // input colors are clamped to this before they enter the history
+};
+
+// Pixel offset of a frame for TemporalAntiAliasingJitter::Halton, in [-0.5, 0.5)
+dm::float2 GetHaltonPixelOffset(uint32_t frameIndex);
+
+// CPU version of the temporal resolve for offline and automated runs: the history is reprojected with the motion
+// vectors, clamped to the neighborhood of the current pixel and blended exponentially with the new frame.
+// Tiles run on the pool and every pixel is one SSE vector, several 4K frames per second on a desktop CPU.
+class CpuTemporalResolver
+{
+public:
+    explicit CpuTemporalResolver(ThreadPool& pool);
+
+    // Drops the history, the next frame is output as is
+    void Reset();
+
+    // color holds width * height jittered frame colors row by row. motionVectors holds the offset in pixels from each
+    // pixel to where its surface was in the previous frame, like the MotionVectors target; nullptr for a static view.
+    // A new size drops the history.
+    void Resolve(uint32_t width, uint32_t height, const dm::float4* color, const dm::float2* motionVectors,
+        const CpuTemporalResolveParameters& params);
+
+    [[nodiscard]] const std::vector<dm::float4>& GetOutput() const { return m_History[m_Current]; }
+
+private:
+    ThreadPool& m_Pool;
+    std::vector<dm::float4> m_History[2];
+    uint32_t m_Current = 0;
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+    bool m_HistoryValid = false;
+};
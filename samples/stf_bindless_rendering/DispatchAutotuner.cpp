@@ -0,0 +1,254 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "DispatchAutotuner.h"
+
+#include <json/json.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+using namespace donut::math;
+
+#include "dispatch_swizzle.h"
+
+namespace
+{
+    const char* const c_SwizzleNames[] = { "None", "Morton", "ColumnStrips" };
+    const char* const c_LaneLayoutNames[] = { "None", "RowLinear16x2", "QuadZ16x2" };
+
+    template <size_t N>
+    bool FindName(const char* const (&names)[N], const std::string& name, uint32_t& index)
+    {
+        for (uint32_t i = 0; i < N; i++)
+        {
+            if (name == names[i])
+            {
+                index = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string GetResolutionKey(uint2 resolution)
+    {
+        return std::to_string(resolution.x) + "x" + std::to_string(resolution.y);
+    }
+
+    bool ParseSize(const std::string& text, uint2& size)
+    {
+        unsigned x = 0;
+        unsigned y = 0;
+        if (sscanf(text.c_str(), "%ux%u", &x, &y) != 2 || x == 0 || y == 0)
+            return false;
+        size = uint2(x, y);
+        return true;
+    }
+}
+
+std::vector<CpuDispatchOrder> DispatchAutotuner::GetCandidates()
+{
+    const uint2 groupSizes[] = { uint2(8, 8), uint2(16, 8), uint2(8, 16), uint2(16, 16) };
+    const std::pair<uint32_t, uint32_t> swizzles[] = {
+        { STF_GROUP_SWIZZLE_NONE, 0 },
+        { STF_GROUP_SWIZZLE_MORTON, 4 },
+        { STF_GROUP_SWIZZLE_MORTON, 8 },
+        { STF_GROUP_SWIZZLE_COLUMN_STRIPS, 4 },
+        { STF_GROUP_SWIZZLE_COLUMN_STRIPS, 8 },
+        { STF_GROUP_SWIZZLE_COLUMN_STRIPS, 16 },
+    };
+    const CpuLaneLayout laneLayouts[] = { CpuLaneLayout::None, CpuLaneLayout::RowLinear16x2, CpuLaneLayout::QuadZ16x2 };
+
+    std::vector<CpuDispatchOrder> candidates;
+    for (uint2 groupSize : groupSizes)
+    {
+        for (const auto& [swizzle, swizzleSize] : swizzles)
+        {
+            for (CpuLaneLayout laneLayout : laneLayouts)
+            {
+                if (laneLayout != CpuLaneLayout::None && groupSize.x != 16)
+                    continue;
+
+                CpuDispatchOrder order;
+                order.groupSize = groupSize;
+                order.laneLayout = laneLayout;
+                order.swizzle = swizzle;
+                order.swizzleSize = swizzleSize;
+                candidates.push_back(order);
+            }
+        }
+    }
+
+    return candidates;
+}
+
+std::string DispatchAutotuner::GetCandidateName(const CpuDispatchOrder& order)
+{
+    std::string name = std::to_string(order.groupSize.x) + "x" + std::to_string(order.groupSize.y) + " " + c_SwizzleNames[order.swizzle];
+    if (order.swizzle != STF_GROUP_SWIZZLE_NONE)
+        name += std::to_string(order.swizzleSize);
+    if (order.laneLayout != CpuLaneLayout::None)
+        name += std::string(" ") + c_LaneLayoutNames[uint32_t(order.laneLayout)];
+    return name;
+}
+
+void DispatchAutotuner::Start(uint2 resolution, const std::string& metric, uint32_t warmupFrames, uint32_t measuredFrames)
+{
+    m_Resolution = resolution;
+    m_Metric = metric;
+    m_WarmupFrames = warmupFrames;
+    m_MeasuredFrames = std::max(measuredFrames, 1u);
+
+    m_Searching = !m_Candidates.empty();
+    m_Current = 0;
+    m_Frame = 0;
+    m_Samples.clear();
+    m_HasBest = false;
+}
+
+void DispatchAutotuner::Cancel()
+{
+    m_Searching = false;
+}
+
+float DispatchAutotuner::GetProgress() const
+{
+    if (!m_Searching)
+        return 1.f;
+
+    const float framesPerCandidate = float(m_WarmupFrames + m_MeasuredFrames);
+    return (float(m_Current) + float(m_Frame) / framesPerCandidate) / float(m_Candidates.size());
+}
+
+bool DispatchAutotuner::Report(uint32_t index, float cost)
+{
+    if (!m_Searching || index != m_Current)
+        return false;
+
+    if (m_Frame++ >= m_WarmupFrames)
+        m_Samples.push_back(cost);
+
+    if (m_Samples.size() < m_MeasuredFrames)
+        return false;
+
+    std::nth_element(m_Samples.begin(), m_Samples.begin() + m_Samples.size() / 2, m_Samples.end());
+    const float median = m_Samples[m_Samples.size() / 2];
+    if (!m_HasBest || median < m_Best.cost)
+    {
+        m_Best.order = m_Candidates[m_Current];
+        m_Best.cost = median;
+        m_Best.metric = m_Metric;
+        m_HasBest = true;
+    }
+
+    m_Samples.clear();
+    m_Frame = 0;
+    if (++m_Current < m_Candidates.size())
+        return false;
+
+    m_Current = 0;
+    m_Searching = false;
+    SetResult(m_Resolution, m_Best);
+    return true;
+}
+
+const DispatchTuning* DispatchAutotuner::FindResult(uint2 resolution) const
+{
+    auto it = m_Results.find({ resolution.x, resolution.y });
+    return it != m_Results.end() ? &it->second : nullptr;
+}
+
+void DispatchAutotuner::SetResult(uint2 resolution, const DispatchTuning& tuning)
+{
+    m_Results[{ resolution.x, resolution.y }] = tuning;
+}
+
+bool DispatchAutotuner::Load(const std::filesystem::path& fileName, std::string& error)
+{
+    std::ifstream file(fileName);
+    if (!file.is_open())
+    {
+        error = "Cannot open '" + fileName.generic_string() + "'";
+        return false;
+    }
+
+    Json::CharReaderBuilder builder;
+    Json::Value root;
+    std::string parseErrors;
+    if (!Json::parseFromStream(builder, file, &root, &parseErrors) || !root.isObject())
+    {
+        error = "Cannot parse '" + fileName.generic_string() + "': " + parseErrors;
+        return false;
+    }
+
+    for (const std::string& key : root.getMemberNames())
+    {
+        const Json::Value& node = root[key];
+        uint2 resolution;
+        DispatchTuning tuning;
+        uint32_t laneLayout = 0;
+        if (!ParseSize(key, resolution) ||
+            !ParseSize(node["groupSize"].asString(), tuning.order.groupSize) ||
+            !FindName(c_SwizzleNames, node["swizzle"].asString(), tuning.order.swizzle) ||
+            !FindName(c_LaneLayoutNames, node["laneLayout"].asString(), laneLayout) ||
+            !node["swizzleSize"].isUInt())
+        {
+            error = fileName.generic_string() + ": invalid entry '" + key + "'";
+            return false;
+        }
+
+        tuning.order.swizzleSize = node["swizzleSize"].asUInt();
+        tuning.order.laneLayout = CpuLaneLayout(laneLayout);
+        tuning.cost = node["cost"].asFloat();
+        tuning.metric = node["metric"].asString();
+        SetResult(resolution, tuning);
+    }
+
+    return true;
+}
+
+bool DispatchAutotuner::Save(const std::filesystem::path& fileName, std::string& error) const
+{
+    Json::Value root(Json::objectValue);
+    for (const auto& [resolution, tuning] : m_Results)
+    {
+        Json::Value& node = root[GetResolutionKey(uint2(resolution.first, resolution.second))];
+        node["groupSize"] = std::to_string(tuning.order.groupSize.x) + "x" + std::to_string(tuning.order.groupSize.y);
+        node["swizzle"] = c_SwizzleNames[tuning.order.swizzle];
+        node["swizzleSize"] = tuning.order.swizzleSize;
+        node["laneLayout"] = c_LaneLayoutNames[uint32_t(tuning.order.laneLayout)];
+        node["cost"] = tuning.cost;
+        node["metric"] = tuning.metric;
+    }
+
+    std::ofstream file(fileName);
+    if (!file.is_open())
+    {
+        error = "Cannot write '" + fileName.generic_string() + "'";
+        return false;
+    }
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "    ";
+    std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+    writer->write(root, &file);
+    file << "\n";
+
+    if (!file.good())
+    {
+        error = "Failed writing '" + fileName.generic_string() + "'";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,79 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "TexelTrace.h"
+
+#include <donut/core/math/math.h>
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct DispatchTuning
+{
+    CpuDispatchOrder order;
+    float cost = 0.f;
+    std::string metric;     // what cost measures, e.g. "gpuMilliseconds"
+};
+
+// Searches thread group shape, group swizzle and lane layout of the compute pipeline. The caller runs the current
+// candidate and reports one cost per frame, lower is better, from GPU timer queries or from a CPU score such as the
+// cache misses of a texel trace. Each candidate gets warmupFrames unscored frames and is scored by the median of the
+// following measuredFrames. The best candidate is kept per resolution.
+class DispatchAutotuner
+{
+public:
+    // Group sizes of StfThreadGroupSize times the swizzles, lane layout overrides only where a row of the group holds
+    // 16 threads, as the 16x2 layouts of the shader assume
+    static std::vector<CpuDispatchOrder> GetCandidates();
+    static std::string GetCandidateName(const CpuDispatchOrder& order);
+
+    void Start(dm::uint2 resolution, const std::string& metric, uint32_t warmupFrames, uint32_t measuredFrames);
+    void Cancel();
+
+    [[nodiscard]] bool IsSearching() const { return m_Searching; }
+    [[nodiscard]] uint32_t GetCurrentIndex() const { return m_Current; }
+    [[nodiscard]] const CpuDispatchOrder& GetCandidate(uint32_t index) const { return m_Candidates[index]; }
+    [[nodiscard]] const CpuDispatchOrder& GetCurrentCandidate() const { return m_Candidates[m_Current]; }
+    [[nodiscard]] size_t GetCandidateCount() const { return m_Candidates.size(); }
+    [[nodiscard]] float GetProgress() const;
+
+    // The cost of one frame rendered with candidate 'index'. Costs of other candidates than the current one arrive
+    // late from timer queries of earlier frames and are dropped. Returns true when this finished the search.
+    bool Report(uint32_t index, float cost);
+
+    // Best candidate of a finished search at this resolution, or of the loaded file
+    [[nodiscard]] const DispatchTuning* FindResult(dm::uint2 resolution) const;
+    void SetResult(dm::uint2 resolution, const DispatchTuning& tuning);
+
+    // JSON object with one entry per resolution, e.g. "3840x2160"
+    bool Load(const std::filesystem::path& fileName, std::string& error);
+    bool Save(const std::filesystem::path& fileName, std::string& error) const;
+
+private:
+    std::vector<CpuDispatchOrder> m_Candidates = GetCandidates();
+    std::map<std::pair<uint32_t, uint32_t>, DispatchTuning> m_Results;
+
+    dm::uint2 m_Resolution = 0u;
+    std::string m_Metric;
+    uint32_t m_WarmupFrames = 0;
+    uint32_t m_MeasuredFrames = 1;
+
+    bool m_Searching = false;
+    uint32_t m_Current = 0;
+    uint32_t m_Frame = 0;
+    std::vector<float> m_Samples;
+    DispatchTuning m_Best;
+    bool m_HasBest = false;
+};
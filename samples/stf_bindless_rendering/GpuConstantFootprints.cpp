@@ -0,0 +1,140 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "GpuConstantFootprints.h"
+
+#include <donut/core/math/math.h>
+#include <donut/engine/ShaderFactory.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace donut::math;
+
+#include "stf_constant_footprint_cb.h"
+
+GpuConstantFootprints::GpuConstantFootprints(nvrhi::IDevice* device, donut::engine::ShaderFactory& shaderFactory, uint64_t byteSize)
+    : m_Device(device)
+{
+    m_Shader = shaderFactory.CreateShader("app/constant_footprint_cs.hlsl", "main", nullptr, nvrhi::ShaderType::Compute);
+
+    auto layoutDesc = nvrhi::BindingLayoutDesc()
+        .setVisibility(nvrhi::ShaderType::Compute)
+        .addItem(nvrhi::BindingLayoutItem::Texture_SRV(0))
+        .addItem(nvrhi::BindingLayoutItem::RawBuffer_UAV(0))
+        .addItem(nvrhi::BindingLayoutItem::PushConstants(0, sizeof(ConstantFootprintBuildConstants)));
+
+    m_BindingLayout = device->createBindingLayout(layoutDesc);
+
+    auto pipelineDesc = nvrhi::ComputePipelineDesc()
+        .addBindingLayout(m_BindingLayout)
+        .setComputeShader(m_Shader);
+
+    m_Pipeline = device->createComputePipeline(pipelineDesc);
+
+    nvrhi::BufferDesc bufferDesc;
+    bufferDesc.byteSize = std::max<uint64_t>(byteSize, STF_CONSTANT_FOOTPRINT_MAX_TEXTURES * sizeof(uint32_t));
+    bufferDesc.canHaveUAVs = true;
+    bufferDesc.canHaveRawViews = true;
+    bufferDesc.initialState = nvrhi::ResourceStates::ShaderResource;
+    bufferDesc.keepInitialState = true;
+    bufferDesc.debugName = "StfConstantFootprints";
+    m_Buffer = m_Device->createBuffer(bufferDesc);
+}
+
+void GpuConstantFootprints::Build(nvrhi::ICommandList* commandList, const std::map<uint32_t, nvrhi::ITexture*>& textures)
+{
+    m_Stats = GpuConstantFootprintStats();
+
+    const uint64_t capacity = m_Buffer->getDesc().byteSize / sizeof(uint32_t);
+    std::vector<uint32_t> header(STF_CONSTANT_FOOTPRINT_MAX_TEXTURES, 0);
+    uint64_t end = header.size();
+
+    commandList->beginMarker("Constant Footprints");
+
+    for (const auto& [textureIndex, texture] : textures)
+    {
+        const nvrhi::TextureDesc& desc = texture->getDesc();
+        if (textureIndex >= STF_CONSTANT_FOOTPRINT_MAX_TEXTURES || desc.dimension != nvrhi::TextureDimension::Texture2D)
+        {
+            m_Stats.skippedTextures++;
+            continue;
+        }
+
+        // The table, then the bits of every mip and level
+        const uint32_t tableOffset = uint32_t(end);
+        std::vector<uint32_t> table(desc.mipLevels * STF_CONSTANT_FOOTPRINT_LEVELS);
+        std::vector<ConstantFootprintBuildConstants> passes;
+        uint64_t textureEnd = end + table.size();
+
+        for (uint32_t mip = 0; mip < desc.mipLevels; mip++)
+        {
+            const uint2 size = uint2(std::max(desc.width >> mip, 1u), std::max(desc.height >> mip, 1u));
+            for (uint32_t level = 0; level < STF_CONSTANT_FOOTPRINT_LEVELS; level++)
+            {
+                const uint32_t stride = 2u << level;
+
+                ConstantFootprintBuildConstants pass = {};
+                pass.mip = mip;
+                pass.level = level;
+                pass.blocksX = (size.x + stride - 1) / stride;
+                pass.blocksY = (size.y + stride - 1) / stride;
+                pass.outputOffset = uint32_t(textureEnd);
+                if (level > 0)
+                {
+                    pass.inputOffset = passes.back().outputOffset;
+                    pass.inputBlocksX = passes.back().blocksX;
+                    pass.inputBlocksY = passes.back().blocksY;
+                }
+
+                table[mip * STF_CONSTANT_FOOTPRINT_LEVELS + level] = pass.outputOffset;
+                textureEnd += (uint64_t(pass.blocksX) * pass.blocksY + 31) / 32;
+                passes.push_back(pass);
+            }
+        }
+
+        if (textureEnd > capacity)
+        {
+            m_Stats.skippedTextures++;
+            continue;
+        }
+
+        header[textureIndex] = tableOffset;
+        end = textureEnd;
+        commandList->writeBuffer(m_Buffer, table.data(), table.size() * sizeof(uint32_t), uint64_t(tableOffset) * sizeof(uint32_t));
+
+        auto setDesc = nvrhi::BindingSetDesc()
+            .addItem(nvrhi::BindingSetItem::Texture_SRV(0, texture))
+            .addItem(nvrhi::BindingSetItem::RawBuffer_UAV(0, m_Buffer))
+            .addItem(nvrhi::BindingSetItem::PushConstants(0, sizeof(ConstantFootprintBuildConstants)));
+
+        nvrhi::BindingSetHandle bindingSet = m_Device->createBindingSet(setDesc, m_BindingLayout);
+
+        auto state = nvrhi::ComputeState()
+            .setPipeline(m_Pipeline)
+            .addBindingSet(bindingSet);
+
+        // Every level reads the one below, the UAV barriers between the dispatches order them
+        commandList->setComputeState(state);
+        for (const ConstantFootprintBuildConstants& pass : passes)
+        {
+            const uint32_t words = (pass.blocksX * pass.blocksY + 31) / 32;
+            commandList->setPushConstants(&pass, sizeof(pass));
+            commandList->dispatch((words + 63) / 64);
+        }
+
+        m_Stats.textures++;
+    }
+
+    commandList->writeBuffer(m_Buffer, header.data(), header.size() * sizeof(uint32_t), 0);
+    commandList->endMarker();
+
+    m_Stats.bytes = end * sizeof(uint32_t);
+}
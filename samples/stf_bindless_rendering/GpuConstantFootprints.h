@@ -0,0 +1,51 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+
+#include <cstdint>
+#include <map>
+
+namespace donut::engine
+{
+    class ShaderFactory;
+}
+
+struct GpuConstantFootprintStats
+{
+    uint32_t textures = 0;
+    uint32_t skippedTextures = 0;   // did not fit into the buffer, they never take the early-out
+    uint64_t bytes = 0;
+};
+
+// The constant block buffer of stf_constant_footprint.hlsli, built by constant_footprint_cs.hlsl from the scene
+// textures once they are uploaded. The buffer has a fixed size so that the binding sets can be created before the
+// scene is loaded; textures that do not fit get no blocks.
+class GpuConstantFootprints
+{
+public:
+    GpuConstantFootprints(nvrhi::IDevice* device, donut::engine::ShaderFactory& shaderFactory, uint64_t byteSize);
+
+    [[nodiscard]] nvrhi::IBuffer* GetBuffer() const { return m_Buffer; }
+    [[nodiscard]] const GpuConstantFootprintStats& GetStats() const { return m_Stats; }
+
+    // Replaces the blocks of all textures, by bindless texture descriptor
+    void Build(nvrhi::ICommandList* commandList, const std::map<uint32_t, nvrhi::ITexture*>& textures);
+
+private:
+    nvrhi::DeviceHandle m_Device;
+    nvrhi::ShaderHandle m_Shader;
+    nvrhi::BindingLayoutHandle m_BindingLayout;
+    nvrhi::ComputePipelineHandle m_Pipeline;
+    nvrhi::BufferHandle m_Buffer;
+    GpuConstantFootprintStats m_Stats;
+};
@@ -0,0 +1,120 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "GpuSamplingStats.h"
+#include "stf_stats_cb.h"
+
+namespace
+{
+    constexpr uint64_t c_BufferSize = uint64_t(STF_STATS_MAX_TEXTURES) * STF_STATS_COUNTER_COUNT * sizeof(uint32_t);
+}
+
+GpuSamplingStats::GpuSamplingStats(nvrhi::IDevice* device)
+    : m_Device(device)
+{
+    nvrhi::BufferDesc bufferDesc;
+    bufferDesc.byteSize = c_BufferSize;
+    bufferDesc.canHaveUAVs = true;
+    bufferDesc.canHaveRawViews = true;
+    bufferDesc.initialState = nvrhi::ResourceStates::UnorderedAccess;
+    bufferDesc.keepInitialState = true;
+    bufferDesc.debugName = "StfSamplingStats";
+    m_Buffer = m_Device->createBuffer(bufferDesc);
+
+    nvrhi::BufferDesc readbackDesc;
+    readbackDesc.byteSize = c_BufferSize;
+    readbackDesc.cpuAccess = nvrhi::CpuAccessMode::Read;
+    readbackDesc.initialState = nvrhi::ResourceStates::CopyDest;
+    readbackDesc.keepInitialState = true;
+    readbackDesc.debugName = "StfSamplingStatsReadback";
+
+    for (Readback& readback : m_Readbacks)
+    {
+        readback.buffer = m_Device->createBuffer(readbackDesc);
+        readback.query = m_Device->createEventQuery();
+    }
+}
+
+bool GpuSamplingStats::BeginFrame(nvrhi::ICommandList* commandList)
+{
+    if (m_Readbacks[m_Current].inFlight)
+        return false;
+
+    commandList->clearBufferUInt(m_Buffer, 0);
+    return true;
+}
+
+void GpuSamplingStats::EndFrame(nvrhi::ICommandList* commandList, uint32_t magMethod)
+{
+    Readback& readback = m_Readbacks[m_Current];
+    commandList->copyBuffer(readback.buffer, 0, m_Buffer, 0, c_BufferSize);
+    readback.magMethod = magMethod;
+    readback.recorded = true;
+}
+
+void GpuSamplingStats::Submitted()
+{
+    Readback& readback = m_Readbacks[m_Current];
+    if (!readback.recorded)
+        return;
+
+    m_Device->setEventQuery(readback.query, nvrhi::CommandQueue::Graphics);
+    readback.recorded = false;
+    readback.inFlight = true;
+    m_Current = (m_Current + 1) % c_ReadbackCount;
+}
+
+uint32_t GpuSamplingStats::Poll(StfSamplingStats& stats, bool wait)
+{
+    uint32_t frames = 0;
+    for (Readback& readback : m_Readbacks)
+    {
+        if (!readback.inFlight)
+            continue;
+
+        if (wait)
+            m_Device->waitEventQuery(readback.query);
+        else if (!m_Device->pollEventQuery(readback.query))
+            continue;
+
+        const uint32_t* counters = static_cast<const uint32_t*>(m_Device->mapBuffer(readback.buffer, nvrhi::CpuAccessMode::Read));
+        if (counters)
+        {
+            for (uint32_t texture = 0; texture < STF_STATS_MAX_TEXTURES; texture++)
+            {
+                const uint32_t* entry = counters + texture * STF_STATS_COUNTER_COUNT;
+                if (entry[STF_STATS_WAVES] == 0)
+                    continue;
+
+                StfSamplingCounters frameCounters;
+                frameCounters.samples = entry[STF_STATS_SAMPLES];
+                frameCounters.magnifiedSamples = entry[STF_STATS_MAGNIFIED_SAMPLES];
+                frameCounters.waveFilteredSamples = entry[STF_STATS_WAVE_FILTERED_SAMPLES];
+                frameCounters.quadFilteredSamples = entry[STF_STATS_QUAD_FILTERED_SAMPLES];
+                frameCounters.fallbackSamples = entry[STF_STATS_FALLBACK_SAMPLES];
+                frameCounters.texelsFetched = entry[STF_STATS_TEXELS_FETCHED];
+                frameCounters.sharingLanes = entry[STF_STATS_SHARING_LANES];
+                frameCounters.waves = entry[STF_STATS_WAVES];
+                frameCounters.distinctTexels = entry[STF_STATS_DISTINCT_TEXELS];
+                frameCounters.constantSamples = entry[STF_STATS_CONSTANT_SAMPLES];
+                frameCounters.extraTaps = entry[STF_STATS_EXTRA_TAPS];
+                stats.Add(texture, readback.magMethod, frameCounters);
+            }
+
+            m_Device->unmapBuffer(readback.buffer);
+            frames++;
+        }
+
+        m_Device->resetEventQuery(readback.query);
+        readback.inFlight = false;
+    }
+
+    return frames;
+}
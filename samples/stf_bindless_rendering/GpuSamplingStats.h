@@ -0,0 +1,57 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "StfSamplingStats.h"
+
+#include <nvrhi/nvrhi.h>
+
+#include <array>
+
+// The stats buffer of stf_stats.hlsli. Frames that collect clear it first and copy it to a readback buffer at the
+// end; the copies are read a few frames later when their event query has completed, so collecting never stalls.
+class GpuSamplingStats
+{
+public:
+    explicit GpuSamplingStats(nvrhi::IDevice* device);
+
+    [[nodiscard]] nvrhi::IBuffer* GetBuffer() const { return m_Buffer; }
+
+    // Clears the counters before the passes of the frame. False when all readback buffers are in flight,
+    // the frame must not collect then.
+    bool BeginFrame(nvrhi::ICommandList* commandList);
+
+    // Copies the counters of the frame, magMethod is its STF_MAGNIFICATION_METHOD_*
+    void EndFrame(nvrhi::ICommandList* commandList, uint32_t magMethod);
+
+    // Called after the command list of EndFrame was executed
+    void Submitted();
+
+    // Adds the finished frames to stats, all frames in flight when wait is set. Returns the number of frames added.
+    uint32_t Poll(StfSamplingStats& stats, bool wait);
+
+private:
+    struct Readback
+    {
+        nvrhi::BufferHandle buffer;
+        nvrhi::EventQueryHandle query;
+        uint32_t magMethod = 0;
+        bool recorded = false;      // copied, not yet submitted
+        bool inFlight = false;
+    };
+
+    static constexpr size_t c_ReadbackCount = 4;
+
+    nvrhi::DeviceHandle m_Device;
+    nvrhi::BufferHandle m_Buffer;
+    std::array<Readback, c_ReadbackCount> m_Readbacks;
+    size_t m_Current = 0;
+};
@@ -0,0 +1,72 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "GpuTexelResolvePass.h"
+
+#include <donut/engine/CommonRenderPasses.h>
+#include <donut/engine/ShaderFactory.h>
+#include <donut/engine/View.h>
+
+GpuTexelResolvePass::GpuTexelResolvePass(nvrhi::IDevice* device, donut::engine::ShaderFactory& shaderFactory,
+    std::shared_ptr<donut::engine::CommonRenderPasses> commonPasses, nvrhi::IBindingLayout* bindlessLayout)
+    : m_Device(device)
+    , m_CommonPasses(commonPasses)
+    , m_BindlessLayout(bindlessLayout)
+{
+    m_PixelShader = shaderFactory.CreateShader("app/gbuffer_texel_resolve_ps.hlsl", "main", nullptr, nvrhi::ShaderType::Pixel);
+
+    auto layoutDesc = nvrhi::BindingLayoutDesc()
+        .setVisibility(nvrhi::ShaderType::Pixel)
+        .addItem(nvrhi::BindingLayoutItem::Texture_SRV(0))
+        .addItem(nvrhi::BindingLayoutItem::Texture_SRV(1))
+        .addItem(nvrhi::BindingLayoutItem::StructuredBuffer_SRV(2));
+
+    m_BindingLayout = device->createBindingLayout(layoutDesc);
+}
+
+void GpuTexelResolvePass::Render(nvrhi::ICommandList* commandList, nvrhi::IFramebuffer* framebuffer, const donut::engine::IView& view,
+    nvrhi::ITexture* texelIds, nvrhi::ITexture* tangentFrames, nvrhi::IBuffer* materialBuffer, nvrhi::IDescriptorTable* descriptorTable)
+{
+    if (!m_Pipeline)
+    {
+        nvrhi::GraphicsPipelineDesc pipelineDesc;
+        pipelineDesc.primType = nvrhi::PrimitiveType::TriangleStrip;
+        pipelineDesc.VS = m_CommonPasses->m_FullscreenVS;
+        pipelineDesc.PS = m_PixelShader;
+        pipelineDesc.bindingLayouts = { m_BindingLayout, m_BindlessLayout };
+        pipelineDesc.renderState.rasterState.setCullNone();
+        pipelineDesc.renderState.depthStencilState.depthTestEnable = false;
+        pipelineDesc.renderState.depthStencilState.stencilEnable = false;
+
+        m_Pipeline = m_Device->createGraphicsPipeline(pipelineDesc, framebuffer);
+    }
+
+    auto setDesc = nvrhi::BindingSetDesc()
+        .addItem(nvrhi::BindingSetItem::Texture_SRV(0, texelIds))
+        .addItem(nvrhi::BindingSetItem::Texture_SRV(1, tangentFrames))
+        .addItem(nvrhi::BindingSetItem::StructuredBuffer_SRV(2, materialBuffer));
+
+    nvrhi::BindingSetHandle bindingSet = m_Device->createBindingSet(setDesc, m_BindingLayout);
+
+    auto state = nvrhi::GraphicsState()
+        .setPipeline(m_Pipeline)
+        .setFramebuffer(framebuffer)
+        .setViewport(view.GetViewportState())
+        .addBindingSet(bindingSet)
+        .addBindingSet(descriptorTable);
+
+    commandList->beginMarker("Texel Resolve");
+    commandList->setGraphicsState(state);
+
+    nvrhi::DrawArguments args;
+    args.vertexCount = 4;
+    commandList->draw(args);
+    commandList->endMarker();
+}
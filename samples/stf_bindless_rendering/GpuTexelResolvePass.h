@@ -0,0 +1,44 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <nvrhi/nvrhi.h>
+
+#include <memory>
+
+namespace donut::engine
+{
+    class CommonRenderPasses;
+    class IView;
+    class ShaderFactory;
+}
+
+// The resolve of the deferred texel G-buffer (gbuffer_texel_id.h): a full screen gbuffer_texel_resolve_ps that loads
+// the material textures at the texels the fill stored and writes the albedo, specular, normal and emissive channels,
+// in that order in the framebuffer. The material textures come from the bindless descriptor table of the scene.
+// The pixels are shaded in screen order, not binned by texture.
+class GpuTexelResolvePass
+{
+public:
+    GpuTexelResolvePass(nvrhi::IDevice* device, donut::engine::ShaderFactory& shaderFactory,
+        std::shared_ptr<donut::engine::CommonRenderPasses> commonPasses, nvrhi::IBindingLayout* bindlessLayout);
+
+    void Render(nvrhi::ICommandList* commandList, nvrhi::IFramebuffer* framebuffer, const donut::engine::IView& view,
+        nvrhi::ITexture* texelIds, nvrhi::ITexture* tangentFrames, nvrhi::IBuffer* materialBuffer, nvrhi::IDescriptorTable* descriptorTable);
+
+private:
+    nvrhi::DeviceHandle m_Device;
+    std::shared_ptr<donut::engine::CommonRenderPasses> m_CommonPasses;
+    nvrhi::ShaderHandle m_PixelShader;
+    nvrhi::BindingLayoutHandle m_BindingLayout;
+    nvrhi::BindingLayoutHandle m_BindlessLayout;
+    nvrhi::GraphicsPipelineHandle m_Pipeline;   // created for the first framebuffer, the G-buffer formats do not change
+};
@@ -0,0 +1,780 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "ImageMetrics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <xmmintrin.h>
+
+namespace
+{
+    constexpr float c_Pi = 3.14159265358979f;
+
+    // SSIM constants for a dynamic range of 1
+    constexpr float c_SsimC1 = 0.01f * 0.01f;
+    constexpr float c_SsimC2 = 0.03f * 0.03f;
+    constexpr float c_SsimSigma = 1.5f;
+    constexpr uint32_t c_SsimRadius = 5;
+    constexpr float c_MsSsimWeights[] = { 0.0448f, 0.2856f, 0.3001f, 0.2363f, 0.1333f };
+
+    // FLIP parameters
+    constexpr float c_FlipColorExponent = 0.7f;         // q_c
+    constexpr float c_FlipColorCutoff = 0.4f;           // p_c
+    constexpr float c_FlipColorCutoffError = 0.95f;     // p_t
+    constexpr float c_FlipFeatureWidth = 0.082f;        // degrees
+
+    // Contrast sensitivity of the achromatic, red-green and blue-yellow channels as sums of Gaussians a * exp(-pi^2 x^2 / b)
+    struct CsfTerm
+    {
+        float a;
+        float b;
+    };
+    const std::vector<CsfTerm> c_CsfChannels[3] = {
+        { { 1.f, 0.0047f } },
+        { { 1.f, 0.0053f } },
+        { { 34.1f, 0.04f }, { 13.5f, 0.025f } },
+    };
+
+    // One channel of an image
+    struct Plane
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<float> data;
+
+        Plane() = default;
+        Plane(uint32_t w, uint32_t h) : width(w), height(h), data(size_t(w) * h, 0.f) { }
+
+        float* Row(uint32_t y) { return data.data() + size_t(y) * width; }
+        const float* Row(uint32_t y) const { return data.data() + size_t(y) * width; }
+    };
+
+    struct RgbPlanes
+    {
+        Plane channels[3];
+    };
+
+    void AccumulateScaled(float* output, const float* input, float weight, uint32_t count)
+    {
+        const __m128 scale = _mm_set1_ps(weight);
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(output + i, _mm_add_ps(_mm_loadu_ps(output + i), _mm_mul_ps(_mm_loadu_ps(input + i), scale)));
+        for (; i < count; i++)
+            output[i] += input[i] * weight;
+    }
+
+    // Correlation with kernelX along rows and kernelY along columns, both of odd size, edges clamped
+    void FilterSeparable(ThreadPool& pool, const Plane& input, const std::vector<float>& kernelX,
+        const std::vector<float>& kernelY, Plane& output)
+    {
+        const uint32_t width = input.width;
+        const uint32_t height = input.height;
+        const int radiusX = int(kernelX.size() / 2);
+        const int radiusY = int(kernelY.size() / 2);
+
+        Plane rows(width, height);
+        output = Plane(width, height);
+
+        pool.ParallelFor(height, [&](uint32_t y)
+        {
+            std::vector<float> padded(width + 2 * radiusX);
+            const float* source = input.Row(y);
+            for (int i = 0; i < int(padded.size()); i++)
+                padded[i] = source[std::clamp(i - radiusX, 0, int(width) - 1)];
+
+            float* destination = rows.Row(y);
+            for (size_t k = 0; k < kernelX.size(); k++)
+                AccumulateScaled(destination, padded.data() + k, kernelX[k], width);
+        });
+
+        pool.ParallelFor(height, [&](uint32_t y)
+        {
+            float* destination = output.Row(y);
+            for (size_t k = 0; k < kernelY.size(); k++)
+            {
+                const int row = std::clamp(int(y) + int(k) - radiusY, 0, int(height) - 1);
+                AccumulateScaled(destination, rows.Row(uint32_t(row)), kernelY[k], width);
+            }
+        });
+    }
+
+    std::vector<float> GetGaussianKernel(float sigma, int radius)
+    {
+        std::vector<float> kernel(2 * radius + 1);
+        float sum = 0.f;
+        for (int i = -radius; i <= radius; i++)
+        {
+            kernel[i + radius] = std::exp(-float(i * i) / (2.f * sigma * sigma));
+            sum += kernel[i + radius];
+        }
+        for (float& weight : kernel)
+            weight /= sum;
+        return kernel;
+    }
+
+    // Positive weights sum to 1 and negative weights to -1, like the feature detectors of FLIP
+    void NormalizeSigned(std::vector<float>& kernel)
+    {
+        float positive = 0.f;
+        float negative = 0.f;
+        for (float weight : kernel)
+            (weight > 0.f ? positive : negative) += weight;
+        for (float& weight : kernel)
+            weight /= weight > 0.f ? positive : -negative;
+    }
+
+    float HalfToFloat(uint16_t value)
+    {
+        const uint32_t sign = uint32_t(value & 0x8000) << 16;
+        const uint32_t exponent = (value >> 10) & 0x1f;
+        const uint32_t mantissa = value & 0x3ff;
+
+        if (exponent == 0)
+        {
+            const float denormal = float(mantissa) * (1.f / 16777216.f);
+            return sign ? -denormal : denormal;
+        }
+
+        const uint32_t bits = exponent == 31
+            ? sign | 0x7f800000u | (mantissa << 13)
+            : sign | ((exponent + 112) << 23) | (mantissa << 13);
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    // ACES filmic fit (Narkowicz 2015)
+    float ToneMap(float value)
+    {
+        return (value * (2.51f * value + 0.03f)) / (value * (2.43f * value + 0.59f) + 0.14f);
+    }
+
+    // A curve sampled on [minValue, maxValue] and interpolated linearly, for the transcendentals of every pixel
+    class CurveTable
+    {
+    public:
+        template<typename Function>
+        CurveTable(float minValue, float maxValue, uint32_t size, Function function)
+            : m_Min(minValue)
+            , m_Scale(float(size - 1) / (maxValue - minValue))
+            , m_Values(size + 1)
+        {
+            for (uint32_t i = 0; i < size; i++)
+                m_Values[i] = function(minValue + float(i) / m_Scale);
+            m_Values[size] = m_Values[size - 1];
+        }
+
+        float operator()(float value) const
+        {
+            const float position = std::clamp((value - m_Min) * m_Scale, 0.f, float(m_Values.size() - 2));
+            const uint32_t index = uint32_t(position);
+            return m_Values[index] + (m_Values[index + 1] - m_Values[index]) * (position - float(index));
+        }
+
+    private:
+        float m_Min;
+        float m_Scale;
+        std::vector<float> m_Values;
+    };
+
+    // Exact below 1/4096, where the table would not follow the slope
+    float LinearToSrgb(float value)
+    {
+        static const CurveTable table(0.f, 1.f, 4097, [](float x)
+        {
+            return x <= 0.0031308f ? x * 12.92f : 1.055f * std::pow(x, 1.f / 2.4f) - 0.055f;
+        });
+        return value < 1.f / 4096.f ? value * 12.92f : table(value);
+    }
+
+    // Linear display colors in [0, 1]. NaN counts as black.
+    RgbPlanes LoadImage(ThreadPool& pool, const MetricImage& image, const ImageMetricsOptions& options)
+    {
+        RgbPlanes planes;
+        for (Plane& plane : planes.channels)
+            plane = Plane(image.width, image.height);
+
+        const size_t pixelSize = image.format == MetricImageFormat::Float16 ? 8 : 16;
+        const size_t rowPitch = image.rowPitch ? image.rowPitch : pixelSize * image.width;
+
+        pool.ParallelFor(image.height, [&](uint32_t y)
+        {
+            const uint8_t* row = static_cast<const uint8_t*>(image.data) + rowPitch * y;
+            for (uint32_t x = 0; x < image.width; x++)
+            {
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    float value = image.format == MetricImageFormat::Float16
+                        ? HalfToFloat(reinterpret_cast<const uint16_t*>(row)[x * 4 + c])
+                        : reinterpret_cast<const float*>(row)[x * 4 + c];
+
+                    if (std::isnan(value))
+                        value = 0.f;
+                    if (options.hdr)
+                        value = ToneMap(std::max(value * options.exposure, 0.f));
+
+                    planes.channels[c].Row(y)[x] = std::clamp(value, 0.f, 1.f);
+                }
+            }
+        });
+
+        return planes;
+    }
+
+    // sRGB encoded colors and their luma, what PSNR and SSIM are computed on
+    void EncodeSrgb(ThreadPool& pool, const RgbPlanes& rgb, RgbPlanes& encoded, Plane& luma)
+    {
+        const uint32_t width = rgb.channels[0].width;
+        const uint32_t height = rgb.channels[0].height;
+        for (Plane& plane : encoded.channels)
+            plane = Plane(width, height);
+        luma = Plane(width, height);
+
+        pool.ParallelFor(height, [&](uint32_t y)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                float value[3];
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    value[c] = LinearToSrgb(rgb.channels[c].Row(y)[x]);
+                    encoded.channels[c].Row(y)[x] = value[c];
+                }
+                luma.Row(y)[x] = 0.2126f * value[0] + 0.7152f * value[1] + 0.0722f * value[2];
+            }
+        });
+    }
+
+    std::vector<float> GetTileAverages(ThreadPool& pool, const Plane& map, uint32_t tileSize, uint32_t tilesX, uint32_t tilesY)
+    {
+        std::vector<float> tiles(size_t(tilesX) * tilesY, 0.f);
+        pool.ParallelFor(tilesY, [&](uint32_t tileY)
+        {
+            const uint32_t endY = std::min((tileY + 1) * tileSize, map.height);
+            for (uint32_t tileX = 0; tileX < tilesX; tileX++)
+            {
+                const uint32_t endX = std::min((tileX + 1) * tileSize, map.width);
+                double sum = 0.0;
+                for (uint32_t y = tileY * tileSize; y < endY; y++)
+                    for (uint32_t x = tileX * tileSize; x < endX; x++)
+                        sum += map.Row(y)[x];
+                tiles[tileY * tilesX + tileX] = float(sum / double((endX - tileX * tileSize) * (endY - tileY * tileSize)));
+            }
+        });
+        return tiles;
+    }
+
+    double GetMean(const Plane& map)
+    {
+        double sum = 0.0;
+        for (uint32_t y = 0; y < map.height; y++)
+        {
+            double rowSum = 0.0;
+            for (uint32_t x = 0; x < map.width; x++)
+                rowSum += map.Row(y)[x];
+            sum += rowSum;
+        }
+        return sum / double(std::max<size_t>(map.data.size(), 1));
+    }
+
+    double MseToPsnr(double mse)
+    {
+        return mse > 0.0 ? 10.0 * std::log10(1.0 / mse) : std::numeric_limits<double>::infinity();
+    }
+
+    // SSIM and contrast-structure maps of two luma planes
+    void ComputeSsimMaps(ThreadPool& pool, const Plane& a, const Plane& b, Plane& ssim, Plane& contrastStructure)
+    {
+        const std::vector<float> kernel = GetGaussianKernel(c_SsimSigma, int(c_SsimRadius));
+        const uint32_t width = a.width;
+        const uint32_t height = a.height;
+
+        Plane aa(width, height), bb(width, height), ab(width, height);
+        pool.ParallelFor(height, [&](uint32_t y)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const float va = a.Row(y)[x];
+                const float vb = b.Row(y)[x];
+                aa.Row(y)[x] = va * va;
+                bb.Row(y)[x] = vb * vb;
+                ab.Row(y)[x] = va * vb;
+            }
+        });
+
+        Plane meanA, meanB, meanAA, meanBB, meanAB;
+        FilterSeparable(pool, a, kernel, kernel, meanA);
+        FilterSeparable(pool, b, kernel, kernel, meanB);
+        FilterSeparable(pool, aa, kernel, kernel, meanAA);
+        FilterSeparable(pool, bb, kernel, kernel, meanBB);
+        FilterSeparable(pool, ab, kernel, kernel, meanAB);
+
+        ssim = Plane(width, height);
+        contrastStructure = Plane(width, height);
+        pool.ParallelFor(height, [&](uint32_t y)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const float ma = meanA.Row(y)[x];
+                const float mb = meanB.Row(y)[x];
+                const float varianceA = meanAA.Row(y)[x] - ma * ma;
+                const float varianceB = meanBB.Row(y)[x] - mb * mb;
+                const float covariance = meanAB.Row(y)[x] - ma * mb;
+
+                const float cs = (2.f * covariance + c_SsimC2) / (varianceA + varianceB + c_SsimC2);
+                const float luminance = (2.f * ma * mb + c_SsimC1) / (ma * ma + mb * mb + c_SsimC1);
+                contrastStructure.Row(y)[x] = cs;
+                ssim.Row(y)[x] = luminance * cs;
+            }
+        });
+    }
+
+    Plane Downsample(ThreadPool& pool, const Plane& input)
+    {
+        Plane output(std::max(input.width / 2, 1u), std::max(input.height / 2, 1u));
+        pool.ParallelFor(output.height, [&](uint32_t y)
+        {
+            const uint32_t y0 = std::min(y * 2, input.height - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, input.height - 1);
+            for (uint32_t x = 0; x < output.width; x++)
+            {
+                const uint32_t x0 = std::min(x * 2, input.width - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, input.width - 1);
+                output.Row(y)[x] = 0.25f * (input.Row(y0)[x0] + input.Row(y0)[x1] + input.Row(y1)[x0] + input.Row(y1)[x1]);
+            }
+        });
+        return output;
+    }
+
+    double ComputeMsSsim(ThreadPool& pool, Plane a, Plane b, double fullResolutionSsim, double fullResolutionContrastStructure)
+    {
+        // Scales stop once the SSIM window no longer fits
+        const uint32_t windowSize = 2 * c_SsimRadius + 1;
+        uint32_t scales = 1;
+        while (scales < 5 && std::min(a.width, a.height) >> scales >= windowSize)
+            scales++;
+
+        double weightSum = 0.0;
+        for (uint32_t scale = 0; scale < scales; scale++)
+            weightSum += c_MsSsimWeights[scale];
+
+        double logResult = 0.0;
+        for (uint32_t scale = 0; scale < scales; scale++)
+        {
+            const double weight = c_MsSsimWeights[scale] / weightSum;
+            double value = scales == 1 ? fullResolutionSsim : fullResolutionContrastStructure;
+            if (scale > 0)
+            {
+                a = Downsample(pool, a);
+                b = Downsample(pool, b);
+                Plane ssim, contrastStructure;
+                ComputeSsimMaps(pool, a, b, ssim, contrastStructure);
+                value = GetMean(scale + 1 == scales ? ssim : contrastStructure);
+            }
+            logResult += weight * std::log(std::max(value, 1e-6));
+        }
+        return std::exp(logResult);
+    }
+
+    struct Lab
+    {
+        float l, a, b;
+    };
+
+    constexpr float c_WhiteX = 0.950470f;
+    constexpr float c_WhiteZ = 1.088830f;
+
+    void LinearRgbToXyz(const float rgb[3], float xyz[3])
+    {
+        xyz[0] = 0.4124564f * rgb[0] + 0.3575761f * rgb[1] + 0.1804375f * rgb[2];
+        xyz[1] = 0.2126729f * rgb[0] + 0.7151522f * rgb[1] + 0.0721750f * rgb[2];
+        xyz[2] = 0.0193339f * rgb[0] + 0.1191920f * rgb[1] + 0.9503041f * rgb[2];
+    }
+
+    void XyzToLinearRgb(const float xyz[3], float rgb[3])
+    {
+        rgb[0] = 3.2404542f * xyz[0] - 1.5371385f * xyz[1] - 0.4985314f * xyz[2];
+        rgb[1] = -0.9692660f * xyz[0] + 1.8760108f * xyz[1] + 0.0415560f * xyz[2];
+        rgb[2] = 0.0556434f * xyz[0] - 0.2040259f * xyz[1] + 1.0572252f * xyz[2];
+    }
+
+    float LabCurve(float t)
+    {
+        constexpr float delta = 6.f / 29.f;
+        constexpr float threshold = delta * delta * delta;
+        static const CurveTable table(threshold, 1.1f, 4096, [](float x) { return std::cbrt(x); });
+        return t > threshold ? table(t) : t / (3.f * delta * delta) + 4.f / 29.f;
+    }
+
+    // L*a*b* with the Hunt adjustment of the chroma
+    Lab LinearRgbToHuntLab(const float rgb[3])
+    {
+        float xyz[3];
+        LinearRgbToXyz(rgb, xyz);
+        const float fx = LabCurve(xyz[0] / c_WhiteX);
+        const float fy = LabCurve(xyz[1]);
+        const float fz = LabCurve(xyz[2] / c_WhiteZ);
+
+        Lab lab;
+        lab.l = 116.f * fy - 16.f;
+        lab.a = 0.01f * lab.l * 500.f * (fx - fy);
+        lab.b = 0.01f * lab.l * 200.f * (fy - fz);
+        return lab;
+    }
+
+    float HyAbDistance(const Lab& x, const Lab& y)
+    {
+        const float da = x.a - y.a;
+        const float db = x.b - y.b;
+        return std::abs(x.l - y.l) + std::sqrt(da * da + db * db);
+    }
+
+    // The opponent color space YCxCz of the linear image, filtered by the contrast sensitivity of each channel,
+    // and back to linear RGB clamped to the display
+    RgbPlanes FilterByContrastSensitivity(ThreadPool& pool, const RgbPlanes& rgb, float pixelsPerDegree)
+    {
+        const uint32_t width = rgb.channels[0].width;
+        const uint32_t height = rgb.channels[0].height;
+
+        RgbPlanes opponent;
+        for (Plane& plane : opponent.channels)
+            plane = Plane(width, height);
+
+        pool.ParallelFor(height, [&](uint32_t y)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const float color[3] = { rgb.channels[0].Row(y)[x], rgb.channels[1].Row(y)[x], rgb.channels[2].Row(y)[x] };
+                float xyz[3];
+                LinearRgbToXyz(color, xyz);
+                opponent.channels[0].Row(y)[x] = 116.f * xyz[1] - 16.f;
+                opponent.channels[1].Row(y)[x] = 500.f * (xyz[0] / c_WhiteX - xyz[1]);
+                opponent.channels[2].Row(y)[x] = 200.f * (xyz[1] - xyz[2] / c_WhiteZ);
+            }
+        });
+
+        RgbPlanes filtered;
+        for (uint32_t channel = 0; channel < 3; channel++)
+        {
+            const std::vector<CsfTerm>& terms = c_CsfChannels[channel];
+
+            // A 2D term a * pi / b * g(x) * g(y) is separable, the channel kernel is the normalized sum of its terms
+            float maxB = 0.f;
+            for (const CsfTerm& term : terms)
+                maxB = std::max(maxB, term.b);
+            const int radius = int(std::ceil(3.f * std::sqrt(maxB / (2.f * c_Pi * c_Pi)) * pixelsPerDegree));
+
+            std::vector<std::vector<float>> kernels;
+            std::vector<float> weights;
+            float total = 0.f;
+            for (const CsfTerm& term : terms)
+            {
+                std::vector<float> kernel(2 * radius + 1);
+                float sum = 0.f;
+                for (int i = -radius; i <= radius; i++)
+                {
+                    const float degrees = float(i) / pixelsPerDegree;
+                    kernel[i + radius] = std::exp(-c_Pi * c_Pi * degrees * degrees / term.b);
+                    sum += kernel[i + radius];
+                }
+                const float weight = term.a * c_Pi / term.b * sum * sum;
+                for (float& value : kernel)
+                    value /= sum;
+                kernels.push_back(std::move(kernel));
+                weights.push_back(weight);
+                total += weight;
+            }
+
+            filtered.channels[channel] = Plane(width, height);
+            for (size_t term = 0; term < kernels.size(); term++)
+            {
+                Plane result;
+                FilterSeparable(pool, opponent.channels[channel], kernels[term], kernels[term], result);
+                AccumulateScaled(filtered.channels[channel].data.data(), result.data.data(), weights[term] / total, uint32_t(result.data.size()));
+            }
+        }
+
+        pool.ParallelFor(height, [&](uint32_t y)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const float luminance = (filtered.channels[0].Row(y)[x] + 16.f) / 116.f;
+                const float xyz[3] = {
+                    (filtered.channels[1].Row(y)[x] / 500.f + luminance) * c_WhiteX,
+                    luminance,
+                    (luminance - filtered.channels[2].Row(y)[x] / 200.f) * c_WhiteZ };
+                float color[3];
+                XyzToLinearRgb(xyz, color);
+                for (uint32_t c = 0; c < 3; c++)
+                    filtered.channels[c].Row(y)[x] = std::clamp(color[c], 0.f, 1.f);
+            }
+        });
+
+        return filtered;
+    }
+
+    // Magnitudes of the edge and point detectors on the luminance
+    void DetectFeatures(ThreadPool& pool, const RgbPlanes& rgb, float pixelsPerDegree, Plane& edges, Plane& points)
+    {
+        const uint32_t width = rgb.channels[0].width;
+        const uint32_t height = rgb.channels[0].height;
+
+        Plane luminance(width, height);
+        pool.ParallelFor(height, [&](uint32_t y)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const float color[3] = { rgb.channels[0].Row(y)[x], rgb.channels[1].Row(y)[x], rgb.channels[2].Row(y)[x] };
+                float xyz[3];
+                LinearRgbToXyz(color, xyz);
+                luminance.Row(y)[x] = xyz[1];
+            }
+        });
+
+        const float sigma = 0.5f * c_FlipFeatureWidth * pixelsPerDegree;
+        const int radius = int(std::ceil(3.f * sigma));
+        const std::vector<float> gaussian = GetGaussianKernel(sigma, radius);
+
+        std::vector<float> firstDerivative(gaussian.size());
+        std::vector<float> secondDerivative(gaussian.size());
+        for (int i = -radius; i <= radius; i++)
+        {
+            const float x = float(i);
+            firstDerivative[i + radius] = -x / (sigma * sigma) * gaussian[i + radius];
+            secondDerivative[i + radius] = (x * x / (sigma * sigma) - 1.f) / (sigma * sigma) * gaussian[i + radius];
+        }
+        NormalizeSigned(firstDerivative);
+        NormalizeSigned(secondDerivative);
+
+        // The Gaussian pass across the derivative is shared by the edge and point detectors
+        const std::vector<float> identity = { 1.f };
+        Plane blurredX, blurredY;
+        FilterSeparable(pool, luminance, gaussian, identity, blurredX);
+        FilterSeparable(pool, luminance, identity, gaussian, blurredY);
+
+        Plane edgeX, edgeY, pointX, pointY;
+        FilterSeparable(pool, blurredY, firstDerivative, identity, edgeX);
+        FilterSeparable(pool, blurredX, identity, firstDerivative, edgeY);
+        FilterSeparable(pool, blurredY, secondDerivative, identity, pointX);
+        FilterSeparable(pool, blurredX, identity, secondDerivative, pointY);
+
+        edges = Plane(width, height);
+        points = Plane(width, height);
+        for (size_t i = 0; i < edges.data.size(); i++)
+        {
+            edges.data[i] = std::sqrt(edgeX.data[i] * edgeX.data[i] + edgeY.data[i] * edgeY.data[i]);
+            points.data[i] = std::sqrt(pointX.data[i] * pointX.data[i] + pointY.data[i] * pointY.data[i]);
+        }
+    }
+
+    Plane ComputeFlipMap(ThreadPool& pool, const RgbPlanes& test, const RgbPlanes& reference, float pixelsPerDegree)
+    {
+        const uint32_t width = test.channels[0].width;
+        const uint32_t height = test.channels[0].height;
+
+        const RgbPlanes filteredTest = FilterByContrastSensitivity(pool, test, pixelsPerDegree);
+        const RgbPlanes filteredReference = FilterByContrastSensitivity(pool, reference, pixelsPerDegree);
+
+        Plane testEdges, testPoints, referenceEdges, referencePoints;
+        DetectFeatures(pool, test, pixelsPerDegree, testEdges, testPoints);
+        DetectFeatures(pool, reference, pixelsPerDegree, referenceEdges, referencePoints);
+
+        // The largest color difference, between green and blue
+        const float green[3] = { 0.f, 1.f, 0.f };
+        const float blue[3] = { 0.f, 0.f, 1.f };
+        const float maxColorError = std::pow(HyAbDistance(LinearRgbToHuntLab(green), LinearRgbToHuntLab(blue)), c_FlipColorExponent);
+        const float cutoff = c_FlipColorCutoff * maxColorError;
+
+        Plane flip(width, height);
+        pool.ParallelFor(height, [&](uint32_t y)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const float colorTest[3] = { filteredTest.channels[0].Row(y)[x], filteredTest.channels[1].Row(y)[x], filteredTest.channels[2].Row(y)[x] };
+                const float colorReference[3] = { filteredReference.channels[0].Row(y)[x], filteredReference.channels[1].Row(y)[x], filteredReference.channels[2].Row(y)[x] };
+                const float distance = std::pow(HyAbDistance(LinearRgbToHuntLab(colorTest), LinearRgbToHuntLab(colorReference)), c_FlipColorExponent);
+
+                const float colorError = distance < cutoff
+                    ? c_FlipColorCutoffError / cutoff * distance
+                    : c_FlipColorCutoffError + (distance - cutoff) / (maxColorError - cutoff) * (1.f - c_FlipColorCutoffError);
+
+                const size_t i = size_t(y) * width + x;
+                const float featureDifference = std::max(std::abs(testEdges.data[i] - referenceEdges.data[i]),
+                    std::abs(testPoints.data[i] - referencePoints.data[i]));
+                const float featureError = std::sqrt(std::min(featureDifference / std::sqrt(2.f), 1.f)); // q_f = 0.5
+
+                flip.Row(y)[x] = std::pow(std::min(colorError, 1.f), 1.f - featureError);
+            }
+        });
+
+        return flip;
+    }
+}
+
+ImageMetrics::ImageMetrics(ThreadPool& pool)
+    : m_Pool(pool)
+{
+}
+
+bool ImageMetrics::Compare(const MetricImage& test, const MetricImage& reference, const ImageMetricsOptions& options,
+    ImageMetricsResult& result) const
+{
+    result = ImageMetricsResult();
+
+    if (!test.data || !reference.data || test.width != reference.width || test.height != reference.height ||
+        test.width == 0 || test.height == 0 || options.tileSize == 0)
+        return false;
+
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    const uint32_t width = test.width;
+    const uint32_t height = test.height;
+    const RgbPlanes testRgb = LoadImage(m_Pool, test, options);
+    const RgbPlanes referenceRgb = LoadImage(m_Pool, reference, options);
+
+    ImageMetricsTiles& tiles = result.tiles;
+    tiles.tileSize = options.tileSize;
+    tiles.tilesX = (width + options.tileSize - 1) / options.tileSize;
+    tiles.tilesY = (height + options.tileSize - 1) / options.tileSize;
+
+    // PSNR of the encoded colors
+    RgbPlanes testEncoded, referenceEncoded;
+    Plane testLuma, referenceLuma;
+    EncodeSrgb(m_Pool, testRgb, testEncoded, testLuma);
+    EncodeSrgb(m_Pool, referenceRgb, referenceEncoded, referenceLuma);
+
+    Plane squaredError(width, height);
+    m_Pool.ParallelFor(height, [&](uint32_t y)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            float sum = 0.f;
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                const float difference = testEncoded.channels[c].Row(y)[x] - referenceEncoded.channels[c].Row(y)[x];
+                sum += difference * difference;
+            }
+            squaredError.Row(y)[x] = sum / 3.f;
+        }
+    });
+
+    result.psnr = MseToPsnr(GetMean(squaredError));
+    tiles.psnr = GetTileAverages(m_Pool, squaredError, options.tileSize, tiles.tilesX, tiles.tilesY);
+    for (float& tile : tiles.psnr)
+        tile = float(MseToPsnr(tile));
+
+    // SSIM of the encoded luma
+    Plane ssim, contrastStructure;
+    ComputeSsimMaps(m_Pool, testLuma, referenceLuma, ssim, contrastStructure);
+    result.ssim = GetMean(ssim);
+    tiles.ssim = GetTileAverages(m_Pool, ssim, options.tileSize, tiles.tilesX, tiles.tilesY);
+
+    if (options.multiScaleSsim)
+        result.msSsim = ComputeMsSsim(m_Pool, testLuma, referenceLuma, result.ssim, GetMean(contrastStructure));
+
+    // FLIP of the linear colors
+    if (options.flip)
+    {
+        const Plane flip = ComputeFlipMap(m_Pool, testRgb, referenceRgb, options.pixelsPerDegree);
+        result.flip = GetMean(flip);
+        tiles.flip = GetTileAverages(m_Pool, flip, options.tileSize, tiles.tilesX, tiles.tilesY);
+    }
+
+    result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    return true;
+}
+
+TemporalInstabilityMetric::TemporalInstabilityMetric(ThreadPool& pool)
+    : m_Pool(pool)
+{
+}
+
+void TemporalInstabilityMetric::Reset()
+{
+    m_FrameCount = 0;
+    m_FrameDifferenceSum = 0.0;
+}
+
+void TemporalInstabilityMetric::AddFrame(const MetricImage& frame, const ImageMetricsOptions& options)
+{
+    if (!frame.data || frame.width == 0 || frame.height == 0)
+        return;
+
+    if (frame.width != m_Width || frame.height != m_Height)
+    {
+        m_Width = frame.width;
+        m_Height = frame.height;
+        Reset();
+    }
+
+    if (m_FrameCount == 0)
+    {
+        m_Previous.assign(size_t(m_Width) * m_Height, 0.f);
+        m_Mean.assign(size_t(m_Width) * m_Height, 0.f);
+        m_SquaredDeviationSum.assign(size_t(m_Width) * m_Height, 0.f);
+    }
+
+    RgbPlanes encoded;
+    Plane luma;
+    EncodeSrgb(m_Pool, LoadImage(m_Pool, frame, options), encoded, luma);
+    const uint32_t frameCount = ++m_FrameCount;
+    std::vector<double> rowDifferences(m_Height, 0.0);
+
+    m_Pool.ParallelFor(m_Height, [&](uint32_t y)
+    {
+        double difference = 0.0;
+        for (uint32_t x = 0; x < m_Width; x++)
+        {
+            const size_t i = size_t(y) * m_Width + x;
+            const float value = luma.Row(y)[x];
+
+            if (frameCount > 1)
+                difference += std::abs(value - m_Previous[i]);
+            m_Previous[i] = value;
+
+            const float delta = value - m_Mean[i];
+            m_Mean[i] += delta / float(frameCount);
+            m_SquaredDeviationSum[i] += delta * (value - m_Mean[i]);
+        }
+        rowDifferences[y] = difference;
+    });
+
+    if (frameCount > 1)
+    {
+        double difference = 0.0;
+        for (double row : rowDifferences)
+            difference += row;
+        m_FrameDifferenceSum += difference / (double(m_Width) * m_Height);
+    }
+}
+
+void TemporalInstabilityMetric::GetResult(const ImageMetricsOptions& options, TemporalInstabilityResult& result) const
+{
+    result = TemporalInstabilityResult();
+    result.frameCount = m_FrameCount;
+    if (m_FrameCount < 2 || options.tileSize == 0)
+        return;
+
+    Plane variance(m_Width, m_Height);
+    for (size_t i = 0; i < variance.data.size(); i++)
+        variance.data[i] = m_SquaredDeviationSum[i] / float(m_FrameCount);
+
+    result.luminanceVariance = GetMean(variance);
+    result.frameDifference = m_FrameDifferenceSum / double(m_FrameCount - 1);
+    result.tileSize = options.tileSize;
+    result.tilesX = (m_Width + options.tileSize - 1) / options.tileSize;
+    result.tilesY = (m_Height + options.tileSize - 1) / options.tileSize;
+    result.tileVariance = GetTileAverages(m_Pool, variance, options.tileSize, result.tilesX, result.tilesY);
+}
@@ -0,0 +1,119 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "TaskGraph.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class MetricImageFormat
+{
+    Float32,    // RGBA32_FLOAT, e.g. the CPU frames
+    Float16,    // RGBA16_FLOAT, e.g. readbacks of HdrColor or ResolvedColor
+};
+
+// 4 channel image in CPU memory, alpha is ignored. Colors are linear.
+struct MetricImage
+{
+    const void* data = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t rowPitch = 0;        // in bytes, 0 for tightly packed rows
+    MetricImageFormat format = MetricImageFormat::Float32;
+};
+
+struct ImageMetricsOptions
+{
+    // HDR images are scaled by exposure and tone mapped before they are compared, LDR images are clamped to [0, 1]
+    bool hdr = false;
+    float exposure = 1.f;
+    // Viewing condition of FLIP: a 0.7 m wide 3840 pixel monitor at 0.7 m
+    float pixelsPerDegree = 67.f;
+    uint32_t tileSize = 32;
+    // The most expensive parts, off when only PSNR and SSIM are needed on every frame
+    bool multiScaleSsim = true;
+    bool flip = true;
+};
+
+// Per-tile averages, tiles row by row
+struct ImageMetricsTiles
+{
+    uint32_t tileSize = 0;
+    uint32_t tilesX = 0;
+    uint32_t tilesY = 0;
+    std::vector<float> psnr;
+    std::vector<float> ssim;
+    std::vector<float> flip;
+};
+
+struct ImageMetricsResult
+{
+    double psnr = 0.0;          // dB over the sRGB encoded RGB channels, infinite for identical images
+    double ssim = 0.0;          // of the sRGB encoded luma, 11x11 Gaussian window
+    double msSsim = 0.0;        // 5 scales when the image is large enough, 0 when not requested
+    double flip = 0.0;          // mean of the FLIP error map, 0 is identical and 1 is the largest error, 0 when not requested
+    double milliseconds = 0.0;
+    ImageMetricsTiles tiles;
+};
+
+// Full reference metrics of a test image against a reference image of the same size.
+// FLIP follows the LDR version of Andersson et al. 2020: a color difference of the images filtered by the contrast
+// sensitivity of the eye, weighted up where edges and points differ. HDR images use it after tone mapping.
+// The images are converted to planes once, every filter is separable and runs row by row on the pool with SSE.
+class ImageMetrics
+{
+public:
+    explicit ImageMetrics(ThreadPool& pool);
+
+    bool Compare(const MetricImage& test, const MetricImage& reference, const ImageMetricsOptions& options,
+        ImageMetricsResult& result) const;
+
+private:
+    ThreadPool& m_Pool;
+};
+
+struct TemporalInstabilityResult
+{
+    uint32_t frameCount = 0;
+    double luminanceVariance = 0.0;     // per pixel variance of the luma over the frames, averaged over the image
+    double frameDifference = 0.0;       // mean absolute luma change from one frame to the next
+    uint32_t tileSize = 0;
+    uint32_t tilesX = 0;
+    uint32_t tilesY = 0;
+    std::vector<float> tileVariance;
+};
+
+// Flicker of a static view after the temporal resolve: feed every resolved frame, read the result at the end.
+// Uses the sRGB encoded luma like SSIM, so it is comparable between HDR and LDR sources.
+class TemporalInstabilityMetric
+{
+public:
+    explicit TemporalInstabilityMetric(ThreadPool& pool);
+
+    void Reset();
+
+    // A new size restarts the sequence
+    void AddFrame(const MetricImage& frame, const ImageMetricsOptions& options);
+
+    void GetResult(const ImageMetricsOptions& options, TemporalInstabilityResult& result) const;
+
+private:
+    ThreadPool& m_Pool;
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+    uint32_t m_FrameCount = 0;
+    double m_FrameDifferenceSum = 0.0;
+    std::vector<float> m_Previous;
+    std::vector<float> m_Mean;
+    std::vector<float> m_SquaredDeviationSum;   // Welford's M2
+};
@@ -0,0 +1,343 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "NoiseSpectrum.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <fstream>
+
+namespace
+{
+    constexpr double c_Pi = 3.14159265358979323846;
+
+    using Complex = std::complex<float>;
+
+    bool IsPowerOfTwo(uint32_t value)
+    {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+
+    uint32_t NextPowerOfTwo(uint32_t value)
+    {
+        uint32_t result = 1;
+        while (result < value)
+            result *= 2;
+        return result;
+    }
+
+    // Iterative radix-2 FFT of a fixed power of two size, data is accessed with a stride
+    class Fft
+    {
+    public:
+        explicit Fft(uint32_t size)
+            : m_Size(size)
+            , m_Twiddles(size / 2)
+            , m_Reversed(size)
+        {
+            assert(IsPowerOfTwo(size));
+
+            for (uint32_t i = 0; i < size / 2; i++)
+                m_Twiddles[i] = std::polar(1.f, float(-2.0 * c_Pi * i / size));
+
+            uint32_t bits = 0;
+            while ((1u << bits) < size)
+                bits++;
+            for (uint32_t i = 0; i < size; i++)
+            {
+                uint32_t reversed = 0;
+                for (uint32_t b = 0; b < bits; b++)
+                    reversed |= ((i >> b) & 1) << (bits - 1 - b);
+                m_Reversed[i] = reversed;
+            }
+        }
+
+        void Transform(Complex* data, uint32_t stride) const
+        {
+            for (uint32_t i = 0; i < m_Size; i++)
+            {
+                if (i < m_Reversed[i])
+                    std::swap(data[i * stride], data[m_Reversed[i] * stride]);
+            }
+
+            for (uint32_t length = 2; length <= m_Size; length *= 2)
+            {
+                const uint32_t half = length / 2;
+                const uint32_t twiddleStep = m_Size / length;
+                for (uint32_t start = 0; start < m_Size; start += length)
+                {
+                    for (uint32_t k = 0; k < half; k++)
+                    {
+                        Complex& even = data[(start + k) * stride];
+                        Complex& odd = data[(start + k + half) * stride];
+                        const Complex t = m_Twiddles[k * twiddleStep] * odd;
+                        odd = even - t;
+                        even += t;
+                    }
+                }
+            }
+        }
+
+    private:
+        uint32_t m_Size;
+        std::vector<Complex> m_Twiddles;
+        std::vector<uint32_t> m_Reversed;
+    };
+
+    std::vector<float> GetHannWindow(uint32_t size)
+    {
+        std::vector<float> window(size);
+        for (uint32_t i = 0; i < size; i++)
+            window[i] = float(0.5 - 0.5 * std::cos(2.0 * c_Pi * (i + 0.5) / size));
+        return window;
+    }
+
+    // Signed frequency of an FFT bin in [-size / 2, size / 2)
+    int GetFrequency(uint32_t bin, uint32_t size)
+    {
+        return bin < size / 2 ? int(bin) : int(bin) - int(size);
+    }
+}
+
+NoiseSpectrumAnalyzer::NoiseSpectrumAnalyzer(ThreadPool& pool, const NoiseSpectrumOptions& options)
+    : m_Pool(pool)
+    , m_Options(options)
+{
+    assert(IsPowerOfTwo(options.tileSize));
+    m_Options.temporalPixelStride = std::max(options.temporalPixelStride, 1u);
+}
+
+void NoiseSpectrumAnalyzer::Reset()
+{
+    m_FrameCount = 0;
+    m_TileCount = 0;
+    m_TilePowerSum.assign(size_t(m_Options.tileSize) * m_Options.tileSize, 0.0);
+    m_History.clear();
+}
+
+void NoiseSpectrumAnalyzer::AddFrame(uint32_t width, uint32_t height, const float* error)
+{
+    if (width != m_Width || height != m_Height || m_TilePowerSum.empty())
+    {
+        m_Width = width;
+        m_Height = height;
+        Reset();
+    }
+
+    const uint32_t tileSize = m_Options.tileSize;
+    const uint32_t tilesX = width / tileSize;
+    const uint32_t tilesY = height / tileSize;
+
+    // Welch: mean removed, Hann windowed tiles, power normalized by the window energy
+    const Fft fft(tileSize);
+    const std::vector<float> window = GetHannWindow(tileSize);
+    double windowEnergy = 0.0;
+    for (float wy : window)
+        for (float wx : window)
+            windowEnergy += double(wx * wy) * (wx * wy);
+
+    std::vector<std::vector<double>> rowPower(tilesY);
+    m_Pool.ParallelFor(tilesY, [&](uint32_t tileY)
+    {
+        std::vector<double>& power = rowPower[tileY];
+        power.assign(size_t(tileSize) * tileSize, 0.0);
+        std::vector<Complex> tile(size_t(tileSize) * tileSize);
+
+        for (uint32_t tileX = 0; tileX < tilesX; tileX++)
+        {
+            double mean = 0.0;
+            for (uint32_t y = 0; y < tileSize; y++)
+            {
+                const float* row = error + size_t(tileY * tileSize + y) * width + tileX * tileSize;
+                for (uint32_t x = 0; x < tileSize; x++)
+                    mean += row[x];
+            }
+            mean /= double(tileSize) * tileSize;
+
+            for (uint32_t y = 0; y < tileSize; y++)
+            {
+                const float* row = error + size_t(tileY * tileSize + y) * width + tileX * tileSize;
+                for (uint32_t x = 0; x < tileSize; x++)
+                    tile[y * tileSize + x] = Complex((row[x] - float(mean)) * window[x] * window[y], 0.f);
+            }
+
+            for (uint32_t y = 0; y < tileSize; y++)
+                fft.Transform(&tile[y * tileSize], 1);
+            for (uint32_t x = 0; x < tileSize; x++)
+                fft.Transform(&tile[x], tileSize);
+
+            for (size_t i = 0; i < tile.size(); i++)
+                power[i] += double(std::norm(tile[i])) / windowEnergy;
+        }
+    });
+
+    for (const std::vector<double>& power : rowPower)
+    {
+        for (size_t i = 0; i < power.size(); i++)
+            m_TilePowerSum[i] += power[i];
+    }
+    m_TileCount += uint64_t(tilesX) * tilesY;
+
+    if (m_History.size() < m_Options.maxTemporalFrames)
+    {
+        const uint32_t stride = m_Options.temporalPixelStride;
+        std::vector<float>& samples = m_History.emplace_back();
+        samples.reserve(size_t((width + stride - 1) / stride) * ((height + stride - 1) / stride));
+        for (uint32_t y = 0; y < height; y += stride)
+            for (uint32_t x = 0; x < width; x += stride)
+                samples.push_back(error[size_t(y) * width + x]);
+    }
+
+    m_FrameCount++;
+}
+
+void NoiseSpectrumAnalyzer::GetResult(NoiseSpectrum& result) const
+{
+    result = NoiseSpectrum();
+    result.frameCount = m_FrameCount;
+    if (m_FrameCount == 0)
+        return;
+
+    // Spatial: radial average of the mean tile power
+    const uint32_t tileSize = m_Options.tileSize;
+    const uint32_t bins = tileSize / 2;
+    if (m_TileCount > 0)
+    {
+        std::vector<double> binPower(bins, 0.0);
+        std::vector<uint32_t> binCount(bins, 0);
+        double total = 0.0;
+        double lowFrequency = 0.0;
+        uint32_t frequencies = 0;
+        uint32_t lowFrequencies = 0;
+
+        for (uint32_t y = 0; y < tileSize; y++)
+        {
+            for (uint32_t x = 0; x < tileSize; x++)
+            {
+                if (x == 0 && y == 0)
+                    continue;
+
+                const double power = m_TilePowerSum[y * tileSize + x] / double(m_TileCount);
+                const int fx = GetFrequency(x, tileSize);
+                const int fy = GetFrequency(y, tileSize);
+                const double frequency = std::sqrt(double(fx * fx + fy * fy)) / double(tileSize / 2);
+
+                total += power;
+                frequencies++;
+                if (frequency < m_Options.lowFrequencyCutoff)
+                {
+                    lowFrequency += power;
+                    lowFrequencies++;
+                }
+
+                const uint32_t bin = uint32_t(frequency * bins);
+                if (bin < bins)
+                {
+                    binPower[bin] += power;
+                    binCount[bin]++;
+                }
+            }
+        }
+
+        result.spatialPower.resize(bins);
+        for (uint32_t bin = 0; bin < bins; bin++)
+            result.spatialPower[bin] = binCount[bin] ? binPower[bin] / binCount[bin] : 0.0;
+
+        // Parseval: the power summed over all bins is tileSize^2 times the variance
+        result.spatialVariance = total / (double(tileSize) * tileSize);
+        result.spatialLowFrequencyRatio = total > 0.0 ? lowFrequency / total : 0.0;
+        result.spatialWhiteNoiseRatio = double(lowFrequencies) / frequencies;
+    }
+
+    // Temporal: one-sided spectrum of every sampled pixel's history
+    const uint32_t frames = uint32_t(m_History.size());
+    if (frames < 4)
+        return;
+
+    const uint32_t size = NextPowerOfTwo(frames);
+    const uint32_t pixels = uint32_t(m_History[0].size());
+    const uint32_t chunkSize = 1024;
+    const uint32_t chunks = (pixels + chunkSize - 1) / chunkSize;
+    const Fft fft(size);
+    const std::vector<float> window = GetHannWindow(frames);
+    double windowEnergy = 0.0;
+    for (float w : window)
+        windowEnergy += double(w) * w;
+
+    std::vector<std::vector<double>> chunkPower(chunks);
+    m_Pool.ParallelFor(chunks, [&](uint32_t chunk)
+    {
+        std::vector<double>& power = chunkPower[chunk];
+        power.assign(size / 2 + 1, 0.0);
+        std::vector<Complex> series(size);
+
+        const uint32_t end = std::min((chunk + 1) * chunkSize, pixels);
+        for (uint32_t pixel = chunk * chunkSize; pixel < end; pixel++)
+        {
+            double mean = 0.0;
+            for (uint32_t frame = 0; frame < frames; frame++)
+                mean += m_History[frame][pixel];
+            mean /= frames;
+
+            std::fill(series.begin(), series.end(), Complex(0.f));
+            for (uint32_t frame = 0; frame < frames; frame++)
+                series[frame] = Complex((m_History[frame][pixel] - float(mean)) * window[frame], 0.f);
+
+            fft.Transform(series.data(), 1);
+
+            for (uint32_t k = 0; k <= size / 2; k++)
+                power[k] += double(std::norm(series[k])) / windowEnergy;
+        }
+    });
+
+    std::vector<double> power(size / 2 + 1, 0.0);
+    for (const std::vector<double>& chunk : chunkPower)
+        for (size_t k = 0; k < power.size(); k++)
+            power[k] += chunk[k] / pixels;
+
+    // Bins 1 to size / 2, the negative frequencies mirror all but the Nyquist bin
+    double total = 0.0;
+    double lowFrequency = 0.0;
+    double weights = 0.0;
+    double lowWeights = 0.0;
+    result.temporalPower.resize(size / 2);
+    for (uint32_t k = 1; k <= size / 2; k++)
+    {
+        const double weight = k == size / 2 ? 1.0 : 2.0;
+        result.temporalPower[k - 1] = power[k];
+        total += power[k] * weight;
+        weights += weight;
+        if (double(k) / (size / 2) < m_Options.lowFrequencyCutoff)
+        {
+            lowFrequency += power[k] * weight;
+            lowWeights += weight;
+        }
+    }
+
+    result.temporalLowFrequencyRatio = total > 0.0 ? lowFrequency / total : 0.0;
+    result.temporalWhiteNoiseRatio = lowWeights / weights;
+}
+
+bool NoiseSpectrumAnalyzer::WriteCsv(const std::filesystem::path& fileName, const NoiseSpectrum& spectrum)
+{
+    std::ofstream file(fileName);
+    if (!file.is_open())
+        return false;
+
+    file << "domain,frequency,power\n";
+    for (size_t i = 0; i < spectrum.spatialPower.size(); i++)
+        file << "spatial," << (double(i) + 0.5) / spectrum.spatialPower.size() << "," << spectrum.spatialPower[i] << "\n";
+    for (size_t i = 0; i < spectrum.temporalPower.size(); i++)
+        file << "temporal," << double(i + 1) / spectrum.temporalPower.size() << "," << spectrum.temporalPower[i] << "\n";
+
+    return file.good();
+}
@@ -0,0 +1,72 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "TaskGraph.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+struct NoiseSpectrumOptions
+{
+    uint32_t tileSize = 64;             // power of two, the spatial spectrum is averaged over tiles of this size
+    float lowFrequencyCutoff = 0.25f;   // fraction of the Nyquist frequency below which energy counts as low frequency
+    uint32_t temporalPixelStride = 4;   // every n-th pixel in x and y keeps its error history
+    uint32_t maxTemporalFrames = 64;    // frames of history, later frames are left out of the temporal spectrum
+};
+
+struct NoiseSpectrum
+{
+    uint32_t frameCount = 0;
+
+    // Power per radial frequency bin, bin i covers [i, i + 1) / bins of the Nyquist frequency. The DC term is excluded.
+    std::vector<double> spatialPower;
+    double spatialVariance = 0.0;               // total power without DC, the mean variance of the error in a tile
+    double spatialLowFrequencyRatio = 0.0;      // energy below the cutoff over all energy
+    double spatialWhiteNoiseRatio = 0.0;        // the same ratio for white noise, the share of frequencies below the cutoff
+
+    // Power per temporal frequency bin from 0 to the Nyquist frequency of the frame rate, DC excluded
+    std::vector<double> temporalPower;
+    double temporalLowFrequencyRatio = 0.0;
+    double temporalWhiteNoiseRatio = 0.0;
+};
+
+// Power spectra of per-frame error images, e.g. the luminance of an STF frame minus the hardware sampler frame.
+// Blue noise error has little energy at low frequencies where TAA and DLSS cannot remove it; white noise spreads
+// evenly, so the low frequency ratios are reported next to the white noise values.
+// The spatial spectrum is a Welch average of Hann windowed tiles over all frames, the temporal spectrum the average
+// over the sampled pixels of their Hann windowed error over time. Tiles and pixels run on the pool.
+class NoiseSpectrumAnalyzer
+{
+public:
+    NoiseSpectrumAnalyzer(ThreadPool& pool, const NoiseSpectrumOptions& options);
+
+    void Reset();
+
+    // width * height error values row by row. A new size restarts the analysis.
+    void AddFrame(uint32_t width, uint32_t height, const float* error);
+
+    void GetResult(NoiseSpectrum& result) const;
+
+    // Both spectra as CSV rows of domain, normalized frequency and power
+    static bool WriteCsv(const std::filesystem::path& fileName, const NoiseSpectrum& spectrum);
+
+private:
+    ThreadPool& m_Pool;
+    NoiseSpectrumOptions m_Options;
+    uint32_t m_Width = 0;
+    uint32_t m_Height = 0;
+    uint32_t m_FrameCount = 0;
+    uint64_t m_TileCount = 0;
+    std::vector<double> m_TilePowerSum;             // tileSize * tileSize, summed over tiles and frames
+    std::vector<std::vector<float>> m_History;      // per stored frame, the sampled pixels
+};
@@ -0,0 +1,537 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "OpacityMicromap.h"
+#include "CpuScene.h"
+
+#include <donut/engine/SceneTypes.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+
+using namespace donut;
+using namespace donut::math;
+
+namespace
+{
+    const char c_Magic[4] = { 'S', 'T', 'F', 'O' };
+    constexpr uint32_t c_Version = 1;
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t triangleCount;
+        uint64_t descCount;
+        uint64_t dataSize;
+    };
+
+    // Special triangles are validated as if they had a micromap of this level
+    constexpr uint32_t c_ValidationLevel = 4;
+
+    // The bird curve of the D3D12 and Vulkan specifications: discrete barycentrics of a micro-triangle from its index
+    // and back. Consecutive micro-triangles of the curve share an edge, or a vertex where it turns.
+    uint32_t ExtractEvenBits(uint32_t x)
+    {
+        x &= 0x55555555u;
+        x = (x | (x >> 1)) & 0x33333333u;
+        x = (x | (x >> 2)) & 0x0f0f0f0fu;
+        x = (x | (x >> 4)) & 0x00ff00ffu;
+        x = (x | (x >> 8)) & 0x0000ffffu;
+        return x;
+    }
+
+    uint32_t SpreadBits(uint32_t x)
+    {
+        x &= 0x0000ffffu;
+        x = (x | (x << 8)) & 0x00ff00ffu;
+        x = (x | (x << 4)) & 0x0f0f0f0fu;
+        x = (x | (x << 2)) & 0x33333333u;
+        x = (x | (x << 1)) & 0x55555555u;
+        return x;
+    }
+
+    uint32_t PrefixXor(uint32_t x)
+    {
+        x ^= x >> 1;
+        x ^= x >> 2;
+        x ^= x >> 4;
+        x ^= x >> 8;
+        return x;
+    }
+
+    // PrefixXor of the two 16 bit halves separately
+    uint32_t PrefixXor2(uint32_t x)
+    {
+        x ^= (x >> 1) & 0x7fff7fffu;
+        x ^= (x >> 2) & 0x3fff3fffu;
+        x ^= (x >> 4) & 0x0fff0fffu;
+        x ^= (x >> 8) & 0x00ff00ffu;
+        return x;
+    }
+
+    void IndexToDiscreteBarycentrics(uint32_t index, uint32_t& u, uint32_t& v, uint32_t& w)
+    {
+        const uint32_t b0 = ExtractEvenBits(index);
+        const uint32_t b1 = ExtractEvenBits(index >> 1);
+        const uint32_t fx = PrefixXor(b0);
+        const uint32_t fy = PrefixXor(b0 & ~b1);
+        const uint32_t t = fy ^ b1;
+
+        u = (fx & ~t) | (b0 & ~t) | (~b0 & ~fx & t);
+        v = fy ^ b0;
+        w = (~fx & ~t) | (b0 & ~t) | (~b0 & fx & t);
+    }
+
+    uint32_t DiscreteBarycentricsToIndex(uint32_t u, uint32_t v, uint32_t w, uint32_t level)
+    {
+        const uint32_t mask = (1u << level) - 1;
+        const uint32_t b0 = ~(u ^ w) & mask;
+        const uint32_t t = (u ^ v) & b0;
+        const uint32_t c = (((u & v & w) | (~u & ~v & ~w)) & mask) << 16;
+        const uint32_t f = PrefixXor2(t | c) ^ u;
+        const uint32_t b1 = (f & ~b0) | t;
+        return SpreadBits(b0) | (SpreadBits(b1) << 1);
+    }
+
+    uint32_t GetBitsPerState(OmmFormat format)
+    {
+        return format == OmmFormat::TwoState ? 1 : 2;
+    }
+
+    OmmState ReadState(const uint8_t* data, OmmFormat format, uint32_t microTriangle)
+    {
+        const uint32_t bits = GetBitsPerState(format);
+        const uint32_t bit = microTriangle * bits;
+        return OmmState((data[bit / 8] >> (bit % 8)) & ((1u << bits) - 1));
+    }
+
+    int WrapTexel(int x, int size)
+    {
+        const int wrapped = x % size;
+        return wrapped < 0 ? wrapped + size : wrapped;
+    }
+
+    // Separating axis test of a 2D triangle and the square of halfSize around center
+    bool TriangleOverlapsSquare(const float2 triangle[3], float2 center, float halfSize)
+    {
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            const float2 edge = triangle[(i + 1) % 3] - triangle[i];
+            const float2 axis = float2(-edge.y, edge.x);
+            if (axis.x == 0.f && axis.y == 0.f)
+                continue;
+
+            float triangleMin = dot(triangle[0], axis);
+            float triangleMax = triangleMin;
+            for (uint32_t j = 1; j < 3; j++)
+            {
+                const float d = dot(triangle[j], axis);
+                triangleMin = std::min(triangleMin, d);
+                triangleMax = std::max(triangleMax, d);
+            }
+
+            const float c = dot(center, axis);
+            const float r = halfSize * (std::abs(axis.x) + std::abs(axis.y));
+            if (triangleMax < c - r || triangleMin > c + r)
+                return false;
+        }
+
+        // The axes of the square are covered by the caller's bounding box
+        return true;
+    }
+
+    struct BakedTriangle
+    {
+        uint32_t level = 0;
+        std::vector<OmmState> states;
+    };
+
+    // The alpha test of CpuScene::ConsiderTransparentMaterial is a bilinear sample of mip 0. A point at texel space
+    // position x reads the texels whose centers are less than a texel away on both axes, and the filtered opacity
+    // lies between the smallest and the largest of theirs.
+    void BakeTriangle(const CpuScene& scene, uint32_t triangleIndex, const OmmBakeSettings& settings, BakedTriangle& baked)
+    {
+        const CpuScene::Triangle& triangle = scene.GetTriangles()[triangleIndex];
+        const CpuScene::Geometry& geometry = scene.GetGeometries()[triangle.geometry];
+        const CpuScene::Material& material = scene.GetMaterials()[geometry.material];
+
+        if (material.baseTexture < 0 || geometry.buffers->texcoord1Data.empty())
+        {
+            baked.level = 0;
+            baked.states.assign(1, material.opacity >= material.alphaCutoff ? OmmState::Opaque : OmmState::Transparent);
+            return;
+        }
+
+        const StfCpuTexture& texture = scene.GetTextures()[material.baseTexture];
+        const int2 size = texture.GetSize(0);
+
+        float2 texels[3];
+        for (uint32_t i = 0; i < 3; i++)
+            texels[i] = geometry.buffers->texcoord1Data[triangle.vertices[i]] * float2(size);
+
+        const float2 edge1 = texels[1] - texels[0];
+        const float2 edge2 = texels[2] - texels[0];
+        const float texelArea = 0.5f * std::abs(edge1.x * edge2.y - edge1.y * edge2.x);
+
+        uint32_t level = 0;
+        while (level < settings.maxSubdivisionLevel && texelArea > settings.texelsPerMicroTriangle * float(1u << (2 * level)))
+            level++;
+
+        baked.level = level;
+        baked.states.resize(size_t(1) << (2 * level));
+
+        // A little more than a texel, so that rounding in the texture coordinates of a hit cannot reach a texel
+        // the footprint missed
+        const float reach = 1.001f;
+
+        for (uint32_t microTriangle = 0; microTriangle < baked.states.size(); microTriangle++)
+        {
+            float2 vertices[3];
+            OpacityMicromaps::GetMicroTriangleVertices(microTriangle, level, vertices);
+
+            float2 footprint[3];
+            float2 footprintMin = float2(FLT_MAX);
+            float2 footprintMax = float2(-FLT_MAX);
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                footprint[i] = texels[0] + edge1 * vertices[i].x + edge2 * vertices[i].y;
+                footprintMin = min(footprintMin, footprint[i]);
+                footprintMax = max(footprintMax, footprint[i]);
+            }
+
+            // Texel centers are at x + 0.5
+            const int2 first = int2(int(std::ceil(footprintMin.x - 0.5f - reach)), int(std::ceil(footprintMin.y - 0.5f - reach)));
+            const int2 last = int2(int(std::floor(footprintMax.x - 0.5f + reach)), int(std::floor(footprintMax.y - 0.5f + reach)));
+            const int64_t texelCount = int64_t(std::max(last.x - first.x + 1, 0)) * std::max(last.y - first.y + 1, 0);
+
+            bool anyOpaque = false;
+            bool anyTransparent = false;
+            if (texelCount > int64_t(settings.maxTexelsPerMicroTriangle))
+            {
+                anyOpaque = true;
+                anyTransparent = true;
+            }
+
+            for (int y = first.y; y <= last.y && !(anyOpaque && anyTransparent); y++)
+            {
+                for (int x = first.x; x <= last.x && !(anyOpaque && anyTransparent); x++)
+                {
+                    if (!TriangleOverlapsSquare(footprint, float2(float(x), float(y)) + 0.5f, reach))
+                        continue;
+
+                    const float opacity = material.opacity * texture.Load(0, int2(WrapTexel(x, size.x), WrapTexel(y, size.y))).w;
+                    if (opacity >= material.alphaCutoff)
+                        anyOpaque = true;
+                    else
+                        anyTransparent = true;
+                }
+            }
+
+            if (anyOpaque != anyTransparent)
+            {
+                baked.states[microTriangle] = anyOpaque ? OmmState::Opaque : OmmState::Transparent;
+                continue;
+            }
+
+            // Unknown, leaning towards the alpha test at the center, which is also what two-state micromaps keep
+            const float2 center = (vertices[0] + vertices[1] + vertices[2]) / 3.f;
+            baked.states[microTriangle] = scene.ConsiderTransparentMaterial(triangleIndex, center)
+                ? OmmState::UnknownOpaque
+                : OmmState::UnknownTransparent;
+        }
+    }
+
+    float GetWorldArea(const CpuScene::Triangle& triangle)
+    {
+        return 0.5f * length(cross(triangle.positions[1] - triangle.positions[0], triangle.positions[2] - triangle.positions[0]));
+    }
+}
+
+uint32_t OpacityMicromaps::GetMicroTriangleIndex(float2 barycentrics, uint32_t subdivisionLevel)
+{
+    if (subdivisionLevel == 0)
+        return 0;
+
+    // The upright micro-triangle (u, v) has the corner at the smallest barycentrics of its cell, the inverted one
+    // fills the rest of the cell. Points on an edge go to either side.
+    const int n = 1 << subdivisionLevel;
+    const float2 scaled = barycentrics * float(n);
+    int u = std::clamp(int(std::floor(scaled.x)), 0, n - 1);
+    int v = std::clamp(int(std::floor(scaled.y)), 0, n - 1);
+    if (u + v > n - 1)
+    {
+        if (u > v)
+            u = n - 1 - v;
+        else
+            v = n - 1 - u;
+    }
+
+    const bool upright = u + v == n - 1 || (scaled.x - float(u)) + (scaled.y - float(v)) < 1.f;
+    const int w = upright ? n - 1 - u - v : n - 2 - u - v;
+    return DiscreteBarycentricsToIndex(uint32_t(u), uint32_t(v), uint32_t(w), subdivisionLevel);
+}
+
+void OpacityMicromaps::GetMicroTriangleVertices(uint32_t index, uint32_t subdivisionLevel, float2 vertices[3])
+{
+    if (subdivisionLevel == 0)
+    {
+        vertices[0] = float2(0.f, 0.f);
+        vertices[1] = float2(1.f, 0.f);
+        vertices[2] = float2(0.f, 1.f);
+        return;
+    }
+
+    uint32_t u, v, w;
+    IndexToDiscreteBarycentrics(index, u, v, w);
+
+    const uint32_t mask = (1u << subdivisionLevel) - 1;
+    u &= mask;
+    v &= mask;
+    w &= mask;
+
+    const bool upright = ((u ^ v ^ w) & 1) != 0;
+    if (!upright)
+    {
+        u++;
+        v++;
+    }
+
+    const float scale = 1.f / float(1u << subdivisionLevel);
+    const float step = upright ? scale : -scale;
+    const float2 corner = float2(float(u), float(v)) * scale;
+    vertices[0] = corner;
+    vertices[1] = corner + float2(step, 0.f);
+    vertices[2] = corner + float2(0.f, step);
+}
+
+void OpacityMicromaps::Bake(ThreadPool& pool, const CpuScene& scene, const OmmBakeSettings& settings)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    const std::vector<CpuScene::Triangle>& triangles = scene.GetTriangles();
+
+    m_Indices.assign(triangles.size(), SpecialIndexFullyOpaque);
+    m_Descs.clear();
+    m_Data.clear();
+    m_Stats = OmmBakeStats();
+
+    std::vector<uint32_t> alphaTested;
+    for (uint32_t i = 0; i < triangles.size(); i++)
+    {
+        if (scene.GetMaterials()[scene.GetGeometries()[triangles[i].geometry].material].alphaTested)
+            alphaTested.push_back(i);
+    }
+
+    std::vector<BakedTriangle> baked(alphaTested.size());
+    pool.ParallelFor(uint32_t(alphaTested.size()), [&](uint32_t i)
+    {
+        BakeTriangle(scene, alphaTested[i], settings, baked[i]);
+    });
+
+    // Triangles with the same states, e.g. the instances of a mesh, share a micromap
+    std::map<std::pair<uint32_t, std::vector<uint8_t>>, int32_t> micromaps;
+    const uint32_t bits = GetBitsPerState(settings.format);
+    double totalArea = 0.0;
+    double knownArea = 0.0;
+
+    for (size_t i = 0; i < alphaTested.size(); i++)
+    {
+        const BakedTriangle& triangle = baked[i];
+        const double area = GetWorldArea(triangles[alphaTested[i]]);
+        totalArea += area;
+
+        uint32_t known = 0;
+        for (OmmState state : triangle.states)
+        {
+            m_Stats.microTriangles[uint32_t(state)]++;
+            known += IsKnown(state) ? 1 : 0;
+        }
+        knownArea += area * double(known) / double(triangle.states.size());
+
+        // Two-state micromaps keep what the unknown states lean towards
+        std::vector<OmmState> states = triangle.states;
+        if (settings.format == OmmFormat::TwoState)
+        {
+            for (OmmState& state : states)
+                state = OmmState(uint32_t(state) & 1);
+        }
+
+        if (std::all_of(states.begin(), states.end(), [&](OmmState state) { return state == states[0]; }))
+        {
+            m_Indices[alphaTested[i]] = -int32_t(states[0]) - 1;
+            m_Stats.specialIndexTriangles++;
+            continue;
+        }
+
+        std::vector<uint8_t> data((states.size() * bits + 7) / 8, 0);
+        for (uint32_t j = 0; j < states.size(); j++)
+            data[j * bits / 8] |= uint8_t(uint32_t(states[j]) << (j * bits % 8));
+
+        auto [it, inserted] = micromaps.emplace(std::make_pair(triangle.level, std::move(data)), int32_t(m_Descs.size()));
+        if (inserted)
+        {
+            OmmDesc desc;
+            desc.byteOffset = uint32_t(m_Data.size());
+            desc.subdivisionLevel = uint16_t(triangle.level);
+            desc.format = uint16_t(settings.format);
+            m_Descs.push_back(desc);
+            m_Data.insert(m_Data.end(), it->first.second.begin(), it->first.second.end());
+        }
+        m_Indices[alphaTested[i]] = it->second;
+    }
+
+    m_Stats.alphaTestedTriangles = uint32_t(alphaTested.size());
+    m_Stats.micromaps = uint32_t(m_Descs.size());
+    m_Stats.knownArea = totalArea > 0.0 ? knownArea / totalArea : 1.0;
+    m_Stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+OmmState OpacityMicromaps::GetState(uint32_t triangle, float2 barycentrics) const
+{
+    const int32_t index = m_Indices[triangle];
+    if (index < 0)
+        return OmmState(-index - 1);
+
+    const OmmDesc& desc = m_Descs[index];
+    return ReadState(m_Data.data() + desc.byteOffset, OmmFormat(desc.format), GetMicroTriangleIndex(barycentrics, desc.subdivisionLevel));
+}
+
+uint64_t OpacityMicromaps::Validate(ThreadPool& pool, const CpuScene& scene, uint32_t samplesPerMicroTriangle) const
+{
+    std::atomic<uint64_t> mismatches = 0;
+
+    pool.ParallelFor(uint32_t(m_Indices.size()), [&](uint32_t triangle)
+    {
+        const CpuScene::Geometry& geometry = scene.GetGeometries()[scene.GetTriangles()[triangle].geometry];
+        if (!scene.GetMaterials()[geometry.material].alphaTested)
+            return;
+
+        const int32_t index = m_Indices[triangle];
+        const uint32_t level = index < 0 ? c_ValidationLevel : m_Descs[index].subdivisionLevel;
+
+        std::minstd_rand rng(triangle + 1);
+        std::uniform_real_distribution<float> uniform(0.f, 1.f);
+        uint64_t localMismatches = 0;
+
+        for (uint32_t microTriangle = 0; microTriangle < (1u << (2 * level)); microTriangle++)
+        {
+            float2 vertices[3];
+            GetMicroTriangleVertices(microTriangle, level, vertices);
+
+            for (uint32_t i = 0; i < samplesPerMicroTriangle; i++)
+            {
+                float2 r = float2(uniform(rng), uniform(rng));
+                if (r.x + r.y > 1.f)
+                    r = float2(1.f - r.x, 1.f - r.y);
+
+                const float2 barycentrics = vertices[0] + (vertices[1] - vertices[0]) * r.x + (vertices[2] - vertices[0]) * r.y;
+                const OmmState state = GetState(triangle, barycentrics);
+                if (IsKnown(state) && (state == OmmState::Opaque) != scene.ConsiderTransparentMaterial(triangle, barycentrics))
+                    localMismatches++;
+            }
+        }
+
+        mismatches += localMismatches;
+    });
+
+    return mismatches;
+}
+
+std::vector<OmmUsageCount> OpacityMicromaps::GetUsageCounts() const
+{
+    std::map<std::pair<uint32_t, uint16_t>, uint32_t> counts;
+    for (const OmmDesc& desc : m_Descs)
+        counts[{ desc.subdivisionLevel, desc.format }]++;
+
+    std::vector<OmmUsageCount> usageCounts;
+    for (const auto& [key, count] : counts)
+    {
+        OmmUsageCount usageCount;
+        usageCount.count = count;
+        usageCount.subdivisionLevel = key.first;
+        usageCount.format = OmmFormat(key.second);
+        usageCounts.push_back(usageCount);
+    }
+    return usageCounts;
+}
+
+bool OpacityMicromaps::Write(const std::filesystem::path& fileName) const
+{
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    Header header = {};
+    memcpy(header.magic, c_Magic, sizeof(c_Magic));
+    header.version = c_Version;
+    header.triangleCount = m_Indices.size();
+    header.descCount = m_Descs.size();
+    header.dataSize = m_Data.size();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(m_Indices.data()), std::streamsize(m_Indices.size() * sizeof(int32_t)));
+    file.write(reinterpret_cast<const char*>(m_Descs.data()), std::streamsize(m_Descs.size() * sizeof(OmmDesc)));
+    file.write(reinterpret_cast<const char*>(m_Data.data()), std::streamsize(m_Data.size()));
+    return file.good();
+}
+
+bool OpacityMicromaps::Read(const std::filesystem::path& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    Header header = {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || memcmp(header.magic, c_Magic, sizeof(c_Magic)) != 0 || header.version != c_Version ||
+        header.triangleCount > UINT32_MAX || header.descCount > UINT32_MAX || header.dataSize > UINT32_MAX)
+    {
+        return false;
+    }
+
+    m_Indices.resize(size_t(header.triangleCount));
+    m_Descs.resize(size_t(header.descCount));
+    m_Data.resize(size_t(header.dataSize));
+    file.read(reinterpret_cast<char*>(m_Indices.data()), std::streamsize(m_Indices.size() * sizeof(int32_t)));
+    file.read(reinterpret_cast<char*>(m_Descs.data()), std::streamsize(m_Descs.size() * sizeof(OmmDesc)));
+    file.read(reinterpret_cast<char*>(m_Data.data()), std::streamsize(m_Data.size()));
+
+    bool valid = bool(file);
+    for (const OmmDesc& desc : m_Descs)
+    {
+        const uint64_t bytes = ((uint64_t(1) << (2 * desc.subdivisionLevel)) * GetBitsPerState(OmmFormat(desc.format)) + 7) / 8;
+        valid = valid && desc.subdivisionLevel <= 12 && (desc.format == uint16_t(OmmFormat::TwoState) || desc.format == uint16_t(OmmFormat::FourState)) &&
+            desc.byteOffset + bytes <= m_Data.size();
+    }
+    for (int32_t index : m_Indices)
+        valid = valid && index >= SpecialIndexFullyUnknownOpaque && index < int32_t(m_Descs.size());
+
+    // The stats of the bake are not stored
+    m_Stats = OmmBakeStats();
+    m_Stats.micromaps = uint32_t(m_Descs.size());
+
+    if (!valid)
+    {
+        m_Indices.clear();
+        m_Descs.clear();
+        m_Data.clear();
+        return false;
+    }
+
+    return true;
+}
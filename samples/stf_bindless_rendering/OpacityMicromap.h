@@ -0,0 +1,121 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "TaskGraph.h"
+
+#include <donut/core/math/math.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+class CpuScene;
+
+// D3D12_RAYTRACING_OPACITY_MICROMAP_STATE, VkOpacityMicromapSpecialIndexEXT uses the same values
+enum class OmmState : uint8_t
+{
+    Transparent = 0,
+    Opaque = 1,
+    UnknownTransparent = 2,     // runs the any-hit shader, transparent when any-hit is skipped
+    UnknownOpaque = 3,
+};
+
+// D3D12_RAYTRACING_OPACITY_MICROMAP_FORMAT
+enum class OmmFormat : uint16_t
+{
+    TwoState = 1,   // 1 bit per micro-triangle, unknown states are rounded to opaque or transparent
+    FourState = 2,  // 2 bits per micro-triangle
+};
+
+// D3D12_RAYTRACING_OPACITY_MICROMAP_DESC, one per micromap of the array
+struct OmmDesc
+{
+    uint32_t byteOffset = 0;
+    uint16_t subdivisionLevel = 0;
+    uint16_t format = uint16_t(OmmFormat::FourState);
+};
+
+// D3D12_RAYTRACING_OPACITY_MICROMAP_HISTOGRAM_ENTRY, the counts the array and BLAS builds are sized with
+struct OmmUsageCount
+{
+    uint32_t count = 0;
+    uint32_t subdivisionLevel = 0;
+    OmmFormat format = OmmFormat::FourState;
+};
+
+struct OmmBakeSettings
+{
+    OmmFormat format = OmmFormat::FourState;
+    // Triangles are subdivided until a micro-triangle covers about texelsPerMicroTriangle texels of mip 0
+    uint32_t maxSubdivisionLevel = 5;
+    float texelsPerMicroTriangle = 4.f;
+    // Micro-triangles whose texture footprint touches more texels are left unknown instead of rasterized
+    uint32_t maxTexelsPerMicroTriangle = 4096;
+};
+
+struct OmmBakeStats
+{
+    uint32_t alphaTestedTriangles = 0;
+    uint32_t specialIndexTriangles = 0;     // alpha-tested triangles of one state that need no micromap
+    uint32_t micromaps = 0;                 // after merging triangles with the same micromap
+    uint64_t microTriangles[4] = {};        // by OmmState, of the alpha-tested triangles
+    double knownArea = 0.0;                 // share of the alpha-tested surface with an opaque or transparent state
+    double milliseconds = 0.0;
+};
+
+// Opacity micromaps of the alpha-tested triangles of a CpuScene, baked from the alpha channel of their base color
+// texture at mip 0 and the alpha cutoff, which is what the any-hit shaders test. The texels that can reach a
+// micro-triangle through the bilinear filter are found by rasterizing its texture space footprint grown by a texel:
+// it is opaque or transparent when all of them agree and unknown otherwise, so a known state never differs from
+// the alpha test. Triangles of one state use the special indices instead of a micromap.
+// The data follows the D3D12 layout: micro-triangles in bird curve order, one index per triangle into the descs.
+class OpacityMicromaps
+{
+public:
+    // D3D12_RAYTRACING_OPACITY_MICROMAP_SPECIAL_INDEX
+    static constexpr int32_t SpecialIndexFullyTransparent = -1;
+    static constexpr int32_t SpecialIndexFullyOpaque = -2;
+    static constexpr int32_t SpecialIndexFullyUnknownTransparent = -3;
+    static constexpr int32_t SpecialIndexFullyUnknownOpaque = -4;
+
+    // The micro-triangle of a subdivision level containing the point, and the barycentrics of its three vertices.
+    // Barycentrics are the weights of vertex 1 and 2, like the DXR triangle barycentrics.
+    static uint32_t GetMicroTriangleIndex(dm::float2 barycentrics, uint32_t subdivisionLevel);
+    static void GetMicroTriangleVertices(uint32_t index, uint32_t subdivisionLevel, dm::float2 vertices[3]);
+
+    void Bake(ThreadPool& pool, const CpuScene& scene, const OmmBakeSettings& settings);
+
+    // State of a point on a scene triangle, Opaque for triangles that are not alpha tested
+    [[nodiscard]] OmmState GetState(uint32_t triangle, dm::float2 barycentrics) const;
+    [[nodiscard]] static bool IsKnown(OmmState state) { return state == OmmState::Opaque || state == OmmState::Transparent; }
+
+    // Evaluates the alpha test at samplesPerMicroTriangle random points of every micro-triangle with a known state
+    // and returns how many disagree with it. Zero for four-state micromaps.
+    uint64_t Validate(ThreadPool& pool, const CpuScene& scene, uint32_t samplesPerMicroTriangle) const;
+
+    [[nodiscard]] bool IsEmpty() const { return m_Indices.empty(); }
+    [[nodiscard]] const OmmBakeStats& GetStats() const { return m_Stats; }
+    [[nodiscard]] const std::vector<int32_t>& GetIndices() const { return m_Indices; }   // per scene triangle
+    [[nodiscard]] const std::vector<OmmDesc>& GetDescs() const { return m_Descs; }
+    [[nodiscard]] const std::vector<uint8_t>& GetData() const { return m_Data; }
+    [[nodiscard]] std::vector<OmmUsageCount> GetUsageCounts() const;
+
+    // Binary file with the indices, descs and data
+    bool Write(const std::filesystem::path& fileName) const;
+    bool Read(const std::filesystem::path& fileName);
+
+private:
+    std::vector<int32_t> m_Indices;
+    std::vector<OmmDesc> m_Descs;
+    std::vector<uint8_t> m_Data;
+    OmmBakeStats m_Stats;
+};
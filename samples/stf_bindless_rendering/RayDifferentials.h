@@ -0,0 +1,119 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <donut/core/math/math.h>
+
+// C++ version of ray_differentials.hlsli.
+// Texture gradients from ray differentials (Igehy, "Tracing Ray Differentials"): the change of the ray origin and
+// direction per pixel step is carried to the hit point, and a per-triangle Jacobian turns the position change into a
+// texture coordinate change. One hit is enough, no neighbor rays are traced or intersected.
+
+// Change of a ray per pixel step in x and y. Directions are normalized.
+struct RayDifferential
+{
+    dm::float3 dOdx = 0.f;
+    dm::float3 dOdy = 0.f;
+    dm::float3 dDdx = 0.f;
+    dm::float3 dDdy = 0.f;
+};
+
+// Gradients of the texture coordinates with respect to a world space position in the triangle plane.
+// Constant over a triangle, computed once per static triangle.
+struct TexcoordJacobian
+{
+    dm::float3 dUdP = 0.f;
+    dm::float3 dVdP = 0.f;
+};
+
+inline TexcoordJacobian ComputeTexcoordJacobian(const dm::float3 positions[3], const dm::float2 texcoords[3])
+{
+    const dm::float3 edge1 = positions[1] - positions[0];
+    const dm::float3 edge2 = positions[2] - positions[0];
+    const dm::float3 normal = dm::cross(edge1, edge2);
+    const float lengthSquared = dm::dot(normal, normal);
+
+    TexcoordJacobian jacobian;
+    if (lengthSquared <= 0.f)
+        return jacobian;
+
+    // Gradients of the barycentrics of vertex 1 and 2 in the triangle plane
+    const dm::float3 dB1dP = dm::cross(edge2, normal) / lengthSquared;
+    const dm::float3 dB2dP = dm::cross(normal, edge1) / lengthSquared;
+
+    const dm::float2 texEdge1 = texcoords[1] - texcoords[0];
+    const dm::float2 texEdge2 = texcoords[2] - texcoords[0];
+    jacobian.dUdP = dB1dP * texEdge1.x + dB2dP * texEdge2.x;
+    jacobian.dVdP = dB1dP * texEdge1.y + dB2dP * texEdge2.y;
+    return jacobian;
+}
+
+// Differential of a pinhole camera ray through the center of pixelPosition, the ray setupPrimaryRay builds.
+// The world position on the clip plane is a projective function of the pixel, its derivative comes from the rows
+// of matClipToWorld instead of a second and third unprojection.
+inline RayDifferential GetPrimaryRayDifferential(dm::uint2 pixelPosition, const dm::float4x4& matClipToWorld,
+    dm::float2 viewportSizeInv, dm::float3 cameraPosition)
+{
+    const dm::float2 uv = (dm::float2(pixelPosition) + 0.5f) * viewportSizeInv;
+    const dm::float4 clipPos = dm::float4(uv.x * 2.f - 1.f, 1.f - uv.y * 2.f, 0.5f, 1.f);
+    const dm::float4 worldPos = clipPos * matClipToWorld;
+    const dm::float3 position = worldPos.xyz() / worldPos.w;
+
+    // One pixel is 2 / width in clip x and -2 / height in clip y
+    const dm::float4 dWorldPosdx = matClipToWorld.row0 * (2.f * viewportSizeInv.x);
+    const dm::float4 dWorldPosdy = matClipToWorld.row1 * (-2.f * viewportSizeInv.y);
+    const dm::float3 dPositiondx = (dWorldPosdx.xyz() - position * dWorldPosdx.w) / worldPos.w;
+    const dm::float3 dPositiondy = (dWorldPosdy.xyz() - position * dWorldPosdy.w) / worldPos.w;
+
+    // Derivative of normalize(position - cameraPosition)
+    const dm::float3 direction = position - cameraPosition;
+    const float invLength = 1.f / dm::length(direction);
+    const dm::float3 normalized = direction * invLength;
+
+    RayDifferential differential;
+    differential.dDdx = (dPositiondx - normalized * dm::dot(normalized, dPositiondx)) * invLength;
+    differential.dDdy = (dPositiondy - normalized * dm::dot(normalized, dPositiondy)) * invLength;
+    return differential;
+}
+
+// Change of the hit position per pixel step for a hit at hitT along the normalized direction on a surface with
+// the given normal, which does not need to be normalized. The differential is moved along the ray and projected
+// onto the plane of the surface.
+inline void TransferRayDifferential(const RayDifferential& differential, dm::float3 direction, float hitT,
+    dm::float3 normal, dm::float3& dPdx, dm::float3& dPdy)
+{
+    const float invDirectionDotNormal = 1.f / dm::dot(direction, normal);
+
+    dPdx = differential.dOdx + differential.dDdx * hitT;
+    dPdy = differential.dOdy + differential.dDdy * hitT;
+    dPdx -= direction * (dm::dot(dPdx, normal) * invDirectionDotNormal);
+    dPdy -= direction * (dm::dot(dPdy, normal) * invDirectionDotNormal);
+}
+
+// Differential of a ray reflected at the hit, for texture gradients on secondary hits. The surface is treated as
+// flat over the pixel footprint, so only the incoming direction change is mirrored. normal must be normalized here.
+inline RayDifferential ReflectRayDifferential(const RayDifferential& differential, dm::float3 dPdx, dm::float3 dPdy,
+    dm::float3 normal)
+{
+    RayDifferential reflected;
+    reflected.dOdx = dPdx;
+    reflected.dOdy = dPdy;
+    reflected.dDdx = differential.dDdx - normal * (2.f * dm::dot(differential.dDdx, normal));
+    reflected.dDdy = differential.dDdy - normal * (2.f * dm::dot(differential.dDdy, normal));
+    return reflected;
+}
+
+inline void GetTextureGradients(const TexcoordJacobian& jacobian, dm::float3 dPdx, dm::float3 dPdy,
+    dm::float2& texGradX, dm::float2& texGradY)
+{
+    texGradX = dm::float2(dm::dot(jacobian.dUdP, dPdx), dm::dot(jacobian.dVdP, dPdx));
+    texGradY = dm::float2(dm::dot(jacobian.dUdP, dPdy), dm::dot(jacobian.dVdP, dPdy));
+}
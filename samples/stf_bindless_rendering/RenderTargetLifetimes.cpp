@@ -0,0 +1,178 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "RenderTargetLifetimes.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+    uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+        return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+    }
+
+    bool LifetimesOverlap(const RenderTargetPlacement& a, const RenderTargetPlacement& b)
+    {
+        return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+    }
+}
+
+bool PlanRenderTargets(const std::vector<RenderTargetRequirements>& targets, const std::vector<RenderPassUsage>& passes,
+    RenderTargetPlan& plan, std::string& error)
+{
+    plan = RenderTargetPlan();
+    plan.placements.resize(targets.size());
+
+    std::unordered_map<std::string, size_t> indices;
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        indices[targets[i].name] = i;
+        plan.declaredBytes += targets[i].size;
+    }
+
+    std::vector<bool> written(targets.size(), false);
+    std::vector<bool> clearedOnFirstUse(targets.size(), false);
+
+    for (uint32_t passIndex = 0; passIndex < uint32_t(passes.size()); passIndex++)
+    {
+        const RenderPassUsage& pass = passes[passIndex];
+
+        auto use = [&](const std::string& name, bool write, bool clear) -> bool
+        {
+            auto it = indices.find(name);
+            if (it == indices.end())
+            {
+                error = "Pass '" + pass.name + "' uses undeclared render target '" + name + "'";
+                return false;
+            }
+
+            const size_t index = it->second;
+            RenderTargetPlacement& placement = plan.placements[index];
+
+            if (!placement.used)
+            {
+                placement.used = true;
+                placement.firstPass = passIndex;
+                clearedOnFirstUse[index] = clear;
+            }
+            placement.lastPass = passIndex;
+
+            if (!write && !written[index] && targets[index].lifetime == RenderTargetLifetime::Transient)
+            {
+                error = "Pass '" + pass.name + "' reads transient render target '" + name + "' before any pass writes it";
+                return false;
+            }
+
+            written[index] = written[index] || write;
+            return true;
+        };
+
+        // Clears and writes first, a pass that reads a target it also writes is fine
+        for (const std::string& name : pass.clears)
+            if (!use(name, true, true))
+                return false;
+        for (const std::string& name : pass.writes)
+            if (!use(name, true, false))
+                return false;
+        for (const std::string& name : pass.reads)
+            if (!use(name, false, false))
+                return false;
+    }
+
+    const uint32_t lastPass = passes.empty() ? 0 : uint32_t(passes.size()) - 1;
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        RenderTargetPlacement& placement = plan.placements[i];
+        if (!placement.used)
+            continue;
+
+        // Persistent targets are live across the frame boundary
+        if (targets[i].lifetime == RenderTargetLifetime::Persistent)
+        {
+            placement.firstPass = 0;
+            placement.lastPass = lastPass;
+        }
+
+        order.push_back(i);
+        plan.usedBytes += targets[i].size;
+        plan.usedCount++;
+    }
+
+    // Largest first packs better. Persistent targets span every pass, so they end up side by side.
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+    {
+        return targets[a].size > targets[b].size;
+    });
+
+    std::vector<size_t> placed;
+    for (size_t index : order)
+    {
+        RenderTargetPlacement& placement = plan.placements[index];
+        const RenderTargetRequirements& target = targets[index];
+
+        // Lowest offset that does not collide with a placed target live at the same time
+        std::vector<uint64_t> candidates = { 0 };
+        for (size_t other : placed)
+        {
+            if (LifetimesOverlap(placement, plan.placements[other]))
+                candidates.push_back(plan.placements[other].offset + targets[other].size);
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        for (uint64_t candidate : candidates)
+        {
+            const uint64_t offset = AlignUp(candidate, target.alignment);
+
+            bool fits = true;
+            for (size_t other : placed)
+            {
+                const RenderTargetPlacement& otherPlacement = plan.placements[other];
+                if (LifetimesOverlap(placement, otherPlacement) &&
+                    offset < otherPlacement.offset + targets[other].size && otherPlacement.offset < offset + target.size)
+                {
+                    fits = false;
+                    break;
+                }
+            }
+
+            if (fits)
+            {
+                placement.offset = offset;
+                break;
+            }
+        }
+
+        placed.push_back(index);
+        plan.heapSize = std::max(plan.heapSize, placement.offset + target.size);
+    }
+
+    // Memory is reused every frame, so a target is aliased whether the other one comes before or after it
+    for (size_t a : placed)
+    {
+        for (size_t b : placed)
+        {
+            if (a != b &&
+                plan.placements[a].offset < plan.placements[b].offset + targets[b].size &&
+                plan.placements[b].offset < plan.placements[a].offset + targets[a].size)
+            {
+                plan.placements[a].aliased = true;
+                break;
+            }
+        }
+
+        plan.placements[a].needsClear = plan.placements[a].aliased && !clearedOnFirstUse[a];
+    }
+
+    return true;
+}
@@ -0,0 +1,73 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class RenderTargetLifetime : uint8_t
+{
+    // Contents only matter between the first and the last pass using it in a frame, memory may be shared
+    Transient,
+    // Contents are kept across frames (history, or read before being written), never shares memory
+    Persistent
+};
+
+struct RenderTargetRequirements
+{
+    std::string name;
+    uint64_t size = 0;
+    uint64_t alignment = 1;
+    RenderTargetLifetime lifetime = RenderTargetLifetime::Transient;
+};
+
+// Targets accessed by one pass of the frame, by name. Targets in 'clears' are fully initialized by the pass.
+struct RenderPassUsage
+{
+    std::string name;
+    std::vector<std::string> reads;
+    std::vector<std::string> writes;
+    std::vector<std::string> clears;
+
+    bool operator==(const RenderPassUsage& other) const
+    {
+        return name == other.name && reads == other.reads && writes == other.writes && clears == other.clears;
+    }
+    bool operator!=(const RenderPassUsage& other) const { return !(*this == other); }
+};
+
+struct RenderTargetPlacement
+{
+    bool used = false;
+    uint32_t firstPass = 0;
+    uint32_t lastPass = 0;
+    uint64_t offset = 0;
+    // Shares memory with another target, so its contents are undefined when it becomes live
+    bool aliased = false;
+    // Aliased and the first pass does not clear it, whoever runs the passes has to
+    bool needsClear = false;
+};
+
+struct RenderTargetPlan
+{
+    std::vector<RenderTargetPlacement> placements; // in the order of the requirements
+    uint64_t heapSize = 0;      // all used targets placed in one heap
+    uint64_t usedBytes = 0;     // used targets without aliasing
+    uint64_t declaredBytes = 0; // every target, used or not
+    uint32_t usedCount = 0;
+};
+
+// Finds the live range of every target over the frame's passes and places the used targets in one heap,
+// overlapping the memory of transient targets whose live ranges do not overlap. Unused targets get no memory.
+// Fails on passes that use undeclared targets, or transient targets that are read before any pass writes them.
+bool PlanRenderTargets(const std::vector<RenderTargetRequirements>& targets, const std::vector<RenderPassUsage>& passes,
+    RenderTargetPlan& plan, std::string& error);
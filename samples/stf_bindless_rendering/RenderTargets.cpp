@@ -10,14 +10,21 @@
 
 #include "RenderTargets.h"
 
+#include <donut/core/log.h>
 #include <donut/engine/FramebufferFactory.h>
 
 using namespace dm;
 using namespace donut;
 
-RenderTargets::RenderTargets(nvrhi::IDevice* device, int2 dlssInputSize, int2 dlssOutputSize)
+RenderTargets::RenderTargets(nvrhi::IDevice* device, int2 dlssInputSize, int2 dlssOutputSize, const std::vector<RenderPassUsage>& passes)
     : Size(dlssInputSize)
+    , m_Passes(passes)
 {
+    auto declare = [this](nvrhi::TextureHandle& handle, const nvrhi::TextureDesc& desc, RenderTargetLifetime lifetime)
+    {
+        m_Targets.push_back({ &handle, desc, lifetime });
+    };
+
     nvrhi::TextureDesc desc;
     desc.width = dlssInputSize.x;
     desc.height = dlssInputSize.y;
@@ -31,17 +38,14 @@ RenderTargets::RenderTargets(nvrhi::IDevice* device, int2 dlssInputSize, int2 dl
 
     desc.format = nvrhi::Format::SRGBA8_UNORM;
     desc.debugName = "LdrColor";
-    LdrColor = device->createTexture(desc);
+    declare(LdrColor, desc, RenderTargetLifetime::Transient);
 
-    LdrFramebuffer = std::make_shared<engine::FramebufferFactory>(device);
-    LdrFramebuffer->RenderTargets = { LdrColor };
-    
     desc.format = nvrhi::Format::D32;
     desc.debugName = "DeviceDepth";
     desc.initialState = nvrhi::ResourceStates::DepthWrite;
     desc.clearValue = 0.f;
     desc.useClearValue = true;
-    DeviceDepth = device->createTexture(desc);
+    declare(DeviceDepth, desc, RenderTargetLifetime::Persistent);
 
     // G-buffer targets
 
@@ -52,92 +56,69 @@ RenderTargets::RenderTargets(nvrhi::IDevice* device, int2 dlssInputSize, int2 dl
 #define BACKGROUND_DEPTH 65504.f
     desc.clearValue = BACKGROUND_DEPTH;
     desc.debugName = "DepthBuffer";
-    Depth = device->createTexture(desc);
+    declare(Depth, desc, RenderTargetLifetime::Transient);
     desc.debugName = "PrevDepthBuffer";
-    PrevDepth = device->createTexture(desc);
+    declare(PrevDepth, desc, RenderTargetLifetime::Persistent);
 
     desc.useClearValue = false;
     desc.clearValue = 0.f;
 
     desc.format = nvrhi::Format::R32_FLOAT;
     desc.debugName = "DeviceDepthUAV";
-    DeviceDepthUAV = device->createTexture(desc);
+    declare(DeviceDepthUAV, desc, RenderTargetLifetime::Persistent);
 
     desc.format = nvrhi::Format::SRGBA8_UNORM;
     desc.debugName = "GBufferDiffuseAlbedo";
-    GBufferDiffuseAlbedo = device->createTexture(desc);
+    declare(GBufferDiffuseAlbedo, desc, RenderTargetLifetime::Transient);
     desc.debugName = "PrevGBufferDiffuseAlbedo";
-    PrevGBufferDiffuseAlbedo = device->createTexture(desc);
+    declare(PrevGBufferDiffuseAlbedo, desc, RenderTargetLifetime::Persistent);
 
     desc.format = nvrhi::Format::SRGBA8_UNORM;
     desc.debugName = "GBufferSpecularRough";
-    GBufferSpecularRough = device->createTexture(desc);
+    declare(GBufferSpecularRough, desc, RenderTargetLifetime::Transient);
     desc.debugName = "PrevGBufferSpecularRough";
-    PrevGBufferSpecularRough = device->createTexture(desc);
+    declare(PrevGBufferSpecularRough, desc, RenderTargetLifetime::Persistent);
 
     desc.format = nvrhi::Format::RGBA16_SNORM;
     desc.debugName = "GBufferNormals";
-    GBufferNormals = device->createTexture(desc);
+    declare(GBufferNormals, desc, RenderTargetLifetime::Transient);
     desc.debugName = "PrevGBufferNormals";
-    PrevGBufferNormals = device->createTexture(desc);
+    declare(PrevGBufferNormals, desc, RenderTargetLifetime::Persistent);
     
     desc.format = nvrhi::Format::R32_UINT;
     desc.debugName = "GBufferGeoNormals";
-    GBufferGeoNormals = device->createTexture(desc);
+    declare(GBufferGeoNormals, desc, RenderTargetLifetime::Transient);
     desc.debugName = "PrevGBufferGeoNormals";
-    PrevGBufferGeoNormals = device->createTexture(desc);
+    declare(PrevGBufferGeoNormals, desc, RenderTargetLifetime::Persistent);
+
+    desc.format = nvrhi::Format::RG32_UINT;
+    desc.debugName = "GBufferTexelIds";
+    declare(GBufferTexelIds, desc, RenderTargetLifetime::Transient);
 
     desc.format = nvrhi::Format::RGBA8_UNORM;
     desc.debugName = "NormalRoughness";
-    NormalRoughness = device->createTexture(desc);
+    declare(NormalRoughness, desc, RenderTargetLifetime::Transient);
 
     desc.format = nvrhi::Format::RGBA16_FLOAT;
     desc.debugName = "GBufferEmissive";
-    GBufferEmissive = device->createTexture(desc);
+    declare(GBufferEmissive, desc, RenderTargetLifetime::Transient);
 
     desc.format = nvrhi::Format::RGBA16_FLOAT;
     desc.debugName = "MotionVectors";
-    MotionVectors = device->createTexture(desc);
+    declare(MotionVectors, desc, RenderTargetLifetime::Persistent);
 
     desc.format = nvrhi::Format::RGBA16_FLOAT;
     desc.width = dlssOutputSize.x;
     desc.height = dlssOutputSize.y;
     desc.debugName = "ResolvedColor";
-    ResolvedColor = device->createTexture(desc);
+    declare(ResolvedColor, desc, RenderTargetLifetime::Transient);
 
     desc.width = dlssInputSize.x;
     desc.height = dlssInputSize.y;
 
     desc.format = nvrhi::Format::RGBA16_FLOAT;
     desc.debugName = "ReferenceColor";
-    ReferenceColor = device->createTexture(desc);
-
-    GBufferFramebuffer = std::make_shared<engine::FramebufferFactory>(device);
-    GBufferFramebuffer->DepthTarget = DeviceDepth;
-    GBufferFramebuffer->RenderTargets = {
-        Depth,
-        GBufferDiffuseAlbedo,
-        GBufferSpecularRough,
-        GBufferNormals,
-        GBufferGeoNormals,
-        GBufferEmissive,
-        MotionVectors
-    };
-
-    PrevGBufferFramebuffer = std::make_shared<engine::FramebufferFactory>(device);
-    PrevGBufferFramebuffer->DepthTarget = DeviceDepth;
-    PrevGBufferFramebuffer->RenderTargets = {
-        PrevDepth,
-        PrevGBufferDiffuseAlbedo,
-        PrevGBufferSpecularRough,
-        PrevGBufferNormals,
-        PrevGBufferGeoNormals,
-        GBufferEmissive,
-        MotionVectors
-    };
-
-    ResolvedFramebuffer = std::make_shared<engine::FramebufferFactory>(device);
-    ResolvedFramebuffer->RenderTargets = { ResolvedColor };
+    declare(ReferenceColor, desc, RenderTargetLifetime::Transient);
 
     // UAV-only textures
 
@@ -146,13 +127,199 @@ RenderTargets::RenderTargets(nvrhi::IDevice* device, int2 dlssInputSize, int2 dl
     desc.format = nvrhi::Format::RGBA16_FLOAT;
     desc.debugName = "HdrColor";
     desc.clearValue = 0.0;
-    HdrColor = device->createTexture(desc);
+    declare(HdrColor, desc, RenderTargetLifetime::Transient);
 
     desc.format = nvrhi::Format::RGBA16_SNORM;
     desc.debugName = "TemporalFeedback1";
-    TaaFeedback1 = device->createTexture(desc);
+    declare(TaaFeedback1, desc, RenderTargetLifetime::Persistent);
     desc.debugName = "TemporalFeedback2";
-    TaaFeedback2 = device->createTexture(desc);
+    declare(TaaFeedback2, desc, RenderTargetLifetime::Persistent);
+
+    Allocate(device);
+
+    // Framebuffers only for the passes that run
+    if (LdrColor)
+    {
+        LdrFramebuffer = std::make_shared<engine::FramebufferFactory>(device);
+        LdrFramebuffer->RenderTargets = { LdrColor };
+    }
+
+    if (GBufferDiffuseAlbedo)
+    {
+        GBufferFramebuffer = std::make_shared<engine::FramebufferFactory>(device);
+        GBufferFramebuffer->DepthTarget = DeviceDepth;
+        GBufferFramebuffer->RenderTargets = {
+            Depth,
+            GBufferDiffuseAlbedo,
+            GBufferSpecularRough,
+            GBufferNormals,
+            GBufferGeoNormals,
+            GBufferEmissive,
+            MotionVectors
+        };
+        if (GBufferTexelIds)
+            GBufferFramebuffer->RenderTargets.push_back(GBufferTexelIds);
+    }
+
+    if (PrevGBufferDiffuseAlbedo)
+    {
+        PrevGBufferFramebuffer = std::make_shared<engine::FramebufferFactory>(device);
+        PrevGBufferFramebuffer->DepthTarget = DeviceDepth;
+        PrevGBufferFramebuffer->RenderTargets = {
+            PrevDepth,
+            PrevGBufferDiffuseAlbedo,
+            PrevGBufferSpecularRough,
+            PrevGBufferNormals,
+            PrevGBufferGeoNormals,
+            GBufferEmissive,
+            MotionVectors
+        };
+        if (GBufferTexelIds)
+            PrevGBufferFramebuffer->RenderTargets.push_back(GBufferTexelIds);
+    }
+
+    // The channels the texel resolve writes, in the order of gbuffer_texel_resolve_ps
+    if (GBufferTexelIds)
+    {
+        GBufferResolveFramebuffer = std::make_shared<engine::FramebufferFactory>(device);
+        GBufferResolveFramebuffer->RenderTargets = {
+            GBufferDiffuseAlbedo,
+            GBufferSpecularRough,
+            GBufferNormals,
+            GBufferEmissive
+        };
+    }
+
+    if (ResolvedColor)
+    {
+        ResolvedFramebuffer = std::make_shared<engine::FramebufferFactory>(device);
+        ResolvedFramebuffer->RenderTargets = { ResolvedColor };
+    }
+}
+
+void RenderTargets::Allocate(nvrhi::IDevice* device)
+{
+    // Virtual textures have no memory yet, which is what the sizes are needed for
+    std::vector<nvrhi::TextureHandle> textures;
+    std::vector<RenderTargetRequirements> requirements;
+    for (const Target& target : m_Targets)
+    {
+        nvrhi::TextureDesc desc = target.desc;
+        desc.isVirtual = true;
+        nvrhi::TextureHandle texture = device->createTexture(desc);
+        const nvrhi::MemoryRequirements memory = device->getTextureMemoryRequirements(texture);
+
+        textures.push_back(texture);
+        requirements.push_back({ desc.debugName, memory.size, memory.alignment, target.lifetime });
+        m_TargetSizes.push_back(memory.size);
+    }
+
+    std::string error;
+    if (!PlanRenderTargets(requirements, m_Passes, m_Plan, error))
+    {
+        // Still render, with every target in its own allocation as before
+        log::error("%s", error.c_str());
+
+        for (size_t i = 0; i < m_Targets.size(); i++)
+            *m_Targets[i].handle = device->createTexture(m_Targets[i].desc);
+
+        m_Plan = RenderTargetPlan();
+        m_Plan.placements.resize(m_Targets.size());
+        for (const RenderTargetRequirements& target : requirements)
+            m_Plan.declaredBytes += target.size;
+        m_Plan.usedBytes = m_Plan.declaredBytes;
+        m_Plan.usedCount = uint32_t(m_Targets.size());
+        return;
+    }
+
+    if (m_Plan.heapSize > 0)
+    {
+        nvrhi::HeapDesc heapDesc;
+        heapDesc.capacity = m_Plan.heapSize;
+        heapDesc.type = nvrhi::HeapType::DeviceLocal;
+        heapDesc.debugName = "RenderTargets";
+        m_Heap = device->createHeap(heapDesc);
+    }
+
+    for (size_t i = 0; i < m_Targets.size(); i++)
+    {
+        RenderTargetPlacement& placement = m_Plan.placements[i];
+        if (!placement.used)
+            continue;
+
+        if (m_Heap && device->bindTextureMemory(textures[i], m_Heap, placement.offset))
+        {
+            *m_Targets[i].handle = textures[i];
+        }
+        else
+        {
+            // No placed resources for this one, it cannot share memory then
+            *m_Targets[i].handle = device->createTexture(m_Targets[i].desc);
+            placement.aliased = false;
+            placement.needsClear = false;
+        }
+    }
+}
+
+RenderPassUsage RenderTargets::GetGBufferPassUsage(bool deferredTexels)
+{
+    RenderPassUsage pass = { "gbuffer", {}, { "DeviceDepth", "DepthBuffer", "GBufferDiffuseAlbedo", "GBufferSpecularRough", "GBufferNormals",
+        "GBufferGeoNormals", "GBufferEmissive", "MotionVectors" }, {} };
+    if (deferredTexels)
+        pass.writes.push_back("GBufferTexelIds");
+    return pass;
+}
+
+bool RenderTargets::IsUpdateRequired(const std::vector<RenderPassUsage>& passes) const
+{
+    return passes != m_Passes;
+}
+
+void RenderTargets::BeginPass(nvrhi::ICommandList* commandList, const char* passName) const
+{
+    for (uint32_t passIndex = 0; passIndex < uint32_t(m_Passes.size()); passIndex++)
+    {
+        if (m_Passes[passIndex].name != passName)
+            continue;
+
+        for (size_t i = 0; i < m_Targets.size(); i++)
+        {
+            const RenderTargetPlacement& placement = m_Plan.placements[i];
+            if (!placement.needsClear || placement.firstPass != passIndex)
+                continue;
+
+            // The memory holds whatever the other target left in it, a clear makes the contents defined again
+            nvrhi::ITexture* texture = *m_Targets[i].handle;
+            const nvrhi::FormatInfo& formatInfo = nvrhi::getFormatInfo(texture->getDesc().format);
+            if (formatInfo.hasDepth || formatInfo.hasStencil)
+                commandList->clearDepthStencilTexture(texture, nvrhi::AllSubresources, true, 0.f, formatInfo.hasStencil, 0);
+            else if (formatInfo.kind == nvrhi::FormatKind::Integer)
+                commandList->clearTextureUInt(texture, nvrhi::AllSubresources, 0);
+            else
+                commandList->clearTextureFloat(texture, nvrhi::AllSubresources, texture->getDesc().clearValue);
+        }
+
+        return;
+    }
+}
+
+void RenderTargets::LogMemoryUsage() const
+{
+    constexpr double MB = 1024.0 * 1024.0;
+
+    for (size_t i = 0; i < m_Targets.size(); i++)
+    {
+        const RenderTargetPlacement& placement = m_Plan.placements[i];
+        if (!*m_Targets[i].handle)
+            continue;
+
+        log::info("  %-26s %8.2f MB%s", m_Targets[i].desc.debugName.c_str(), double(m_TargetSizes[i]) / MB,
+            placement.aliased ? "  (aliased)" : "");
+    }
+
+    log::info("Render targets: %d of %d allocated, %.1f MB in a %.1f MB heap (%.1f MB if every target were allocated separately)",
+        int(m_Plan.usedCount), int(m_Targets.size()), double(m_Plan.usedBytes) / MB, double(m_Plan.heapSize) / MB,
+        double(m_Plan.declaredBytes) / MB);
 }
 
 bool RenderTargets::IsUpdateRequired(int2 size)
@@ -10,15 +10,20 @@
 
 #pragma once
 
+#include "RenderTargetLifetimes.h"
+
 #include <donut/core/math/math.h>
 #include <nvrhi/nvrhi.h>
 #include <memory>
+#include <vector>
 
 namespace donut::engine
 {
     class FramebufferFactory;
 }
 
+// Only the targets used by the passes given at creation are allocated, the others stay null. Used targets are
+// placed in a single heap where transient targets with disjoint live ranges share memory.
 class RenderTargets
 {
 public:
@@ -31,6 +36,7 @@ public:
     nvrhi::TextureHandle GBufferNormals;
     nvrhi::TextureHandle GBufferGeoNormals;
     nvrhi::TextureHandle GBufferEmissive;
+    nvrhi::TextureHandle GBufferTexelIds;   // deferred texels, see gbuffer_texel_id.h
     nvrhi::TextureHandle PrevGBufferDiffuseAlbedo;
     nvrhi::TextureHandle PrevGBufferSpecularRough;
     nvrhi::TextureHandle PrevGBufferNormals;
@@ -65,11 +71,44 @@ public:
     std::shared_ptr<donut::engine::FramebufferFactory> ResolvedFramebuffer;
     std::shared_ptr<donut::engine::FramebufferFactory> GBufferFramebuffer;
     std::shared_ptr<donut::engine::FramebufferFactory> PrevGBufferFramebuffer;
+    std::shared_ptr<donut::engine::FramebufferFactory> GBufferResolveFramebuffer;
 
     dm::int2 Size;
 
-    RenderTargets(nvrhi::IDevice* device, dm::int2 dlssInputSize, dm::int2 dlssOutputSize);
+    RenderTargets(nvrhi::IDevice* device, dm::int2 dlssInputSize, dm::int2 dlssOutputSize, const std::vector<RenderPassUsage>& passes);
+
+    RenderTargets(const RenderTargets&) = delete;
+    RenderTargets& operator=(const RenderTargets&) = delete;
+
+    // The targets the G-buffer fill pass writes. Targets created for just this pass get a GBufferFramebuffer
+    // with the formats of the one the frame renders to.
+    static RenderPassUsage GetGBufferPassUsage(bool deferredTexels);
 
     bool IsUpdateRequired(dm::int2 size);
+    bool IsUpdateRequired(const std::vector<RenderPassUsage>& passes) const;
+
+    // Swaps the G-buffer with its Prev* history. Unused by the sample, the current G-buffer targets are transient and may share memory.
     void NextFrame();
+
+    // Clears the aliased targets that become live in this pass, unless the pass clears them itself
+    void BeginPass(nvrhi::ICommandList* commandList, const char* passName) const;
+
+    // Bytes per target and totals, through log::info
+    void LogMemoryUsage() const;
+
+private:
+    struct Target
+    {
+        nvrhi::TextureHandle* handle;
+        nvrhi::TextureDesc desc;
+        RenderTargetLifetime lifetime;
+    };
+
+    std::vector<Target> m_Targets;
+    std::vector<uint64_t> m_TargetSizes;
+    std::vector<RenderPassUsage> m_Passes;
+    RenderTargetPlan m_Plan;
+    nvrhi::HeapHandle m_Heap;
+
+    void Allocate(nvrhi::IDevice* device);
 };
@@ -0,0 +1,360 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "SceneLoader.h"
+#include "TextureProcessing.h"
+
+#include <donut/core/json.h>
+#include <donut/core/log.h>
+#include <donut/core/vfs/VFS.h>
+#include <donut/engine/GltfImporter.h>
+#include <donut/engine/SceneGraph.h>
+#include <donut/engine/TextureCache.h>
+#include <json/json.h>
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <unordered_set>
+
+using namespace donut;
+
+namespace
+{
+    bool ReadJsonFile(const std::filesystem::path& fileName, Json::Value& root, std::string& error)
+    {
+        std::ifstream file(fileName);
+        if (!file.is_open())
+        {
+            error = "Cannot open '" + fileName.generic_string() + "'";
+            return false;
+        }
+
+        Json::CharReaderBuilder builder;
+        std::string errors;
+        if (!Json::parseFromStream(builder, file, &root, &errors))
+        {
+            error = "Cannot parse '" + fileName.generic_string() + "': " + errors;
+            return false;
+        }
+
+        return true;
+    }
+
+    // glTF URIs are percent-encoded
+    std::string DecodeUri(const std::string& uri)
+    {
+        std::string result;
+        for (size_t i = 0; i < uri.size(); i++)
+        {
+            if (uri[i] == '%' && i + 2 < uri.size() && isxdigit(uri[i + 1]) && isxdigit(uri[i + 2]))
+            {
+                result += char(std::stoi(uri.substr(i + 1, 2), nullptr, 16));
+                i += 2;
+            }
+            else
+            {
+                result += uri[i];
+            }
+        }
+        return result;
+    }
+}
+
+bool FindSceneModels(const std::filesystem::path& sceneFileName, std::vector<std::filesystem::path>& models, std::string& error)
+{
+    const std::string extension = sceneFileName.extension().generic_string();
+    if (extension == ".gltf" || extension == ".glb")
+    {
+        models.push_back(sceneFileName);
+        return true;
+    }
+
+    Json::Value root;
+    if (!ReadJsonFile(sceneFileName, root, error))
+        return false;
+
+    for (const Json::Value& model : root["models"])
+    {
+        if (model.isString())
+            models.push_back(sceneFileName.parent_path() / model.asString());
+    }
+
+    return true;
+}
+
+bool FindGltfImages(const std::filesystem::path& gltfFileName, std::vector<SceneImageReference>& images, uint64_t& bufferBytes, std::string& error)
+{
+    bufferBytes = 0;
+
+    // Binary glTF keeps its images in the embedded buffer, the scene graph loader decodes those
+    if (gltfFileName.extension() == ".glb")
+    {
+        std::error_code ec;
+        bufferBytes = std::filesystem::file_size(gltfFileName, ec);
+        return true;
+    }
+
+    Json::Value root;
+    if (!ReadJsonFile(gltfFileName, root, error))
+        return false;
+
+    for (const Json::Value& buffer : root["buffers"])
+        bufferBytes += buffer["byteLength"].asUInt64();
+
+    const Json::Value& textures = root["textures"];
+    const Json::Value& gltfImages = root["images"];
+    std::unordered_set<Json::ArrayIndex> added;
+
+    auto addTexture = [&](const Json::Value& textureInfo, bool sRGB)
+    {
+        if (!textureInfo.isObject() || !textureInfo["index"].isUInt())
+            return;
+
+        const Json::Value& texture = textures[textureInfo["index"].asUInt()];
+        const Json::Value& ddsSource = texture["extensions"]["MSFT_texture_dds"]["source"];
+        const Json::Value& source = ddsSource.isUInt() ? ddsSource : texture["source"];
+        if (!source.isUInt() || !added.insert(source.asUInt()).second)
+            return;
+
+        const std::string uri = gltfImages[source.asUInt()]["uri"].asString();
+        if (uri.empty() || uri.compare(0, 5, "data:") == 0)
+            return;
+
+        images.push_back({ gltfFileName.parent_path() / DecodeUri(uri), sRGB });
+    };
+
+    for (const Json::Value& material : root["materials"])
+    {
+        const Json::Value& pbr = material["pbrMetallicRoughness"];
+        const Json::Value& specularGlossiness = material["extensions"]["KHR_materials_pbrSpecularGlossiness"];
+        const Json::Value& transmission = material["extensions"]["KHR_materials_transmission"];
+
+        addTexture(pbr["baseColorTexture"], true);
+        addTexture(pbr["metallicRoughnessTexture"], false);
+        addTexture(specularGlossiness["diffuseTexture"], true);
+        addTexture(specularGlossiness["specularGlossinessTexture"], true);
+        addTexture(material["normalTexture"], false);
+        addTexture(material["occlusionTexture"], false);
+        addTexture(material["emissiveTexture"], true);
+        addTexture(transmission["transmissionTexture"], false);
+    }
+
+    return true;
+}
+
+ParallelSceneLoader::ParallelSceneLoader(ThreadPool& pool, std::shared_ptr<engine::TextureCache> textureCache)
+    : m_TextureCache(std::move(textureCache))
+    , m_Graph(std::make_unique<TaskGraph>(pool))
+{
+}
+
+bool ParallelSceneLoader::Load(const std::filesystem::path& sceneFileName, const std::function<bool()>& loadSceneGraph)
+{
+    std::vector<std::filesystem::path> models;
+    std::string error;
+    if (!FindSceneModels(sceneFileName, models, error))
+        log::warning("%s", error.c_str());
+
+    struct Shared
+    {
+        std::atomic<uint32_t> remainingModels{ 0 };
+        std::atomic<uint64_t> bufferBytes{ 0 };
+        std::atomic<bool> sceneGraphLoaded{ false };
+        std::mutex imagesMutex;
+        std::unordered_set<std::string> images;
+        std::vector<TaskGraph::TaskId> decodeTasks;
+    };
+    auto shared = std::make_shared<Shared>();
+    shared->remainingModels = uint32_t(models.size());
+
+    // Weights are in MB of file data, so progress follows the bytes to parse and decode
+    auto addSceneGraphTask = [this, shared, &loadSceneGraph]()
+    {
+        std::vector<TaskGraph::TaskId> decodeTasks;
+        {
+            std::lock_guard<std::mutex> lock(shared->imagesMutex);
+            decodeTasks = shared->decodeTasks;
+        }
+
+        m_Graph->AddTask("scene graph", [shared, &loadSceneGraph]()
+        {
+            shared->sceneGraphLoaded = loadSceneGraph ? loadSceneGraph() : true;
+        }, decodeTasks, double(shared->bufferBytes) / (1 << 20) + 1.0);
+    };
+
+    if (models.empty())
+        addSceneGraphTask();
+
+    for (const std::filesystem::path& model : models)
+    {
+        m_Graph->AddTask("parse " + model.filename().generic_string(), [this, shared, model, addSceneGraphTask]()
+        {
+            std::vector<SceneImageReference> images;
+            uint64_t bufferBytes = 0;
+            std::string error;
+            if (!FindGltfImages(model, images, bufferBytes, error))
+                log::warning("%s", error.c_str());
+
+            shared->bufferBytes += bufferBytes;
+
+            for (const SceneImageReference& image : images)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(shared->imagesMutex);
+                    if (!shared->images.insert(image.path.generic_string()).second)
+                        continue;
+                }
+
+                std::error_code ec;
+                const uint64_t fileSize = std::filesystem::file_size(image.path, ec);
+                m_ImageCount++;
+                m_ImageBytes += ec ? 0 : fileSize;
+
+                const TaskGraph::TaskId decodeTask = m_Graph->AddTask("decode " + image.path.filename().generic_string(), [this, image]()
+                {
+                    m_TextureCache->LoadTextureFromFileDeferred(image.path, image.sRGB);
+                }, {}, double(ec ? 0 : fileSize) / (1 << 20) + 0.01);
+
+                std::lock_guard<std::mutex> lock(shared->imagesMutex);
+                shared->decodeTasks.push_back(decodeTask);
+            }
+
+            // The last parsed model queues the scene graph behind the decodes of every model
+            if (--shared->remainingModels == 0)
+                addSceneGraphTask();
+        }, {}, 0.01);
+    }
+
+    m_Graph->Wait();
+
+    return shared->sceneGraphLoaded;
+}
+
+float ParallelSceneLoader::GetProgress() const
+{
+    return m_Graph->GetProgress();
+}
+
+void RunSceneLoadBenchmark(const std::filesystem::path& sceneFileName, const std::vector<uint32_t>& threadCounts)
+{
+    auto nativeFS = std::make_shared<vfs::NativeFileSystem>();
+
+    for (uint32_t threadCount : threadCounts)
+    {
+        // No device: only the CPU decoders of the cache are used
+        auto textureCache = std::make_shared<engine::TextureCache>(nullptr, nativeFS, nullptr);
+        ThreadPool pool(threadCount);
+
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        ParallelSceneLoader loader(pool, textureCache);
+        loader.Load(sceneFileName, {});
+
+        const auto decoded = std::chrono::high_resolution_clock::now();
+
+        std::vector<SceneImageReference> images;
+        std::vector<std::filesystem::path> models;
+        std::string error;
+        FindSceneModels(sceneFileName, models, error);
+        for (const std::filesystem::path& model : models)
+        {
+            uint64_t bufferBytes = 0;
+            FindGltfImages(model, images, bufferBytes, error);
+        }
+
+        std::atomic<uint32_t> mipImages{ 0 };
+        pool.ParallelFor(uint32_t(images.size()), [&](uint32_t i)
+        {
+            CpuImage image;
+            std::vector<CpuImage> mips;
+            if (DecodeImageFile(*textureCache, images[i].path, images[i].sRGB, image))
+            {
+                GenerateMipChain(image, mips);
+                mipImages++;
+            }
+        });
+
+        const auto end = std::chrono::high_resolution_clock::now();
+
+        log::info("Scene load benchmark, %d threads: decode %.1f ms (%d images, %.1f MB), CPU mips %.1f ms (%d images)",
+            int(pool.GetThreadCount()),
+            std::chrono::duration<double, std::milli>(decoded - start).count(),
+            int(loader.GetImageCount()),
+            double(loader.GetImageBytes()) / (1 << 20),
+            std::chrono::duration<double, std::milli>(end - decoded).count(),
+            int(mipImages));
+    }
+}
+
+std::shared_ptr<engine::SceneGraph> LoadSceneGraphWithoutDevice(const std::filesystem::path& sceneFileName,
+    engine::TextureCache& textureCache, std::string& error)
+{
+    std::vector<std::filesystem::path> models;
+    if (!FindSceneModels(sceneFileName, models, error))
+        return nullptr;
+
+    Json::Value graphNodes;
+    if (sceneFileName.extension() == ".json")
+    {
+        Json::Value root;
+        if (!ReadJsonFile(sceneFileName, root, error))
+            return nullptr;
+        graphNodes = root["graph"];
+    }
+
+    auto nativeFS = std::make_shared<vfs::NativeFileSystem>();
+    engine::GltfImporter importer(nativeFS, std::make_shared<engine::SceneTypeFactory>());
+
+    std::vector<std::shared_ptr<engine::SceneGraphNode>> modelRoots;
+    for (const std::filesystem::path& model : models)
+    {
+        engine::SceneLoadingStats stats;
+        engine::SceneImportResult result;
+        if (!importer.Load(model, textureCache, stats, nullptr, result) || !result.rootNode)
+        {
+            error = "Cannot load '" + model.generic_string() + "'";
+            return nullptr;
+        }
+        modelRoots.push_back(result.rootNode);
+    }
+
+    auto graph = std::make_shared<engine::SceneGraph>();
+    auto root = std::make_shared<engine::SceneGraphNode>();
+    graph->SetRootNode(root);
+
+    // Without a graph, e.g. for a single glTF file, every model is placed once at the origin
+    if (!graphNodes.isArray() || graphNodes.empty())
+    {
+        for (const auto& modelRoot : modelRoots)
+            graph->Attach(root, modelRoot);
+    }
+
+    for (const Json::Value& source : graphNodes)
+    {
+        auto node = std::make_shared<engine::SceneGraphNode>();
+        node->SetName(source["name"].asString());
+        node->SetTranslation(json::Read<dm::double3>(source["translation"], dm::double3::zero()));
+        node->SetRotation(json::Read<dm::dquat>(source["rotation"], dm::dquat::identity()));
+
+        const Json::Value& scaling = source["scaling"];
+        node->SetScaling(scaling.isNumeric() ? dm::double3(scaling.asDouble()) : json::Read<dm::double3>(scaling, dm::double3(1.0)));
+
+        graph->Attach(root, node);
+
+        // Models used by several nodes are copied by Attach
+        const Json::Value& model = source["model"];
+        if (model.isUInt() && model.asUInt() < modelRoots.size())
+            graph->Attach(node, modelRoots[model.asUInt()]);
+    }
+
+    graph->Refresh(0);
+    return graph;
+}
@@ -0,0 +1,78 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "TaskGraph.h"
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace donut::engine
+{
+    class SceneGraph;
+    class TextureCache;
+}
+
+struct SceneImageReference
+{
+    std::filesystem::path path;
+    bool sRGB = false;
+};
+
+// Model files listed under "models" in a donut .scene.json, resolved relative to the scene file
+bool FindSceneModels(const std::filesystem::path& sceneFileName, std::vector<std::filesystem::path>& models, std::string& error);
+
+// Images used by the materials of a .gltf file, in the color space the donut glTF importer requests them in,
+// preferring MSFT_texture_dds sources like the importer does. Also returns the total size of the glTF buffers.
+bool FindGltfImages(const std::filesystem::path& gltfFileName, std::vector<SceneImageReference>& images, uint64_t& bufferBytes, std::string& error);
+
+// CPU side of scene loading as a task graph on a thread pool:
+//
+//   parse model 0 ... parse model N      (glTF json: images and buffer sizes)
+//     |-> decode image 0 ... decode image M   (file read + decode into the TextureCache, in parallel)
+//     '-> scene graph                          (Scene::Load, finds every image already in the cache)
+//
+// Uploads and GPU mip generation stay on the render thread, where TextureCache::ProcessRenderingThreadCommands
+// finalizes decoded textures in time-bounded batches each frame.
+class ParallelSceneLoader
+{
+public:
+    ParallelSceneLoader(ThreadPool& pool, std::shared_ptr<donut::engine::TextureCache> textureCache);
+
+    // Blocks until everything is decoded and loadSceneGraph returned. loadSceneGraph may be empty.
+    bool Load(const std::filesystem::path& sceneFileName, const std::function<bool()>& loadSceneGraph);
+
+    // Thread safe, 0..1 by decoded bytes
+    [[nodiscard]] float GetProgress() const;
+
+    [[nodiscard]] uint32_t GetImageCount() const { return m_ImageCount; }
+    [[nodiscard]] uint64_t GetImageBytes() const { return m_ImageBytes; }
+
+private:
+    std::shared_ptr<donut::engine::TextureCache> m_TextureCache;
+    std::unique_ptr<TaskGraph> m_Graph;
+
+    std::atomic<uint32_t> m_ImageCount{ 0 };
+    std::atomic<uint64_t> m_ImageBytes{ 0 };
+};
+
+// Headless CPU benchmark of the decode and mip stages over every image of a scene, for each thread count
+void RunSceneLoadBenchmark(const std::filesystem::path& sceneFileName, const std::vector<uint32_t>& threadCounts);
+
+// Scene graph of a .scene.json or glTF file without a device, for CPU rendering. The models are read by the glTF
+// importer and placed by the top level "graph" nodes of the scene file; nested nodes, lights and animations are
+// not read. Meshes only have their CPU buffers, textures are decoded into the cache but never created.
+std::shared_ptr<donut::engine::SceneGraph> LoadSceneGraphWithoutDevice(const std::filesystem::path& sceneFileName,
+    donut::engine::TextureCache& textureCache, std::string& error);
@@ -0,0 +1,403 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "ShaderBlobCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const char c_Magic[4] = { 'S', 'T', 'F', 'B' };
+    const uint32_t c_Version = 1;
+    const uint64_t c_BlobAlignment = 16;
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t reserved;
+        uint64_t indexOffset;
+    };
+    static_assert(sizeof(Header) == 24, "Header layout is part of the file format");
+
+    struct IndexEntry
+    {
+        uint64_t keyHash;
+        uint64_t offset;        // key bytes, then blob (aligned), then reflection
+        uint32_t keySize;
+        uint32_t blobSize;
+        uint32_t reflectionSize;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(IndexEntry) == 32, "IndexEntry layout is part of the file format");
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    uint64_t HashKey(const std::string& key)
+    {
+        return HashFnv1a64(key.data(), key.size());
+    }
+}
+
+std::string MakeShaderBlobKey(uint64_t containerDigest, const std::string& target, const PermutationKey& permutation)
+{
+    char digest[17];
+    snprintf(digest, sizeof(digest), "%016llx", (unsigned long long)containerDigest);
+    return std::string(digest) + " " + target + " " + permutation.ToString();
+}
+
+ShaderBlobCache::ShaderBlobCache(std::filesystem::path fileName)
+    : m_FileName(std::move(fileName))
+{
+}
+
+ShaderBlobCache::~ShaderBlobCache()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    UnmapLocked();
+}
+
+void ShaderBlobCache::MapLocked()
+{
+    if (m_MappingAttempted)
+        return;
+
+    m_MappingAttempted = true;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(m_FileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < LONGLONG(sizeof(Header)))
+    {
+        CloseHandle(file);
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return;
+    }
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return;
+    }
+
+    m_FileHandle = file;
+    m_MappingHandle = mapping;
+    m_Mapping = static_cast<const uint8_t*>(view);
+    m_MappingSize = size_t(fileSize.QuadPart);
+#else
+    int fd = open(m_FileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || size_t(fileStat.st_size) < sizeof(Header))
+    {
+        close(fd);
+        return;
+    }
+
+    void* view = mmap(nullptr, size_t(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file alive
+
+    if (view == MAP_FAILED)
+        return;
+
+    m_Mapping = static_cast<const uint8_t*>(view);
+    m_MappingSize = size_t(fileStat.st_size);
+#endif
+
+    // Validate the header and index bounds once, entries are bounds checked on lookup
+    Header header;
+    memcpy(&header, m_Mapping, sizeof(header));
+
+    const bool valid = memcmp(header.magic, c_Magic, sizeof(c_Magic)) == 0 &&
+        header.version == c_Version &&
+        header.indexOffset <= m_MappingSize &&
+        uint64_t(header.entryCount) * sizeof(IndexEntry) <= m_MappingSize - header.indexOffset &&
+        header.indexOffset % alignof(IndexEntry) == 0;
+
+    if (!valid)
+    {
+        UnmapLocked();
+        m_MappingAttempted = true;
+        return;
+    }
+
+    m_Stats.entries = header.entryCount;
+    m_Stats.mappedBytes = m_MappingSize;
+}
+
+void ShaderBlobCache::UnmapLocked()
+{
+#ifdef _WIN32
+    if (m_Mapping)
+        UnmapViewOfFile(m_Mapping);
+    if (m_MappingHandle)
+        CloseHandle(m_MappingHandle);
+    if (m_FileHandle)
+        CloseHandle(m_FileHandle);
+    m_MappingHandle = nullptr;
+    m_FileHandle = nullptr;
+#else
+    if (m_Mapping)
+        munmap(const_cast<uint8_t*>(m_Mapping), m_MappingSize);
+#endif
+
+    m_Mapping = nullptr;
+    m_MappingSize = 0;
+    m_MappingAttempted = false;
+    m_Stats.entries = 0;
+    m_Stats.mappedBytes = 0;
+}
+
+ShaderBlobView ShaderBlobCache::FindMappedLocked(const std::string& key) const
+{
+    if (!m_Mapping)
+        return ShaderBlobView();
+
+    Header header;
+    memcpy(&header, m_Mapping, sizeof(header));
+
+    const IndexEntry* begin = reinterpret_cast<const IndexEntry*>(m_Mapping + header.indexOffset);
+    const IndexEntry* end = begin + header.entryCount;
+    const uint64_t keyHash = HashKey(key);
+
+    const IndexEntry* first = std::lower_bound(begin, end, keyHash,
+        [](const IndexEntry& entry, uint64_t hash) { return entry.keyHash < hash; });
+
+    for (const IndexEntry* entry = first; entry != end && entry->keyHash == keyHash; ++entry)
+    {
+        const uint64_t blobOffset = AlignUp(entry->offset + entry->keySize, c_BlobAlignment);
+        const uint64_t entryEnd = blobOffset + entry->blobSize + entry->reflectionSize;
+        if (entryEnd > header.indexOffset)
+            continue; // corrupt entry
+
+        if (entry->keySize != key.size() || memcmp(m_Mapping + entry->offset, key.data(), key.size()) != 0)
+            continue; // hash collision
+
+        ShaderBlobView view;
+        view.data = m_Mapping + blobOffset;
+        view.size = entry->blobSize;
+        view.reflection = entry->reflectionSize ? m_Mapping + blobOffset + entry->blobSize : nullptr;
+        view.reflectionSize = entry->reflectionSize;
+        return view;
+    }
+
+    return ShaderBlobView();
+}
+
+ShaderBlobView ShaderBlobCache::Find(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    auto pending = m_Pending.find(key);
+    if (pending != m_Pending.end())
+    {
+        m_Stats.hits++;
+
+        ShaderBlobView view;
+        view.data = pending->second.data.data();
+        view.size = pending->second.data.size();
+        view.reflection = pending->second.reflection.empty() ? nullptr : pending->second.reflection.data();
+        view.reflectionSize = pending->second.reflection.size();
+        return view;
+    }
+
+    MapLocked();
+
+    ShaderBlobView view = FindMappedLocked(key);
+    if (view)
+        m_Stats.hits++;
+    else
+        m_Stats.misses++;
+
+    return view;
+}
+
+void ShaderBlobCache::Store(const std::string& key, const void* data, size_t size, const void* reflection, size_t reflectionSize)
+{
+    PendingBlob blob;
+    blob.data.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+    if (reflection)
+        blob.reflection.assign(static_cast<const uint8_t*>(reflection), static_cast<const uint8_t*>(reflection) + reflectionSize);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Pending[key] = std::move(blob);
+    m_Stats.stored++;
+}
+
+bool ShaderBlobCache::Flush(std::string& error)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (m_Pending.empty())
+        return true;
+
+    MapLocked();
+
+    // Gather what is already on disk, pending blobs replace entries with the same key
+    struct Record
+    {
+        std::string key;
+        const uint8_t* data;
+        size_t size;
+        const uint8_t* reflection;
+        size_t reflectionSize;
+    };
+
+    std::vector<Record> records;
+    for (const auto& pending : m_Pending)
+    {
+        records.push_back({ pending.first, pending.second.data.data(), pending.second.data.size(),
+            pending.second.reflection.data(), pending.second.reflection.size() });
+    }
+
+    if (m_Mapping)
+    {
+        Header header;
+        memcpy(&header, m_Mapping, sizeof(header));
+        const IndexEntry* entries = reinterpret_cast<const IndexEntry*>(m_Mapping + header.indexOffset);
+
+        for (uint32_t i = 0; i < header.entryCount; i++)
+        {
+            const IndexEntry& entry = entries[i];
+            const uint64_t blobOffset = AlignUp(entry.offset + entry.keySize, c_BlobAlignment);
+            if (blobOffset + entry.blobSize + entry.reflectionSize > header.indexOffset)
+                continue;
+
+            std::string key(reinterpret_cast<const char*>(m_Mapping + entry.offset), entry.keySize);
+            if (m_Pending.count(key))
+                continue;
+
+            records.push_back({ std::move(key), m_Mapping + blobOffset, entry.blobSize,
+                m_Mapping + blobOffset + entry.blobSize, entry.reflectionSize });
+        }
+    }
+
+    std::sort(records.begin(), records.end(), [](const Record& a, const Record& b)
+    {
+        const uint64_t ha = HashKey(a.key);
+        const uint64_t hb = HashKey(b.key);
+        return ha != hb ? ha < hb : a.key < b.key;
+    });
+
+    const std::filesystem::path tempFileName = m_FileName.generic_string() + ".tmp";
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(m_FileName.parent_path(), ec);
+
+        std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            error = "Cannot write shader blob cache '" + tempFileName.generic_string() + "'";
+            return false;
+        }
+
+        const char zeros[c_BlobAlignment] = {};
+        uint64_t offset = sizeof(Header);
+        file.write(zeros, sizeof(Header)); // patched below
+
+        std::vector<IndexEntry> index;
+        for (const Record& record : records)
+        {
+            IndexEntry entry = {};
+            entry.keyHash = HashKey(record.key);
+            entry.offset = offset;
+            entry.keySize = uint32_t(record.key.size());
+            entry.blobSize = uint32_t(record.size);
+            entry.reflectionSize = uint32_t(record.reflectionSize);
+            index.push_back(entry);
+
+            file.write(record.key.data(), record.key.size());
+            offset += record.key.size();
+
+            const uint64_t blobOffset = AlignUp(offset, c_BlobAlignment);
+            file.write(zeros, std::streamsize(blobOffset - offset));
+            file.write(reinterpret_cast<const char*>(record.data), std::streamsize(record.size));
+            file.write(reinterpret_cast<const char*>(record.reflection), std::streamsize(record.reflectionSize));
+            offset = blobOffset + record.size + record.reflectionSize;
+        }
+
+        const uint64_t indexOffset = AlignUp(offset, alignof(IndexEntry));
+        file.write(zeros, std::streamsize(indexOffset - offset));
+        file.write(reinterpret_cast<const char*>(index.data()), std::streamsize(index.size() * sizeof(IndexEntry)));
+
+        Header header = {};
+        memcpy(header.magic, c_Magic, sizeof(c_Magic));
+        header.version = c_Version;
+        header.entryCount = uint32_t(index.size());
+        header.indexOffset = indexOffset;
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        if (!file.good())
+        {
+            error = "Failed writing shader blob cache '" + tempFileName.generic_string() + "'";
+            return false;
+        }
+    }
+
+    // Windows cannot replace a mapped file, elsewhere the mapping stays until the new file is in place
+#ifdef _WIN32
+    UnmapLocked();
+#endif
+
+    std::error_code ec;
+    std::filesystem::rename(tempFileName, m_FileName, ec);
+    if (ec)
+    {
+        error = "Cannot replace shader blob cache '" + m_FileName.generic_string() + "': " + ec.message();
+        std::filesystem::remove(tempFileName, ec);
+        return false;
+    }
+
+    // Records point into the mapping and the pending blobs, both are released only now
+    UnmapLocked();
+    m_Pending.clear();
+    return true;
+}
+
+ShaderBlobCacheStats ShaderBlobCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
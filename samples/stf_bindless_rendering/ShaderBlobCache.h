@@ -0,0 +1,94 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "ShaderPermutationCache.h"
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Content-addressed key of one compiled permutation: the digest of the ShaderMake container it is read from, so that
+// recompiling the shaders changes every key built on the container, the target and its macros
+std::string MakeShaderBlobKey(uint64_t containerDigest, const std::string& target, const PermutationKey& permutation);
+
+struct ShaderBlobView
+{
+    const void* data = nullptr;
+    size_t size = 0;
+    const void* reflection = nullptr;
+    size_t reflectionSize = 0;
+
+    explicit operator bool() const { return data != nullptr; }
+};
+
+struct ShaderBlobCacheStats
+{
+    uint32_t entries = 0;
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t stored = 0;
+    uint64_t mappedBytes = 0;
+};
+
+// Pack file of compiled shader blobs. The index is sorted by key hash and stays inside the memory mapping, so a
+// lookup only touches the pages of the index it searches and of the blob it returns. The file is mapped on the
+// first lookup; new blobs are kept in memory and merged into the file by Flush().
+//
+// Layout: Header | (key, blob, reflection)* | IndexEntry[entryCount]
+class ShaderBlobCache
+{
+public:
+    explicit ShaderBlobCache(std::filesystem::path fileName);
+    ~ShaderBlobCache();
+
+    ShaderBlobCache(const ShaderBlobCache&) = delete;
+    ShaderBlobCache& operator=(const ShaderBlobCache&) = delete;
+
+    // Thread safe. The returned view stays valid until Flush() or destruction.
+    ShaderBlobView Find(const std::string& key);
+
+    // Thread safe. Data is copied.
+    void Store(const std::string& key, const void* data, size_t size, const void* reflection, size_t reflectionSize);
+
+    // Writes the merged pack to a temporary file and renames it over the old one. Pending blobs are only dropped
+    // once the rename succeeded, a failed flush keeps them for the next one.
+    bool Flush(std::string& error);
+
+    [[nodiscard]] ShaderBlobCacheStats GetStats() const;
+    [[nodiscard]] const std::filesystem::path& GetFileName() const { return m_FileName; }
+
+private:
+    struct PendingBlob
+    {
+        std::vector<uint8_t> data;
+        std::vector<uint8_t> reflection;
+    };
+
+    std::filesystem::path m_FileName;
+
+    mutable std::mutex m_Mutex;
+    bool m_MappingAttempted = false;
+    const uint8_t* m_Mapping = nullptr;
+    size_t m_MappingSize = 0;
+#ifdef _WIN32
+    void* m_FileHandle = nullptr;
+    void* m_MappingHandle = nullptr;
+#endif
+    std::unordered_map<std::string, PendingBlob> m_Pending;
+    ShaderBlobCacheStats m_Stats;
+
+    void MapLocked();
+    void UnmapLocked();
+    ShaderBlobView FindMappedLocked(const std::string& key) const;
+};
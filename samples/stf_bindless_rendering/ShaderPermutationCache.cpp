@@ -0,0 +1,449 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "ShaderPermutationCache.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <sstream>
+
+ShaderMacroSet::ShaderMacroSet(std::initializer_list<std::pair<std::string, std::string>> macros)
+{
+    for (const auto& macro : macros)
+        Set(macro.first, macro.second);
+}
+
+void ShaderMacroSet::Set(const std::string& name, const std::string& value)
+{
+    auto it = std::lower_bound(m_Macros.begin(), m_Macros.end(), name,
+        [](const std::pair<std::string, std::string>& macro, const std::string& n) { return macro.first < n; });
+
+    if (it != m_Macros.end() && it->first == name)
+        it->second = value;
+    else
+        m_Macros.insert(it, { name, value });
+}
+
+const std::string* ShaderMacroSet::Find(const std::string& name) const
+{
+    auto it = std::lower_bound(m_Macros.begin(), m_Macros.end(), name,
+        [](const std::pair<std::string, std::string>& macro, const std::string& n) { return macro.first < n; });
+
+    if (it != m_Macros.end() && it->first == name)
+        return &it->second;
+
+    return nullptr;
+}
+
+std::string PermutationKey::ToString() const
+{
+    std::string result;
+    switch (kind)
+    {
+    case PermutationKind::Shader: result = "shader:"; break;
+    case PermutationKind::ShaderLibrary: result = "library:"; break;
+    case PermutationKind::Pipeline: result = "pipeline:"; break;
+    }
+
+    result += name;
+    if (!entry.empty())
+        result += ":" + entry;
+
+    for (const auto& macro : macros.Get())
+        result += " " + macro.first + "=" + macro.second;
+
+    if (!dependencies.empty())
+    {
+        result += " [";
+        for (size_t i = 0; i < dependencies.size(); i++)
+            result += (i ? " | " : "") + dependencies[i].ToString();
+        result += "]";
+    }
+
+    return result;
+}
+
+uint64_t HashFnv1a64(const void* data, size_t size, uint64_t seed)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+uint64_t PermutationKey::Hash() const
+{
+    const std::string id = ToString();
+    return HashFnv1a64(id.data(), id.size());
+}
+
+PermutationCache::PermutationCache(std::shared_ptr<IPermutationBuilder> builder, uint32_t threadCount)
+    : m_Builder(std::move(builder))
+{
+    threadCount = std::max(threadCount, 1u);
+    for (uint32_t i = 0; i < threadCount; i++)
+        m_Workers.emplace_back(&PermutationCache::WorkerThread, this);
+}
+
+PermutationCache::~PermutationCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_WorkAvailable.notify_all();
+
+    for (std::thread& worker : m_Workers)
+        worker.join();
+}
+
+void PermutationCache::EnqueueLocked(Entry& entry)
+{
+    entry.status = PermutationStatus::Queued;
+    m_Queue.push(QueueItem{ entry.priority, m_Sequence++, entry.key.ToString() });
+    m_Stats.queued++;
+    m_WorkAvailable.notify_one();
+}
+
+PermutationCache::Entry& PermutationCache::ScheduleLocked(const PermutationKey& key, PermutationPriority priority)
+{
+    const std::string id = key.ToString();
+    Entry& entry = m_Entries[id];
+
+    if (entry.status == PermutationStatus::Missing)
+    {
+        entry.key = key;
+        entry.priority = priority;
+
+        for (const PermutationKey& dependencyKey : key.dependencies)
+        {
+            Entry& dependency = ScheduleLocked(dependencyKey, priority);
+
+            if (dependency.status == PermutationStatus::Failed)
+            {
+                entry.status = PermutationStatus::Failed;
+                m_Stats.failed++;
+                return entry;
+            }
+
+            if (dependency.status != PermutationStatus::Ready)
+            {
+                dependency.dependents.push_back(id);
+                entry.pendingDependencies++;
+            }
+        }
+
+        if (entry.pendingDependencies == 0)
+            EnqueueLocked(entry);
+        else
+            entry.status = PermutationStatus::WaitingForDependencies;
+    }
+    else if (priority > entry.priority)
+    {
+        entry.priority = priority;
+
+        // Bump what this permutation is waiting for as well
+        for (const PermutationKey& dependencyKey : key.dependencies)
+            ScheduleLocked(dependencyKey, priority);
+
+        // Stale queue items are skipped by the workers, pushing a second one is cheaper than re-heaping
+        if (entry.status == PermutationStatus::Queued)
+            m_Queue.push(QueueItem{ entry.priority, m_Sequence++, id });
+    }
+
+    return entry;
+}
+
+std::shared_ptr<PermutationArtifact> PermutationCache::Request(const PermutationKey& key, PermutationPriority priority)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    Entry& entry = ScheduleLocked(key, priority);
+    if (entry.status == PermutationStatus::Ready)
+    {
+        m_Stats.hits++;
+        return entry.artifact;
+    }
+
+    m_Stats.misses++;
+    return nullptr;
+}
+
+std::shared_ptr<PermutationArtifact> PermutationCache::Wait(const PermutationKey& key)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    const std::string id = key.ToString();
+    ScheduleLocked(key, PermutationPriority::Requested);
+
+    m_EntryFinished.wait(lock, [&]()
+    {
+        auto it = m_Entries.find(id);
+        // Missing means the cache was invalidated while waiting, schedule again
+        if (it == m_Entries.end())
+            ScheduleLocked(key, PermutationPriority::Requested);
+        else if (it->second.status == PermutationStatus::Ready || it->second.status == PermutationStatus::Failed)
+            return true;
+        return false;
+    });
+
+    return m_Entries[id].artifact;
+}
+
+void PermutationCache::Prewarm(const std::vector<PermutationKey>& keys, PermutationPriority priority)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    for (const PermutationKey& key : keys)
+        ScheduleLocked(key, priority);
+}
+
+PermutationStatus PermutationCache::GetStatus(const PermutationKey& key) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    auto it = m_Entries.find(key.ToString());
+    return it == m_Entries.end() ? PermutationStatus::Missing : it->second.status;
+}
+
+PermutationCacheStats PermutationCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void PermutationCache::Invalidate()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Generation++;
+    m_Entries.clear();
+    m_Queue = std::priority_queue<QueueItem>();
+    m_EntryFinished.notify_all();
+}
+
+void PermutationCache::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    m_EntryFinished.wait(lock, [&]()
+    {
+        if (m_Building != 0)
+            return false;
+
+        for (const auto& it : m_Entries)
+        {
+            if (it.second.status == PermutationStatus::Queued || it.second.status == PermutationStatus::WaitingForDependencies)
+                return false;
+        }
+        return true;
+    });
+}
+
+void PermutationCache::FinishLocked(const std::string& id, std::shared_ptr<PermutationArtifact> artifact)
+{
+    Entry& entry = m_Entries[id];
+    entry.artifact = std::move(artifact);
+    entry.status = entry.artifact ? PermutationStatus::Ready : PermutationStatus::Failed;
+
+    if (entry.artifact)
+        m_Stats.built++;
+    else
+        m_Stats.failed++;
+
+    const bool succeeded = entry.status == PermutationStatus::Ready;
+    const std::vector<std::string> dependents = std::move(entry.dependents);
+    entry.dependents.clear();
+
+    for (const std::string& dependentId : dependents)
+    {
+        auto it = m_Entries.find(dependentId);
+        if (it == m_Entries.end() || it->second.status != PermutationStatus::WaitingForDependencies)
+            continue;
+
+        Entry& dependent = it->second;
+        if (!succeeded)
+        {
+            FinishLocked(dependentId, nullptr);
+            continue;
+        }
+
+        assert(dependent.pendingDependencies > 0);
+        if (--dependent.pendingDependencies == 0)
+            EnqueueLocked(dependent);
+    }
+}
+
+void PermutationCache::WorkerThread()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    while (true)
+    {
+        m_WorkAvailable.wait(lock, [&]() { return m_Stopping || !m_Queue.empty(); });
+
+        if (m_Stopping)
+            return;
+
+        const QueueItem item = m_Queue.top();
+        m_Queue.pop();
+
+        auto it = m_Entries.find(item.id);
+        if (it == m_Entries.end() || it->second.status != PermutationStatus::Queued)
+            continue; // stale item: already picked up at another priority, or invalidated
+
+        Entry& entry = it->second;
+        entry.status = PermutationStatus::Building;
+
+        const PermutationKey key = entry.key;
+        std::vector<std::shared_ptr<PermutationArtifact>> dependencies;
+        for (const PermutationKey& dependencyKey : key.dependencies)
+            dependencies.push_back(m_Entries[dependencyKey.ToString()].artifact);
+
+        const uint64_t generation = m_Generation;
+        m_Building++;
+        lock.unlock();
+
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        std::shared_ptr<PermutationArtifact> artifact;
+        if (m_Builder->IsThreadSafe())
+        {
+            artifact = m_Builder->Build(key, dependencies);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> builderLock(m_BuilderMutex);
+            artifact = m_Builder->Build(key, dependencies);
+        }
+
+        const auto end = std::chrono::high_resolution_clock::now();
+
+        lock.lock();
+        m_Building--;
+        m_Stats.buildMilliseconds += std::chrono::duration<double, std::milli>(end - start).count();
+
+        if (generation == m_Generation)
+            FinishLocked(item.id, std::move(artifact));
+
+        m_EntryFinished.notify_all();
+    }
+}
+
+// Expands "STF_LOAD={0,1}" into "STF_LOAD=0", "STF_LOAD=1"
+static std::vector<std::string> ExpandAlternatives(const std::string& token)
+{
+    const size_t open = token.find('{');
+    if (open == std::string::npos)
+        return { token };
+
+    const size_t close = token.find('}', open);
+    if (close == std::string::npos)
+        return {};
+
+    const std::string prefix = token.substr(0, open);
+    const std::string suffixes = token.substr(close + 1);
+
+    std::vector<std::string> result;
+    std::stringstream alternatives(token.substr(open + 1, close - open - 1));
+    std::string alternative;
+    while (std::getline(alternatives, alternative, ','))
+    {
+        for (const std::string& suffix : ExpandAlternatives(suffixes))
+            result.push_back(prefix + alternative + suffix);
+    }
+
+    return result;
+}
+
+bool ParseShaderConfig(const std::string& text, std::vector<ShaderConfigPermutation>& permutations, std::string& error)
+{
+    std::stringstream lines(text);
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(lines, line))
+    {
+        lineNumber++;
+
+        const size_t comment = std::min(line.find('#'), line.find("//"));
+        if (comment != std::string::npos)
+            line.resize(comment);
+
+        std::vector<std::vector<std::string>> tokens;
+        std::stringstream words(line);
+        std::string word;
+        while (words >> word)
+        {
+            std::vector<std::string> alternatives = ExpandAlternatives(word);
+            if (alternatives.empty())
+            {
+                error = "shaders.cfg(" + std::to_string(lineNumber) + "): unterminated '{' in '" + word + "'";
+                return false;
+            }
+            tokens.push_back(std::move(alternatives));
+        }
+
+        if (tokens.empty())
+            continue;
+
+        // Walk the cartesian product of all alternatives on this line
+        std::vector<size_t> choice(tokens.size(), 0);
+        while (true)
+        {
+            ShaderConfigPermutation permutation;
+            permutation.file = tokens[0][choice[0]];
+            permutation.entry = "main";
+
+            for (size_t i = 1; i < tokens.size(); i++)
+            {
+                const std::string& option = tokens[i][choice[i]];
+                const bool hasValue = i + 1 < tokens.size();
+
+                if (option == "-T" && hasValue)
+                    permutation.target = tokens[i + 1][choice[i + 1]], i++;
+                else if (option == "-E" && hasValue)
+                    permutation.entry = tokens[i + 1][choice[i + 1]], i++;
+                else if (option == "-D" && hasValue)
+                {
+                    const std::string& define = tokens[i + 1][choice[i + 1]];
+                    const size_t equals = define.find('=');
+                    if (equals == std::string::npos)
+                        permutation.macros.Set(define, "1");
+                    else
+                        permutation.macros.Set(define.substr(0, equals), define.substr(equals + 1));
+                    i++;
+                }
+            }
+
+            if (permutation.target.empty())
+            {
+                error = "shaders.cfg(" + std::to_string(lineNumber) + "): missing -T";
+                return false;
+            }
+
+            permutations.push_back(std::move(permutation));
+
+            size_t digit = 0;
+            while (digit < tokens.size() && ++choice[digit] == tokens[digit].size())
+                choice[digit++] = 0;
+
+            if (digit == tokens.size())
+                break;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,190 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// FNV-1a, pass the previous result as seed to hash several ranges
+uint64_t HashFnv1a64(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+
+// Sorted NAME=VALUE pairs, so that the same macro set always produces the same key
+class ShaderMacroSet
+{
+public:
+    ShaderMacroSet() = default;
+    ShaderMacroSet(std::initializer_list<std::pair<std::string, std::string>> macros);
+
+    void Set(const std::string& name, const std::string& value);
+    [[nodiscard]] const std::string* Find(const std::string& name) const;
+    [[nodiscard]] const std::vector<std::pair<std::string, std::string>>& Get() const { return m_Macros; }
+
+    bool operator==(const ShaderMacroSet& other) const { return m_Macros == other.m_Macros; }
+
+private:
+    std::vector<std::pair<std::string, std::string>> m_Macros;
+};
+
+enum class PermutationKind : uint32_t
+{
+    Shader,
+    ShaderLibrary,
+    Pipeline,
+};
+
+// Identifies one permutation: a shader (file + entry + macros) or a pipeline built from other permutations
+struct PermutationKey
+{
+    PermutationKind kind = PermutationKind::Shader;
+    std::string name;       // shader file, or pipeline name
+    std::string entry;      // entry point / shader stage, empty for libraries and pipelines
+    ShaderMacroSet macros;
+    std::vector<PermutationKey> dependencies;
+
+    [[nodiscard]] std::string ToString() const;
+    [[nodiscard]] uint64_t Hash() const;
+};
+
+struct PermutationArtifact
+{
+    virtual ~PermutationArtifact() = default;
+};
+
+// Does the actual compile / pipeline creation. Called on worker threads, one call at a time unless IsThreadSafe().
+class IPermutationBuilder
+{
+public:
+    virtual ~IPermutationBuilder() = default;
+
+    virtual std::shared_ptr<PermutationArtifact> Build(
+        const PermutationKey& key,
+        const std::vector<std::shared_ptr<PermutationArtifact>>& dependencies) = 0;
+
+    virtual bool IsThreadSafe() const { return false; }
+};
+
+enum class PermutationPriority : uint32_t
+{
+    Prewarm,
+    Neighbour,  // one settings change away from what is on screen
+    Requested,  // wanted on screen right now
+};
+
+enum class PermutationStatus
+{
+    Missing,
+    WaitingForDependencies,
+    Queued,
+    Building,
+    Ready,
+    Failed,
+};
+
+struct PermutationCacheStats
+{
+    uint32_t built = 0;
+    uint32_t failed = 0;
+    uint32_t hits = 0;      // Request() returned a ready artifact
+    uint32_t misses = 0;    // Request() had to wait for a build
+    uint32_t queued = 0;
+    double buildMilliseconds = 0.0;
+};
+
+// Builds permutations on background threads. The render thread asks for the permutation it wants with
+// Request() and keeps using whatever it had until the result is ready, so setting changes never block.
+class PermutationCache
+{
+public:
+    PermutationCache(std::shared_ptr<IPermutationBuilder> builder, uint32_t threadCount);
+    ~PermutationCache();
+
+    // Non-blocking: returns the artifact if ready, otherwise schedules it (and its dependencies) and returns nullptr
+    std::shared_ptr<PermutationArtifact> Request(const PermutationKey& key, PermutationPriority priority = PermutationPriority::Requested);
+
+    // Blocking variant, used at startup when there is nothing else to show
+    std::shared_ptr<PermutationArtifact> Wait(const PermutationKey& key);
+
+    void Prewarm(const std::vector<PermutationKey>& keys, PermutationPriority priority = PermutationPriority::Prewarm);
+
+    [[nodiscard]] PermutationStatus GetStatus(const PermutationKey& key) const;
+    [[nodiscard]] PermutationCacheStats GetStats() const;
+
+    // Drops every artifact, e.g. after shaders were recompiled. Builds in flight are discarded when they finish.
+    void Invalidate();
+
+    // Blocks until nothing is queued or building
+    void WaitIdle();
+
+private:
+    struct Entry
+    {
+        PermutationKey key;
+        PermutationStatus status = PermutationStatus::Missing;
+        PermutationPriority priority = PermutationPriority::Prewarm;
+        uint32_t pendingDependencies = 0;
+        std::vector<std::string> dependents;
+        std::shared_ptr<PermutationArtifact> artifact;
+    };
+
+    struct QueueItem
+    {
+        PermutationPriority priority;
+        uint64_t sequence;  // FIFO within one priority
+        std::string id;
+
+        bool operator<(const QueueItem& other) const
+        {
+            if (priority != other.priority)
+                return priority < other.priority;
+            return sequence > other.sequence;
+        }
+    };
+
+    std::shared_ptr<IPermutationBuilder> m_Builder;
+    std::mutex m_BuilderMutex;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_WorkAvailable;
+    std::condition_variable m_EntryFinished;
+    std::unordered_map<std::string, Entry> m_Entries;
+    std::priority_queue<QueueItem> m_Queue;
+    uint64_t m_Sequence = 0;
+    uint64_t m_Generation = 0;
+    uint32_t m_Building = 0;
+    bool m_Stopping = false;
+    PermutationCacheStats m_Stats;
+
+    std::vector<std::thread> m_Workers;
+
+    Entry& ScheduleLocked(const PermutationKey& key, PermutationPriority priority);
+    void EnqueueLocked(Entry& entry);
+    void FinishLocked(const std::string& id, std::shared_ptr<PermutationArtifact> artifact);
+    void WorkerThread();
+};
+
+// One line of a ShaderMake config (shaders.cfg) with all {a,b} alternatives expanded
+struct ShaderConfigPermutation
+{
+    std::string file;
+    std::string target;     // -T
+    std::string entry;      // -E, "main" when not given
+    ShaderMacroSet macros;  // -D
+};
+
+bool ParseShaderConfig(const std::string& text, std::vector<ShaderConfigPermutation>& permutations, std::string& error);
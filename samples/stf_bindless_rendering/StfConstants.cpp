@@ -0,0 +1,167 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "StfConstants.h"
+#include "UserInterface.h"
+#include "../../libraries/RTXTF-Library/STFDefinitions.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace donut::math;
+
+#include "lighting_cb.h"
+#include "stf_sigma_lod.h"
+#include "stf_temporal_strata.h"
+
+void FillStfConstants(const UIData& ui, uint32_t frameIndex, LightingConstants& constants)
+{
+    auto GetStfRuntimeFilterMode = [](StfFilterMode mode)->int {
+        switch (mode)
+        {
+        case StfFilterMode::Linear: return STF_FILTER_TYPE_LINEAR;
+        case StfFilterMode::Cubic: return STF_FILTER_TYPE_CUBIC;
+        case StfFilterMode::Gaussian: return STF_FILTER_TYPE_GAUSSIAN;
+        case StfFilterMode::Custom: return STF_FILTER_TYPE_LINEAR; // stfFilterKernelEnabled, the library filters linearly
+        default:
+            assert(!"Not Implemented");
+            return 0;
+        }
+        };
+
+    auto GetStfMagMode = [](StfMagMethod mode)->int {
+        switch (mode)
+        {
+        case StfMagMethod::Default: return STF_MAGNIFICATION_METHOD_NONE;
+        case StfMagMethod::Filter2x2Quad: return STF_MAGNIFICATION_METHOD_2x2_QUAD;
+        case StfMagMethod::Filter2x2Fine: return STF_MAGNIFICATION_METHOD_2x2_FINE;
+        case StfMagMethod::Filter2x2FineTemporal: return STF_MAGNIFICATION_METHOD_2x2_FINE_TEMPORAL;
+        case StfMagMethod::Filter3x3FineAlu: return STF_MAGNIFICATION_METHOD_3x3_FINE_ALU;
+        case StfMagMethod::Filter3x3FineLut: return STF_MAGNIFICATION_METHOD_3x3_FINE_LUT;
+        case StfMagMethod::Filter4x4Fine: return STF_MAGNIFICATION_METHOD_4x4_FINE;
+        case StfMagMethod::MinMax: return STF_MAGNIFICATION_METHOD_MIN_MAX;
+        case StfMagMethod::MinMaxHelper: return STF_MAGNIFICATION_METHOD_MIN_MAX_HELPER;
+        case StfMagMethod::MinMaxV2: return STF_MAGNIFICATION_METHOD_MIN_MAX_V2;
+        case StfMagMethod::MinMaxV2Helper: return STF_MAGNIFICATION_METHOD_MIN_MAX_V2_HELPER;
+        case StfMagMethod::Mask: return STF_MAGNIFICATION_METHOD_MASK;
+        case StfMagMethod::Mask2: return STF_MAGNIFICATION_METHOD_MASK2;
+        default:
+            assert(!"Not Implemented");
+            return 0;
+        }
+    };
+
+    auto GetFallbackMagMode = [](StfFallbackMethod mode)->int {
+        switch (mode)
+        {
+        case StfFallbackMethod::BL1STFILTER_FAST: return STF_MAGNIFICATION_FALLBACK_METHOD_BL1STFILTER_FAST;
+        case StfFallbackMethod::Debug: return STF_MAGNIFICATION_FALLBACK_METHOD_DEBUG;
+        default:
+            assert(!"Not Implemented");
+            return 0;
+        }
+        };
+
+    auto GetStfAddressMode = [](StfAddressMode mode)->int {
+        switch (mode)
+        {
+        case StfAddressMode::SameAsSampler: return STF_ADDRESS_MODE_WRAP; // m_CommonPasses->m_AnisotropicWrapSampler
+        case StfAddressMode::Clamp: return STF_ADDRESS_MODE_CLAMP;
+        case StfAddressMode::Wrap: return STF_ADDRESS_MODE_WRAP;
+        default:
+            assert(!"Not Implemented");
+            return 0;
+        }
+        };
+
+    float mipLevelOverride = 0; // wont be read by default
+
+    if (ui.stfMinificationMethod == StfMinMethod::ForceNegInf)
+    {
+        const uint32_t negInf = 0xFF800000;
+        mipLevelOverride = reinterpret_cast<const float&>(negInf);
+    }
+    else if (ui.stfMinificationMethod == StfMinMethod::ForcePosInf)
+    {
+        const uint32_t posInf = 0x7F800000;
+        mipLevelOverride = reinterpret_cast<const float&>(posInf);
+    }
+    else if (ui.stfMinificationMethod == StfMinMethod::ForceNan)
+    {
+        const uint32_t nan = 0x7FC00000;
+        mipLevelOverride = reinterpret_cast<const float&>(nan);
+    }
+    else
+    {
+        mipLevelOverride = ui.stfMipLevelOverride;
+    }
+
+    constants.stfSplitScreen = ui.samplerType == SamplerType::SplitScreen ? 1 : 0;
+    constants.stfFrameIndex = frameIndex;
+    constants.stfFilterMode = GetStfRuntimeFilterMode(ui.stfFilterMode);
+    constants.stfMagnificationMethod = GetStfMagMode(ui.stfMagnificationMethod);
+    constants.stfFallbackMethod = GetFallbackMagMode(ui.stfFallbackMethod);
+    constants.stfMinificationMethod = ui.stfMinificationMethod == StfMinMethod::Aniso || ui.stfMinificationMethod == StfMinMethod::Ewa ?
+        STF_ANISO_LOD_METHOD_DEFAULT : STF_ANISO_LOD_METHOD_NONE;
+    constants.stfEwaEnabled = ui.stfMinificationMethod == StfMinMethod::Ewa ? 1 : 0;
+    constants.stfUseMipLevelOverride = ui.stfMinificationMethod != StfMinMethod::Aniso && ui.stfMinificationMethod != StfMinMethod::Ewa ? 1 : 0;
+    constants.stfAddressMode = GetStfAddressMode(ui.stfAddressMode);
+    constants.stfMipLevelOverride = mipLevelOverride;
+    constants.stfSigma = ui.stfSigma;
+    constants.stfWaveLaneLayoutOverride = (uint)ui.stfWaveLaneLayoutOverride;
+    constants.stfReseedOnSample = (uint)ui.stfReseedOnSample;
+    constants.stfShareFootprints = (uint)ui.stfShareFootprints;
+    constants.stfConstantFootprints = (uint)ui.stfConstantFootprints;
+    constants.stfDecorrelateTextures = (uint)ui.stfDecorrelateTextures;
+    constants.stfMaxTaps = (uint)std::clamp(ui.stfMaxTaps, 1, 4);
+    constants.stfTapContrast = ui.stfTapContrast;
+    constants.stfFilterKernel = (uint)ui.stfFilterKernel;
+    constants.stfSigmaLodTarget = ui.stfSigmaLod ? std::max(ui.stfSigmaLodTarget, 0.f) : 0.f;
+    constants.stfTemporalStrata = (uint)std::clamp(ui.stfTemporalStrata, 1, STF_TEMPORAL_STRATA_MAX);
+    constants.stfTemporalGenerator = GetStfTemporalStrataGenerator(constants.stfTemporalStrata);
+
+    // The custom kernels bypass the library on the Load path, see stf_filter_kernel.hlsli: the Sample path falls back
+    // to bilinear, and neither the magnification methods nor the footprint shortcuts know their footprint
+    constants.stfFilterKernelEnabled = ui.stfFilterMode == StfFilterMode::Custom && ui.stfLoad ? 1 : 0;
+    if (constants.stfFilterKernelEnabled)
+    {
+        constants.stfMagnificationMethod = STF_MAGNIFICATION_METHOD_NONE;
+        constants.stfShareFootprints = 0;
+        constants.stfConstantFootprints = 0;
+    }
+
+    // Wide Gaussians move to a coarser mip than the footprints are computed for, see stf_sigma_lod.hlsli
+    if (IsStfSigmaLodEnabled(constants.stfFilterMode, constants.stfSigma, constants.stfSigmaLodTarget))
+    {
+        constants.stfShareFootprints = 0;
+        constants.stfConstantFootprints = 0;
+    }
+
+    // The shared footprints place the taps with the aniso methods of the library, see stf_ewa.hlsli
+    if (constants.stfEwaEnabled)
+        constants.stfShareFootprints = 0;
+
+    // The texel resolve loads the position the library picks for the first texture, see gbuffer_texel_id.h: the paths
+    // that move it or take more taps shade in the fill
+    constants.stfDeferredTexels = !constants.stfFilterKernelEnabled && !constants.stfEwaEnabled && constants.stfMaxTaps <= 1 &&
+        !IsStfSigmaLodEnabled(constants.stfFilterMode, constants.stfSigma, constants.stfSigmaLodTarget) ? 1 : 0;
+    constants.stfUseWhiteNoise = (uint)ui.stfUseWhiteNoise;
+    constants.stfDebugOnFailure = (uint)ui.stfDebugOnFailure;
+    constants.stfDebugVisualizeLanes = (uint)ui.stfDebugVisualizeLanes;
+
+    // Morton blocks are a power of two groups wide
+    constants.stfGroupSwizzle = (uint)ui.stfGroupSwizzle;
+    constants.stfGroupSwizzleSize = (uint)std::max(ui.stfGroupSwizzleSize, 1);
+    if (ui.stfGroupSwizzle == StfGroupSwizzle::Morton)
+    {
+        while (constants.stfGroupSwizzleSize & (constants.stfGroupSwizzleSize - 1))
+            constants.stfGroupSwizzleSize &= constants.stfGroupSwizzleSize - 1;
+    }
+}
@@ -0,0 +1,19 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+struct UIData;
+struct LightingConstants;
+
+// STF settings of the UI as shader constants, shared by the GPU passes and the CPU renderers
+void FillStfConstants(const UIData& ui, uint32_t frameIndex, LightingConstants& constants);
@@ -0,0 +1,918 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "StfCpuSampler.h"
+#include "StfFilterKernel.h"
+#include "stf_sigma_lod.h"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+using namespace donut::math;
+
+#include "stf_constant_footprint_cb.h"
+#include "stf_ewa.h"
+
+namespace
+{
+    constexpr float c_MaxAnisotropy = 16.f;
+
+    uint32_t AsUint(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    int ApplyAddressMode(int coordinate, int size, uint32_t addressMode)
+    {
+        if (addressMode == STF_ADDRESS_MODE_CLAMP)
+            return std::clamp(coordinate, 0, size - 1);
+
+        const int wrapped = coordinate % size;
+        return wrapped < 0 ? wrapped + size : wrapped;
+    }
+
+    // Inverse CDF of the cubic B-spline weights of the 4 texels around a sample, returns 0..3
+    int SampleCubicBSpline(float f, float u)
+    {
+        const float f2 = f * f;
+        const float f3 = f2 * f;
+        const float w0 = (1.f - 3.f * f + 3.f * f2 - f3) / 6.f;
+        const float w1 = (4.f - 6.f * f2 + 3.f * f3) / 6.f;
+        const float w2 = (1.f + 3.f * f + 3.f * f2 - 3.f * f3) / 6.f;
+
+        if (u < w0)
+            return 0;
+        if (u < w0 + w1)
+            return 1;
+        if (u < w0 + w1 + w2)
+            return 2;
+        return 3;
+    }
+
+    // Non-finite levels from the mip override modes resolve like they do on the GPU: -inf and NaN to the base, +inf to the last level
+    float ClampMipLevel(float mipLevel, uint32_t mipCount)
+    {
+        if (std::isnan(mipLevel))
+            return 0.f;
+        return std::clamp(mipLevel, 0.f, float(mipCount - 1));
+    }
+
+    // Level of detail of the minor footprint axis. The tap moves along majorAxis by up to half of spread in either
+    // direction, spread is 0 without anisotropy.
+    float GetAnisotropicLod(const StfCpuTexture& texture, float2 ddx, float2 ddy, float2& majorAxis, float& spread)
+    {
+        const float2 size = float2(texture.GetSize(0));
+        const float lengthX = length(ddx * size);
+        const float lengthY = length(ddy * size);
+        const float major = std::max(lengthX, lengthY);
+        const float minor = std::min(lengthX, lengthY);
+        const float anisotropy = minor > 0.f ? std::min(major / minor, c_MaxAnisotropy) : (major > 0.f ? c_MaxAnisotropy : 1.f);
+
+        majorAxis = lengthX > lengthY ? ddx : ddy;
+        spread = anisotropy > 1.f ? 1.f - 1.f / anisotropy : 0.f;
+        return std::log2(std::max(major / anisotropy, 1e-8f));
+    }
+
+    // Texels the filter can reach from the texel positions positionMin to positionMax, before addressing
+    void GetFilterSupport(uint32_t filterType, float sigma, float2 positionMin, float2 positionMax, int2& minTexel, int2& maxTexel)
+    {
+        switch (filterType)
+        {
+        case STF_FILTER_TYPE_CUBIC:
+            minTexel = int2(floor(positionMin)) - 1;
+            maxTexel = int2(floor(positionMax)) + 2;
+            break;
+
+        case STF_FILTER_TYPE_GAUSSIAN:
+        {
+            // The largest Box-Muller radius of GetTap
+            const float radius = sigma * std::sqrt(-2.f * std::log(1e-7f));
+            minTexel = int2(floor(positionMin - radius + 0.5f));
+            maxTexel = int2(floor(positionMax + radius + 0.5f));
+            break;
+        }
+
+        case STF_FILTER_TYPE_LINEAR:
+        default:
+            minTexel = int2(floor(positionMin));
+            maxTexel = int2(floor(positionMax)) + 1;
+            break;
+        }
+    }
+
+    // Moves the texel range of one axis into the mip, false when wrapping splits it
+    bool ApplyAddressMode(int& minTexel, int& maxTexel, int size, uint32_t addressMode)
+    {
+        if (addressMode == STF_ADDRESS_MODE_CLAMP)
+        {
+            minTexel = std::clamp(minTexel, 0, size - 1);
+            maxTexel = std::clamp(maxTexel, 0, size - 1);
+            return true;
+        }
+
+        const int wrapped = ApplyAddressMode(minTexel, size, addressMode);
+        maxTexel = wrapped + (maxTexel - minTexel);
+        minTexel = wrapped;
+        return maxTexel < size;
+    }
+
+    uint32_t LoadRgba(const CpuImage& image, int x, int y)
+    {
+        uint32_t rgba;
+        memcpy(&rgba, &image.rgba[(size_t(y) * image.width + x) * 4], sizeof(rgba));
+        return rgba;
+    }
+}
+
+float GetIsotropicLod(const StfCpuTexture& texture, float2 ddx, float2 ddy)
+{
+    const float2 size = float2(texture.GetSize(0));
+    const float lengthX = length(ddx * size);
+    const float lengthY = length(ddy * size);
+    return std::log2(std::max(std::max(lengthX, lengthY), 1e-8f));
+}
+
+StfCpuTexture::StfCpuTexture(CpuImage base)
+{
+    std::vector<CpuImage> mips;
+    GenerateMipChain(base, mips);
+
+    m_Mips.reserve(mips.size() + 1);
+    m_Mips.push_back(std::move(base));
+    for (CpuImage& mip : mips)
+        m_Mips.push_back(std::move(mip));
+
+    BuildConstantBlocks();
+}
+
+bool StfCpuTexture::ConstantBlocks::Get(int2 block) const
+{
+    const size_t bit = size_t(block.y) * blocks.x + block.x;
+    return (bits[bit / 32] >> (bit % 32)) & 1;
+}
+
+void StfCpuTexture::BuildConstantBlocks()
+{
+    m_ConstantBlocks.resize(m_Mips.size() * STF_CONSTANT_FOOTPRINT_LEVELS);
+
+    for (uint32_t mip = 0; mip < GetMipCount(); mip++)
+    {
+        const CpuImage& image = m_Mips[mip];
+        const int2 size = GetSize(mip);
+
+        for (uint32_t level = 0; level < STF_CONSTANT_FOOTPRINT_LEVELS; level++)
+        {
+            const int stride = 2 << level;
+            ConstantBlocks& blocks = m_ConstantBlocks[mip * STF_CONSTANT_FOOTPRINT_LEVELS + level];
+            blocks.blocks = (size + (stride - 1)) / stride;
+            blocks.bits.assign((size_t(blocks.blocks.x) * blocks.blocks.y + 31) / 32, 0);
+
+            for (int y = 0; y < blocks.blocks.y; y++)
+            {
+                for (int x = 0; x < blocks.blocks.x; x++)
+                {
+                    bool constant = true;
+                    if (level == 0)
+                    {
+                        // The texels of the block
+                        const int2 minTexel = int2(x, y) * stride;
+                        const int2 maxTexel = min(minTexel + 2 * stride, size) - 1;
+                        const uint32_t first = LoadRgba(image, minTexel.x, minTexel.y);
+                        for (int ty = minTexel.y; ty <= maxTexel.y && constant; ty++)
+                            for (int tx = minTexel.x; tx <= maxTexel.x && constant; tx++)
+                                constant = LoadRgba(image, tx, ty) == first;
+                    }
+                    else
+                    {
+                        // Blocks 2i to 2i + 2 of the level below cover the block and overlap their neighbors, so they
+                        // are all constant exactly when the block is. Past the edge the last one covers the rest.
+                        const ConstantBlocks& below = m_ConstantBlocks[mip * STF_CONSTANT_FOOTPRINT_LEVELS + level - 1];
+                        for (int cy = 0; cy < 3 && constant; cy++)
+                            for (int cx = 0; cx < 3 && constant; cx++)
+                                constant = below.Get(min(int2(2 * x + cx, 2 * y + cy), below.blocks - 1));
+                    }
+
+                    if (constant)
+                    {
+                        const size_t bit = size_t(y) * blocks.blocks.x + x;
+                        blocks.bits[bit / 32] |= 1u << (bit % 32);
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool StfCpuTexture::IsConstant(uint32_t mip, int2 minTexel, int2 maxTexel) const
+{
+    const int2 extent = maxTexel - minTexel + 1;
+    for (uint32_t level = 0; level < STF_CONSTANT_FOOTPRINT_LEVELS; level++)
+    {
+        // The block of the first texel contains the rectangle when it ends before the next but one block starts
+        const int stride = 2 << level;
+        if ((minTexel.x & (stride - 1)) + extent.x <= 2 * stride && (minTexel.y & (stride - 1)) + extent.y <= 2 * stride)
+            return m_ConstantBlocks[mip * STF_CONSTANT_FOOTPRINT_LEVELS + level].Get(int2(minTexel.x >> (level + 1), minTexel.y >> (level + 1)));
+    }
+
+    return false;
+}
+
+float4 StfCpuTexture::Load(uint32_t mip, int2 texel) const
+{
+    const CpuImage& image = m_Mips[mip];
+    const uint8_t* rgba = &image.rgba[(size_t(texel.y) * image.width + texel.x) * 4];
+
+    if (image.sRGB)
+        return float4(Srgb8ToLinear(rgba[0]), Srgb8ToLinear(rgba[1]), Srgb8ToLinear(rgba[2]), float(rgba[3]) / 255.f);
+
+    return float4(float(rgba[0]), float(rgba[1]), float(rgba[2]), float(rgba[3])) / 255.f;
+}
+
+float4 StfCpuTexture::Load(const StfCpuTap& tap) const
+{
+    return Load(tap.mip, tap.texel) * tap.weight;
+}
+
+StfCpuTap StfCpuSamplerState::GetTap(const StfCpuTexture& texture, float2 uv, float mipLevel) const
+{
+    mipLevel = ClampMipLevel(mipLevel, texture.GetMipCount());
+
+    // Stochastic trilinear: the upper level with probability equal to the fractional part
+    StfCpuTap tap;
+    tap.mip = uint32_t(mipLevel);
+    if (u.w < mipLevel - float(tap.mip))
+        tap.mip = std::min(tap.mip + 1, texture.GetMipCount() - 1);
+
+    const int2 size = texture.GetSize(tap.mip);
+    const float2 position = uv * float2(size) - 0.5f;
+    const float2 base = floor(position);
+    const float2 f = position - base;
+
+    int2 texel = int2(base);
+    if (filterKernelEnabled)
+    {
+        // StfFilterKernel::Load, the weights of the two axes multiply
+        const StfFilterKernelTable& table = StfFilterKernelTable::Get(filterKernel);
+        float weightX, weightY;
+        texel.x += table.SampleAxis(f.x, u.x, weightX);
+        texel.y += table.SampleAxis(f.y, u.y, weightY);
+        tap.weight = weightX * weightY;
+    }
+    else
+    {
+        switch (filterType)
+        {
+        case STF_FILTER_TYPE_CUBIC:
+            texel.x += SampleCubicBSpline(f.x, u.x) - 1;
+            texel.y += SampleCubicBSpline(f.y, u.y) - 1;
+            break;
+
+        case STF_FILTER_TYPE_GAUSSIAN:
+        {
+            // Box-Muller, then the texel nearest to the offset position
+            const float radius = sigma * std::sqrt(-2.f * std::log(std::max(u.x, 1e-7f)));
+            const float angle = 2.f * PI_f * u.y;
+            const float2 offset = float2(radius * std::cos(angle), radius * std::sin(angle));
+            texel = int2(floor(position + offset + 0.5f));
+            break;
+        }
+
+        case STF_FILTER_TYPE_LINEAR:
+        default:
+            texel.x += u.x < f.x ? 1 : 0;
+            texel.y += u.y < f.y ? 1 : 0;
+            break;
+        }
+    }
+
+    tap.texel.x = ApplyAddressMode(texel.x, size.x, addressMode);
+    tap.texel.y = ApplyAddressMode(texel.y, size.y, addressMode);
+    return tap;
+}
+
+StfCpuTap StfCpuSamplerState::GetTapLevel(const StfCpuTexture& texture, float2 uv, float mipLevel) const
+{
+    if (!IsSigmaLodEnabled())
+        return GetTap(texture, uv, mipLevel);
+
+    // StfSigmaLod::SampleLevel: the mip is chosen here, GetTap only draws the Gaussian offset with the sigma of that mip
+    mipLevel = ClampMipLevel(mipLevel, texture.GetMipCount());
+    const float mip = SelectStfSigmaLodMip(mipLevel, sigma, sigmaLodTarget, float(texture.GetMipCount()), u.w);
+
+    StfCpuSamplerState mipState = *this;
+    mipState.sigma = GetStfSigmaLodMipSigma(sigma, mip - mipLevel);
+    return mipState.GetTap(texture, uv, mip);
+}
+
+bool StfCpuSamplerState::IsSigmaLodEnabled() const
+{
+    return IsStfSigmaLodEnabled(filterType, sigma, sigmaLodTarget);
+}
+
+StfCpuTap StfCpuSamplerState::GetTapGrad(const StfCpuTexture& texture, float2 uv, float2 ddx, float2 ddy) const
+{
+    if (IsSigmaLodEnabled())
+        return GetTapLevel(texture, uv, GetIsotropicLod(texture, ddx, ddy));
+
+    if (anisoMethod == STF_ANISO_LOD_METHOD_NONE || filterKernelEnabled)
+        return GetTap(texture, uv, GetIsotropicLod(texture, ddx, ddy));
+
+    if (ewaEnabled)
+    {
+        // StfEwa::SampleGrad: a Gaussian distributed position in the ellipse, on the mip of the minor axis
+        const StfEwaFootprint footprint = GetStfEwaFootprint(ddx, ddy, float2(texture.GetSize(0)));
+        uint32_t hash = CpuRng::Hash32Combine(CpuRng::Hash32(AsUint(u.x)), AsUint(u.w));
+        const float u0 = CpuRng::SampleNext1D(hash);
+        const float u1 = CpuRng::SampleNext1D(hash);
+        return GetTap(texture, uv + GetStfEwaOffset(footprint, u0, u1), footprint.lod);
+    }
+
+    // Level from the minor axis of the footprint, one tap at a random position along the major axis
+    float2 majorAxis;
+    float spread;
+    const float lod = GetAnisotropicLod(texture, ddx, ddy, majorAxis, spread);
+
+    if (spread > 0.f)
+    {
+        uint32_t hash = CpuRng::Hash32Combine(CpuRng::Hash32(AsUint(u.x)), AsUint(u.w));
+        const float along = CpuRng::SampleNext1D(hash) - 0.5f;
+        uv += majorAxis * (along * spread);
+    }
+
+    return GetTap(texture, uv, lod);
+}
+
+bool StfCpuSamplerState::GetConstantTap(const StfCpuTexture& texture, float2 uvMin, float2 uvMax, float mipLevel, StfCpuTap& tap) const
+{
+    if (filterKernelEnabled || IsSigmaLodEnabled())
+        return false;
+
+    mipLevel = ClampMipLevel(mipLevel, texture.GetMipCount());
+
+    // The mips GetTap can choose, they must agree on the value
+    const uint32_t lower = uint32_t(mipLevel);
+    const uint32_t upper = mipLevel > float(lower) ? std::min(lower + 1, texture.GetMipCount() - 1) : lower;
+
+    float4 value = 0.f;
+    for (uint32_t mip = lower; mip <= upper; mip++)
+    {
+        const int2 size = texture.GetSize(mip);
+        int2 minTexel, maxTexel;
+        GetFilterSupport(filterType, sigma, uvMin * float2(size) - 0.5f, uvMax * float2(size) - 0.5f, minTexel, maxTexel);
+
+        if (!ApplyAddressMode(minTexel.x, maxTexel.x, size.x, addressMode) ||
+            !ApplyAddressMode(minTexel.y, maxTexel.y, size.y, addressMode) ||
+            !texture.IsConstant(mip, minTexel, maxTexel))
+        {
+            return false;
+        }
+
+        const float4 mipValue = texture.Load(mip, minTexel);
+        if (mip == lower)
+        {
+            tap.mip = mip;
+            tap.texel = minTexel;
+            value = mipValue;
+        }
+        else if (any(mipValue != value))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool StfCpuSamplerState::GetConstantTapLevel(const StfCpuTexture& texture, float2 uv, float mipLevel, StfCpuTap& tap) const
+{
+    return GetConstantTap(texture, uv, uv, mipLevel, tap);
+}
+
+bool StfCpuSamplerState::GetConstantTapGrad(const StfCpuTexture& texture, float2 uv, float2 ddx, float2 ddy, StfCpuTap& tap) const
+{
+    if (anisoMethod == STF_ANISO_LOD_METHOD_NONE)
+        return GetConstantTap(texture, uv, uv, GetIsotropicLod(texture, ddx, ddy), tap);
+
+    if (ewaEnabled)
+    {
+        const StfEwaFootprint footprint = GetStfEwaFootprint(ddx, ddy, float2(texture.GetSize(0)));
+        const float2 reach = abs(footprint.majorAxis) + abs(footprint.minorAxis);
+        return GetConstantTap(texture, uv - reach, uv + reach, footprint.lod, tap);
+    }
+
+    // Every position GetTapGrad can move the tap to
+    float2 majorAxis;
+    float spread;
+    const float lod = GetAnisotropicLod(texture, ddx, ddy, majorAxis, spread);
+    const float2 reach = abs(majorAxis) * (0.5f * spread);
+    return GetConstantTap(texture, uv - reach, uv + reach, lod, tap);
+}
+
+float4 StfCpuSamplerState::SampleGrad(const StfCpuTexture& texture, float2 uv, float2 ddx, float2 ddy)
+{
+    StfCpuTap tap;
+    if (constantFootprints && GetConstantTapGrad(texture, uv, ddx, ddy, tap))
+        return texture.Load(tap);
+
+    tap = GetTapGrad(texture, uv, ddx, ddy);
+    Reseed();
+    return texture.Load(tap);
+}
+
+float4 StfCpuSamplerState::SampleLevel(const StfCpuTexture& texture, float2 uv, float mipLevel)
+{
+    StfCpuTap tap;
+    if (constantFootprints && GetConstantTapLevel(texture, uv, mipLevel, tap))
+        return texture.Load(tap);
+
+    tap = GetTapLevel(texture, uv, mipLevel);
+    Reseed();
+    return texture.Load(tap);
+}
+
+void StfCpuSamplerState::Reseed()
+{
+    if (!reseedOnSample)
+        return;
+
+    uint32_t hash = CpuRng::Hash32Combine(CpuRng::Hash32(AsUint(u.x)), AsUint(u.y) ^ AsUint(u.w));
+    u.x = CpuRng::SampleNext1D(hash);
+    u.y = CpuRng::SampleNext1D(hash);
+    u.w = CpuRng::SampleNext1D(hash);
+}
+
+StfCpuSharedFootprint::StfCpuSharedFootprint(const StfCpuSamplerState& state, float2 uv, float2 ddx, float2 ddy)
+    : m_State(state)
+    , m_Uv(uv)
+    , m_Ddx(ddx)
+    , m_Ddy(ddy)
+{
+}
+
+StfCpuSharedFootprint::StfCpuSharedFootprint(const StfCpuSamplerState& state, float2 uv, float mipLevel)
+    : m_State(state)
+    , m_Uv(uv)
+    , m_MipLevel(mipLevel)
+    , m_ForceMipLevel(true)
+{
+}
+
+StfCpuTap StfCpuSharedFootprint::GetTap(const StfCpuTexture& texture)
+{
+    const int2 size = texture.GetSize(0);
+    const uint32_t mipCount = texture.GetMipCount();
+    for (uint32_t i = 0; i < m_ClassCount; i++)
+    {
+        if (all(m_Classes[i].size == size) && m_Classes[i].mipCount == mipCount)
+            return m_Classes[i].tap;
+    }
+
+    const StfCpuTap tap = m_ForceMipLevel
+        ? m_State.GetTapLevel(texture, m_Uv, m_MipLevel)
+        : m_State.GetTapGrad(texture, m_Uv, m_Ddx, m_Ddy);
+    m_FootprintCount++;
+
+    if (m_ClassCount < MaxClasses)
+        m_Classes[m_ClassCount++] = { size, mipCount, tap };
+
+    return tap;
+}
+
+float4 StfCpuSharedFootprint::Sample(const StfCpuTexture& texture)
+{
+    StfCpuTap tap;
+    if (m_State.constantFootprints)
+    {
+        const bool constant = m_ForceMipLevel
+            ? m_State.GetConstantTapLevel(texture, m_Uv, m_MipLevel, tap)
+            : m_State.GetConstantTapGrad(texture, m_Uv, m_Ddx, m_Ddy, tap);
+        if (constant)
+            return texture.Load(tap);
+    }
+
+    tap = GetTap(texture);
+    return texture.Load(tap);
+}
+
+uint32_t StfCpuMultiTap::GetTapCount(float contrast) const
+{
+    if (maxTaps < 2 || contrast < threshold)
+        return 1;
+    return maxTaps >= 4 && contrast >= 2.f * threshold ? 4 : 2;
+}
+
+float StfCpuMultiTap::GetContrast(float4 minValue, float4 maxValue)
+{
+    const float4 range = maxValue - minValue;
+    return std::max(std::max(range.x, range.y), std::max(range.z, range.w));
+}
+
+float4 StfCpuMultiTap::GetTapRandom(float4 u, uint32_t tap, uint32_t tapCount)
+{
+    const float4 generator = tapCount == 4 ? float4(1.f, 3.f, 0.f, 1.f) : float4(1.f, 1.f, 0.f, 1.f);
+    const float4 shifted = u + generator * (float(tap) / float(tapCount));
+    return float4(shifted.x - std::floor(shifted.x), shifted.y - std::floor(shifted.y), shifted.z - std::floor(shifted.z),
+        shifted.w - std::floor(shifted.w));
+}
+
+float4 StfCpuMultiTap::AddTapsGrad(const StfCpuSamplerState& state, float4 u, float4 value, uint32_t& tapCount,
+    const StfCpuTexture& texture, float2 uv, float2 ddx, float2 ddy)
+{
+    StfCpuTap tap;
+    if (state.constantFootprints && state.GetConstantTapGrad(texture, uv, ddx, ddy, tap))
+        tapCount = 1;
+
+    StfCpuSamplerState tapState = state;
+    tapState.reseedOnSample = false;
+    float4 sum = value;
+    for (uint32_t i = 1; i < tapCount; i++)
+    {
+        tapState.u = GetTapRandom(u, i, tapCount);
+        tap = tapState.GetTapGrad(texture, uv, ddx, ddy);
+        sum += texture.Load(tap);
+    }
+    return sum / float(tapCount);
+}
+
+float4 StfCpuMultiTap::AddTapsLevel(const StfCpuSamplerState& state, float4 u, float4 value, uint32_t& tapCount,
+    const StfCpuTexture& texture, float2 uv, float mipLevel)
+{
+    StfCpuTap tap;
+    if (state.constantFootprints && state.GetConstantTapLevel(texture, uv, mipLevel, tap))
+        tapCount = 1;
+
+    StfCpuSamplerState tapState = state;
+    tapState.reseedOnSample = false;
+    float4 sum = value;
+    for (uint32_t i = 1; i < tapCount; i++)
+    {
+        tapState.u = GetTapRandom(u, i, tapCount);
+        tap = tapState.GetTapLevel(texture, uv, mipLevel);
+        sum += texture.Load(tap);
+    }
+    return sum / float(tapCount);
+}
+
+namespace
+{
+    float4 SampleBilinear(const StfCpuTexture& texture, float2 uv, uint32_t mip, uint32_t addressMode)
+    {
+        const int2 size = texture.GetSize(mip);
+        const float2 position = uv * float2(size) - 0.5f;
+        const float2 base = floor(position);
+        const float2 f = position - base;
+
+        const int x0 = ApplyAddressMode(int(base.x), size.x, addressMode);
+        const int y0 = ApplyAddressMode(int(base.y), size.y, addressMode);
+        const int x1 = ApplyAddressMode(int(base.x) + 1, size.x, addressMode);
+        const int y1 = ApplyAddressMode(int(base.y) + 1, size.y, addressMode);
+
+        const float4 top = lerp(texture.Load(mip, int2(x0, y0)), texture.Load(mip, int2(x1, y0)), f.x);
+        const float4 bottom = lerp(texture.Load(mip, int2(x0, y1)), texture.Load(mip, int2(x1, y1)), f.x);
+        return lerp(top, bottom, f.y);
+    }
+}
+
+float4 SampleHardwareLevel(const StfCpuTexture& texture, float2 uv, float mipLevel)
+{
+    mipLevel = ClampMipLevel(mipLevel, texture.GetMipCount());
+
+    const uint32_t lower = uint32_t(mipLevel);
+    const uint32_t upper = std::min(lower + 1, texture.GetMipCount() - 1);
+    const float f = mipLevel - float(lower);
+
+    if (f == 0.f || lower == upper)
+        return SampleBilinear(texture, uv, lower, STF_ADDRESS_MODE_WRAP);
+
+    return lerp(SampleBilinear(texture, uv, lower, STF_ADDRESS_MODE_WRAP), SampleBilinear(texture, uv, upper, STF_ADDRESS_MODE_WRAP), f);
+}
+
+float4 SampleHardwareGrad(const StfCpuTexture& texture, float2 uv, float2 ddx, float2 ddy)
+{
+    return SampleHardwareLevel(texture, uv, GetIsotropicLod(texture, ddx, ddy));
+}
+
+namespace
+{
+    // The Gaussian weighted average of the texels of one mip whose centers lie inside the ellipse
+    float4 SampleEwaMip(const StfCpuTexture& texture, float2 uv, const StfEwaFootprint& footprint, uint32_t mip, uint32_t addressMode)
+    {
+        const int2 size = texture.GetSize(mip);
+        const float2 center = uv * float2(size) - 0.5f;
+
+        // Semi-axes in texels of the mip, at least one texel long so that the ellipse always contains texels
+        float2 majorAxis = footprint.majorAxis * float2(size);
+        float2 minorAxis = footprint.minorAxis * float2(size);
+        const float majorLength = std::max(length(majorAxis), 1e-8f);
+        const float minorLength = std::max(length(minorAxis), 1e-8f);
+        majorAxis *= std::max(majorLength, 1.f) / majorLength;
+        minorAxis *= std::max(minorLength, 1.f) / minorLength;
+
+        const float2 extent = float2(std::sqrt(majorAxis.x * majorAxis.x + minorAxis.x * minorAxis.x),
+            std::sqrt(majorAxis.y * majorAxis.y + minorAxis.y * minorAxis.y));
+        const int2 minTexel = int2(ceil(center - extent));
+        const int2 maxTexel = int2(floor(center + extent));
+        const float2 majorScaled = majorAxis / dot(majorAxis, majorAxis);
+        const float2 minorScaled = minorAxis / dot(minorAxis, minorAxis);
+
+        float4 sum = 0.f;
+        float weightSum = 0.f;
+        for (int y = minTexel.y; y <= maxTexel.y; y++)
+        {
+            for (int x = minTexel.x; x <= maxTexel.x; x++)
+            {
+                // Radius in the unit ellipse, the axes are orthogonal
+                const float2 d = float2(float(x), float(y)) - center;
+                const float p = dot(d, majorScaled);
+                const float q = dot(d, minorScaled);
+                const float r2 = p * p + q * q;
+                if (r2 >= 1.f)
+                    continue;
+
+                const float weight = std::exp(-STF_EWA_ALPHA * r2);
+                const int2 texel = int2(ApplyAddressMode(x, size.x, addressMode), ApplyAddressMode(y, size.y, addressMode));
+                sum += texture.Load(mip, texel) * weight;
+                weightSum += weight;
+            }
+        }
+
+        return weightSum > 0.f ? sum / weightSum : SampleBilinear(texture, uv, mip, addressMode);
+    }
+}
+
+float4 SampleEwaReference(const StfCpuTexture& texture, float2 uv, float2 ddx, float2 ddy, uint32_t addressMode)
+{
+    const StfEwaFootprint footprint = GetStfEwaFootprint(ddx, ddy, float2(texture.GetSize(0)));
+    const float mipLevel = ClampMipLevel(footprint.lod, texture.GetMipCount());
+
+    const uint32_t lower = uint32_t(mipLevel);
+    const uint32_t upper = std::min(lower + 1, texture.GetMipCount() - 1);
+    const float f = mipLevel - float(lower);
+
+    const float4 lowerValue = SampleEwaMip(texture, uv, footprint, lower, addressMode);
+    if (f == 0.f || lower == upper)
+        return lowerValue;
+
+    return lerp(lowerValue, SampleEwaMip(texture, uv, footprint, upper, addressMode), f);
+}
+
+namespace
+{
+    constexpr uint32_t c_MaxWaveLanes = 128;
+
+    bool IsWaveMagMethod(uint32_t magMethod)
+    {
+        return magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX || magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX_HELPER ||
+            magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX_V2 || magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX_V2_HELPER;
+    }
+
+    bool IsQuadMagMethod(uint32_t magMethod)
+    {
+        return magMethod == STF_MAGNIFICATION_METHOD_2x2_QUAD || magMethod == STF_MAGNIFICATION_METHOD_2x2_FINE ||
+            magMethod == STF_MAGNIFICATION_METHOD_2x2_FINE_TEMPORAL;
+    }
+
+    // Whether the union of the 2x2 footprints starting at bases[i] for the included lanes in [begin, end) has
+    // no more texels than loaderCount. False when no lane is included. The union is the rectangle of texels from
+    // minTexel to maxTexel inclusive.
+    bool FootprintsFit(const int2* bases, const bool* included, uint32_t begin, uint32_t end, uint32_t loaderCount,
+        int2& minTexel, int2& maxTexel)
+    {
+        int2 minBase = int2(INT_MAX);
+        int2 maxBase = int2(INT_MIN);
+        bool any = false;
+        for (uint32_t i = begin; i < end; i++)
+        {
+            if (!included[i])
+                continue;
+            minBase = min(minBase, bases[i]);
+            maxBase = max(maxBase, bases[i]);
+            any = true;
+        }
+
+        if (!any)
+            return false;
+
+        minTexel = minBase;
+        maxTexel = maxBase + 1;
+        const int64_t width = int64_t(maxBase.x) - minBase.x + 2;
+        const int64_t height = int64_t(maxBase.y) - minBase.y + 2;
+        return width * height <= int64_t(loaderCount);
+    }
+
+    // Texels fetched by one wave, to count the distinct ones and to pass them on in fetch order
+    class WaveTexelSet
+    {
+    public:
+        explicit WaveTexelSet(std::vector<StfCpuTap>* fetches)
+            : m_Fetches(fetches)
+        {
+        }
+
+        void Add(uint32_t mip, int2 texel)
+        {
+            assert(m_Count < std::size(m_Keys));
+            m_Keys[m_Count++] = (uint64_t(mip) << 58) | (uint64_t(uint32_t(texel.y) & 0x1fffffff) << 29) | uint64_t(uint32_t(texel.x) & 0x1fffffff);
+            if (m_Fetches)
+                m_Fetches->push_back({ mip, texel });
+        }
+
+        // The texels of a cooperative load, addressed like the bilinear filter
+        void AddRect(int2 minTexel, int2 maxTexel, int2 size, uint32_t addressMode)
+        {
+            for (int y = minTexel.y; y <= maxTexel.y; y++)
+                for (int x = minTexel.x; x <= maxTexel.x; x++)
+                    Add(0, int2(ApplyAddressMode(x, size.x, addressMode), ApplyAddressMode(y, size.y, addressMode)));
+        }
+
+        uint32_t CountDistinct()
+        {
+            std::sort(m_Keys, m_Keys + m_Count);
+            return uint32_t(std::unique(m_Keys, m_Keys + m_Count) - m_Keys);
+        }
+
+    private:
+        // A filtered group loads at most one texel per lane, every other lane fetches one tap
+        uint64_t m_Keys[2 * c_MaxWaveLanes];
+        uint32_t m_Count = 0;
+        std::vector<StfCpuTap>* m_Fetches;
+    };
+}
+
+void StfCpuSampleWaveGrad(const StfCpuTexture& texture, uint32_t magMethod, bool includeHelperLanes,
+    StfCpuWaveLane* lanes, uint32_t laneCount, StfSamplingCounters& stats, std::vector<StfCpuTap>* fetches)
+{
+    assert(laneCount <= c_MaxWaveLanes && laneCount % 4 == 0);
+
+    const bool waveMethod = IsWaveMagMethod(magMethod);
+    const bool quadMethod = IsQuadMagMethod(magMethod);
+    const bool helperVariant = magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX_HELPER || magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX_V2_HELPER;
+    const bool quadRetry = magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX_V2 || magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX_V2_HELPER;
+
+    bool constant[c_MaxWaveLanes];
+    StfCpuTap constantTaps[c_MaxWaveLanes];
+    bool active[c_MaxWaveLanes];
+    bool magnified[c_MaxWaveLanes];
+    bool loads[c_MaxWaveLanes];
+    bool footprint[c_MaxWaveLanes];
+    bool filtered[c_MaxWaveLanes];
+    int2 bases[c_MaxWaveLanes];
+
+    WaveTexelSet texels(fetches);
+
+    const float2 size = float2(texture.GetSize(0));
+    uint32_t addressMode = STF_ADDRESS_MODE_WRAP;
+    bool anyStf = false;
+    for (uint32_t i = 0; i < laneCount; i++)
+    {
+        const StfCpuWaveLane& lane = lanes[i];
+        constant[i] = lane.participates && lane.stfEnabled && lane.state->constantFootprints &&
+            lane.state->GetConstantTapGrad(texture, lane.uv, lane.ddx, lane.ddy, constantTaps[i]);
+        if (constant[i])
+            texels.Add(constantTaps[i].mip, constantTaps[i].texel);
+
+        // Lanes that took the early-out are not active in the sample any more
+        active[i] = lane.participates && !constant[i];
+        magnified[i] = active[i] && lane.stfEnabled && GetIsotropicLod(texture, lane.ddx, lane.ddy) <= 0.f;
+        bases[i] = int2(floor(lane.uv * size - 0.5f));
+        filtered[i] = false;
+
+        if (lane.participates && lane.stfEnabled)
+        {
+            addressMode = lane.state->addressMode;
+            anyStf = true;
+        }
+    }
+
+    int2 minTexel, maxTexel;
+
+    if (waveMethod)
+    {
+        uint32_t loaderCount = 0;
+        for (uint32_t i = 0; i < laneCount; i++)
+        {
+            const bool visible = !lanes[i].helper || includeHelperLanes;
+            loads[i] = active[i] && visible;
+            footprint[i] = magnified[i] && visible && !(lanes[i].helper && helperVariant);
+            loaderCount += loads[i] ? 1 : 0;
+        }
+
+        if (FootprintsFit(bases, footprint, 0, laneCount, loaderCount, minTexel, maxTexel))
+        {
+            for (uint32_t i = 0; i < laneCount; i++)
+            {
+                filtered[i] = footprint[i];
+                stats.waveFilteredSamples += (footprint[i] && !lanes[i].helper) ? 1 : 0;
+            }
+
+            texels.AddRect(minTexel, maxTexel, texture.GetSize(0), addressMode);
+            stats.texelsFetched += uint64_t(maxTexel.x - minTexel.x + 1) * uint64_t(maxTexel.y - minTexel.y + 1);
+            stats.sharingLanes += loaderCount;
+        }
+        else if (quadRetry)
+        {
+            for (uint32_t quad = 0; quad < laneCount; quad += 4)
+            {
+                const uint32_t quadLoaders = uint32_t(loads[quad]) + uint32_t(loads[quad + 1]) + uint32_t(loads[quad + 2]) + uint32_t(loads[quad + 3]);
+                if (!FootprintsFit(bases, footprint, quad, quad + 4, quadLoaders, minTexel, maxTexel))
+                    continue;
+
+                for (uint32_t i = quad; i < quad + 4; i++)
+                {
+                    filtered[i] = footprint[i];
+                    stats.quadFilteredSamples += (footprint[i] && !lanes[i].helper) ? 1 : 0;
+                }
+
+                texels.AddRect(minTexel, maxTexel, texture.GetSize(0), addressMode);
+                stats.texelsFetched += uint64_t(maxTexel.x - minTexel.x + 1) * uint64_t(maxTexel.y - minTexel.y + 1);
+                stats.sharingLanes += quadLoaders;
+            }
+        }
+    }
+    else if (quadMethod)
+    {
+        for (uint32_t quad = 0; quad < laneCount; quad += 4)
+        {
+            uint32_t quadLoaders = 0;
+            for (uint32_t i = quad; i < quad + 4; i++)
+                quadLoaders += active[i] ? 1 : 0;
+
+            if (!FootprintsFit(bases, magnified, quad, quad + 4, quadLoaders, minTexel, maxTexel))
+                continue;
+
+            for (uint32_t i = quad; i < quad + 4; i++)
+            {
+                filtered[i] = magnified[i];
+                stats.quadFilteredSamples += (magnified[i] && !lanes[i].helper) ? 1 : 0;
+            }
+
+            texels.AddRect(minTexel, maxTexel, texture.GetSize(0), addressMode);
+            stats.texelsFetched += uint64_t(maxTexel.x - minTexel.x + 1) * uint64_t(maxTexel.y - minTexel.y + 1);
+            stats.sharingLanes += quadLoaders;
+        }
+    }
+
+    for (uint32_t i = 0; i < laneCount; i++)
+    {
+        StfCpuWaveLane& lane = lanes[i];
+        if (!lane.participates)
+            continue;
+
+        if (!lane.stfEnabled)
+        {
+            lane.result = SampleHardwareGrad(texture, lane.uv, lane.ddx, lane.ddy);
+            continue;
+        }
+
+        if (!lane.helper)
+        {
+            stats.samples++;
+            stats.constantSamples += constant[i] ? 1 : 0;
+            if (magnified[i])
+            {
+                stats.magnifiedSamples++;
+                stats.fallbackSamples += filtered[i] ? 0 : 1;
+            }
+        }
+
+        if (constant[i])
+        {
+            lane.result = texture.Load(constantTaps[i]);
+            stats.texelsFetched++;
+        }
+        else if (filtered[i])
+        {
+            lane.result = SampleBilinear(texture, lane.uv, 0, lane.state->addressMode);
+            lane.state->Reseed();
+        }
+        else
+        {
+            // StfCpuSamplerState::SampleGrad, keeping the tap
+            const StfCpuTap tap = lane.state->GetTapGrad(texture, lane.uv, lane.ddx, lane.ddy);
+            lane.state->Reseed();
+            lane.result = texture.Load(tap);
+
+            texels.Add(tap.mip, tap.texel);
+            stats.texelsFetched++;
+        }
+    }
+
+    if (anyStf)
+    {
+        stats.waves++;
+        stats.distinctTexels += texels.CountDistinct();
+    }
+}
@@ -0,0 +1,258 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "StfSamplingStats.h"
+#include "TextureProcessing.h"
+
+#include <donut/core/math/math.h>
+#include "../../libraries/RTXTF-Library/STFDefinitions.h"
+#include "stf_filter_kernel_cb.h"
+
+#include <cstdint>
+#include <vector>
+
+// C++ version of RNG in rng.hlsli, bit exact
+struct CpuRng
+{
+    static uint32_t Hash32(uint32_t x)
+    {
+        x ^= x >> 17;
+        x *= 0xed5ad4bbu;
+        x ^= x >> 11;
+        x *= 0xac4c1b51u;
+        x ^= x >> 15;
+        x *= 0x31848babu;
+        x ^= x >> 14;
+        return x;
+    }
+
+    static uint32_t Hash32Combine(uint32_t seed, uint32_t value)
+    {
+        return seed ^ (Hash32(value) + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+    }
+
+    static float SampleNext1D(uint32_t& hash)
+    {
+        hash = Hash32(hash);
+        return float(hash >> 8) / float(1 << 24);
+    }
+
+    static dm::float3 SpatioTemporalWhiteNoise3D(dm::uint2 pixel, uint32_t frameIndex)
+    {
+        uint32_t hash = Hash32Combine(Hash32(frameIndex + 0x035F9F29u), (pixel.x << 16) | pixel.y);
+        dm::float3 u;
+        u.x = SampleNext1D(hash);
+        u.y = SampleNext1D(hash);
+        u.z = SampleNext1D(hash);
+        return u;
+    }
+};
+
+struct StfCpuTap;
+
+// Mip chain of an 8-bit RGBA texture. Fetches return linear values, like sampling an SRGBA8 or RGBA8 GPU texture.
+// The constant blocks of stf_constant_footprint_cb.h are built with the mips, they tell where all texels are equal.
+class StfCpuTexture
+{
+public:
+    StfCpuTexture() = default;
+    StfCpuTexture(CpuImage base);
+
+    [[nodiscard]] bool IsValid() const { return !m_Mips.empty(); }
+    [[nodiscard]] uint32_t GetMipCount() const { return uint32_t(m_Mips.size()); }
+    [[nodiscard]] dm::int2 GetSize(uint32_t mip) const { return dm::int2(int(m_Mips[mip].width), int(m_Mips[mip].height)); }
+
+    // texel must be inside the mip
+    [[nodiscard]] dm::float4 Load(uint32_t mip, dm::int2 texel) const;
+    [[nodiscard]] dm::float4 Load(const StfCpuTap& tap) const;     // the texel times the weight of the tap
+
+    // Whether all texels from minTexel to maxTexel inclusive are equal, the rectangle must be inside the mip.
+    // Rectangles that do not fit into one constant block are reported as not constant.
+    [[nodiscard]] bool IsConstant(uint32_t mip, dm::int2 minTexel, dm::int2 maxTexel) const;
+
+private:
+    struct ConstantBlocks
+    {
+        dm::int2 blocks = 0;
+        std::vector<uint32_t> bits;     // row-major, one bit per block
+
+        [[nodiscard]] bool Get(dm::int2 block) const;
+    };
+
+    void BuildConstantBlocks();
+
+    std::vector<CpuImage> m_Mips;
+    std::vector<ConstantBlocks> m_ConstantBlocks;   // mip * STF_CONSTANT_FOOTPRINT_LEVELS + level
+};
+
+// One texel chosen by the stochastic filter
+struct StfCpuTap
+{
+    uint32_t mip = 0;
+    dm::int2 texel = 0;
+    float weight = 1.f;     // the tap returns the texel times weight, not 1 only for custom kernels with negative lobes
+};
+
+// CPU version of the single-lane STF_SamplerState path: a stochastic mip choice between the two nearest levels,
+// then one texel drawn with probability equal to its weight in the linear, cubic B-spline or Gaussian filter, or
+// by the magnitude of its weight in the custom kernel of filterKernel (stf_filter_kernel.hlsli).
+// Custom kernels select the level of detail isotropically and never take the constant footprint early-out, and so do
+// Gaussians wider than sigmaLodTarget, which move to a coarser mip with an equivalent sigma (stf_sigma_lod.h).
+// Gradient taps with ewaEnabled move to a Gaussian distributed position in the elliptical footprint
+// of stf_ewa.h; the other aniso methods move along the longer derivative.
+// The magnification methods that share texels across the lanes of a wave are ignored here, which is what
+// STF_MAGNIFICATION_METHOD_NONE does on the GPU; StfCpuSampleWaveGrad models them for whole waves.
+struct StfCpuSamplerState
+{
+    // (x, y) pick the texel, w picks the mip level, like STF_SamplerState::Create
+    dm::float4 u = dm::float4(0.5f);
+    uint32_t filterType = STF_FILTER_TYPE_LINEAR;
+    uint32_t addressMode = STF_ADDRESS_MODE_WRAP;
+    uint32_t anisoMethod = STF_ANISO_LOD_METHOD_DEFAULT;
+    bool ewaEnabled = false;            // EWA in place of anisoMethod on the gradient taps, see stf_ewa.h
+    float sigma = 0.7f;
+    float sigmaLodTarget = 0.f;         // 0 samples every sigma on the mip of the footprint
+    uint32_t filterKernel = STF_FILTER_KERNEL_LANCZOS2;
+    bool filterKernelEnabled = false;   // filterKernel in place of filterType
+    bool reseedOnSample = false;
+    bool constantFootprints = false;    // early-out of SampleGrad/Level, see GetConstantTapGrad
+
+    [[nodiscard]] StfCpuTap GetTapGrad(const StfCpuTexture& texture, dm::float2 uv, dm::float2 ddx, dm::float2 ddy) const;
+    [[nodiscard]] StfCpuTap GetTapLevel(const StfCpuTexture& texture, dm::float2 uv, float mipLevel) const;
+
+    // Whether the Gaussian is wide enough to move to a coarser mip, StfSigmaLod::IsEnabled
+    [[nodiscard]] bool IsSigmaLodEnabled() const;
+
+    // When every texel the filter can reach for any random numbers holds the same value, one of them, so the sample
+    // needs a single fetch and no random numbers. The reachable texels are bounded by the mips the level of detail
+    // selects between and the filter support around all positions the anisotropic tap can move to.
+    // stf_constant_footprint.hlsli is the GPU version.
+    [[nodiscard]] bool GetConstantTapGrad(const StfCpuTexture& texture, dm::float2 uv, dm::float2 ddx, dm::float2 ddy, StfCpuTap& tap) const;
+    [[nodiscard]] bool GetConstantTapLevel(const StfCpuTexture& texture, dm::float2 uv, float mipLevel, StfCpuTap& tap) const;
+
+    // Fetch the tap, then draw new random numbers when reseedOnSample is set. With constantFootprints, constant
+    // footprints return their value without drawing random numbers.
+    dm::float4 SampleGrad(const StfCpuTexture& texture, dm::float2 uv, dm::float2 ddx, dm::float2 ddy);
+    dm::float4 SampleLevel(const StfCpuTexture& texture, dm::float2 uv, float mipLevel);
+
+    // Draw new random numbers when reseedOnSample is set, after a sample that did not go through SampleGrad/Level
+    void Reseed();
+
+private:
+    [[nodiscard]] StfCpuTap GetTap(const StfCpuTexture& texture, dm::float2 uv, float mipLevel) const;
+    [[nodiscard]] bool GetConstantTap(const StfCpuTexture& texture, dm::float2 uvMin, dm::float2 uvMax, float mipLevel, StfCpuTap& tap) const;
+};
+
+// CPU version of StfSharedFootprint in stf_shared_footprint.hlsli. The tap of an STF sample depends on the texture
+// only through its base size and mip count, so the textures of a material sample that agree on both form one
+// footprint class: the tap is computed for the first texture of a class and the others load the same texel. Without
+// reseedOnSample this returns exactly what StfCpuSamplerState::SampleGrad/Level returns for every texture.
+class StfCpuSharedFootprint
+{
+public:
+    static constexpr uint32_t MaxClasses = 4;   // more classes compute their taps without sharing them
+
+    StfCpuSharedFootprint(const StfCpuSamplerState& state, dm::float2 uv, dm::float2 ddx, dm::float2 ddy);
+    StfCpuSharedFootprint(const StfCpuSamplerState& state, dm::float2 uv, float mipLevel);
+
+    [[nodiscard]] StfCpuTap GetTap(const StfCpuTexture& texture);
+
+    // Like GetTap, but constant footprints take the early-out of the sampler state first
+    dm::float4 Sample(const StfCpuTexture& texture);
+
+    // Taps computed so far, one per footprint class unless there were more than MaxClasses
+    [[nodiscard]] uint32_t GetFootprintCount() const { return m_FootprintCount; }
+
+private:
+    struct FootprintClass
+    {
+        dm::int2 size = 0;
+        uint32_t mipCount = 0;
+        StfCpuTap tap;
+    };
+
+    const StfCpuSamplerState& m_State;
+    dm::float2 m_Uv;
+    dm::float2 m_Ddx = 0.f;
+    dm::float2 m_Ddy = 0.f;
+    float m_MipLevel = 0.f;
+    bool m_ForceMipLevel = false;
+
+    FootprintClass m_Classes[MaxClasses];
+    uint32_t m_ClassCount = 0;
+    uint32_t m_FootprintCount = 0;
+};
+
+// CPU version of StfMultiTap in stf_multi_tap.hlsli: adaptive multi-tap STF averages the first tap with one or three
+// more taps where the first taps of the quad differ by more than threshold. The extra taps shift the random numbers
+// of the first tap by a rank-1 lattice and take the single-lane path without reseeding.
+struct StfCpuMultiTap
+{
+    uint32_t maxTaps = 1;       // 1 is off
+    float threshold = 0.1f;     // contrast for 2 taps, twice as much for 4, 0 always takes maxTaps
+
+    [[nodiscard]] bool IsEnabled() const { return maxTaps > 1; }
+    [[nodiscard]] uint32_t GetTapCount(float contrast) const;
+
+    // Largest per-channel range of the first taps, from their component-wise minimum and maximum
+    [[nodiscard]] static float GetContrast(dm::float4 minValue, dm::float4 maxValue);
+    [[nodiscard]] static dm::float4 GetTapRandom(dm::float4 u, uint32_t tap, uint32_t tapCount);
+
+    // The average of value, the first tap taken with the random numbers u, and tapCount - 1 more taps. A constant
+    // footprint took the early-out instead of the first tap and stays one tap, tapCount is set to 1 then.
+    [[nodiscard]] static dm::float4 AddTapsGrad(const StfCpuSamplerState& state, dm::float4 u, dm::float4 value, uint32_t& tapCount,
+        const StfCpuTexture& texture, dm::float2 uv, dm::float2 ddx, dm::float2 ddy);
+    [[nodiscard]] static dm::float4 AddTapsLevel(const StfCpuSamplerState& state, dm::float4 u, dm::float4 value, uint32_t& tapCount,
+        const StfCpuTexture& texture, dm::float2 uv, float mipLevel);
+};
+
+// One lane of a wave executing a Texture2DSample. Consecutive groups of 4 lanes are the quads of a pixel shader
+// wave in the order top-left, top-right, bottom-left, bottom-right.
+struct StfCpuWaveLane
+{
+    StfCpuSamplerState* state = nullptr;
+    dm::float2 uv = 0.f;
+    dm::float2 ddx = 0.f;
+    dm::float2 ddy = 0.f;
+    bool helper = false;        // helper lanes only exist for the derivatives, their result is discarded
+    bool stfEnabled = true;     // false samples with the hardware sampler
+    bool participates = true;   // false for lanes that already returned from the shader
+    dm::float4 result = 0.f;
+};
+
+// CPU model of the wave magnification methods, as the RTXTF library sources are not available to port:
+// under magnification the lanes load the texels of the union of their bilinear footprints cooperatively, one texel
+// per lane, and filter exactly when the union has no more texels than there are loading lanes.
+//  - MIN_MAX, MIN_MAX_V2: the union over the wave, from wave min/max of the footprints. V2 retries per quad.
+//  - MIN_MAX_HELPER, MIN_MAX_V2_HELPER: the same, but helper lanes only load and keep their footprints out.
+//  - 2x2_QUAD, 2x2_FINE, 2x2_FINE_TEMPORAL: per quad, helper lanes always take part like in quad intrinsics.
+// Helper lanes take part in the wave methods only with includeHelperLanes ([WaveOpsIncludeHelperLanes]).
+// Other methods, minified lanes and failed lanes take one stochastic tap like StfCpuSamplerState::SampleGrad.
+// Lanes whose sampler state takes the constant footprint early-out fetch their one texel before the magnification
+// methods run and do not take part in them, like lanes that branched around the sample on the GPU.
+// stats receives the counters of the STF lanes, the cooperative loads count as the texels of the footprint union.
+// fetches, when given, receives the texels the STF lanes load: the constant footprints, the footprint unions, then
+// the taps in lane order.
+void StfCpuSampleWaveGrad(const StfCpuTexture& texture, uint32_t magMethod, bool includeHelperLanes,
+    StfCpuWaveLane* lanes, uint32_t laneCount, StfSamplingCounters& stats, std::vector<StfCpuTap>* fetches = nullptr);
+
+// The hardware sampler the sample binds when STF is off: wrap addressing, bilinear within a level,
+// linear between levels. Anisotropic hardware filtering is approximated by its isotropic LOD.
+dm::float4 SampleHardwareLevel(const StfCpuTexture& texture, dm::float2 uv, float mipLevel);
+dm::float4 SampleHardwareGrad(const StfCpuTexture& texture, dm::float2 uv, dm::float2 ddx, dm::float2 ddy);
+
+// Deterministic EWA, the reference of ewaEnabled: the texels inside the ellipse of stf_ewa.h weighted
+// by its Gaussian, on the two mips around the level of detail of the minor axis and blended linearly between them.
+dm::float4 SampleEwaReference(const StfCpuTexture& texture, dm::float2 uv, dm::float2 ddx, dm::float2 ddy, uint32_t addressMode);
+
+// log2 of the larger footprint axis in texels of the base level
+float GetIsotropicLod(const StfCpuTexture& texture, dm::float2 ddx, dm::float2 ddy);
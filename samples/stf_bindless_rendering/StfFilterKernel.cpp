@@ -0,0 +1,258 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "StfFilterKernel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "stf_filter_kernel_cb.h"
+
+namespace
+{
+    constexpr float c_Pi = 3.14159265358979f;
+    constexpr float c_KaiserAlpha = 4.f;
+
+    float Sinc(float x)
+    {
+        if (std::abs(x) < 1e-6f)
+            return 1.f;
+        return std::sin(c_Pi * x) / (c_Pi * x);
+    }
+
+    // Modified Bessel function of the first kind of order 0, from its power series
+    float BesselI0(float x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+        const double quarterX2 = 0.25 * double(x) * double(x);
+        for (int k = 1; k < 32; k++)
+        {
+            term *= quarterX2 / (double(k) * double(k));
+            sum += term;
+            if (term < sum * 1e-12)
+                break;
+        }
+        return float(sum);
+    }
+
+    // Mitchell-Netravali cubic with B = C = 1/3
+    float Mitchell(float x)
+    {
+        const float B = 1.f / 3.f;
+        const float C = 1.f / 3.f;
+        x = std::abs(x);
+        const float x2 = x * x;
+        const float x3 = x2 * x;
+        if (x < 1.f)
+            return ((12.f - 9.f * B - 6.f * C) * x3 + (-18.f + 12.f * B + 6.f * C) * x2 + (6.f - 2.f * B)) / 6.f;
+        if (x < 2.f)
+            return ((-B - 6.f * C) * x3 + (6.f * B + 30.f * C) * x2 + (-12.f * B - 48.f * C) * x + (8.f * B + 24.f * C)) / 6.f;
+        return 0.f;
+    }
+
+    uint32_t AsUint(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    float AsFloat(uint32_t bits)
+    {
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+float EvaluateStfFilterKernel(uint32_t kernel, float x)
+{
+    const float radius = GetStfFilterKernelRadius(kernel);
+    if (std::abs(x) >= radius)
+        return 0.f;
+
+    switch (kernel)
+    {
+    case STF_FILTER_KERNEL_LANCZOS2:
+    case STF_FILTER_KERNEL_LANCZOS3:
+        return Sinc(x) * Sinc(x / radius);
+
+    case STF_FILTER_KERNEL_MITCHELL:
+        return Mitchell(x);
+
+    case STF_FILTER_KERNEL_KAISER:
+    {
+        const float r = x / radius;
+        return Sinc(x) * BesselI0(c_KaiserAlpha * std::sqrt(1.f - r * r)) / BesselI0(c_KaiserAlpha);
+    }
+
+    default:
+        assert(!"Not Implemented");
+        return 0.f;
+    }
+}
+
+float GetStfFilterKernelRadius(uint32_t kernel)
+{
+    switch (kernel)
+    {
+    case STF_FILTER_KERNEL_LANCZOS2: return 2.f;
+    case STF_FILTER_KERNEL_LANCZOS3: return 3.f;
+    case STF_FILTER_KERNEL_MITCHELL: return 2.f;
+    case STF_FILTER_KERNEL_KAISER: return 3.f;
+    default: return 1.f;
+    }
+}
+
+const char* GetStfFilterKernelName(uint32_t kernel)
+{
+    switch (kernel)
+    {
+    case STF_FILTER_KERNEL_LANCZOS2: return "Lanczos2";
+    case STF_FILTER_KERNEL_LANCZOS3: return "Lanczos3";
+    case STF_FILTER_KERNEL_MITCHELL: return "Mitchell";
+    case STF_FILTER_KERNEL_KAISER: return "Kaiser";
+    default: return "Unknown";
+    }
+}
+
+StfFilterKernelTable::StfFilterKernelTable(uint32_t kernel)
+    : m_Kernel(kernel)
+{
+    // Taps whose distance to a sample position in [0, 1] can be inside the radius
+    const int radius = int(std::ceil(GetStfFilterKernelRadius(kernel)));
+    m_FirstOffset = 1 - radius;
+    m_TapCount = uint32_t(2 * radius);
+    assert(m_TapCount <= STF_FILTER_KERNEL_MAX_TAPS);
+
+    m_Weights.resize((STF_FILTER_KERNEL_PHASES + 1) * m_TapCount);
+    m_GpuData.assign(STF_FILTER_KERNEL_SIZE, 0);
+    m_GpuData[0] = m_TapCount;
+    m_GpuData[1] = uint32_t(m_FirstOffset);
+    m_GpuData[2] = kernel;
+
+    for (uint32_t phase = 0; phase <= STF_FILTER_KERNEL_PHASES; phase++)
+    {
+        const float f = float(phase) / float(STF_FILTER_KERNEL_PHASES);
+        float* weights = &m_Weights[phase * m_TapCount];
+
+        float sum = 0.f;
+        for (uint32_t tap = 0; tap < m_TapCount; tap++)
+        {
+            weights[tap] = EvaluateStfFilterKernel(kernel, float(m_FirstOffset + int(tap)) - f);
+            sum += weights[tap];
+        }
+
+        float absSum = 0.f;
+        for (uint32_t tap = 0; tap < m_TapCount; tap++)
+        {
+            weights[tap] /= sum;
+            absSum += std::abs(weights[tap]);
+        }
+
+        // Vose's alias method: columns below the mean borrow the rest of their column from one above it
+        float probability[STF_FILTER_KERNEL_MAX_TAPS];
+        uint32_t alias[STF_FILTER_KERNEL_MAX_TAPS];
+        uint32_t small[STF_FILTER_KERNEL_MAX_TAPS];
+        uint32_t large[STF_FILTER_KERNEL_MAX_TAPS];
+        uint32_t smallCount = 0;
+        uint32_t largeCount = 0;
+        for (uint32_t tap = 0; tap < m_TapCount; tap++)
+        {
+            probability[tap] = std::abs(weights[tap]) / absSum * float(m_TapCount);
+            alias[tap] = tap;
+            if (probability[tap] < 1.f)
+                small[smallCount++] = tap;
+            else
+                large[largeCount++] = tap;
+        }
+
+        while (smallCount != 0 && largeCount != 0)
+        {
+            const uint32_t less = small[--smallCount];
+            const uint32_t more = large[--largeCount];
+            alias[less] = more;
+            probability[more] -= 1.f - probability[less];
+            if (probability[more] < 1.f)
+                small[smallCount++] = more;
+            else
+                large[largeCount++] = more;
+        }
+
+        // Rounding leaves columns that are full up to an epsilon
+        while (smallCount != 0)
+            probability[small[--smallCount]] = 1.f;
+        while (largeCount != 0)
+            probability[large[--largeCount]] = 1.f;
+
+        uint32_t* data = &m_GpuData[STF_FILTER_KERNEL_HEADER + phase * STF_FILTER_KERNEL_PHASE_STRIDE];
+        data[0] = AsUint(absSum);
+        for (uint32_t tap = 0; tap < m_TapCount; tap++)
+        {
+            const uint32_t negative = weights[tap] < 0.f ? 1 : 0;
+            const uint32_t aliasNegative = weights[alias[tap]] < 0.f ? 1 : 0;
+            data[1 + 2 * tap] = AsUint(probability[tap]);
+            data[2 + 2 * tap] = alias[tap] | (negative << 8) | (aliasNegative << 9);
+        }
+    }
+}
+
+const StfFilterKernelTable& StfFilterKernelTable::Get(uint32_t kernel)
+{
+    static const StfFilterKernelTable tables[STF_FILTER_KERNEL_COUNT] = {
+        StfFilterKernelTable(STF_FILTER_KERNEL_LANCZOS2),
+        StfFilterKernelTable(STF_FILTER_KERNEL_LANCZOS3),
+        StfFilterKernelTable(STF_FILTER_KERNEL_MITCHELL),
+        StfFilterKernelTable(STF_FILTER_KERNEL_KAISER)
+    };
+    return tables[std::min<uint32_t>(kernel, STF_FILTER_KERNEL_COUNT - 1)];
+}
+
+float StfFilterKernelTable::GetWeight(uint32_t phase, uint32_t tap) const
+{
+    return m_Weights[phase * m_TapCount + tap];
+}
+
+int StfFilterKernelTable::SampleAxis(float f, float u, float& weight) const
+{
+    // Pick one of the two phases around f, then reuse the rest of u
+    const float position = f * float(STF_FILTER_KERNEL_PHASES);
+    const uint32_t lower = std::min(uint32_t(position), uint32_t(STF_FILTER_KERNEL_PHASES - 1));
+    const float t = position - float(lower);
+
+    uint32_t phase = lower;
+    if (u < t)
+    {
+        phase = lower + 1;
+        u = u / t;
+    }
+    else
+    {
+        u = (u - t) / (1.f - t);
+    }
+    u = std::min(u, 0.99999994f);
+
+    const float scaled = u * float(m_TapCount);
+    const uint32_t column = std::min(uint32_t(scaled), m_TapCount - 1);
+    const float coin = scaled - float(column);
+
+    const uint32_t* data = &m_GpuData[STF_FILTER_KERNEL_HEADER + phase * STF_FILTER_KERNEL_PHASE_STRIDE];
+    const uint32_t entry = data[2 + 2 * column];
+    const bool keep = coin < AsFloat(data[1 + 2 * column]);
+    const uint32_t tap = keep ? column : (entry & 0xff);
+    const bool negative = ((entry >> (keep ? 8 : 9)) & 1) != 0;
+
+    const float absSum = AsFloat(data[0]);
+    weight = negative ? -absSum : absSum;
+    return m_FirstOffset + int(tap);
+}
@@ -0,0 +1,59 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Importance sampling tables of the separable STF_FILTER_KERNEL_* kernels of stf_filter_kernel.hlsli. For every
+// phase of stf_filter_kernel_cb.h the weights of the taps around the sample are normalized to sum to 1 and turned
+// into a Walker alias table over their absolute values, so one tap is drawn in constant time with one random number.
+// Kernels with negative lobes are sampled by the magnitude of their weights and the tap carries the sign of its
+// weight times the sum of the magnitudes: the expectation is the filtered value, at a higher variance than for
+// positive kernels. The tables are built once per kernel; stf_filter_kernel.hlsli samples the same layout.
+class StfFilterKernelTable
+{
+public:
+    explicit StfFilterKernelTable(uint32_t kernel);
+
+    // The table of a kernel, built on first use
+    static const StfFilterKernelTable& Get(uint32_t kernel);
+
+    [[nodiscard]] uint32_t GetKernel() const { return m_Kernel; }
+    [[nodiscard]] uint32_t GetTapCount() const { return m_TapCount; }
+    [[nodiscard]] int GetFirstOffset() const { return m_FirstOffset; }
+
+    // Normalized weight of a tap of a phase, for validation
+    [[nodiscard]] float GetWeight(uint32_t phase, uint32_t tap) const;
+
+    // One axis: the offset of the tap from the texel below the sample position at the fractional position f, and
+    // its signed weight. StfFilterKernel::SampleAxis in stf_filter_kernel.hlsli is the GPU version.
+    [[nodiscard]] int SampleAxis(float f, float u, float& weight) const;
+
+    // STF_FILTER_KERNEL_SIZE uints in the layout of stf_filter_kernel_cb.h
+    [[nodiscard]] const std::vector<uint32_t>& GetGpuData() const { return m_GpuData; }
+
+private:
+    uint32_t m_Kernel = 0;
+    uint32_t m_TapCount = 0;
+    int m_FirstOffset = 0;
+    std::vector<float> m_Weights;       // phase-major
+    std::vector<uint32_t> m_GpuData;
+};
+
+// The kernel at a distance of x texels from the sample position, not normalized
+float EvaluateStfFilterKernel(uint32_t kernel, float x);
+
+// Distance beyond which the kernel is 0
+float GetStfFilterKernelRadius(uint32_t kernel);
+
+// Name of an STF_FILTER_KERNEL_* value as used in the sweep files
+const char* GetStfFilterKernelName(uint32_t kernel);
@@ -0,0 +1,79 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "StfSamplingStats.h"
+
+#include "../../libraries/RTXTF-Library/STFDefinitions.h"
+
+#include <fstream>
+
+void StfSamplingStats::Add(uint32_t texture, uint32_t magMethod, const StfSamplingCounters& counters)
+{
+    m_Entries[Key(texture, magMethod)].Add(counters);
+}
+
+StfSamplingCounters StfSamplingStats::GetTotal(uint32_t magMethod) const
+{
+    StfSamplingCounters total;
+    for (const auto& [key, counters] : m_Entries)
+    {
+        if (magMethod == ~0u || key.second == magMethod)
+            total.Add(counters);
+    }
+    return total;
+}
+
+bool StfSamplingStats::WriteCsv(const std::filesystem::path& fileName, const std::function<std::string(uint32_t)>& textureName) const
+{
+    std::ofstream file(fileName);
+    if (!file.is_open())
+        return false;
+
+    file << "texture,magMethod,samples,magnifiedSamples,waveFilteredSamples,quadFilteredSamples,fallbackSamples,"
+            "texelsFetched,sharingLanes,waves,distinctTexels,constantSamples,extraTaps,fallbackRate,texelsPerSample,"
+            "distinctTexelsPerWave,constantRate,tapsPerSample\n";
+
+    for (const auto& [key, counters] : m_Entries)
+    {
+        std::string name = textureName ? textureName(key.first) : std::string();
+        if (name.empty())
+            name = std::to_string(key.first);
+
+        file << name << "," << GetStfMagMethodName(key.second) << ","
+            << counters.samples << "," << counters.magnifiedSamples << "," << counters.waveFilteredSamples << ","
+            << counters.quadFilteredSamples << "," << counters.fallbackSamples << "," << counters.texelsFetched << ","
+            << counters.sharingLanes << "," << counters.waves << "," << counters.distinctTexels << "," << counters.constantSamples << ","
+            << counters.extraTaps << "," << counters.GetFallbackRate() << "," << counters.GetTexelsPerSample() << "," << counters.GetDistinctTexelsPerWave() << ","
+            << counters.GetConstantRate() << "," << counters.GetTapsPerSample() << "\n";
+    }
+
+    return file.good();
+}
+
+const char* GetStfMagMethodName(uint32_t magMethod)
+{
+    switch (magMethod)
+    {
+    case STF_MAGNIFICATION_METHOD_NONE: return "Default";
+    case STF_MAGNIFICATION_METHOD_2x2_QUAD: return "Quad2x2";
+    case STF_MAGNIFICATION_METHOD_2x2_FINE: return "Fine2x2";
+    case STF_MAGNIFICATION_METHOD_2x2_FINE_TEMPORAL: return "FineTemporal2x2";
+    case STF_MAGNIFICATION_METHOD_3x3_FINE_ALU: return "FineAlu3x3";
+    case STF_MAGNIFICATION_METHOD_3x3_FINE_LUT: return "FineLut3x3";
+    case STF_MAGNIFICATION_METHOD_4x4_FINE: return "Fine4x4";
+    case STF_MAGNIFICATION_METHOD_MIN_MAX: return "MinMax";
+    case STF_MAGNIFICATION_METHOD_MIN_MAX_HELPER: return "MinMaxHelper";
+    case STF_MAGNIFICATION_METHOD_MIN_MAX_V2: return "MinMaxV2";
+    case STF_MAGNIFICATION_METHOD_MIN_MAX_V2_HELPER: return "MinMaxV2Helper";
+    case STF_MAGNIFICATION_METHOD_MASK: return "Mask";
+    case STF_MAGNIFICATION_METHOD_MASK2: return "Mask2";
+    default: return "Unknown";
+    }
+}
@@ -0,0 +1,82 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+
+// Counters of STF texture samples, filled by StfCpuSampleWaveGrad and by the GPU passes through the stats buffer
+// of stf_stats.hlsli. Helper lanes fetch texels but are not counted as samples.
+struct StfSamplingCounters
+{
+    uint64_t samples = 0;               // STF samples of non-helper lanes
+    uint64_t magnifiedSamples = 0;      // of those, at a level of detail <= 0
+    uint64_t waveFilteredSamples = 0;   // magnified, bilinear from texels shared across the wave
+    uint64_t quadFilteredSamples = 0;   // magnified, bilinear from texels shared within the quad
+    uint64_t fallbackSamples = 0;       // magnified, but one stochastic tap because the footprints did not fit
+    uint64_t texelsFetched = 0;         // loads of all lanes, cooperative loads included
+    uint64_t sharingLanes = 0;          // lanes that loaded texels for a wave or quad filter
+    uint64_t waves = 0;                 // sample instructions executed by a wave with at least one STF lane
+    uint64_t distinctTexels = 0;        // distinct texels fetched per wave, summed over the waves
+    uint64_t constantSamples = 0;       // one fetch without random numbers, the footprint was constant
+    uint64_t extraTaps = 0;             // taps after the first of adaptive multi-tap STF, also in texelsFetched
+
+    void Add(const StfSamplingCounters& other)
+    {
+        samples += other.samples;
+        magnifiedSamples += other.magnifiedSamples;
+        waveFilteredSamples += other.waveFilteredSamples;
+        quadFilteredSamples += other.quadFilteredSamples;
+        fallbackSamples += other.fallbackSamples;
+        texelsFetched += other.texelsFetched;
+        sharingLanes += other.sharingLanes;
+        waves += other.waves;
+        distinctTexels += other.distinctTexels;
+        constantSamples += other.constantSamples;
+        extraTaps += other.extraTaps;
+    }
+
+    [[nodiscard]] double GetFallbackRate() const { return magnifiedSamples ? double(fallbackSamples) / double(magnifiedSamples) : 0.0; }
+    [[nodiscard]] double GetTexelsPerSample() const { return samples ? double(texelsFetched) / double(samples) : 0.0; }
+    [[nodiscard]] double GetDistinctTexelsPerWave() const { return waves ? double(distinctTexels) / double(waves) : 0.0; }
+    [[nodiscard]] double GetConstantRate() const { return samples ? double(constantSamples) / double(samples) : 0.0; }
+    [[nodiscard]] double GetTapsPerSample() const { return samples ? 1.0 + double(extraTaps) / double(samples) : 0.0; }
+};
+
+// Counters per texture and STF_MAGNIFICATION_METHOD_*, so sweeps over the magnification method keep them apart.
+// Textures are identified by an index, the scene texture on the CPU and the bindless descriptor on the GPU.
+class StfSamplingStats
+{
+public:
+    using Key = std::pair<uint32_t, uint32_t>;  // texture, magnification method
+
+    void Clear() { m_Entries.clear(); }
+    void Add(uint32_t texture, uint32_t magMethod, const StfSamplingCounters& counters);
+
+    [[nodiscard]] bool IsEmpty() const { return m_Entries.empty(); }
+    [[nodiscard]] const std::map<Key, StfSamplingCounters>& GetEntries() const { return m_Entries; }
+
+    // Sum over all textures of one method, or of all methods when magMethod is ~0u
+    [[nodiscard]] StfSamplingCounters GetTotal(uint32_t magMethod = ~0u) const;
+
+    // One row per texture and method; textureName may be empty, then the index is written instead
+    bool WriteCsv(const std::filesystem::path& fileName, const std::function<std::string(uint32_t)>& textureName) const;
+
+private:
+    std::map<Key, StfSamplingCounters> m_Entries;
+};
+
+// Name of an STF_MAGNIFICATION_METHOD_* value as used in the sweep files
+const char* GetStfMagMethodName(uint32_t magMethod);
@@ -0,0 +1,897 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "SweepConfig.h"
+#include "UserInterface.h"
+
+#include <json/json.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <set>
+#include <sstream>
+
+using namespace donut::math;
+
+// Must match the order of GetSweepFields()
+enum SweepFieldId
+{
+    SweepField_SamplerType,
+    SweepField_StfLoad,
+    SweepField_AllowHelperLanes,
+    SweepField_DeferredTexels,
+    SweepField_FilterMode,
+    SweepField_FilterKernel,
+    SweepField_MagMethod,
+    SweepField_FallbackMethod,
+    SweepField_MinMethod,
+    SweepField_MipLevelOverride,
+    SweepField_AddressMode,
+    SweepField_Sigma,
+    SweepField_SigmaLod,
+    SweepField_SigmaLodTarget,
+    SweepField_ReseedOnSample,
+    SweepField_UseWhiteNoise,
+    SweepField_TemporalStrata,
+    SweepField_DecorrelateTextures,
+    SweepField_ShareFootprints,
+    SweepField_ConstantFootprints,
+    SweepField_MaxTaps,
+    SweepField_TapContrast,
+    SweepField_PipelineType,
+    SweepField_GroupSize,
+    SweepField_LaneLayout,
+    SweepField_GroupSwizzle,
+    SweepField_GroupSwizzleSize,
+    SweepField_AaMode,
+#if ENABLE_DLSS
+    SweepField_DlssQuality,
+#endif
+    SweepField_Count
+};
+
+const std::vector<SweepFieldDesc>& GetSweepFields()
+{
+    static const std::vector<SweepFieldDesc> fields = {
+        { "samplerType",      SweepFieldType::Enum,  { "HW", "STF", "SplitScreen" }, 0.f, 0.f, true },
+        { "stfLoad",          SweepFieldType::Bool,  {}, 0.f, 1.f, true },
+        { "allowHelperLanes", SweepFieldType::Bool,  {}, 0.f, 1.f, true },
+        { "deferredTexels",   SweepFieldType::Bool,  {}, 0.f, 1.f, true },
+        { "filterMode",       SweepFieldType::Enum,  { "Linear", "Cubic", "Gaussian", "Custom" }, 0.f, 0.f, false },
+        { "filterKernel",     SweepFieldType::Enum,  { "Lanczos2", "Lanczos3", "Mitchell", "Kaiser" }, 0.f, 0.f, false },
+        { "magMethod",        SweepFieldType::Enum,  { "Default", "Quad2x2", "Fine2x2", "FineTemporal2x2", "FineAlu3x3", "FineLut3x3", "Fine4x4",
+                                                       "MinMax", "MinMaxHelper", "MinMaxV2", "MinMaxV2Helper", "Mask", "Mask2" }, 0.f, 0.f, false },
+        { "fallbackMethod",   SweepFieldType::Enum,  { "BL1STFILTER_FAST", "Debug" }, 0.f, 0.f, false },
+        { "minMethod",        SweepFieldType::Enum,  { "Aniso", "ForceNegInf", "ForcePosInf", "ForceNan", "ForceCustom", "Ewa" }, 0.f, 0.f, false },
+        { "mipLevelOverride", SweepFieldType::Float, {}, -100.f, 100.f, false },
+        { "addressMode",      SweepFieldType::Enum,  { "SameAsSampler", "Clamp", "Wrap" }, 0.f, 0.f, false },
+        { "sigma",            SweepFieldType::Float, {}, 0.f, 100.f, false },
+        { "sigmaLod",         SweepFieldType::Bool,  {}, 0.f, 1.f, false },
+        { "sigmaLodTarget",   SweepFieldType::Float, {}, 0.25f, 4.f, false },
+        { "reseedOnSample",   SweepFieldType::Bool,  {}, 0.f, 1.f, false },
+        { "useWhiteNoise",    SweepFieldType::Bool,  {}, 0.f, 1.f, false },
+        { "temporalStrata",   SweepFieldType::Int,   {}, 1.f, 16.f, false },
+        { "decorrelateTextures", SweepFieldType::Bool, {}, 0.f, 1.f, false },
+        { "shareFootprints",  SweepFieldType::Bool,  {}, 0.f, 1.f, false },
+        { "constantFootprints", SweepFieldType::Bool, {}, 0.f, 1.f, false },
+        { "maxTaps",          SweepFieldType::Int,   {}, 1.f, 4.f, false },
+        { "tapContrast",      SweepFieldType::Float, {}, 0.f, 1.f, false },
+        { "pipelineType",     SweepFieldType::Enum,  { "RayGen", "Compute", "Raster" }, 0.f, 0.f, true },
+        { "groupSize",        SweepFieldType::Enum,  { "8x8", "16x8", "8x16", "16x16" }, 0.f, 0.f, true },
+        { "laneLayout",       SweepFieldType::Enum,  { "None", "RowLinear16x2", "QuadZ16x2" }, 0.f, 0.f, false },
+        { "groupSwizzle",     SweepFieldType::Enum,  { "None", "Morton", "ColumnStrips" }, 0.f, 0.f, false },
+        { "swizzleSize",      SweepFieldType::Int,   {}, 1.f, 64.f, false },
+#if ENABLE_DLSS
+        { "aaMode",           SweepFieldType::Enum,  { "None", "TAA", "DLSS" }, 0.f, 0.f, false },
+        { "dlssQuality",      SweepFieldType::Enum,  { "MaxPerf", "Balanced", "MaxQuality", "UltraPerformance", "DLAA" }, 0.f, 0.f, false },
+#else
+        { "aaMode",           SweepFieldType::Enum,  { "None", "TAA" }, 0.f, 0.f, false },
+#endif
+    };
+
+    static_assert((int)StfMagMethod::Count == 13);
+    static_assert((int)StfFallbackMethod::Count == 2);
+    assert(fields.size() == SweepField_Count);
+
+    return fields;
+}
+
+int FindSweepField(const std::string& name)
+{
+    const auto& fields = GetSweepFields();
+    for (size_t i = 0; i < fields.size(); i++)
+    {
+        if (name == fields[i].name)
+            return int(i);
+    }
+    return -1;
+}
+
+static double GetSweepFieldValue(const UIData& ui, int field)
+{
+    switch (field)
+    {
+    case SweepField_SamplerType: return double(ui.samplerType);
+    case SweepField_StfLoad: return ui.stfLoad ? 1.0 : 0.0;
+    case SweepField_AllowHelperLanes: return ui.allowHelperLanesInWaveIntrinsics ? 1.0 : 0.0;
+    case SweepField_DeferredTexels: return ui.stfDeferredTexels ? 1.0 : 0.0;
+    case SweepField_FilterMode: return double(ui.stfFilterMode);
+    case SweepField_FilterKernel: return double(ui.stfFilterKernel);
+    case SweepField_MagMethod: return double(ui.stfMagnificationMethod);
+    case SweepField_FallbackMethod: return double(ui.stfFallbackMethod);
+    case SweepField_MinMethod: return double(ui.stfMinificationMethod);
+    case SweepField_MipLevelOverride: return ui.stfMipLevelOverride;
+    case SweepField_AddressMode: return double(ui.stfAddressMode);
+    case SweepField_Sigma: return ui.stfSigma;
+    case SweepField_SigmaLod: return ui.stfSigmaLod ? 1.0 : 0.0;
+    case SweepField_SigmaLodTarget: return ui.stfSigmaLodTarget;
+    case SweepField_ReseedOnSample: return ui.stfReseedOnSample ? 1.0 : 0.0;
+    case SweepField_UseWhiteNoise: return ui.stfUseWhiteNoise ? 1.0 : 0.0;
+    case SweepField_TemporalStrata: return double(ui.stfTemporalStrata);
+    case SweepField_DecorrelateTextures: return ui.stfDecorrelateTextures ? 1.0 : 0.0;
+    case SweepField_ShareFootprints: return ui.stfShareFootprints ? 1.0 : 0.0;
+    case SweepField_ConstantFootprints: return ui.stfConstantFootprints ? 1.0 : 0.0;
+    case SweepField_MaxTaps: return double(ui.stfMaxTaps);
+    case SweepField_TapContrast: return ui.stfTapContrast;
+    case SweepField_PipelineType: return double(ui.stfPipelineType);
+    case SweepField_GroupSize: return double(ui.stfGroupSize);
+    case SweepField_LaneLayout: return double(ui.stfWaveLaneLayoutOverride);
+    case SweepField_GroupSwizzle: return double(ui.stfGroupSwizzle);
+    case SweepField_GroupSwizzleSize: return double(ui.stfGroupSwizzleSize);
+    case SweepField_AaMode: return double(ui.aaMode);
+#if ENABLE_DLSS
+    case SweepField_DlssQuality: return double(ui.qualityMode);
+#endif
+    default:
+        assert(!"Not Implemented");
+        return 0.0;
+    }
+}
+
+static void SetSweepFieldValue(UIData& ui, int field, double value)
+{
+    const int i = int(value);
+    const bool b = value != 0.0;
+    const float f = float(value);
+
+    switch (field)
+    {
+    case SweepField_SamplerType: ui.samplerType = SamplerType(i); break;
+    case SweepField_StfLoad: ui.stfLoad = b; break;
+    case SweepField_AllowHelperLanes: ui.allowHelperLanesInWaveIntrinsics = b; break;
+    case SweepField_DeferredTexels: ui.stfDeferredTexels = b; break;
+    case SweepField_FilterMode: ui.stfFilterMode = StfFilterMode(i); break;
+    case SweepField_FilterKernel: ui.stfFilterKernel = StfFilterKernel(i); break;
+    case SweepField_MagMethod: ui.stfMagnificationMethod = StfMagMethod(i); break;
+    case SweepField_FallbackMethod: ui.stfFallbackMethod = StfFallbackMethod(i); break;
+    case SweepField_MinMethod: ui.stfMinificationMethod = StfMinMethod(i); break;
+    case SweepField_MipLevelOverride: ui.stfMipLevelOverride = f; break;
+    case SweepField_AddressMode: ui.stfAddressMode = StfAddressMode(i); break;
+    case SweepField_Sigma: ui.stfSigma = f; break;
+    case SweepField_SigmaLod: ui.stfSigmaLod = b; break;
+    case SweepField_SigmaLodTarget: ui.stfSigmaLodTarget = f; break;
+    case SweepField_ReseedOnSample: ui.stfReseedOnSample = b; break;
+    case SweepField_UseWhiteNoise: ui.stfUseWhiteNoise = b; break;
+    case SweepField_TemporalStrata: ui.stfTemporalStrata = i; break;
+    case SweepField_DecorrelateTextures: ui.stfDecorrelateTextures = b; break;
+    case SweepField_ShareFootprints: ui.stfShareFootprints = b; break;
+    case SweepField_ConstantFootprints: ui.stfConstantFootprints = b; break;
+    case SweepField_MaxTaps: ui.stfMaxTaps = i; break;
+    case SweepField_TapContrast: ui.stfTapContrast = f; break;
+    case SweepField_PipelineType: ui.stfPipelineType = StfPipelineType(i); break;
+    case SweepField_GroupSize: ui.stfGroupSize = StfThreadGroupSize(i); break;
+    case SweepField_LaneLayout: ui.stfWaveLaneLayoutOverride = StfWaveLaneLayout(i); break;
+    case SweepField_GroupSwizzle: ui.stfGroupSwizzle = StfGroupSwizzle(i); break;
+    case SweepField_GroupSwizzleSize: ui.stfGroupSwizzleSize = i; break;
+    case SweepField_AaMode: ui.aaMode = AntiAliasingMode(i); break;
+#if ENABLE_DLSS
+    case SweepField_DlssQuality: ui.qualityMode = DLSSQualityModes(i); break;
+#endif
+    default:
+        assert(!"Not Implemented");
+    }
+}
+
+// Returns false if the field has no effect for the given state, mirroring how Render() and the shaders consume UIData
+static bool IsSweepFieldEffective(const UIData& ui, int field)
+{
+    const bool stfOn = GetStfOn(ui.samplerType);
+
+    switch (field)
+    {
+    case SweepField_StfLoad:
+    case SweepField_FilterMode:
+    case SweepField_MagMethod:
+    case SweepField_FallbackMethod:
+    case SweepField_ReseedOnSample:
+    case SweepField_UseWhiteNoise:
+    case SweepField_TemporalStrata:
+    case SweepField_DecorrelateTextures:
+    case SweepField_MaxTaps:
+        return stfOn;
+    case SweepField_TapContrast:
+        return stfOn && ui.stfMaxTaps > 1;
+    case SweepField_ShareFootprints:
+        return stfOn && ui.stfLoad && ui.stfMagnificationMethod == StfMagMethod::Default && !ui.stfReseedOnSample &&
+            !ui.stfDecorrelateTextures && ui.stfFilterMode != StfFilterMode::Custom;
+    case SweepField_ConstantFootprints:
+        return stfOn && ui.stfLoad && ui.stfFilterMode != StfFilterMode::Custom;
+    case SweepField_AllowHelperLanes:
+    case SweepField_DeferredTexels:
+        return stfOn && ui.stfPipelineType == StfPipelineType::Raster;
+    case SweepField_GroupSize:
+        return stfOn && ui.stfPipelineType == StfPipelineType::Compute;
+    case SweepField_GroupSwizzle:
+        return ui.stfPipelineType == StfPipelineType::Compute;
+    case SweepField_GroupSwizzleSize:
+        return ui.stfPipelineType == StfPipelineType::Compute && ui.stfGroupSwizzle != StfGroupSwizzle::None;
+    case SweepField_Sigma:
+    case SweepField_SigmaLod:
+        return stfOn && ui.stfFilterMode == StfFilterMode::Gaussian;
+    case SweepField_SigmaLodTarget:
+        return stfOn && ui.stfFilterMode == StfFilterMode::Gaussian && ui.stfSigmaLod;
+    case SweepField_FilterKernel:
+        return stfOn && ui.stfLoad && ui.stfFilterMode == StfFilterMode::Custom;
+    case SweepField_AddressMode:
+        return stfOn && ui.stfLoad;
+    case SweepField_MipLevelOverride:
+        return ui.stfMinificationMethod == StfMinMethod::ForceCustom;
+#if ENABLE_DLSS
+    case SweepField_DlssQuality:
+        return ui.aaMode == AntiAliasingMode::DLSS;
+#endif
+    default:
+        return true;
+    }
+}
+
+SweepCameraKeyframe SweepCameraPath::Evaluate(float t) const
+{
+    if (keyframes.empty())
+        return SweepCameraKeyframe{ float3(0.f, 1.8f, 0.f), float3(1.f, 1.8f, 0.f) };
+
+    if (keyframes.size() == 1)
+        return keyframes[0];
+
+    const float segments = float(keyframes.size() - 1);
+    const float x = saturate(t) * segments;
+    const size_t segment = std::min(size_t(x), keyframes.size() - 2);
+    const float alpha = x - float(segment);
+
+    const SweepCameraKeyframe& a = keyframes[segment];
+    const SweepCameraKeyframe& b = keyframes[segment + 1];
+
+    SweepCameraKeyframe result;
+    result.position = lerp(a.position, b.position, alpha);
+    result.target = lerp(a.target, b.target, alpha);
+    return result;
+}
+
+static bool ParseSweepValue(const SweepFieldDesc& desc, const Json::Value& node, SweepValue& value, std::string& error)
+{
+    switch (desc.type)
+    {
+    case SweepFieldType::Bool:
+        if (!node.isBool() && !node.isIntegral())
+        {
+            error = std::string("'") + desc.name + "' expects a boolean";
+            return false;
+        }
+        value.number = node.asBool() ? 1.0 : 0.0;
+        value.label = node.asBool() ? "true" : "false";
+        return true;
+
+    case SweepFieldType::Int:
+    case SweepFieldType::Float:
+        if (!node.isNumeric())
+        {
+            error = std::string("'") + desc.name + "' expects a number";
+            return false;
+        }
+        value.number = node.asDouble();
+        if (desc.type == SweepFieldType::Int)
+            value.number = std::round(value.number);
+        if (!std::isfinite(value.number) || value.number < desc.minValue || value.number > desc.maxValue)
+        {
+            std::ostringstream ss;
+            ss << "'" << desc.name << "' value " << value.number << " is outside of [" << desc.minValue << ", " << desc.maxValue << "]";
+            error = ss.str();
+            return false;
+        }
+        {
+            std::ostringstream ss;
+            ss << value.number;
+            value.label = ss.str();
+        }
+        return true;
+
+    case SweepFieldType::Enum:
+        if (node.isString())
+        {
+            const std::string text = node.asString();
+            for (size_t i = 0; i < desc.enumNames.size(); i++)
+            {
+                if (text == desc.enumNames[i])
+                {
+                    value.number = double(i);
+                    value.label = desc.enumNames[i];
+                    return true;
+                }
+            }
+        }
+        else if (node.isIntegral() && node.asInt() >= 0 && node.asUInt() < desc.enumNames.size())
+        {
+            value.number = double(node.asUInt());
+            value.label = desc.enumNames[node.asUInt()];
+            return true;
+        }
+        {
+            std::string options;
+            for (const char* name : desc.enumNames)
+                options += std::string(options.empty() ? "" : ", ") + name;
+            error = std::string("'") + desc.name + "' expects one of: " + options;
+        }
+        return false;
+    }
+
+    return false;
+}
+
+// 'nodeName' is the member of the spec, for the errors. Axes of a singleValued node take one value each.
+static bool ParseSweepAxes(const Json::Value& node, const char* nodeName, bool singleValued, std::vector<SweepAxis>& axes,
+    std::string& error)
+{
+    if (node.isNull())
+        return true;
+
+    if (!node.isObject())
+    {
+        error = std::string("'") + nodeName + "' must be an object";
+        return false;
+    }
+
+    const auto& fields = GetSweepFields();
+
+    for (const std::string& name : node.getMemberNames())
+    {
+        const int field = FindSweepField(name);
+        if (field < 0)
+        {
+            error = "Unknown UIData field '" + name + "'";
+            return false;
+        }
+
+        SweepAxis axis;
+        axis.field = field;
+
+        const Json::Value& valuesNode = node[name];
+        if (valuesNode.isArray())
+        {
+            if (singleValued && valuesNode.size() != 1)
+            {
+                error = std::string("'") + nodeName + "." + name + "' must have a single value";
+                return false;
+            }
+
+            for (const Json::Value& valueNode : valuesNode)
+            {
+                SweepValue value;
+                if (!ParseSweepValue(fields[field], valueNode, value, error))
+                    return false;
+                axis.values.push_back(value);
+            }
+        }
+        else
+        {
+            SweepValue value;
+            if (!ParseSweepValue(fields[field], valuesNode, value, error))
+                return false;
+            axis.values.push_back(value);
+        }
+
+        if (axis.values.empty())
+        {
+            error = "'" + name + "' has no values";
+            return false;
+        }
+
+        std::set<double> unique;
+        for (const SweepValue& value : axis.values)
+        {
+            if (!unique.insert(value.number).second)
+            {
+                error = "'" + name + "' lists '" + value.label + "' more than once";
+                return false;
+            }
+        }
+
+        axes.push_back(std::move(axis));
+    }
+
+    return true;
+}
+
+static bool ParseFloat3(const Json::Value& node, float3& value)
+{
+    if (!node.isArray() || node.size() != 3)
+        return false;
+
+    for (Json::ArrayIndex i = 0; i < 3; i++)
+    {
+        if (!node[i].isNumeric())
+            return false;
+        value[i] = node[i].asFloat();
+    }
+    return true;
+}
+
+static bool ParseFrameCount(const Json::Value& root, const char* name, uint32_t minValue, uint32_t& value, std::string& error)
+{
+    const Json::Value& node = root[name];
+    if (node.isNull())
+        return true;
+
+    if (!node.isIntegral() || node.asInt64() < int64_t(minValue) || node.asInt64() > int64_t(UINT32_MAX))
+    {
+        error = std::string("'") + name + "' must be an integer >= " + std::to_string(minValue);
+        return false;
+    }
+
+    value = node.asUInt();
+    return true;
+}
+
+bool ParseSweepSpec(const Json::Value& root, SweepSpec& spec, std::string& error)
+{
+    spec = SweepSpec();
+
+    if (!root.isObject())
+    {
+        error = "Sweep spec must be a JSON object";
+        return false;
+    }
+
+    if (root.isMember("name"))
+        spec.name = root["name"].asString();
+
+    if (root.isMember("output"))
+        spec.output = root["output"].asString();
+
+    const std::string mode = root.get("mode", "cartesian").asString();
+    if (mode == "cartesian")
+        spec.mode = SweepMode::Cartesian;
+    else if (mode == "random")
+        spec.mode = SweepMode::Random;
+    else
+    {
+        error = "'mode' must be 'cartesian' or 'random'";
+        return false;
+    }
+
+    if (!ParseFrameCount(root, "samples", 1, spec.sampleCount, error) ||
+        !ParseFrameCount(root, "seed", 0, spec.seed, error) ||
+        !ParseFrameCount(root, "warmupFrames", 0, spec.warmupFrames, error) ||
+        !ParseFrameCount(root, "frames", 1, spec.measureFrames, error) ||
+        !ParseFrameCount(root, "qualityFrames", 1, spec.qualityFrames, error))
+        return false;
+
+    if (spec.mode == SweepMode::Random && spec.sampleCount == 0)
+    {
+        error = "'random' mode requires 'samples'";
+        return false;
+    }
+
+    if (spec.sampleCount > MaxSweepConfigurations)
+    {
+        error = "'samples' must be at most " + std::to_string(MaxSweepConfigurations);
+        return false;
+    }
+
+    if (!ParseSweepAxes(root["base"], "base", true, spec.base, error))
+        return false;
+
+    if (!ParseSweepAxes(root["axes"], "axes", false, spec.axes, error))
+        return false;
+
+    if (!ParseSweepAxes(root["reference"], "reference", true, spec.reference, error))
+        return false;
+
+    if (root.isMember("reference") && spec.reference.empty())
+    {
+        error = "'reference' must set at least one field";
+        return false;
+    }
+
+    if (root.isMember("qualityFrames") && spec.qualityFrames > spec.measureFrames)
+    {
+        error = "'qualityFrames' must be at most 'frames'";
+        return false;
+    }
+
+    for (const SweepAxis& axis : spec.axes)
+    {
+        for (const SweepAxis& base : spec.base)
+        {
+            if (axis.field == base.field)
+            {
+                error = std::string("'") + GetSweepFields()[axis.field].name + "' is both in 'base' and 'axes'";
+                return false;
+            }
+        }
+    }
+
+    // Random mode draws from the product without listing it
+    const uint64_t configurationCount = GetSweepConfigurationCount(spec);
+    if (spec.mode == SweepMode::Cartesian && configurationCount > MaxSweepConfigurations)
+    {
+        error = "'axes' span " + (configurationCount == UINT64_MAX ? std::string("over 2^64") : std::to_string(configurationCount)) +
+            " configurations, more than " + std::to_string(MaxSweepConfigurations) + ", use 'mode': 'random' with 'samples'";
+        return false;
+    }
+
+    const Json::Value& keyframes = root["camera"]["keyframes"];
+    if (!keyframes.isNull())
+    {
+        if (!keyframes.isArray())
+        {
+            error = "'camera.keyframes' must be an array";
+            return false;
+        }
+
+        for (const Json::Value& keyframeNode : keyframes)
+        {
+            SweepCameraKeyframe keyframe;
+            if (!ParseFloat3(keyframeNode["position"], keyframe.position) || !ParseFloat3(keyframeNode["target"], keyframe.target))
+            {
+                error = "Camera keyframes need 'position' and 'target' as [x, y, z]";
+                return false;
+            }
+            spec.camera.keyframes.push_back(keyframe);
+        }
+    }
+
+    return true;
+}
+
+bool LoadSweepSpec(const std::filesystem::path& path, SweepSpec& spec, std::string& error)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        error = "Cannot open '" + path.generic_string() + "'";
+        return false;
+    }
+
+    Json::CharReaderBuilder builder;
+    Json::Value root;
+    std::string parseErrors;
+    if (!Json::parseFromStream(builder, file, &root, &parseErrors))
+    {
+        error = "Cannot parse '" + path.generic_string() + "': " + parseErrors;
+        return false;
+    }
+
+    if (!ParseSweepSpec(root, spec, error))
+    {
+        error = path.generic_string() + ": " + error;
+        return false;
+    }
+
+    return true;
+}
+
+uint64_t GetSweepConfigurationCount(const SweepSpec& spec)
+{
+    uint64_t total = 1;
+    for (const SweepAxis& axis : spec.axes)
+    {
+        const uint64_t count = axis.values.size();
+        if (total > UINT64_MAX / count)
+            return UINT64_MAX;
+        total *= count;
+    }
+    return total;
+}
+
+static SweepConfiguration DecodeSweepIndex(const SweepSpec& spec, uint64_t linearIndex)
+{
+    SweepConfiguration config;
+    config.valueIndices.resize(spec.axes.size());
+
+    // The last axis varies fastest so that the cartesian order reads like nested loops in the spec
+    for (size_t axis = spec.axes.size(); axis-- > 0; )
+    {
+        const uint64_t count = spec.axes[axis].values.size();
+        config.valueIndices[axis] = uint32_t(linearIndex % count);
+        linearIndex /= count;
+    }
+
+    return config;
+}
+
+// The value of every field that has an effect in the configuration, -1 for the others
+static std::vector<double> GetEffectiveSweepState(const SweepSpec& spec, const SweepConfiguration& config)
+{
+    UIData ui;
+    ApplySweepConfiguration(spec, config, ui);
+
+    std::vector<double> state(SweepField_Count);
+    for (int field = 0; field < SweepField_Count; field++)
+        state[field] = IsSweepFieldEffective(ui, field) ? GetSweepFieldValue(ui, field) : -1.0;
+    return state;
+}
+
+std::vector<SweepConfiguration> EnumerateSweep(const SweepSpec& spec)
+{
+    std::vector<SweepConfiguration> configs;
+    std::set<std::vector<double>> effectiveStates;
+
+    const uint64_t total = GetSweepConfigurationCount(spec);
+    if (total <= MaxSweepConfigurations)
+    {
+        // Small enough to list: every distinct configuration, then a seeded subset of them in random mode
+        for (uint64_t linearIndex = 0; linearIndex < total; linearIndex++)
+        {
+            SweepConfiguration config = DecodeSweepIndex(spec, linearIndex);
+            if (effectiveStates.insert(GetEffectiveSweepState(spec, config)).second)
+                configs.push_back(std::move(config));
+        }
+
+        if (spec.mode == SweepMode::Random && spec.sampleCount < configs.size())
+        {
+            // Partial Fisher-Yates shuffle
+            std::mt19937_64 rng(spec.seed);
+            for (size_t i = 0; i < spec.sampleCount; i++)
+            {
+                std::uniform_int_distribution<size_t> dist(i, configs.size() - 1);
+                std::swap(configs[i], configs[dist(rng)]);
+            }
+            configs.resize(spec.sampleCount);
+        }
+    }
+    else
+    {
+        // Random mode over a product too large to list, ParseSweepSpec rejects cartesian ones. Every axis draws its
+        // own value index, so that all axes are sampled uniformly, until there are enough distinct effective states.
+        // Many draws in a row without a new state mean that the effective states are exhausted.
+        std::mt19937_64 rng(spec.seed);
+        std::set<std::vector<uint32_t>> drawn;
+        uint32_t failedDraws = 0;
+
+        while (configs.size() < spec.sampleCount && failedDraws < MaxFailedSweepDraws)
+        {
+            SweepConfiguration config;
+            config.valueIndices.resize(spec.axes.size());
+            for (size_t axis = 0; axis < spec.axes.size(); axis++)
+            {
+                std::uniform_int_distribution<uint32_t> dist(0, uint32_t(spec.axes[axis].values.size() - 1));
+                config.valueIndices[axis] = dist(rng);
+            }
+
+            if (!drawn.insert(config.valueIndices).second || !effectiveStates.insert(GetEffectiveSweepState(spec, config)).second)
+            {
+                failedDraws++;
+                continue;
+            }
+
+            failedDraws = 0;
+            configs.push_back(std::move(config));
+        }
+    }
+
+    // Cartesian order, so that neighbouring configurations mostly share pipelines
+    std::sort(configs.begin(), configs.end(), [](const SweepConfiguration& a, const SweepConfiguration& b)
+    {
+        return a.valueIndices < b.valueIndices;
+    });
+
+    for (size_t i = 0; i < configs.size(); i++)
+        configs[i].index = uint32_t(i);
+
+    return configs;
+}
+
+static void ApplySweepFieldValue(int field, double value, UIData& ui)
+{
+    if (GetSweepFieldValue(ui, field) == value)
+        return;
+
+    SetSweepFieldValue(ui, field, value);
+
+    if (GetSweepFields()[field].requiresPipelineUpdate)
+        ui.stfPipelineUpdate = true;
+
+    if (field == SweepField_AaMode)
+        ui.aaModeChanged = true;
+#if ENABLE_DLSS
+    if (field == SweepField_DlssQuality)
+        ui.aaModeChanged = true;
+#endif
+}
+
+void ApplySweepConfiguration(const SweepSpec& spec, const SweepConfiguration& config, UIData& ui)
+{
+    for (const SweepAxis& axis : spec.base)
+        ApplySweepFieldValue(axis.field, axis.values[0].number, ui);
+
+    for (size_t i = 0; i < spec.axes.size(); i++)
+        ApplySweepFieldValue(spec.axes[i].field, spec.axes[i].values[config.valueIndices[i]].number, ui);
+}
+
+void ApplySweepReference(const SweepSpec& spec, UIData& ui)
+{
+    for (const SweepAxis& axis : spec.base)
+        ApplySweepFieldValue(axis.field, axis.values[0].number, ui);
+
+    for (const SweepAxis& axis : spec.reference)
+        ApplySweepFieldValue(axis.field, axis.values[0].number, ui);
+}
+
+bool IsSweepQualityFrame(const SweepSpec& spec, uint32_t frame)
+{
+    if (spec.reference.empty() || frame < spec.warmupFrames || frame >= spec.warmupFrames + spec.measureFrames)
+        return false;
+
+    // The last frame of each of qualityFrames equal parts of the measured frames
+    const uint32_t qualityFrames = std::min(spec.qualityFrames, spec.measureFrames);
+    const uint32_t step = spec.measureFrames / qualityFrames;
+    const uint32_t measured = frame - spec.warmupFrames + 1;
+    return measured % step == 0 && measured / step <= qualityFrames;
+}
+
+std::string GetSweepConfigurationLabel(const SweepSpec& spec, const SweepConfiguration& config)
+{
+    const auto& fields = GetSweepFields();
+
+    std::string label;
+    for (size_t i = 0; i < spec.axes.size(); i++)
+    {
+        if (!label.empty())
+            label += " ";
+        label += std::string(fields[spec.axes[i].field].name) + "=" + spec.axes[i].values[config.valueIndices[i]].label;
+    }
+    return label;
+}
+
+SweepSummary SummarizeSweepSamples(std::vector<float> samples)
+{
+    SweepSummary summary;
+    if (samples.empty())
+        return summary;
+
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0.0;
+    for (float sample : samples)
+        sum += sample;
+
+    summary.mean = float(sum / double(samples.size()));
+    summary.median = samples[samples.size() / 2];
+    summary.p95 = samples[std::min(samples.size() - 1, size_t(std::ceil(0.95 * double(samples.size()))) - 1)];
+    summary.min = samples.front();
+    summary.max = samples.back();
+    return summary;
+}
+
+static bool WriteSweepReportCsv(std::ofstream& file, const SweepSpec& spec, const std::vector<SweepResult>& results)
+{
+    const auto& fields = GetSweepFields();
+
+    file << "index";
+    for (const SweepAxis& axis : spec.axes)
+        file << "," << fields[axis.field].name;
+    file << ",frames,gpu_mean_ms,gpu_median_ms,gpu_p95_ms,gpu_min_ms,gpu_max_ms,cpu_mean_ms,cpu_median_ms";
+    file << ",quality_frames,psnr_db,ssim,flip\n";
+
+    for (const SweepResult& result : results)
+    {
+        const SweepSummary gpu = SummarizeSweepSamples(result.frames.gpuMilliseconds);
+        const SweepSummary cpu = SummarizeSweepSamples(result.frames.cpuMilliseconds);
+
+        file << result.config.index;
+        for (size_t i = 0; i < spec.axes.size(); i++)
+            file << "," << spec.axes[i].values[result.config.valueIndices[i]].label;
+        file << "," << result.frames.gpuMilliseconds.size()
+            << "," << gpu.mean << "," << gpu.median << "," << gpu.p95 << "," << gpu.min << "," << gpu.max
+            << "," << cpu.mean << "," << cpu.median;
+
+        // The quality of the configuration next to its times, the columns stay empty when nothing was compared
+        file << "," << result.frames.flip.size();
+        if (result.frames.flip.empty())
+            file << ",,,\n";
+        else
+        {
+            file << "," << SummarizeSweepSamples(result.frames.psnr).mean << "," << SummarizeSweepSamples(result.frames.ssim).mean
+                << "," << SummarizeSweepSamples(result.frames.flip).mean << "\n";
+        }
+    }
+
+    return file.good();
+}
+
+static bool WriteSweepReportJson(std::ofstream& file, const SweepSpec& spec, const std::vector<SweepResult>& results)
+{
+    const auto& fields = GetSweepFields();
+
+    Json::Value root;
+    root["name"] = spec.name;
+    root["warmupFrames"] = spec.warmupFrames;
+    root["frames"] = spec.measureFrames;
+
+    for (const SweepAxis& axis : spec.reference)
+        root["reference"][fields[axis.field].name] = axis.values[0].label;
+
+    Json::Value& resultsNode = root["results"];
+    resultsNode = Json::Value(Json::arrayValue);
+
+    for (const SweepResult& result : results)
+    {
+        Json::Value node;
+        node["index"] = result.config.index;
+
+        for (size_t i = 0; i < spec.axes.size(); i++)
+            node["settings"][fields[spec.axes[i].field].name] = spec.axes[i].values[result.config.valueIndices[i]].label;
+
+        auto writeSummary = [](Json::Value& dst, const SweepSummary& summary)
+        {
+            dst["mean"] = summary.mean;
+            dst["median"] = summary.median;
+            dst["p95"] = summary.p95;
+            dst["min"] = summary.min;
+            dst["max"] = summary.max;
+        };
+
+        writeSummary(node["gpuMilliseconds"], SummarizeSweepSamples(result.frames.gpuMilliseconds));
+        writeSummary(node["cpuMilliseconds"], SummarizeSweepSamples(result.frames.cpuMilliseconds));
+        node["frames"] = Json::UInt(result.frames.gpuMilliseconds.size());
+
+        if (!result.frames.flip.empty())
+        {
+            Json::Value& quality = node["quality"];
+            quality["frames"] = Json::UInt(result.frames.flip.size());
+            quality["psnr"] = SummarizeSweepSamples(result.frames.psnr).mean;
+            quality["ssim"] = SummarizeSweepSamples(result.frames.ssim).mean;
+            quality["flip"] = SummarizeSweepSamples(result.frames.flip).mean;
+        }
+
+        resultsNode.append(node);
+    }
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "    ";
+    std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+    writer->write(root, &file);
+    file << "\n";
+
+    return file.good();
+}
+
+bool WriteSweepReport(const std::filesystem::path& path, const SweepSpec& spec, const std::vector<SweepResult>& results, std::string& error)
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        error = "Cannot write '" + path.generic_string() + "'";
+        return false;
+    }
+
+    const bool json = path.extension() == ".json";
+    const bool success = json
+        ? WriteSweepReportJson(file, spec, results)
+        : WriteSweepReportCsv(file, spec, results);
+
+    if (!success)
+        error = "Failed writing '" + path.generic_string() + "'";
+
+    return success;
+}
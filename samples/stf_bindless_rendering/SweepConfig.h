@@ -0,0 +1,190 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <donut/core/math/math.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Json
+{
+    class Value;
+}
+
+struct UIData;
+
+// Settings sweep over UIData fields.
+// The spec is a JSON document, e.g.
+//
+// {
+//     "name": "sponza-ctf",
+//     "output": "stf_sweep.csv",
+//     "mode": "cartesian",            // or "random" together with "samples" and "seed"
+//     "warmupFrames": 30,
+//     "frames": 120,
+//     "base": { "aaMode": "TAA", "pipelineType": "Compute" },
+//     "reference": { "samplerType": "HW" },   // optional, see SweepSpec::reference
+//     "qualityFrames": 4,
+//     "axes": {
+//         "filterMode": [ "Linear", "Gaussian" ],
+//         "magMethod": [ "Default", "MinMaxV2", "Mask2" ],
+//         "groupSize": [ "8x8", "16x16" ]
+//     },
+//     "camera": { "keyframes": [ { "position": [0, 1.8, 0], "target": [1, 1.8, 0] },
+//                                { "position": [8, 1.8, 0], "target": [9, 1.5, 0.5] } ] }
+// }
+//
+// Parsing, validation and enumeration don't touch the device.
+
+enum class SweepFieldType
+{
+    Bool,
+    Int,
+    Float,
+    Enum,
+};
+
+struct SweepValue
+{
+    double number = 0.0;    // enum index, 0/1 for bools, or the numeric value
+    std::string label;      // canonical text used in reports
+};
+
+struct SweepAxis
+{
+    int field = -1;         // index into GetSweepFields()
+    std::vector<SweepValue> values;
+};
+
+struct SweepCameraKeyframe
+{
+    dm::float3 position;
+    dm::float3 target;
+};
+
+struct SweepCameraPath
+{
+    std::vector<SweepCameraKeyframe> keyframes;
+
+    // t in [0, 1] over the whole path, piecewise linear between keyframes
+    SweepCameraKeyframe Evaluate(float t) const;
+};
+
+enum class SweepMode
+{
+    Cartesian,
+    Random,
+};
+
+struct SweepSpec
+{
+    std::string name = "sweep";
+    std::filesystem::path output = "stf_sweep.csv";
+    SweepMode mode = SweepMode::Cartesian;
+    uint32_t sampleCount = 0;   // Random mode only
+    uint32_t seed = 0;
+    uint32_t warmupFrames = 30;
+    uint32_t measureFrames = 120;
+
+    std::vector<SweepAxis> base;    // single-valued axes applied before every configuration
+    std::vector<SweepAxis> axes;
+
+    // Single-valued axes of the reference, rendered along the same camera path before the configurations. Settings
+    // of the axes it does not list keep their values. Without a reference the report has no quality columns.
+    std::vector<SweepAxis> reference;
+    uint32_t qualityFrames = 4;     // measured frames per configuration compared against the reference, evenly spaced
+    SweepCameraPath camera;
+};
+
+// One point of the sweep: a value index per axis
+struct SweepConfiguration
+{
+    uint32_t index = 0;
+    std::vector<uint32_t> valueIndices;
+};
+
+struct SweepFieldDesc
+{
+    const char* name;
+    SweepFieldType type;
+    std::vector<const char*> enumNames;
+    float minValue;
+    float maxValue;
+    bool requiresPipelineUpdate;
+};
+
+// Upper bound of the configurations of a spec: of the cartesian product in cartesian mode, of 'samples' in random mode
+const uint32_t MaxSweepConfigurations = 65536;
+
+// Random mode stops drawing after this many draws in a row found no new configuration
+const uint32_t MaxFailedSweepDraws = 10000;
+
+const std::vector<SweepFieldDesc>& GetSweepFields();
+int FindSweepField(const std::string& name);
+
+bool ParseSweepSpec(const Json::Value& root, SweepSpec& spec, std::string& error);
+bool LoadSweepSpec(const std::filesystem::path& path, SweepSpec& spec, std::string& error);
+
+// Size of the cartesian product of the axes, UINT64_MAX when it does not fit
+uint64_t GetSweepConfigurationCount(const SweepSpec& spec);
+
+// Full cartesian product, or a seeded random subset of 'samples' configurations of it, with configurations that
+// differ only in settings that the rest of the configuration ignores (e.g. sigma for a linear filter) removed.
+// Random mode returns fewer configurations only when the product has fewer distinct ones. The result is in
+// cartesian order.
+std::vector<SweepConfiguration> EnumerateSweep(const SweepSpec& spec);
+
+// Writes the base values and then the configuration into 'ui'. Sets ui.stfPipelineUpdate / ui.aaModeChanged
+// when a field that needs it actually changed.
+void ApplySweepConfiguration(const SweepSpec& spec, const SweepConfiguration& config, UIData& ui);
+
+// Writes the base values and then the reference into 'ui', like ApplySweepConfiguration
+void ApplySweepReference(const SweepSpec& spec, UIData& ui);
+
+// True for the measured frames the quality is measured on, 'frame' counts the warmup frames too
+bool IsSweepQualityFrame(const SweepSpec& spec, uint32_t frame);
+
+std::string GetSweepConfigurationLabel(const SweepSpec& spec, const SweepConfiguration& config);
+
+struct SweepFrameStats
+{
+    std::vector<float> gpuMilliseconds;
+    std::vector<float> cpuMilliseconds;
+
+    // Of the quality frames against the reference, see ImageMetricsResult
+    std::vector<float> psnr;
+    std::vector<float> ssim;
+    std::vector<float> flip;
+};
+
+struct SweepResult
+{
+    SweepConfiguration config;
+    SweepFrameStats frames;
+};
+
+struct SweepSummary
+{
+    float mean = 0.f;
+    float median = 0.f;
+    float p95 = 0.f;
+    float min = 0.f;
+    float max = 0.f;
+};
+
+SweepSummary SummarizeSweepSamples(std::vector<float> samples);
+
+// Writes all results into one report, CSV or JSON depending on the file extension. Every row has the mean PSNR, SSIM
+// and FLIP of its quality frames next to its times, empty in CSV and left out of JSON when the spec has no reference.
+bool WriteSweepReport(const std::filesystem::path& path, const SweepSpec& spec, const std::vector<SweepResult>& results, std::string& error);
@@ -0,0 +1,253 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "SweepRunner.h"
+#include "UserInterface.h"
+
+#include <donut/app/Camera.h>
+#include <donut/core/log.h>
+
+#include <cstring>
+
+using namespace donut;
+
+SweepRunner::SweepRunner(nvrhi::IDevice* device, SweepSpec spec)
+    : m_Device(device)
+    , m_Spec(std::move(spec))
+    , m_Metrics(m_Pool)
+{
+    m_Configurations = EnumerateSweep(m_Spec);
+
+    m_Results.resize(m_Configurations.size());
+    for (size_t i = 0; i < m_Configurations.size(); i++)
+        m_Results[i].config = m_Configurations[i];
+
+    for (PendingQuery& pending : m_Queries)
+        pending.query = m_Device->createTimerQuery();
+
+    m_Finished = m_Configurations.empty();
+    m_ReferenceRun = !m_Spec.reference.empty();
+
+    log::info("Sweep '%s': %d configurations, %d warmup + %d measured frames each",
+        m_Spec.name.c_str(), int(m_Configurations.size()), int(m_Spec.warmupFrames), int(m_Spec.measureFrames));
+}
+
+bool SweepRunner::BeginFrame(UIData& ui, app::FirstPersonCamera& camera)
+{
+    if (m_Finished)
+        return false;
+
+    if (m_FrameInConfiguration == 0 && m_ReferenceRun)
+    {
+        ApplySweepReference(m_Spec, ui);
+
+        ui.enableAnimations = false;
+        ui.stfFreezeFrameIndex = false;
+        ui.showUI = false;
+
+        std::string label;
+        for (const SweepAxis& axis : m_Spec.reference)
+            label += std::string(label.empty() ? "" : " ") + GetSweepFields()[axis.field].name + "=" + axis.values[0].label;
+        log::info("Sweep reference %s", label.c_str());
+    }
+    else if (m_FrameInConfiguration == 0)
+    {
+        const SweepConfiguration& config = m_Configurations[m_Configuration];
+        ApplySweepConfiguration(m_Spec, config, ui);
+
+        ui.enableAnimations = false;
+        ui.stfFreezeFrameIndex = false;
+        ui.showUI = false;
+
+        log::info("Sweep [%d/%d] %s", int(m_Configuration + 1), int(m_Configurations.size()),
+            GetSweepConfigurationLabel(m_Spec, config).c_str());
+    }
+
+    // The path is replayed identically for every configuration
+    const uint32_t framesPerConfiguration = m_Spec.warmupFrames + m_Spec.measureFrames;
+    const float t = framesPerConfiguration > 1 ? float(m_FrameInConfiguration) / float(framesPerConfiguration - 1) : 0.f;
+    const SweepCameraKeyframe keyframe = m_Spec.camera.Evaluate(t);
+    camera.LookAt(keyframe.position, keyframe.target);
+
+    m_FrameStart = std::chrono::high_resolution_clock::now();
+
+    return true;
+}
+
+void SweepRunner::BeginGpuTimer(nvrhi::ICommandList* commandList)
+{
+    if (m_Finished)
+        return;
+
+    if (m_Queries[m_CurrentQuery].inFlight)
+        PollQueries(true);
+
+    commandList->beginTimerQuery(m_Queries[m_CurrentQuery].query);
+}
+
+void SweepRunner::EndGpuTimer(nvrhi::ICommandList* commandList)
+{
+    if (m_Finished)
+        return;
+
+    commandList->endTimerQuery(m_Queries[m_CurrentQuery].query);
+}
+
+void SweepRunner::CaptureFrame(nvrhi::ICommandList* commandList, nvrhi::ITexture* color)
+{
+    if (m_Finished || !IsSweepQualityFrame(m_Spec, m_FrameInConfiguration))
+        return;
+
+    const nvrhi::TextureDesc& colorDesc = color->getDesc();
+    if (colorDesc.format != nvrhi::Format::RGBA16_FLOAT)
+        return;
+
+    if (!m_CaptureTexture || m_CaptureTexture->getDesc().width != colorDesc.width || m_CaptureTexture->getDesc().height != colorDesc.height)
+    {
+        nvrhi::TextureDesc desc;
+        desc.width = colorDesc.width;
+        desc.height = colorDesc.height;
+        desc.format = colorDesc.format;
+        desc.debugName = "SweepCapture";
+        m_CaptureTexture = m_Device->createStagingTexture(desc, nvrhi::CpuAccessMode::Read);
+    }
+
+    commandList->copyTexture(m_CaptureTexture, nvrhi::TextureSlice(), color, nvrhi::TextureSlice());
+    m_CapturePending = true;
+}
+
+void SweepRunner::ReadCapture()
+{
+    m_CapturePending = false;
+
+    size_t rowPitch = 0;
+    const void* data = m_Device->mapStagingTexture(m_CaptureTexture, nvrhi::TextureSlice(), nvrhi::CpuAccessMode::Read, &rowPitch);
+    if (!data)
+        return;
+
+    const nvrhi::TextureDesc& desc = m_CaptureTexture->getDesc();
+    const size_t packedPitch = size_t(desc.width) * 8;
+    MetricImage frame;
+    frame.data = data;
+    frame.width = desc.width;
+    frame.height = desc.height;
+    frame.rowPitch = rowPitch;
+    frame.format = MetricImageFormat::Float16;
+
+    const uint32_t qualityFrame = m_QualityFrame++;
+    if (m_ReferenceRun)
+    {
+        m_ReferenceWidth = desc.width;
+        m_ReferenceHeight = desc.height;
+        std::vector<uint8_t>& pixels = m_ReferenceFrames.emplace_back(packedPitch * desc.height);
+        for (uint32_t y = 0; y < desc.height; y++)
+            memcpy(pixels.data() + packedPitch * y, static_cast<const uint8_t*>(data) + rowPitch * y, packedPitch);
+    }
+    else if (qualityFrame < m_ReferenceFrames.size())
+    {
+        MetricImage reference = frame;
+        reference.data = m_ReferenceFrames[qualityFrame].data();
+        reference.width = m_ReferenceWidth;
+        reference.height = m_ReferenceHeight;
+        reference.rowPitch = size_t(m_ReferenceWidth) * 8;
+
+        // Tone mapped like the display, MS-SSIM is not in the report
+        ImageMetricsOptions options;
+        options.hdr = true;
+        options.multiScaleSsim = false;
+
+        ImageMetricsResult result;
+        if (m_Metrics.Compare(frame, reference, options, result))
+        {
+            SweepFrameStats& frames = m_Results[m_Configuration].frames;
+            frames.psnr.push_back(float(result.psnr));
+            frames.ssim.push_back(float(result.ssim));
+            frames.flip.push_back(float(result.flip));
+        }
+        else
+            log::warning("Sweep: quality frame %d differs in size from the reference, not compared", int(qualityFrame));
+    }
+
+    m_Device->unmapStagingTexture(m_CaptureTexture);
+}
+
+void SweepRunner::EndFrame()
+{
+    if (m_Finished)
+        return;
+
+    const auto frameEnd = std::chrono::high_resolution_clock::now();
+
+    if (m_CapturePending)
+        ReadCapture();
+
+    PendingQuery& pending = m_Queries[m_CurrentQuery];
+    pending.configuration = m_Configuration;
+    pending.measured = !m_ReferenceRun && m_FrameInConfiguration >= m_Spec.warmupFrames;
+    pending.cpuMilliseconds = std::chrono::duration<float, std::milli>(frameEnd - m_FrameStart).count();
+    pending.inFlight = true;
+
+    m_CurrentQuery = (m_CurrentQuery + 1) % c_QueryCount;
+
+    m_FrameInConfiguration++;
+    if (m_FrameInConfiguration == m_Spec.warmupFrames + m_Spec.measureFrames)
+    {
+        m_FrameInConfiguration = 0;
+        m_QualityFrame = 0;
+
+        // The configurations follow the reference
+        if (m_ReferenceRun)
+            m_ReferenceRun = false;
+        else if (++m_Configuration == m_Configurations.size())
+        {
+            PollQueries(true);
+            m_Finished = true;
+            return;
+        }
+    }
+
+    PollQueries(false);
+}
+
+void SweepRunner::PollQueries(bool wait)
+{
+    for (PendingQuery& pending : m_Queries)
+    {
+        if (!pending.inFlight)
+            continue;
+
+        if (!wait && !m_Device->pollTimerQuery(pending.query))
+            continue;
+
+        const float gpuMilliseconds = m_Device->getTimerQueryTime(pending.query) * 1000.f;
+        m_Device->resetTimerQuery(pending.query);
+        pending.inFlight = false;
+
+        if (pending.measured)
+        {
+            SweepFrameStats& frames = m_Results[pending.configuration].frames;
+            frames.gpuMilliseconds.push_back(gpuMilliseconds);
+            frames.cpuMilliseconds.push_back(pending.cpuMilliseconds);
+        }
+    }
+}
+
+bool SweepRunner::WriteReport()
+{
+    std::string error;
+    if (!WriteSweepReport(m_Spec.output, m_Spec, m_Results, error))
+    {
+        log::error("%s", error.c_str());
+        return false;
+    }
+
+    log::info("Sweep report written to '%s'", m_Spec.output.generic_string().c_str());
+    return true;
+}
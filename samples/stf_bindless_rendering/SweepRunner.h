@@ -0,0 +1,97 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "ImageMetrics.h"
+#include "SweepConfig.h"
+#include "TaskGraph.h"
+
+#include <nvrhi/nvrhi.h>
+
+#include <array>
+#include <chrono>
+
+struct UIData;
+
+namespace donut::app
+{
+    class FirstPersonCamera;
+}
+
+// Drives the sample through every configuration of a SweepSpec: applies the settings, flies the scripted
+// camera path, skips warmup frames and records GPU/CPU frame times for the measured frames.
+// With a reference in the spec, the reference runs first along the same path and the quality frames of every
+// configuration are read back and compared against its frames with ImageMetrics.
+class SweepRunner
+{
+public:
+    SweepRunner(nvrhi::IDevice* device, SweepSpec spec);
+
+    // Called from Animate(). Returns false once all configurations are measured.
+    bool BeginFrame(UIData& ui, donut::app::FirstPersonCamera& camera);
+
+    // Bracket the GPU work of the frame
+    void BeginGpuTimer(nvrhi::ICommandList* commandList);
+    void EndGpuTimer(nvrhi::ICommandList* commandList);
+
+    // Copies the final color of a quality frame for EndFrame, after EndGpuTimer so the copy is not timed.
+    // 'color' is HdrColor or ResolvedColor, RGBA16_FLOAT.
+    void CaptureFrame(nvrhi::ICommandList* commandList, nvrhi::ITexture* color);
+
+    // Called after the command list was submitted. Waits for the GPU on quality frames.
+    void EndFrame();
+
+    // True on the first frame of each configuration, render history should be reset
+    [[nodiscard]] bool IsFirstFrameOfConfiguration() const { return m_FrameInConfiguration == 0; }
+    [[nodiscard]] bool IsFinished() const { return m_Finished; }
+    [[nodiscard]] size_t GetConfigurationCount() const { return m_Configurations.size(); }
+
+    bool WriteReport();
+
+private:
+    struct PendingQuery
+    {
+        nvrhi::TimerQueryHandle query;
+        uint32_t configuration = 0;
+        bool measured = false;
+        bool inFlight = false;
+        float cpuMilliseconds = 0.f;
+    };
+
+    nvrhi::DeviceHandle m_Device;
+    SweepSpec m_Spec;
+    std::vector<SweepConfiguration> m_Configurations;
+    std::vector<SweepResult> m_Results;
+
+    // Timer queries are resolved a few frames late, keep enough of them around to never block
+    static constexpr size_t c_QueryCount = 8;
+    std::array<PendingQuery, c_QueryCount> m_Queries;
+    size_t m_CurrentQuery = 0;
+
+    uint32_t m_Configuration = 0;
+    uint32_t m_FrameInConfiguration = 0;
+    bool m_ReferenceRun = false;
+    bool m_Finished = false;
+
+    ThreadPool m_Pool;
+    ImageMetrics m_Metrics;
+    nvrhi::StagingTextureHandle m_CaptureTexture;
+    bool m_CapturePending = false;
+    uint32_t m_QualityFrame = 0;
+    std::vector<std::vector<uint8_t>> m_ReferenceFrames;    // tightly packed RGBA16_FLOAT
+    uint32_t m_ReferenceWidth = 0;
+    uint32_t m_ReferenceHeight = 0;
+
+    std::chrono::high_resolution_clock::time_point m_FrameStart;
+
+    void PollQueries(bool wait);
+    void ReadCapture();
+};
@@ -0,0 +1,208 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "TaskGraph.h"
+
+#include <algorithm>
+#include <cassert>
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (uint32_t i = 0; i < threadCount; i++)
+        m_Workers.emplace_back(&ThreadPool::WorkerThread, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_JobAvailable.notify_all();
+
+    for (std::thread& worker : m_Workers)
+        worker.join();
+}
+
+void ThreadPool::Submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Jobs.push_back(std::move(job));
+    }
+    m_JobAvailable.notify_one();
+}
+
+void ThreadPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& body)
+{
+    if (count == 0)
+        return;
+
+    // Shared counters rather than one job per index, so small bodies do not drown in scheduling overhead
+    struct State
+    {
+        std::atomic<uint32_t> next{ 0 };
+        std::atomic<uint32_t> done{ 0 };
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<State>();
+
+    auto work = [state, count, &body]()
+    {
+        uint32_t completed = 0;
+        for (uint32_t i = state->next++; i < count; i = state->next++)
+        {
+            body(i);
+            completed++;
+        }
+
+        if (completed && state->done.fetch_add(completed) + completed == count)
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->finished.notify_all();
+        }
+    };
+
+    const uint32_t helpers = std::min(GetThreadCount(), count - 1);
+    for (uint32_t i = 0; i < helpers; i++)
+        Submit(work);
+
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&]() { return state->done == count; });
+}
+
+void ThreadPool::WorkerThread()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_JobAvailable.wait(lock, [&]() { return m_Stopping || !m_Jobs.empty(); });
+
+            if (m_Stopping && m_Jobs.empty())
+                return;
+
+            job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+        }
+
+        job();
+    }
+}
+
+TaskGraph::TaskGraph(ThreadPool& pool)
+    : m_Pool(pool)
+{
+}
+
+TaskGraph::~TaskGraph()
+{
+    // Tasks reference the graph
+    Wait();
+}
+
+TaskGraph::TaskId TaskGraph::AddTask(std::string name, std::function<void()> body, const std::vector<TaskId>& dependencies, double weight)
+{
+    TaskId id;
+    bool ready;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        id = TaskId(m_Tasks.size());
+        m_Tasks.emplace_back();
+
+        Task& task = m_Tasks.back();
+        task.name = std::move(name);
+        task.body = std::move(body);
+        task.weight = weight;
+
+        for (TaskId dependency : dependencies)
+        {
+            assert(dependency < id);
+            if (!m_Tasks[dependency].finished)
+            {
+                m_Tasks[dependency].dependents.push_back(id);
+                task.pendingDependencies++;
+            }
+        }
+
+        m_TotalWeight += weight;
+        ready = task.pendingDependencies == 0;
+    }
+
+    if (ready)
+        m_Pool.Submit([this, id]() { RunTask(id); });
+
+    return id;
+}
+
+void TaskGraph::RunTask(TaskId id)
+{
+    std::function<void()> body;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        body = std::move(m_Tasks[id].body);
+    }
+
+    body();
+
+    std::vector<TaskId> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        Task& task = m_Tasks[id];
+        task.finished = true;
+        m_Finished++;
+        m_FinishedWeight += task.weight;
+
+        for (TaskId dependent : task.dependents)
+        {
+            if (--m_Tasks[dependent].pendingDependencies == 0)
+                ready.push_back(dependent);
+        }
+
+        // Under the lock: once the last task is counted, Wait() may return and the graph may be gone
+        m_TaskFinished.notify_all();
+    }
+
+    for (TaskId dependent : ready)
+        m_Pool.Submit([this, dependent]() { RunTask(dependent); });
+}
+
+void TaskGraph::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_TaskFinished.wait(lock, [&]() { return m_Finished == m_Tasks.size(); });
+}
+
+float TaskGraph::GetProgress() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_TotalWeight > 0.0 ? float(m_FinishedWeight / m_TotalWeight) : 1.f;
+}
+
+uint32_t TaskGraph::GetTaskCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return uint32_t(m_Tasks.size());
+}
+
+uint32_t TaskGraph::GetFinishedTaskCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Finished;
+}
@@ -0,0 +1,94 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running fire-and-forget jobs in FIFO order
+class ThreadPool
+{
+public:
+    // threadCount == 0 uses one thread per hardware thread
+    explicit ThreadPool(uint32_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(std::function<void()> job);
+
+    // Runs body(i) for i in [0, count) on the pool and the calling thread, returns when all are done
+    void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& body);
+
+    [[nodiscard]] uint32_t GetThreadCount() const { return uint32_t(m_Workers.size()); }
+
+private:
+    std::mutex m_Mutex;
+    std::condition_variable m_JobAvailable;
+    std::deque<std::function<void()>> m_Jobs;
+    bool m_Stopping = false;
+    std::vector<std::thread> m_Workers;
+
+    void WorkerThread();
+};
+
+// Tasks with dependencies, scheduled on a ThreadPool as soon as their inputs are done. Tasks may add more tasks
+// while the graph runs, e.g. one decode task per image found by a parse task. Progress is reported by weight.
+class TaskGraph
+{
+public:
+    using TaskId = uint32_t;
+
+    explicit TaskGraph(ThreadPool& pool);
+    ~TaskGraph();
+
+    // Thread safe. The task starts once all dependencies have finished.
+    TaskId AddTask(std::string name, std::function<void()> body, const std::vector<TaskId>& dependencies = {}, double weight = 1.0);
+
+    // Blocks until every task added so far, and every task they add, has finished. Not to be called from a task.
+    void Wait();
+
+    // Finished weight / total weight of the tasks added so far
+    [[nodiscard]] float GetProgress() const;
+    [[nodiscard]] uint32_t GetTaskCount() const;
+    [[nodiscard]] uint32_t GetFinishedTaskCount() const;
+
+private:
+    struct Task
+    {
+        std::string name;
+        std::function<void()> body;
+        double weight = 1.0;
+        uint32_t pendingDependencies = 0;
+        bool finished = false;
+        std::vector<TaskId> dependents;
+    };
+
+    ThreadPool& m_Pool;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_TaskFinished;
+    std::deque<Task> m_Tasks; // stable addresses while growing
+    uint32_t m_Finished = 0;
+    double m_TotalWeight = 0.0;
+    double m_FinishedWeight = 0.0;
+
+    void RunTask(TaskId id);
+};
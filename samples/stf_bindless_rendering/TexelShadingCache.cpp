@@ -0,0 +1,107 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "TexelShadingCache.h"
+
+using namespace donut::math;
+
+TexelShadingCacheStats& TexelShadingCacheStats::operator+=(const TexelShadingCacheStats& other)
+{
+    samples += other.samples;
+    bypassed += other.bypassed;
+    lookups += other.lookups;
+    hits += other.hits;
+    frameHits += other.frameHits;
+    inserts += other.inserts;
+    dropped += other.dropped;
+    return *this;
+}
+
+TexelShadingCache::TexelShadingCache(uint32_t capacity)
+{
+    uint32_t log2Capacity = 4;
+    while (log2Capacity < 31 && (1u << log2Capacity) < capacity)
+        log2Capacity++;
+
+    m_Mask = (1u << log2Capacity) - 1;
+    m_Shift = 64 - log2Capacity;
+    m_Slots = std::make_unique<Slot[]>(size_t(m_Mask) + 1);
+}
+
+uint64_t TexelShadingCache::MakeKey(uint32_t material, uint32_t mip, int2 texel)
+{
+    constexpr uint64_t texelMask = (1ull << 22) - 1;
+    return (uint64_t((material + 1) & 0xffff) << 48)
+        | (uint64_t(mip & 0xf) << 44)
+        | ((uint64_t(texel.y) & texelMask) << 22)
+        | (uint64_t(texel.x) & texelMask);
+}
+
+uint32_t TexelShadingCache::GetHome(uint64_t key) const
+{
+    // Fibonacci hashing: the top bits of the product depend on all bits of the key
+    return uint32_t((key * 0x9e3779b97f4a7c15ull) >> m_Shift);
+}
+
+bool TexelShadingCache::Find(uint64_t key, CpuScene::DecodedMaterial& decoded, uint32_t& frame) const
+{
+    const uint32_t home = GetHome(key);
+    for (uint32_t probe = 0; probe < MaxProbes; probe++)
+    {
+        const Slot& slot = m_Slots[(home + probe) & m_Mask];
+        const uint64_t slotKey = slot.key.load(std::memory_order_acquire);
+        if (slotKey == 0)
+            return false;
+        if (slotKey != key)
+            continue;
+
+        // The acquire pairs with the release of Insert, the entry is complete once the frame is published
+        const uint32_t slotFrame = slot.frame.load(std::memory_order_acquire);
+        if (slotFrame == 0)
+            return false;
+
+        decoded = slot.decoded;
+        frame = slotFrame - 1;
+        return true;
+    }
+    return false;
+}
+
+bool TexelShadingCache::Insert(uint64_t key, const CpuScene::DecodedMaterial& decoded, uint32_t frame)
+{
+    const uint32_t home = GetHome(key);
+    for (uint32_t probe = 0; probe < MaxProbes; probe++)
+    {
+        Slot& slot = m_Slots[(home + probe) & m_Mask];
+        uint64_t slotKey = slot.key.load(std::memory_order_acquire);
+        if (slotKey == 0 && slot.key.compare_exchange_strong(slotKey, key, std::memory_order_acq_rel))
+        {
+            slot.decoded = decoded;
+            slot.frame.store(frame + 1, std::memory_order_release);
+            m_Size.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Present, or claimed by another thread between the load and the exchange
+        if (slotKey == key)
+            return false;
+    }
+    return false;
+}
+
+void TexelShadingCache::Clear()
+{
+    for (uint32_t i = 0; i <= m_Mask; i++)
+    {
+        m_Slots[i].key.store(0, std::memory_order_relaxed);
+        m_Slots[i].frame.store(0, std::memory_order_relaxed);
+    }
+    m_Size.store(0, std::memory_order_relaxed);
+}
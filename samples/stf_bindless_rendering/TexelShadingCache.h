@@ -0,0 +1,89 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "CpuScene.h"
+
+#include <donut/core/math/math.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+struct TexelShadingCacheStats
+{
+    uint64_t samples = 0;       // material samples
+    uint64_t bypassed = 0;      // samples whose textures do not share one tap, decoded without a lookup
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    uint64_t frameHits = 0;     // hits on entries inserted by an earlier frame
+    uint64_t inserts = 0;
+    uint64_t dropped = 0;       // misses that found no free slot within MaxProbes, or whose key another thread claimed first
+
+    TexelShadingCacheStats& operator+=(const TexelShadingCacheStats& other);
+
+    [[nodiscard]] double GetHitRate() const { return lookups ? double(hits) / double(lookups) : 0.0; }
+};
+
+// Decoded materials keyed by the texel STF selected: with one tap per texture and all textures of a material in one
+// footprint class (StfCpuSharedFootprint), CpuScene::DecodeMaterial is a function of the material, the mip and the
+// texel of that tap, so pixels and frames that pick the same texel can share the decode. Only the tangent frame of
+// the hit is applied per pixel.
+// Open addressing with linear probing over a power of two table. The key is claimed with a compare-exchange, the
+// thread that wins writes the value and then publishes the frame of the insertion, and lookups only read entries
+// whose frame is published, so Find and Insert are lock-free and can run on any number of threads. Entries are
+// never removed one by one; Clear empties the table between frames.
+//
+// GPU variant: the same table in a RWByteAddressBuffer, one 8 byte key and a packed entry per slot (for example the
+// albedo and F0 in R11G11B10, an octahedral normal and roughness, opacity and the frame in 8 bits each). The key is
+// claimed with InterlockedCompareExchange64 (SM 6.6 64-bit atomics, or a 32-bit hash of the key plus a second word to
+// verify it), and the winner stores the entry then the frame. Lanes of a wave that pick the same key would first be
+// grouped with WaveMatch so one lane probes for all of them, which is what a magnified surface does most. Readers
+// that find the frame unpublished decode themselves instead of waiting. The table would be cleared or aged by frame
+// when the load passes half of it, and not at all while the textures and materials do not change.
+class TexelShadingCache
+{
+public:
+    static constexpr uint32_t MaxProbes = 16;
+
+    // capacity is rounded up to a power of two
+    explicit TexelShadingCache(uint32_t capacity);
+
+    // 16 bits of material, 4 of mip and 22 per texel coordinate, never 0
+    [[nodiscard]] static uint64_t MakeKey(uint32_t material, uint32_t mip, dm::int2 texel);
+
+    // True and the entry of a key whose insertion is complete. frame receives the frame that inserted it.
+    bool Find(uint64_t key, CpuScene::DecodedMaterial& decoded, uint32_t& frame) const;
+
+    // False when the key is present or being inserted, or when no slot within MaxProbes is free
+    bool Insert(uint64_t key, const CpuScene::DecodedMaterial& decoded, uint32_t frame);
+
+    // Not thread safe: no Find or Insert may run at the same time
+    void Clear();
+
+    [[nodiscard]] uint32_t GetCapacity() const { return m_Mask + 1; }
+    [[nodiscard]] uint32_t GetSize() const { return m_Size.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> key { 0 };        // 0 when empty
+        std::atomic<uint32_t> frame { 0 };      // frame of the insertion + 1, 0 until the entry is written
+        CpuScene::DecodedMaterial decoded;
+    };
+
+    std::unique_ptr<Slot[]> m_Slots;
+    uint32_t m_Mask = 0;
+    uint32_t m_Shift = 0;
+    std::atomic<uint32_t> m_Size { 0 };
+
+    [[nodiscard]] uint32_t GetHome(uint64_t key) const;
+};
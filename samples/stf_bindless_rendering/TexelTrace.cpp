@@ -0,0 +1,190 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "TexelTrace.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+using namespace donut::math;
+
+#include "dispatch_swizzle.h"
+
+namespace
+{
+    const char c_Magic[4] = { 'S', 'T', 'F', 'T' };
+    constexpr uint32_t c_Version = 1;
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        TexelTraceLayout layout;
+        uint64_t footprintTexels;
+        uint64_t requestCount;
+        uint64_t fetchCount;
+    };
+
+    uint32_t DivideRoundUp(uint32_t a, uint32_t b)
+    {
+        return (a + b - 1) / b;
+    }
+}
+
+uint2 CpuDispatchOrder::GetGroup(uint32_t groupIndex, uint2 groupCount) const
+{
+    return SwizzleGroupIndex(groupIndex, groupCount, swizzle, swizzleSize);
+}
+
+void CpuDispatchOrder::GetGroupPixels(uint2 group, uint2 viewportSize, std::vector<uint2>& pixels) const
+{
+    const uint32_t threadCount = groupSize.x * groupSize.y;
+    pixels.resize(threadCount);
+
+    for (uint32_t thread = 0; thread < threadCount; thread++)
+    {
+        uint2 pixel = group * groupSize + uint2(thread % groupSize.x, thread / groupSize.x);
+
+        // WaveGetLaneIndex() of a compute thread
+        const uint32_t lane = thread % waveWidth;
+        const uint2 base = uint2(pixel.x & 0xFFFFFFF0u, pixel.y & 0xFFFFFFFEu);
+        if (laneLayout == CpuLaneLayout::RowLinear16x2)
+            pixel = base + uint2(lane & 0xFu, lane >> 4u);
+        else if (laneLayout == CpuLaneLayout::QuadZ16x2)
+            pixel = base + uint2(((lane >> 2u) << 1u) + (lane & 1u), (lane >> 1u) & 1u);
+
+        pixels[thread] = (pixel.x < viewportSize.x && pixel.y < viewportSize.y) ? pixel : uint2(~0u);
+    }
+}
+
+TexelTrace::TexelTrace(const TexelTraceLayout& layout)
+    : m_Layout(layout)
+{
+}
+
+void TexelTrace::SetTextures(const std::vector<StfCpuTexture>& textures)
+{
+    m_FirstMip.clear();
+    m_Mips.clear();
+    m_TotalTexels = 0;
+
+    const uint32_t tileTexels = m_Layout.tileWidth * m_Layout.tileHeight;
+    for (const StfCpuTexture& texture : textures)
+    {
+        m_FirstMip.push_back(uint32_t(m_Mips.size()));
+        if (!texture.IsValid())
+            continue;
+
+        for (uint32_t mip = 0; mip < texture.GetMipCount(); mip++)
+        {
+            MipLayout layout;
+            layout.size = texture.GetSize(mip);
+            layout.tilesX = DivideRoundUp(uint32_t(layout.size.x), m_Layout.tileWidth);
+            layout.base = uint32_t(m_TotalTexels);
+            m_Mips.push_back(layout);
+
+            m_TotalTexels += uint64_t(layout.tilesX) * DivideRoundUp(uint32_t(layout.size.y), m_Layout.tileHeight) * tileTexels;
+        }
+    }
+
+    assert(m_TotalTexels <= UINT32_MAX && "The traced textures do not fit 32-bit texel addresses");
+}
+
+void TexelTrace::Clear()
+{
+    m_Fetches.clear();
+    m_Requests.clear();
+}
+
+void TexelTrace::BeginRequest(uint32_t group)
+{
+    TexelTraceRequest request;
+    request.firstFetch = uint32_t(m_Fetches.size());
+    request.group = group;
+    m_Requests.push_back(request);
+}
+
+uint32_t TexelTrace::GetAddress(uint32_t texture, const StfCpuTap& tap) const
+{
+    const MipLayout& mip = m_Mips[m_FirstMip[texture] + tap.mip];
+    const uint32_t x = uint32_t(tap.texel.x);
+    const uint32_t y = uint32_t(tap.texel.y);
+    const uint32_t tile = (y / m_Layout.tileHeight) * mip.tilesX + x / m_Layout.tileWidth;
+    const uint32_t offset = (y % m_Layout.tileHeight) * m_Layout.tileWidth + x % m_Layout.tileWidth;
+    return mip.base + tile * m_Layout.tileWidth * m_Layout.tileHeight + offset;
+}
+
+void TexelTrace::Append(const TexelTrace& other)
+{
+    const uint32_t fetchOffset = uint32_t(m_Fetches.size());
+    for (TexelTraceRequest request : other.m_Requests)
+    {
+        request.firstFetch += fetchOffset;
+        m_Requests.push_back(request);
+    }
+    m_Fetches.insert(m_Fetches.end(), other.m_Fetches.begin(), other.m_Fetches.end());
+}
+
+bool TexelTrace::Write(const std::filesystem::path& fileName) const
+{
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    Header header = {};
+    memcpy(header.magic, c_Magic, sizeof(c_Magic));
+    header.version = c_Version;
+    header.layout = m_Layout;
+    header.footprintTexels = m_TotalTexels;
+    header.requestCount = m_Requests.size();
+    header.fetchCount = m_Fetches.size();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(m_Requests.data()), std::streamsize(m_Requests.size() * sizeof(TexelTraceRequest)));
+    file.write(reinterpret_cast<const char*>(m_Fetches.data()), std::streamsize(m_Fetches.size() * sizeof(uint32_t)));
+    return file.good();
+}
+
+bool TexelTrace::Read(const std::filesystem::path& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    Header header = {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || memcmp(header.magic, c_Magic, sizeof(c_Magic)) != 0 || header.version != c_Version ||
+        header.fetchCount > UINT32_MAX || header.requestCount > UINT32_MAX)
+    {
+        return false;
+    }
+
+    // The texture layout is not stored, a read trace can be replayed but not extended
+    m_Layout = header.layout;
+    m_FirstMip.clear();
+    m_Mips.clear();
+    m_TotalTexels = header.footprintTexels;
+
+    m_Requests.resize(size_t(header.requestCount));
+    m_Fetches.resize(size_t(header.fetchCount));
+    file.read(reinterpret_cast<char*>(m_Requests.data()), std::streamsize(m_Requests.size() * sizeof(TexelTraceRequest)));
+    file.read(reinterpret_cast<char*>(m_Fetches.data()), std::streamsize(m_Fetches.size() * sizeof(uint32_t)));
+    const bool ordered = std::is_sorted(m_Requests.begin(), m_Requests.end(),
+        [](const TexelTraceRequest& a, const TexelTraceRequest& b) { return a.firstFetch < b.firstFetch; });
+    if (!file || !ordered || (!m_Requests.empty() && m_Requests.back().firstFetch > m_Fetches.size()))
+    {
+        Clear();
+        return false;
+    }
+
+    return true;
+}
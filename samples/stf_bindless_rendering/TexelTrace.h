@@ -0,0 +1,113 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "StfCpuSampler.h"
+
+#include <donut/core/math/math.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// Values of stfWaveLaneLayoutOverride, see MakeRowLinearLanes_16x2 and MakeQuadZLanes_16x2
+enum class CpuLaneLayout : uint32_t
+{
+    None,
+    RowLinear16x2,
+    QuadZ16x2,
+};
+
+// The order in which the compute pipeline of the sample runs its threads: thread groups in the order of the group
+// swizzle, the threads of a group row by row with consecutive threads forming the waves, then the lane layout
+// override of main(). The overrides assume waves of 16x2 threads; other group shapes give the pixel positions the
+// shader computes, which then cover some pixels twice and others not at all.
+struct CpuDispatchOrder
+{
+    dm::uint2 groupSize = dm::uint2(8, 8);
+    CpuLaneLayout laneLayout = CpuLaneLayout::None;
+    uint32_t swizzle = 0;       // STF_GROUP_SWIZZLE_* of dispatch_swizzle.h
+    uint32_t swizzleSize = 8;
+    uint32_t waveWidth = 32;
+
+    [[nodiscard]] uint32_t GetWavesPerGroup() const { return (groupSize.x * groupSize.y + waveWidth - 1) / waveWidth; }
+    [[nodiscard]] dm::uint2 GetGroupCount(dm::uint2 viewportSize) const { return (viewportSize + groupSize - 1u) / groupSize; }
+
+    // The group that runs groupIndex-th, SwizzleGroupIndex
+    [[nodiscard]] dm::uint2 GetGroup(uint32_t groupIndex, dm::uint2 groupCount) const;
+
+    // The pixel of every thread of a group, in lane order. Threads outside the viewport get ~0u.
+    void GetGroupPixels(dm::uint2 group, dm::uint2 viewportSize, std::vector<dm::uint2>& pixels) const;
+};
+
+// Where the texels of the traced textures live in memory: one address space with the textures one after the other,
+// each mip level in tiles of tileWidth x tileHeight texels stored row by row inside the tile and tiles row by row,
+// like the block-linear layouts of GPU textures. The defaults put one 8x4 tile of RGBA8 texels in a 128 byte line.
+struct TexelTraceLayout
+{
+    uint32_t bytesPerTexel = 4;
+    uint32_t tileWidth = 8;
+    uint32_t tileHeight = 4;
+};
+
+// One texture instruction of one wave
+struct TexelTraceRequest
+{
+    uint32_t firstFetch = 0;    // fetches up to the next request's firstFetch belong to this one
+    uint32_t group = 0;         // thread group of the wave in dispatch order
+};
+
+// The texel fetches of the STF loads of a frame, as texel addresses in units of bytesPerTexel. At 4 bytes per
+// fetch a 1280x720 frame with four textures per pixel takes about 16 MB.
+class TexelTrace
+{
+public:
+    TexelTrace() = default;
+    explicit TexelTrace(const TexelTraceLayout& layout);
+
+    // Lays out the mip chains of the textures that Add refers to by index
+    void SetTextures(const std::vector<StfCpuTexture>& textures);
+
+    void Clear();
+    void BeginRequest(uint32_t group);
+    void Add(uint32_t texture, const StfCpuTap& tap) { Add(GetAddress(texture, tap)); }
+    void Add(uint32_t address) { m_Fetches.push_back(address); }
+    // Appends the requests of another trace of the same textures, e.g. one recorded by another thread
+    void Append(const TexelTrace& other);
+
+    // Texel address of a tap of a texture of SetTextures
+    [[nodiscard]] uint32_t GetAddress(uint32_t texture, const StfCpuTap& tap) const;
+
+    [[nodiscard]] const TexelTraceLayout& GetLayout() const { return m_Layout; }
+    [[nodiscard]] const std::vector<uint32_t>& GetFetches() const { return m_Fetches; }
+    [[nodiscard]] const std::vector<TexelTraceRequest>& GetRequests() const { return m_Requests; }
+    [[nodiscard]] uint64_t GetFootprintBytes() const { return m_TotalTexels * m_Layout.bytesPerTexel; }
+
+    // Binary file with the layout, the requests and the fetches
+    bool Write(const std::filesystem::path& fileName) const;
+    bool Read(const std::filesystem::path& fileName);
+
+private:
+    struct MipLayout
+    {
+        uint32_t base = 0;      // first texel
+        uint32_t tilesX = 0;
+        dm::int2 size = 0;
+    };
+
+    TexelTraceLayout m_Layout;
+    std::vector<uint32_t> m_FirstMip;   // per texture, into m_Mips
+    std::vector<MipLayout> m_Mips;
+    uint64_t m_TotalTexels = 0;
+
+    std::vector<uint32_t> m_Fetches;
+    std::vector<TexelTraceRequest> m_Requests;
+};
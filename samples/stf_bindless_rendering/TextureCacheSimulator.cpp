@@ -0,0 +1,109 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "TextureCacheSimulator.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    uint32_t Log2(uint32_t value)
+    {
+        uint32_t result = 0;
+        while ((1u << (result + 1)) <= value)
+            result++;
+        return result;
+    }
+}
+
+SetAssociativeCache::SetAssociativeCache(const CacheLevelDesc& desc)
+{
+    assert(desc.lineBytes != 0 && (desc.lineBytes & (desc.lineBytes - 1)) == 0 && desc.ways != 0);
+
+    m_LineShift = Log2(desc.lineBytes);
+    m_Ways = desc.ways;
+    m_SetCount = std::max(desc.sizeBytes / (desc.lineBytes * desc.ways), 1u);
+    m_Tags.assign(size_t(m_SetCount) * m_Ways, 0);
+    m_LastUse.assign(m_Tags.size(), 0);
+}
+
+bool SetAssociativeCache::Access(uint64_t address)
+{
+    const uint64_t line = address >> m_LineShift;
+    const size_t first = size_t(line % m_SetCount) * m_Ways;
+    m_Clock++;
+
+    size_t victim = first;
+    for (size_t way = first; way < first + m_Ways; way++)
+    {
+        if (m_Tags[way] == line + 1)
+        {
+            m_LastUse[way] = m_Clock;
+            return true;
+        }
+
+        if (m_LastUse[way] < m_LastUse[victim])
+            victim = way;
+    }
+
+    m_Tags[victim] = line + 1;
+    m_LastUse[victim] = m_Clock;
+    return false;
+}
+
+TextureCacheResult SimulateTextureCache(const TexelTrace& trace, const TextureCacheConfig& config)
+{
+    std::vector<SetAssociativeCache> l1(std::max(config.l1Count, 1u), SetAssociativeCache(config.l1));
+    SetAssociativeCache l2(config.l2);
+
+    const std::vector<uint32_t>& fetches = trace.GetFetches();
+    const std::vector<TexelTraceRequest>& requests = trace.GetRequests();
+    const uint64_t bytesPerTexel = trace.GetLayout().bytesPerTexel;
+    const uint32_t l1LineShift = Log2(config.l1.lineBytes);
+
+    TextureCacheResult result;
+    result.requests = requests.size();
+    result.fetches = fetches.size();
+
+    std::vector<uint64_t> lines;
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        const size_t begin = requests[i].firstFetch;
+        const size_t end = i + 1 < requests.size() ? requests[i + 1].firstFetch : fetches.size();
+
+        lines.clear();
+        for (size_t fetch = begin; fetch < end; fetch++)
+            lines.push_back((uint64_t(fetches[fetch]) * bytesPerTexel) >> l1LineShift);
+
+        std::sort(lines.begin(), lines.end());
+        lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+
+        SetAssociativeCache& sm = l1[requests[i].group % l1.size()];
+        for (uint64_t line : lines)
+        {
+            const uint64_t address = line << l1LineShift;
+            result.l1Accesses++;
+            if (sm.Access(address))
+            {
+                result.l1Hits++;
+                continue;
+            }
+
+            result.l2Accesses++;
+            if (l2.Access(address))
+                result.l2Hits++;
+            else
+                result.dramBytes += config.l2.lineBytes;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,68 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include "TexelTrace.h"
+
+#include <cstdint>
+#include <vector>
+
+struct CacheLevelDesc
+{
+    uint32_t sizeBytes = 0;
+    uint32_t lineBytes = 128;
+    uint32_t ways = 4;
+};
+
+// Loosely a current GPU: per-SM texture caches in front of one shared L2
+struct TextureCacheConfig
+{
+    CacheLevelDesc l1 = { 32 * 1024, 128, 4 };
+    CacheLevelDesc l2 = { 4 * 1024 * 1024, 128, 16 };
+    uint32_t l1Count = 32;      // SMs, thread groups are distributed to them round robin
+};
+
+struct TextureCacheResult
+{
+    uint64_t requests = 0;      // texture instructions of a wave
+    uint64_t fetches = 0;       // texels
+    uint64_t l1Accesses = 0;    // distinct L1 lines of each request
+    uint64_t l1Hits = 0;
+    uint64_t l2Accesses = 0;
+    uint64_t l2Hits = 0;
+    uint64_t dramBytes = 0;
+
+    [[nodiscard]] double GetL1HitRate() const { return l1Accesses ? double(l1Hits) / double(l1Accesses) : 0.0; }
+    [[nodiscard]] double GetL2HitRate() const { return l2Accesses ? double(l2Hits) / double(l2Accesses) : 0.0; }
+};
+
+// Set-associative cache with LRU replacement, addressed by byte
+class SetAssociativeCache
+{
+public:
+    explicit SetAssociativeCache(const CacheLevelDesc& desc);
+
+    // True on a hit, a miss allocates the line
+    bool Access(uint64_t address);
+
+private:
+    uint32_t m_LineShift = 0;
+    uint32_t m_SetCount = 0;
+    uint32_t m_Ways = 0;
+    uint64_t m_Clock = 0;
+    std::vector<uint64_t> m_Tags;       // per set and way, line address + 1, 0 is empty
+    std::vector<uint64_t> m_LastUse;
+};
+
+// Replays a trace through the L1 of its thread group's SM and the L2. Each request looks up its distinct L1 lines
+// once, like the texture unit coalescing the texels of one instruction; L1 misses go to the L2 and L2 misses read
+// one L2 line from DRAM. The SMs run the requests in trace order, without modeling how their timing interleaves.
+TextureCacheResult SimulateTextureCache(const TexelTrace& trace, const TextureCacheConfig& config);
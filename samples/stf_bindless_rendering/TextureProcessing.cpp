@@ -0,0 +1,169 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "TextureProcessing.h"
+
+#include <donut/engine/TextureCache.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+using namespace donut;
+
+bool DecodeImageFile(engine::TextureCache& textureCache, const std::filesystem::path& fileName, bool sRGB, CpuImage& image)
+{
+    std::shared_ptr<engine::TextureData> texture = std::static_pointer_cast<engine::TextureData>(
+        textureCache.LoadTextureFromFileDeferred(fileName, sRGB));
+
+    if (!texture || !texture->data || texture->dataLayout.empty() || texture->dataLayout[0].empty())
+        return false;
+
+    if (texture->format != nvrhi::Format::RGBA8_UNORM && texture->format != nvrhi::Format::SRGBA8_UNORM)
+        return false;
+
+    const engine::TextureSubresourceData& layout = texture->dataLayout[0][0];
+    const uint8_t* source = static_cast<const uint8_t*>(texture->data->data()) + layout.dataOffset;
+
+    image.width = texture->width;
+    image.height = texture->height;
+    image.sRGB = sRGB;
+    image.rgba.resize(size_t(image.width) * image.height * 4);
+
+    for (uint32_t y = 0; y < image.height; y++)
+        memcpy(&image.rgba[size_t(y) * image.width * 4], source + y * layout.rowPitch, size_t(image.width) * 4);
+
+    return true;
+}
+
+namespace
+{
+    struct SrgbTables
+    {
+        std::array<float, 256> toLinear;
+
+        SrgbTables()
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                const float c = float(i) / 255.f;
+                toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+        }
+    };
+
+    const SrgbTables& GetSrgbTables()
+    {
+        static const SrgbTables tables;
+        return tables;
+    }
+
+    uint8_t LinearToSrgb8(float linear)
+    {
+        const float c = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.f / 2.4f) - 0.055f;
+        return uint8_t(std::clamp(c * 255.f + 0.5f, 0.f, 255.f));
+    }
+
+    void Downsample(const CpuImage& source, CpuImage& destination)
+    {
+        const SrgbTables& tables = GetSrgbTables();
+
+        destination.width = std::max(source.width / 2, 1u);
+        destination.height = std::max(source.height / 2, 1u);
+        destination.sRGB = source.sRGB;
+        destination.rgba.resize(size_t(destination.width) * destination.height * 4);
+
+        for (uint32_t y = 0; y < destination.height; y++)
+        {
+            const uint32_t y0 = std::min(y * 2, source.height - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, source.height - 1);
+
+            for (uint32_t x = 0; x < destination.width; x++)
+            {
+                const uint32_t x0 = std::min(x * 2, source.width - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, source.width - 1);
+
+                const uint8_t* texels[4] = {
+                    &source.rgba[(size_t(y0) * source.width + x0) * 4],
+                    &source.rgba[(size_t(y0) * source.width + x1) * 4],
+                    &source.rgba[(size_t(y1) * source.width + x0) * 4],
+                    &source.rgba[(size_t(y1) * source.width + x1) * 4] };
+
+                uint8_t* output = &destination.rgba[(size_t(y) * destination.width + x) * 4];
+
+                for (int channel = 0; channel < 4; channel++)
+                {
+                    // Alpha is always linear
+                    if (source.sRGB && channel < 3)
+                    {
+                        float sum = 0.f;
+                        for (const uint8_t* texel : texels)
+                            sum += tables.toLinear[texel[channel]];
+                        output[channel] = LinearToSrgb8(sum * 0.25f);
+                    }
+                    else
+                    {
+                        uint32_t sum = 2;
+                        for (const uint8_t* texel : texels)
+                            sum += texel[channel];
+                        output[channel] = uint8_t(sum / 4);
+                    }
+                }
+            }
+        }
+    }
+}
+
+float Srgb8ToLinear(uint8_t value)
+{
+    return GetSrgbTables().toLinear[value];
+}
+
+void GenerateMipChain(const CpuImage& base, std::vector<CpuImage>& mips)
+{
+    uint32_t levels = 0;
+    for (uint32_t size = std::max(base.width, base.height); size > 1; size /= 2)
+        levels++;
+
+    mips.clear();
+    mips.resize(levels);
+
+    for (uint32_t level = 0; level < levels; level++)
+        Downsample(level == 0 ? base : mips[level - 1], mips[level]);
+}
+
+bool WritePfmImage(const std::filesystem::path& fileName, uint32_t width, uint32_t height, const float* rgba)
+{
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file)
+        return false;
+
+    // A negative scale marks little endian data, PFM rows go bottom to top
+    const std::string header = "PF\n" + std::to_string(width) + " " + std::to_string(height) + "\n-1.0\n";
+    file.write(header.data(), std::streamsize(header.size()));
+
+    std::vector<float> row(size_t(width) * 3);
+    for (uint32_t y = height; y-- > 0;)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            const float* source = rgba + (size_t(y) * width + x) * 4;
+            row[x * 3 + 0] = source[0];
+            row[x * 3 + 1] = source[1];
+            row[x * 3 + 2] = source[2];
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), std::streamsize(row.size() * sizeof(float)));
+    }
+
+    return bool(file);
+}
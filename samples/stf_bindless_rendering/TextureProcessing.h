@@ -0,0 +1,43 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace donut::engine
+{
+    class TextureCache;
+}
+
+// 8-bit RGBA image in CPU memory
+struct CpuImage
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    bool sRGB = false;
+    std::vector<uint8_t> rgba;
+};
+
+// Decodes an image file through the TextureCache decoders on the calling thread. Only 8-bit RGBA results
+// (PNG, JPG, TGA, ...) are converted, block compressed DDS files return false.
+bool DecodeImageFile(donut::engine::TextureCache& textureCache, const std::filesystem::path& fileName, bool sRGB, CpuImage& image);
+
+// sRGB to linear through a 256 entry table
+float Srgb8ToLinear(uint8_t value);
+
+// 2x2 box filtered mip chain down to 1x1, averaged in linear space for sRGB images.
+// Odd dimensions clamp the last row/column. mips[0] is the first level below the base.
+void GenerateMipChain(const CpuImage& base, std::vector<CpuImage>& mips);
+
+// Writes 4 floats per pixel, rows top to bottom, as a little endian RGB PFM file. Alpha is dropped.
+bool WritePfmImage(const std::filesystem::path& fileName, uint32_t width, uint32_t height, const float* rgba);
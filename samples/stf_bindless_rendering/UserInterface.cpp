@@ -43,10 +43,6 @@
 
 using namespace donut;
 
-UIData::UIData()
-{
-}
-
 UserInterface::UserInterface(app::DeviceManager* deviceManager, vfs::IFileSystem& rootFS, UIData& ui)
     : ImGui_Renderer(deviceManager)
     , m_ui(ui)
@@ -153,9 +149,21 @@ void UserInterface::PostProcessSettings()
                     {
                         m_ui.stfPipelineUpdate = true;
                     }
+
+                    if (ImGui::Checkbox("Deferred Texels", (bool*)&m_ui.stfDeferredTexels))
+                    {
+                        m_ui.stfPipelineUpdate = true;
+                    }
+                    ShowHelpMarker("The G-buffer stores the texel STF picks for the first texture of each material in 96 bits per pixel, and a full screen resolve loads the textures once per visible pixel, each on the mip of the same texel density. Alpha-tested materials are shaded in the G-buffer pass, and every material with a custom kernel, Sigma LOD, Ewa or more than one tap.");
                 }
 
-                ImGui::Combo("Filter Type", (int*)&m_ui.stfFilterMode, "Linear\0Cubic\0Gaussian\0");
+                ImGui::Combo("Filter Type", (int*)&m_ui.stfFilterMode, "Linear\0Cubic\0Gaussian\0Custom\0");
+
+                {
+                    IMGUI_SCOPED_DISABLE(m_ui.stfFilterMode != StfFilterMode::Custom || !m_ui.stfLoad);
+                    ImGui::Combo("Kernel", (int*)&m_ui.stfFilterKernel, "Lanczos2\0Lanczos3\0Mitchell\0Kaiser\0");
+                    ShowHelpMarker("Separable kernel of the Custom filter type, one tap drawn from an alias table per axis. Negative lobes make single samples leave [0, 1]. Load path only, the Sample path falls back to Linear");
+                }
 
                 {
                     IMGUI_SCOPED_DISABLE(!m_ui.stfLoad);
@@ -202,11 +210,19 @@ void UserInterface::PostProcessSettings()
                     IMGUI_SCOPED_DISABLE(m_ui.stfFilterMode != StfFilterMode::Gaussian);
                     ImGui::SliderFloat("Sigma", &m_ui.stfSigma, 0.f, 100.f, "%.3f", ImGuiSliderFlags_Logarithmic);
                     ShowHelpMarker("Increase or decrease the width of the Gaussian filter");
+
+                    ImGui::Checkbox("Sigma LOD", &m_ui.stfSigmaLod);
+                    ShowHelpMarker("Sample Gaussians wider than the target sigma on a coarser mip with an equivalent kernel, choosing randomly between the two mips around it. Keeps the taps near the pixel for cache locality and converges in fewer frames");
+                    {
+                        IMGUI_SCOPED_DISABLE(!m_ui.stfSigmaLod);
+                        ImGui::SliderFloat("Sigma LOD Target", &m_ui.stfSigmaLodTarget, 0.25f, 4.f, "%.2f");
+                    }
                 }
 
             }
 
-            ImGui::Combo("Minification Method", (int*)&m_ui.stfMinificationMethod, "Aniso\0ForceNegInf\0ForcePosInf\0ForceNan\0ForceCustom\0");
+            ImGui::Combo("Minification Method", (int*)&m_ui.stfMinificationMethod, "Aniso\0ForceNegInf\0ForcePosInf\0ForceNan\0ForceCustom\0Ewa\0");
+            ShowHelpMarker("Ewa: one tap at a Gaussian distributed position in the elliptical footprint of the pixel, on the mip of its minor axis. Follows skewed footprints at grazing angles that Aniso only spreads along the longer derivative. Needs gradients: samples with an explicit mip level (SampleLevel / LoadLevel) ignore it and filter like Aniso.");
 
             {
                 IMGUI_SCOPED_DISABLE(m_ui.stfMinificationMethod != StfMinMethod::ForceCustom);
@@ -215,6 +231,25 @@ void UserInterface::PostProcessSettings()
 
             ImGui::Checkbox("Reseed on sample", (bool*)&m_ui.stfReseedOnSample);
             ImGui::Checkbox("Use White Noise", (bool*)&m_ui.stfUseWhiteNoise);
+            ImGui::SliderInt("Temporal Strata", &m_ui.stfTemporalStrata, 1, 16);
+            ShowHelpMarker("Stratifies the random numbers of a pixel over cycles of this many frames: the taps of a cycle cover the filter in as many strata, so the temporal filter converges in fewer frames. 1 draws new noise every frame.");
+            ImGui::Checkbox("Decorrelate Textures", &m_ui.stfDecorrelateTextures);
+            ShowHelpMarker("Rotates the blue noise of the pixel by a fixed offset per material texture, so that the textures of a material pick independent taps like with reseeding, at the cost of a few adds.");
+            ImGui::Checkbox("Share Footprints", &m_ui.stfShareFootprints);
+            ShowHelpMarker("Computes the STF sample position once for all material textures of equal size and loads them at the same texel. Same result, less ALU. Only with Use Load, the Default magnification method and without reseeding or decorrelation.");
+            ImGui::Checkbox("Constant Footprint Early-Out", &m_ui.stfConstantFootprints);
+            ShowHelpMarker("Skips the stochastic filter when all texels it can reach are equal, from per-texture blocks of equal texels built at load time: one fetch and no random numbers. Same result without reseeding. Only with Use Load.");
+
+            {
+                int maxTapsIndex = m_ui.stfMaxTaps >= 4 ? 2 : m_ui.stfMaxTaps - 1;
+                if (ImGui::Combo("Max Taps", &maxTapsIndex, "1\0""2\0""4\0"))
+                    m_ui.stfMaxTaps = 1 << maxTapsIndex;
+                ShowHelpMarker("Adaptive multi-tap STF: takes one or three more stochastic taps where the first taps of the quad differ by more than the contrast threshold, and averages them. Spends fetches on edges and detail instead of flat regions.");
+
+                IMGUI_SCOPED_DISABLE(m_ui.stfMaxTaps <= 1);
+                ImGui::SliderFloat("Tap Contrast", &m_ui.stfTapContrast, 0.f, 1.f, "%.3f");
+                ShowHelpMarker("Largest channel range of the quad that takes 2 taps, twice as much takes 4. 0 always takes Max Taps taps.");
+            }
 
             {
                 ImGui::Separator();
@@ -232,9 +267,36 @@ void UserInterface::PostProcessSettings()
                     {
                         m_ui.stfPipelineUpdate = true;
                     }
+                    ImGui::Combo("Group Swizzle", (int*)&m_ui.stfGroupSwizzle, "None\0Morton\0Column Strips\0");
+                    ImGui::SliderInt("Swizzle Size", &m_ui.stfGroupSwizzleSize, 2, 32);
+                    ShowHelpMarker("Order of the thread groups: Morton order inside blocks of size x size groups (rounded down to a power of two), or row by row inside strips of size group columns.");
+
+                    const bool searching = m_ui.stfAutotuneProgress < 1.f;
+                    {
+                        IMGUI_SCOPED_DISABLE(searching || !GetStfOn(m_ui.samplerType));
+                        if (ImGui::Button("Autotune Dispatch"))
+                            m_ui.stfAutotuneDispatch = true;
+                    }
+                    ShowHelpMarker("Times the STF compute pass with every group size, group swizzle and lane layout and keeps the fastest for the current resolution. Keep the camera still while it runs.");
+                    if (searching)
+                        ImGui::ProgressBar(m_ui.stfAutotuneProgress);
+                    ImGui::Checkbox("Use Tuned Dispatch", &m_ui.stfUseTunedDispatch);
+                    if (!m_ui.stfAutotuneStatus.empty())
+                        ImGui::TextUnformatted(m_ui.stfAutotuneStatus.c_str());
                 }
 
                 ImGui::Checkbox("Debug Failure", (bool*)&m_ui.stfDebugOnFailure);
+                ImGui::Checkbox("Collect Sampling Stats", (bool*)&m_ui.stfCollectStats);
+                ShowHelpMarker("Counts what the magnification method did per texture: samples that fell back to a stochastic tap, texels fetched and lanes sharing cooperative loads. Estimated from the footprints of the lanes.");
+                if (m_ui.stfCollectStats)
+                {
+                    const StfSamplingCounters& stats = m_ui.stfSamplingStats;
+                    ImGui::Text("Fallback rate: %.1f%%", 100.0 * stats.GetFallbackRate());
+                    ImGui::Text("Texels per sample: %.2f", stats.GetTexelsPerSample());
+                    ImGui::Text("Sharing lanes per wave: %.1f", stats.waves ? double(stats.sharingLanes) / double(stats.waves) : 0.0);
+                    ImGui::Text("Distinct texels per wave: %.1f", stats.GetDistinctTexelsPerWave());
+                    ImGui::Text("Constant footprints: %.1f%%", 100.0 * stats.GetConstantRate());
+                }
                 ImGui::Combo("Lane Warp Layout", (int*)&m_ui.stfWaveLaneLayoutOverride, "None\0Row Linear 16x2\0Quad-Z 16x2\0");
                 ImGui::Checkbox("Lane Debug viz", (bool*)&m_ui.stfDebugVisualizeLanes);
             }
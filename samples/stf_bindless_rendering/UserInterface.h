@@ -15,6 +15,8 @@
 #include <donut/render/TemporalAntiAliasingPass.h>
 #include <donut/app/imgui_renderer.h>
 
+#include "StfSamplingStats.h"
+
 #if ENABLE_DLSS
 #include "../../external/DLSS/include/nvsdk_ngx_helpers.h"
 #endif
@@ -57,7 +59,17 @@ enum class StfFilterMode
 {
     Linear,
     Cubic,
-    Gaussian
+    Gaussian,
+    Custom      // StfFilterKernel, Load path only
+};
+
+// Kernels of StfFilterMode::Custom, in the order of STF_FILTER_KERNEL_*
+enum class StfFilterKernel
+{
+    Lanczos2,
+    Lanczos3,
+    Mitchell,
+    Kaiser
 };
 
 enum class StfMagMethod
@@ -92,6 +104,7 @@ enum class StfMinMethod
     ForcePosInf,
     ForceNan,
     ForceCustom,
+    Ewa,                // stochastic elliptical footprint, see stf_ewa.h
 };
 
 enum class StfAddressMode
@@ -123,6 +136,14 @@ enum class StfWaveLaneLayout
     QuadZ16x2,
 };
 
+// Values of STF_GROUP_SWIZZLE_*
+enum class StfGroupSwizzle
+{
+    None,
+    Morton,
+    ColumnStrips,
+};
+
 // Ultra Quality is broken and is not used in the sample application for DLSS, punting for now until we get more answers for DLSS team
 enum class DLSSQualityModes
 {
@@ -185,29 +206,45 @@ struct UIData
     SamplerType samplerType = SamplerType::STF;
     bool stfLoad = true;
     bool allowHelperLanesInWaveIntrinsics = false;
+    bool stfDeferredTexels = false;
     StfFilterMode stfFilterMode = StfFilterMode::Linear;
+    StfFilterKernel stfFilterKernel = StfFilterKernel::Lanczos3;
     StfMagMethod stfMagnificationMethod = StfMagMethod::MinMaxV2;
     StfFallbackMethod stfFallbackMethod = StfFallbackMethod::BL1STFILTER_FAST;
     StfMinMethod stfMinificationMethod = StfMinMethod::Aniso;
     float stfMipLevelOverride = 0.f;
     StfAddressMode stfAddressMode = StfAddressMode::SameAsSampler;
     float stfSigma = 0.7f;
+    bool stfSigmaLod = false;               // wide Gaussians on a coarser mip, see stf_sigma_lod.h
+    float stfSigmaLodTarget = 1.f;
     bool stfReseedOnSample = false;
     bool stfUseWhiteNoise = false;
+    int stfTemporalStrata = 1;              // frames per stratified cycle, see stf_temporal_strata.h
+    bool stfShareFootprints = false;
+    bool stfConstantFootprints = false;
+    bool stfDecorrelateTextures = false;
+    int stfMaxTaps = 1;
+    float stfTapContrast = 0.1f;
     bool stfDebugOnFailure = false;
+    bool stfCollectStats = false;
+    StfSamplingCounters stfSamplingStats;   // since collection was enabled, for the current magnification method
     float resolutionScale = 1.f;
 
     StfPipelineType stfPipelineType = StfPipelineType::Compute;
     StfThreadGroupSize stfGroupSize = StfThreadGroupSize::_8x8;
     StfWaveLaneLayout stfWaveLaneLayoutOverride = StfWaveLaneLayout::None;
+    StfGroupSwizzle stfGroupSwizzle = StfGroupSwizzle::None;
+    int stfGroupSwizzleSize = 8;
     int stfDebugVisualizeLanes = 0;
+    bool stfAutotuneDispatch = false;       // request, cleared when the search starts
+    bool stfUseTunedDispatch = false;       // apply the tuned dispatch of the current resolution
+    float stfAutotuneProgress = 1.f;        // below 1 while searching
+    std::string stfAutotuneStatus;
 
     bool enableFpsLimit = true;
     uint32_t fpsLimit = 60;
 
     donut::render::TemporalAntiAliasingJitter temporalJitter = donut::render::TemporalAntiAliasingJitter::Halton;
-
-    UIData();
 };
 
 
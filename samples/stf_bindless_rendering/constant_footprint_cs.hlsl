@@ -0,0 +1,73 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include <donut/shaders/binding_helpers.hlsli>
+#include "stf_constant_footprint_cb.h"
+
+// Builds the constant blocks of one mip and level of a texture, see stf_constant_footprint_cb.h. Level 0 compares
+// the texels as the shaders Load them, so block compressed textures are compared after decoding. Higher levels
+// combine the 3x3 blocks of the level below that cover them. One thread writes one uint of bits.
+
+Texture2D<float4> t_Texture : register(t0);
+RWByteAddressBuffer u_Blocks : register(u0);
+
+VK_PUSH_CONSTANT ConstantBuffer<ConstantFootprintBuildConstants> g_Build : register(b0);
+
+bool GetInputBlock(uint2 block)
+{
+    block = min(block, uint2(g_Build.inputBlocksX, g_Build.inputBlocksY) - 1);
+    const uint bit = block.y * g_Build.inputBlocksX + block.x;
+    return (u_Blocks.Load((g_Build.inputOffset + bit / 32) * 4) >> (bit % 32)) & 1;
+}
+
+bool IsBlockConstant(uint2 block)
+{
+    if (g_Build.level != 0)
+    {
+        // Blocks 2i to 2i + 2 of the level below cover the block and overlap their neighbors
+        bool constant = true;
+        for (uint y = 0; y < 3; y++)
+            for (uint x = 0; x < 3; x++)
+                constant = constant && GetInputBlock(block * 2 + uint2(x, y));
+        return constant;
+    }
+
+    uint width, height, mipCount;
+    t_Texture.GetDimensions(g_Build.mip, width, height, mipCount);
+
+    const uint2 minTexel = block * 2;
+    const uint2 maxTexel = min(minTexel + 4, uint2(width, height)) - 1;
+    const float4 first = t_Texture.Load(int3(minTexel, g_Build.mip));
+
+    bool constant = true;
+    for (uint y = minTexel.y; y <= maxTexel.y; y++)
+        for (uint x = minTexel.x; x <= maxTexel.x; x++)
+            constant = constant && all(t_Texture.Load(int3(x, y, g_Build.mip)) == first);
+    return constant;
+}
+
+[numthreads(64, 1, 1)]
+void main(uint3 globalIdx : SV_DispatchThreadID)
+{
+    const uint blockCount = g_Build.blocksX * g_Build.blocksY;
+    const uint firstBit = globalIdx.x * 32;
+    if (firstBit >= blockCount)
+        return;
+
+    uint bits = 0;
+    for (uint i = 0; i < 32 && firstBit + i < blockCount; i++)
+    {
+        const uint bit = firstBit + i;
+        if (IsBlockConstant(uint2(bit % g_Build.blocksX, bit / g_Build.blocksX)))
+            bits |= 1u << i;
+    }
+
+    u_Blocks.Store((g_Build.outputOffset + globalIdx.x) * 4, bits);
+}
@@ -0,0 +1,76 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef DISPATCH_SWIZZLE_H
+#define DISPATCH_SWIZZLE_H
+
+// Thread group swizzles of the compute pipeline, shared by the shader and the CPU texel trace.
+// C++ includes this like lighting_cb.h, with donut::math in scope.
+#define STF_GROUP_SWIZZLE_NONE 0
+#define STF_GROUP_SWIZZLE_MORTON 1          // Morton order inside square blocks of size x size groups, size a power of two
+#define STF_GROUP_SWIZZLE_COLUMN_STRIPS 2   // row by row inside strips of size columns, strip after strip
+
+#ifdef __cplusplus
+#define STF_SWIZZLE_FUNCTION inline
+#else
+#define STF_SWIZZLE_FUNCTION
+#endif
+
+// The even bits of x packed together, one coordinate of a Morton code
+STF_SWIZZLE_FUNCTION uint CompactMortonBits(uint x)
+{
+    x &= 0x55555555u;
+    x = (x ^ (x >> 1u)) & 0x33333333u;
+    x = (x ^ (x >> 2u)) & 0x0f0f0f0fu;
+    x = (x ^ (x >> 4u)) & 0x00ff00ffu;
+    x = (x ^ (x >> 8u)) & 0x0000ffffu;
+    return x;
+}
+
+// The group that runs as the groupIndex-th group of a row-major dispatch of groupCount groups. Every swizzle visits
+// every group exactly once; the groups that do not fill a whole Morton block come last, row by row.
+STF_SWIZZLE_FUNCTION uint2 SwizzleGroupIndex(uint groupIndex, uint2 groupCount, uint swizzle, uint size)
+{
+    if (swizzle == STF_GROUP_SWIZZLE_MORTON && size > 1u)
+    {
+        const uint2 blocks = groupCount / size;
+        const uint blockGroups = size * size;
+        const uint fullGroups = blocks.x * blocks.y * blockGroups;
+        if (groupIndex < fullGroups)
+        {
+            const uint block = groupIndex / blockGroups;
+            const uint code = groupIndex % blockGroups;
+            return uint2(block % blocks.x, block / blocks.x) * size + uint2(CompactMortonBits(code), CompactMortonBits(code >> 1u));
+        }
+
+        // The columns right of the blocks, then the rows below them
+        const uint rest = groupIndex - fullGroups;
+        const uint2 covered = blocks * size;
+        const uint rightWidth = groupCount.x - covered.x;
+        if (rightWidth != 0u && rest < rightWidth * covered.y)
+            return uint2(covered.x + rest % rightWidth, rest / rightWidth);
+
+        const uint below = rest - rightWidth * covered.y;
+        return uint2(below % groupCount.x, covered.y + below / groupCount.x);
+    }
+
+    if (swizzle == STF_GROUP_SWIZZLE_COLUMN_STRIPS && size != 0u)
+    {
+        const uint stripGroups = size * groupCount.y;
+        const uint strip = groupIndex / stripGroups;
+        const uint index = groupIndex % stripGroups;
+        const uint stripWidth = (strip + 1u) * size <= groupCount.x ? size : groupCount.x - strip * size;
+        return uint2(strip * size + index % stripWidth, index / stripWidth);
+    }
+
+    return uint2(groupIndex % groupCount.x, groupIndex / groupCount.x);
+}
+
+#endif // DISPATCH_SWIZZLE_H
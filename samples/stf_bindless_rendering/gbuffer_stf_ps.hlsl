@@ -49,10 +49,19 @@ void main(
 #if MOTION_VECTORS
     , out float3 o_motion : SV_Target6
 #endif
+#if DEFERRED_TEXELS
+    , out uint o_tangentFrame : SV_Target4
+    , out uint2 o_texelId : SV_Target7
+#endif
 )
 {
     float2 pixelPosition = i_position.xy * g_Const.view.viewportSizeInv;
 
+#if DEFERRED_TEXELS
+    o_tangentFrame = 0;
+    o_texelId = uint2(0, 0);
+#endif
+
 #if STF_ENABLED
     if (g_Const.stfSplitScreen)
     {
@@ -67,26 +76,42 @@ void main(
     }
 #endif
 
-    MaterialTextureSample textures = SampleMaterialTextures(i_vtx.texCoord, g_Material.normalTextureTransformScale, i_position.xy);
+#if DEFERRED_TEXELS
+    // The texel resolve loads the textures of the pixels with a texel ID, see gbuffer_texel_id.h. Pixels that may be
+    // clipped need their opacity here, they are shaded in the fill.
+    const bool mayClip = ALPHA_TESTED != 0 && g_Material.domain != MaterialDomain_Opaque;
+    if (!mayClip && GetMaterialTexelId(i_vtx.texCoord, i_position.xy, !i_isFrontFace, o_texelId))
+    {
+        o_tangentFrame = PackGBufferTangentFrame(i_vtx.normal, i_vtx.tangent.xyz, i_vtx.tangent.w);
+        o_channel0 = 0;
+        o_channel1 = 0;
+        o_channel2 = 0;
+        o_channel3 = 0;
+    }
+    else
+#endif
+    {
+        MaterialTextureSample textures = SampleMaterialTextures(i_vtx.texCoord, g_Material.normalTextureTransformScale, i_position.xy);
 
-    MaterialSample surface = EvaluateSceneMaterial(i_vtx.normal, i_vtx.tangent, g_Material, textures);
+        MaterialSample surface = EvaluateSceneMaterial(i_vtx.normal, i_vtx.tangent, g_Material, textures);
 
 #if ALPHA_TESTED
-    if (g_Material.domain != MaterialDomain_Opaque)
-        clip(surface.opacity - g_Material.alphaCutoff);
+        if (g_Material.domain != MaterialDomain_Opaque)
+            clip(surface.opacity - g_Material.alphaCutoff);
 #endif
 
-    if (!i_isFrontFace)
-        surface.shadingNormal = -surface.shadingNormal;
+        if (!i_isFrontFace)
+            surface.shadingNormal = -surface.shadingNormal;
 
-    o_channel0.xyz = surface.diffuseAlbedo;
-    o_channel0.w = surface.opacity;
-    o_channel1.xyz = surface.specularF0;
-    o_channel1.w = surface.occlusion;
-    o_channel2.xyz = surface.shadingNormal;
-    o_channel2.w = surface.roughness;
-    o_channel3.xyz = surface.emissiveColor;
-    o_channel3.w = 0;
+        o_channel0.xyz = surface.diffuseAlbedo;
+        o_channel0.w = surface.opacity;
+        o_channel1.xyz = surface.specularF0;
+        o_channel1.w = surface.occlusion;
+        o_channel2.xyz = surface.shadingNormal;
+        o_channel2.w = surface.roughness;
+        o_channel3.xyz = surface.emissiveColor;
+        o_channel3.w = 0;
+    }
 
     float4 debugColor;
     if (GetWaveVizMode(g_Const.stfDebugVisualizeLanes, uint2(i_position.xy), debugColor))
@@ -99,6 +124,9 @@ void main(
         o_channel2.w = 0;
         o_channel3.xyz = debugColor.xyz;
         o_channel3.w = 0;
+#if DEFERRED_TEXELS
+        o_texelId = uint2(0, 0);
+#endif
     }
 
 #if MOTION_VECTORS
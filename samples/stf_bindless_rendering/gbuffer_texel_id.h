@@ -0,0 +1,213 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef GBUFFER_TEXEL_ID_H
+#define GBUFFER_TEXEL_ID_H
+
+// Deferred texels: with DEFERRED_TEXELS, gbuffer_stf_ps stores where STF sampled instead of what it sampled, and
+// gbuffer_texel_resolve_ps loads the material textures once per visible pixel. Shared by the shaders and the CPU
+// rasterizer. C++ includes this like lighting_cb.h, with donut::math in scope.
+//
+// 96 bits per pixel:
+//  - GBufferTexelIds (RG32_UINT)
+//      x: the texture coordinates of the center of the STF texel, wrapped to [0, 1) in 16 bits per axis
+//      y: material ID (20 bits), mip (5 bits), log2 of the width of the first texture (5 bits), back face, resolve
+//  - GBufferGeoNormals (R32_UINT): the interpolated vertex normal in 2x11 bits of octahedral coordinates, the angle of
+//    the tangent around it in 8 bits, whether there is a tangent and the sign of the bitangent
+// The sample position is the one STF picked for the first texture of the material. The other textures load the texel
+// at the same texture coordinates on the mip of the same texel density, one finer per doubling of the width, exactly
+// the shared footprint when their size matches. The single position per material is deliberate: textures of other
+// sizes get the texel under it rather than a sample position of their own.
+// The fill stores IDs only while stfDeferredTexels is set, which FillStfConstants clears for the paths that do not take
+// one tap at the position of the library: the custom filter kernels, the sigma LOD of wide Gaussians, EWA and extra taps.
+// Pixels without the resolve bit were shaded by the fill (alpha-tested materials, the hardware sampler side of the
+// split screen) or are background.
+// The resolve shades the pixels in screen order. Binning or sorting them by texture for cache coherence is out of scope:
+// the gain is that each texture is loaded once per visible pixel instead of once per lane of the fill.
+
+#define GBUFFER_TEXEL_ID_MATERIAL_MASK 0xfffffu
+#define GBUFFER_TEXEL_ID_MIP_SHIFT 20
+#define GBUFFER_TEXEL_ID_MIP_MASK 0x1fu
+#define GBUFFER_TEXEL_ID_WIDTH_SHIFT 25
+#define GBUFFER_TEXEL_ID_WIDTH_MASK 0x1fu
+#define GBUFFER_TEXEL_ID_BACK_FACE 0x40000000u
+#define GBUFFER_TEXEL_ID_RESOLVE 0x80000000u
+
+#define GBUFFER_TANGENT_FRAME_HAS_TANGENT 0x40000000u
+#define GBUFFER_TANGENT_FRAME_BITANGENT_SIGN 0x80000000u
+
+#ifdef __cplusplus
+#define GBUFFER_TEXEL_ID_FUNCTION inline
+#else
+#define GBUFFER_TEXEL_ID_FUNCTION
+#endif
+
+struct GBufferTexelId
+{
+    float2 uv;          // the center of the texel in [0, 1)
+    uint mip;
+    uint log2Width;     // of mip 0 of the texture the position was picked for
+    uint materialId;
+    bool backFace;
+    bool resolve;
+};
+
+struct GBufferTangentBasis
+{
+    float3 b1;
+    float3 b2;
+};
+
+struct GBufferTangentFrame
+{
+    float3 normal;
+    float4 tangent;     // 0 without a tangent, w is the sign of the bitangent
+};
+
+// floor(log2(width)), exact for the power of two sizes of mipmapped textures
+GBUFFER_TEXEL_ID_FUNCTION uint GetGBufferLog2Width(uint width)
+{
+    uint log2Width = 0;
+    for (; width > 1; width >>= 1)
+        log2Width++;
+    return log2Width;
+}
+
+// texel and mipSize in texels of the mip the sample position is on, width the width of mip 0 of the texture
+GBUFFER_TEXEL_ID_FUNCTION uint2 PackGBufferTexelId(float2 texel, float2 mipSize, uint mip, uint width, uint materialId, bool backFace)
+{
+    // Texel centers of textures up to 32768 texels wide are exact in 16 bits
+    const float2 uv = (floor(texel) + 0.5f) / mipSize;
+    const float u = (uv.x - floor(uv.x)) * 65536.f;
+    const float v = (uv.y - floor(uv.y)) * 65536.f;
+    const uint packedUv = (uint(u) & 0xffffu) | ((uint(v) & 0xffffu) << 16);
+
+    uint packed = (materialId & GBUFFER_TEXEL_ID_MATERIAL_MASK) | ((mip & GBUFFER_TEXEL_ID_MIP_MASK) << GBUFFER_TEXEL_ID_MIP_SHIFT);
+    packed |= (GetGBufferLog2Width(width) & GBUFFER_TEXEL_ID_WIDTH_MASK) << GBUFFER_TEXEL_ID_WIDTH_SHIFT;
+    packed |= GBUFFER_TEXEL_ID_RESOLVE;
+    if (backFace)
+        packed |= GBUFFER_TEXEL_ID_BACK_FACE;
+    return uint2(packedUv, packed);
+}
+
+GBUFFER_TEXEL_ID_FUNCTION GBufferTexelId UnpackGBufferTexelId(uint2 packed)
+{
+    GBufferTexelId id;
+    id.uv = float2(float(packed.x & 0xffffu), float(packed.x >> 16)) / 65536.f;
+    id.materialId = packed.y & GBUFFER_TEXEL_ID_MATERIAL_MASK;
+    id.mip = (packed.y >> GBUFFER_TEXEL_ID_MIP_SHIFT) & GBUFFER_TEXEL_ID_MIP_MASK;
+    id.log2Width = (packed.y >> GBUFFER_TEXEL_ID_WIDTH_SHIFT) & GBUFFER_TEXEL_ID_WIDTH_MASK;
+    id.backFace = (packed.y & GBUFFER_TEXEL_ID_BACK_FACE) != 0;
+    id.resolve = (packed.y & GBUFFER_TEXEL_ID_RESOLVE) != 0;
+    return id;
+}
+
+// The mip of a texture of the material with the texel density of the mip of the ID: a texture twice as wide as the
+// first one loads one mip finer, half as wide one mip coarser
+GBUFFER_TEXEL_ID_FUNCTION uint GetGBufferTexelMip(GBufferTexelId id, uint width, uint mipCount)
+{
+    const int mip = int(id.mip) + int(GetGBufferLog2Width(width)) - int(id.log2Width);
+    return mip < 0 ? 0u : (uint(mip) < mipCount ? uint(mip) : mipCount - 1);
+}
+
+// The texel of a texture of any size under the texture coordinates of an ID, size is the size of its mip
+GBUFFER_TEXEL_ID_FUNCTION int2 GetGBufferTexel(float2 uv, int2 size)
+{
+    const int x = int(uv.x * float(size.x));
+    const int y = int(uv.y * float(size.y));
+    return int2(x < size.x ? x : size.x - 1, y < size.y ? y : size.y - 1);
+}
+
+GBUFFER_TEXEL_ID_FUNCTION uint PackGBufferOctahedral(float3 n)
+{
+    const float l1 = (n.x < 0.f ? -n.x : n.x) + (n.y < 0.f ? -n.y : n.y) + (n.z < 0.f ? -n.z : n.z);
+    float x = n.x / l1;
+    float y = n.y / l1;
+    if (n.z < 0.f)
+    {
+        const float foldedX = (1.f - (y < 0.f ? -y : y)) * (x < 0.f ? -1.f : 1.f);
+        const float foldedY = (1.f - (x < 0.f ? -x : x)) * (y < 0.f ? -1.f : 1.f);
+        x = foldedX;
+        y = foldedY;
+    }
+    const uint qx = uint(floor((x * 0.5f + 0.5f) * 2047.f + 0.5f));
+    const uint qy = uint(floor((y * 0.5f + 0.5f) * 2047.f + 0.5f));
+    return qx | (qy << 11);
+}
+
+GBUFFER_TEXEL_ID_FUNCTION float3 UnpackGBufferOctahedral(uint packed)
+{
+    const float x = float(packed & 0x7ffu) / 2047.f * 2.f - 1.f;
+    const float y = float((packed >> 11) & 0x7ffu) / 2047.f * 2.f - 1.f;
+    const float z = 1.f - (x < 0.f ? -x : x) - (y < 0.f ? -y : y);
+    float3 n = float3(x, y, z);
+    if (z < 0.f)
+    {
+        n.x = (1.f - (y < 0.f ? -y : y)) * (x < 0.f ? -1.f : 1.f);
+        n.y = (1.f - (x < 0.f ? -x : x)) * (y < 0.f ? -1.f : 1.f);
+    }
+    return normalize(n);
+}
+
+// Orthonormal basis around n (Duff et al. 2017), the reference direction of the tangent angle
+GBUFFER_TEXEL_ID_FUNCTION GBufferTangentBasis GetGBufferTangentBasis(float3 n)
+{
+    const float s = n.z >= 0.f ? 1.f : -1.f;
+    const float a = -1.f / (s + n.z);
+    const float b = n.x * n.y * a;
+    GBufferTangentBasis basis;
+    basis.b1 = float3(1.f + s * n.x * n.x * a, s * b, -s * n.x);
+    basis.b2 = float3(b, s + n.y * n.y * a, -n.y);
+    return basis;
+}
+
+// tangent and bitangentSign are the xyz and w of the vertex tangent
+GBUFFER_TEXEL_ID_FUNCTION uint PackGBufferTangentFrame(float3 normal, float3 tangent, float bitangentSign)
+{
+    const uint octahedral = PackGBufferOctahedral(normalize(normal));
+    uint packed = octahedral;
+
+    // The angle is measured in the basis of the decoded normal, so the fill and the resolve agree on it
+    const float3 n = UnpackGBufferOctahedral(octahedral);
+    const GBufferTangentBasis basis = GetGBufferTangentBasis(n);
+
+    const float3 t = tangent - n * dot(n, tangent);
+    if (dot(t, t) > 1e-12f)
+    {
+        const float angle = atan2(dot(t, basis.b2), dot(t, basis.b1));
+        const uint quantized = uint(floor((angle / 6.28318531f + 0.5f) * 256.f + 0.5f)) & 0xffu;
+        packed |= quantized << 22;
+        packed |= GBUFFER_TANGENT_FRAME_HAS_TANGENT;
+        if (bitangentSign < 0.f)
+            packed |= GBUFFER_TANGENT_FRAME_BITANGENT_SIGN;
+    }
+    return packed;
+}
+
+GBUFFER_TEXEL_ID_FUNCTION GBufferTangentFrame UnpackGBufferTangentFrame(uint packed)
+{
+    GBufferTangentFrame frame;
+    frame.normal = UnpackGBufferOctahedral(packed & 0x3fffffu);
+    frame.tangent = float4(0.f, 0.f, 0.f, 0.f);
+
+    if ((packed & GBUFFER_TANGENT_FRAME_HAS_TANGENT) != 0)
+    {
+        const GBufferTangentBasis basis = GetGBufferTangentBasis(frame.normal);
+
+        const float angle = (float((packed >> 22) & 0xffu) / 256.f - 0.5f) * 6.28318531f;
+        const float sign = (packed & GBUFFER_TANGENT_FRAME_BITANGENT_SIGN) != 0 ? -1.f : 1.f;
+        const float cosAngle = cos(angle);
+        const float sinAngle = sin(angle);
+        frame.tangent = float4(basis.b1 * cosAngle + basis.b2 * sinAngle, sign);
+    }
+    return frame;
+}
+
+#endif // GBUFFER_TEXEL_ID_H
@@ -0,0 +1,86 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma pack_matrix(row_major)
+
+#include <donut/shaders/bindless.h>
+#include <donut/shaders/binding_helpers.hlsli>
+#include <donut/shaders/scene_material.hlsli>
+#include "gbuffer_texel_id.h"
+
+// Resolve of the deferred texel G-buffer, see gbuffer_texel_id.h: loads the material textures at the texel the fill
+// stored for each pixel and writes the channels gbuffer_stf_ps writes, once per visible pixel. Pixels the fill shaded
+// itself are discarded and keep their channels.
+
+Texture2D<uint2> t_TexelIds : register(t0);
+Texture2D<uint> t_TangentFrames : register(t1);
+StructuredBuffer<MaterialConstants> t_MaterialConstants : register(t2);
+
+VK_BINDING(1, 1) Texture2D t_BindlessTextures[] : register(t0, space2);
+
+float4 LoadMaterialTexture(int textureIndex, GBufferTexelId id)
+{
+    Texture2D texture = t_BindlessTextures[NonUniformResourceIndex(textureIndex)];
+
+    uint width, height, mipCount;
+    texture.GetDimensions(0, width, height, mipCount);
+
+    const uint mip = GetGBufferTexelMip(id, width, mipCount);
+    const int2 size = int2(max(uint2(width, height) >> mip, 1u));
+    return texture.Load(int3(GetGBufferTexel(id.uv, size), mip));
+}
+
+void main(
+    in float4 i_position : SV_Position,
+    in float2 i_uv : UV,
+    out float4 o_channel0 : SV_Target0,
+    out float4 o_channel1 : SV_Target1,
+    out float4 o_channel2 : SV_Target2,
+    out float4 o_channel3 : SV_Target3
+)
+{
+    const int2 pixel = int2(i_position.xy);
+    const GBufferTexelId id = UnpackGBufferTexelId(t_TexelIds[pixel]);
+    if (!id.resolve)
+        discard;
+
+    const MaterialConstants material = t_MaterialConstants[id.materialId];
+    const GBufferTangentFrame frame = UnpackGBufferTangentFrame(t_TangentFrames[pixel]);
+
+    MaterialTextureSample textures = DefaultMaterialTextures();
+    if ((material.flags & MaterialFlags_UseBaseOrDiffuseTexture) != 0)
+        textures.baseOrDiffuse = LoadMaterialTexture(material.baseOrDiffuseTextureIndex, id);
+    if ((material.flags & MaterialFlags_UseMetalRoughOrSpecularTexture) != 0)
+        textures.metalRoughOrSpecular = LoadMaterialTexture(material.metalRoughOrSpecularTextureIndex, id);
+    if ((material.flags & MaterialFlags_UseEmissiveTexture) != 0)
+        textures.emissive = LoadMaterialTexture(material.emissiveTextureIndex, id);
+    if ((material.flags & MaterialFlags_UseNormalTexture) != 0)
+        textures.normal = LoadMaterialTexture(material.normalTextureIndex, id);
+    if ((material.flags & MaterialFlags_UseOcclusionTexture) != 0)
+        textures.occlusion = LoadMaterialTexture(material.occlusionTextureIndex, id);
+    if ((material.flags & MaterialFlags_UseTransmissionTexture) != 0)
+        textures.transmission = LoadMaterialTexture(material.transmissionTextureIndex, id);
+    if ((material.flags & MaterialFlags_UseOpacityTexture) != 0)
+        textures.opacity = LoadMaterialTexture(material.opacityTextureIndex, id).x;
+
+    MaterialSample surface = EvaluateSceneMaterial(frame.normal, frame.tangent, material, textures);
+
+    if (id.backFace)
+        surface.shadingNormal = -surface.shadingNormal;
+
+    o_channel0.xyz = surface.diffuseAlbedo;
+    o_channel0.w = surface.opacity;
+    o_channel1.xyz = surface.specularF0;
+    o_channel1.w = surface.occlusion;
+    o_channel2.xyz = surface.shadingNormal;
+    o_channel2.w = surface.roughness;
+    o_channel3.xyz = surface.emissiveColor;
+    o_channel3.w = 0;
+}
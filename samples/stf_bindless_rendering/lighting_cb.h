@@ -41,7 +41,27 @@ struct LightingConstants
     uint stfUseWhiteNoise;
     uint stfDebugOnFailure;
     uint stfDebugVisualizeLanes;
-    uint pad;
+    uint stfCollectStats;
+
+    uint stfGroupSwizzle;       // STF_GROUP_SWIZZLE_*, compute pipeline only
+    uint stfGroupSwizzleSize;
+    uint stfShareFootprints;    // one STF sample position per group of equally sized textures, see stf_shared_footprint.hlsli
+    uint stfConstantFootprints; // one fetch for constant footprints, see stf_constant_footprint.hlsli
+
+    uint stfDecorrelateTextures; // per-texture rotation of the random numbers, see stf_decorrelation.h
+    uint stfMaxTaps;            // 1, 2 or 4 taps per sample, see stf_multi_tap.hlsli
+    float stfTapContrast;       // quad contrast that takes 2 taps, twice that takes 4
+    uint stfFilterKernel;       // STF_FILTER_KERNEL_* of stfFilterKernelEnabled, see stf_filter_kernel.hlsli
+
+    float stfSigmaLodTarget;    // Gaussian sigma above which the level of detail moves up, 0 is off, see stf_sigma_lod.h
+    uint stfTemporalStrata;     // frames per cycle of the stratified random numbers, 1 is off, see stf_temporal_strata.h
+    uint stfTemporalGenerator;  // lattice generator of stfTemporalStrata
+    uint stfFilterKernelEnabled; // stfFilterKernel filters in place of stfFilterMode, which stays linear for the library
+
+    uint stfEwaEnabled;         // EWA on the gradient paths, stfMinificationMethod stays the default for the library, see stf_ewa.hlsli
+    uint stfDeferredTexels;     // the DEFERRED_TEXELS fill stores texel IDs, see gbuffer_texel_id.h
+    uint stfPad4;
+    uint stfPad5;
 };
 
 #endif // LIGHTING_CB_H
\ No newline at end of file
@@ -16,6 +16,8 @@
 #include "rng.hlsli"
 
 #include "../../libraries/RTXTF-Library/STFSamplerState.hlsli"
+#include "stf_temporal_strata.h"
+#include "gbuffer_texel_id.h"
 
 
 // Bindings - can be overriden before including this file if necessary
@@ -72,6 +74,18 @@
 #define MATERIAL_BLUE_NOISE_SLOT 0
 #endif
 
+#ifndef MATERIAL_STF_STATS_SLOT
+#define MATERIAL_STF_STATS_SLOT 0
+#endif
+
+#ifndef MATERIAL_STF_CONSTANT_FOOTPRINT_SLOT
+#define MATERIAL_STF_CONSTANT_FOOTPRINT_SLOT 1
+#endif
+
+#ifndef MATERIAL_STF_FILTER_KERNEL_SLOT
+#define MATERIAL_STF_FILTER_KERNEL_SLOT 2
+#endif
+
 cbuffer c_Material : REGISTER_CBUFFER(MATERIAL_CB_SLOT, MATERIAL_REGISTER_SPACE)
 {
     MaterialConstants g_Material;
@@ -88,137 +102,187 @@ Texture2D t_Transmission         : REGISTER_SRV(MATERIAL_TRANSMISSION_SLOT,  MAT
 Texture2D t_Opacity              : REGISTER_SRV(MATERIAL_OPACITY_SLOT,       MATERIAL_REGISTER_SPACE);
 SamplerState s_MaterialSampler   : REGISTER_SAMPLER(MATERIAL_SAMPLER_SLOT,   MATERIAL_SAMPLER_REGISTER_SPACE);
 Texture2D STBN2DTexture          : REGISTER_SRV(MATERIAL_BLUE_NOISE_SLOT,    GBUFFER_SPACE_VIEW);
+RWByteAddressBuffer u_StfStats   : REGISTER_UAV(MATERIAL_STF_STATS_SLOT,     GBUFFER_SPACE_VIEW);
+ByteAddressBuffer t_StfConstantFootprints : REGISTER_SRV(MATERIAL_STF_CONSTANT_FOOTPRINT_SLOT, GBUFFER_SPACE_VIEW);
+ByteAddressBuffer t_StfFilterKernel : REGISTER_SRV(MATERIAL_STF_FILTER_KERNEL_SLOT, GBUFFER_SPACE_VIEW);
 
-float4 SampleTexture(inout STF_SamplerState stfSamplerState, bool stfEnabled, Texture2D texture, SamplerState materialSampler, float2 texCoord)
+#include "stf_texture_sampling.hlsli"
+
+float4 SampleTexture(inout STF_SamplerState stfSamplerState, inout StfSharedFootprint footprint, bool stfEnabled, Texture2D texture, int textureIndex, SamplerState materialSampler, float2 texCoord)
 {
-#if STF_ENABLED
-    if (stfEnabled)
-    {
-        #if STF_LOAD
-            return stfSamplerState.Texture2DLoad(texture, texCoord);
-        #else
-            return stfSamplerState.Texture2DSample(texture, materialSampler, texCoord);
-        #endif
-    } else
-#endif
-    {
-        return texture.Sample(materialSampler, texCoord);
-    }
+    return SampleStfTexture(stfSamplerState, footprint, stfEnabled, texture, textureIndex, materialSampler, texCoord,
+        StfTextureLod::CreateImplicit(ddx(texCoord), ddy(texCoord)));
 }
 
-float4 SampleTextureLevel(inout STF_SamplerState stfSamplerState, bool stfEnabled, Texture2D texture, SamplerState materialSampler, float2 texCoord, float mipLevel)
+float4 SampleTextureLevel(inout STF_SamplerState stfSamplerState, inout StfSharedFootprint footprint, bool stfEnabled, Texture2D texture, int textureIndex, SamplerState materialSampler, float2 texCoord, float mipLevel)
 {
-#if STF_ENABLED
-    if (stfEnabled)
-    {
-        #if STF_LOAD
-            return stfSamplerState.Texture2DLoadLevel(texture, texCoord, mipLevel);
-        #else
-            return stfSamplerState.Texture2DSampleLevel(texture, materialSampler, texCoord, mipLevel);
-        #endif
-    } else
-#endif
-    {
-        return texture.SampleLevel(materialSampler, texCoord, mipLevel);
-    }
+    return SampleStfTexture(stfSamplerState, footprint, stfEnabled, texture, textureIndex, materialSampler, texCoord, StfTextureLod::CreateLevel(mipLevel));
 }
 
-float4 SampleTextureGrad(inout STF_SamplerState stfSamplerState, bool stfEnabled, Texture2D texture, SamplerState materialSampler, float2 texCoord, float2 dx, float2 dy)
+float4 SampleTextureGrad(inout STF_SamplerState stfSamplerState, inout StfSharedFootprint footprint, bool stfEnabled, Texture2D texture, int textureIndex, SamplerState materialSampler, float2 texCoord, float2 dx, float2 dy)
 {
-#if STF_ENABLED
-    if (stfEnabled)
-    {
-        #if STF_LOAD
-            return stfSamplerState.Texture2DLoadGrad(texture, texCoord, dx, dy);
-        #else
-            return stfSamplerState.Texture2DSampleGrad(texture, materialSampler, texCoord, dx, dy);
-        #endif
-    } else
-#endif
-    {
-        return texture.SampleGrad(materialSampler, texCoord, dx, dy);
-    }
+    return SampleStfTexture(stfSamplerState, footprint, stfEnabled, texture, textureIndex, materialSampler, texCoord, StfTextureLod::CreateGrad(dx, dy));
 }
 
-void InitSTF(inout STF_SamplerState stfSamplerState, uint2 pixelPosition)
+// u returns the random numbers of the pixel for DecorrelateSTF
+void InitSTF(inout STF_SamplerState stfSamplerState, uint2 pixelPosition, out float3 u)
 {
-    float3 u = RNG::SpatioTemporalBlueNoise2D(pixelPosition, g_Const.stfFrameIndex, STBN2DTexture);
+    const uint noiseFrame = GetStfTemporalStrataFrame(g_Const.stfFrameIndex, g_Const.stfTemporalStrata);
+    u = RNG::SpatioTemporalBlueNoise2D(pixelPosition, noiseFrame, STBN2DTexture);
     if (g_Const.stfUseWhiteNoise)
-        u = RNG::SpatioTemporalWhiteNoise3D(pixelPosition, g_Const.stfFrameIndex);
-
-    stfSamplerState = STF_SamplerState::Create(float4(u.x, u.y, 0 /*slice - unused*/, u.z));
-    stfSamplerState.SetFilterType(g_Const.stfFilterMode);
-    stfSamplerState.SetFrameIndex(g_Const.stfFrameIndex);
-    stfSamplerState.SetMagMethod(g_Const.stfMagnificationMethod);
-    stfSamplerState.SetFallbackMethod(g_Const.stfFallbackMethod);
-    stfSamplerState.SetAddressingModes(g_Const.stfAddressMode.xxx);
-    stfSamplerState.SetSigma(g_Const.stfSigma);
-    stfSamplerState.SetAnisoMethod(g_Const.stfMinificationMethod);
-    stfSamplerState.SetReseedOnSample(g_Const.stfReseedOnSample);
-    stfSamplerState.SetDebugFailure(g_Const.stfDebugOnFailure);
+        u = RNG::SpatioTemporalWhiteNoise3D(pixelPosition, noiseFrame);
+    u = StratifyStfRandom(u, g_Const.stfFrameIndex, g_Const.stfTemporalStrata, g_Const.stfTemporalGenerator);
+
+    stfSamplerState = CreateSTF(u);
 }
 
-MaterialTextureSample SampleMaterialTextures(float2 texCoord, float2 normalTexCoordScale, float2 pixelPosition)
+// False for alpha-tested materials and on the hardware sampler side of the split screen
+bool IsMaterialStfEnabled(float2 pixelPosition)
 {
-    MaterialTextureSample values = DefaultMaterialTextures();
-
-    STF_SamplerState stfSamplerState;
-    InitSTF(stfSamplerState, pixelPosition);
-
 #if STF_ENABLED
     bool stfEnabled = true && g_Material.domain != MaterialDomain_AlphaTested;
     if (g_Const.stfSplitScreen && pixelPosition.x > (g_Const.view.viewportSize.x / 2.f))
     {
         stfEnabled = false;
     }
+    return stfEnabled;
 #else
-    const bool stfEnabled = false;
+    return false;
 #endif
+}
+
+MaterialTextureSample SampleMaterialTextures(float2 texCoord, float2 normalTexCoordScale, float2 pixelPosition)
+{
+    MaterialTextureSample values = DefaultMaterialTextures();
+
+    STF_SamplerState stfSamplerState;
+    float3 u;
+    InitSTF(stfSamplerState, pixelPosition, u);
+
+    const bool stfEnabled = IsMaterialStfEnabled(pixelPosition);
+
+    const bool shareFootprints = StfSharedFootprint::IsSharedFootprintEnabled(g_Const.stfShareFootprints != 0, g_Const.stfMagnificationMethod,
+        g_Const.stfReseedOnSample != 0 || g_Const.stfDecorrelateTextures != 0);
+    StfSharedFootprint footprint = StfSharedFootprint::CreateGrad(shareFootprints, texCoord, ddx(texCoord), ddy(texCoord));
 
     if ((g_Material.flags & MaterialFlags_UseBaseOrDiffuseTexture) != 0)
     {
-        values.baseOrDiffuse = SampleTexture(stfSamplerState, stfEnabled, t_BaseOrDiffuse, s_MaterialSampler, texCoord);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_BASE_OR_DIFFUSE);
+        values.baseOrDiffuse = SampleTexture(stfSamplerState, footprint, stfEnabled, t_BaseOrDiffuse, g_Material.baseOrDiffuseTextureIndex, s_MaterialSampler, texCoord);
     }
 
     if ((g_Material.flags & MaterialFlags_UseMetalRoughOrSpecularTexture) != 0)
     {
-        values.metalRoughOrSpecular = SampleTexture(stfSamplerState, stfEnabled, t_MetalRoughOrSpecular, s_MaterialSampler, texCoord);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_METAL_ROUGH_OR_SPECULAR);
+        values.metalRoughOrSpecular = SampleTexture(stfSamplerState, footprint, stfEnabled, t_MetalRoughOrSpecular, g_Material.metalRoughOrSpecularTextureIndex, s_MaterialSampler, texCoord);
     }
 
     if ((g_Material.flags & MaterialFlags_UseEmissiveTexture) != 0)
     {
-        values.emissive = SampleTexture(stfSamplerState, stfEnabled, t_Emissive, s_MaterialSampler, texCoord);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_EMISSIVE);
+        values.emissive = SampleTexture(stfSamplerState, footprint, stfEnabled, t_Emissive, g_Material.emissiveTextureIndex, s_MaterialSampler, texCoord);
     }
 
     if ((g_Material.flags & MaterialFlags_UseNormalTexture) != 0)
     {
-        values.normal = SampleTexture(stfSamplerState, stfEnabled, t_Normal, s_MaterialSampler, texCoord);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_NORMAL);
+        values.normal = SampleTexture(stfSamplerState, footprint, stfEnabled, t_Normal, g_Material.normalTextureIndex, s_MaterialSampler, texCoord);
     }
 
     if ((g_Material.flags & MaterialFlags_UseOcclusionTexture) != 0)
     {
-        values.occlusion = SampleTexture(stfSamplerState, stfEnabled, t_Occlusion, s_MaterialSampler, texCoord);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_OCCLUSION);
+        values.occlusion = SampleTexture(stfSamplerState, footprint, stfEnabled, t_Occlusion, g_Material.occlusionTextureIndex, s_MaterialSampler, texCoord);
     }
 
     if ((g_Material.flags & MaterialFlags_UseTransmissionTexture) != 0)
     {
-        values.transmission = SampleTexture(stfSamplerState, stfEnabled, t_Transmission, s_MaterialSampler, texCoord);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_TRANSMISSION);
+        values.transmission = SampleTexture(stfSamplerState, footprint, stfEnabled, t_Transmission, g_Material.transmissionTextureIndex, s_MaterialSampler, texCoord);
     }
 
     if ((g_Material.flags & MaterialFlags_UseOpacityTexture) != 0)
     {
-        values.opacity = SampleTexture(stfSamplerState, stfEnabled, t_Opacity, s_MaterialSampler, texCoord).x;
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_OPACITY);
+        values.opacity = SampleTexture(stfSamplerState, footprint, stfEnabled, t_Opacity, g_Material.opacityTextureIndex, s_MaterialSampler, texCoord).x;
     }
 
     return values;
 }
 
+// Deferred texels: the texel ID (gbuffer_texel_id.h) of the sample position STF picks for the first texture of the
+// material, with the random numbers SampleMaterialTextures gives that texture. The position is the single-lane one,
+// the magnification methods of SampleTexture do not apply. False when the fill shades the pixel itself: STF is off for
+// it, stfDeferredTexels is not set, or the material has no textures.
+bool GetMaterialTexelId(float2 texCoord, float2 pixelPosition, bool backFace, out uint2 texelId)
+{
+    texelId = uint2(0, 0);
+
+    // Before the split screen makes the lanes of a quad diverge
+    const float2 ddxUV = ddx(texCoord);
+    const float2 ddyUV = ddy(texCoord);
+    if (g_Const.stfDeferredTexels == 0 || !IsMaterialStfEnabled(pixelPosition))
+        return false;
+
+    uint width = 0, height = 0, mipCount = 0;
+    uint textureSlot = STF_TEXTURE_SLOT_BASE_OR_DIFFUSE;
+    if ((g_Material.flags & MaterialFlags_UseBaseOrDiffuseTexture) != 0)
+    {
+        t_BaseOrDiffuse.GetDimensions(0, width, height, mipCount);
+    }
+    else if ((g_Material.flags & MaterialFlags_UseMetalRoughOrSpecularTexture) != 0)
+    {
+        t_MetalRoughOrSpecular.GetDimensions(0, width, height, mipCount);
+        textureSlot = STF_TEXTURE_SLOT_METAL_ROUGH_OR_SPECULAR;
+    }
+    else if ((g_Material.flags & MaterialFlags_UseEmissiveTexture) != 0)
+    {
+        t_Emissive.GetDimensions(0, width, height, mipCount);
+        textureSlot = STF_TEXTURE_SLOT_EMISSIVE;
+    }
+    else if ((g_Material.flags & MaterialFlags_UseNormalTexture) != 0)
+    {
+        t_Normal.GetDimensions(0, width, height, mipCount);
+        textureSlot = STF_TEXTURE_SLOT_NORMAL;
+    }
+    else if ((g_Material.flags & MaterialFlags_UseOcclusionTexture) != 0)
+    {
+        t_Occlusion.GetDimensions(0, width, height, mipCount);
+        textureSlot = STF_TEXTURE_SLOT_OCCLUSION;
+    }
+    else if ((g_Material.flags & MaterialFlags_UseTransmissionTexture) != 0)
+    {
+        t_Transmission.GetDimensions(0, width, height, mipCount);
+        textureSlot = STF_TEXTURE_SLOT_TRANSMISSION;
+    }
+    else if ((g_Material.flags & MaterialFlags_UseOpacityTexture) != 0)
+    {
+        t_Opacity.GetDimensions(0, width, height, mipCount);
+        textureSlot = STF_TEXTURE_SLOT_OPACITY;
+    }
+
+    if (mipCount == 0)
+        return false;
+
+    STF_SamplerState stfSamplerState;
+    float3 u;
+    InitSTF(stfSamplerState, pixelPosition, u);
+    DecorrelateSTF(stfSamplerState, u, textureSlot);
+
+    const float3 samplePos = stfSamplerState.Texture2DGetSamplePosGrad(width, height, mipCount, texCoord, ddxUV, ddyUV);
+    const uint mip = uint(samplePos.z);
+    const uint2 mipSize = max(uint2(width, height) >> mip, 1u);
+    texelId = PackGBufferTexelId(samplePos.xy, float2(mipSize), mip, width, uint(g_Material.materialID), backFace);
+    return true;
+}
+
 MaterialTextureSample SampleMaterialTexturesLevel(float2 texCoord, float lod, float2 pixelPosition)
 {
     MaterialTextureSample values = DefaultMaterialTextures();
 
     STF_SamplerState stfSamplerState;
-    InitSTF(stfSamplerState, pixelPosition);
+    float3 u;
+    InitSTF(stfSamplerState, pixelPosition, u);
     
 #if STF_ENABLED
     bool stfEnabled = true;
@@ -230,39 +294,50 @@ MaterialTextureSample SampleMaterialTexturesLevel(float2 texCoord, float lod, fl
     const bool stfEnabled = false;
 #endif
 
+    const bool shareFootprints = StfSharedFootprint::IsSharedFootprintEnabled(g_Const.stfShareFootprints != 0, g_Const.stfMagnificationMethod,
+        g_Const.stfReseedOnSample != 0 || g_Const.stfDecorrelateTextures != 0);
+    StfSharedFootprint footprint = StfSharedFootprint::CreateLevel(shareFootprints, texCoord, lod);
+
     if ((g_Material.flags & MaterialFlags_UseBaseOrDiffuseTexture) != 0)
     {
-        values.baseOrDiffuse = SampleTextureLevel(stfSamplerState, stfEnabled, t_BaseOrDiffuse, s_MaterialSampler, texCoord, lod);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_BASE_OR_DIFFUSE);
+        values.baseOrDiffuse = SampleTextureLevel(stfSamplerState, footprint, stfEnabled, t_BaseOrDiffuse, g_Material.baseOrDiffuseTextureIndex, s_MaterialSampler, texCoord, lod);
     }
 
     if ((g_Material.flags & MaterialFlags_UseMetalRoughOrSpecularTexture) != 0)
     {
-        values.metalRoughOrSpecular = SampleTextureLevel(stfSamplerState, stfEnabled, t_MetalRoughOrSpecular, s_MaterialSampler, texCoord, lod);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_METAL_ROUGH_OR_SPECULAR);
+        values.metalRoughOrSpecular = SampleTextureLevel(stfSamplerState, footprint, stfEnabled, t_MetalRoughOrSpecular, g_Material.metalRoughOrSpecularTextureIndex, s_MaterialSampler, texCoord, lod);
     }
 
     if ((g_Material.flags & MaterialFlags_UseEmissiveTexture) != 0)
     {
-        values.emissive = SampleTextureLevel(stfSamplerState, stfEnabled, t_Emissive, s_MaterialSampler, texCoord, lod);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_EMISSIVE);
+        values.emissive = SampleTextureLevel(stfSamplerState, footprint, stfEnabled, t_Emissive, g_Material.emissiveTextureIndex, s_MaterialSampler, texCoord, lod);
     }
 
     if ((g_Material.flags & MaterialFlags_UseNormalTexture) != 0)
     {
-        values.normal = SampleTextureLevel(stfSamplerState, stfEnabled, t_Normal, s_MaterialSampler, texCoord, lod);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_NORMAL);
+        values.normal = SampleTextureLevel(stfSamplerState, footprint, stfEnabled, t_Normal, g_Material.normalTextureIndex, s_MaterialSampler, texCoord, lod);
     }
 
     if ((g_Material.flags & MaterialFlags_UseOcclusionTexture) != 0)
     {
-        values.occlusion = SampleTextureLevel(stfSamplerState, stfEnabled, t_Occlusion, s_MaterialSampler, texCoord, lod);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_OCCLUSION);
+        values.occlusion = SampleTextureLevel(stfSamplerState, footprint, stfEnabled, t_Occlusion, g_Material.occlusionTextureIndex, s_MaterialSampler, texCoord, lod);
     }
 
     if ((g_Material.flags & MaterialFlags_UseTransmissionTexture) != 0)
     {
-        values.transmission = SampleTextureLevel(stfSamplerState, stfEnabled, t_Transmission, s_MaterialSampler, texCoord, lod);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_TRANSMISSION);
+        values.transmission = SampleTextureLevel(stfSamplerState, footprint, stfEnabled, t_Transmission, g_Material.transmissionTextureIndex, s_MaterialSampler, texCoord, lod);
     }
 
     if ((g_Material.flags & MaterialFlags_UseOpacityTexture) != 0)
     {
-        values.opacity = SampleTextureLevel(stfSamplerState, stfEnabled, t_Opacity, s_MaterialSampler, texCoord, lod).x;
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_OPACITY);
+        values.opacity = SampleTextureLevel(stfSamplerState, footprint, stfEnabled, t_Opacity, g_Material.opacityTextureIndex, s_MaterialSampler, texCoord, lod).x;
     }
 
     return values;
@@ -273,7 +348,8 @@ MaterialTextureSample SampleMaterialTexturesGrad(float2 texCoord, float2 ddx, fl
     MaterialTextureSample values = DefaultMaterialTextures();
 
     STF_SamplerState stfSamplerState;
-    InitSTF(stfSamplerState, pixelPosition);
+    float3 u;
+    InitSTF(stfSamplerState, pixelPosition, u);
     
 #if STF_ENABLED
     bool stfEnabled = true;
@@ -285,39 +361,50 @@ MaterialTextureSample SampleMaterialTexturesGrad(float2 texCoord, float2 ddx, fl
     const bool stfEnabled = false;
 #endif
 
+    const bool shareFootprints = StfSharedFootprint::IsSharedFootprintEnabled(g_Const.stfShareFootprints != 0, g_Const.stfMagnificationMethod,
+        g_Const.stfReseedOnSample != 0 || g_Const.stfDecorrelateTextures != 0);
+    StfSharedFootprint footprint = StfSharedFootprint::CreateGrad(shareFootprints, texCoord, ddx, ddy);
+
     if ((g_Material.flags & MaterialFlags_UseBaseOrDiffuseTexture) != 0)
     {
-        values.baseOrDiffuse = SampleTextureGrad(stfSamplerState, stfEnabled, t_BaseOrDiffuse, s_MaterialSampler, texCoord, ddx, ddy);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_BASE_OR_DIFFUSE);
+        values.baseOrDiffuse = SampleTextureGrad(stfSamplerState, footprint, stfEnabled, t_BaseOrDiffuse, g_Material.baseOrDiffuseTextureIndex, s_MaterialSampler, texCoord, ddx, ddy);
     }
 
     if ((g_Material.flags & MaterialFlags_UseMetalRoughOrSpecularTexture) != 0)
     {
-        values.metalRoughOrSpecular = SampleTextureGrad(stfSamplerState, stfEnabled, t_MetalRoughOrSpecular, s_MaterialSampler, texCoord, ddx, ddy);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_METAL_ROUGH_OR_SPECULAR);
+        values.metalRoughOrSpecular = SampleTextureGrad(stfSamplerState, footprint, stfEnabled, t_MetalRoughOrSpecular, g_Material.metalRoughOrSpecularTextureIndex, s_MaterialSampler, texCoord, ddx, ddy);
     }
 
     if ((g_Material.flags & MaterialFlags_UseEmissiveTexture) != 0)
     {
-        values.emissive = SampleTextureGrad(stfSamplerState, stfEnabled, t_Emissive, s_MaterialSampler, texCoord, ddx, ddy);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_EMISSIVE);
+        values.emissive = SampleTextureGrad(stfSamplerState, footprint, stfEnabled, t_Emissive, g_Material.emissiveTextureIndex, s_MaterialSampler, texCoord, ddx, ddy);
     }
 
     if ((g_Material.flags & MaterialFlags_UseNormalTexture) != 0)
     {
-        values.normal = SampleTextureGrad(stfSamplerState, stfEnabled, t_Normal, s_MaterialSampler, texCoord, ddx, ddy);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_NORMAL);
+        values.normal = SampleTextureGrad(stfSamplerState, footprint, stfEnabled, t_Normal, g_Material.normalTextureIndex, s_MaterialSampler, texCoord, ddx, ddy);
     }
 
     if ((g_Material.flags & MaterialFlags_UseOcclusionTexture) != 0)
     {
-        values.occlusion = SampleTextureGrad(stfSamplerState, stfEnabled, t_Occlusion, s_MaterialSampler, texCoord, ddx, ddy);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_OCCLUSION);
+        values.occlusion = SampleTextureGrad(stfSamplerState, footprint, stfEnabled, t_Occlusion, g_Material.occlusionTextureIndex, s_MaterialSampler, texCoord, ddx, ddy);
     }
 
     if ((g_Material.flags & MaterialFlags_UseTransmissionTexture) != 0)
     {
-        values.transmission = SampleTextureGrad(stfSamplerState, stfEnabled, t_Transmission, s_MaterialSampler, texCoord, ddx, ddy);
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_TRANSMISSION);
+        values.transmission = SampleTextureGrad(stfSamplerState, footprint, stfEnabled, t_Transmission, g_Material.transmissionTextureIndex, s_MaterialSampler, texCoord, ddx, ddy);
     }
 
     if ((g_Material.flags & MaterialFlags_UseOpacityTexture) != 0)
     {
-        values.opacity = SampleTextureGrad(stfSamplerState, stfEnabled, t_Opacity, s_MaterialSampler, texCoord, ddx, ddy).x;
+        DecorrelateSTF(stfSamplerState, u, STF_TEXTURE_SLOT_OPACITY);
+        values.opacity = SampleTextureGrad(stfSamplerState, footprint, stfEnabled, t_Opacity, g_Material.opacityTextureIndex, s_MaterialSampler, texCoord, ddx, ddy).x;
     }
 
     return values;
@@ -0,0 +1,112 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef __RAY_DIFFERENTIALS_HLSLI__
+#define __RAY_DIFFERENTIALS_HLSLI__
+
+// Texture gradients from ray differentials (Igehy, "Tracing Ray Differentials").
+// The change of the ray per pixel step is carried to the hit point, and the triangle's texture coordinate
+// Jacobian turns the position change into texGrad_x/y. Mirrored on the CPU in RayDifferentials.h.
+
+// Change of a ray per pixel step in x and y. Directions are normalized.
+struct RayDifferential
+{
+    float3 dOdx;
+    float3 dOdy;
+    float3 dDdx;
+    float3 dDdy;
+};
+
+// Gradients of the texture coordinates with respect to a position in the triangle plane
+struct TexcoordJacobian
+{
+    float3 dUdP;
+    float3 dVdP;
+};
+
+// edge1 and edge2 are the triangle edges from vertex 0 in the space the position differentials live in
+TexcoordJacobian computeTexcoordJacobian(float3 edge1, float3 edge2, float2 texcoords[3])
+{
+    const float3 normal = cross(edge1, edge2);
+    const float invLengthSquared = 1.0 / max(dot(normal, normal), 1e-30);
+
+    // Gradients of the barycentrics of vertex 1 and 2 in the triangle plane
+    const float3 dB1dP = cross(edge2, normal) * invLengthSquared;
+    const float3 dB2dP = cross(normal, edge1) * invLengthSquared;
+
+    const float2 texEdge1 = texcoords[1] - texcoords[0];
+    const float2 texEdge2 = texcoords[2] - texcoords[0];
+
+    TexcoordJacobian jacobian;
+    jacobian.dUdP = dB1dP * texEdge1.x + dB2dP * texEdge2.x;
+    jacobian.dVdP = dB1dP * texEdge1.y + dB2dP * texEdge2.y;
+    return jacobian;
+}
+
+// Differential of the camera ray setupPrimaryRay builds for pixelPosition.
+// The derivative of the unprojected position comes from the rows of matClipToWorld, no neighbor rays are built.
+RayDifferential getPrimaryRayDifferential(uint2 pixelPosition, PlanarViewConstants view)
+{
+    float2 uv = (float2(pixelPosition) + 0.5) * view.viewportSizeInv;
+    float4 clipPos = float4(uv.x * 2.0 - 1.0, 1.0 - uv.y * 2.0, 0.5, 1);
+    float4 worldPos = mul(clipPos, view.matClipToWorld);
+    float3 position = worldPos.xyz / worldPos.w;
+
+    // One pixel is 2 / width in clip x and -2 / height in clip y
+    float4 dWorldPos_x = view.matClipToWorld[0] * (2.0 * view.viewportSizeInv.x);
+    float4 dWorldPos_y = view.matClipToWorld[1] * (-2.0 * view.viewportSizeInv.y);
+    float3 dPosition_x = (dWorldPos_x.xyz - position * dWorldPos_x.w) / worldPos.w;
+    float3 dPosition_y = (dWorldPos_y.xyz - position * dWorldPos_y.w) / worldPos.w;
+
+    // Derivative of normalize(position - cameraPosition)
+    float3 direction = position - view.cameraDirectionOrPosition.xyz;
+    float invLength = rsqrt(dot(direction, direction));
+    float3 normalized = direction * invLength;
+
+    RayDifferential differential;
+    differential.dOdx = 0;
+    differential.dOdy = 0;
+    differential.dDdx = (dPosition_x - normalized * dot(normalized, dPosition_x)) * invLength;
+    differential.dDdy = (dPosition_y - normalized * dot(normalized, dPosition_y)) * invLength;
+    return differential;
+}
+
+// Change of the hit position per pixel step for a hit at hitT along the normalized direction.
+// normal is the plane of the hit triangle and does not need to be normalized.
+void transferRayDifferential(RayDifferential differential, float3 direction, float hitT, float3 normal,
+    out float3 dP_x, out float3 dP_y)
+{
+    float invDirectionDotNormal = 1.0 / dot(direction, normal);
+
+    dP_x = differential.dOdx + differential.dDdx * hitT;
+    dP_y = differential.dOdy + differential.dDdy * hitT;
+    dP_x -= direction * (dot(dP_x, normal) * invDirectionDotNormal);
+    dP_y -= direction * (dot(dP_y, normal) * invDirectionDotNormal);
+}
+
+// Differential of the ray reflected at the hit, treating the surface as flat over the pixel footprint.
+// normal must be normalized here.
+RayDifferential reflectRayDifferential(RayDifferential differential, float3 dP_x, float3 dP_y, float3 normal)
+{
+    RayDifferential reflected;
+    reflected.dOdx = dP_x;
+    reflected.dOdy = dP_y;
+    reflected.dDdx = differential.dDdx - normal * (2.0 * dot(differential.dDdx, normal));
+    reflected.dDdy = differential.dDdy - normal * (2.0 * dot(differential.dDdy, normal));
+    return reflected;
+}
+
+void getTextureGradients(TexcoordJacobian jacobian, float3 dP_x, float3 dP_y, out float2 texGrad_x, out float2 texGrad_y)
+{
+    texGrad_x = float2(dot(jacobian.dUdP, dP_x), dot(jacobian.dVdP, dP_x));
+    texGrad_y = float2(dot(jacobian.dUdP, dP_y), dot(jacobian.dVdP, dP_y));
+}
+
+#endif // __RAY_DIFFERENTIALS_HLSLI__
@@ -34,11 +34,34 @@
 #include <donut/render/DepthPass.h>
 #include <donut/render/CascadedShadowMap.h>
 #include "UserInterface.h"
+#include "SweepRunner.h"
+#include "ShaderPermutationCache.h"
+#include "ShaderBlobCache.h"
+#include "SceneLoader.h"
+#include "GpuSamplingStats.h"
+#include "GpuConstantFootprints.h"
+#include "GpuTexelResolvePass.h"
+#include "StfConstants.h"
+#include "StfFilterKernel.h"
+#include "DispatchAutotuner.h"
+#include <ShaderMake/ShaderBlob.h>
 
 #if ENABLE_DLSS
 #include "DLSS.h"
 #endif
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
 using namespace donut;
 using namespace donut::render;
 using namespace donut::engine;
@@ -46,21 +69,104 @@ using namespace donut::math;
 using namespace donut::app;
 
 #include "lighting_cb.h"
+#include "stf_filter_kernel_cb.h"
 #include <donut/shaders/gbuffer_cb.h>
 
 static const char* g_WindowTitle = "Donut Example: RTX Texture Filtering";
 
+// Constant blocks of the scene textures, about a quarter of the texture size at 8 bits per texel.
+// Textures that do not fit never take the constant footprint early-out.
+static constexpr uint64_t c_ConstantFootprintBufferSize = 64ull << 20;
+
 #ifdef DONUT_D3D_AGILITY_SDK_ENABLED
     extern "C" { __declspec(dllexport) extern const UINT D3D12SDKVersion = DONUT_D3D_AGILITY_SDK_VERSION;}
     extern "C" { __declspec(dllexport) extern const char* D3D12SDKPath = ".\\D3D12\\"; }
 #endif
 
+// Everything that selects a distinct STF pipeline. Fields that do not apply to the pipeline type are
+// normalized, so that settings producing the same shaders share one cache entry.
+struct StfPipelinePermutation
+{
+    StfPipelineType type = StfPipelineType::Compute;
+    bool stfEnabled = false;
+    bool stfLoad = false;
+    bool allowHelperLanes = false;
+    bool deferredTexels = false;    // the G-buffer stores texel IDs for the texel resolve, see gbuffer_texel_id.h
+    uint2 threadGroupSize = uint2(16, 16);
+
+    StfPipelinePermutation() = default;
+
+    StfPipelinePermutation(StfPipelineType _type, bool _stfEnabled, bool _stfLoad, bool _allowHelperLanes, bool _deferredTexels, uint2 _threadGroupSize)
+        : type(_type)
+        , stfEnabled(_stfEnabled)
+        , stfLoad(_stfEnabled && _stfLoad)
+        , allowHelperLanes(_type == StfPipelineType::Raster && _allowHelperLanes)
+        , deferredTexels(_type == StfPipelineType::Raster && _stfEnabled && _deferredTexels)
+        , threadGroupSize(_type == StfPipelineType::Compute && _stfEnabled ? _threadGroupSize : uint2(16, 16))
+    {
+    }
+
+    bool operator==(const StfPipelinePermutation& other) const
+    {
+        return type == other.type && stfEnabled == other.stfEnabled && stfLoad == other.stfLoad &&
+            allowHelperLanes == other.allowHelperLanes && deferredTexels == other.deferredTexels && all(threadGroupSize == other.threadGroupSize);
+    }
+
+    bool operator!=(const StfPipelinePermutation& other) const { return !(*this == other); }
+
+    // Number of UI settings that differ, 1 means a single click away
+    uint32_t Distance(const StfPipelinePermutation& other) const
+    {
+        return uint32_t(type != other.type) + uint32_t(stfEnabled != other.stfEnabled) + uint32_t(stfLoad != other.stfLoad) +
+            uint32_t(allowHelperLanes != other.allowHelperLanes) + uint32_t(deferredTexels != other.deferredTexels) +
+            uint32_t(any(threadGroupSize != other.threadGroupSize));
+    }
+
+    PermutationKey GetKey() const
+    {
+        PermutationKey key;
+        key.kind = PermutationKind::Pipeline;
+        key.macros = {
+            { "STF_ENABLED", stfEnabled ? "1" : "0" },
+            { "STF_LOAD", stfLoad ? "1" : "0" } };
+
+        if (type == StfPipelineType::Compute)
+        {
+            key.name = "compute";
+            key.macros.Set("USE_RAY_QUERY", "1");
+            key.macros.Set("THREAD_SIZE_X", std::to_string(threadGroupSize.x));
+            key.macros.Set("THREAD_SIZE_Y", std::to_string(threadGroupSize.y));
+            key.dependencies = {
+                { PermutationKind::Shader, "app/stf_bindless_rendering_cs.hlsl", "main_cs", key.macros, {} } };
+        }
+        else if (type == StfPipelineType::RayGen)
+        {
+            key.name = "raygen";
+            key.macros.Set("USE_RAY_QUERY", "0");
+            key.dependencies = {
+                { PermutationKind::ShaderLibrary, "app/stf_bindless_rendering_lib.hlsl", "", key.macros, {} },
+                { PermutationKind::ShaderLibrary, "app/stf_bindless_rendering_hit_group.hlsl", "", key.macros, {} } };
+        }
+        else
+        {
+            key.name = "raster";
+            key.macros.Set("ALLOW_HELPER_LANES", allowHelperLanes ? "1" : "0");
+            key.macros.Set("DEFERRED_TEXELS", deferredTexels ? "1" : "0");
+        }
+
+        return key;
+    }
+};
+
 // Override GBuffer shaders
 class GBufferFillPassWithSTF : public GBufferFillPass
 {
     nvrhi::BufferHandle m_ConstantBuffer;
-    std::shared_ptr<UIData> m_ui;
+    StfPipelinePermutation m_Permutation;
     std::shared_ptr<LoadedTexture> m_STBNTexture;
+    nvrhi::BufferHandle m_StatsBuffer;
+    nvrhi::BufferHandle m_ConstantFootprintBuffer;
+    nvrhi::BufferHandle m_FilterKernelBuffer;
 
     using GBufferFillPass::GBufferFillPass;
 
@@ -70,11 +176,45 @@ public:
         commandList->writeBuffer(m_ConstantBuffer, &constants, sizeof(constants));
     }
 
-    GBufferFillPassWithSTF(nvrhi::IDevice* device, std::shared_ptr<CommonRenderPasses> commonPasses, std::shared_ptr<UIData> ui, std::shared_ptr<LoadedTexture> STBNTexture) :
-        m_ui(ui),
+    // Creates the PSOs for the views of the sample (reverse depth, not mirrored) after Init, against a framebuffer
+    // with the G-buffer formats. Other keys are still created by GBufferFillPass on first use.
+    bool CreatePipelines(nvrhi::IFramebuffer* framebuffer)
+    {
+        if (!m_VertexShader || !m_PixelShader || !framebuffer)
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        for (const nvrhi::RasterCullMode cullMode : { nvrhi::RasterCullMode::Back, nvrhi::RasterCullMode::Front, nvrhi::RasterCullMode::None })
+        {
+            for (const bool alphaTested : { false, true })
+            {
+                PipelineKey key;
+                key.value = 0;
+                key.bits.cullMode = cullMode;
+                key.bits.alphaTested = alphaTested;
+                key.bits.frontCounterClockwise = false;
+                key.bits.reverseDepth = true;
+
+                m_Pipelines[key.value] = CreateGraphicsPipeline(key, framebuffer);
+                if (!m_Pipelines[key.value])
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    GBufferFillPassWithSTF(nvrhi::IDevice* device, std::shared_ptr<CommonRenderPasses> commonPasses, const StfPipelinePermutation& permutation,
+        std::shared_ptr<LoadedTexture> STBNTexture, nvrhi::IBuffer* statsBuffer, nvrhi::IBuffer* constantFootprintBuffer,
+        nvrhi::IBuffer* filterKernelBuffer) :
+        m_Permutation(permutation),
         GBufferFillPass(device, commonPasses)
     {
         m_STBNTexture = STBNTexture;
+        m_StatsBuffer = statsBuffer;
+        m_ConstantFootprintBuffer = constantFootprintBuffer;
+        m_FilterKernelBuffer = filterKernelBuffer;
 
         m_ConstantBuffer = device->createBuffer(nvrhi::utils::CreateVolatileConstantBufferDesc(
             sizeof(LightingConstants), "LightingConstants", c_MaxRenderPassConstantBufferVersions));
@@ -85,11 +225,12 @@ protected:
     nvrhi::ShaderHandle CreatePixelShader(ShaderFactory& shaderFactory, const CreateParameters& params, bool alphaTested) override
     {
         std::vector<ShaderMacro> PixelShaderMacros;
-        PixelShaderMacros.push_back(ShaderMacro("STF_ENABLED", m_ui->samplerType >= SamplerType::STF ? "1" : "0"));
-        PixelShaderMacros.push_back(ShaderMacro("STF_LOAD", m_ui->stfLoad == true ? "1" : "0"));
+        PixelShaderMacros.push_back(ShaderMacro("STF_ENABLED", m_Permutation.stfEnabled ? "1" : "0"));
+        PixelShaderMacros.push_back(ShaderMacro("STF_LOAD", m_Permutation.stfLoad ? "1" : "0"));
         PixelShaderMacros.push_back(ShaderMacro("MOTION_VECTORS", params.enableMotionVectors ? "1" : "0"));
         PixelShaderMacros.push_back(ShaderMacro("ALPHA_TESTED", alphaTested ? "1" : "0"));
-        PixelShaderMacros.push_back(ShaderMacro("ALLOW_HELPER_LANES", m_ui->allowHelperLanesInWaveIntrinsics ? "1" : "0"));
+        PixelShaderMacros.push_back(ShaderMacro("ALLOW_HELPER_LANES", m_Permutation.allowHelperLanes ? "1" : "0"));
+        PixelShaderMacros.push_back(ShaderMacro("DEFERRED_TEXELS", m_Permutation.deferredTexels ? "1" : "0"));
 
         return shaderFactory.CreateAutoShader("app/gbuffer_stf_ps.hlsl", "main", DONUT_MAKE_PLATFORM_SHADER(g_gbuffer_stf_ps), &PixelShaderMacros, nvrhi::ShaderType::Pixel);
     }
@@ -121,6 +262,9 @@ protected:
             .setRegisterSpaceIsDescriptorSet(!m_IsDX11)
             .addItem(nvrhi::BindingLayoutItem::VolatileConstantBuffer(GBUFFER_BINDING_VIEW_CONSTANTS))
             .addItem(nvrhi::BindingLayoutItem::Texture_SRV(0))
+            .addItem(nvrhi::BindingLayoutItem::RawBuffer_SRV(1))
+            .addItem(nvrhi::BindingLayoutItem::RawBuffer_SRV(2))
+            .addItem(nvrhi::BindingLayoutItem::RawBuffer_UAV(0))
             .addItem(nvrhi::BindingLayoutItem::Sampler(GBUFFER_BINDING_MATERIAL_SAMPLER));
 
         layout = m_Device->createBindingLayout(bindingLayoutDesc);
@@ -129,6 +273,9 @@ protected:
             .setTrackLiveness(params.trackLiveness)
             .addItem(nvrhi::BindingSetItem::ConstantBuffer(GBUFFER_BINDING_VIEW_CONSTANTS, m_ConstantBuffer))
             .addItem(nvrhi::BindingSetItem::Texture_SRV(0, m_STBNTexture->texture))
+            .addItem(nvrhi::BindingSetItem::RawBuffer_SRV(1, m_ConstantFootprintBuffer))
+            .addItem(nvrhi::BindingSetItem::RawBuffer_SRV(2, m_FilterKernelBuffer))
+            .addItem(nvrhi::BindingSetItem::RawBuffer_UAV(0, m_StatsBuffer))
             .addItem(nvrhi::BindingSetItem::Sampler(GBUFFER_BINDING_MATERIAL_SAMPLER,
                 m_CommonPasses->m_AnisotropicWrapSampler));
 
@@ -168,6 +315,309 @@ protected:
     }
 };
 
+struct StfShaderArtifact : public PermutationArtifact
+{
+    nvrhi::ShaderHandle shader;
+};
+
+struct StfShaderLibraryArtifact : public PermutationArtifact
+{
+    nvrhi::ShaderLibraryHandle library;
+};
+
+struct StfPipelineArtifact : public PermutationArtifact
+{
+    nvrhi::ComputePipelineHandle computePipeline;
+    nvrhi::rt::PipelineHandle rayPipeline;
+    nvrhi::rt::ShaderTableHandle shaderTable;
+    std::unique_ptr<GBufferFillPassWithSTF> gbufferPass;
+};
+
+// Creates the STF shaders and pipelines on the PermutationCache worker threads. Uses its own ShaderFactory,
+// the one owned by the application is used by the render thread at the same time.
+//
+// Compute shaders and ray tracing libraries go through the ShaderBlobCache when one is given: each permutation
+// is stored under a key made of the digest of its ShaderMake container and its macros, so a recompiled container
+// misses the cache. Later launches still read and hash each container once, but skip the permutation search and
+// take the blobs from the mapped pack.
+class StfPipelineBuilder : public IPermutationBuilder
+{
+    nvrhi::DeviceHandle m_Device;
+    std::shared_ptr<vfs::IFileSystem> m_FileSystem;
+    std::shared_ptr<ShaderFactory> m_ShaderFactory;
+    std::mutex m_ShaderFactoryMutex;
+    std::shared_ptr<CommonRenderPasses> m_CommonPasses;
+    std::shared_ptr<LoadedTexture> m_STBNTexture;
+    nvrhi::BufferHandle m_StatsBuffer;
+    nvrhi::BufferHandle m_ConstantFootprintBuffer;
+    nvrhi::BufferHandle m_FilterKernelBuffer;
+    nvrhi::BindingLayoutHandle m_BindingLayout;
+    nvrhi::BindingLayoutHandle m_BindlessLayout;
+
+    std::mutex m_GBufferFormatMutex;
+    std::unique_ptr<RenderTargets> m_GBufferFormatTargets[2];
+
+    // A compiled ShaderMake container and the digest that keys its permutations in the blob cache
+    struct ShaderContainer
+    {
+        std::shared_ptr<vfs::IBlob> blob;
+        uint64_t digest = 0;
+    };
+
+    std::shared_ptr<ShaderBlobCache> m_BlobCache;
+    std::mutex m_ContainerMutex;
+    std::unordered_map<std::string, ShaderContainer> m_Containers;
+
+    // Reads the container of a permutation once per container, same path rules as ShaderFactory
+    bool GetContainer(const PermutationKey& key, ShaderContainer& container)
+    {
+        std::string fileName = key.name;
+        const size_t extension = fileName.rfind(".hlsl");
+        if (extension != std::string::npos)
+            fileName.erase(extension);
+        if (!key.entry.empty() && key.entry != "main")
+            fileName += "_" + key.entry;
+
+        {
+            std::lock_guard<std::mutex> lock(m_ContainerMutex);
+            auto it = m_Containers.find(fileName);
+            if (it != m_Containers.end())
+            {
+                container = it->second;
+                return true;
+            }
+        }
+
+        container.blob = m_FileSystem->readFile(std::filesystem::path("/shaders") / (fileName + ".bin"));
+        if (!container.blob)
+        {
+            log::error("Couldn't read the binary file for shader %s", key.name.c_str());
+            return false;
+        }
+        container.digest = m_BlobCache ? HashFnv1a64(container.blob->data(), container.blob->size()) : 0;
+
+        std::lock_guard<std::mutex> lock(m_ContainerMutex);
+        m_Containers.emplace(fileName, container);
+        return true;
+    }
+
+    // 1x1 targets for the G-buffer pass alone, so the raster PSOs can be created before the frame allocates its targets
+    nvrhi::IFramebuffer* GetGBufferFormatFramebuffer(bool deferredTexels)
+    {
+        std::lock_guard<std::mutex> lock(m_GBufferFormatMutex);
+
+        std::unique_ptr<RenderTargets>& targets = m_GBufferFormatTargets[deferredTexels ? 1 : 0];
+        if (!targets)
+            targets = std::make_unique<RenderTargets>(m_Device, int2(1, 1), int2(1, 1), std::vector<RenderPassUsage>{ RenderTargets::GetGBufferPassUsage(deferredTexels) });
+
+        if (!targets->GBufferFramebuffer)
+            return nullptr;
+
+        return targets->GBufferFramebuffer->GetFramebuffer(nvrhi::TextureSubresourceSet(0, 1, 0, 1));
+    }
+
+    // Finds one permutation in its compiled ShaderMake container
+    bool LoadPermutation(const PermutationKey& key, const ShaderContainer& container, std::vector<uint8_t>& bytecode)
+    {
+        std::vector<ShaderMake::ShaderConstant> constants;
+        for (const auto& macro : key.macros.Get())
+            constants.push_back({ macro.first.c_str(), macro.second.c_str() });
+
+        const void* permutation = nullptr;
+        size_t permutationSize = 0;
+        if (!ShaderMake::FindPermutationInBlob(container.blob->data(), container.blob->size(), constants.data(), uint32_t(constants.size()), &permutation, &permutationSize))
+        {
+            log::error("%s", ShaderMake::FormatShaderNotFoundMessage(container.blob->data(), container.blob->size(), constants.data(), uint32_t(constants.size())).c_str());
+            return false;
+        }
+
+        bytecode.assign(static_cast<const uint8_t*>(permutation), static_cast<const uint8_t*>(permutation) + permutationSize);
+        return true;
+    }
+
+    std::shared_ptr<PermutationArtifact> BuildShader(const PermutationKey& key)
+    {
+        const bool isLibrary = key.kind == PermutationKind::ShaderLibrary;
+        const uint32_t shaderType = uint32_t(isLibrary ? nvrhi::ShaderType::AllRayTracing : nvrhi::ShaderType::Compute);
+
+        const void* bytecode = nullptr;
+        size_t bytecodeSize = 0;
+        std::vector<uint8_t> loadedBytecode;
+
+        ShaderContainer container;
+        if (!GetContainer(key, container))
+            return nullptr;
+
+        std::string blobKey;
+        if (m_BlobCache)
+        {
+            blobKey = MakeShaderBlobKey(container.digest, app::GetShaderTypeName(m_Device->getGraphicsAPI()), key);
+
+            ShaderBlobView blob = m_BlobCache->Find(blobKey);
+            if (blob && blob.reflectionSize == sizeof(shaderType) && memcmp(blob.reflection, &shaderType, sizeof(shaderType)) == 0)
+            {
+                bytecode = blob.data;
+                bytecodeSize = blob.size;
+            }
+        }
+
+        if (!bytecode)
+        {
+            if (!LoadPermutation(key, container, loadedBytecode))
+                return nullptr;
+
+            bytecode = loadedBytecode.data();
+            bytecodeSize = loadedBytecode.size();
+
+            if (!blobKey.empty())
+                m_BlobCache->Store(blobKey, bytecode, bytecodeSize, &shaderType, sizeof(shaderType));
+        }
+
+        if (isLibrary)
+        {
+            auto artifact = std::make_shared<StfShaderLibraryArtifact>();
+            artifact->library = m_Device->createShaderLibrary(bytecode, bytecodeSize);
+            return artifact->library ? artifact : nullptr;
+        }
+
+        nvrhi::ShaderDesc desc;
+        desc.shaderType = nvrhi::ShaderType::Compute;
+        desc.debugName = key.name;
+        desc.entryName = key.entry;
+
+        auto artifact = std::make_shared<StfShaderArtifact>();
+        artifact->shader = m_Device->createShader(desc, bytecode, bytecodeSize);
+        return artifact->shader ? artifact : nullptr;
+    }
+
+public:
+    StfPipelineBuilder(nvrhi::IDevice* device, std::shared_ptr<vfs::IFileSystem> fs, std::shared_ptr<CommonRenderPasses> commonPasses,
+        std::shared_ptr<LoadedTexture> STBNTexture, nvrhi::IBuffer* statsBuffer, nvrhi::IBuffer* constantFootprintBuffer,
+        nvrhi::IBuffer* filterKernelBuffer, nvrhi::IBindingLayout* bindingLayout, nvrhi::IBindingLayout* bindlessLayout)
+        : m_Device(device)
+        , m_FileSystem(fs)
+        , m_CommonPasses(commonPasses)
+        , m_STBNTexture(STBNTexture)
+        , m_StatsBuffer(statsBuffer)
+        , m_ConstantFootprintBuffer(constantFootprintBuffer)
+        , m_FilterKernelBuffer(filterKernelBuffer)
+        , m_BindingLayout(bindingLayout)
+        , m_BindlessLayout(bindlessLayout)
+    {
+        m_ShaderFactory = std::make_shared<ShaderFactory>(device, fs, "/shaders");
+    }
+
+    void SetBlobCache(std::shared_ptr<ShaderBlobCache> blobCache)
+    {
+        m_BlobCache = blobCache;
+    }
+
+    // Only the ShaderFactory needs serializing, pipeline creation runs in parallel
+    bool IsThreadSafe() const override { return true; }
+
+    void ClearShaderCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_ShaderFactoryMutex);
+            m_ShaderFactory->ClearCache();
+        }
+
+        // The containers may have been recompiled
+        std::lock_guard<std::mutex> lock(m_ContainerMutex);
+        m_Containers.clear();
+    }
+
+    std::shared_ptr<PermutationArtifact> Build(const PermutationKey& key, const std::vector<std::shared_ptr<PermutationArtifact>>& dependencies) override
+    {
+        if (key.kind == PermutationKind::Shader || key.kind == PermutationKind::ShaderLibrary)
+            return BuildShader(key);
+
+        auto artifact = std::make_shared<StfPipelineArtifact>();
+
+        if (key.name == "compute")
+        {
+            auto shader = std::static_pointer_cast<StfShaderArtifact>(dependencies[0]);
+
+            auto pipelineDesc = nvrhi::ComputePipelineDesc()
+                .setComputeShader(shader->shader)
+                .addBindingLayout(m_BindingLayout)
+                .addBindingLayout(m_BindlessLayout);
+
+            artifact->computePipeline = m_Device->createComputePipeline(pipelineDesc);
+
+            if (!artifact->computePipeline)
+                return nullptr;
+        }
+        else if (key.name == "raygen")
+        {
+            auto shaderLibraryLib = std::static_pointer_cast<StfShaderLibraryArtifact>(dependencies[0])->library;
+            auto shaderLibraryHitGroup = std::static_pointer_cast<StfShaderLibraryArtifact>(dependencies[1])->library;
+
+            nvrhi::rt::PipelineDesc pipelineDesc;
+            pipelineDesc.globalBindingLayouts = { m_BindingLayout, m_BindlessLayout };
+            pipelineDesc.shaders = {
+                { "", shaderLibraryLib->getShader("RayGen", nvrhi::ShaderType::RayGeneration), nullptr },
+                { "", shaderLibraryLib->getShader("Miss", nvrhi::ShaderType::Miss), nullptr }
+            };
+
+            pipelineDesc.hitGroups = { {
+                "HitGroup",
+                shaderLibraryHitGroup->getShader("ClosestHit", nvrhi::ShaderType::ClosestHit),
+                shaderLibraryHitGroup->getShader("AnyHit", nvrhi::ShaderType::AnyHit),
+                nullptr, // intersectionShader
+                nullptr, // bindingLayout
+                false  // isProceduralPrimitive
+            } };
+
+            pipelineDesc.maxPayloadSize = sizeof(float) * 8;
+
+            artifact->rayPipeline = m_Device->createRayTracingPipeline(pipelineDesc);
+
+            if (!artifact->rayPipeline)
+                return nullptr;
+
+            artifact->shaderTable = artifact->rayPipeline->createShaderTable();
+
+            if (!artifact->shaderTable)
+                return nullptr;
+
+            artifact->shaderTable->setRayGenerationShader("RayGen");
+            artifact->shaderTable->addHitGroup("HitGroup");
+            artifact->shaderTable->addMissShader("Miss");
+        }
+        else
+        {
+            assert(key.name == "raster");
+
+            auto isSet = [&key](const char* name)
+            {
+                const std::string* value = key.macros.Find(name);
+                return value && *value == "1";
+            };
+
+            const StfPipelinePermutation permutation(StfPipelineType::Raster, isSet("STF_ENABLED"), isSet("STF_LOAD"), isSet("ALLOW_HELPER_LANES"),
+                isSet("DEFERRED_TEXELS"), uint2(16, 16));
+
+            GBufferFillPass::CreateParameters GBufferParams;
+            artifact->gbufferPass = std::make_unique<GBufferFillPassWithSTF>(m_Device, m_CommonPasses, permutation, m_STBNTexture, m_StatsBuffer,
+                m_ConstantFootprintBuffer, m_FilterKernelBuffer);
+            {
+                std::lock_guard<std::mutex> lock(m_ShaderFactoryMutex);
+                artifact->gbufferPass->Init(*m_ShaderFactory, GBufferParams);
+            }
+
+            // Here rather than on the render thread when the permutation is first drawn
+            if (!artifact->gbufferPass->CreatePipelines(GetGBufferFormatFramebuffer(permutation.deferredTexels)))
+            {
+                log::error("Couldn't create the G-buffer pipelines for %s", key.ToString().c_str());
+                return nullptr;
+            }
+        }
+
+        return artifact;
+    }
+};
+
 class BindlessRayTracing : public app::ApplicationBase
 {
 private:
@@ -175,13 +625,7 @@ private:
     std::shared_ptr<UIData> m_ui;
 	std::shared_ptr<vfs::RootFileSystem> m_RootFS;
 
-    nvrhi::ShaderLibraryHandle m_ShaderLibraryLib;
-    nvrhi::ShaderLibraryHandle m_ShaderLibraryHitGroup;
-    nvrhi::rt::PipelineHandle m_RayPipeline;
-    nvrhi::rt::ShaderTableHandle m_ShaderTable;
-    nvrhi::ShaderHandle m_ComputeShader;
     nvrhi::ShaderHandle m_PixelShader;
-    nvrhi::ComputePipelineHandle m_ComputePipeline;
     nvrhi::CommandListHandle m_CommandList;
     nvrhi::BindingLayoutHandle m_BindingLayout;
     nvrhi::BindingSetHandle m_BindingSet;
@@ -206,8 +650,8 @@ private:
     std::unique_ptr<BindingCache> m_BindingCache;
 
     std::unique_ptr<RenderTargets> m_RenderTargets;
-    std::unique_ptr<GBufferFillPassWithSTF> m_GBufferPass;
     std::unique_ptr<DeferredLightingPass> m_DeferredLightingPass;
+    std::unique_ptr<GpuTexelResolvePass> m_TexelResolvePass;
     std::unique_ptr<ToneMappingPass> m_ToneMappingPass;
 
     std::unique_ptr<TemporalAntiAliasingPass> m_TemporalPass;
@@ -221,9 +665,124 @@ private:
     std::unique_ptr<DLSS> m_DLSS;
 #endif
 
+    std::unique_ptr<SweepRunner> m_Sweep;
+
+    // STF sampling counters per texture and magnification method, collected while the UI asks for them or for the whole
+    // run when written to m_SamplingStatsFile
+    std::unique_ptr<GpuSamplingStats> m_SamplingStats;
+    StfSamplingStats m_SamplingStatsTable;
+    std::filesystem::path m_SamplingStatsFile;
+    bool m_CollectingStats = false;
+
+    // Constant blocks of the scene textures for the constant footprint early-out, built once the scene is loaded
+    std::unique_ptr<GpuConstantFootprints> m_ConstantFootprints;
+
+    // Alias tables of the custom filter kernel, rewritten when the UI picks another kernel
+    nvrhi::BufferHandle m_FilterKernelBuffer;
+    uint32_t m_FilterKernel = ~0u;
+
+    // Compute dispatch search, each frame times the STF dispatch with the candidate it ran
+    struct AutotuneQuery
+    {
+        nvrhi::TimerQueryHandle query;
+        uint32_t candidate = 0;
+        bool inFlight = false;
+    };
+
+    DispatchAutotuner m_Autotuner;
+    std::filesystem::path m_DispatchTuningFile;
+    std::array<AutotuneQuery, 8> m_AutotuneQueries;
+    size_t m_AutotuneQuery = 0;
+    uint2 m_AutotuneResolution = 0u;
+
+    // STF pipelines are built in the background, the active one keeps rendering until the requested one is ready
+    std::shared_ptr<StfPipelineBuilder> m_PipelineBuilder;
+    std::unique_ptr<PermutationCache> m_PipelineCache;
+    std::vector<StfPipelinePermutation> m_PrecompiledPermutations;
+    bool m_UseRayQuery = false;
+    std::shared_ptr<StfPipelineArtifact> m_ActivePipeline;
+    StfPipelinePermutation m_ActivePermutation;
+    bool m_ActivePipelineStale = false;
+    std::string m_ReportedPipelineFailure;
+
+    std::shared_ptr<ShaderBlobCache> m_ShaderBlobCache;
+    std::filesystem::path m_ShaderBlobCacheFile;
+    bool m_ShaderBlobCacheEnabled = true;
+    bool m_ShaderBlobCacheBenchmark = false;
+
+    // Images are decoded on the loading pool while the splash screen is up
+    std::unique_ptr<ThreadPool> m_LoadingPool;
+    std::unique_ptr<ParallelSceneLoader> m_SceneLoader;
+    bool m_SceneReady = false;
+
 public:
     using ApplicationBase::ApplicationBase;
 
+    ~BindlessRayTracing()
+    {
+        // Stop the workers before writing out the blobs they compiled
+        m_PipelineCache = nullptr;
+        m_SceneLoader = nullptr;
+        m_LoadingPool = nullptr;
+
+        std::string error;
+        if (m_ShaderBlobCache && !m_ShaderBlobCache->Flush(error))
+            log::warning("%s", error.c_str());
+
+        if (m_SamplingStats && !m_SamplingStatsFile.empty())
+        {
+            m_SamplingStats->Poll(m_SamplingStatsTable, true);
+            WriteSamplingStats();
+        }
+    }
+
+    void SetSamplingStatsFile(const std::filesystem::path& fileName)
+    {
+        m_SamplingStatsFile = fileName;
+    }
+
+    bool WriteSamplingStats()
+    {
+        // Bindless descriptors back to file names through the materials that use them
+        std::unordered_map<uint32_t, std::string> textureNames;
+        if (m_Scene)
+        {
+            for (const std::shared_ptr<Material>& material : m_Scene->GetSceneGraph()->GetMaterials())
+            {
+                for (const std::shared_ptr<LoadedTexture>& texture : { material->baseOrDiffuseTexture, material->metalRoughOrSpecularTexture,
+                    material->normalTexture, material->emissiveTexture, material->occlusionTexture, material->transmissionTexture, material->opacityTexture })
+                {
+                    if (texture && texture->bindlessDescriptor.IsValid())
+                        textureNames[uint32_t(texture->bindlessDescriptor.Get())] = std::filesystem::path(texture->path).filename().generic_string();
+                }
+            }
+        }
+
+        const bool written = m_SamplingStatsTable.WriteCsv(m_SamplingStatsFile, [&textureNames](uint32_t texture)
+        {
+            auto it = textureNames.find(texture);
+            return it != textureNames.end() ? it->second : std::string();
+        });
+
+        if (!written)
+            log::warning("Cannot write '%s'", m_SamplingStatsFile.generic_string().c_str());
+        return written;
+    }
+
+    // Must be called before Init()
+    void SetDispatchTuningFile(const std::filesystem::path& fileName)
+    {
+        m_DispatchTuningFile = fileName;
+    }
+
+    // Must be called before Init()
+    void SetShaderBlobCache(bool enabled, const std::filesystem::path& fileName, bool benchmark)
+    {
+        m_ShaderBlobCacheEnabled = enabled;
+        m_ShaderBlobCacheFile = fileName;
+        m_ShaderBlobCacheBenchmark = benchmark;
+    }
+
     std::shared_ptr<vfs::RootFileSystem> GetRootFs()
     {
         return m_RootFS;
@@ -252,6 +811,7 @@ public:
         m_RootFS->mount("/assets/media", mediaPath);
 
         m_ui = std::make_shared<UIData>();
+        m_UseRayQuery = useRayQuery;
 
 		m_ShaderFactory = std::make_shared<ShaderFactory>(GetDevice(), m_RootFS, "/shaders");
 		m_CommonPasses = std::make_shared<CommonRenderPasses>(GetDevice(), m_ShaderFactory);
@@ -276,8 +836,11 @@ public:
             nvrhi::BindingLayoutItem::StructuredBuffer_SRV(2),
             nvrhi::BindingLayoutItem::StructuredBuffer_SRV(3),
             nvrhi::BindingLayoutItem::Texture_SRV(4),
+            nvrhi::BindingLayoutItem::RawBuffer_SRV(5),
+            nvrhi::BindingLayoutItem::RawBuffer_SRV(6),
             nvrhi::BindingLayoutItem::Sampler(0),
-            nvrhi::BindingLayoutItem::Texture_UAV(0)
+            nvrhi::BindingLayoutItem::Texture_UAV(0),
+            nvrhi::BindingLayoutItem::RawBuffer_UAV(1)
         };
         m_BindingLayout = GetDevice()->createBindingLayout(globalBindingLayoutDesc);
 
@@ -285,16 +848,6 @@ public:
 
         auto nativeFS = std::make_shared<vfs::NativeFileSystem>();
         m_TextureCache = std::make_shared<TextureCache>(GetDevice(), nativeFS, m_DescriptorTable);
-        
-        SetAsynchronousLoadingEnabled(false);
-        BeginLoadingScene(nativeFS, sceneFileName);
-
-        m_SunLight = std::make_shared<DirectionalLight>();
-        m_Scene->GetSceneGraph()->AttachLeafNode(m_Scene->GetSceneGraph()->GetRootNode(), m_SunLight);
-
-        m_SunLight->SetDirection(double3(0.1f, -1.0f, -0.15f));
-        m_SunLight->angularSize = 0.53f;
-        m_SunLight->irradiance = 5.f;
 
         const nvrhi::Format shadowMapFormats[] = {
             nvrhi::Format::D24S8,
@@ -323,14 +876,9 @@ public:
 
         m_OpaqueDrawStrategy = std::make_shared<InstancedOpaqueDrawStrategy>();
 
-        m_Scene->FinishedLoading(GetFrameIndex());
-        
         m_Camera.LookAt(float3(0.f, 1.8f, 0.f), float3(1.f, 1.8f, 0.f));
         m_Camera.SetMoveSpeed(3.f);
 
-        if (!CreatePipeline((*m_ShaderFactory)))
-            return false;
-
 #if ENABLE_DLSS
 #if DLSS_WITH_DX12
         if (GetDevice()->getGraphicsAPI() == nvrhi::GraphicsAPI::D3D12)
@@ -356,38 +904,161 @@ public:
             m_TextureCache->LoadingFinished();
         }
 
-        GBufferFillPass::CreateParameters GBufferParams;
-        m_GBufferPass = std::make_unique<GBufferFillPassWithSTF>(GetDevice(), m_CommonPasses, m_ui, m_STBNTexture);
-        m_GBufferPass->Init(*m_ShaderFactory, GBufferParams);
+        const auto pipelineStart = std::chrono::high_resolution_clock::now();
+
+        m_SamplingStats = std::make_unique<GpuSamplingStats>(GetDevice());
+        m_ConstantFootprints = std::make_unique<GpuConstantFootprints>(GetDevice(), *m_ShaderFactory, c_ConstantFootprintBufferSize);
+
+        nvrhi::BufferDesc filterKernelDesc;
+        filterKernelDesc.byteSize = STF_FILTER_KERNEL_SIZE * sizeof(uint32_t);
+        filterKernelDesc.canHaveRawViews = true;
+        filterKernelDesc.initialState = nvrhi::ResourceStates::ShaderResource;
+        filterKernelDesc.keepInitialState = true;
+        filterKernelDesc.debugName = "StfFilterKernel";
+        m_FilterKernelBuffer = GetDevice()->createBuffer(filterKernelDesc);
+
+        m_PipelineBuilder = std::make_shared<StfPipelineBuilder>(GetDevice(), m_RootFS, m_CommonPasses, m_STBNTexture, m_SamplingStats->GetBuffer(),
+            m_ConstantFootprints->GetBuffer(), m_FilterKernelBuffer, m_BindingLayout, m_BindlessLayout);
+        if (m_ShaderBlobCacheEnabled)
+        {
+            if (m_ShaderBlobCacheFile.empty())
+                m_ShaderBlobCacheFile = appShaderPath / "blob_cache.bin";
+
+            m_ShaderBlobCache = std::make_shared<ShaderBlobCache>(m_ShaderBlobCacheFile);
+            m_PipelineBuilder->SetBlobCache(m_ShaderBlobCache);
+        }
+
+        m_PipelineCache = std::make_unique<PermutationCache>(m_PipelineBuilder, 2);
+        LoadPrecompiledPermutations();
+
+        std::string tuningError;
+        if (std::filesystem::exists(m_DispatchTuningFile) && !m_Autotuner.Load(m_DispatchTuningFile, tuningError))
+            log::warning("%s", tuningError.c_str());
+
+        // Nothing to show yet, so the first pipeline is worth waiting for
+        m_ActivePermutation = GetRequestedPermutation();
+        m_ActivePipeline = std::static_pointer_cast<StfPipelineArtifact>(m_PipelineCache->Wait(m_ActivePermutation.GetKey()));
+        if (!m_ActivePipeline)
+            return false;
+
+        PrewarmPipelines();
+
+        if (m_ShaderBlobCacheBenchmark)
+        {
+            const auto firstPipelineEnd = std::chrono::high_resolution_clock::now();
+            m_PipelineCache->WaitIdle();
+            const auto prewarmEnd = std::chrono::high_resolution_clock::now();
+
+            const PermutationCacheStats pipelineStats = m_PipelineCache->GetStats();
+            log::info("Shader blob cache benchmark: first pipeline %.1f ms, %d pipelines and shaders with the prewarmed neighbours %.1f ms",
+                std::chrono::duration<double, std::milli>(firstPipelineEnd - pipelineStart).count(),
+                int(pipelineStats.built),
+                std::chrono::duration<double, std::milli>(prewarmEnd - pipelineStart).count());
+
+            if (m_ShaderBlobCache)
+            {
+                const ShaderBlobCacheStats blobStats = m_ShaderBlobCache->GetStats();
+                log::info("Shader blob cache benchmark: %d hits, %d misses, %d stored, %d entries (%.1f KB) mapped from '%s'",
+                    int(blobStats.hits), int(blobStats.misses), int(blobStats.stored), int(blobStats.entries),
+                    double(blobStats.mappedBytes) / 1024.0, m_ShaderBlobCacheFile.generic_string().c_str());
+            }
+        }
 
         m_rayTracingConstantBuffer = GetDevice()->createBuffer(nvrhi::utils::CreateVolatileConstantBufferDesc(
             sizeof(LightingConstants), "LightingConstants", c_MaxRenderPassConstantBufferVersions));
 
         m_CommandList = GetDevice()->createCommandList();
 
+        // The rest happens in SceneLoaded() once the loading thread is done and the textures are uploaded
+        m_LoadingPool = std::make_unique<ThreadPool>();
+        m_SceneLoader = std::make_unique<ParallelSceneLoader>(*m_LoadingPool, m_TextureCache);
+
+        SetAsynchronousLoadingEnabled(true);
+        BeginLoadingScene(nativeFS, sceneFileName);
+
+        return true;
+    }
+
+    void SceneLoaded() override
+    {
+        ApplicationBase::SceneLoaded();
+
+        m_SunLight = std::make_shared<DirectionalLight>();
+        m_Scene->GetSceneGraph()->AttachLeafNode(m_Scene->GetSceneGraph()->GetRootNode(), m_SunLight);
+
+        m_SunLight->SetDirection(double3(0.1f, -1.0f, -0.15f));
+        m_SunLight->angularSize = 0.53f;
+        m_SunLight->irradiance = 5.f;
+
+        m_Scene->FinishedLoading(GetFrameIndex());
+
         m_CommandList->open();
 
         CreateAccelStructs(m_CommandList);
+        BuildConstantFootprints(m_CommandList);
 
         m_CommandList->close();
         GetDevice()->executeCommandList(m_CommandList);
 
         GetDevice()->waitForIdle();
 
+        // Workers are idle from here on
+        m_SceneLoader = nullptr;
+        m_LoadingPool = nullptr;
+        m_SceneReady = true;
+    }
+
+    bool StartSweep(const std::filesystem::path& specFileName)
+    {
+        SweepSpec spec;
+        std::string error;
+        if (!LoadSweepSpec(specFileName, spec, error))
+        {
+            log::error("%s", error.c_str());
+            return false;
+        }
+
+        m_Sweep = std::make_unique<SweepRunner>(GetDevice(), std::move(spec));
         return true;
     }
 
+    // Runs on the ApplicationBase loading thread
     bool LoadScene(std::shared_ptr<vfs::IFileSystem> fs, const std::filesystem::path& sceneFileName) override 
     {
-        Scene* scene = new Scene(GetDevice(), *m_ShaderFactory, fs, m_TextureCache, m_DescriptorTable, nullptr);
+        const auto start = std::chrono::high_resolution_clock::now();
 
-        if (scene->Load(sceneFileName))
+        // The images are decoded in parallel first, Scene::Load then finds all of them in the texture cache
+        std::unique_ptr<Scene> scene;
+        const bool loaded = m_SceneLoader->Load(sceneFileName, [&]()
         {
-            m_Scene = std::unique_ptr<Scene>(scene);
-            return true;
-        }
+            scene = std::make_unique<Scene>(GetDevice(), *m_ShaderFactory, fs, m_TextureCache, m_DescriptorTable, nullptr);
+            return scene->Load(sceneFileName);
+        });
 
-        return false;
+        if (!loaded)
+            return false;
+
+        log::info("Scene loaded in %.1f ms: %d images (%.1f MB) decoded on %d threads",
+            std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count(),
+            int(m_SceneLoader->GetImageCount()),
+            double(m_SceneLoader->GetImageBytes()) / (1 << 20),
+            int(m_LoadingPool->GetThreadCount()));
+
+        m_Scene = std::move(scene);
+        return true;
+    }
+
+    void RenderSplashScreen(nvrhi::IFramebuffer* framebuffer) override
+    {
+        // Decoding dominates, the last part of the bar follows the upload batches finalized on this thread
+        const uint32_t requestedTextures = m_TextureCache->GetNumberOfRequestedTextures();
+        const float finalized = requestedTextures > 0 ? float(m_TextureCache->GetNumberOfFinalizedTextures()) / float(requestedTextures) : 0.f;
+        m_ui->loadingPercentage = 0.9f * (m_SceneLoader ? m_SceneLoader->GetProgress() : 1.f) + 0.1f * finalized;
+
+        m_CommandList->open();
+        nvrhi::utils::ClearColorAttachment(m_CommandList, framebuffer, 0, nvrhi::Color(0.f));
+        m_CommandList->close();
+        GetDevice()->executeCommandList(m_CommandList);
     }
 
     bool KeyboardUpdate(int key, int scancode, int action, int mods) override
@@ -425,7 +1096,12 @@ public:
     {
         m_Camera.Animate(fElapsedTimeSeconds);
 
-        if (IsSceneLoaded() && m_ui->enableAnimations)
+        if (m_Sweep && m_SceneReady)
+        {
+            m_Sweep->BeginFrame(*m_ui, m_Camera);
+        }
+
+        if (m_SceneReady && m_ui->enableAnimations)
         {
             m_WallclockTime += fElapsedTimeSeconds;
             float offset = 0;
@@ -449,130 +1125,265 @@ public:
             m_ToneMappingPass->AdvanceFrame(fElapsedTimeSeconds);
     }
 
-    bool CreatePipeline(ShaderFactory& shaderFactory)
+    StfPipelinePermutation GetRequestedPermutation()
+    {
+        return StfPipelinePermutation(
+            m_ui->stfPipelineType,
+            GetStfOn(m_ui->samplerType),
+            m_ui->stfLoad,
+            m_ui->allowHelperLanesInWaveIntrinsics,
+            IsDeferredTexelsEffective(),
+            GetThreadGroupSize());
+    }
+
+    // The DEFERRED_TEXELS fill and the resolve only run where FillStfConstants keeps stfDeferredTexels, the filter
+    // kernels, sigma LOD, EWA and extra taps keep the forward fill even with the UI setting on
+    bool IsDeferredTexelsEffective() const
     {
-        if (m_ui->stfPipelineType == StfPipelineType::Compute)
+        LightingConstants constants = {};
+        FillStfConstants(*m_ui, m_FrameIndex, constants);
+        return m_ui->stfDeferredTexels && constants.stfDeferredTexels;
+    }
+
+    // RayGen needs ray tracing pipelines and is left out with -rayQuery, which may run without them. Compute traces
+    // with ray queries.
+    bool IsPipelineTypeUsable(StfPipelineType type) const
+    {
+        if (type == StfPipelineType::RayGen)
+            return !m_UseRayQuery && GetDevice()->queryFeatureSupport(nvrhi::Feature::RayTracingPipeline);
+        if (type == StfPipelineType::Compute)
+            return GetDevice()->queryFeatureSupport(nvrhi::Feature::RayQuery);
+        return true;
+    }
+
+    // Every pipeline of a usable type whose shaders were compiled by the build, see shaders.cfg
+    void LoadPrecompiledPermutations()
+    {
+        const std::filesystem::path configFileName = app::GetDirectoryWithExecutable() / "shaders/stf_bindless_rendering/shaders.cfg";
+
+        std::ifstream file(configFileName);
+        if (!file.is_open())
         {
-            return CreateComputePipeline(*m_ShaderFactory);
+            log::warning("Cannot open '%s', STF pipelines will not be prewarmed", configFileName.generic_string().c_str());
+            return;
         }
-        else if (m_ui->stfPipelineType == StfPipelineType::RayGen)
+
+        std::stringstream text;
+        text << file.rdbuf();
+
+        std::vector<ShaderConfigPermutation> shaderPermutations;
+        std::string error;
+        if (!ParseShaderConfig(text.str(), shaderPermutations, error))
         {
-            return CreateRayTracingPipeline(*m_ShaderFactory);
+            log::warning("%s", error.c_str());
+            return;
         }
-        else
+
+        std::unordered_set<std::string> precompiled;
+        for (const ShaderConfigPermutation& shader : shaderPermutations)
         {
-            GBufferFillPass::CreateParameters GBufferParams;
-            m_GBufferPass = std::make_unique<GBufferFillPassWithSTF>(GetDevice(), m_CommonPasses, m_ui, m_STBNTexture);
-            m_GBufferPass->Init(*m_ShaderFactory, GBufferParams);
-            return (m_GBufferPass != nullptr);
+            const bool isLibrary = shader.target == "lib";
+            precompiled.insert(PermutationKey{
+                isLibrary ? PermutationKind::ShaderLibrary : PermutationKind::Shader,
+                "app/" + shader.file,
+                isLibrary ? "" : shader.entry,
+                shader.macros,
+                {} }.ToString());
+        }
+
+        const StfPipelineType types[] = { StfPipelineType::RayGen, StfPipelineType::Compute, StfPipelineType::Raster };
+        const uint2 groupSizes[] = { uint2(8, 8), uint2(16, 8), uint2(8, 16), uint2(16, 16) };
+
+        for (StfPipelineType type : types)
+        for (int stfEnabled = 0; stfEnabled < 2; stfEnabled++)
+        for (int stfLoad = 0; stfLoad < 2; stfLoad++)
+        for (int allowHelperLanes = 0; allowHelperLanes < 2; allowHelperLanes++)
+        for (int deferredTexels = 0; deferredTexels < 2; deferredTexels++)
+        for (uint2 groupSize : groupSizes)
+        {
+            const StfPipelinePermutation permutation(type, stfEnabled != 0, stfLoad != 0, allowHelperLanes != 0, deferredTexels != 0, groupSize);
+
+            if (!IsPipelineTypeUsable(type))
+                continue;
+
+            if (std::find(m_PrecompiledPermutations.begin(), m_PrecompiledPermutations.end(), permutation) != m_PrecompiledPermutations.end())
+                continue;
+
+            const PermutationKey key = permutation.GetKey();
+            const bool allShadersPrecompiled = std::all_of(key.dependencies.begin(), key.dependencies.end(),
+                [&precompiled](const PermutationKey& dependency) { return precompiled.count(dependency.ToString()) != 0; });
+
+            if (allShadersPrecompiled)
+                m_PrecompiledPermutations.push_back(permutation);
         }
     }
 
-    uint2 GetThreadGroupSize()
+    // Queue the pipelines one UI change away. Further ones are built when asked for, most of them are never used
+    // and would keep the workers and the driver busy for seconds.
+    void PrewarmPipelines()
     {
-        if (!GetStfOn(m_ui->samplerType))
+        const StfPipelinePermutation requested = GetRequestedPermutation();
+
+        std::vector<PermutationKey> neighbours;
+        for (const StfPipelinePermutation& permutation : m_PrecompiledPermutations)
         {
-            return uint2(16, 16);
+            if (permutation.Distance(requested) == 1)
+                neighbours.push_back(permutation.GetKey());
         }
 
-        if (m_ui->stfGroupSize == StfThreadGroupSize::_8x8)
+        m_PipelineCache->Prewarm(neighbours, PermutationPriority::Neighbour);
+    }
+
+    // Switches to the pipeline matching the UI once it is built, never blocks unless a sweep needs exact results
+    void UpdateActivePipeline()
+    {
+        if (m_ui->clearShaderCache)
         {
-            return uint2(8, 8);
+            m_ShaderFactory->ClearCache();
+            m_PipelineBuilder->ClearShaderCache();
+            m_PipelineCache->Invalidate();
+            m_ActivePipelineStale = true; // keep rendering with the old pipeline until the new one is built
+            m_ReportedPipelineFailure.clear();
+            m_ui->clearShaderCache = false;
         }
-        else if (m_ui->stfGroupSize == StfThreadGroupSize::_16x8)
+
+        if (m_ui->stfPipelineUpdate)
         {
-            return uint2(16, 8);
+            PrewarmPipelines();
+            m_ui->stfPipelineUpdate = false;
         }
-        else if (m_ui->stfGroupSize == StfThreadGroupSize::_8x16)
+
+        const StfPipelinePermutation requested = GetRequestedPermutation();
+        if (requested == m_ActivePermutation && !m_ActivePipelineStale)
+            return;
+
+        const PermutationKey key = requested.GetKey();
+        std::shared_ptr<PermutationArtifact> artifact;
+        if ((m_Sweep && !m_Sweep->IsFinished()) || m_Autotuner.IsSearching())
+            artifact = m_PipelineCache->Wait(key);
+        else
+            artifact = m_PipelineCache->Request(key);
+
+        if (artifact)
         {
-            return uint2(8, 16);
+            m_ActivePipeline = std::static_pointer_cast<StfPipelineArtifact>(artifact);
+            m_ActivePermutation = requested;
+            m_ActivePipelineStale = false;
+            m_BindingCache->Clear();
+            return;
         }
-        else // if (m_ui->stfGroupSize == StfThreadGroupSize::_8x8)
+
+        const std::string keyString = key.ToString();
+        if (m_PipelineCache->GetStatus(key) == PermutationStatus::Failed && m_ReportedPipelineFailure != keyString)
         {
-            assert(m_ui->stfGroupSize == StfThreadGroupSize::_16x16);
-            return uint2(16, 16);
+            log::error("Failed to create STF pipeline '%s', keeping the previous one", keyString.c_str());
+            m_ReportedPipelineFailure = keyString;
         }
     }
 
-    bool CreateComputePipeline(ShaderFactory& shaderFactory)
+    void ApplyDispatch(const CpuDispatchOrder& order)
     {
-        uint2 threadDim = GetThreadGroupSize();
-        assert(threadDim.x == 16 || threadDim.x == 8);
-        assert(threadDim.y == 16 || threadDim.y == 8);
-        const char* dimX = threadDim.x == 16 ? "16" : "8";
-        const char* dimY = threadDim.y == 16 ? "16" : "8";
-
-        std::vector<ShaderMacro> defines = { 
-            { "USE_RAY_QUERY", "1" },
-            { "STF_ENABLED", !GetStfOn(m_ui->samplerType) ? "0" : "1" },
-            { "STF_LOAD", (GetStfOn(m_ui->samplerType) && m_ui->stfLoad) ? "1" : "0" },
-            { "THREAD_SIZE_X", dimX },
-            { "THREAD_SIZE_Y", dimY },
-        };
-
-        m_ComputeShader = m_ShaderFactory->CreateShader("app/stf_bindless_rendering_cs.hlsl", "main_cs", &defines, nvrhi::ShaderType::Compute);
-
-        if (!m_ComputeShader)
-            return false;
-
-        auto pipelineDesc = nvrhi::ComputePipelineDesc()
-            .setComputeShader(m_ComputeShader)
-            .addBindingLayout(m_BindingLayout)
-            .addBindingLayout(m_BindlessLayout);
-
-        m_ComputePipeline = GetDevice()->createComputePipeline(pipelineDesc);
-
-        if (!m_ComputePipeline)
-            return false;
+        const uint2 groupSizes[] = { uint2(8, 8), uint2(16, 8), uint2(8, 16), uint2(16, 16) };
+        for (uint32_t i = 0; i < uint32_t(std::size(groupSizes)); i++)
+        {
+            if (all(groupSizes[i] == order.groupSize))
+                m_ui->stfGroupSize = StfThreadGroupSize(i);
+        }
 
-        return true;
+        m_ui->stfGroupSwizzle = StfGroupSwizzle(order.swizzle);
+        m_ui->stfGroupSwizzleSize = int(order.swizzleSize);
+        m_ui->stfWaveLaneLayoutOverride = StfWaveLaneLayout(order.laneLayout);
     }
 
-    bool CreateRayTracingPipeline(ShaderFactory& shaderFactory)
+    // Starts a search on request and sets the dispatch settings of the UI to the current candidate, or to the tuned
+    // dispatch of this resolution
+    void UpdateDispatchAutotuner(uint2 resolution)
     {
-        std::vector<ShaderMacro> defines = { { "USE_RAY_QUERY", "0" }, { "STF_ENABLED", GetStfOn(m_ui->samplerType) ? "1" : "0" }, { "STF_LOAD", (GetStfOn(m_ui->samplerType) && m_ui->stfLoad) ? "1" : "0" } };
-        m_ShaderLibraryLib = shaderFactory.CreateShaderLibrary("app/stf_bindless_rendering_lib.hlsl", &defines);
-        m_ShaderLibraryHitGroup = shaderFactory.CreateShaderLibrary("app/stf_bindless_rendering_hit_group.hlsl", &defines);
-
-        if (!m_ShaderLibraryLib)
-            return false;
+        if (m_ui->stfAutotuneDispatch)
+        {
+            m_ui->stfAutotuneDispatch = false;
+            for (AutotuneQuery& pending : m_AutotuneQueries)
+            {
+                if (!pending.query)
+                    pending.query = GetDevice()->createTimerQuery();
+            }
 
-        if (!m_ShaderLibraryHitGroup)
-            return false;
+            m_AutotuneResolution = resolution;
+            m_Autotuner.Start(resolution, "gpuMilliseconds", 4, 16);
+            log::info("Autotuning the STF dispatch at %dx%d, %d candidates", int(resolution.x), int(resolution.y), int(m_Autotuner.GetCandidateCount()));
+        }
 
-        nvrhi::rt::PipelineDesc pipelineDesc;
-        pipelineDesc.globalBindingLayouts = { m_BindingLayout, m_BindlessLayout };
-        pipelineDesc.shaders = {
-            { "", m_ShaderLibraryLib->getShader("RayGen", nvrhi::ShaderType::RayGeneration), nullptr },
-            { "", m_ShaderLibraryLib->getShader("Miss", nvrhi::ShaderType::Miss), nullptr }
-        };
+        if (m_Autotuner.IsSearching())
+        {
+            if (any(resolution != m_AutotuneResolution) || !GetStfOn(m_ui->samplerType) || m_ui->stfPipelineType != StfPipelineType::Compute)
+            {
+                m_Autotuner.Cancel();
+                m_ui->stfAutotuneStatus = "Autotune cancelled, it needs the STF compute pipeline at a fixed resolution";
+            }
+            else
+            {
+                ApplyDispatch(m_Autotuner.GetCurrentCandidate());
+            }
+        }
+        else if (m_ui->stfUseTunedDispatch)
+        {
+            if (const DispatchTuning* tuning = m_Autotuner.FindResult(resolution))
+                ApplyDispatch(tuning->order);
+        }
 
-        pipelineDesc.hitGroups = { {
-            "HitGroup",
-            m_ShaderLibraryHitGroup->getShader("ClosestHit", nvrhi::ShaderType::ClosestHit),
-            m_ShaderLibraryHitGroup->getShader("AnyHit", nvrhi::ShaderType::AnyHit),
-            nullptr, // intersectionShader
-            nullptr, // bindingLayout
-            false  // isProceduralPrimitive
-        } };
+        m_ui->stfAutotuneProgress = m_Autotuner.GetProgress();
+    }
 
-        pipelineDesc.maxPayloadSize = sizeof(float) * 8;
+    // Reports the resolved timer queries of earlier frames, and saves and applies the result once the search is done
+    void PollAutotuneQueries()
+    {
+        for (AutotuneQuery& pending : m_AutotuneQueries)
+        {
+            if (!pending.inFlight || !GetDevice()->pollTimerQuery(pending.query))
+                continue;
 
-        m_RayPipeline = GetDevice()->createRayTracingPipeline(pipelineDesc);
+            const float milliseconds = GetDevice()->getTimerQueryTime(pending.query) * 1000.f;
+            GetDevice()->resetTimerQuery(pending.query);
+            pending.inFlight = false;
 
-        if (!m_RayPipeline)
-            return false;
+            if (!m_Autotuner.Report(pending.candidate, milliseconds))
+                continue;
 
-        m_ShaderTable = m_RayPipeline->createShaderTable();
+            const DispatchTuning* tuning = m_Autotuner.FindResult(m_AutotuneResolution);
+            m_ui->stfAutotuneStatus = "Best: " + DispatchAutotuner::GetCandidateName(tuning->order) + ", " + std::to_string(tuning->cost) + " ms";
+            log::info("Autotuned STF dispatch at %dx%d: %s", int(m_AutotuneResolution.x), int(m_AutotuneResolution.y), m_ui->stfAutotuneStatus.c_str());
+            ApplyDispatch(tuning->order);
 
-        if (!m_ShaderTable)
-            return false;
+            std::string error;
+            if (!m_Autotuner.Save(m_DispatchTuningFile, error))
+                log::warning("%s", error.c_str());
+        }
+    }
 
-        m_ShaderTable->setRayGenerationShader("RayGen");
-        m_ShaderTable->addHitGroup("HitGroup");
-        m_ShaderTable->addMissShader("Miss");
+    uint2 GetThreadGroupSize()
+    {
+        if (!GetStfOn(m_ui->samplerType))
+        {
+            return uint2(16, 16);
+        }
 
-        return true;
+        if (m_ui->stfGroupSize == StfThreadGroupSize::_8x8)
+        {
+            return uint2(8, 8);
+        }
+        else if (m_ui->stfGroupSize == StfThreadGroupSize::_16x8)
+        {
+            return uint2(16, 8);
+        }
+        else if (m_ui->stfGroupSize == StfThreadGroupSize::_8x16)
+        {
+            return uint2(8, 16);
+        }
+        else // if (m_ui->stfGroupSize == StfThreadGroupSize::_8x8)
+        {
+            assert(m_ui->stfGroupSize == StfThreadGroupSize::_16x16);
+            return uint2(16, 16);
+        }
     }
 
     void GetMeshBlasDesc(MeshInfo& mesh, nvrhi::rt::AccelStructDesc& blasDesc) const
@@ -611,6 +1422,27 @@ public:
         }
     }
 
+    void BuildConstantFootprints(nvrhi::ICommandList* commandList)
+    {
+        std::map<uint32_t, nvrhi::ITexture*> textures;
+        for (const std::shared_ptr<Material>& material : m_Scene->GetSceneGraph()->GetMaterials())
+        {
+            for (const std::shared_ptr<LoadedTexture>& texture : { material->baseOrDiffuseTexture, material->metalRoughOrSpecularTexture,
+                material->normalTexture, material->emissiveTexture, material->occlusionTexture, material->transmissionTexture, material->opacityTexture })
+            {
+                if (texture && texture->texture && texture->bindlessDescriptor.IsValid())
+                    textures[uint32_t(texture->bindlessDescriptor.Get())] = texture->texture;
+            }
+        }
+
+        m_ConstantFootprints->Build(commandList, textures);
+
+        const GpuConstantFootprintStats& stats = m_ConstantFootprints->GetStats();
+        log::info("Constant footprint blocks of %d textures: %.1f MB", int(stats.textures), double(stats.bytes) / (1 << 20));
+        if (stats.skippedTextures != 0)
+            log::warning("%d textures did not fit into the constant footprint buffer", int(stats.skippedTextures));
+    }
+
     void CreateAccelStructs(nvrhi::ICommandList* commandList)
     {
         for (const auto& mesh : m_Scene->GetSceneGraph()->GetMeshes())
@@ -691,6 +1523,60 @@ public:
     }
 
 
+    // Render targets touched by each pass of the frame, by texture debug name. Only these are allocated.
+    std::vector<RenderPassUsage> GetRenderPassUsage() const
+    {
+        std::vector<RenderPassUsage> passes;
+
+        // The TAA pass also provides the jitter for DLSS. It binds its feedback textures when created.
+        if (m_ui->aaMode != AntiAliasingMode::None)
+            passes.push_back({ "motion vectors", { "DeviceDepth", "TemporalFeedback1", "TemporalFeedback2" }, { "MotionVectors" }, {} });
+
+        if (m_ActivePermutation.type == StfPipelineType::Raster)
+        {
+            if (m_ActivePermutation.deferredTexels)
+            {
+                passes.push_back({ "gbuffer clear", {}, {}, { "DeviceDepth", "DepthBuffer", "HdrColor", "GBufferDiffuseAlbedo", "GBufferSpecularRough", "GBufferNormals", "GBufferEmissive", "GBufferTexelIds" } });
+                passes.push_back(RenderTargets::GetGBufferPassUsage(true));
+                passes.push_back({ "gbuffer resolve", { "GBufferTexelIds", "GBufferGeoNormals" }, { "GBufferDiffuseAlbedo", "GBufferSpecularRough", "GBufferNormals", "GBufferEmissive" }, {} });
+            }
+            else
+            {
+                passes.push_back({ "gbuffer clear", {}, {}, { "DeviceDepth", "DepthBuffer", "HdrColor", "GBufferDiffuseAlbedo", "GBufferSpecularRough", "GBufferNormals", "GBufferEmissive" } });
+                passes.push_back(RenderTargets::GetGBufferPassUsage(false));
+            }
+            passes.push_back({ "deferred lighting", { "DeviceDepth", "GBufferDiffuseAlbedo", "GBufferSpecularRough", "GBufferNormals", "GBufferEmissive" }, { "HdrColor" }, {} });
+        }
+        else
+        {
+            passes.push_back({ "ray tracing", {}, { "HdrColor" }, {} });
+        }
+
+        if (m_ui->aaMode == AntiAliasingMode::None)
+        {
+            passes.push_back({ "blit", { "HdrColor" }, {}, {} });
+            return passes;
+        }
+
+#if ENABLE_DLSS
+        if (m_ui->aaMode == AntiAliasingMode::DLSS)
+        {
+            if (m_DLSS->IsSupported())
+                passes.push_back({ "dlss", { "DeviceDepthUAV", "MotionVectors", "HdrColor" }, { "ResolvedColor" }, {} });
+            else
+                passes.push_back({ "temporal resolve", { "DeviceDepth", "MotionVectors", "HdrColor", "TemporalFeedback1", "TemporalFeedback2" }, { "ResolvedColor", "TemporalFeedback1", "TemporalFeedback2" }, {} });
+
+            passes.push_back({ "tone mapping", { "ResolvedColor" }, { "LdrColor" }, {} });
+            passes.push_back({ "blit", { "ResolvedColor" }, {}, {} });
+            return passes;
+        }
+#endif
+
+        passes.push_back({ "temporal resolve", { "DeviceDepth", "MotionVectors", "HdrColor", "TemporalFeedback1", "TemporalFeedback2" }, { "ResolvedColor", "TemporalFeedback1", "TemporalFeedback2" }, {} });
+        passes.push_back({ "blit", { "ResolvedColor" }, {}, {} });
+        return passes;
+    }
+
     void BackBufferResizing() override
     { 
         m_ColorBuffer = nullptr;
@@ -701,7 +1587,7 @@ public:
         m_PreviousViewsValid = false;
     }
 
-    void Render(nvrhi::IFramebuffer* framebuffer) override
+    void RenderScene(nvrhi::IFramebuffer* framebuffer) override
     {
         const auto& fbinfo = framebuffer->getFramebufferInfo();
 
@@ -710,19 +1596,12 @@ public:
         uint32_t outputWidth = fbinfo.width;
         uint32_t outputHeight = fbinfo.height;
 
-        if (m_ui->clearShaderCache || m_ui->stfPipelineUpdate)
-        {
-            m_ShaderFactory->ClearCache();
-            m_BindingCache->Clear();
-        }
+        UpdateDispatchAutotuner(uint2(outputWidth, outputHeight));
+        UpdateActivePipeline();
 
-        if (m_ui->stfPipelineUpdate)
-        {
-            CreatePipeline(*m_ShaderFactory);
-            m_ui->stfPipelineUpdate = false;
-        }
+        const std::vector<RenderPassUsage> renderPasses = GetRenderPassUsage();
 
-        if (!m_RenderTargets || m_ui->aaModeChanged)
+        if (!m_RenderTargets || m_ui->aaModeChanged || m_RenderTargets->IsUpdateRequired(renderPasses))
         {
             // Get optimal render resolution before creating render targets
             if (m_DLSS->IsSupported() && m_ui->aaMode == AntiAliasingMode::DLSS)
@@ -731,22 +1610,32 @@ public:
                 m_DLSS->GetRenderSize(&inputWidth, &inputHeight, &outputWidth, &outputHeight);
             }
 
-            m_RenderTargets = std::make_unique<RenderTargets>(GetDevice(), int2(inputWidth, inputHeight), int2(outputWidth, outputHeight));
+            // Passes binding the old targets go with them
+            m_TemporalPass = nullptr;
+            m_ToneMappingPass = nullptr;
+            m_BindingCache->Clear();
+            m_PreviousViewsValid = false;
 
-            render::TemporalAntiAliasingPass::CreateParameters taaParams;
-            taaParams.sourceDepth = m_RenderTargets->DeviceDepth;
-            taaParams.motionVectors = m_RenderTargets->MotionVectors;
-            taaParams.unresolvedColor = m_RenderTargets->HdrColor;
-            taaParams.resolvedColor = m_RenderTargets->ResolvedColor;
-            taaParams.feedback1 = m_RenderTargets->TaaFeedback1;
-            taaParams.feedback2 = m_RenderTargets->TaaFeedback2;
-            taaParams.motionVectorStencilMask = 0x00;
-            taaParams.useCatmullRomFilter = true;
+            m_RenderTargets = std::make_unique<RenderTargets>(GetDevice(), int2(inputWidth, inputHeight), int2(outputWidth, outputHeight), renderPasses);
+            m_RenderTargets->LogMemoryUsage();
 
-            m_TemporalPass = std::make_unique<render::TemporalAntiAliasingPass>(GetDevice(), m_ShaderFactory, m_CommonPasses, m_View, taaParams);
-            if (m_TemporalPass)
+            if (m_ui->aaMode != AntiAliasingMode::None)
             {
-                m_TemporalPass->SetJitter(donut::render::TemporalAntiAliasingJitter::Halton);
+                render::TemporalAntiAliasingPass::CreateParameters taaParams;
+                taaParams.sourceDepth = m_RenderTargets->DeviceDepth;
+                taaParams.motionVectors = m_RenderTargets->MotionVectors;
+                taaParams.unresolvedColor = m_RenderTargets->HdrColor;
+                taaParams.resolvedColor = m_RenderTargets->ResolvedColor;
+                taaParams.feedback1 = m_RenderTargets->TaaFeedback1;
+                taaParams.feedback2 = m_RenderTargets->TaaFeedback2;
+                taaParams.motionVectorStencilMask = 0x00;
+                taaParams.useCatmullRomFilter = true;
+
+                m_TemporalPass = std::make_unique<render::TemporalAntiAliasingPass>(GetDevice(), m_ShaderFactory, m_CommonPasses, m_View, taaParams);
+                if (m_TemporalPass)
+                {
+                    m_TemporalPass->SetJitter(donut::render::TemporalAntiAliasingJitter::Halton);
+                }
             }
 
             m_ui->aaModeChanged = false;
@@ -757,8 +1646,20 @@ public:
             m_DLSS->GetRenderSize(&inputWidth, &inputHeight, &outputWidth, &outputHeight);
         }
 
+        if (m_Sweep && m_Sweep->IsFirstFrameOfConfiguration())
+        {
+            // Every configuration starts from the same STF frame index and without temporal history
+            m_FrameIndex = 0;
+            m_PreviousViewsValid = false;
+        }
+
         m_CommandList->open();
 
+        if (m_Sweep)
+        {
+            m_Sweep->BeginGpuTimer(m_CommandList);
+        }
+
         m_Scene->Refresh(m_CommandList, GetFrameIndex());
 
 #if ENABLE_DLSS
@@ -777,103 +1678,24 @@ public:
         m_View.SetMatrices(m_Camera.GetWorldToViewMatrix(), perspProjD3DStyleReverse(dm::PI_f * 0.25f, windowViewport.width() / windowViewport.height(), 0.1f));
         m_View.UpdateCache();
 
-        auto GetStfRuntimeFilterMode = [](StfFilterMode mode)->int {
-            switch (mode)
-            {
-            case StfFilterMode::Linear: return STF_FILTER_TYPE_LINEAR;
-            case StfFilterMode::Cubic: return STF_FILTER_TYPE_CUBIC;
-            case StfFilterMode::Gaussian: return STF_FILTER_TYPE_GAUSSIAN;
-            default:
-                assert(!"Not Implemented");
-                return 0;
-            }
-            };
-
-        auto GetStfMagMode = [](StfMagMethod mode)->int {
-            switch (mode)
-            {
-            case StfMagMethod::Default: return STF_MAGNIFICATION_METHOD_NONE;
-            case StfMagMethod::Filter2x2Quad: return STF_MAGNIFICATION_METHOD_2x2_QUAD;
-            case StfMagMethod::Filter2x2Fine: return STF_MAGNIFICATION_METHOD_2x2_FINE;
-            case StfMagMethod::Filter2x2FineTemporal: return STF_MAGNIFICATION_METHOD_2x2_FINE_TEMPORAL;
-            case StfMagMethod::Filter3x3FineAlu: return STF_MAGNIFICATION_METHOD_3x3_FINE_ALU;
-            case StfMagMethod::Filter3x3FineLut: return STF_MAGNIFICATION_METHOD_3x3_FINE_LUT;
-            case StfMagMethod::Filter4x4Fine: return STF_MAGNIFICATION_METHOD_4x4_FINE;
-            case StfMagMethod::MinMax: return STF_MAGNIFICATION_METHOD_MIN_MAX;
-            case StfMagMethod::MinMaxHelper: return STF_MAGNIFICATION_METHOD_MIN_MAX_HELPER;
-            case StfMagMethod::MinMaxV2: return STF_MAGNIFICATION_METHOD_MIN_MAX_V2;
-            case StfMagMethod::MinMaxV2Helper: return STF_MAGNIFICATION_METHOD_MIN_MAX_V2_HELPER;
-            case StfMagMethod::Mask: return STF_MAGNIFICATION_METHOD_MASK;
-            case StfMagMethod::Mask2: return STF_MAGNIFICATION_METHOD_MASK2;
-            default:
-                assert(!"Not Implemented");
-                return 0;
-            }
-        };
-
-        auto GetFallbackMagMode = [](StfFallbackMethod mode)->int {
-            switch (mode)
-            {
-            case StfFallbackMethod::BL1STFILTER_FAST: return STF_MAGNIFICATION_FALLBACK_METHOD_BL1STFILTER_FAST;
-            case StfFallbackMethod::Debug: return STF_MAGNIFICATION_FALLBACK_METHOD_DEBUG;
-            default:
-                assert(!"Not Implemented");
-                return 0;
-            }
-            };
-
-        auto GetStfAddressMode = [](StfAddressMode mode)->int {
-            switch (mode)
-            {
-            case StfAddressMode::SameAsSampler: return STF_ADDRESS_MODE_WRAP; // m_CommonPasses->m_AnisotropicWrapSampler
-            case StfAddressMode::Clamp: return STF_ADDRESS_MODE_CLAMP;
-            case StfAddressMode::Wrap: return STF_ADDRESS_MODE_WRAP;
-            default:
-                assert(!"Not Implemented");
-                return 0;
-            }
-            };
+        LightingConstants constants = {};
+        constants.ambientColor = m_ambientColor;
+        FillStfConstants(*m_ui, m_ui->stfFreezeFrameIndex ? m_FrameIndex : m_FrameIndex++, constants);
 
-        float mipLevelOverride = 0; // wont be read by default
+        // The table restarts whenever the UI turns collection on, a file collects the whole run
+        const bool collectStats = m_ui->stfCollectStats || !m_SamplingStatsFile.empty();
+        if (m_ui->stfCollectStats && !m_CollectingStats && m_SamplingStatsFile.empty())
+            m_SamplingStatsTable.Clear();
+        m_CollectingStats = collectStats;
+        constants.stfCollectStats = collectStats && m_SamplingStats->BeginFrame(m_CommandList);
 
-        if (m_ui->stfMinificationMethod == StfMinMethod::ForceNegInf)
-        {
-            const uint32_t negInf = 0xFF800000;
-            mipLevelOverride = reinterpret_cast<const float&>(negInf);
-        }
-        else if (m_ui->stfMinificationMethod == StfMinMethod::ForcePosInf)
-        {
-            const uint32_t posInf = 0x7F800000;
-            mipLevelOverride = reinterpret_cast<const float&>(posInf);
-        }
-        else if (m_ui->stfMinificationMethod == StfMinMethod::ForceNan)
-        {
-            const uint32_t nan = 0x7FC00000;
-            mipLevelOverride = reinterpret_cast<const float&>(nan);
-        }
-        else
+        if (constants.stfFilterKernel != m_FilterKernel)
         {
-            mipLevelOverride = m_ui->stfMipLevelOverride;
+            const std::vector<uint32_t>& filterKernel = StfFilterKernelTable::Get(constants.stfFilterKernel).GetGpuData();
+            m_CommandList->writeBuffer(m_FilterKernelBuffer, filterKernel.data(), filterKernel.size() * sizeof(uint32_t));
+            m_FilterKernel = constants.stfFilterKernel;
         }
 
-        LightingConstants constants = {};
-        constants.ambientColor = m_ambientColor;
-        constants.stfSplitScreen = m_ui->samplerType == SamplerType::SplitScreen ? 1 : 0;
-        constants.stfFrameIndex = m_ui->stfFreezeFrameIndex ? m_FrameIndex : m_FrameIndex++;
-        constants.stfFilterMode = GetStfRuntimeFilterMode(m_ui->stfFilterMode);
-        constants.stfMagnificationMethod = GetStfMagMode(m_ui->stfMagnificationMethod);
-        constants.stfFallbackMethod = GetFallbackMagMode(m_ui->stfFallbackMethod);
-        constants.stfMinificationMethod = m_ui->stfMinificationMethod == StfMinMethod::Aniso ? STF_ANISO_LOD_METHOD_DEFAULT : STF_ANISO_LOD_METHOD_NONE;
-        constants.stfUseMipLevelOverride = m_ui->stfMinificationMethod != StfMinMethod::Aniso ? 1 : 0;
-        constants.stfAddressMode = GetStfAddressMode(m_ui->stfAddressMode);
-        constants.stfMipLevelOverride = mipLevelOverride;
-        constants.stfSigma = m_ui->stfSigma;
-        constants.stfWaveLaneLayoutOverride = (uint)m_ui->stfWaveLaneLayoutOverride;
-        constants.stfReseedOnSample = (uint)m_ui->stfReseedOnSample;
-        constants.stfUseWhiteNoise = (uint)m_ui->stfUseWhiteNoise;
-        constants.stfDebugOnFailure = (uint)m_ui->stfDebugOnFailure;
-        constants.stfDebugVisualizeLanes = (uint)m_ui->stfDebugVisualizeLanes;
-
         m_View.FillPlanarViewConstants(constants.view);
         if (m_PreviousViewsValid)
         {
@@ -883,10 +1705,11 @@ public:
 
         if (m_TemporalPass && m_PreviousViewsValid)
         {
+            m_RenderTargets->BeginPass(m_CommandList, "motion vectors");
             m_TemporalPass->RenderMotionVectors(m_CommandList, m_View, m_ViewPrevious);
         }
 
-        if (m_ui->stfPipelineType == StfPipelineType::Raster)
+        if (m_ActivePermutation.type == StfPipelineType::Raster)
         {
             if (!m_DeferredLightingPass)
             {
@@ -894,7 +1717,7 @@ public:
                 m_DeferredLightingPass->Init(m_ShaderFactory);
             }
 
-            m_GBufferPass->UpdateLightConstantBuffer(m_CommandList, constants);
+            m_ActivePipeline->gbufferPass->UpdateLightConstantBuffer(m_CommandList, constants);
 
             m_SunLight->shadowMap = m_ShadowMap;
             box3 sceneBounds = m_Scene->GetSceneGraph()->GetRootNode()->GetGlobalBoundingBox();
@@ -921,6 +1744,7 @@ public:
                 "ShadowMap",
                 /*m_ui.EnableMaterialEvents*/ false);
 
+            m_RenderTargets->BeginPass(m_CommandList, "gbuffer clear");
             m_CommandList->clearDepthStencilTexture(m_RenderTargets->DeviceDepth, nvrhi::AllSubresources, true, 0.0, true, 0);
             m_CommandList->clearTextureFloat(m_RenderTargets->Depth, nvrhi::AllSubresources, nvrhi::Color(65504.f));
             m_CommandList->clearTextureFloat(m_RenderTargets->HdrColor, nvrhi::AllSubresources, nvrhi::Color(0.f));
@@ -928,6 +1752,8 @@ public:
             m_CommandList->clearTextureFloat(m_RenderTargets->GBufferSpecularRough, nvrhi::AllSubresources, nvrhi::Color(0.f));
             m_CommandList->clearTextureFloat(m_RenderTargets->GBufferNormals, nvrhi::AllSubresources, nvrhi::Color(0.f));
             m_CommandList->clearTextureFloat(m_RenderTargets->GBufferEmissive, nvrhi::AllSubresources, nvrhi::Color(0.f));
+            if (m_ActivePermutation.deferredTexels)
+                m_CommandList->clearTextureUInt(m_RenderTargets->GBufferTexelIds, nvrhi::AllSubresources, 0);
 
             size_t meshCount = m_Scene->GetSceneGraph()->GetMeshInstances().size();
 
@@ -958,17 +1784,29 @@ public:
 
                 GBufferFillPassWithSTF::Context context;
 
+                m_RenderTargets->BeginPass(m_CommandList, "gbuffer");
                 RenderView(
                     m_CommandList,
                     &m_View,
                     m_PreviousViewsValid ? &m_ViewPrevious : &m_View,
                     m_RenderTargets->GBufferFramebuffer->GetFramebuffer(m_View),
                     drawStrategy,
-                    *m_GBufferPass,
+                    *m_ActivePipeline->gbufferPass,
                     context,
                     false);
             }
 
+            if (m_ActivePermutation.deferredTexels)
+            {
+                if (!m_TexelResolvePass)
+                    m_TexelResolvePass = std::make_unique<GpuTexelResolvePass>(GetDevice(), *m_ShaderFactory, m_CommonPasses, m_BindlessLayout);
+
+                m_RenderTargets->BeginPass(m_CommandList, "gbuffer resolve");
+                m_TexelResolvePass->Render(m_CommandList, m_RenderTargets->GBufferResolveFramebuffer->GetFramebuffer(m_View), m_View,
+                    m_RenderTargets->GBufferTexelIds, m_RenderTargets->GBufferGeoNormals, m_Scene->GetMaterialBuffer(),
+                    m_DescriptorTable->GetDescriptorTable());
+            }
+
             GBufferRenderTargets gbufferTargets;
             gbufferTargets.Depth = m_RenderTargets->DeviceDepth;
             gbufferTargets.GBufferDiffuse = m_RenderTargets->GBufferDiffuseAlbedo;
@@ -983,9 +1821,10 @@ public:
             deferredInputs.lights = &m_Scene->GetSceneGraph()->GetLights();
             deferredInputs.output = m_RenderTargets->HdrColor;
 
+            m_RenderTargets->BeginPass(m_CommandList, "deferred lighting");
             m_DeferredLightingPass->Render(m_CommandList, m_View, deferredInputs);
         }
-        else if (m_ui->stfPipelineType != StfPipelineType::Raster)
+        else
         {
             m_CommandList->writeBuffer(m_rayTracingConstantBuffer, &constants, sizeof(constants));
 
@@ -997,18 +1836,23 @@ public:
                 nvrhi::BindingSetItem::StructuredBuffer_SRV(2, m_Scene->GetGeometryBuffer()),
                 nvrhi::BindingSetItem::StructuredBuffer_SRV(3, m_Scene->GetMaterialBuffer()),
                 nvrhi::BindingSetItem::Texture_SRV(4, m_STBNTexture->texture),
+                nvrhi::BindingSetItem::RawBuffer_SRV(5, m_ConstantFootprints->GetBuffer()),
+                nvrhi::BindingSetItem::RawBuffer_SRV(6, m_FilterKernelBuffer),
                 nvrhi::BindingSetItem::Sampler(0, m_CommonPasses->m_AnisotropicWrapSampler),
-                nvrhi::BindingSetItem::Texture_UAV(0, m_RenderTargets->HdrColor)
+                nvrhi::BindingSetItem::Texture_UAV(0, m_RenderTargets->HdrColor),
+                nvrhi::BindingSetItem::RawBuffer_UAV(1, m_SamplingStats->GetBuffer())
             };
 
             m_BindingSet = GetDevice()->createBindingSet(bindingSetDesc, m_BindingLayout);
 
             BuildTLAS(m_CommandList, GetFrameIndex());
 
-            if (m_RayPipeline && m_ui->stfPipelineType == StfPipelineType::RayGen)
+            m_RenderTargets->BeginPass(m_CommandList, "ray tracing");
+
+            if (m_ActivePermutation.type == StfPipelineType::RayGen)
             {
                 nvrhi::rt::State state;
-                state.shaderTable = m_ShaderTable;
+                state.shaderTable = m_ActivePipeline->shaderTable;
                 state.bindings = { m_BindingSet, m_DescriptorTable->GetDescriptorTable() };
                 m_CommandList->setRayTracingState(state);
 
@@ -1017,29 +1861,46 @@ public:
                 args.height = inputHeight;
                 m_CommandList->dispatchRays(args);
             }
-            else if (m_ComputePipeline && m_ui->stfPipelineType == StfPipelineType::Compute)
+            else
             {
                 nvrhi::ComputeState state;
-                state.pipeline = m_ComputePipeline;
+                state.pipeline = m_ActivePipeline->computePipeline;
                 state.bindings = { m_BindingSet, m_DescriptorTable->GetDescriptorTable() };
                 m_CommandList->setComputeState(state);
 
-                uint2 threadDim = GetThreadGroupSize();
+                uint2 threadDim = m_ActivePermutation.threadGroupSize;
+
+                // Only frames that ran the candidate's group size count, a free query slot is never waited for
+                AutotuneQuery& autotuneQuery = m_AutotuneQueries[m_AutotuneQuery];
+                const bool timed = m_Autotuner.IsSearching() && !autotuneQuery.inFlight &&
+                    all(threadDim == m_Autotuner.GetCurrentCandidate().groupSize);
+                if (timed)
+                    m_CommandList->beginTimerQuery(autotuneQuery.query);
 
                 m_CommandList->dispatch(
                     dm::div_ceil(inputWidth, threadDim.x),
                     dm::div_ceil(inputHeight, threadDim.y));
+
+                if (timed)
+                {
+                    m_CommandList->endTimerQuery(autotuneQuery.query);
+                    autotuneQuery.candidate = m_Autotuner.GetCurrentIndex();
+                    autotuneQuery.inFlight = true;
+                    m_AutotuneQuery = (m_AutotuneQuery + 1) % m_AutotuneQueries.size();
+                }
             }
         }
 
         if (m_ui->aaMode == AntiAliasingMode::None)
         {
+            m_RenderTargets->BeginPass(m_CommandList, "blit");
             m_CommonPasses->BlitTexture(m_CommandList, framebuffer, m_RenderTargets->HdrColor, m_BindingCache.get());
         }
 
 #if ENABLE_DLSS
         if (m_DLSS->IsSupported() && m_ui->aaMode == AntiAliasingMode::DLSS)
         {
+            m_RenderTargets->BeginPass(m_CommandList, "dlss");
             m_DLSS->Render(m_CommandList,
                 *m_RenderTargets,
                 m_ToneMappingPass->GetExposureBuffer(),
@@ -1056,6 +1917,7 @@ public:
             if (m_TemporalPass)
             {
                 TemporalAntiAliasingParameters params = {};
+                m_RenderTargets->BeginPass(m_CommandList, "temporal resolve");
                 m_TemporalPass->TemporalResolve(m_CommandList, params, m_PreviousViewsValid, m_View, m_View);
             }
 
@@ -1075,8 +1937,10 @@ public:
             ToneMappingParams.eyeAdaptationSpeedUp = 0.f;
             ToneMappingParams.eyeAdaptationSpeedDown = 0.f;
 
+            m_RenderTargets->BeginPass(m_CommandList, "tone mapping");
             m_ToneMappingPass->SimpleRender(m_CommandList, ToneMappingParams, m_View, m_RenderTargets->ResolvedColor);
 
+            m_RenderTargets->BeginPass(m_CommandList, "blit");
             m_CommonPasses->BlitTexture(m_CommandList, framebuffer, m_RenderTargets->ResolvedColor, m_BindingCache.get());
         }
         else
@@ -1084,6 +1948,7 @@ public:
 #endif
             if (m_ui->aaMode == AntiAliasingMode::TAA)
             {
+                m_RenderTargets->BeginPass(m_CommandList, "blit");
                 m_CommonPasses->BlitTexture(m_CommandList, framebuffer, m_RenderTargets->ResolvedColor, m_BindingCache.get());
             }
 #if ENABLE_DLSS
@@ -1092,9 +1957,42 @@ public:
         m_ViewPrevious = m_View;
         m_PreviousViewsValid = true;
 
+        if (m_Sweep)
+        {
+            m_Sweep->EndGpuTimer(m_CommandList);
+
+            // The color the blit read, before tone mapping
+            m_Sweep->CaptureFrame(m_CommandList, m_ui->aaMode == AntiAliasingMode::None ? m_RenderTargets->HdrColor : m_RenderTargets->ResolvedColor);
+        }
+
+        if (constants.stfCollectStats)
+        {
+            m_SamplingStats->EndFrame(m_CommandList, constants.stfMagnificationMethod);
+        }
+
         m_CommandList->close();
         GetDevice()->executeCommandList(m_CommandList);
 
+        PollAutotuneQueries();
+
+        m_SamplingStats->Submitted();
+        if (m_CollectingStats && m_SamplingStats->Poll(m_SamplingStatsTable, false) != 0)
+        {
+            m_ui->stfSamplingStats = m_SamplingStatsTable.GetTotal(constants.stfMagnificationMethod);
+        }
+
+        if (m_Sweep)
+        {
+            m_Sweep->EndFrame();
+
+            if (m_Sweep->IsFinished())
+            {
+                m_Sweep->WriteReport();
+                m_Sweep = nullptr;
+                glfwSetWindowShouldClose(GetDeviceManager()->GetWindow(), GLFW_TRUE);
+            }
+        }
+
         if (m_TemporalPass)
         {
             m_TemporalPass->AdvanceFrame();
@@ -1102,11 +2000,12 @@ public:
                 ? dm::float2::zero()
                 : m_TemporalPass->GetCurrentPixelOffset());
         }
-
-        if (IsSceneLoaded())
+        else
         {
-            m_ui->isLoading = false;
+            m_View.SetPixelOffset(dm::float2::zero());
         }
+
+        m_ui->isLoading = false;
     }
 };
 
@@ -1127,6 +2026,12 @@ int main(int __argc, const char** __argv)
     deviceParams.backBufferHeight = 1440;
 
     bool useRayQuery = false;
+    std::filesystem::path sweepFileName;
+    std::filesystem::path shaderBlobCacheFileName;
+    bool shaderBlobCacheEnabled = true;
+    bool shaderBlobCacheBenchmark = false;
+    std::filesystem::path samplingStatsFileName;
+    std::filesystem::path dispatchTuningFileName;
     for (int i = 1; i < __argc; i++)
     {
         if (strcmp(__argv[i], "-rayQuery") == 0)
@@ -1138,8 +2043,36 @@ int main(int __argc, const char** __argv)
             deviceParams.enableDebugRuntime = true;
             deviceParams.enableNvrhiValidationLayer = true;
         }
+        else if (strcmp(__argv[i], "-sweep") == 0 && i + 1 < __argc)
+        {
+            sweepFileName = __argv[++i];
+            deviceParams.vsyncEnabled = false;
+        }
+        else if (strcmp(__argv[i], "-shaderBlobCache") == 0 && i + 1 < __argc)
+        {
+            shaderBlobCacheFileName = __argv[++i];
+        }
+        else if (strcmp(__argv[i], "-noShaderBlobCache") == 0)
+        {
+            shaderBlobCacheEnabled = false;
+        }
+        else if (strcmp(__argv[i], "-shaderBlobCacheBenchmark") == 0)
+        {
+            shaderBlobCacheBenchmark = true;
+        }
+        else if (strcmp(__argv[i], "-dispatchTuning") == 0 && i + 1 < __argc)
+        {
+            dispatchTuningFileName = __argv[++i];
+        }
+        else if (strcmp(__argv[i], "-stfStats") == 0 && i + 1 < __argc)
+        {
+            samplingStatsFileName = __argv[++i];
+        }
     }
 
+    if (dispatchTuningFileName.empty())
+        dispatchTuningFileName = app::GetDirectoryWithExecutable() / "dispatch_tuning.json";
+
 #if ENABLE_DLSS && DLSS_WITH_VK
     if (api == nvrhi::GraphicsAPI::VULKAN)
     {
@@ -1167,7 +2100,10 @@ int main(int __argc, const char** __argv)
 
     {
         BindlessRayTracing example(deviceManager);
-        if (example.Init(useRayQuery))
+        example.SetShaderBlobCache(shaderBlobCacheEnabled, shaderBlobCacheFileName, shaderBlobCacheBenchmark);
+        example.SetSamplingStatsFile(samplingStatsFileName);
+        example.SetDispatchTuningFile(dispatchTuningFileName);
+        if (example.Init(useRayQuery) && (sweepFileName.empty() || example.StartSweep(sweepFileName)))
         {
             UserInterface userInterface(deviceManager, *example.GetRootFs(), *example.GetUI());
             userInterface.Init(example.GetShaderFactory());
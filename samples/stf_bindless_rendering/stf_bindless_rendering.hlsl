@@ -19,9 +19,11 @@
 #include <donut/shaders/scene_material.hlsli>
 #include "lighting_cb.h"
 #include "rng.hlsli"
+#include "ray_differentials.hlsli"
 #include "stf_debug.hlsli"
 
 #include "../../libraries/RTXTF-Library/STFSamplerState.hlsli"
+#include "stf_temporal_strata.h"
 
 struct [raypayload] RayPayload
 {
@@ -36,12 +38,15 @@ struct [raypayload] RayPayload
 ConstantBuffer<LightingConstants> g_Const : register(b0);
 
 RWTexture2D<float4> u_Output : register(u0);
+RWByteAddressBuffer u_StfStats : register(u1);
 
 RaytracingAccelerationStructure SceneBVH : register(t0);
 StructuredBuffer<InstanceData> t_InstanceData : register(t1);
 StructuredBuffer<GeometryData> t_GeometryData : register(t2);
 StructuredBuffer<MaterialConstants> t_MaterialConstants : register(t3);
 Texture2D<float4> STBN2DTexture : register(t4);
+ByteAddressBuffer t_StfConstantFootprints : register(t5);
+ByteAddressBuffer t_StfFilterKernel : register(t6);
 
 SamplerState s_MaterialSampler : register(s0);
 
@@ -183,38 +188,16 @@ enum MaterialAttributes
     MatAttr_All          = 0x1F
 };
 
-float4 SampleTexture(inout STF_SamplerState stfSamplerState, bool stfEnabled, Texture2D texture, SamplerState materialSampler, float2 texCoord, float mipLevel)
+#include "stf_texture_sampling.hlsli"
+
+float4 SampleTexture(inout STF_SamplerState stfSamplerState, inout StfSharedFootprint footprint, bool stfEnabled, Texture2D texture, int textureIndex, SamplerState materialSampler, float2 texCoord, float mipLevel)
 {
-#if STF_ENABLED
-    if (stfEnabled)
-    {
-        #if STF_LOAD
-            return stfSamplerState.Texture2DLoadLevel(texture, texCoord, mipLevel);
-        #else
-            return stfSamplerState.Texture2DSampleLevel(texture, materialSampler, texCoord, mipLevel);
-        #endif
-    } else
-#endif
-    {
-        return texture.SampleLevel(materialSampler, texCoord, mipLevel);
-    }
+    return SampleStfTexture(stfSamplerState, footprint, stfEnabled, texture, textureIndex, materialSampler, texCoord, StfTextureLod::CreateLevel(mipLevel));
 }
 
-float4 SampleTextureGrad(inout STF_SamplerState stfSamplerState, bool stfEnabled, Texture2D texture, SamplerState materialSampler, float2 texCoord, float2 texGrad_x, float2 texGrad_y)
+float4 SampleTextureGrad(inout STF_SamplerState stfSamplerState, inout StfSharedFootprint footprint, bool stfEnabled, Texture2D texture, int textureIndex, SamplerState materialSampler, float2 texCoord, float2 texGrad_x, float2 texGrad_y)
 {
-#if STF_ENABLED
-    if (stfEnabled)
-    {
-        #if STF_LOAD
-            return stfSamplerState.Texture2DLoadGrad(texture, texCoord, texGrad_x, texGrad_y);
-        #else
-            return stfSamplerState.Texture2DSampleGrad(texture, materialSampler, texCoord, texGrad_x, texGrad_y);
-        #endif
-    }
-#endif
-    {
-        return texture.SampleGrad(materialSampler, texCoord, texGrad_x, texGrad_y);
-    }
+    return SampleStfTexture(stfSamplerState, footprint, stfEnabled, texture, textureIndex, materialSampler, texCoord, StfTextureLod::CreateGrad(texGrad_x, texGrad_y));
 }
 
 MaterialSample sampleGeometryMaterial(
@@ -229,20 +212,13 @@ MaterialSample sampleGeometryMaterial(
 {
     MaterialTextureSample textures = DefaultMaterialTextures();
 
-    float3 u = RNG::SpatioTemporalBlueNoise2D(pixelPosition, g_Const.stfFrameIndex, STBN2DTexture);
+    const uint noiseFrame = GetStfTemporalStrataFrame(g_Const.stfFrameIndex, g_Const.stfTemporalStrata);
+    float3 u = RNG::SpatioTemporalBlueNoise2D(pixelPosition, noiseFrame, STBN2DTexture);
     if (g_Const.stfUseWhiteNoise)
-        u = RNG::SpatioTemporalWhiteNoise3D(pixelPosition, g_Const.stfFrameIndex);
+        u = RNG::SpatioTemporalWhiteNoise3D(pixelPosition, noiseFrame);
+    u = StratifyStfRandom(u, g_Const.stfFrameIndex, g_Const.stfTemporalStrata, g_Const.stfTemporalGenerator);
     
-    STF_SamplerState samplerState = STF_SamplerState::Create(float4(u.x, u.y, 0 /*slice - unused*/, u.z));
-    samplerState.SetFilterType(g_Const.stfFilterMode);
-    samplerState.SetFrameIndex(g_Const.stfFrameIndex);
-    samplerState.SetMagMethod(g_Const.stfMagnificationMethod);
-    samplerState.SetFallbackMethod(g_Const.stfFallbackMethod);
-    samplerState.SetAddressingModes(g_Const.stfAddressMode.xxx);
-    samplerState.SetSigma(g_Const.stfSigma);
-    samplerState.SetAnisoMethod(g_Const.stfMinificationMethod);
-    samplerState.SetReseedOnSample(g_Const.stfReseedOnSample);
-    samplerState.SetDebugFailure(g_Const.stfDebugOnFailure);
+    STF_SamplerState samplerState = CreateSTF(u);
     
 #if STF_ENABLED
     bool stfEnabled = true && (gs.material.domain != MaterialDomain_AlphaTested);
@@ -254,17 +230,25 @@ MaterialSample sampleGeometryMaterial(
     const bool stfEnabled = false;
 #endif
 
+    const bool shareFootprints = StfSharedFootprint::IsSharedFootprintEnabled(g_Const.stfShareFootprints != 0, g_Const.stfMagnificationMethod,
+        g_Const.stfReseedOnSample != 0 || g_Const.stfDecorrelateTextures != 0);
+    StfSharedFootprint footprint = StfSharedFootprint::CreateGrad(shareFootprints, gs.texcoord, texGrad_x, texGrad_y);
+    if (forceMipLevel)
+        footprint = StfSharedFootprint::CreateLevel(shareFootprints, gs.texcoord, mipLevel);
+
     if ((attributes & MatAttr_BaseColor) && (gs.material.baseOrDiffuseTextureIndex >= 0) && (gs.material.flags & MaterialFlags_UseBaseOrDiffuseTexture) != 0)
     {
         Texture2D diffuseTexture = t_BindlessTextures[NonUniformResourceIndex(gs.material.baseOrDiffuseTextureIndex)];
 
+        DecorrelateSTF(samplerState, u, STF_TEXTURE_SLOT_BASE_OR_DIFFUSE);
+
         if (forceMipLevel)
         {
-            textures.baseOrDiffuse = SampleTexture(samplerState, stfEnabled, diffuseTexture, materialSampler, gs.texcoord, mipLevel);
+            textures.baseOrDiffuse = SampleTexture(samplerState, footprint, stfEnabled, diffuseTexture, gs.material.baseOrDiffuseTextureIndex, materialSampler, gs.texcoord, mipLevel);
         }
         else
         {
-            textures.baseOrDiffuse = SampleTextureGrad(samplerState, stfEnabled, diffuseTexture, materialSampler, gs.texcoord, texGrad_x, texGrad_y);
+            textures.baseOrDiffuse = SampleTextureGrad(samplerState, footprint, stfEnabled, diffuseTexture, gs.material.baseOrDiffuseTextureIndex, materialSampler, gs.texcoord, texGrad_x, texGrad_y);
         }
     }
 
@@ -272,13 +256,15 @@ MaterialSample sampleGeometryMaterial(
     {
         Texture2D emissiveTexture = t_BindlessTextures[NonUniformResourceIndex(gs.material.emissiveTextureIndex)];
 
+        DecorrelateSTF(samplerState, u, STF_TEXTURE_SLOT_EMISSIVE);
+
         if (forceMipLevel)
         {
-            textures.emissive = SampleTexture(samplerState, stfEnabled, emissiveTexture, materialSampler, gs.texcoord, mipLevel);
+            textures.emissive = SampleTexture(samplerState, footprint, stfEnabled, emissiveTexture, gs.material.emissiveTextureIndex, materialSampler, gs.texcoord, mipLevel);
         }
         else
         {
-            textures.emissive = SampleTextureGrad(samplerState, stfEnabled, emissiveTexture, materialSampler, gs.texcoord, texGrad_x, texGrad_y);
+            textures.emissive = SampleTextureGrad(samplerState, footprint, stfEnabled, emissiveTexture, gs.material.emissiveTextureIndex, materialSampler, gs.texcoord, texGrad_x, texGrad_y);
         }
     }
     
@@ -286,13 +272,15 @@ MaterialSample sampleGeometryMaterial(
     {
         Texture2D normalsTexture = t_BindlessTextures[NonUniformResourceIndex(gs.material.normalTextureIndex)];
 
+        DecorrelateSTF(samplerState, u, STF_TEXTURE_SLOT_NORMAL);
+
         if (forceMipLevel)
         {
-            textures.normal = SampleTexture(samplerState, stfEnabled, normalsTexture, materialSampler, gs.texcoord, mipLevel);
+            textures.normal = SampleTexture(samplerState, footprint, stfEnabled, normalsTexture, gs.material.normalTextureIndex, materialSampler, gs.texcoord, mipLevel);
         }
         else
         {
-            textures.normal = SampleTextureGrad(samplerState, stfEnabled, normalsTexture, materialSampler, gs.texcoord, texGrad_x, texGrad_y);
+            textures.normal = SampleTextureGrad(samplerState, footprint, stfEnabled, normalsTexture, gs.material.normalTextureIndex, materialSampler, gs.texcoord, texGrad_x, texGrad_y);
         }
     }
 
@@ -300,13 +288,15 @@ MaterialSample sampleGeometryMaterial(
     {
         Texture2D specularTexture = t_BindlessTextures[NonUniformResourceIndex(gs.material.metalRoughOrSpecularTextureIndex)];
 
+        DecorrelateSTF(samplerState, u, STF_TEXTURE_SLOT_METAL_ROUGH_OR_SPECULAR);
+
         if (forceMipLevel)
         {
-            textures.metalRoughOrSpecular = SampleTexture(samplerState, stfEnabled, specularTexture, materialSampler, gs.texcoord, mipLevel);
+            textures.metalRoughOrSpecular = SampleTexture(samplerState, footprint, stfEnabled, specularTexture, gs.material.metalRoughOrSpecularTextureIndex, materialSampler, gs.texcoord, mipLevel);
         }
         else
         {
-            textures.metalRoughOrSpecular = SampleTextureGrad(samplerState, stfEnabled, specularTexture, materialSampler, gs.texcoord, texGrad_x, texGrad_y);
+            textures.metalRoughOrSpecular = SampleTextureGrad(samplerState, footprint, stfEnabled, specularTexture, gs.material.metalRoughOrSpecularTextureIndex, materialSampler, gs.texcoord, texGrad_x, texGrad_y);
         }
     }
 
@@ -314,13 +304,15 @@ MaterialSample sampleGeometryMaterial(
     {
         Texture2D transmissionTexture = t_BindlessTextures[NonUniformResourceIndex(gs.material.transmissionTextureIndex)];
 
+        DecorrelateSTF(samplerState, u, STF_TEXTURE_SLOT_TRANSMISSION);
+
         if (forceMipLevel)
         {
-            textures.transmission = SampleTexture(samplerState, stfEnabled, transmissionTexture, materialSampler, gs.texcoord, mipLevel);
+            textures.transmission = SampleTexture(samplerState, footprint, stfEnabled, transmissionTexture, gs.material.transmissionTextureIndex, materialSampler, gs.texcoord, mipLevel);
         }
         else
         {
-            textures.transmission = SampleTextureGrad(samplerState, stfEnabled, transmissionTexture, materialSampler, gs.texcoord, texGrad_x, texGrad_y);
+            textures.transmission = SampleTextureGrad(samplerState, footprint, stfEnabled, transmissionTexture, gs.material.transmissionTextureIndex, materialSampler, gs.texcoord, texGrad_x, texGrad_y);
         }
     }
 
@@ -394,23 +386,16 @@ float3 shadeSurface(
     GeometrySample gs = getGeometryFromHit(payload.instanceID, payload.primitiveIndex, payload.geometryIndex, payload.barycentrics, 
         GeomAttr_All, t_InstanceData, t_GeometryData, t_MaterialConstants);
     
-    RayDesc ray_0 = setupPrimaryRay(pixelPosition, g_Const.view);
-    RayDesc ray_x = setupPrimaryRay(pixelPosition + uint2(1, 0), g_Const.view);
-    RayDesc ray_y = setupPrimaryRay(pixelPosition + uint2(0, 1), g_Const.view);
-    float3 worldSpacePositions[3];
-    worldSpacePositions[0] = mul(gs.instance.transform, float4(gs.vertexPositions[0], 1.0)).xyz;
-    worldSpacePositions[1] = mul(gs.instance.transform, float4(gs.vertexPositions[1], 1.0)).xyz;
-    worldSpacePositions[2] = mul(gs.instance.transform, float4(gs.vertexPositions[2], 1.0)).xyz;
-    float3 bary_0 = computeRayIntersectionBarycentrics(worldSpacePositions, ray_0.Origin, ray_0.Direction);
-    float3 bary_x = computeRayIntersectionBarycentrics(worldSpacePositions, ray_x.Origin, ray_x.Direction);
-    float3 bary_y = computeRayIntersectionBarycentrics(worldSpacePositions, ray_y.Origin, ray_y.Direction);
-    float2 texcoord_0 = interpolate(gs.vertexTexcoords, bary_0);
-    float2 texcoord_x = interpolate(gs.vertexTexcoords, bary_x);
-    float2 texcoord_y = interpolate(gs.vertexTexcoords, bary_y);
-    float2 texGrad_x = texcoord_x - texcoord_0;
-    float2 texGrad_y = texcoord_y - texcoord_0;
-    
-    
+    // Texture gradients from the camera ray differential at the hit, instead of intersecting the neighbor pixel rays
+    float3 worldSpaceEdge1 = mul(gs.instance.transform, float4(gs.vertexPositions[1] - gs.vertexPositions[0], 0.0)).xyz;
+    float3 worldSpaceEdge2 = mul(gs.instance.transform, float4(gs.vertexPositions[2] - gs.vertexPositions[0], 0.0)).xyz;
+    TexcoordJacobian jacobian = computeTexcoordJacobian(worldSpaceEdge1, worldSpaceEdge2, gs.vertexTexcoords);
+    RayDifferential rayDifferential = getPrimaryRayDifferential(pixelPosition, g_Const.view);
+    float3 dP_x, dP_y;
+    transferRayDifferential(rayDifferential, viewDirection, payload.committedRayT, cross(worldSpaceEdge1, worldSpaceEdge2), dP_x, dP_y);
+    float2 texGrad_x, texGrad_y;
+    getTextureGradients(jacobian, dP_x, dP_y, texGrad_x, texGrad_y);
+
     const bool forceMipLevel = g_Const.stfUseMipLevelOverride == 1;
     const float mipLevel = g_Const.stfMipLevelOverride;
 
@@ -9,9 +9,13 @@
  **************************************************************************/
 
 #include "stf_bindless_rendering.hlsl"
+#include "dispatch_swizzle.h"
 
 [numthreads(THREAD_SIZE_X, THREAD_SIZE_Y, 1)]
-void main_cs(uint2 pixelPosition : SV_DispatchThreadID, uint2 groupID : SV_GroupThreadID )
+void main_cs(uint2 groupID : SV_GroupID, uint2 groupThreadID : SV_GroupThreadID )
 {
-	main(pixelPosition);
+	const uint2 groupSize = uint2(THREAD_SIZE_X, THREAD_SIZE_Y);
+	const uint2 groupCount = (uint2(g_Const.view.viewportSize) + groupSize - 1) / groupSize;
+	const uint2 group = SwizzleGroupIndex(groupID.y * groupCount.x + groupID.x, groupCount, g_Const.stfGroupSwizzle, g_Const.stfGroupSwizzleSize);
+	main(group * groupSize + groupThreadID);
 }
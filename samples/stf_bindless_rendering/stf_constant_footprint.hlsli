@@ -0,0 +1,202 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_CONSTANT_FOOTPRINT_HLSLI
+#define STF_CONSTANT_FOOTPRINT_HLSLI
+
+#include "stf_constant_footprint_cb.h"
+#include "../../libraries/RTXTF-Library/STFDefinitions.h"
+#include "stf_ewa.h"
+
+// Early-out of the STF sample: when every texel the stochastic filter can reach holds the same value, any of them is
+// the result, so the sample needs one Load and no random numbers. The reachable texels are bounded by the mips the
+// level of detail selects between and the filter support around all positions the anisotropic tap can move to, and
+// tested against the constant blocks that constant_footprint_cs.hlsl builds per texture.
+// The bound follows the sample position model of StfCpuSamplerState::GetConstantTapGrad/Level, the CPU version.
+// Only the Load path uses it: Texture2DSample* filters around the sample position with the hardware sampler.
+namespace StfConstantFootprint
+{
+    struct Filter
+    {
+        uint filterType;
+        uint addressMode;
+        float sigma;
+        uint anisoMethod;
+        bool ewaEnabled;
+    };
+
+    Filter CreateFilter(uint filterType, uint addressMode, float sigma, uint anisoMethod, bool ewaEnabled)
+    {
+        Filter filter;
+        filter.filterType = filterType;
+        filter.addressMode = addressMode;
+        filter.sigma = sigma;
+        filter.anisoMethod = anisoMethod;
+        filter.ewaEnabled = ewaEnabled;
+        return filter;
+    }
+
+    bool IsEnabled(bool constantFootprints)
+    {
+#if STF_LOAD
+        return constantFootprints;
+#else
+        return false;
+#endif
+    }
+
+    bool GetBlock(ByteAddressBuffer blocks, uint tableOffset, uint mip, uint level, uint2 mipSize, uint2 block)
+    {
+        const uint bitsOffset = blocks.Load((tableOffset + mip * STF_CONSTANT_FOOTPRINT_LEVELS + level) * 4);
+        const uint stride = 2u << level;
+        const uint blocksX = (mipSize.x + stride - 1) / stride;
+        const uint bit = block.y * blocksX + block.x;
+        return (blocks.Load((bitsOffset + bit / 32) * 4) >> (bit % 32)) & 1;
+    }
+
+    // Whether all texels from minTexel to maxTexel are equal, the rectangle must be inside the mip
+    bool IsConstant(ByteAddressBuffer blocks, uint tableOffset, uint mip, uint2 mipSize, int2 minTexel, int2 maxTexel)
+    {
+        const int2 extent = maxTexel - minTexel + 1;
+
+        [unroll]
+        for (uint level = 0; level < STF_CONSTANT_FOOTPRINT_LEVELS; level++)
+        {
+            // The block of the first texel contains the rectangle when it ends before the next but one block starts
+            const int stride = 2 << level;
+            if (all((minTexel & (stride - 1)) + extent <= 2 * stride))
+                return GetBlock(blocks, tableOffset, mip, level, mipSize, uint2(minTexel) >> (level + 1));
+        }
+
+        return false;
+    }
+
+    // Texels the filter can reach from the texel positions positionMin to positionMax, before addressing
+    void GetFilterSupport(Filter filter, float2 positionMin, float2 positionMax, out int2 minTexel, out int2 maxTexel)
+    {
+        if (filter.filterType == STF_FILTER_TYPE_CUBIC)
+        {
+            minTexel = int2(floor(positionMin)) - 1;
+            maxTexel = int2(floor(positionMax)) + 2;
+        }
+        else if (filter.filterType == STF_FILTER_TYPE_GAUSSIAN)
+        {
+            // The largest Box-Muller radius of random numbers of at least 1e-7
+            const float radius = filter.sigma * sqrt(-2.f * log(1e-7f));
+            minTexel = int2(floor(positionMin - radius + 0.5f));
+            maxTexel = int2(floor(positionMax + radius + 0.5f));
+        }
+        else
+        {
+            minTexel = int2(floor(positionMin));
+            maxTexel = int2(floor(positionMax)) + 1;
+        }
+    }
+
+    // Moves the texel range into the mip, false when wrapping splits it
+    bool ApplyAddressMode(inout int2 minTexel, inout int2 maxTexel, int2 size, uint addressMode)
+    {
+        if (addressMode == STF_ADDRESS_MODE_CLAMP)
+        {
+            minTexel = clamp(minTexel, 0, size - 1);
+            maxTexel = clamp(maxTexel, 0, size - 1);
+            return true;
+        }
+
+        const int2 wrapped = ((minTexel % size) + size) % size;
+        maxTexel = wrapped + (maxTexel - minTexel);
+        minTexel = wrapped;
+        return all(maxTexel < size);
+    }
+
+    bool FindTexel(ByteAddressBuffer blocks, int textureIndex, Texture2D texture, Filter filter, float2 uvMin, float2 uvMax, float mipLevel,
+        out int3 texel)
+    {
+        texel = 0;
+        if (textureIndex < 0 || textureIndex >= STF_CONSTANT_FOOTPRINT_MAX_TEXTURES)
+            return false;
+
+        const uint tableOffset = blocks.Load(textureIndex * 4);
+        if (tableOffset == 0)
+            return false;
+
+        uint width, height, mipCount;
+        texture.GetDimensions(0, width, height, mipCount);
+
+        mipLevel = isnan(mipLevel) ? 0.f : clamp(mipLevel, 0.f, float(mipCount - 1));
+        const uint lower = uint(mipLevel);
+        const uint upper = mipLevel > float(lower) ? min(lower + 1, mipCount - 1) : lower;
+
+        // The mips the stochastic trilinear filter chooses between must agree on the value
+        float4 value = 0.f;
+        for (uint mip = lower; mip <= upper; mip++)
+        {
+            const int2 size = int2(max(uint2(width, height) >> mip, 1u));
+            int2 minTexel, maxTexel;
+            GetFilterSupport(filter, uvMin * float2(size) - 0.5f, uvMax * float2(size) - 0.5f, minTexel, maxTexel);
+
+            if (!ApplyAddressMode(minTexel, maxTexel, size, filter.addressMode) ||
+                !IsConstant(blocks, tableOffset, mip, uint2(size), minTexel, maxTexel))
+            {
+                return false;
+            }
+
+            const float4 mipValue = texture.Load(int3(minTexel, mip));
+            if (mip == lower)
+            {
+                texel = int3(minTexel, mip);
+                value = mipValue;
+            }
+            else if (any(mipValue != value))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool FindTexelLevel(ByteAddressBuffer blocks, int textureIndex, Texture2D texture, Filter filter, float2 uv, float mipLevel, out int3 texel)
+    {
+        return FindTexel(blocks, textureIndex, texture, filter, uv, uv, mipLevel, texel);
+    }
+
+    bool FindTexelGrad(ByteAddressBuffer blocks, int textureIndex, Texture2D texture, Filter filter, float2 uv, float2 ddxUV, float2 ddyUV,
+        out int3 texel)
+    {
+        uint width, height;
+        texture.GetDimensions(width, height);
+        const float2 size = float2(width, height);
+        const float lengthX = length(ddxUV * size);
+        const float lengthY = length(ddyUV * size);
+
+        if (filter.anisoMethod == STF_ANISO_LOD_METHOD_NONE)
+            return FindTexel(blocks, textureIndex, texture, filter, uv, uv, log2(max(max(lengthX, lengthY), 1e-8f)), texel);
+
+        // EWA: the tap moves anywhere inside the ellipse, bounded by the box around both semi-axes
+        if (filter.ewaEnabled)
+        {
+            const StfEwaFootprint footprint = GetStfEwaFootprint(ddxUV, ddyUV, size);
+            const float2 ellipseReach = abs(footprint.majorAxis) + abs(footprint.minorAxis);
+            return FindTexel(blocks, textureIndex, texture, filter, uv - ellipseReach, uv + ellipseReach, footprint.lod, texel);
+        }
+
+        // Level from the minor axis, the tap moves by up to half the spread along the major axis in either direction
+        const float major = max(lengthX, lengthY);
+        const float minor = min(lengthX, lengthY);
+        const float anisotropy = minor > 0.f ? min(major / minor, 16.f) : (major > 0.f ? 16.f : 1.f);
+        const float spread = anisotropy > 1.f ? 1.f - 1.f / anisotropy : 0.f;
+        const float2 reach = abs(lengthX > lengthY ? ddxUV : ddyUV) * (0.5f * spread);
+
+        return FindTexel(blocks, textureIndex, texture, filter, uv - reach, uv + reach, log2(max(major / anisotropy, 1e-8f)), texel);
+    }
+}
+
+#endif // STF_CONSTANT_FOOTPRINT_HLSLI
@@ -0,0 +1,40 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_CONSTANT_FOOTPRINT_CB_H
+#define STF_CONSTANT_FOOTPRINT_CB_H
+
+// Constant blocks of the textures, see stf_constant_footprint.hlsli. Block level l of a mip has a stride of
+// 2 << l texels and blocks of 4 << l texels, so consecutive blocks overlap by half: block (i, j) covers the
+// texels [i, i + 2) * stride in both axes, clamped to the mip, and its bit is set when all of them are equal.
+// A footprint of up to stride + 1 texels per axis always lies inside the block of its first texel.
+#define STF_CONSTANT_FOOTPRINT_LEVELS 4
+
+// Buffer layout, in uints:
+//  - STF_CONSTANT_FOOTPRINT_MAX_TEXTURES offsets of the texture tables, by bindless texture descriptor, 0 without blocks
+//  - per texture, mip count * STF_CONSTANT_FOOTPRINT_LEVELS offsets of the block bits, in mip-major order
+//  - the block bits of each mip and level, row-major with ceil(mip size / stride) blocks per row
+#define STF_CONSTANT_FOOTPRINT_MAX_TEXTURES 1024
+
+// Push constants of constant_footprint_cs.hlsl
+struct ConstantFootprintBuildConstants
+{
+    uint mip;
+    uint level;
+    uint blocksX;
+    uint blocksY;
+
+    uint outputOffset;      // uint offsets of the bits of the level, and of the level below
+    uint inputOffset;
+    uint inputBlocksX;
+    uint inputBlocksY;
+};
+
+#endif // STF_CONSTANT_FOOTPRINT_CB_H
@@ -0,0 +1,43 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_DECORRELATION_H
+#define STF_DECORRELATION_H
+
+// Per-texture random numbers of the material textures, shared by the shaders and the CPU sampler.
+// C++ includes this like lighting_cb.h, with donut::math in scope.
+// Without reseeding, all textures of a material use the random numbers of the pixel, so their STF taps move
+// together: where the base color picks its left neighbor, so does the normal map. Decorrelate Textures rotates the
+// random numbers of every texture slot by its own offset (a Cranley-Patterson rotation). A rotation of a uniform
+// random number is again uniform, and a constant rotation keeps the spatial and temporal spectrum of the blue noise,
+// so every texture keeps blue noise while the slots pick different taps. The offsets are the R3 low-discrepancy
+// sequence, which spreads the rotations of consecutive slots evenly over the unit cube.
+#define STF_TEXTURE_SLOT_BASE_OR_DIFFUSE 0      // not rotated, the base color samples as without decorrelation
+#define STF_TEXTURE_SLOT_METAL_ROUGH_OR_SPECULAR 1
+#define STF_TEXTURE_SLOT_EMISSIVE 2
+#define STF_TEXTURE_SLOT_NORMAL 3
+#define STF_TEXTURE_SLOT_OCCLUSION 4
+#define STF_TEXTURE_SLOT_TRANSMISSION 5
+#define STF_TEXTURE_SLOT_OPACITY 6
+
+#ifdef __cplusplus
+#define STF_DECORRELATION_FUNCTION inline
+#else
+#define STF_DECORRELATION_FUNCTION
+#endif
+
+// The random numbers of InitSTF rotated for one texture slot, in [0, 1)
+STF_DECORRELATION_FUNCTION float3 DecorrelateStfRandom(float3 u, uint textureSlot)
+{
+    const float3 rotated = u + float3(0.8191725134f, 0.6710435964f, 0.5497004779f) * float(textureSlot);
+    return rotated - float3(floor(rotated.x), floor(rotated.y), floor(rotated.z));
+}
+
+#endif // STF_DECORRELATION_H
@@ -0,0 +1,84 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_EWA_H
+#define STF_EWA_H
+
+// Stochastic elliptical weighted average (EWA) minification, shared by the shaders and the CPU sampler.
+// C++ includes this like lighting_cb.h, with donut::math in scope.
+// The texture coordinate derivatives map the pixel to an ellipse in the texture, whose axes are the singular vectors
+// of the Jacobian. EWA weights the texels inside it by a Gaussian exp(-alpha r^2) of the radius r in the unit ellipse,
+// on the mip of the minor axis. The stochastic version draws one position from that Gaussian, which for anisotropic
+// footprints lies essentially along the major axis, and takes one STF tap there on the mip of the minor axis: in
+// expectation this is EWA with the weights of the STF filter in place of point texels, at one fetch per sample.
+// Unlike STF_ANISO_LOD_METHOD_DEFAULT, which moves along the longer of the two derivatives, the axes follow skewed
+// footprints, and the Gaussian falls off smoothly instead of ending at the footprint edge.
+// EWA is enabled by its own constant, not an aniso method: the library never filters with it.
+
+#define STF_EWA_MAX_ANISOTROPY 16.f
+#define STF_EWA_ALPHA 2.f               // falloff of the Gaussian, exp(-alpha) at the edge of the ellipse
+
+#ifdef __cplusplus
+#define STF_EWA_FUNCTION inline
+#else
+#define STF_EWA_FUNCTION
+#endif
+
+struct StfEwaFootprint
+{
+    float2 majorAxis;   // semi-axes of the ellipse in texture coordinates
+    float2 minorAxis;   // at least the major axis over STF_EWA_MAX_ANISOTROPY long
+    float lod;          // level of detail of the minor axis
+};
+
+// size is the size of the base level in texels
+STF_EWA_FUNCTION StfEwaFootprint GetStfEwaFootprint(float2 ddxUV, float2 ddyUV, float2 size)
+{
+    // The rows of the Jacobian in texels and its covariance [a b; b c], whose eigenvalues are the squared semi-axes
+    const float2 dx = ddxUV * size;
+    const float2 dy = ddyUV * size;
+    const float a = dx.x * dx.x + dy.x * dy.x;
+    const float b = dx.x * dx.y + dy.x * dy.y;
+    const float c = dx.y * dx.y + dy.y * dy.y;
+    const float halfTrace = 0.5f * (a + c);
+    const float root = sqrt(0.25f * (a - c) * (a - c) + b * b);
+    const float major = sqrt(halfTrace + root);
+    const float minorSquared = halfTrace - root;
+    float minor = minorSquared > 0.f ? sqrt(minorSquared) : 0.f;
+    if (minor * STF_EWA_MAX_ANISOTROPY < major)
+        minor = major / STF_EWA_MAX_ANISOTROPY;
+
+    // Eigenvector of the larger eigenvalue
+    float2 direction = float2(halfTrace + root - c, b);
+    if (b * b <= 1e-12f * halfTrace * halfTrace)
+        direction = a >= c ? float2(1.f, 0.f) : float2(0.f, 1.f);
+    const float directionLength = sqrt(dot(direction, direction));
+    direction = direction / directionLength;
+
+    StfEwaFootprint footprint;
+    footprint.majorAxis = direction * major / size;
+    footprint.minorAxis = float2(-direction.y, direction.x) * minor / size;
+    footprint.lod = log2(minor > 1e-8f ? minor : 1e-8f);
+    return footprint;
+}
+
+// The offset of one tap from the center in texture coordinates, u0 and u1 uniform in [0, 1). The radius follows the
+// truncated Gaussian weighted by the circumference r, so the position is distributed like the EWA weights.
+STF_EWA_FUNCTION float2 GetStfEwaOffset(StfEwaFootprint footprint, float u0, float u1)
+{
+    // ln from log2, since log also names donut::log in the C++ files
+    const float r = sqrt(-0.69314718f * log2(1.f - u0 * (1.f - exp(-STF_EWA_ALPHA))) / STF_EWA_ALPHA);
+    const float angle = 6.28318531f * u1;
+    const float alongMajor = r * cos(angle);
+    const float alongMinor = r * sin(angle);
+    return footprint.majorAxis * alongMajor + footprint.minorAxis * alongMinor;
+}
+
+#endif // STF_EWA_H
@@ -0,0 +1,49 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_EWA_HLSLI
+#define STF_EWA_HLSLI
+
+#include "../../libraries/RTXTF-Library/STFSamplerState.hlsli"
+#include "rng.hlsli"
+#include "stf_ewa.h"
+
+// EWA minification, see stf_ewa.h: the tap moves to a Gaussian distributed position in the elliptical
+// footprint and the library filters it on the mip of the minor axis, with its stochastic choice between two mips.
+// The offset takes two random numbers hashed from the sampler state, so it is not correlated with the texel choice
+// of the filter. Only the gradient variants use it. StfCpuSamplerState::GetTapGrad is the CPU version.
+namespace StfEwa
+{
+    bool IsEnabled(bool ewaEnabled)
+    {
+        return ewaEnabled;
+    }
+
+    float4 SampleGrad(inout STF_SamplerState stfSamplerState, Texture2D texture, SamplerState materialSampler, float2 uv,
+        float2 ddxUV, float2 ddyUV)
+    {
+        uint width, height;
+        texture.GetDimensions(width, height);
+        const StfEwaFootprint footprint = GetStfEwaFootprint(ddxUV, ddyUV, float2(width, height));
+
+        const float4 u = stfSamplerState.GetUniformRandom();
+        uint hash = RNG::Hash32Combine(RNG::Hash32(asuint(u.x)), asuint(u.w));
+        const float u0 = RNG::SampleNext1D(hash);
+        const float u1 = RNG::SampleNext1D(hash);
+        uv += GetStfEwaOffset(footprint, u0, u1);
+#if STF_LOAD
+        return stfSamplerState.Texture2DLoadLevel(texture, uv, footprint.lod);
+#else
+        return stfSamplerState.Texture2DSampleLevel(texture, materialSampler, uv, footprint.lod);
+#endif
+    }
+}
+
+#endif // STF_EWA_HLSLI
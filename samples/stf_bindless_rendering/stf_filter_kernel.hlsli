@@ -0,0 +1,122 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_FILTER_KERNEL_HLSLI
+#define STF_FILTER_KERNEL_HLSLI
+
+#include "stf_filter_kernel_cb.h"
+#include "../../libraries/RTXTF-Library/STFSamplerState.hlsli"
+
+// The custom filter kernel: one tap of a separable kernel (Lanczos, Mitchell-Netravali, Kaiser) drawn from the alias
+// tables StfFilterKernelTable builds on the host, one table lookup per axis. Taps of negative lobes return the texel
+// times a negative weight, so a single sample can leave [0, 1] while the expectation is the filtered texture.
+// The level of detail is isotropic, from the major axis of the footprint like STF_ANISO_LOD_METHOD_NONE, with the
+// stochastic choice between two mips of the library. The random numbers come from the sampler state and are not
+// reseeded. Only the Load path uses it; the magnification methods of the library do not apply.
+namespace StfFilterKernel
+{
+    bool IsEnabled(bool filterKernelEnabled)
+    {
+#if STF_LOAD
+        return filterKernelEnabled;
+#else
+        return false;
+#endif
+    }
+
+    // One axis: the offset of the tap from the texel below the sample position, and its signed weight.
+    // StfFilterKernelTable::SampleAxis is the CPU version.
+    int SampleAxis(ByteAddressBuffer table, float f, float u, out float weight)
+    {
+        const uint tapCount = table.Load(0);
+        const int firstOffset = int(table.Load(4));
+
+        // Pick one of the two phases around f, then reuse the rest of u
+        const float position = f * float(STF_FILTER_KERNEL_PHASES);
+        const uint lower = min(uint(position), STF_FILTER_KERNEL_PHASES - 1);
+        const float t = position - float(lower);
+
+        uint phase = lower;
+        if (u < t)
+        {
+            phase = lower + 1;
+            u = u / t;
+        }
+        else
+        {
+            u = (u - t) / (1.f - t);
+        }
+        u = min(u, 0.99999994f);
+
+        const float scaled = u * float(tapCount);
+        const uint column = min(uint(scaled), tapCount - 1);
+        const float coin = scaled - float(column);
+
+        const uint phaseOffset = (STF_FILTER_KERNEL_HEADER + phase * STF_FILTER_KERNEL_PHASE_STRIDE) * 4;
+        const uint2 entry = table.Load2(phaseOffset + (1 + 2 * column) * 4);
+        const bool keep = coin < asfloat(entry.x);
+        const uint tap = keep ? column : (entry.y & 0xff);
+        const bool negative = ((entry.y >> (keep ? 8 : 9)) & 1) != 0;
+
+        const float absSum = asfloat(table.Load(phaseOffset));
+        weight = negative ? -absSum : absSum;
+        return firstOffset + int(tap);
+    }
+
+    int ApplyAddressMode(int coordinate, int size, uint addressMode)
+    {
+        if (addressMode == STF_ADDRESS_MODE_CLAMP)
+            return clamp(coordinate, 0, size - 1);
+        return ((coordinate % size) + size) % size;
+    }
+
+    // u is [u, v, slice, mip] like STF_SamplerState::GetUniformRandom
+    float4 Load(ByteAddressBuffer table, Texture2D texture, float4 u, float2 uv, float mipLevel, uint addressMode)
+    {
+        uint width, height, mipCount;
+        texture.GetDimensions(0, width, height, mipCount);
+
+        mipLevel = isnan(mipLevel) ? 0.f : clamp(mipLevel, 0.f, float(mipCount - 1));
+        uint mip = uint(mipLevel);
+        if (u.w < mipLevel - float(mip))
+            mip = min(mip + 1, mipCount - 1);
+
+        const int2 size = int2(max(uint2(width, height) >> mip, 1u));
+        const float2 position = uv * float2(size) - 0.5f;
+        const float2 base = floor(position);
+        const float2 f = position - base;
+
+        float weightX, weightY;
+        int2 texel = int2(base);
+        texel.x += SampleAxis(table, f.x, u.x, weightX);
+        texel.y += SampleAxis(table, f.y, u.y, weightY);
+        texel.x = ApplyAddressMode(texel.x, size.x, addressMode);
+        texel.y = ApplyAddressMode(texel.y, size.y, addressMode);
+
+        return texture.Load(int3(texel, mip)) * (weightX * weightY);
+    }
+
+    float4 LoadLevel(ByteAddressBuffer table, STF_SamplerState stfSamplerState, uint addressMode, Texture2D texture, float2 uv, float mipLevel)
+    {
+        return Load(table, texture, stfSamplerState.GetUniformRandom(), uv, mipLevel, addressMode);
+    }
+
+    float4 LoadGrad(ByteAddressBuffer table, STF_SamplerState stfSamplerState, uint addressMode, Texture2D texture, float2 uv, float2 ddxUV,
+        float2 ddyUV)
+    {
+        uint width, height;
+        texture.GetDimensions(width, height);
+        const float2 size = float2(width, height);
+        const float lod = log2(max(max(length(ddxUV * size), length(ddyUV * size)), 1e-8f));
+        return Load(table, texture, stfSamplerState.GetUniformRandom(), uv, lod, addressMode);
+    }
+}
+
+#endif // STF_FILTER_KERNEL_HLSLI
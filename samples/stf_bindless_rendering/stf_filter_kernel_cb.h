@@ -0,0 +1,36 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_FILTER_KERNEL_CB_H
+#define STF_FILTER_KERNEL_CB_H
+
+// Separable kernels of stf_filter_kernel.hlsli. They are enabled by their own constant, not a filter type: the
+// library never sees them, the sample filters these kernels itself.
+#define STF_FILTER_KERNEL_LANCZOS2 0
+#define STF_FILTER_KERNEL_LANCZOS3 1
+#define STF_FILTER_KERNEL_MITCHELL 2      // Mitchell-Netravali, B = C = 1/3
+#define STF_FILTER_KERNEL_KAISER 3        // Kaiser windowed sinc, radius 3, alpha 4
+#define STF_FILTER_KERNEL_COUNT 4
+
+// The weights of the taps around a sample depend on the fractional texel position f. They are tabulated at
+// STF_FILTER_KERNEL_PHASES + 1 positions f = p / STF_FILTER_KERNEL_PHASES, and a sample picks one of the two
+// tables around f with the probability of a linear interpolation between them.
+#define STF_FILTER_KERNEL_PHASES 32
+#define STF_FILTER_KERNEL_MAX_TAPS 8
+
+// Buffer layout, in uints:
+//  - tap count, first tap offset from the texel below the sample position (an int), kernel, 0
+//  - per phase, STF_FILTER_KERNEL_PHASE_STRIDE uints: the sum of the absolute weights, then per tap the Walker alias
+//    table entry: the probability to keep the tap (a float) and the alias tap | tap negative << 8 | alias negative << 9
+#define STF_FILTER_KERNEL_HEADER 4
+#define STF_FILTER_KERNEL_PHASE_STRIDE (1 + 2 * STF_FILTER_KERNEL_MAX_TAPS)
+#define STF_FILTER_KERNEL_SIZE (STF_FILTER_KERNEL_HEADER + (STF_FILTER_KERNEL_PHASES + 1) * STF_FILTER_KERNEL_PHASE_STRIDE)
+
+#endif // STF_FILTER_KERNEL_CB_H
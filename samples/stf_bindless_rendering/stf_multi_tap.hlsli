@@ -0,0 +1,150 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_MULTI_TAP_HLSLI
+#define STF_MULTI_TAP_HLSLI
+
+#include "../../libraries/RTXTF-Library/STFSamplerState.hlsli"
+#include "stf_filter_kernel.hlsli"
+#include "stf_sigma_lod.hlsli"
+#include "stf_ewa.hlsli"
+
+// Adaptive multi-tap STF: after the first stochastic tap, pixels in high contrast regions take one or three more
+// taps and average them. The contrast is the largest per-channel range of the first taps of the lanes of the quad
+// (lanes 4i to 4i + 3) that sample the same texture, which costs no fetches: 2 taps above the threshold and up to 4
+// above twice the threshold. A threshold of 0 always takes maxTaps taps.
+// The taps use the random numbers of the first tap shifted by a rank-1 lattice of 2 or 4 points, so every random
+// number is stratified into tapCount intervals of the filter CDF, and u and v also into 2x2 quadrants for 4 taps.
+// The first tap keeps its random numbers, and the 2 tap lattice is part of the 4 tap one.
+// Extra taps run in divergent control flow, so they take the single-lane path without a magnification method and
+// without reseeding, through StfFilterKernel for the custom kernels or through StfSigmaLod for wide Gaussians
+// and through StfEwa for EWA minification.
+// StfCpuMultiTap in StfCpuSampler.h is the CPU version.
+namespace StfMultiTap
+{
+    bool IsEnabled(uint maxTaps)
+    {
+        return maxTaps > 1;
+    }
+
+    float GetQuadContrast(float4 value, int textureIndex)
+    {
+        const uint lane = WaveGetLaneIndex();
+        const uint4 activeLanes = WaveActiveBallot(true);
+
+        float4 minValue = value;
+        float4 maxValue = value;
+
+        [unroll]
+        for (uint i = 1; i < 4; i++)
+        {
+            const uint other = lane ^ i;
+            const float4 otherValue = WaveReadLaneAt(value, other);
+            const int otherTexture = WaveReadLaneAt(textureIndex, other);
+            const bool otherActive = ((activeLanes[other / 32] >> (other % 32)) & 1) != 0;
+            if (otherActive && otherTexture == textureIndex)
+            {
+                minValue = min(minValue, otherValue);
+                maxValue = max(maxValue, otherValue);
+            }
+        }
+
+        const float4 range = maxValue - minValue;
+        return max(max(range.x, range.y), max(range.z, range.w));
+    }
+
+    uint GetTapCount(float contrast, uint maxTaps, float threshold)
+    {
+        if (maxTaps < 2 || contrast < threshold)
+            return 1;
+        return maxTaps >= 4 && contrast >= 2.f * threshold ? 4 : 2;
+    }
+
+    // u is [u, v, slice, mip] like STF_SamplerState::GetUniformRandom
+    float4 GetTapRandom(float4 u, uint tap, uint tapCount)
+    {
+        const float4 generator = tapCount == 4 ? float4(1.f, 3.f, 0.f, 1.f) : float4(1.f, 1.f, 0.f, 1.f);
+        return frac(u + generator * (float(tap) / float(tapCount)));
+    }
+
+    // Prepares a copy of the sampler state of the first tap for the extra taps
+    STF_SamplerState CreateTapState(STF_SamplerState stfSamplerState)
+    {
+        STF_SamplerState tapState = stfSamplerState;
+        tapState.SetMagMethod(STF_MAGNIFICATION_METHOD_NONE);
+        tapState.SetReseedOnSample(false);
+        return tapState;
+    }
+
+    // The functions below take the random numbers u of the first tap and its value, and return the average of all taps
+
+    float4 AddTapsGrad(STF_SamplerState stfSamplerState, float4 u, float4 value, uint maxTaps, float threshold, int textureIndex,
+        ByteAddressBuffer filterKernel, bool filterKernelEnabled, uint filterType, uint addressMode, float sigma, float sigmaLodTarget, bool ewaEnabled,
+        Texture2D texture, SamplerState materialSampler, float2 texCoord, float2 ddxUV, float2 ddyUV, out uint tapCount)
+    {
+        tapCount = GetTapCount(GetQuadContrast(value, textureIndex), maxTaps, threshold);
+
+        STF_SamplerState tapState = CreateTapState(stfSamplerState);
+        float4 sum = value;
+        for (uint tap = 1; tap < tapCount; tap++)
+        {
+            tapState.SetUniformRandom(GetTapRandom(u, tap, tapCount));
+            if (StfSigmaLod::IsEnabled(filterType, sigma, sigmaLodTarget))
+            {
+                sum += StfSigmaLod::SampleGrad(tapState, sigma, sigmaLodTarget, texture, materialSampler, texCoord, ddxUV, ddyUV);
+                continue;
+            }
+            if (StfEwa::IsEnabled(ewaEnabled) && !StfFilterKernel::IsEnabled(filterKernelEnabled))
+            {
+                sum += StfEwa::SampleGrad(tapState, texture, materialSampler, texCoord, ddxUV, ddyUV);
+                continue;
+            }
+#if STF_LOAD
+            if (StfFilterKernel::IsEnabled(filterKernelEnabled))
+                sum += StfFilterKernel::LoadGrad(filterKernel, tapState, addressMode, texture, texCoord, ddxUV, ddyUV);
+            else
+                sum += tapState.Texture2DLoadGrad(texture, texCoord, ddxUV, ddyUV);
+#else
+            sum += tapState.Texture2DSampleGrad(texture, materialSampler, texCoord, ddxUV, ddyUV);
+#endif
+        }
+        return sum / float(tapCount);
+    }
+
+    float4 AddTapsLevel(STF_SamplerState stfSamplerState, float4 u, float4 value, uint maxTaps, float threshold, int textureIndex,
+        ByteAddressBuffer filterKernel, bool filterKernelEnabled, uint filterType, uint addressMode, float sigma, float sigmaLodTarget, Texture2D texture,
+        SamplerState materialSampler, float2 texCoord, float mipLevel, out uint tapCount)
+    {
+        tapCount = GetTapCount(GetQuadContrast(value, textureIndex), maxTaps, threshold);
+
+        STF_SamplerState tapState = CreateTapState(stfSamplerState);
+        float4 sum = value;
+        for (uint tap = 1; tap < tapCount; tap++)
+        {
+            tapState.SetUniformRandom(GetTapRandom(u, tap, tapCount));
+            if (StfSigmaLod::IsEnabled(filterType, sigma, sigmaLodTarget))
+            {
+                sum += StfSigmaLod::SampleLevel(tapState, sigma, sigmaLodTarget, texture, materialSampler, texCoord, mipLevel);
+                continue;
+            }
+#if STF_LOAD
+            if (StfFilterKernel::IsEnabled(filterKernelEnabled))
+                sum += StfFilterKernel::LoadLevel(filterKernel, tapState, addressMode, texture, texCoord, mipLevel);
+            else
+                sum += tapState.Texture2DLoadLevel(texture, texCoord, mipLevel);
+#else
+            sum += tapState.Texture2DSampleLevel(texture, materialSampler, texCoord, mipLevel);
+#endif
+        }
+        return sum / float(tapCount);
+    }
+}
+
+#endif // STF_MULTI_TAP_HLSLI
@@ -0,0 +1,120 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_SHARED_FOOTPRINT_HLSLI
+#define STF_SHARED_FOOTPRINT_HLSLI
+
+#include "../../libraries/RTXTF-Library/STFSamplerState.hlsli"
+
+// Footprint classes remembered per material sample, textures of further sizes compute their own sample positions
+#define STF_SHARED_FOOTPRINT_CLASSES 2
+
+// The textures of a material usually share their texture coordinates and often their size. The STF sample position
+// depends on the texture only through its width, height and mip count, so textures that agree on these form one
+// footprint class: Texture2DGetSamplePos* runs for the first texture of a class and the others Load the same texel,
+// which is what Texture2DLoad* would have loaded for each of them. The sample position is not wrapped or clamped yet,
+// Load applies the address mode the way Texture2DLoad* does.
+// That only holds for the single-lane path: the wave magnification methods filter cooperatively per texture, and
+// reseeding and Decorrelate Textures give every texture its own random numbers, see IsSharedFootprintSupported. StfCpuSharedFootprint is
+// the CPU version.
+struct StfSharedFootprint
+{
+    bool enabled;       // false samples every texture on its own
+    float2 uv;
+    float2 ddxUV;
+    float2 ddyUV;
+    float mipLevel;
+    bool forceMipLevel;
+
+    uint classCount;
+    uint3 classSize[STF_SHARED_FOOTPRINT_CLASSES];      // width, height, mip count
+    float3 classPos[STF_SHARED_FOOTPRINT_CLASSES];
+
+    static StfSharedFootprint CreateGrad(bool enabled, float2 uv, float2 ddxUV, float2 ddyUV)
+    {
+        StfSharedFootprint footprint = (StfSharedFootprint)0;
+        footprint.enabled = enabled;
+        footprint.uv = uv;
+        footprint.ddxUV = ddxUV;
+        footprint.ddyUV = ddyUV;
+        return footprint;
+    }
+
+    static StfSharedFootprint CreateLevel(bool enabled, float2 uv, float mipLevel)
+    {
+        StfSharedFootprint footprint = (StfSharedFootprint)0;
+        footprint.enabled = enabled;
+        footprint.uv = uv;
+        footprint.mipLevel = mipLevel;
+        footprint.forceMipLevel = true;
+        return footprint;
+    }
+
+    static bool IsSharedFootprintSupported(uint magMethod, bool perTextureRandom)
+    {
+        return magMethod == STF_MAGNIFICATION_METHOD_NONE && !perTextureRandom;
+    }
+
+    // Sample positions are texel positions, only the Load path of STF can share them
+    static bool IsSharedFootprintEnabled(bool shareFootprints, uint magMethod, bool perTextureRandom)
+    {
+#if STF_LOAD
+        return shareFootprints && IsSharedFootprintSupported(magMethod, perTextureRandom);
+#else
+        return false;
+#endif
+    }
+
+    // Texel of a sample position on the mip it selects, positions outside the mip wrap or clamp like the CPU sampler
+    static int3 GetTexel(float3 samplePos, uint3 size, uint addressMode)
+    {
+        const int mip = int(samplePos.z);
+        const int2 mipSize = max(int2(size.xy) >> mip, 1);
+        int2 texel = int2(floor(samplePos.xy));
+        if (addressMode == STF_ADDRESS_MODE_CLAMP)
+            texel = clamp(texel, 0, mipSize - 1);
+        else
+            texel = ((texel % mipSize) + mipSize) % mipSize;
+        return int3(texel, mip);
+    }
+
+    float4 Load(inout STF_SamplerState stfSamplerState, Texture2D texture, uint addressMode)
+    {
+        uint width, height, numberOfLevels;
+        texture.GetDimensions(0, width, height, numberOfLevels);
+        const uint3 size = uint3(width, height, numberOfLevels);
+
+        [unroll]
+        for (uint i = 0; i < STF_SHARED_FOOTPRINT_CLASSES; i++)
+        {
+            if (i < classCount && all(classSize[i] == size))
+                return texture.Load(GetTexel(classPos[i], size, addressMode));
+        }
+
+        const float3 samplePos = forceMipLevel
+            ? stfSamplerState.Texture2DGetSamplePosLevel(width, height, numberOfLevels, uv, mipLevel)
+            : stfSamplerState.Texture2DGetSamplePosGrad(width, height, numberOfLevels, uv, ddxUV, ddyUV);
+
+        [unroll]
+        for (uint j = 0; j < STF_SHARED_FOOTPRINT_CLASSES; j++)
+        {
+            if (j == classCount)
+            {
+                classSize[j] = size;
+                classPos[j] = samplePos;
+            }
+        }
+        classCount = min(classCount + 1, STF_SHARED_FOOTPRINT_CLASSES);
+
+        return texture.Load(GetTexel(samplePos, size, addressMode));
+    }
+};
+
+#endif // STF_SHARED_FOOTPRINT_HLSLI
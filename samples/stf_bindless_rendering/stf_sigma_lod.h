@@ -0,0 +1,65 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_SIGMA_LOD_H
+#define STF_SIGMA_LOD_H
+
+#include "../../libraries/RTXTF-Library/STFDefinitions.h"
+
+// Level of detail of wide Gaussian STF filters, shared by the shaders and the CPU sampler.
+// C++ includes this like lighting_cb.h, with donut::math in scope.
+// A Gaussian of sigma texels on the mip of the footprint draws taps up to several sigma away from the sample, which
+// spreads the texels of a wave over the whole kernel and needs many frames to converge. The same kernel is the
+// Gaussian of a smaller sigma on a coarser mip: with texels as unit boxes, a mip k levels up has the variance of the
+// box of its 2^k x 2^k texels, so sigma becomes sqrt((sigma^2 + 1/12) / 4^k - 1/12) in its texels. The level of detail
+// moves up until that is the target sigma, and the taps choose randomly between the two mips around it like
+// stochastic trilinear filtering, each with its own sigma.
+#define STF_SIGMA_LOD_TEXEL_VARIANCE (1.f / 12.f)
+
+#ifdef __cplusplus
+#define STF_SIGMA_LOD_FUNCTION inline
+#else
+#define STF_SIGMA_LOD_FUNCTION
+#endif
+
+// A target sigma of 0 turns it off, sigmas up to the target sample the mip of the footprint as before
+STF_SIGMA_LOD_FUNCTION bool IsStfSigmaLodEnabled(uint filterType, float sigma, float targetSigma)
+{
+    return filterType == STF_FILTER_TYPE_GAUSSIAN && targetSigma > 0.f && sigma > targetSigma;
+}
+
+// Levels from the mip of the footprint to the mip where the kernel has the target sigma
+STF_SIGMA_LOD_FUNCTION float GetStfSigmaLodBias(float sigma, float targetSigma)
+{
+    const float variance = sigma * sigma + STF_SIGMA_LOD_TEXEL_VARIANCE;
+    const float targetVariance = targetSigma * targetSigma + STF_SIGMA_LOD_TEXEL_VARIANCE;
+    return variance > targetVariance ? 0.5f * log2(variance / targetVariance) : 0.f;
+}
+
+// Sigma in texels of a mip mipOffset levels above the level of detail sigma is given for
+STF_SIGMA_LOD_FUNCTION float GetStfSigmaLodMipSigma(float sigma, float mipOffset)
+{
+    const float variance = (sigma * sigma + STF_SIGMA_LOD_TEXEL_VARIANCE) * exp2(-2.f * mipOffset) - STF_SIGMA_LOD_TEXEL_VARIANCE;
+    return variance > 0.f ? sqrt(variance) : 0.f;
+}
+
+// The mip of one tap: mipLevel, within [0, mipCount - 1], moved up by the bias, then the level below or above with
+// the probability of its fractional part like stochastic trilinear filtering, u is the mip random number
+STF_SIGMA_LOD_FUNCTION float SelectStfSigmaLodMip(float mipLevel, float sigma, float targetSigma, float mipCount, float u)
+{
+    const float maxMip = mipCount - 1.f;
+    const float lod = mipLevel + GetStfSigmaLodBias(sigma, targetSigma);
+    if (lod >= maxMip)
+        return maxMip;
+    const float lower = floor(lod);
+    return u < lod - lower ? lower + 1.f : lower;
+}
+
+#endif // STF_SIGMA_LOD_H
@@ -0,0 +1,57 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_SIGMA_LOD_HLSLI
+#define STF_SIGMA_LOD_HLSLI
+
+#include "../../libraries/RTXTF-Library/STFSamplerState.hlsli"
+#include "stf_sigma_lod.h"
+
+// Wide Gaussian filters on a coarser mip, see stf_sigma_lod.h. The mip of the tap is chosen here and passed to the
+// library as an integer level with the sigma of that mip, so the library only draws the Gaussian offset. The level of
+// detail of the gradient variants is isotropic, from the major axis of the footprint like STF_ANISO_LOD_METHOD_NONE,
+// since the kernel is wider than the footprint once it moves up. StfCpuSamplerState::GetTapLevel is the CPU version.
+namespace StfSigmaLod
+{
+    bool IsEnabled(uint filterType, float sigma, float targetSigma)
+    {
+        return IsStfSigmaLodEnabled(filterType, sigma, targetSigma);
+    }
+
+    float4 SampleLevel(inout STF_SamplerState stfSamplerState, float sigma, float targetSigma, Texture2D texture,
+        SamplerState materialSampler, float2 uv, float mipLevel)
+    {
+        uint width, height, mipCount;
+        texture.GetDimensions(0, width, height, mipCount);
+        mipLevel = isnan(mipLevel) ? 0.f : clamp(mipLevel, 0.f, float(mipCount - 1));
+
+        const float mip = SelectStfSigmaLodMip(mipLevel, sigma, targetSigma, float(mipCount), stfSamplerState.GetUniformRandom().w);
+        stfSamplerState.SetSigma(GetStfSigmaLodMipSigma(sigma, mip - mipLevel));
+#if STF_LOAD
+        const float4 value = stfSamplerState.Texture2DLoadLevel(texture, uv, mip);
+#else
+        const float4 value = stfSamplerState.Texture2DSampleLevel(texture, materialSampler, uv, mip);
+#endif
+        stfSamplerState.SetSigma(sigma);
+        return value;
+    }
+
+    float4 SampleGrad(inout STF_SamplerState stfSamplerState, float sigma, float targetSigma, Texture2D texture,
+        SamplerState materialSampler, float2 uv, float2 ddxUV, float2 ddyUV)
+    {
+        uint width, height;
+        texture.GetDimensions(width, height);
+        const float2 size = float2(width, height);
+        const float lod = log2(max(max(length(ddxUV * size), length(ddyUV * size)), 1e-8f));
+        return SampleLevel(stfSamplerState, sigma, targetSigma, texture, materialSampler, uv, lod);
+    }
+}
+
+#endif // STF_SIGMA_LOD_HLSLI
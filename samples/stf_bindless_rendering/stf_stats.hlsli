@@ -0,0 +1,216 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_STATS_HLSLI
+#define STF_STATS_HLSLI
+
+#include "stf_stats_cb.h"
+#include "../../libraries/RTXTF-Library/STFDefinitions.h"
+
+// STF sampling counters of the GPU passes. The library does not report what its magnification methods did, so the
+// counters come from the same model as StfCpuSampleWaveGrad, evaluated with wave intrinsics next to the sample:
+// magnified lanes filter exactly when the union of their bilinear footprints has no more texels than there are
+// lanes to load them, per wave for MIN_MAX and per quad for the 2x2 methods and the V2 retry. Lanes that take one
+// stochastic tap are assumed to fetch the nearest texel of the rounded level of detail.
+// Helper lanes are only seen with [WaveOpsIncludeHelperLanes], and never write the buffer. Lanes that took the
+// constant footprint early-out fetch their one texel and do not take part in the magnification methods. The extra
+// taps of adaptive multi-tap STF are recorded separately by RecordExtraTaps.
+namespace StfStats
+{
+    static const int c_MaxInt = 0x7fffffff;
+
+    bool IsWaveMagMethod(uint magMethod)
+    {
+        return magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX || magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX_HELPER ||
+            magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX_V2 || magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX_V2_HELPER;
+    }
+
+    bool IsQuadMagMethod(uint magMethod)
+    {
+        return magMethod == STF_MAGNIFICATION_METHOD_2x2_QUAD || magMethod == STF_MAGNIFICATION_METHOD_2x2_FINE ||
+            magMethod == STF_MAGNIFICATION_METHOD_2x2_FINE_TEMPORAL;
+    }
+
+    // log2 of the larger footprint axis in texels of the base level, GetIsotropicLod of the CPU sampler
+    float GetIsotropicLod(Texture2D texture, float2 ddx, float2 ddy)
+    {
+        uint width, height;
+        texture.GetDimensions(width, height);
+        const float2 size = float2(width, height);
+        return log2(max(max(length(ddx * size), length(ddy * size)), 1e-8f));
+    }
+
+    // Texels of the union of the footprints of the active lanes where included is set, as a float to not overflow
+    float GetFootprintUnion(int2 base, bool included)
+    {
+        const int2 minBase = WaveActiveMin(included ? base : int2(c_MaxInt, c_MaxInt));
+        const int2 maxBase = WaveActiveMax(included ? base : int2(-c_MaxInt, -c_MaxInt));
+        return float(maxBase.x - minBase.x + 2) * float(maxBase.y - minBase.y + 2);
+    }
+
+    // All active lanes sample the same texture
+    void RecordGroup(RWByteAddressBuffer buffer, uint textureIndex, Texture2D texture, float2 texCoord, float lod, bool stfEnabled, uint magMethod,
+        bool constantFootprint)
+    {
+        if (!WaveActiveAnyTrue(stfEnabled))
+            return;
+
+        bool helper = false;
+#if ALLOW_HELPER_LANES
+        helper = IsHelperLane();
+#endif
+
+        uint width, height, mipCount;
+        texture.GetDimensions(0, width, height, mipCount);
+
+        const bool helperVariant = magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX_HELPER || magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX_V2_HELPER;
+        const bool quadRetry = magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX_V2 || magMethod == STF_MAGNIFICATION_METHOD_MIN_MAX_V2_HELPER;
+
+        const bool constant = stfEnabled && constantFootprint;
+        const bool magnified = stfEnabled && !constant && lod <= 0.f;
+        const int2 base = int2(floor(texCoord * float2(width, height) - 0.5f));
+        const uint loaderCount = WaveActiveCountBits(!constant);
+
+        // Cooperative loads, the totals are uniform
+        bool waveFiltered = false;
+        bool quadFiltered = false;
+        float sharedTexels = 0.f;
+        uint sharingLanes = 0;
+
+        const bool footprint = magnified && !(helper && helperVariant);
+        if (IsWaveMagMethod(magMethod) && WaveActiveAnyTrue(footprint))
+        {
+            const float area = GetFootprintUnion(base, footprint);
+            if (area <= float(loaderCount))
+            {
+                waveFiltered = footprint;
+                sharedTexels += area;
+                sharingLanes += loaderCount;
+            }
+        }
+
+        const bool quadMethod = IsQuadMagMethod(magMethod);
+        if (quadMethod || (quadRetry && !WaveActiveAnyTrue(waveFiltered)))
+        {
+            const bool quadFootprint = quadMethod ? magnified : footprint;
+            const uint laneQuad = WaveGetLaneIndex() / 4;
+
+            for (uint quad = 0; quad < WaveGetLaneCount() / 4; quad++)
+            {
+                const bool inQuad = laneQuad == quad;
+                if (!WaveActiveAnyTrue(inQuad && quadFootprint))
+                    continue;
+
+                const float area = GetFootprintUnion(base, inQuad && quadFootprint);
+                const uint quadLoaders = WaveActiveCountBits(inQuad && !constant);
+                if (area <= float(quadLoaders))
+                {
+                    if (inQuad && quadFootprint)
+                        quadFiltered = true;
+                    sharedTexels += area;
+                    sharingLanes += quadLoaders;
+                }
+            }
+        }
+
+        // Distinct taps: peel off one texel per iteration, the texels of the cooperative loads count once
+        const bool tap = stfEnabled && !waveFiltered && !quadFiltered;
+        const uint mip = uint(clamp(round(lod), 0.f, float(mipCount - 1)));
+        const uint2 mipSize = max(uint2(width, height) >> mip, 1u);
+        const uint2 texel = uint2(frac(texCoord) * float2(mipSize)) % mipSize;
+        const uint key = (mip << 28) | ((texel.y & 0x3fff) << 14) | (texel.x & 0x3fff);
+
+        uint distinctTaps = 0;
+        bool pending = tap;
+        [loop]
+        while (WaveActiveAnyTrue(pending))
+        {
+            if (pending)
+                pending = key != WaveReadLaneFirst(key);
+            distinctTaps++;
+        }
+
+        const bool counted = stfEnabled && !helper;
+        const uint samples = WaveActiveCountBits(counted);
+        const uint magnifiedSamples = WaveActiveCountBits(counted && magnified);
+        const uint waveFilteredSamples = WaveActiveCountBits(counted && waveFiltered);
+        const uint quadFilteredSamples = WaveActiveCountBits(counted && quadFiltered);
+        const uint fallbackSamples = WaveActiveCountBits(counted && magnified && !waveFiltered && !quadFiltered);
+        const uint taps = WaveActiveCountBits(tap);
+        const uint constantSamples = WaveActiveCountBits(counted && constant);
+
+        // Helper lanes cannot write memory
+        if (helper || WavePrefixCountBits(!helper) != 0)
+            return;
+
+        const uint address = min(textureIndex, STF_STATS_MAX_TEXTURES - 1) * STF_STATS_COUNTER_COUNT * 4;
+        buffer.InterlockedAdd(address + STF_STATS_SAMPLES * 4, samples);
+        buffer.InterlockedAdd(address + STF_STATS_MAGNIFIED_SAMPLES * 4, magnifiedSamples);
+        buffer.InterlockedAdd(address + STF_STATS_WAVE_FILTERED_SAMPLES * 4, waveFilteredSamples);
+        buffer.InterlockedAdd(address + STF_STATS_QUAD_FILTERED_SAMPLES * 4, quadFilteredSamples);
+        buffer.InterlockedAdd(address + STF_STATS_FALLBACK_SAMPLES * 4, fallbackSamples);
+        buffer.InterlockedAdd(address + STF_STATS_TEXELS_FETCHED * 4, uint(sharedTexels) + taps);
+        buffer.InterlockedAdd(address + STF_STATS_SHARING_LANES * 4, sharingLanes);
+        buffer.InterlockedAdd(address + STF_STATS_WAVES * 4, 1);
+        buffer.InterlockedAdd(address + STF_STATS_DISTINCT_TEXELS * 4, uint(sharedTexels) + distinctTaps);
+        buffer.InterlockedAdd(address + STF_STATS_CONSTANT_SAMPLES * 4, constantSamples);
+    }
+
+    // Call next to the sample with the bindless descriptor index of the texture. Lanes of a wave sampling different
+    // textures are recorded in separate groups, like the separate waves they would be in a draw per texture.
+    // constantFootprint is set for the lanes that take the early-out of stf_constant_footprint.hlsli.
+    void Record(RWByteAddressBuffer buffer, int textureIndex, Texture2D texture, float2 texCoord, float lod, bool stfEnabled, uint magMethod,
+        bool constantFootprint)
+    {
+        if (textureIndex < 0)
+            return;
+
+        [loop]
+        while (true)
+        {
+            if (WaveReadLaneFirst(textureIndex) == textureIndex)
+            {
+                RecordGroup(buffer, uint(textureIndex), texture, texCoord, lod, stfEnabled, magMethod, constantFootprint);
+                break;
+            }
+        }
+    }
+
+    // Extra taps of stf_multi_tap.hlsli, each one a single-lane fetch on top of the taps counted by Record
+    void RecordExtraTaps(RWByteAddressBuffer buffer, int textureIndex, uint extraTaps)
+    {
+        if (textureIndex < 0)
+            return;
+
+        bool helper = false;
+#if ALLOW_HELPER_LANES
+        helper = IsHelperLane();
+#endif
+
+        [loop]
+        while (true)
+        {
+            if (WaveReadLaneFirst(textureIndex) == textureIndex)
+            {
+                // Helper lanes fetch their taps too, like the taps of Record
+                const uint taps = WaveActiveSum(extraTaps);
+                if (!helper && WavePrefixCountBits(!helper) == 0)
+                {
+                    const uint address = min(uint(textureIndex), STF_STATS_MAX_TEXTURES - 1) * STF_STATS_COUNTER_COUNT * 4;
+                    buffer.InterlockedAdd(address + STF_STATS_TEXELS_FETCHED * 4, taps);
+                    buffer.InterlockedAdd(address + STF_STATS_EXTRA_TAPS * 4, taps);
+                }
+                break;
+            }
+        }
+    }
+}
+
+#endif // STF_STATS_HLSLI
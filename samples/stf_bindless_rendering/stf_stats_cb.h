@@ -0,0 +1,31 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_STATS_CB_H
+#define STF_STATS_CB_H
+
+// Layout of the STF sampling stats buffer: STF_STATS_COUNTER_COUNT uints per bindless texture descriptor,
+// in the order of StfSamplingCounters. Descriptors past the end share the last entry.
+#define STF_STATS_MAX_TEXTURES 1024
+
+#define STF_STATS_SAMPLES 0
+#define STF_STATS_MAGNIFIED_SAMPLES 1
+#define STF_STATS_WAVE_FILTERED_SAMPLES 2
+#define STF_STATS_QUAD_FILTERED_SAMPLES 3
+#define STF_STATS_FALLBACK_SAMPLES 4
+#define STF_STATS_TEXELS_FETCHED 5
+#define STF_STATS_SHARING_LANES 6
+#define STF_STATS_WAVES 7
+#define STF_STATS_DISTINCT_TEXELS 8
+#define STF_STATS_CONSTANT_SAMPLES 9
+#define STF_STATS_EXTRA_TAPS 10
+#define STF_STATS_COUNTER_COUNT 11
+
+#endif // STF_STATS_CB_H
@@ -0,0 +1,90 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_TEMPORAL_STRATA_H
+#define STF_TEMPORAL_STRATA_H
+
+// N-frame temporal stratification of the STF random numbers, shared by the shaders and the CPU sampler.
+// C++ includes this like lighting_cb.h, with donut::math in scope.
+// Every frame normally draws the noise of its own frame index, so the taps a pixel accumulates over frames are only
+// as well spread as the temporal slices of the blue noise. With N strata, the frames of a cycle of N frame indices
+// reuse the noise of the first frame of the cycle, shifted by point frameIndex mod N of the rank-1 lattice
+// (k, g k, g^2 k) / N mod 1. With g coprime to N, the lattice puts one point into each of N equal intervals of every
+// random number, so over a cycle the taps of a pixel cover the filter CDF of both axes and the mip choice in N strata,
+// like the N taps of multi-tap STF spread over N frames. 2x2_FINE_TEMPORAL alternates between 2 patterns in the same
+// way. The noise of the pixel rotates the lattice, which keeps the spatial blue noise within a frame and makes every
+// frame unbiased on its own. The shift only depends on the frame index of STF_SamplerState::SetFrameIndex and the
+// pixel, not on how the temporal filter reprojects.
+#define STF_TEMPORAL_STRATA_MAX 16
+
+#ifdef __cplusplus
+#define STF_TEMPORAL_STRATA_FUNCTION inline
+#else
+#define STF_TEMPORAL_STRATA_FUNCTION
+#endif
+
+// The frame index of the noise of the cycle
+STF_TEMPORAL_STRATA_FUNCTION uint GetStfTemporalStrataFrame(uint frameIndex, uint strata)
+{
+    return strata > 1 ? frameIndex - frameIndex % strata : frameIndex;
+}
+
+// The noise of GetStfTemporalStrataFrame shifted to the stratum of the frame, in [0, 1)
+STF_TEMPORAL_STRATA_FUNCTION float3 StratifyStfRandom(float3 u, uint frameIndex, uint strata, uint generator)
+{
+    if (strata <= 1)
+        return u;
+
+    const uint k = frameIndex % strata;
+    const uint y = (k * generator) % strata;
+    const uint w = (y * generator) % strata;
+    const float3 shifted = u + float3(float(k), float(y), float(w)) / float(strata);
+    return shifted - float3(floor(shifted.x), floor(shifted.y), floor(shifted.z));
+}
+
+#ifdef __cplusplus
+// The generator g of N strata whose first two dimensions keep their points furthest apart on the torus
+inline uint32_t GetStfTemporalStrataGenerator(uint32_t strata)
+{
+    uint32_t best = 1;
+    uint32_t bestDistance = 0;
+    for (uint32_t g = 1; g < strata; g++)
+    {
+        uint32_t a = strata;
+        uint32_t b = g;
+        while (b != 0)
+        {
+            const uint32_t r = a % b;
+            a = b;
+            b = r;
+        }
+        if (a != 1)
+            continue;
+
+        // Squared distance in units of 1 / N to the nearest other point, the lattice looks the same from every point
+        uint32_t distance = ~0u;
+        for (uint32_t k = 1; k < strata; k++)
+        {
+            const uint32_t x = k < strata - k ? k : strata - k;
+            const uint32_t yk = (k * g) % strata;
+            const uint32_t y = yk < strata - yk ? yk : strata - yk;
+            distance = x * x + y * y < distance ? x * x + y * y : distance;
+        }
+        if (distance > bestDistance)
+        {
+            best = g;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+#endif
+
+#endif // STF_TEMPORAL_STRATA_H
@@ -0,0 +1,201 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#ifndef STF_TEXTURE_SAMPLING_HLSLI
+#define STF_TEXTURE_SAMPLING_HLSLI
+
+// One texture sample of the sample, with STF and every optional path of it, shared by the raster and the ray
+// tracing / compute shaders. The including file declares g_Const (LightingConstants), u_StfStats,
+// t_StfConstantFootprints and t_StfFilterKernel, and defines STF_ENABLED and STF_LOAD.
+
+#include "../../libraries/RTXTF-Library/STFSamplerState.hlsli"
+#include "stf_stats.hlsli"
+#include "stf_shared_footprint.hlsli"
+#include "stf_constant_footprint.hlsli"
+#include "stf_decorrelation.h"
+#include "stf_multi_tap.hlsli"
+#include "stf_filter_kernel.hlsli"
+#include "stf_sigma_lod.hlsli"
+#include "stf_ewa.hlsli"
+
+#define STF_TEXTURE_LOD_IMPLICIT 0  // Sample: pixel shader derivatives, which the caller also passes as gradients
+#define STF_TEXTURE_LOD_LEVEL 1     // SampleLevel
+#define STF_TEXTURE_LOD_GRAD 2      // SampleGrad
+
+// How the mip level of a sample is chosen. Every call site passes a constant mode, so the branches on it compile away.
+struct StfTextureLod
+{
+    uint mode;
+    float mipLevel;
+    float2 texGrad_x;
+    float2 texGrad_y;
+
+    static StfTextureLod CreateImplicit(float2 texGrad_x, float2 texGrad_y)
+    {
+        StfTextureLod lod = (StfTextureLod)0;
+        lod.mode = STF_TEXTURE_LOD_IMPLICIT;
+        lod.texGrad_x = texGrad_x;
+        lod.texGrad_y = texGrad_y;
+        return lod;
+    }
+
+    static StfTextureLod CreateLevel(float mipLevel)
+    {
+        StfTextureLod lod = (StfTextureLod)0;
+        lod.mode = STF_TEXTURE_LOD_LEVEL;
+        lod.mipLevel = mipLevel;
+        return lod;
+    }
+
+    static StfTextureLod CreateGrad(float2 texGrad_x, float2 texGrad_y)
+    {
+        StfTextureLod lod = (StfTextureLod)0;
+        lod.mode = STF_TEXTURE_LOD_GRAD;
+        lod.texGrad_x = texGrad_x;
+        lod.texGrad_y = texGrad_y;
+        return lod;
+    }
+
+    bool IsLevel()
+    {
+        return mode == STF_TEXTURE_LOD_LEVEL;
+    }
+};
+
+StfConstantFootprint::Filter GetConstantFootprintFilter()
+{
+    return StfConstantFootprint::CreateFilter(g_Const.stfFilterMode, g_Const.stfAddressMode, g_Const.stfSigma, g_Const.stfMinificationMethod,
+        g_Const.stfEwaEnabled != 0);
+}
+
+STF_SamplerState CreateSTF(float3 u)
+{
+    STF_SamplerState stfSamplerState = STF_SamplerState::Create(float4(u.x, u.y, 0 /*slice - unused*/, u.z));
+    stfSamplerState.SetFilterType(g_Const.stfFilterMode);
+    stfSamplerState.SetFrameIndex(g_Const.stfFrameIndex);
+    stfSamplerState.SetMagMethod(g_Const.stfMagnificationMethod);
+    stfSamplerState.SetFallbackMethod(g_Const.stfFallbackMethod);
+    stfSamplerState.SetAddressingModes(g_Const.stfAddressMode.xxx);
+    stfSamplerState.SetSigma(g_Const.stfSigma);
+    stfSamplerState.SetAnisoMethod(g_Const.stfMinificationMethod);
+    stfSamplerState.SetReseedOnSample(g_Const.stfReseedOnSample);
+    stfSamplerState.SetDebugFailure(g_Const.stfDebugOnFailure);
+    return stfSamplerState;
+}
+
+// With Decorrelate Textures, every texture slot samples with its own rotation of the random numbers of the pixel
+void DecorrelateSTF(inout STF_SamplerState stfSamplerState, float3 u, uint textureSlot)
+{
+    if (g_Const.stfDecorrelateTextures)
+        stfSamplerState = CreateSTF(DecorrelateStfRandom(u, textureSlot));
+}
+
+// The single STF tap: a shared footprint, the custom filter kernel, the sigma LOD of wide Gaussians, EWA, or the
+// library. EWA needs gradients, explicit mip levels sample without it.
+float4 SampleStfTap(inout STF_SamplerState stfSamplerState, inout StfSharedFootprint footprint, Texture2D texture,
+    SamplerState materialSampler, float2 texCoord, StfTextureLod lod)
+{
+#if STF_LOAD
+    if (footprint.enabled)
+        return footprint.Load(stfSamplerState, texture, g_Const.stfAddressMode);
+
+    if (StfFilterKernel::IsEnabled(g_Const.stfFilterKernelEnabled != 0))
+    {
+        if (lod.IsLevel())
+            return StfFilterKernel::LoadLevel(t_StfFilterKernel, stfSamplerState, g_Const.stfAddressMode, texture, texCoord, lod.mipLevel);
+        return StfFilterKernel::LoadGrad(t_StfFilterKernel, stfSamplerState, g_Const.stfAddressMode, texture, texCoord, lod.texGrad_x, lod.texGrad_y);
+    }
+#endif
+
+    if (StfSigmaLod::IsEnabled(g_Const.stfFilterMode, g_Const.stfSigma, g_Const.stfSigmaLodTarget))
+    {
+        if (lod.IsLevel())
+            return StfSigmaLod::SampleLevel(stfSamplerState, g_Const.stfSigma, g_Const.stfSigmaLodTarget, texture, materialSampler, texCoord, lod.mipLevel);
+        return StfSigmaLod::SampleGrad(stfSamplerState, g_Const.stfSigma, g_Const.stfSigmaLodTarget, texture, materialSampler, texCoord, lod.texGrad_x, lod.texGrad_y);
+    }
+
+    if (!lod.IsLevel() && StfEwa::IsEnabled(g_Const.stfEwaEnabled != 0))
+        return StfEwa::SampleGrad(stfSamplerState, texture, materialSampler, texCoord, lod.texGrad_x, lod.texGrad_y);
+
+#if STF_LOAD
+    if (lod.mode == STF_TEXTURE_LOD_IMPLICIT)
+        return stfSamplerState.Texture2DLoad(texture, texCoord);
+    if (lod.IsLevel())
+        return stfSamplerState.Texture2DLoadLevel(texture, texCoord, lod.mipLevel);
+    return stfSamplerState.Texture2DLoadGrad(texture, texCoord, lod.texGrad_x, lod.texGrad_y);
+#else
+    if (lod.mode == STF_TEXTURE_LOD_IMPLICIT)
+        return stfSamplerState.Texture2DSample(texture, materialSampler, texCoord);
+    if (lod.IsLevel())
+        return stfSamplerState.Texture2DSampleLevel(texture, materialSampler, texCoord, lod.mipLevel);
+    return stfSamplerState.Texture2DSampleGrad(texture, materialSampler, texCoord, lod.texGrad_x, lod.texGrad_y);
+#endif
+}
+
+// textureIndex is the bindless descriptor of the texture, it identifies the texture in the STF sampling stats and
+// its constant blocks. Without STF, or with stfEnabled false, the hardware sampler filters.
+float4 SampleStfTexture(inout STF_SamplerState stfSamplerState, inout StfSharedFootprint footprint, bool stfEnabled, Texture2D texture,
+    int textureIndex, SamplerState materialSampler, float2 texCoord, StfTextureLod lod)
+{
+#if STF_ENABLED
+    int3 constantTexel;
+    bool constantFootprint = false;
+    if (stfEnabled && StfConstantFootprint::IsEnabled(g_Const.stfConstantFootprints != 0))
+    {
+        if (lod.IsLevel())
+            constantFootprint = StfConstantFootprint::FindTexelLevel(t_StfConstantFootprints, textureIndex, texture, GetConstantFootprintFilter(), texCoord, lod.mipLevel, constantTexel);
+        else
+            constantFootprint = StfConstantFootprint::FindTexelGrad(t_StfConstantFootprints, textureIndex, texture, GetConstantFootprintFilter(), texCoord, lod.texGrad_x, lod.texGrad_y, constantTexel);
+    }
+
+    if (g_Const.stfCollectStats)
+    {
+        const float statsLod = lod.IsLevel() ? lod.mipLevel : StfStats::GetIsotropicLod(texture, lod.texGrad_x, lod.texGrad_y);
+        StfStats::Record(u_StfStats, textureIndex, texture, texCoord, statsLod, stfEnabled, g_Const.stfMagnificationMethod, constantFootprint);
+    }
+
+    if (constantFootprint)
+        return texture.Load(constantTexel);
+
+    if (stfEnabled)
+    {
+        const float4 u = stfSamplerState.GetUniformRandom();
+        float4 value = SampleStfTap(stfSamplerState, footprint, texture, materialSampler, texCoord, lod);
+
+        if (StfMultiTap::IsEnabled(g_Const.stfMaxTaps))
+        {
+            uint tapCount;
+            if (lod.IsLevel())
+            {
+                value = StfMultiTap::AddTapsLevel(stfSamplerState, u, value, g_Const.stfMaxTaps, g_Const.stfTapContrast, textureIndex,
+                    t_StfFilterKernel, g_Const.stfFilterKernelEnabled != 0, g_Const.stfFilterMode, g_Const.stfAddressMode, g_Const.stfSigma, g_Const.stfSigmaLodTarget,
+                    texture, materialSampler, texCoord, lod.mipLevel, tapCount);
+            }
+            else
+            {
+                value = StfMultiTap::AddTapsGrad(stfSamplerState, u, value, g_Const.stfMaxTaps, g_Const.stfTapContrast, textureIndex,
+                    t_StfFilterKernel, g_Const.stfFilterKernelEnabled != 0, g_Const.stfFilterMode, g_Const.stfAddressMode, g_Const.stfSigma, g_Const.stfSigmaLodTarget,
+                    g_Const.stfEwaEnabled != 0, texture, materialSampler, texCoord, lod.texGrad_x, lod.texGrad_y, tapCount);
+            }
+            if (g_Const.stfCollectStats)
+                StfStats::RecordExtraTaps(u_StfStats, textureIndex, tapCount - 1);
+        }
+        return value;
+    }
+#endif
+
+    if (lod.mode == STF_TEXTURE_LOD_IMPLICIT)
+        return texture.Sample(materialSampler, texCoord);
+    if (lod.IsLevel())
+        return texture.SampleLevel(materialSampler, texCoord, lod.mipLevel);
+    return texture.SampleGrad(materialSampler, texCoord, lod.texGrad_x, lod.texGrad_y);
+}
+
+#endif // STF_TEXTURE_SAMPLING_HLSLI
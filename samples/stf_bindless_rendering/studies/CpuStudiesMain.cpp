@@ -0,0 +1,234 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+// The CPU renders, benchmarks and studies of the sample. None of them needs a window or a graphics device, so they
+// run from this console executable instead of the sample's main.
+
+#include "../CpuStudies.h"
+#include "../SceneLoader.h"
+#include "../SweepConfig.h"
+
+#include <donut/app/ApplicationBase.h>
+#include <donut/core/log.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using namespace donut;
+
+int main(int argc, const char** argv)
+{
+    bool loadBenchmark = false;
+    std::filesystem::path texelTraceReplayFileName;
+    CpuRenderSettings settings;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-loadBenchmark") == 0)
+        {
+            loadBenchmark = true;
+        }
+        else if (strcmp(argv[i], "-cpuRender") == 0 && i + 1 < argc)
+        {
+            settings.outputFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-cpuFrames") == 0 && i + 1 < argc)
+        {
+            settings.frameCount = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (strcmp(argv[i], "-gradientBenchmark") == 0)
+        {
+            settings.gradientBenchmark = true;
+        }
+        else if (strcmp(argv[i], "-materialBenchmark") == 0)
+        {
+            settings.materialBenchmark = true;
+        }
+        else if (strcmp(argv[i], "-sigmaLodBenchmark") == 0)
+        {
+            settings.sigmaLodBenchmark = true;
+        }
+        else if (strcmp(argv[i], "-anisoStudy") == 0)
+        {
+            settings.anisoStudy = true;
+        }
+        else if (strcmp(argv[i], "-cpuSigmaLodTarget") == 0 && i + 1 < argc)
+        {
+            settings.ui.stfSigmaLodTarget = float(std::atof(argv[++i]));
+            settings.ui.stfSigmaLod = settings.ui.stfSigmaLodTarget > 0.f;
+        }
+        else if (strcmp(argv[i], "-decorrelationStudy") == 0)
+        {
+            settings.decorrelationStudy = true;
+        }
+        else if (strcmp(argv[i], "-temporalStrataStudy") == 0)
+        {
+            settings.temporalStrataStudy = true;
+        }
+        else if (strcmp(argv[i], "-multiTapStudy") == 0)
+        {
+            settings.multiTapStudy = true;
+        }
+        else if (strcmp(argv[i], "-shadingCacheStudy") == 0)
+        {
+            settings.shadingCacheStudy = true;
+        }
+        else if (strcmp(argv[i], "-deferredTexelStudy") == 0)
+        {
+            settings.deferredTexelStudy = true;
+        }
+        else if (strcmp(argv[i], "-cpuRaster") == 0)
+        {
+            settings.raster = true;
+        }
+        else if (strcmp(argv[i], "-cpuMagMethod") == 0 && i + 1 < argc)
+        {
+            const char* name = argv[++i];
+            const std::vector<const char*>& names = GetSweepFields()[FindSweepField("magMethod")].enumNames;
+            auto it = std::find_if(names.begin(), names.end(), [name](const char* n) { return strcmp(n, name) == 0; });
+            if (it == names.end())
+            {
+                log::error("Unknown magnification method '%s'", name);
+                return 1;
+            }
+            settings.ui.stfMagnificationMethod = StfMagMethod(it - names.begin());
+        }
+        else if (strcmp(argv[i], "-cpuMaxTaps") == 0 && i + 1 < argc)
+        {
+            settings.ui.stfMaxTaps = std::clamp(std::atoi(argv[++i]), 1, 4);
+        }
+        else if (strcmp(argv[i], "-cpuTapContrast") == 0 && i + 1 < argc)
+        {
+            settings.ui.stfTapContrast = std::max(float(std::atof(argv[++i])), 0.f);
+        }
+        else if (strcmp(argv[i], "-cpuHelperLanes") == 0)
+        {
+            settings.ui.allowHelperLanesInWaveIntrinsics = true;
+            settings.rasterizerOptions.includeHelperLanes = true;
+        }
+        else if (strcmp(argv[i], "-cpuWaveWidth") == 0 && i + 1 < argc)
+        {
+            const int waveWidth = std::atoi(argv[++i]);
+            if (waveWidth < 4 || waveWidth > 128 || waveWidth % 4 != 0)
+            {
+                log::error("The wave width must be a multiple of 4 between 4 and 128");
+                return 1;
+            }
+            settings.rasterizerOptions.waveWidth = uint32_t(waveWidth);
+        }
+        else if (strcmp(argv[i], "-cpuWavePacking") == 0 && i + 1 < argc)
+        {
+            const char* packing = argv[++i];
+            settings.rasterizerOptions.wavePacking = strcmp(packing, "triangle") == 0 ? CpuWavePacking::Triangle : CpuWavePacking::Draw;
+        }
+        else if (strcmp(argv[i], "-cpuHeatmap") == 0 && i + 1 < argc)
+        {
+            settings.heatmapFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-cpuSpectrum") == 0 && i + 1 < argc)
+        {
+            settings.spectrumFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-cpuCacheSim") == 0 && i + 1 < argc)
+        {
+            settings.cacheReportFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-cpuTexelTrace") == 0 && i + 1 < argc)
+        {
+            settings.texelTraceFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-cpuAutotune") == 0)
+        {
+            settings.dispatchAutotune = true;
+        }
+        else if (strcmp(argv[i], "-dispatchTuning") == 0 && i + 1 < argc)
+        {
+            settings.dispatchTuningFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-bakeOmm") == 0 && i + 1 < argc)
+        {
+            settings.ommBakeFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-ommLevel") == 0 && i + 1 < argc)
+        {
+            settings.ommBakeSettings.maxSubdivisionLevel = uint32_t(std::clamp(std::atoi(argv[++i]), 0, 12));
+        }
+        else if (strcmp(argv[i], "-ommFormat") == 0 && i + 1 < argc)
+        {
+            settings.ommBakeSettings.format = std::atoi(argv[++i]) == 2 ? OmmFormat::TwoState : OmmFormat::FourState;
+        }
+        else if (strcmp(argv[i], "-omm") == 0 && i + 1 < argc)
+        {
+            settings.ommFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-cacheReplay") == 0 && i + 1 < argc)
+        {
+            texelTraceReplayFileName = argv[++i];
+        }
+        else if ((strcmp(argv[i], "-cacheL1") == 0 || strcmp(argv[i], "-cacheL2") == 0) && i + 1 < argc)
+        {
+            // <size in KB>,<ways>
+            CacheLevelDesc& level = strcmp(argv[i], "-cacheL1") == 0 ? settings.cacheConfig.l1 : settings.cacheConfig.l2;
+            unsigned sizeKB = 0, ways = 0;
+            if (std::sscanf(argv[++i], "%u,%u", &sizeKB, &ways) == 2 && sizeKB != 0 && ways != 0)
+            {
+                level.sizeBytes = sizeKB * 1024;
+                level.ways = ways;
+            }
+        }
+        else if (strcmp(argv[i], "-cacheSMs") == 0 && i + 1 < argc)
+        {
+            settings.cacheConfig.l1Count = uint32_t(std::max(std::atoi(argv[++i]), 1));
+        }
+        else if (strcmp(argv[i], "-stfStats") == 0 && i + 1 < argc)
+        {
+            settings.samplingStatsFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-cpuTaa") == 0)
+        {
+            settings.temporalResolve = true;
+        }
+        else if (strcmp(argv[i], "-cpuTaaClamp") == 0 && i + 1 < argc)
+        {
+            const char* clamp = argv[++i];
+            settings.temporalParameters.clamp = strcmp(clamp, "none") == 0 ? CpuTemporalClamp::None
+                : strcmp(clamp, "variance") == 0 ? CpuTemporalClamp::Variance
+                : CpuTemporalClamp::MinMax;
+        }
+        else
+        {
+            log::error("Unknown argument '%s'", argv[i]);
+            return 1;
+        }
+    }
+
+    if (settings.dispatchTuningFileName.empty())
+        settings.dispatchTuningFileName = app::GetDirectoryWithExecutable() / "dispatch_tuning.json";
+
+    if (loadBenchmark)
+    {
+        const std::filesystem::path sceneFileName = app::GetDirectoryWithExecutable().parent_path() / "assets/media/sponza-plus.scene.json";
+        RunSceneLoadBenchmark(sceneFileName, { 1, std::max(std::thread::hardware_concurrency(), 1u) });
+        return 0;
+    }
+
+    if (!texelTraceReplayFileName.empty())
+        return ReplayTexelTrace(texelTraceReplayFileName, settings.cacheConfig) ? 0 : 1;
+
+    if (!settings.IsRequested())
+    {
+        log::error("Nothing to do: pass -cpuRender <file.pfm>, a benchmark or study, -cacheReplay, -bakeOmm or -loadBenchmark");
+        return 1;
+    }
+
+    return RunCpuRender(settings) ? 0 : 1;
+}
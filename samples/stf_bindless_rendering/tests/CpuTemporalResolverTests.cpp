@@ -0,0 +1,172 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../CpuTemporalResolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace donut::math;
+
+// More than one tile in both directions, with partial tiles at the right and bottom
+static const uint32_t Width = 130;
+static const uint32_t Height = 70;
+
+static bool IsUniform(const std::vector<float4>& pixels, float value, float tolerance)
+{
+    for (const float4& pixel : pixels)
+    {
+        if (std::abs(pixel.x - value) > tolerance || std::abs(pixel.w - value) > tolerance)
+            return false;
+    }
+    return true;
+}
+
+UNIT_TEST(CpuTemporalResolver, HaltonOffsets)
+{
+    // 16 distinct offsets inside the pixel, the first one from index 1 of the sequence, repeating after 16 frames
+    std::set<std::pair<float, float>> offsets;
+    float2 sum = 0.f;
+    for (uint32_t frame = 0; frame < 16; frame++)
+    {
+        const float2 offset = GetHaltonPixelOffset(frame);
+        CHECK(offset.x >= -0.5f && offset.x < 0.5f && offset.y >= -0.5f && offset.y < 0.5f);
+        CHECK(all(offset == GetHaltonPixelOffset(frame + 16)));
+        offsets.insert({ offset.x, offset.y });
+        sum += offset;
+    }
+    CHECK(offsets.size() == 16);
+    CHECK(std::abs(GetHaltonPixelOffset(0).x) < 1e-6f && std::abs(GetHaltonPixelOffset(0).y + 1.f / 6.f) < 1e-6f);
+
+    // Close to centered, so the accumulated image is not shifted
+    CHECK(std::abs(sum.x / 16.f) < 0.05f && std::abs(sum.y / 16.f) < 0.05f);
+}
+
+UNIT_TEST(CpuTemporalResolver, ExponentialBlend)
+{
+    ThreadPool pool(4);
+    CpuTemporalResolver resolver(pool);
+    CpuTemporalResolveParameters params;
+    params.clamp = CpuTemporalClamp::None;
+
+    // The first frame has no history and is output as is
+    std::vector<float4> color(Width * Height, float4(1.f));
+    resolver.Resolve(Width, Height, color.data(), nullptr, params);
+    CHECK(resolver.GetOutput().size() == Width * Height);
+    CHECK(IsUniform(resolver.GetOutput(), 1.f, 0.f));
+
+    // Then the history decays by 1 - newFrameWeight per frame
+    std::fill(color.begin(), color.end(), float4(0.f));
+    for (uint32_t frame = 1; frame <= 8; frame++)
+    {
+        resolver.Resolve(Width, Height, color.data(), nullptr, params);
+        CHECK(IsUniform(resolver.GetOutput(), std::pow(0.9f, float(frame)), 1e-5f));
+    }
+
+    // Reset and a new size both drop the history
+    std::fill(color.begin(), color.end(), float4(2.f));
+    resolver.Reset();
+    resolver.Resolve(Width, Height, color.data(), nullptr, params);
+    CHECK(IsUniform(resolver.GetOutput(), 2.f, 0.f));
+
+    std::vector<float4> smaller(64 * 32, float4(3.f));
+    resolver.Resolve(64, 32, smaller.data(), nullptr, params);
+    CHECK(IsUniform(resolver.GetOutput(), 3.f, 0.f));
+
+    // Fireflies are clamped before they enter the history
+    params.maxRadiance = 4.f;
+    smaller[100] = float4(1e6f);
+    resolver.Reset();
+    resolver.Resolve(64, 32, smaller.data(), nullptr, params);
+    CHECK(all(resolver.GetOutput()[100] == float4(4.f)));
+}
+
+UNIT_TEST(CpuTemporalResolver, NeighborhoodClamp)
+{
+    ThreadPool pool(4);
+    CpuTemporalResolver resolver(pool);
+    CpuTemporalResolveParameters params;
+
+    // A history of 1 over a new frame of 0: the 3x3 bounding box of the new frame is [0, 0], nothing is kept
+    std::vector<float4> color(Width * Height, float4(1.f));
+    params.clamp = CpuTemporalClamp::MinMax;
+    resolver.Resolve(Width, Height, color.data(), nullptr, params);
+    std::fill(color.begin(), color.end(), float4(0.f));
+    resolver.Resolve(Width, Height, color.data(), nullptr, params);
+    CHECK(IsUniform(resolver.GetOutput(), 0.f, 0.f));
+
+    // Vertical stripes of 0 and 1: every 3x3 neighborhood has 3 or 6 of 9 ones away from the edges, the history of 1
+    // is limited to mean + gamma * standard deviation
+    for (uint32_t y = 0; y < Height; y++)
+        for (uint32_t x = 0; x < Width; x++)
+            color[y * Width + x] = float4(float(x % 2));
+
+    params.clamp = CpuTemporalClamp::Variance;
+    params.varianceGamma = 0.5f;
+    const std::vector<float4> ones(Width * Height, float4(1.f));
+    resolver.Reset();
+    resolver.Resolve(Width, Height, ones.data(), nullptr, params);
+    resolver.Resolve(Width, Height, color.data(), nullptr, params);
+
+    // Pixel 10 is 0 with neighbors of 1: a mean of 2/3 and a standard deviation of sqrt(2)/3, half of which is kept
+    const float high = 2.f / 3.f + 0.5f * std::sqrt(2.f) / 3.f;
+    CHECK(std::abs(resolver.GetOutput()[20 * Width + 10].x - high * 0.9f) < 1e-5f);
+
+    // The bounding box of the same neighborhood is [0, 1] and keeps the history
+    params.clamp = CpuTemporalClamp::MinMax;
+    resolver.Reset();
+    resolver.Resolve(Width, Height, ones.data(), nullptr, params);
+    resolver.Resolve(Width, Height, color.data(), nullptr, params);
+    CHECK(std::abs(resolver.GetOutput()[20 * Width + 10].x - 0.9f) < 1e-5f);
+}
+
+UNIT_TEST(CpuTemporalResolver, Reprojection)
+{
+    ThreadPool pool(4);
+    CpuTemporalResolver resolver(pool);
+    CpuTemporalResolveParameters params;
+    params.clamp = CpuTemporalClamp::None;
+    params.newFrameWeight = 0.f;
+
+    // A horizontal ramp as the history
+    std::vector<float4> ramp(Width * Height);
+    for (uint32_t y = 0; y < Height; y++)
+        for (uint32_t x = 0; x < Width; x++)
+            ramp[y * Width + x] = float4(float(x));
+    resolver.Resolve(Width, Height, ramp.data(), nullptr, params);
+
+    // Every surface moved one pixel right: the history comes from the left neighbor, the new first column has none
+    const std::vector<float4> color(Width * Height, float4(-1.f));
+    std::vector<float2> motionVectors(Width * Height, float2(-1.f, 0.f));
+    resolver.Resolve(Width, Height, color.data(), motionVectors.data(), params);
+
+    const std::vector<float4>& output = resolver.GetOutput();
+    CHECK(output[5 * Width].x == -1.f);
+    bool shifted = true;
+    for (uint32_t x = 1; x < Width; x++)
+        shifted = shifted && output[5 * Width + x].x == float(x - 1);
+    CHECK(shifted);
+
+    // Half a pixel: Catmull-Rom reproduces the ramp between the pixels away from the clamped border
+    resolver.Reset();
+    resolver.Resolve(Width, Height, ramp.data(), nullptr, params);
+    std::fill(motionVectors.begin(), motionVectors.end(), float2(-0.5f, 0.f));
+    resolver.Resolve(Width, Height, color.data(), motionVectors.data(), params);
+
+    bool interpolated = true;
+    for (uint32_t x = 2; x < Width - 2; x++)
+        interpolated = interpolated && std::abs(resolver.GetOutput()[30 * Width + x].x - (float(x) - 0.5f)) < 1e-4f;
+    CHECK(interpolated);
+}
@@ -0,0 +1,189 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../DispatchAutotuner.h"
+
+#include <set>
+
+using namespace donut::math;
+
+#include "../dispatch_swizzle.h"
+
+// Grids that are multiples of every swizzle size, and ones that are not in either direction
+static const uint2 c_GroupCounts[] = {
+    uint2(1, 1), uint2(1, 9), uint2(9, 1), uint2(16, 16), uint2(7, 5), uint2(13, 9), uint2(33, 17), uint2(3, 40), uint2(120, 68)
+};
+
+// Number of groups of the grid visited 0 times, 2 or more times, or outside of it
+static uint32_t CountSwizzleErrors(uint2 groupCount, uint32_t swizzle, uint32_t size)
+{
+    std::vector<uint32_t> visits(groupCount.x * groupCount.y, 0);
+    uint32_t errors = 0;
+    for (uint32_t index = 0; index < groupCount.x * groupCount.y; index++)
+    {
+        const uint2 group = SwizzleGroupIndex(index, groupCount, swizzle, size);
+        if (group.x >= groupCount.x || group.y >= groupCount.y)
+            errors++;
+        else
+            visits[group.y * groupCount.x + group.x]++;
+    }
+
+    for (uint32_t count : visits)
+        errors += count != 1 ? 1 : 0;
+    return errors;
+}
+
+UNIT_TEST(DispatchSwizzle, EveryGroupOnce)
+{
+    const std::pair<uint32_t, uint32_t> swizzles[] = {
+        { STF_GROUP_SWIZZLE_NONE, 0 },
+        { STF_GROUP_SWIZZLE_MORTON, 1 },
+        { STF_GROUP_SWIZZLE_MORTON, 2 },
+        { STF_GROUP_SWIZZLE_MORTON, 4 },
+        { STF_GROUP_SWIZZLE_MORTON, 8 },
+        { STF_GROUP_SWIZZLE_MORTON, 64 },
+        { STF_GROUP_SWIZZLE_COLUMN_STRIPS, 0 },
+        { STF_GROUP_SWIZZLE_COLUMN_STRIPS, 1 },
+        { STF_GROUP_SWIZZLE_COLUMN_STRIPS, 3 },
+        { STF_GROUP_SWIZZLE_COLUMN_STRIPS, 4 },
+        { STF_GROUP_SWIZZLE_COLUMN_STRIPS, 7 },
+        { STF_GROUP_SWIZZLE_COLUMN_STRIPS, 16 },
+        { STF_GROUP_SWIZZLE_COLUMN_STRIPS, 200 },
+    };
+
+    for (const uint2 groupCount : c_GroupCounts)
+    {
+        for (const auto& [swizzle, size] : swizzles)
+        {
+            const uint32_t errors = CountSwizzleErrors(groupCount, swizzle, size);
+            CHECK(errors == 0);
+            if (errors)
+                fprintf(stderr, "Swizzle %u size %u on %ux%u groups: %u errors\n", swizzle, size, groupCount.x, groupCount.y, errors);
+        }
+    }
+}
+
+UNIT_TEST(DispatchSwizzle, Order)
+{
+    // Morton: the first size x size groups fill the first block in Z order
+    const uint2 groupCount(13, 9);
+    CHECK(all(SwizzleGroupIndex(0, groupCount, STF_GROUP_SWIZZLE_MORTON, 4) == uint2(0, 0)));
+    CHECK(all(SwizzleGroupIndex(1, groupCount, STF_GROUP_SWIZZLE_MORTON, 4) == uint2(1, 0)));
+    CHECK(all(SwizzleGroupIndex(2, groupCount, STF_GROUP_SWIZZLE_MORTON, 4) == uint2(0, 1)));
+    CHECK(all(SwizzleGroupIndex(3, groupCount, STF_GROUP_SWIZZLE_MORTON, 4) == uint2(1, 1)));
+    for (uint32_t index = 0; index < 16; index++)
+    {
+        const uint2 group = SwizzleGroupIndex(index, groupCount, STF_GROUP_SWIZZLE_MORTON, 4);
+        CHECK(group.x < 4 && group.y < 4);
+    }
+    CHECK(all(SwizzleGroupIndex(16, groupCount, STF_GROUP_SWIZZLE_MORTON, 4) == uint2(4, 0)));
+
+    // The groups outside the blocks come last: the column right of them, then the row below
+    CHECK(all(SwizzleGroupIndex(3 * 2 * 16, groupCount, STF_GROUP_SWIZZLE_MORTON, 4) == uint2(12, 0)));
+    CHECK(all(SwizzleGroupIndex(13 * 9 - 1, groupCount, STF_GROUP_SWIZZLE_MORTON, 4) == uint2(12, 8)));
+
+    // Column strips: down the first strip before the second, the last strip narrower
+    CHECK(all(SwizzleGroupIndex(5, groupCount, STF_GROUP_SWIZZLE_COLUMN_STRIPS, 4) == uint2(1, 1)));
+    CHECK(all(SwizzleGroupIndex(4 * 9, groupCount, STF_GROUP_SWIZZLE_COLUMN_STRIPS, 4) == uint2(4, 0)));
+    CHECK(all(SwizzleGroupIndex(12 * 9 + 1, groupCount, STF_GROUP_SWIZZLE_COLUMN_STRIPS, 4) == uint2(12, 1)));
+
+    // No swizzle is row-major
+    CHECK(all(SwizzleGroupIndex(14, groupCount, STF_GROUP_SWIZZLE_NONE, 4) == uint2(1, 1)));
+}
+
+UNIT_TEST(DispatchSwizzle, CandidatesCoverViewport)
+{
+    const std::vector<CpuDispatchOrder> candidates = DispatchAutotuner::GetCandidates();
+    REQUIRE(!candidates.empty());
+
+    std::set<std::string> names;
+    for (const CpuDispatchOrder& order : candidates)
+        names.insert(DispatchAutotuner::GetCandidateName(order));
+    CHECK(names.size() == candidates.size());
+
+    // Every pixel is shaded by exactly one thread, whatever the swizzle, group shape and lane layout
+    std::vector<uint2> pixels;
+    for (const uint2 viewportSize : { uint2(100, 37), uint2(64, 64), uint2(1, 1) })
+    {
+        for (const CpuDispatchOrder& order : candidates)
+        {
+            const uint2 groupCount = order.GetGroupCount(viewportSize);
+            std::vector<uint32_t> visits(viewportSize.x * viewportSize.y, 0);
+            uint32_t outside = 0;
+
+            for (uint32_t index = 0; index < groupCount.x * groupCount.y; index++)
+            {
+                order.GetGroupPixels(order.GetGroup(index, groupCount), viewportSize, pixels);
+                for (const uint2 pixel : pixels)
+                {
+                    if (pixel.x == ~0u)
+                        outside++;
+                    else
+                        visits[pixel.y * viewportSize.x + pixel.x]++;
+                }
+            }
+
+            bool once = true;
+            for (uint32_t count : visits)
+                once = once && count == 1;
+            CHECK(once);
+            CHECK(outside + viewportSize.x * viewportSize.y == groupCount.x * groupCount.y * order.groupSize.x * order.groupSize.y);
+            if (!once)
+                fprintf(stderr, "%s on %ux%u pixels\n", DispatchAutotuner::GetCandidateName(order).c_str(), viewportSize.x, viewportSize.y);
+        }
+    }
+}
+
+UNIT_TEST(DispatchSwizzle, Autotuner)
+{
+    DispatchAutotuner tuner;
+    const uint32_t count = uint32_t(tuner.GetCandidateCount());
+    const uint32_t best = count / 3;
+    tuner.Start(uint2(1920, 1080), "gpuMilliseconds", 1, 3);
+    REQUIRE(tuner.IsSearching());
+
+    bool finished = false;
+    for (uint32_t index = 0; index < count && !finished; index++)
+    {
+        CHECK(tuner.GetCurrentIndex() == index);
+
+        // Unscored warmup, a late result of an earlier candidate, then the median of three frames with one outlier
+        const float cost = index == best ? 1.f : 2.f + float(index);
+        CHECK(!tuner.Report(index, 0.f));
+        if (index > 0)
+            CHECK(!tuner.Report(index - 1, 0.f));
+        tuner.Report(index, cost);
+        tuner.Report(index, 0.001f);
+        finished = tuner.Report(index, cost);
+    }
+
+    CHECK(finished);
+    CHECK(!tuner.IsSearching());
+    const DispatchTuning* result = tuner.FindResult(uint2(1920, 1080));
+    REQUIRE(result);
+    CHECK(result->cost == 1.f);
+    CHECK(result->metric == "gpuMilliseconds");
+    CHECK(DispatchAutotuner::GetCandidateName(result->order) == DispatchAutotuner::GetCandidateName(tuner.GetCandidate(best)));
+    CHECK(!tuner.FindResult(uint2(1280, 720)));
+
+    // Results survive a save and load
+    const std::filesystem::path fileName = GetUnitTestDirectory("DispatchAutotuner") / "tuning.json";
+    std::string error;
+    REQUIRE(tuner.Save(fileName, error));
+
+    DispatchAutotuner loaded;
+    REQUIRE(loaded.Load(fileName, error));
+    const DispatchTuning* loadedResult = loaded.FindResult(uint2(1920, 1080));
+    REQUIRE(loadedResult);
+    CHECK(DispatchAutotuner::GetCandidateName(loadedResult->order) == DispatchAutotuner::GetCandidateName(result->order));
+    CHECK(loadedResult->cost == result->cost);
+    CHECK(!loaded.Load(GetUnitTestDirectory("DispatchAutotunerMissing") / "missing.json", error));
+}
@@ -0,0 +1,58 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+
+#include <donut/core/math/math.h>
+
+#include <cmath>
+
+using namespace donut::math;
+
+#include "../gbuffer_texel_id.h"
+
+UNIT_TEST(GBufferTexelId, PackUnpack)
+{
+    // Texel 5, 3 of mip 2 of a 256x128 texture
+    const GBufferTexelId id = UnpackGBufferTexelId(PackGBufferTexelId(float2(5.4f, 3.9f), float2(64, 32), 2, 256, 123456, true));
+    CHECK(id.resolve);
+    CHECK(id.backFace);
+    CHECK(id.materialId == 123456);
+    CHECK(id.mip == 2);
+    CHECK(id.log2Width == 8);
+    CHECK(all(GetGBufferTexel(id.uv, int2(64, 32)) == int2(5, 3)));
+
+    // Positions outside [0, 1) wrap, the largest width and mip still fit
+    const GBufferTexelId wrapped = UnpackGBufferTexelId(PackGBufferTexelId(float2(-1.f, 33.f), float2(32, 32), 31, 0x80000000u, 0, false));
+    CHECK(!wrapped.backFace);
+    CHECK(wrapped.mip == 31);
+    CHECK(wrapped.log2Width == 31);
+    CHECK(all(GetGBufferTexel(wrapped.uv, int2(32, 32)) == int2(31, 1)));
+
+    CHECK(GetGBufferLog2Width(1) == 0);
+    CHECK(GetGBufferLog2Width(1024) == 10);
+    CHECK(GetGBufferLog2Width(1000) == 9);
+}
+
+UNIT_TEST(GBufferTexelId, TexelMip)
+{
+    // Mip 3 of a 1024 wide first texture
+    const GBufferTexelId id = UnpackGBufferTexelId(PackGBufferTexelId(float2(10.f, 10.f), float2(128, 128), 3, 1024, 0, false));
+
+    // The same texel density: 128 texels wide on every texture that has the mip
+    CHECK(GetGBufferTexelMip(id, 1024, 11) == 3);
+    CHECK(GetGBufferTexelMip(id, 2048, 12) == 4);
+    CHECK(GetGBufferTexelMip(id, 256, 9) == 1);
+    CHECK(GetGBufferTexelMip(id, 128, 8) == 0);
+
+    // Smaller textures clamp to mip 0, and every texture to its last mip
+    CHECK(GetGBufferTexelMip(id, 64, 7) == 0);
+    CHECK(GetGBufferTexelMip(id, 2048, 3) == 2);
+}
@@ -0,0 +1,109 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../ImageMetrics.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+static float SrgbToLinear(float value)
+{
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+// RGBA32_FLOAT image of gray sRGB encoded values in [0.1, 0.8] plus 'offset', the same texture for every offset
+static std::vector<float> CreateGrayImage(uint32_t width, uint32_t height, float offset, bool textured)
+{
+    std::vector<float> pixels(size_t(width) * height * 4);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < size_t(width) * height; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        const float encoded = (textured ? 0.1f + 0.7f * float(seed >> 8) / float(1u << 24) : 0.4f) + offset;
+        for (uint32_t c = 0; c < 3; c++)
+            pixels[i * 4 + c] = SrgbToLinear(encoded);
+        pixels[i * 4 + 3] = 1.f;
+    }
+    return pixels;
+}
+
+static MetricImage GetMetricImage(const std::vector<float>& pixels, uint32_t width, uint32_t height)
+{
+    MetricImage image;
+    image.data = pixels.data();
+    image.width = width;
+    image.height = height;
+    return image;
+}
+
+UNIT_TEST(ImageMetrics, IdenticalPair)
+{
+    const uint32_t width = 80;
+    const uint32_t height = 48;
+    const std::vector<float> pixels = CreateGrayImage(width, height, 0.f, true);
+
+    ThreadPool pool(4);
+    ImageMetrics metrics(pool);
+    ImageMetricsResult result;
+    REQUIRE(metrics.Compare(GetMetricImage(pixels, width, height), GetMetricImage(pixels, width, height), ImageMetricsOptions(), result));
+
+    CHECK(std::isinf(result.psnr));
+    CHECK(std::abs(result.ssim - 1.0) < 1e-5);
+    CHECK(std::abs(result.msSsim - 1.0) < 1e-5);
+    CHECK(result.flip == 0.0);
+
+    // 32 pixel tiles, the last column and row partial
+    CHECK(result.tiles.tilesX == 3 && result.tiles.tilesY == 2);
+    REQUIRE(result.tiles.flip.size() == 6 && result.tiles.psnr.size() == 6 && result.tiles.ssim.size() == 6);
+    for (size_t i = 0; i < 6; i++)
+        CHECK(std::isinf(result.tiles.psnr[i]) && result.tiles.flip[i] == 0.f);
+}
+
+UNIT_TEST(ImageMetrics, ConstantOffset)
+{
+    const uint32_t width = 64;
+    const uint32_t height = 64;
+
+    ThreadPool pool(4);
+    ImageMetrics metrics(pool);
+    ImageMetricsOptions options;
+    options.multiScaleSsim = false;
+
+    // An offset of 0.1 in sRGB encoded values has a mean squared error of 0.01, 20 dB
+    const std::vector<float> reference = CreateGrayImage(width, height, 0.f, true);
+    const std::vector<float> test = CreateGrayImage(width, height, 0.1f, true);
+    ImageMetricsResult result;
+    REQUIRE(metrics.Compare(GetMetricImage(test, width, height), GetMetricImage(reference, width, height), options, result));
+
+    CHECK(std::abs(result.psnr - 20.0) < 0.01);
+    for (float tile : result.tiles.psnr)
+        CHECK(std::abs(tile - 20.f) < 0.01f);
+
+    // Only the luminance term of SSIM sees the offset, FLIP sees a small color difference
+    CHECK(result.ssim > 0.9 && result.ssim < 0.99);
+    CHECK(result.flip > 0.0 && result.flip < 0.5);
+
+    // On flat images SSIM is the luminance term of the means 0.4 and 0.5 alone
+    const std::vector<float> flatReference = CreateGrayImage(width, height, 0.f, false);
+    const std::vector<float> flatTest = CreateGrayImage(width, height, 0.1f, false);
+    REQUIRE(metrics.Compare(GetMetricImage(flatTest, width, height), GetMetricImage(flatReference, width, height), options, result));
+
+    const double c1 = 0.01 * 0.01;
+    const double expectedSsim = (2.0 * 0.4 * 0.5 + c1) / (0.4 * 0.4 + 0.5 * 0.5 + c1);
+    CHECK(std::abs(result.psnr - 20.0) < 0.01);
+    CHECK(std::abs(result.ssim - expectedSsim) < 1e-4);
+
+    // The metrics are symmetric
+    ImageMetricsResult swapped;
+    REQUIRE(metrics.Compare(GetMetricImage(flatReference, width, height), GetMetricImage(flatTest, width, height), options, swapped));
+    CHECK(std::abs(swapped.ssim - result.ssim) < 1e-6);
+}
@@ -0,0 +1,132 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../NoiseSpectrum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+static const double Pi = 3.14159265358979323846;
+
+// Index of the largest value and whether every value more than one bin away is below 'threshold' of it, the Hann
+// window spreads a sinusoid over its bin and the two next to it
+static bool IsPeak(const std::vector<double>& power, size_t bin, double threshold)
+{
+    const size_t largest = size_t(std::max_element(power.begin(), power.end()) - power.begin());
+    if (largest != bin)
+        return false;
+
+    for (size_t i = 0; i < power.size(); i++)
+    {
+        if ((i + 1 < bin || i > bin + 1) && power[i] > threshold * power[bin])
+            return false;
+    }
+    return true;
+}
+
+UNIT_TEST(NoiseSpectrum, SpatialSinusoid)
+{
+    ThreadPool pool(4);
+    NoiseSpectrumOptions options;
+    options.tileSize = 64;
+    NoiseSpectrumAnalyzer analyzer(pool, options);
+
+    // 12 periods per tile along x with amplitude 2: bin 12 of 32, a variance of 2
+    const uint32_t width = 128;
+    const uint32_t height = 128;
+    std::vector<float> error(width * height);
+    for (uint32_t y = 0; y < height; y++)
+        for (uint32_t x = 0; x < width; x++)
+            error[y * width + x] = float(2.0 * std::cos(2.0 * Pi * 12.0 * x / 64.0));
+
+    analyzer.AddFrame(width, height, error.data());
+    NoiseSpectrum spectrum;
+    analyzer.GetResult(spectrum);
+
+    CHECK(spectrum.frameCount == 1);
+    REQUIRE(spectrum.spatialPower.size() == 32);
+    CHECK(IsPeak(spectrum.spatialPower, 12, 1e-6));
+    CHECK(std::abs(spectrum.spatialVariance - 2.0) < 1e-3);
+
+    // All energy, the neighbouring bins included, above the cutoff at a quarter of the Nyquist frequency
+    CHECK(spectrum.spatialLowFrequencyRatio < 1e-6);
+
+    // 4 periods along y move it below the cutoff
+    for (uint32_t y = 0; y < height; y++)
+        for (uint32_t x = 0; x < width; x++)
+            error[y * width + x] = float(std::cos(2.0 * Pi * 4.0 * y / 64.0 + 1.0));
+
+    analyzer.Reset();
+    analyzer.AddFrame(width, height, error.data());
+    analyzer.GetResult(spectrum);
+    CHECK(IsPeak(spectrum.spatialPower, 4, 1e-6));
+    CHECK(std::abs(spectrum.spatialVariance - 0.5) < 1e-3);
+    CHECK(spectrum.spatialLowFrequencyRatio > 1.0 - 1e-6);
+}
+
+UNIT_TEST(NoiseSpectrum, WhiteNoise)
+{
+    ThreadPool pool(4);
+    NoiseSpectrumAnalyzer analyzer(pool, NoiseSpectrumOptions());
+
+    // Uniform in [-0.5, 0.5): a variance of 1/12 spread evenly over the frequencies
+    const uint32_t width = 128;
+    const uint32_t height = 128;
+    std::vector<float> error(width * height);
+    uint32_t seed = 1;
+    for (uint32_t frame = 0; frame < 32; frame++)
+    {
+        for (float& value : error)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            value = float(seed >> 8) / float(1u << 24) - 0.5f;
+        }
+        analyzer.AddFrame(width, height, error.data());
+    }
+
+    NoiseSpectrum spectrum;
+    analyzer.GetResult(spectrum);
+    CHECK(spectrum.frameCount == 32);
+    CHECK(std::abs(spectrum.spatialVariance - 1.0 / 12.0) < 0.005);
+    CHECK(std::abs(spectrum.spatialLowFrequencyRatio - spectrum.spatialWhiteNoiseRatio) < 0.1 * spectrum.spatialWhiteNoiseRatio);
+    CHECK(std::abs(spectrum.temporalLowFrequencyRatio - spectrum.temporalWhiteNoiseRatio) < 0.2 * spectrum.temporalWhiteNoiseRatio);
+}
+
+UNIT_TEST(NoiseSpectrum, TemporalSinusoid)
+{
+    ThreadPool pool(4);
+    NoiseSpectrumOptions options;
+    options.maxTemporalFrames = 64;
+    NoiseSpectrumAnalyzer analyzer(pool, options);
+
+    // Every pixel flickers with 4 periods over 64 frames, the same in the whole image
+    const uint32_t width = 64;
+    const uint32_t height = 64;
+    std::vector<float> error(width * height);
+    for (uint32_t frame = 0; frame < 64; frame++)
+    {
+        std::fill(error.begin(), error.end(), float(std::sin(2.0 * Pi * 4.0 * frame / 64.0)));
+        analyzer.AddFrame(width, height, error.data());
+    }
+
+    NoiseSpectrum spectrum;
+    analyzer.GetResult(spectrum);
+
+    // Bin k of the temporal power is at k + 1 periods
+    REQUIRE(spectrum.temporalPower.size() == 32);
+    CHECK(IsPeak(spectrum.temporalPower, 3, 1e-6));
+    CHECK(spectrum.temporalLowFrequencyRatio > 1.0 - 1e-6);
+
+    // Without spatial variation there is no spatial error left after the mean of each tile
+    CHECK(spectrum.spatialVariance < 1e-9);
+}
@@ -0,0 +1,158 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../OpacityMicromap.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+using namespace donut::math;
+
+static float2 GetCentroid(uint32_t index, uint32_t level)
+{
+    float2 vertices[3];
+    OpacityMicromaps::GetMicroTriangleVertices(index, level, vertices);
+    return (vertices[0] + vertices[1] + vertices[2]) / 3.f;
+}
+
+static uint32_t CountSharedVertices(const float2 a[3], const float2 b[3])
+{
+    uint32_t shared = 0;
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            shared += all(a[i] == b[j]) ? 1 : 0;
+    return shared;
+}
+
+UNIT_TEST(OpacityMicromap, BirdCurve)
+{
+    // Level 1 of the specifications: the corner at vertex 0, the inverted middle, the corners at vertex 1 and 2
+    CHECK(all(GetCentroid(0, 1) == float2(1.f, 1.f) / 6.f));
+    CHECK(all(GetCentroid(1, 1) == float2(1.f, 1.f) / 3.f));
+    CHECK(all(GetCentroid(2, 1) == float2(4.f, 1.f) / 6.f));
+    CHECK(all(GetCentroid(3, 1) == float2(1.f, 4.f) / 6.f));
+
+    for (uint32_t level = 0; level <= 6; level++)
+    {
+        const uint32_t count = 1u << (2 * level);
+        const float area = 0.5f / float(count);
+
+        float2 previous[3];
+        for (uint32_t index = 0; index < count; index++)
+        {
+            float2 vertices[3];
+            OpacityMicromaps::GetMicroTriangleVertices(index, level, vertices);
+
+            // Inside the triangle, with a 4^-level share of its area
+            bool inside = true;
+            for (const float2& vertex : vertices)
+                inside = inside && vertex.x >= 0.f && vertex.y >= 0.f && vertex.x + vertex.y <= 1.f;
+            CHECK(inside);
+            const float2 e1 = vertices[1] - vertices[0];
+            const float2 e2 = vertices[2] - vertices[0];
+            CHECK(std::abs(std::abs(e1.x * e2.y - e1.y * e2.x) * 0.5f - area) < 1e-7f);
+
+            // Points of the micro-triangle give its index back
+            CHECK(OpacityMicromaps::GetMicroTriangleIndex(GetCentroid(index, level), level) == index);
+            CHECK(OpacityMicromaps::GetMicroTriangleIndex(vertices[0] * 0.8f + vertices[1] * 0.1f + vertices[2] * 0.1f, level) == index);
+
+            // The curve is connected: consecutive micro-triangles share an edge or at least a vertex
+            if (index > 0)
+                CHECK(CountSharedVertices(previous, vertices) >= 1);
+            memcpy(previous, vertices, sizeof(previous));
+        }
+
+        // The corners and points outside the triangle are clamped to a micro-triangle at the edge
+        for (float2 barycentrics : { float2(0.f, 0.f), float2(1.f, 0.f), float2(0.f, 1.f), float2(0.7f, 0.7f), float2(-0.1f, 2.f) })
+            CHECK(OpacityMicromaps::GetMicroTriangleIndex(barycentrics, level) < count);
+    }
+}
+
+// The file layout of OpacityMicromaps::Write
+struct OmmFileHeader
+{
+    char magic[4] = { 'S', 'T', 'F', 'O' };
+    uint32_t version = 1;
+    uint64_t triangleCount = 0;
+    uint64_t descCount = 0;
+    uint64_t dataSize = 0;
+};
+
+static bool WriteOmmFile(const std::filesystem::path& fileName, const std::vector<int32_t>& indices, const std::vector<OmmDesc>& descs,
+    const std::vector<uint8_t>& data)
+{
+    OmmFileHeader header;
+    header.triangleCount = indices.size();
+    header.descCount = descs.size();
+    header.dataSize = data.size();
+
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(indices.data()), std::streamsize(indices.size() * sizeof(int32_t)));
+    file.write(reinterpret_cast<const char*>(descs.data()), std::streamsize(descs.size() * sizeof(OmmDesc)));
+    file.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size()));
+    return file.good();
+}
+
+UNIT_TEST(OpacityMicromap, States)
+{
+    // A four-state level 1 micromap with one micro-triangle per state, and a two-state level 2 micromap alternating
+    // transparent and opaque, after the four special indices
+    std::vector<OmmDesc> descs(2);
+    descs[0].byteOffset = 0;
+    descs[0].subdivisionLevel = 1;
+    descs[0].format = uint16_t(OmmFormat::FourState);
+    descs[1].byteOffset = 1;
+    descs[1].subdivisionLevel = 2;
+    descs[1].format = uint16_t(OmmFormat::TwoState);
+    const std::vector<uint8_t> data = { 0xe4, 0xaa, 0xaa };
+    const std::vector<int32_t> indices = {
+        OpacityMicromaps::SpecialIndexFullyTransparent, OpacityMicromaps::SpecialIndexFullyOpaque,
+        OpacityMicromaps::SpecialIndexFullyUnknownTransparent, OpacityMicromaps::SpecialIndexFullyUnknownOpaque, 0, 1 };
+
+    const std::filesystem::path fileName = GetUnitTestDirectory("OpacityMicromapStates") / "omm.bin";
+    REQUIRE(WriteOmmFile(fileName, indices, descs, data));
+
+    OpacityMicromaps micromaps;
+    REQUIRE(micromaps.Read(fileName));
+    CHECK(!micromaps.IsEmpty());
+
+    const float2 center = float2(1.f, 1.f) / 3.f;
+    CHECK(micromaps.GetState(0, center) == OmmState::Transparent);
+    CHECK(micromaps.GetState(1, center) == OmmState::Opaque);
+    CHECK(micromaps.GetState(2, center) == OmmState::UnknownTransparent);
+    CHECK(micromaps.GetState(3, center) == OmmState::UnknownOpaque);
+
+    for (uint32_t microTriangle = 0; microTriangle < 4; microTriangle++)
+        CHECK(micromaps.GetState(4, GetCentroid(microTriangle, 1)) == OmmState(microTriangle));
+    for (uint32_t microTriangle = 0; microTriangle < 16; microTriangle++)
+        CHECK(micromaps.GetState(5, GetCentroid(microTriangle, 2)) == OmmState(microTriangle % 2));
+
+    CHECK(OpacityMicromaps::IsKnown(OmmState::Opaque) && OpacityMicromaps::IsKnown(OmmState::Transparent));
+    CHECK(!OpacityMicromaps::IsKnown(OmmState::UnknownOpaque) && !OpacityMicromaps::IsKnown(OmmState::UnknownTransparent));
+
+    const std::vector<OmmUsageCount> usage = micromaps.GetUsageCounts();
+    REQUIRE(usage.size() == 2);
+    CHECK(usage[0].subdivisionLevel == 1 && usage[0].format == OmmFormat::FourState && usage[0].count == 1);
+    CHECK(usage[1].subdivisionLevel == 2 && usage[1].format == OmmFormat::TwoState && usage[1].count == 1);
+
+    // Micromaps past the data and indices past the descs are rejected
+    descs[1].byteOffset = 2;
+    REQUIRE(WriteOmmFile(fileName, indices, descs, data));
+    CHECK(!micromaps.Read(fileName) && micromaps.IsEmpty());
+
+    descs[1].byteOffset = 1;
+    REQUIRE(WriteOmmFile(fileName, { 0, 2 }, descs, data));
+    CHECK(!micromaps.Read(fileName));
+}
@@ -0,0 +1,139 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../RayDifferentials.h"
+
+#include <cmath>
+
+using namespace donut::math;
+
+// A tilted plane in front of the camera, with a skewed texture mapping
+static const float3 Positions[3] = { float3(-5.f, -5.f, 1.5f), float3(5.f, -5.f, 6.5f), float3(-5.f, 5.f, 1.5f) };
+static const float2 Texcoords[3] = { float2(0.f, 0.f), float2(1.f, 0.2f), float2(0.3f, 1.f) };
+
+// A projective clip to world transform, w varies over the screen
+static float4x4 GetClipToWorld()
+{
+    float4x4 matrix;
+    matrix.row0 = float4(0.8f, 0.1f, 0.f, 0.05f);
+    matrix.row1 = float4(0.f, 0.6f, 0.2f, -0.03f);
+    matrix.row2 = float4(0.f, 0.f, 0.f, 0.5f);
+    matrix.row3 = float4(0.3f, -0.2f, 1.f, 1.f);
+    return matrix;
+}
+
+static const float3 CameraPosition = float3(0.f, 0.f, -2.f);
+static const float2 ViewportSizeInv = float2(1.f / 64.f, 1.f / 48.f);
+
+// The direction setupPrimaryRay builds, at any point of the screen rather than pixel centers
+static float3 GetPrimaryRayDirection(float2 pixel)
+{
+    const float2 uv = pixel * ViewportSizeInv;
+    const float4 worldPos = float4(uv.x * 2.f - 1.f, 1.f - uv.y * 2.f, 0.5f, 1.f) * GetClipToWorld();
+    return normalize(worldPos.xyz() / worldPos.w - CameraPosition);
+}
+
+// Texture coordinates where the ray through 'pixel' hits the plane, what a traced neighbor ray would give
+static float2 TraceTexcoord(float2 pixel)
+{
+    const float3 direction = GetPrimaryRayDirection(pixel);
+    const float3 normal = cross(Positions[1] - Positions[0], Positions[2] - Positions[0]);
+    const float3 hit = CameraPosition + direction * (dot(Positions[0] - CameraPosition, normal) / dot(direction, normal));
+
+    // Barycentrics of the hit, from the areas of the sub-triangles
+    const float area = dot(normal, normal);
+    const float b1 = dot(cross(Positions[2] - hit, Positions[0] - hit), normal) / area;
+    const float b2 = dot(cross(Positions[0] - hit, Positions[1] - hit), normal) / area;
+    return Texcoords[0] * (1.f - b1 - b2) + Texcoords[1] * b1 + Texcoords[2] * b2;
+}
+
+static bool Near(float2 a, float2 b, float tolerance)
+{
+    return length(a - b) <= tolerance;
+}
+
+UNIT_TEST(RayDifferentials, TexcoordJacobian)
+{
+    const TexcoordJacobian jacobian = ComputeTexcoordJacobian(Positions, Texcoords);
+
+    // Linear over the plane: the vertices and an inner point map to their texture coordinates
+    auto map = [&](float3 position)
+    {
+        return Texcoords[0] + float2(dot(jacobian.dUdP, position - Positions[0]), dot(jacobian.dVdP, position - Positions[0]));
+    };
+    CHECK(Near(map(Positions[1]), Texcoords[1], 1e-6f));
+    CHECK(Near(map(Positions[2]), Texcoords[2], 1e-6f));
+    CHECK(Near(map((Positions[0] + Positions[1] * 2.f + Positions[2]) * 0.25f), (Texcoords[0] + Texcoords[1] * 2.f + Texcoords[2]) * 0.25f, 1e-6f));
+
+    // No change off the plane
+    const float3 normal = cross(Positions[1] - Positions[0], Positions[2] - Positions[0]);
+    CHECK(std::abs(dot(jacobian.dUdP, normal)) < 1e-6f && std::abs(dot(jacobian.dVdP, normal)) < 1e-6f);
+
+    // Degenerate triangles give no gradients rather than infinities
+    const float3 line[3] = { float3(0.f, 0.f, 0.f), float3(1.f, 1.f, 1.f), float3(2.f, 2.f, 2.f) };
+    const TexcoordJacobian degenerate = ComputeTexcoordJacobian(line, Texcoords);
+    CHECK(all(degenerate.dUdP == float3(0.f)) && all(degenerate.dVdP == float3(0.f)));
+}
+
+UNIT_TEST(RayDifferentials, PrimaryRayGradients)
+{
+    const TexcoordJacobian jacobian = ComputeTexcoordJacobian(Positions, Texcoords);
+    const float3 normal = cross(Positions[1] - Positions[0], Positions[2] - Positions[0]);
+
+    for (uint2 pixel : { uint2(0, 0), uint2(20, 40), uint2(63, 5), uint2(32, 24) })
+    {
+        const float2 center = float2(pixel) + 0.5f;
+        const float3 direction = GetPrimaryRayDirection(center);
+
+        // A pinhole camera: the origin does not move, the direction changes like the neighbor rays
+        const RayDifferential differential = GetPrimaryRayDifferential(pixel, GetClipToWorld(), ViewportSizeInv, CameraPosition);
+        CHECK(all(differential.dOdx == float3(0.f)) && all(differential.dOdy == float3(0.f)));
+
+        const float h = 1.f / 16.f;
+        const float3 dDdx = (GetPrimaryRayDirection(center + float2(h, 0.f)) - GetPrimaryRayDirection(center - float2(h, 0.f))) / (2.f * h);
+        const float3 dDdy = (GetPrimaryRayDirection(center + float2(0.f, h)) - GetPrimaryRayDirection(center - float2(0.f, h))) / (2.f * h);
+        CHECK(length(differential.dDdx - dDdx) < 1e-3f * length(dDdx));
+        CHECK(length(differential.dDdy - dDdy) < 1e-3f * length(dDdy));
+
+        // One hit and the differential give the gradients of tracing the neighbors, up to the curvature of the mapping
+        const float hitT = dot(Positions[0] - CameraPosition, normal) / dot(direction, normal);
+        float3 dPdx, dPdy;
+        TransferRayDifferential(differential, direction, hitT, normal, dPdx, dPdy);
+        CHECK(std::abs(dot(dPdx, normal)) < 1e-4f * length(normal) * length(dPdx));
+
+        float2 texGradX, texGradY;
+        GetTextureGradients(jacobian, dPdx, dPdy, texGradX, texGradY);
+
+        const float2 tracedGradX = (TraceTexcoord(center + float2(h, 0.f)) - TraceTexcoord(center - float2(h, 0.f))) / (2.f * h);
+        const float2 tracedGradY = (TraceTexcoord(center + float2(0.f, h)) - TraceTexcoord(center - float2(0.f, h))) / (2.f * h);
+        CHECK(Near(texGradX, tracedGradX, 2e-3f * length(tracedGradX)));
+        CHECK(Near(texGradY, tracedGradY, 2e-3f * length(tracedGradY)));
+    }
+}
+
+UNIT_TEST(RayDifferentials, Reflection)
+{
+    RayDifferential incoming;
+    incoming.dDdx = float3(0.1f, 0.02f, -0.03f);
+    incoming.dDdy = float3(-0.01f, 0.05f, 0.04f);
+    const float3 dPdx = float3(0.2f, 0.f, 0.1f);
+    const float3 dPdy = float3(0.f, 0.3f, 0.f);
+    const float3 normal = normalize(float3(0.f, 1.f, 1.f));
+
+    // The footprint becomes the origin change, the direction change is mirrored at the plane of the normal
+    const RayDifferential reflected = ReflectRayDifferential(incoming, dPdx, dPdy, normal);
+    CHECK(all(reflected.dOdx == dPdx) && all(reflected.dOdy == dPdy));
+    CHECK(std::abs(dot(reflected.dDdx, normal) + dot(incoming.dDdx, normal)) < 1e-6f);
+    CHECK(std::abs(length(reflected.dDdy) - length(incoming.dDdy)) < 1e-6f);
+
+    const float3 tangent = normalize(cross(normal, float3(1.f, 0.f, 0.f)));
+    CHECK(std::abs(dot(reflected.dDdx, tangent) - dot(incoming.dDdx, tangent)) < 1e-6f);
+}
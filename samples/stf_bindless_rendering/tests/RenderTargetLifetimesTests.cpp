@@ -0,0 +1,221 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../RenderTargetLifetimes.h"
+
+#include <random>
+
+static RenderTargetRequirements MakeTarget(const char* name, uint64_t size, RenderTargetLifetime lifetime = RenderTargetLifetime::Transient, uint64_t alignment = 1)
+{
+    RenderTargetRequirements target;
+    target.name = name;
+    target.size = size;
+    target.alignment = alignment;
+    target.lifetime = lifetime;
+    return target;
+}
+
+// Targets live at the same time never share memory, offsets are aligned and inside the heap
+static bool IsValidPlan(const std::vector<RenderTargetRequirements>& targets, const RenderTargetPlan& plan)
+{
+    for (size_t a = 0; a < targets.size(); a++)
+    {
+        const RenderTargetPlacement& placementA = plan.placements[a];
+        if (!placementA.used)
+            continue;
+
+        if (placementA.offset % targets[a].alignment != 0 || placementA.offset + targets[a].size > plan.heapSize)
+            return false;
+
+        for (size_t b = a + 1; b < targets.size(); b++)
+        {
+            const RenderTargetPlacement& placementB = plan.placements[b];
+            if (!placementB.used)
+                continue;
+
+            const bool liveTogether = placementA.firstPass <= placementB.lastPass && placementB.firstPass <= placementA.lastPass;
+            const bool memoryOverlaps = placementA.offset < placementB.offset + targets[b].size && placementB.offset < placementA.offset + targets[a].size;
+            if (liveTogether && memoryOverlaps)
+                return false;
+        }
+    }
+    return true;
+}
+
+UNIT_TEST(RenderTargetLifetimes, DisjointLifetimes)
+{
+    const std::vector<RenderTargetRequirements> targets = { MakeTarget("A", 1000), MakeTarget("B", 1000), MakeTarget("Unused", 500) };
+    std::vector<RenderPassUsage> passes = {
+        { "write A", {}, { "A" }, {} },
+        { "read A", { "A" }, {}, {} },
+        { "write B", {}, { "B" }, {} },
+        { "read B", { "B" }, {}, {} },
+    };
+
+    RenderTargetPlan plan;
+    std::string error;
+    REQUIRE(PlanRenderTargets(targets, passes, plan, error));
+    REQUIRE(IsValidPlan(targets, plan));
+
+    // A and B share memory, so whatever writes them first sees the other's contents
+    CHECK(plan.placements[0].firstPass == 0 && plan.placements[0].lastPass == 1);
+    CHECK(plan.placements[1].firstPass == 2 && plan.placements[1].lastPass == 3);
+    CHECK(plan.placements[0].offset == plan.placements[1].offset);
+    CHECK(plan.placements[0].aliased && plan.placements[1].aliased);
+    CHECK(plan.placements[0].needsClear && plan.placements[1].needsClear);
+    CHECK(plan.heapSize == 1000);
+
+    // Unused targets get no memory but count as declared
+    CHECK(!plan.placements[2].used);
+    CHECK(plan.usedCount == 2);
+    CHECK(plan.usedBytes == 2000);
+    CHECK(plan.declaredBytes == 2500);
+
+    // A pass that clears the target on first use makes the clear unnecessary
+    passes[2] = { "clear B", {}, {}, { "B" } };
+    REQUIRE(PlanRenderTargets(targets, passes, plan, error));
+    CHECK(plan.placements[0].needsClear);
+    CHECK(plan.placements[1].aliased && !plan.placements[1].needsClear);
+}
+
+UNIT_TEST(RenderTargetLifetimes, OverlappingLifetimes)
+{
+    const std::vector<RenderTargetRequirements> targets = { MakeTarget("A", 1000), MakeTarget("B", 600), MakeTarget("C", 400) };
+    const std::vector<RenderPassUsage> passes = {
+        { "write A", {}, { "A" }, {} },
+        { "write B", {}, { "B" }, {} },
+        { "read A and B", { "A", "B" }, { "C" }, {} },
+        { "read C", { "C" }, {}, {} },
+    };
+
+    RenderTargetPlan plan;
+    std::string error;
+    REQUIRE(PlanRenderTargets(targets, passes, plan, error));
+    REQUIRE(IsValidPlan(targets, plan));
+
+    // A, B and C are all live in the third pass
+    CHECK(plan.heapSize == 2000);
+    for (const RenderTargetPlacement& placement : plan.placements)
+        CHECK(placement.used && !placement.aliased && !placement.needsClear);
+
+    // Lifetimes that only touch in one pass overlap too
+    const std::vector<RenderPassUsage> touching = {
+        { "write A", {}, { "A" }, {} },
+        { "read A, write B", { "A" }, { "B" }, {} },
+    };
+    REQUIRE(PlanRenderTargets(targets, touching, plan, error));
+    REQUIRE(IsValidPlan(targets, plan));
+    CHECK(plan.heapSize == 1600);
+    CHECK(!plan.placements[0].aliased && !plan.placements[1].aliased);
+}
+
+UNIT_TEST(RenderTargetLifetimes, PersistentTargets)
+{
+    const std::vector<RenderTargetRequirements> targets = {
+        MakeTarget("History", 1000, RenderTargetLifetime::Persistent),
+        MakeTarget("Early", 1000),
+        MakeTarget("Late", 1000),
+    };
+
+    // The history is read before this frame writes it, which is what persistent targets are for
+    const std::vector<RenderPassUsage> passes = {
+        { "early", { "History" }, { "Early" }, {} },
+        { "use early", { "Early" }, {}, {} },
+        { "late", {}, { "Late", "History" }, {} },
+        { "use late", { "Late" }, {}, {} },
+    };
+
+    RenderTargetPlan plan;
+    std::string error;
+    REQUIRE(PlanRenderTargets(targets, passes, plan, error));
+    REQUIRE(IsValidPlan(targets, plan));
+
+    // Live over the whole frame, so it never shares memory with the transient targets that share it among themselves
+    const RenderTargetPlacement& history = plan.placements[0];
+    CHECK(history.firstPass == 0 && history.lastPass == 3);
+    CHECK(!history.aliased && !history.needsClear);
+    CHECK(plan.placements[1].offset == plan.placements[2].offset);
+    CHECK(plan.placements[1].aliased && plan.placements[2].aliased);
+    CHECK(plan.heapSize == 2000);
+
+    // Used only in the last pass, a persistent target is still live in every pass
+    const std::vector<RenderPassUsage> lastOnly = {
+        { "early", {}, { "Early" }, {} },
+        { "last", { "Early" }, { "History" }, {} },
+    };
+    REQUIRE(PlanRenderTargets(targets, lastOnly, plan, error));
+    CHECK(plan.placements[0].firstPass == 0 && plan.placements[0].lastPass == 1);
+}
+
+UNIT_TEST(RenderTargetLifetimes, Errors)
+{
+    const std::vector<RenderTargetRequirements> targets = { MakeTarget("A", 1000), MakeTarget("B", 1000) };
+
+    RenderTargetPlan plan;
+    std::string error;
+    CHECK(!PlanRenderTargets(targets, { { "read A", { "A" }, {}, {} } }, plan, error));
+    CHECK(error.find("'A'") != std::string::npos);
+
+    // Written by a later pass is still read before write
+    error.clear();
+    CHECK(!PlanRenderTargets(targets, { { "read A", { "A" }, { "B" }, {} }, { "write A", {}, { "A" }, {} } }, plan, error));
+    CHECK(!error.empty());
+
+    error.clear();
+    CHECK(!PlanRenderTargets(targets, { { "write C", {}, { "C" }, {} } }, plan, error));
+    CHECK(error.find("'C'") != std::string::npos);
+
+    // Reading what the same pass writes or clears is fine
+    CHECK(PlanRenderTargets(targets, { { "read write A", { "A" }, { "A" }, {} }, { "read clear B", { "B" }, {}, { "B" } } }, plan, error));
+    CHECK(PlanRenderTargets(targets, {}, plan, error));
+    CHECK(plan.usedCount == 0 && plan.heapSize == 0);
+}
+
+UNIT_TEST(RenderTargetLifetimes, RandomFrames)
+{
+    std::mt19937 random(5);
+    const char* const names[] = { "T0", "T1", "T2", "T3", "T4", "T5", "T6", "T7", "T8", "T9" };
+
+    for (int frame = 0; frame < 200; frame++)
+    {
+        std::vector<RenderTargetRequirements> targets;
+        for (const char* name : names)
+        {
+            const uint64_t alignment = uint64_t(1) << (random() % 8);
+            const RenderTargetLifetime lifetime = random() % 4 == 0 ? RenderTargetLifetime::Persistent : RenderTargetLifetime::Transient;
+            targets.push_back(MakeTarget(name, 1 + random() % 5000, lifetime, alignment));
+        }
+
+        // Every pass writes one target and reads some that were written before
+        std::vector<RenderPassUsage> passes;
+        std::vector<std::string> written;
+        for (int pass = 0; pass < 8; pass++)
+        {
+            RenderPassUsage usage;
+            usage.name = "pass " + std::to_string(pass);
+            for (const std::string& name : written)
+            {
+                if (random() % 3 == 0)
+                    usage.reads.push_back(name);
+            }
+            const std::string target = names[random() % 10];
+            (random() % 2 ? usage.writes : usage.clears).push_back(target);
+            written.push_back(target);
+            passes.push_back(usage);
+        }
+
+        RenderTargetPlan plan;
+        std::string error;
+        REQUIRE(PlanRenderTargets(targets, passes, plan, error));
+        CHECK(IsValidPlan(targets, plan));
+        CHECK(plan.heapSize <= plan.usedBytes + 10 * 128);
+    }
+}
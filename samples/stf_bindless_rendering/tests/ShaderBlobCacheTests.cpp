@@ -0,0 +1,212 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../ShaderBlobCache.h"
+
+#include <cstring>
+#include <fstream>
+
+static std::string MakeBlob(size_t size, uint8_t seed)
+{
+    std::string blob(size, '\0');
+    for (size_t i = 0; i < size; i++)
+        blob[i] = char(uint8_t(seed + i * 31));
+    return blob;
+}
+
+static bool ViewEquals(const ShaderBlobView& view, const std::string& data, const std::string& reflection)
+{
+    return view && view.size == data.size() && memcmp(view.data, data.data(), data.size()) == 0 &&
+        view.reflectionSize == reflection.size() && (reflection.empty() || memcmp(view.reflection, reflection.data(), reflection.size()) == 0);
+}
+
+static void WriteTextFile(const std::filesystem::path& fileName, const std::string& text)
+{
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    file << text;
+}
+
+UNIT_TEST(ShaderBlobCache, IndexRoundTrip)
+{
+    const std::filesystem::path fileName = GetUnitTestDirectory("IndexRoundTrip") / "blobs.bin";
+
+    // Odd sizes, so that the key, blob and index alignment all get exercised
+    const int count = 37;
+    std::string error;
+    {
+        ShaderBlobCache cache(fileName);
+        for (int i = 0; i < count; i++)
+        {
+            const std::string data = MakeBlob(size_t(1 + i * 13), uint8_t(i));
+            const std::string reflection = i % 3 ? MakeBlob(size_t(i), uint8_t(100 + i)) : std::string();
+            cache.Store("key " + std::to_string(i), data.data(), data.size(), reflection.empty() ? nullptr : reflection.data(), reflection.size());
+        }
+        REQUIRE(cache.Flush(error));
+    }
+
+    ShaderBlobCache cache(fileName);
+    for (int i = 0; i < count; i++)
+    {
+        const std::string data = MakeBlob(size_t(1 + i * 13), uint8_t(i));
+        const std::string reflection = i % 3 ? MakeBlob(size_t(i), uint8_t(100 + i)) : std::string();
+        const ShaderBlobView view = cache.Find("key " + std::to_string(i));
+        CHECK(ViewEquals(view, data, reflection));
+        CHECK(uintptr_t(view.data) % 16 == 0);
+    }
+
+    const ShaderBlobCacheStats stats = cache.GetStats();
+    CHECK(stats.entries == uint32_t(count));
+    CHECK(stats.hits == uint32_t(count));
+    CHECK(stats.misses == 0);
+}
+
+UNIT_TEST(ShaderBlobCache, MissAndHit)
+{
+    const std::filesystem::path fileName = GetUnitTestDirectory("MissAndHit") / "blobs.bin";
+    const std::string data = MakeBlob(100, 7);
+    std::string error;
+
+    ShaderBlobCache cache(fileName);
+    CHECK(!cache.Find("missing"));
+    CHECK(cache.GetStats().misses == 1);
+
+    // Pending blobs are found before the flush, mapped ones after it
+    cache.Store("present", data.data(), data.size(), nullptr, 0);
+    CHECK(ViewEquals(cache.Find("present"), data, std::string()));
+    REQUIRE(cache.Flush(error));
+    CHECK(ViewEquals(cache.Find("present"), data, std::string()));
+    CHECK(!cache.Find("missing"));
+
+    // A second flush merges new blobs with the ones on disk and replaces stored keys
+    const std::string replacement = MakeBlob(50, 9);
+    cache.Store("present", replacement.data(), replacement.size(), nullptr, 0);
+    cache.Store("other", data.data(), data.size(), nullptr, 0);
+    REQUIRE(cache.Flush(error));
+
+    ShaderBlobCache reopened(fileName);
+    CHECK(ViewEquals(reopened.Find("present"), replacement, std::string()));
+    CHECK(ViewEquals(reopened.Find("other"), data, std::string()));
+    CHECK(reopened.GetStats().entries == 2);
+
+    const ShaderBlobCacheStats stats = cache.GetStats();
+    CHECK(stats.hits == 2);
+    CHECK(stats.misses == 2);
+    CHECK(stats.stored == 3);
+}
+
+UNIT_TEST(ShaderBlobCache, ContainerChange)
+{
+    const std::filesystem::path directory = GetUnitTestDirectory("ContainerChange");
+
+    // Keys follow the digest of the compiled container, so a recompiled container misses every blob stored for it
+    const std::string container = MakeBlob(4096, 1);
+    std::string recompiled = container;
+    recompiled[1000] ^= 1;
+    const uint64_t digest = HashFnv1a64(container.data(), container.size());
+    const uint64_t recompiledDigest = HashFnv1a64(recompiled.data(), recompiled.size());
+    CHECK(digest != recompiledDigest);
+
+    PermutationKey permutation;
+    permutation.name = "main.hlsl";
+    permutation.entry = "main";
+    permutation.macros.Set("STF_ENABLED", "1");
+    PermutationKey otherPermutation = permutation;
+    otherPermutation.macros.Set("STF_ENABLED", "0");
+
+    const std::string oldKey = MakeShaderBlobKey(digest, "dxil", permutation);
+    const std::string newKey = MakeShaderBlobKey(recompiledDigest, "dxil", permutation);
+    CHECK(oldKey != newKey);
+    CHECK(oldKey == MakeShaderBlobKey(digest, "dxil", permutation));
+    CHECK(oldKey != MakeShaderBlobKey(digest, "spirv", permutation));
+    CHECK(oldKey != MakeShaderBlobKey(digest, "dxil", otherPermutation));
+
+    std::string error;
+    ShaderBlobCache cache(directory / "blobs.bin");
+    const std::string data = MakeBlob(64, 3);
+    cache.Store(oldKey, data.data(), data.size(), nullptr, 0);
+    REQUIRE(cache.Flush(error));
+    CHECK(cache.Find(oldKey));
+    CHECK(!cache.Find(newKey));
+}
+
+UNIT_TEST(ShaderBlobCache, FailedFlushKeepsBlobs)
+{
+    const std::filesystem::path directory = GetUnitTestDirectory("FailedFlushKeepsBlobs");
+    const std::filesystem::path fileName = directory / "blobs.bin";
+    const std::string data = MakeBlob(100, 11);
+    const std::string newData = MakeBlob(70, 12);
+    std::string error;
+
+    ShaderBlobCache cache(fileName);
+    cache.Store("old", data.data(), data.size(), nullptr, 0);
+    REQUIRE(cache.Flush(error));
+    CHECK(ViewEquals(cache.Find("old"), data, std::string()));
+
+    // A directory in place of the pack makes the rename fail: the pending blob and the mapped ones stay available
+    std::filesystem::rename(fileName, directory / "saved.bin");
+    std::filesystem::create_directories(fileName / "blocker");
+    cache.Store("new", newData.data(), newData.size(), nullptr, 0);
+    CHECK(!cache.Flush(error));
+    CHECK(!error.empty());
+    CHECK(ViewEquals(cache.Find("new"), newData, std::string()));
+    CHECK(ViewEquals(cache.Find("old"), data, std::string()));
+    CHECK(!std::filesystem::exists(fileName.generic_string() + ".tmp"));
+
+    // The next flush writes both
+    std::filesystem::remove_all(fileName);
+    REQUIRE(cache.Flush(error));
+
+    ShaderBlobCache reopened(fileName);
+    CHECK(ViewEquals(reopened.Find("old"), data, std::string()));
+    CHECK(ViewEquals(reopened.Find("new"), newData, std::string()));
+}
+
+UNIT_TEST(ShaderBlobCache, TruncatedFile)
+{
+    const std::filesystem::path fileName = GetUnitTestDirectory("TruncatedFile") / "blobs.bin";
+    const std::string data = MakeBlob(1000, 5);
+    std::string error;
+    {
+        ShaderBlobCache cache(fileName);
+        for (int i = 0; i < 8; i++)
+            cache.Store("key " + std::to_string(i), data.data(), data.size(), nullptr, 0);
+        REQUIRE(cache.Flush(error));
+    }
+
+    const uintmax_t fileSize = std::filesystem::file_size(fileName);
+    for (const uintmax_t size : { fileSize - 1, fileSize / 2, uintmax_t(30), uintmax_t(10), uintmax_t(0) })
+    {
+        std::filesystem::resize_file(fileName, size);
+
+        // A truncated pack reads as empty, and the next flush replaces it with a valid one
+        ShaderBlobCache cache(fileName);
+        CHECK(!cache.Find("key 0"));
+        CHECK(cache.GetStats().entries == 0);
+
+        cache.Store("key 0", data.data(), data.size(), nullptr, 0);
+        REQUIRE(cache.Flush(error));
+
+        ShaderBlobCache reopened(fileName);
+        CHECK(ViewEquals(reopened.Find("key 0"), data, std::string()));
+        CHECK(reopened.GetStats().entries == 1);
+
+        // Restore the full pack for the next size
+        ShaderBlobCache full(fileName);
+        for (int i = 0; i < 8; i++)
+            full.Store("key " + std::to_string(i), data.data(), data.size(), nullptr, 0);
+        REQUIRE(full.Flush(error));
+    }
+
+    // A file that is not a pack at all
+    WriteTextFile(fileName, std::string(4096, 'x'));
+    ShaderBlobCache cache(fileName);
+    CHECK(!cache.Find("key 0"));
+}
@@ -0,0 +1,260 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../ShaderPermutationCache.h"
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
+struct StubArtifact : public PermutationArtifact
+{
+    std::string id;
+    std::vector<std::string> dependencies;
+};
+
+// Stands in for the shader compiler and pipeline creation: records every build, fails keys named "fail",
+// and can hold builds until released to test what happens to builds in flight
+class StubPermutationBuilder : public IPermutationBuilder
+{
+public:
+    std::shared_ptr<PermutationArtifact> Build(const PermutationKey& key, const std::vector<std::shared_ptr<PermutationArtifact>>& dependencies) override
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Builds[key.ToString()]++;
+        m_Started++;
+        m_Changed.notify_all();
+        m_Changed.wait(lock, [this]() { return !m_Hold; });
+
+        if (key.name == "fail")
+            return nullptr;
+
+        auto artifact = std::make_shared<StubArtifact>();
+        artifact->id = key.ToString();
+        for (const std::shared_ptr<PermutationArtifact>& dependency : dependencies)
+            artifact->dependencies.push_back(dependency ? static_cast<StubArtifact*>(dependency.get())->id : std::string());
+        return artifact;
+    }
+
+    bool IsThreadSafe() const override { return true; }
+
+    uint32_t GetBuildCount(const PermutationKey& key)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Builds[key.ToString()];
+    }
+
+    void Hold()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Hold = true;
+    }
+
+    void Release()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Hold = false;
+        m_Changed.notify_all();
+    }
+
+    void WaitForStartedBuilds(uint32_t count)
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Changed.wait(lock, [this, count]() { return m_Started >= count; });
+    }
+
+private:
+    std::mutex m_Mutex;
+    std::condition_variable m_Changed;
+    std::map<std::string, uint32_t> m_Builds;
+    uint32_t m_Started = 0;
+    bool m_Hold = false;
+};
+
+static PermutationKey MakeShaderKey(const char* name, const char* entry, ShaderMacroSet macros)
+{
+    PermutationKey key;
+    key.kind = PermutationKind::Shader;
+    key.name = name;
+    key.entry = entry;
+    key.macros = std::move(macros);
+    return key;
+}
+
+static PermutationKey MakePipelineKey(const char* name, std::vector<PermutationKey> dependencies)
+{
+    PermutationKey key;
+    key.kind = PermutationKind::Pipeline;
+    key.name = name;
+    key.dependencies = std::move(dependencies);
+    return key;
+}
+
+static const StubArtifact* GetStub(const std::shared_ptr<PermutationArtifact>& artifact)
+{
+    return static_cast<const StubArtifact*>(artifact.get());
+}
+
+UNIT_TEST(ShaderPermutationCache, Keying)
+{
+    // Macro order does not matter, setting a macro again replaces its value
+    const ShaderMacroSet macros = { { "STF_LOAD", "1" }, { "STF_ENABLED", "1" } };
+    ShaderMacroSet reordered;
+    reordered.Set("STF_ENABLED", "0");
+    reordered.Set("STF_LOAD", "1");
+    reordered.Set("STF_ENABLED", "1");
+    CHECK(macros == reordered);
+    REQUIRE(macros.Find("STF_LOAD"));
+    CHECK(*macros.Find("STF_LOAD") == "1");
+    CHECK(!macros.Find("MISSING"));
+
+    const PermutationKey key = MakeShaderKey("app/stf.hlsl", "main", macros);
+    CHECK(key.ToString() == MakeShaderKey("app/stf.hlsl", "main", reordered).ToString());
+    CHECK(key.Hash() == MakeShaderKey("app/stf.hlsl", "main", reordered).Hash());
+
+    // Every part of the key makes it distinct
+    PermutationKey library = key;
+    library.kind = PermutationKind::ShaderLibrary;
+    const PermutationKey otherEntry = MakeShaderKey("app/stf.hlsl", "other", macros);
+    const PermutationKey otherValue = MakeShaderKey("app/stf.hlsl", "main", { { "STF_LOAD", "0" }, { "STF_ENABLED", "1" } });
+    const PermutationKey fewerMacros = MakeShaderKey("app/stf.hlsl", "main", { { "STF_ENABLED", "1" } });
+    const PermutationKey pipeline = MakePipelineKey("compute", { key });
+    const PermutationKey otherPipeline = MakePipelineKey("compute", { otherValue });
+
+    const std::vector<PermutationKey> keys = { key, library, otherEntry, otherValue, fewerMacros, pipeline, otherPipeline };
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        for (size_t j = i + 1; j < keys.size(); j++)
+        {
+            CHECK(keys[i].ToString() != keys[j].ToString());
+            CHECK(keys[i].Hash() != keys[j].Hash());
+        }
+    }
+
+    // Equal keys share one cache entry and one build
+    auto builder = std::make_shared<StubPermutationBuilder>();
+    PermutationCache cache(builder, 2);
+    REQUIRE(cache.Wait(key));
+    CHECK(cache.Request(MakeShaderKey("app/stf.hlsl", "main", reordered)) != nullptr);
+    CHECK(cache.Request(otherValue) == nullptr);
+    cache.WaitIdle();
+    CHECK(builder->GetBuildCount(key) == 1);
+    CHECK(builder->GetBuildCount(otherValue) == 1);
+    CHECK(cache.GetStatus(otherValue) == PermutationStatus::Ready);
+    CHECK(cache.GetStatus(fewerMacros) == PermutationStatus::Missing);
+
+    const PermutationCacheStats stats = cache.GetStats();
+    CHECK(stats.built == 2);
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 1);
+}
+
+UNIT_TEST(ShaderPermutationCache, Dependencies)
+{
+    auto builder = std::make_shared<StubPermutationBuilder>();
+    PermutationCache cache(builder, 2);
+
+    const PermutationKey library = MakeShaderKey("app/stf.hlsl", "", { { "STF_ENABLED", "1" } });
+    const PermutationKey hitGroup = MakeShaderKey("app/hit.hlsl", "", {});
+    const PermutationKey raygen = MakePipelineKey("raygen", { library, hitGroup });
+
+    // Held builds: the pipeline waits for both shaders, which wait in the queue
+    builder->Hold();
+    CHECK(cache.Request(raygen) == nullptr);
+    CHECK(cache.GetStatus(raygen) == PermutationStatus::WaitingForDependencies);
+    builder->Release();
+
+    // The pipeline gets its dependencies' artifacts in key order, shaders are built once for all pipelines using them
+    const std::shared_ptr<PermutationArtifact> artifact = cache.Wait(raygen);
+    REQUIRE(artifact);
+    REQUIRE(GetStub(artifact)->dependencies.size() == 2);
+    CHECK(GetStub(artifact)->dependencies[0] == library.ToString());
+    CHECK(GetStub(artifact)->dependencies[1] == hitGroup.ToString());
+    CHECK(cache.GetStatus(library) == PermutationStatus::Ready);
+
+    const PermutationKey otherRaygen = MakePipelineKey("raygen", { library, MakeShaderKey("app/hit.hlsl", "", { { "ALPHA", "1" } }) });
+    REQUIRE(cache.Wait(otherRaygen));
+    CHECK(builder->GetBuildCount(library) == 1);
+    CHECK(builder->GetBuildCount(raygen) == 1);
+
+    // A failed dependency fails its dependents without building them, also when it had already failed
+    const PermutationKey failing = MakeShaderKey("fail", "main", {});
+    const PermutationKey broken = MakePipelineKey("compute", { failing });
+    CHECK(!cache.Wait(broken));
+    CHECK(cache.GetStatus(failing) == PermutationStatus::Failed);
+    CHECK(cache.GetStatus(broken) == PermutationStatus::Failed);
+    CHECK(builder->GetBuildCount(broken) == 0);
+
+    const PermutationKey alsoBroken = MakePipelineKey("compute", { library, failing });
+    CHECK(cache.Request(alsoBroken) == nullptr);
+    CHECK(cache.GetStatus(alsoBroken) == PermutationStatus::Failed);
+    CHECK(builder->GetBuildCount(failing) == 1);
+}
+
+UNIT_TEST(ShaderPermutationCache, Invalidation)
+{
+    auto builder = std::make_shared<StubPermutationBuilder>();
+    PermutationCache cache(builder, 1);
+
+    const PermutationKey shader = MakeShaderKey("app/stf.hlsl", "main", { { "STF_ENABLED", "1" } });
+    const PermutationKey pipeline = MakePipelineKey("compute", { shader });
+    REQUIRE(cache.Wait(pipeline));
+
+    // Invalidation drops every artifact, the next request rebuilds the pipeline and its shaders
+    cache.Invalidate();
+    CHECK(cache.GetStatus(pipeline) == PermutationStatus::Missing);
+    CHECK(cache.GetStatus(shader) == PermutationStatus::Missing);
+    CHECK(cache.Request(pipeline) == nullptr);
+    REQUIRE(cache.Wait(pipeline));
+    CHECK(builder->GetBuildCount(shader) == 2);
+    CHECK(builder->GetBuildCount(pipeline) == 2);
+
+    // A build in flight when the cache is invalidated is discarded when it finishes
+    const PermutationKey other = MakeShaderKey("app/other.hlsl", "main", {});
+    builder->Hold();
+    cache.Prewarm({ other });
+    builder->WaitForStartedBuilds(5);
+    cache.Invalidate();
+    builder->Release();
+    cache.WaitIdle();
+    CHECK(cache.GetStatus(other) == PermutationStatus::Missing);
+
+    REQUIRE(cache.Wait(other));
+    CHECK(builder->GetBuildCount(other) == 2);
+}
+
+UNIT_TEST(ShaderPermutationCache, ParseShaderConfig)
+{
+    std::vector<ShaderConfigPermutation> permutations;
+    std::string error;
+    REQUIRE(ParseShaderConfig(
+        "# comment\n"
+        "stf.hlsl -T cs -D STF_ENABLED={0,1} -D STF_LOAD={0,1} // trailing comment\n"
+        "\n"
+        "lib.hlsl -T lib -E RayGen -D ALPHA\n", permutations, error));
+
+    REQUIRE(permutations.size() == 5);
+    CHECK(permutations[0].file == "stf.hlsl" && permutations[0].target == "cs" && permutations[0].entry == "main");
+    CHECK(permutations[4].entry == "RayGen" && permutations[4].target == "lib");
+    REQUIRE(permutations[4].macros.Find("ALPHA"));
+    CHECK(*permutations[4].macros.Find("ALPHA") == "1");
+
+    // Every combination of the alternatives, once
+    std::map<std::string, int> combinations;
+    for (size_t i = 0; i < 4; i++)
+        combinations[*permutations[i].macros.Find("STF_ENABLED") + *permutations[i].macros.Find("STF_LOAD")]++;
+    CHECK(combinations.size() == 4);
+
+    permutations.clear();
+    CHECK(!ParseShaderConfig("stf.hlsl -D STF_ENABLED=1\n", permutations, error));
+    CHECK(!error.empty());
+    CHECK(!ParseShaderConfig("stf.hlsl -T cs -D STF_ENABLED={0,1\n", permutations, error));
+}
@@ -0,0 +1,147 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../StfCpuSampler.h"
+
+#include <cstdint>
+#include <utility>
+
+using namespace donut::math;
+
+// 64x64, the left half one color and the right half random texels
+static StfCpuTexture CreateHalfConstantTexture()
+{
+    CpuImage image;
+    image.width = 64;
+    image.height = 64;
+    image.rgba.resize(64 * 64 * 4);
+
+    uint32_t seed = 11;
+    for (uint32_t y = 0; y < 64; y++)
+    {
+        for (uint32_t x = 0; x < 64; x++)
+        {
+            for (uint32_t channel = 0; channel < 4; channel++)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                image.rgba[(y * 64 + x) * 4 + channel] = x < 32 ? uint8_t(40 + channel) : uint8_t(seed >> 24);
+            }
+        }
+    }
+    return StfCpuTexture(std::move(image));
+}
+
+static float NextRandom(uint32_t& seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return float(seed >> 8) / float(1u << 24);
+}
+
+// Brute force: all texels of the rectangle equal its first one
+static bool AreTexelsEqual(const StfCpuTexture& texture, uint32_t mip, int2 minTexel, int2 maxTexel)
+{
+    const float4 first = texture.Load(mip, minTexel);
+    for (int y = minTexel.y; y <= maxTexel.y; y++)
+        for (int x = minTexel.x; x <= maxTexel.x; x++)
+            if (any(texture.Load(mip, int2(x, y)) != first))
+                return false;
+    return true;
+}
+
+UNIT_TEST(StfConstantFootprint, Blocks)
+{
+    const StfCpuTexture texture = CreateHalfConstantTexture();
+
+    // Random rectangles, also larger than the 17 texels that always fit into a block of the coarsest level
+    uint32_t seed = 3;
+    uint32_t constantCount = 0;
+    for (uint32_t test = 0; test < 4000; test++)
+    {
+        const uint32_t mip = uint32_t(NextRandom(seed) * 3.f);
+        const int2 size = texture.GetSize(mip);
+        const int2 extent = min(int2(1 + int(NextRandom(seed) * 20.f), 1 + int(NextRandom(seed) * 20.f)), size);
+        const int2 minTexel = int2(int(NextRandom(seed) * float(size.x - extent.x + 1)), int(NextRandom(seed) * float(size.y - extent.y + 1)));
+        const int2 maxTexel = minTexel + extent - 1;
+
+        const bool constant = texture.IsConstant(mip, minTexel, maxTexel);
+        constantCount += constant ? 1 : 0;
+
+        // Never constant where the texels differ
+        CHECK(!constant || AreTexelsEqual(texture, mip, minTexel, maxTexel));
+    }
+    CHECK(constantCount > 0);
+
+    // Rectangles whose block lies inside the constant half are found
+    CHECK(texture.IsConstant(0, int2(0, 0), int2(16, 16)));
+    CHECK(texture.IsConstant(0, int2(3, 40), int2(19, 41)));
+    CHECK(texture.IsConstant(1, int2(2, 5), int2(10, 13)));
+
+    // One column of noise is enough to break the block
+    CHECK(!texture.IsConstant(0, int2(28, 8), int2(32, 9)));
+
+    // Conservative: a constant rectangle whose block reaches into the noise is not found
+    CHECK(!texture.IsConstant(1, int2(0, 0), int2(15, 31)));
+}
+
+UNIT_TEST(StfConstantFootprint, EarlyOut)
+{
+    const StfCpuTexture texture = CreateHalfConstantTexture();
+    const float4 constantValue = texture.Load(0, int2(0, 0));
+
+    // Every tap the sampler can take for any random numbers has the value of the constant tap
+    uint32_t seed = 5;
+    uint32_t earlyOuts = 0;
+    for (uint32_t filterType : { uint32_t(STF_FILTER_TYPE_LINEAR), uint32_t(STF_FILTER_TYPE_CUBIC), uint32_t(STF_FILTER_TYPE_GAUSSIAN) })
+    {
+        for (uint32_t test = 0; test < 200; test++)
+        {
+            StfCpuSamplerState state;
+            state.filterType = filterType;
+            state.addressMode = test % 2 ? STF_ADDRESS_MODE_WRAP : STF_ADDRESS_MODE_CLAMP;
+            state.anisoMethod = test % 3 ? STF_ANISO_LOD_METHOD_DEFAULT : STF_ANISO_LOD_METHOD_NONE;
+
+            const float2 uv = float2(NextRandom(seed) * 0.6f - 0.05f, NextRandom(seed));
+            const float2 ddx = float2(NextRandom(seed), NextRandom(seed) * 0.2f) * (4.f / 64.f);
+            const float2 ddy = float2(NextRandom(seed) * 0.2f, NextRandom(seed)) * (2.f / 64.f);
+
+            StfCpuTap constantTap;
+            if (!state.GetConstantTapGrad(texture, uv, ddx, ddy, constantTap))
+                continue;
+            earlyOuts++;
+
+            const float4 value = texture.Load(constantTap);
+            bool agrees = true;
+            for (uint32_t draw = 0; draw < 64; draw++)
+            {
+                state.u = float4(NextRandom(seed), NextRandom(seed), NextRandom(seed), NextRandom(seed));
+                agrees = agrees && all(texture.Load(state.GetTapGrad(texture, uv, ddx, ddy)) == value);
+            }
+            CHECK(agrees);
+        }
+    }
+    CHECK(earlyOuts > 0);
+
+    // The early-out returns the value without drawing new random numbers, other samples draw them
+    StfCpuSamplerState state;
+    state.constantFootprints = true;
+    state.reseedOnSample = true;
+    state.u = float4(0.25f);
+    CHECK(all(state.SampleGrad(texture, float2(0.2f, 0.5f), float2(1.f / 64.f, 0.f), float2(0.f, 1.f / 64.f)) == constantValue));
+    CHECK(all(state.u == float4(0.25f)));
+
+    state.SampleGrad(texture, float2(0.8f, 0.5f), float2(1.f / 64.f, 0.f), float2(0.f, 1.f / 64.f));
+    CHECK(any(state.u != float4(0.25f)));
+
+    // Custom kernels never take it
+    state.filterKernelEnabled = true;
+    StfCpuTap tap;
+    CHECK(!state.GetConstantTapGrad(texture, float2(0.2f, 0.5f), float2(1.f / 64.f, 0.f), float2(0.f, 1.f / 64.f), tap));
+}
@@ -0,0 +1,199 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../StfCpuSampler.h"
+
+#include <cstdint>
+
+using namespace donut::math;
+
+// Random texels, every texture of a test differs in content
+static StfCpuTexture CreateNoiseTexture(uint32_t width, uint32_t height, uint32_t seed)
+{
+    CpuImage image;
+    image.width = width;
+    image.height = height;
+    image.rgba.resize(size_t(width) * height * 4);
+    for (uint8_t& value : image.rgba)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        value = uint8_t(seed >> 24);
+    }
+    return StfCpuTexture(std::move(image));
+}
+
+static float NextRandom(uint32_t& seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return float(seed >> 8) / float(1u << 24);
+}
+
+static bool IsInside(const StfCpuTexture& texture, const StfCpuTap& tap)
+{
+    const int2 size = texture.GetSize(tap.mip);
+    return tap.texel.x >= 0 && tap.texel.y >= 0 && tap.texel.x < size.x && tap.texel.y < size.y;
+}
+
+UNIT_TEST(StfCpuSampler, SharedFootprintMatchesUnshared)
+{
+    // Two textures of one footprint class and one of another
+    const StfCpuTexture textures[] = { CreateNoiseTexture(16, 16, 1), CreateNoiseTexture(16, 16, 2), CreateNoiseTexture(8, 16, 3) };
+
+    uint32_t seed = 7;
+    for (uint32_t addressMode : { uint32_t(STF_ADDRESS_MODE_WRAP), uint32_t(STF_ADDRESS_MODE_CLAMP) })
+    {
+        for (uint32_t sample = 0; sample < 256; sample++)
+        {
+            StfCpuSamplerState state;
+            state.addressMode = addressMode;
+            state.filterType = sample % 2 ? STF_FILTER_TYPE_CUBIC : STF_FILTER_TYPE_LINEAR;
+            state.u = float4(NextRandom(seed), NextRandom(seed), NextRandom(seed), NextRandom(seed));
+
+            // Texture coordinates up to two repeats outside [0, 1], the sample positions leave the mips
+            const float2 uv = float2(NextRandom(seed), NextRandom(seed)) * 5.f - 2.f;
+            const float2 ddx = float2(NextRandom(seed) * 0.1f, 0.f);
+            const float2 ddy = float2(0.f, NextRandom(seed) * 0.1f);
+
+            StfCpuSharedFootprint footprint(state, uv, ddx, ddy);
+            for (const StfCpuTexture& texture : textures)
+            {
+                const StfCpuTap shared = footprint.GetTap(texture);
+                const StfCpuTap unshared = state.GetTapGrad(texture, uv, ddx, ddy);
+                CHECK(IsInside(texture, shared));
+                CHECK(shared.mip == unshared.mip);
+                CHECK(all(shared.texel == unshared.texel));
+
+                StfCpuSamplerState unsharedState = state;
+                const float4 value = footprint.Sample(texture);
+                CHECK(all(value == unsharedState.SampleGrad(texture, uv, ddx, ddy)));
+            }
+            CHECK(footprint.GetFootprintCount() == 2);
+        }
+    }
+}
+
+UNIT_TEST(StfCpuSampler, SharedFootprintAddressMode)
+{
+    const StfCpuTexture texture = CreateNoiseTexture(16, 16, 4);
+
+    StfCpuSamplerState state;
+    state.u = float4(0.5f, 0.5f, 0.5f, 0.f);
+
+    // The texel center 3 left of and 1 below the texture: wraps to the far side, or clamps to the edge
+    const float2 uv = float2(-2.5f, 17.5f) / 16.f;
+    state.addressMode = STF_ADDRESS_MODE_WRAP;
+    CHECK(all(StfCpuSharedFootprint(state, uv, 0.f).GetTap(texture).texel == int2(13, 1)));
+
+    state.addressMode = STF_ADDRESS_MODE_CLAMP;
+    CHECK(all(StfCpuSharedFootprint(state, uv, 0.f).GetTap(texture).texel == int2(0, 15)));
+}
+
+// Two quads of magnified lanes, each quad inside one bilinear footprint. quadUvs are texel positions of the base level.
+static void SetupWave(StfCpuWaveLane (&lanes)[8], StfCpuSamplerState (&states)[8], float2 quad0, float2 quad1)
+{
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        const float2 quad = i < 4 ? quad0 : quad1;
+        states[i] = StfCpuSamplerState();
+        states[i].u = float4(0.3f, 0.6f, 0.2f, 0.f);
+        lanes[i] = StfCpuWaveLane();
+        lanes[i].state = &states[i];
+        lanes[i].uv = (quad + float2(float(i % 2), float((i / 2) % 2)) * 0.25f) / 16.f;
+        lanes[i].ddx = float2(0.25f / 16.f, 0.f);
+        lanes[i].ddy = float2(0.f, 0.25f / 16.f);
+    }
+}
+
+static StfSamplingCounters SampleWave(const StfCpuTexture& texture, uint32_t magMethod, bool includeHelperLanes, StfCpuWaveLane (&lanes)[8])
+{
+    StfSamplingCounters stats;
+    StfCpuSampleWaveGrad(texture, magMethod, includeHelperLanes, lanes, 8, stats);
+    return stats;
+}
+
+UNIT_TEST(StfCpuSampler, WaveMagnification)
+{
+    const StfCpuTexture texture = CreateNoiseTexture(16, 16, 5);
+    StfCpuWaveLane lanes[8];
+    StfCpuSamplerState states[8];
+
+    // Quads 6 texels apart: each quad shares its 2x2 texels, the wave union of 8x8 texels does not fit
+    SetupWave(lanes, states, float2(4.6f), float2(10.6f));
+    StfSamplingCounters stats = SampleWave(texture, STF_MAGNIFICATION_METHOD_NONE, false, lanes);
+    CHECK(stats.samples == 8 && stats.magnifiedSamples == 8 && stats.fallbackSamples == 8 && stats.waves == 1);
+
+    stats = SampleWave(texture, STF_MAGNIFICATION_METHOD_MIN_MAX, false, lanes);
+    CHECK(stats.waveFilteredSamples == 0 && stats.fallbackSamples == 8);
+
+    for (uint32_t magMethod : { uint32_t(STF_MAGNIFICATION_METHOD_MIN_MAX_V2), uint32_t(STF_MAGNIFICATION_METHOD_2x2_QUAD) })
+    {
+        SetupWave(lanes, states, float2(4.6f), float2(10.6f));
+        stats = SampleWave(texture, magMethod, false, lanes);
+        CHECK(stats.quadFilteredSamples == 8 && stats.fallbackSamples == 0);
+        CHECK(stats.texelsFetched == 8 && stats.sharingLanes == 8 && stats.distinctTexels == 8);
+
+        // Filtered lanes return the bilinear filter, not a texel
+        bool bilinear = true;
+        for (const StfCpuWaveLane& lane : lanes)
+            bilinear = bilinear && all(lane.result == SampleHardwareLevel(texture, lane.uv, 0.f));
+        CHECK(bilinear);
+    }
+
+    // Neighboring quads: a 3x2 union for 8 loading lanes
+    SetupWave(lanes, states, float2(4.6f), float2(5.6f, 4.6f));
+    stats = SampleWave(texture, STF_MAGNIFICATION_METHOD_MIN_MAX, false, lanes);
+    CHECK(stats.waveFilteredSamples == 8 && stats.fallbackSamples == 0 && stats.texelsFetched == 6);
+    CHECK(stats.GetFallbackRate() == 0.0 && stats.GetDistinctTexelsPerWave() == 6.0);
+}
+
+UNIT_TEST(StfCpuSampler, WaveHelperLanes)
+{
+    const StfCpuTexture texture = CreateNoiseTexture(16, 16, 6);
+    StfCpuWaveLane lanes[8];
+    StfCpuSamplerState states[8];
+
+    // A helper lane far from the other footprints, where its quad's triangle is not visible
+    auto setup = [&]()
+    {
+        SetupWave(lanes, states, float2(4.6f), float2(5.6f, 4.6f));
+        lanes[3].helper = true;
+        lanes[3].uv = float2(12.6f) / 16.f;
+    };
+
+    // Without [WaveOpsIncludeHelperLanes] the helper lane neither loads nor widens the union of the 7 other lanes
+    setup();
+    StfSamplingCounters stats = SampleWave(texture, STF_MAGNIFICATION_METHOD_MIN_MAX, false, lanes);
+    CHECK(stats.samples == 7 && stats.waveFilteredSamples == 7 && stats.sharingLanes == 7);
+
+    // With them its footprint breaks the union, unless the _HELPER variant keeps helper footprints out
+    setup();
+    stats = SampleWave(texture, STF_MAGNIFICATION_METHOD_MIN_MAX, true, lanes);
+    CHECK(stats.waveFilteredSamples == 0 && stats.fallbackSamples == 7);
+
+    setup();
+    stats = SampleWave(texture, STF_MAGNIFICATION_METHOD_MIN_MAX_HELPER, true, lanes);
+    CHECK(stats.waveFilteredSamples == 7 && stats.sharingLanes == 8);
+
+    // Quad methods always take the helper lanes of the quad, so quad 0 falls back while quad 1 filters
+    setup();
+    stats = SampleWave(texture, STF_MAGNIFICATION_METHOD_2x2_QUAD, false, lanes);
+    CHECK(stats.quadFilteredSamples == 4 && stats.fallbackSamples == 3);
+
+    // Lanes that returned keep their result, lanes without STF take the hardware sampler
+    setup();
+    lanes[5].participates = false;
+    lanes[5].result = float4(-1.f);
+    lanes[6].stfEnabled = false;
+    stats = SampleWave(texture, STF_MAGNIFICATION_METHOD_NONE, false, lanes);
+    CHECK(stats.samples == 5);
+    CHECK(all(lanes[5].result == float4(-1.f)));
+    CHECK(all(lanes[6].result == SampleHardwareGrad(texture, lanes[6].uv, lanes[6].ddx, lanes[6].ddy)));
+}
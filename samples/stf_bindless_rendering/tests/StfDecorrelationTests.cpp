@@ -0,0 +1,94 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+
+#include <donut/core/math/math.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace donut::math;
+
+#include "../stf_decorrelation.h"
+
+static const uint32_t c_Slots[] = {
+    STF_TEXTURE_SLOT_BASE_OR_DIFFUSE, STF_TEXTURE_SLOT_METAL_ROUGH_OR_SPECULAR, STF_TEXTURE_SLOT_EMISSIVE, STF_TEXTURE_SLOT_NORMAL,
+    STF_TEXTURE_SLOT_OCCLUSION, STF_TEXTURE_SLOT_TRANSMISSION, STF_TEXTURE_SLOT_OPACITY
+};
+
+// Distance on the unit torus, where 0 and 1 are the same random number
+static float GetTorusDistance(float3 a, float3 b)
+{
+    float3 d = abs(a - b);
+    d = min(d, float3(1.f) - d);
+    return length(d);
+}
+
+static bool IsInUnitCube(float3 u)
+{
+    return u.x >= 0.f && u.y >= 0.f && u.z >= 0.f && u.x < 1.f && u.y < 1.f && u.z < 1.f;
+}
+
+UNIT_TEST(StfDecorrelation, Rotation)
+{
+    // The base color keeps the random numbers of the pixel
+    for (float3 u : { float3(0.f), float3(0.25f, 0.5f, 0.75f), float3(0.999f) })
+        CHECK(all(DecorrelateStfRandom(u, STF_TEXTURE_SLOT_BASE_OR_DIFFUSE) == u));
+
+    // Every slot stays in [0, 1), also at the ends of the range
+    for (uint32_t slot : c_Slots)
+    {
+        for (float3 u : { float3(0.f), float3(0.5f), float3(0.99999994f) })
+        {
+            const float3 rotated = DecorrelateStfRandom(u, slot);
+            CHECK(IsInUnitCube(rotated));
+        }
+    }
+}
+
+UNIT_TEST(StfDecorrelation, KeepsStratification)
+{
+    // 64 stratified random numbers per axis stay one per stratum after the rotation of any slot, so the rotated
+    // numbers are as uniform, and as well spread, as those of the pixel
+    const uint32_t count = 64;
+    for (uint32_t slot : c_Slots)
+    {
+        std::vector<uint32_t> strata[3] = { std::vector<uint32_t>(count), std::vector<uint32_t>(count), std::vector<uint32_t>(count) };
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const float3 rotated = DecorrelateStfRandom(float3((float(i) + 0.5f) / float(count)), slot);
+            for (int axis = 0; axis < 3; axis++)
+                strata[axis][std::min(uint32_t(rotated[axis] * float(count)), count - 1)]++;
+        }
+
+        bool stratified = true;
+        for (const std::vector<uint32_t>& axis : strata)
+            stratified = stratified && std::all_of(axis.begin(), axis.end(), [](uint32_t n) { return n == 1; });
+        CHECK(stratified);
+    }
+}
+
+UNIT_TEST(StfDecorrelation, SlotOffsets)
+{
+    // The R3 offsets of the 7 slots keep every pair apart on the torus, no two slots pick the same taps
+    float minDistance = 1.f;
+    for (uint32_t a : c_Slots)
+        for (uint32_t b : c_Slots)
+            if (a < b)
+                minDistance = std::min(minDistance, GetTorusDistance(DecorrelateStfRandom(float3(0.f), a), DecorrelateStfRandom(float3(0.f), b)));
+    CHECK(minDistance > 0.3f);
+
+    // The offsets do not depend on the random numbers they rotate
+    const float3 u = float3(0.1f, 0.7f, 0.35f);
+    for (uint32_t slot : c_Slots)
+        CHECK(GetTorusDistance(DecorrelateStfRandom(u, slot) - u, DecorrelateStfRandom(float3(0.f), slot)) < 1e-5f);
+}
@@ -0,0 +1,127 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+
+#include <donut/core/math/math.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace donut::math;
+
+#include "../stf_ewa.h"
+
+static bool IsNear(float a, float b, float tolerance = 1e-4f)
+{
+    return std::abs(a - b) <= tolerance * std::max(1.f, std::abs(b));
+}
+
+// Axes in texels
+static float2 InTexels(float2 axis, float2 size)
+{
+    return axis * size;
+}
+
+UNIT_TEST(StfEwa, AxisAligned)
+{
+    const float2 size = float2(256.f, 128.f);
+
+    // 4 texels along x per pixel step in x, 1 texel along y
+    const StfEwaFootprint footprint = GetStfEwaFootprint(float2(4.f, 0.f) / size, float2(0.f, 1.f) / size, size);
+    const float2 major = InTexels(footprint.majorAxis, size);
+    const float2 minor = InTexels(footprint.minorAxis, size);
+    CHECK(IsNear(std::abs(major.x), 4.f) && IsNear(major.y, 0.f));
+    CHECK(IsNear(minor.x, 0.f) && IsNear(std::abs(minor.y), 1.f));
+    CHECK(IsNear(footprint.lod, 0.f));
+
+    // The longer derivative along y
+    const StfEwaFootprint vertical = GetStfEwaFootprint(float2(2.f, 0.f) / size, float2(0.f, 8.f) / size, size);
+    CHECK(IsNear(std::abs(InTexels(vertical.majorAxis, size).y), 8.f));
+    CHECK(IsNear(std::abs(InTexels(vertical.minorAxis, size).x), 2.f));
+    CHECK(IsNear(vertical.lod, 1.f));
+}
+
+UNIT_TEST(StfEwa, RotatedAndSkewed)
+{
+    const float2 size = float2(64.f, 64.f);
+
+    // A footprint of 8 by 2 texels rotated by 30 degrees: the axes are the rotated derivatives
+    const float angle = 0.5235988f;
+    const float2 axisX = float2(std::cos(angle), std::sin(angle));
+    const float2 axisY = float2(-std::sin(angle), std::cos(angle));
+    const StfEwaFootprint rotated = GetStfEwaFootprint(axisX * 8.f / size, axisY * 2.f / size, size);
+    const float2 major = InTexels(rotated.majorAxis, size);
+    const float2 minor = InTexels(rotated.minorAxis, size);
+    CHECK(IsNear(length(major), 8.f));
+    CHECK(IsNear(length(minor), 2.f));
+    CHECK(IsNear(std::abs(dot(major, axisX)), 8.f));
+    CHECK(IsNear(dot(major, minor), 0.f, 1e-3f));
+    CHECK(IsNear(rotated.lod, 1.f));
+
+    // Skewed derivatives (1, 0) and (1, 1): the semi-axes are the singular values of the Jacobian,
+    // major^2 + minor^2 is its squared Frobenius norm and major * minor its determinant
+    const StfEwaFootprint skewed = GetStfEwaFootprint(float2(1.f, 0.f) / size, float2(1.f, 1.f) / size, size);
+    const float skewedMajor = length(InTexels(skewed.majorAxis, size));
+    const float skewedMinor = length(InTexels(skewed.minorAxis, size));
+    CHECK(IsNear(skewedMajor * skewedMajor + skewedMinor * skewedMinor, 3.f));
+    CHECK(IsNear(skewedMajor * skewedMinor, 1.f));
+    CHECK(IsNear(skewed.lod, std::log2(skewedMinor)));
+
+    // The major axis leans along the diagonal, between the two derivatives
+    const float2 skewedDirection = normalize(InTexels(skewed.majorAxis, size));
+    CHECK(std::abs(skewedDirection.x) > 0.5f && std::abs(skewedDirection.y) > 0.5f);
+}
+
+UNIT_TEST(StfEwa, MaxAnisotropy)
+{
+    const float2 size = float2(128.f, 128.f);
+
+    // 64:1 is clamped to 16:1 by lengthening the minor axis, which moves the level of detail up
+    const StfEwaFootprint footprint = GetStfEwaFootprint(float2(64.f, 0.f) / size, float2(0.f, 1.f) / size, size);
+    CHECK(IsNear(length(InTexels(footprint.majorAxis, size)), 64.f));
+    CHECK(IsNear(length(InTexels(footprint.minorAxis, size)), 4.f));
+    CHECK(IsNear(footprint.lod, 2.f));
+
+    // Degenerate derivatives keep a finite level of detail
+    const StfEwaFootprint degenerate = GetStfEwaFootprint(float2(0.f), float2(0.f), size);
+    CHECK(std::isfinite(degenerate.lod));
+    CHECK(std::isfinite(degenerate.majorAxis.x) && std::isfinite(degenerate.majorAxis.y));
+}
+
+UNIT_TEST(StfEwa, OffsetInsideEllipse)
+{
+    const float2 size = float2(64.f, 64.f);
+    const StfEwaFootprint footprint = GetStfEwaFootprint(float2(8.f, 0.f) / size, float2(0.f, 2.f) / size, size);
+
+    // The center for u0 = 0, the edge of the ellipse for u0 towards 1
+    CHECK(IsNear(length(GetStfEwaOffset(footprint, 0.f, 0.3f)), 0.f));
+    const float2 edge = InTexels(GetStfEwaOffset(footprint, 0.9999999f, 0.f), size);
+    CHECK(IsNear(std::abs(edge.x), 8.f, 1e-3f) && IsNear(edge.y, 0.f));
+
+    // Every offset is inside the unit ellipse, and the mean squared radius is that of the truncated Gaussian
+    constexpr uint32_t sampleCount = 64;
+    double meanRadiusSquared = 0.0;
+    for (uint32_t i = 0; i < sampleCount; i++)
+    {
+        for (uint32_t j = 0; j < sampleCount; j++)
+        {
+            const float2 offset = InTexels(GetStfEwaOffset(footprint, (float(i) + 0.5f) / sampleCount, (float(j) + 0.5f) / sampleCount), size);
+            const float radiusSquared = (offset.x / 8.f) * (offset.x / 8.f) + (offset.y / 2.f) * (offset.y / 2.f);
+            CHECK(radiusSquared <= 1.f + 1e-5f);
+            meanRadiusSquared += radiusSquared / (sampleCount * sampleCount);
+        }
+    }
+
+    // E[r^2] for the density alpha exp(-alpha r^2) / (1 - exp(-alpha)) over r^2 in [0, 1]
+    const double alpha = STF_EWA_ALPHA;
+    const double expected = 1.0 / alpha - std::exp(-alpha) / (1.0 - std::exp(-alpha));
+    CHECK(std::abs(meanRadiusSquared - expected) < 1e-3);
+}
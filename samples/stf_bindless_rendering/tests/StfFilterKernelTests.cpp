@@ -0,0 +1,131 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../StfFilterKernel.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "../stf_filter_kernel_cb.h"
+
+// Expected signed weight per tap of SampleAxis at f, from a stratified sweep over u
+static void IntegrateSampleAxis(const StfFilterKernelTable& table, float f, float* expectation)
+{
+    constexpr uint32_t sampleCount = 1 << 16;
+    for (uint32_t tap = 0; tap < table.GetTapCount(); tap++)
+        expectation[tap] = 0.f;
+
+    for (uint32_t sample = 0; sample < sampleCount; sample++)
+    {
+        float weight;
+        const int offset = table.SampleAxis(f, (float(sample) + 0.5f) / float(sampleCount), weight);
+        const int tap = offset - table.GetFirstOffset();
+        if (tap < 0 || tap >= int(table.GetTapCount()))
+        {
+            CHECK(!"SampleAxis returned an offset outside the kernel");
+            continue;
+        }
+        expectation[tap] += weight / float(sampleCount);
+    }
+}
+
+UNIT_TEST(StfFilterKernel, WeightsMatchKernel)
+{
+    for (uint32_t kernel = 0; kernel < STF_FILTER_KERNEL_COUNT; kernel++)
+    {
+        const StfFilterKernelTable& table = StfFilterKernelTable::Get(kernel);
+        CHECK(table.GetKernel() == kernel);
+        CHECK(table.GetTapCount() == 2 * uint32_t(std::ceil(GetStfFilterKernelRadius(kernel))));
+
+        for (uint32_t phase = 0; phase <= STF_FILTER_KERNEL_PHASES; phase++)
+        {
+            const float f = float(phase) / float(STF_FILTER_KERNEL_PHASES);
+
+            // The normalized kernel, proportional to the kernel at the distance of every tap
+            float sum = 0.f;
+            float kernelSum = 0.f;
+            for (uint32_t tap = 0; tap < table.GetTapCount(); tap++)
+            {
+                sum += table.GetWeight(phase, tap);
+                kernelSum += EvaluateStfFilterKernel(kernel, float(table.GetFirstOffset() + int(tap)) - f);
+            }
+            CHECK(std::abs(sum - 1.f) < 1e-5f);
+
+            for (uint32_t tap = 0; tap < table.GetTapCount(); tap++)
+            {
+                const float expected = EvaluateStfFilterKernel(kernel, float(table.GetFirstOffset() + int(tap)) - f) / kernelSum;
+                CHECK(std::abs(table.GetWeight(phase, tap) - expected) < 1e-5f);
+            }
+        }
+    }
+}
+
+UNIT_TEST(StfFilterKernel, AliasTableMatchesWeights)
+{
+    for (uint32_t kernel = 0; kernel < STF_FILTER_KERNEL_COUNT; kernel++)
+    {
+        const StfFilterKernelTable& table = StfFilterKernelTable::Get(kernel);
+        const std::vector<uint32_t>& data = table.GetGpuData();
+        REQUIRE(data.size() == STF_FILTER_KERNEL_SIZE);
+        CHECK(data[0] == table.GetTapCount());
+        CHECK(int(data[1]) == table.GetFirstOffset());
+
+        for (uint32_t phase = 0; phase <= STF_FILTER_KERNEL_PHASES; phase++)
+        {
+            const uint32_t* phaseData = &data[STF_FILTER_KERNEL_HEADER + phase * STF_FILTER_KERNEL_PHASE_STRIDE];
+            float absSum;
+            memcpy(&absSum, &phaseData[0], sizeof(absSum));
+
+            // Every column keeps its tap with its probability and gives the rest to its alias
+            float selected[STF_FILTER_KERNEL_MAX_TAPS] = {};
+            for (uint32_t column = 0; column < table.GetTapCount(); column++)
+            {
+                float keep;
+                memcpy(&keep, &phaseData[1 + 2 * column], sizeof(keep));
+                const uint32_t alias = phaseData[2 + 2 * column] & 0xff;
+                REQUIRE(keep >= 0.f && keep <= 1.f);
+                REQUIRE(alias < table.GetTapCount());
+                selected[column] += keep / float(table.GetTapCount());
+                selected[alias] += (1.f - keep) / float(table.GetTapCount());
+
+                const bool negative = (phaseData[2 + 2 * column] >> 8) & 1;
+                CHECK(negative == (table.GetWeight(phase, column) < 0.f));
+            }
+
+            for (uint32_t tap = 0; tap < table.GetTapCount(); tap++)
+                CHECK(std::abs(selected[tap] - std::abs(table.GetWeight(phase, tap)) / absSum) < 1e-5f);
+        }
+    }
+}
+
+UNIT_TEST(StfFilterKernel, SampleAxisExpectation)
+{
+    for (uint32_t kernel = 0; kernel < STF_FILTER_KERNEL_COUNT; kernel++)
+    {
+        const StfFilterKernelTable& table = StfFilterKernelTable::Get(kernel);
+        float expectation[STF_FILTER_KERNEL_MAX_TAPS];
+
+        // On a phase the expectation is its kernel, in between the linear interpolation of the two phases around it
+        for (uint32_t phase = 0; phase < STF_FILTER_KERNEL_PHASES; phase += 5)
+        {
+            IntegrateSampleAxis(table, float(phase) / float(STF_FILTER_KERNEL_PHASES), expectation);
+            for (uint32_t tap = 0; tap < table.GetTapCount(); tap++)
+                CHECK(std::abs(expectation[tap] - table.GetWeight(phase, tap)) < 1e-3f);
+
+            IntegrateSampleAxis(table, (float(phase) + 0.25f) / float(STF_FILTER_KERNEL_PHASES), expectation);
+            for (uint32_t tap = 0; tap < table.GetTapCount(); tap++)
+            {
+                const float expected = 0.75f * table.GetWeight(phase, tap) + 0.25f * table.GetWeight(phase + 1, tap);
+                CHECK(std::abs(expectation[tap] - expected) < 1e-3f);
+            }
+        }
+    }
+}
@@ -0,0 +1,141 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../StfCpuSampler.h"
+
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+using namespace donut::math;
+
+static StfCpuTexture CreateNoiseTexture(uint32_t width, uint32_t height, uint32_t seed)
+{
+    CpuImage image;
+    image.width = width;
+    image.height = height;
+    image.rgba.resize(size_t(width) * height * 4);
+    for (uint8_t& value : image.rgba)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        value = uint8_t(seed >> 24);
+    }
+    return StfCpuTexture(std::move(image));
+}
+
+static float NextRandom(uint32_t& seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return float(seed >> 8) / float(1u << 24);
+}
+
+UNIT_TEST(StfMultiTap, TapCount)
+{
+    StfCpuMultiTap multiTap;
+    CHECK(!multiTap.IsEnabled() && multiTap.GetTapCount(1.f) == 1);
+
+    // Two taps from the threshold on, four from twice the threshold when allowed
+    multiTap.maxTaps = 2;
+    multiTap.threshold = 0.1f;
+    CHECK(multiTap.IsEnabled());
+    CHECK(multiTap.GetTapCount(0.05f) == 1 && multiTap.GetTapCount(0.1f) == 2 && multiTap.GetTapCount(0.5f) == 2);
+
+    multiTap.maxTaps = 4;
+    CHECK(multiTap.GetTapCount(0.05f) == 1 && multiTap.GetTapCount(0.15f) == 2 && multiTap.GetTapCount(0.2f) == 4);
+
+    multiTap.threshold = 0.f;
+    CHECK(multiTap.GetTapCount(0.f) == 4);
+
+    // The largest range of any channel, alpha included
+    CHECK(StfCpuMultiTap::GetContrast(float4(0.2f, 0.1f, 0.f, 0.5f), float4(0.3f, 0.1f, 0.25f, 0.6f)) == 0.25f);
+    CHECK(StfCpuMultiTap::GetContrast(float4(0.4f), float4(0.4f)) == 0.f);
+}
+
+UNIT_TEST(StfMultiTap, LatticeRandom)
+{
+    // The first tap keeps its random numbers, the taps of a sample put one random number into each 1 / tapCount
+    // interval of the texel choice in x and y and of the mip choice
+    uint32_t seed = 9;
+    for (uint32_t tapCount : { 2u, 4u })
+    {
+        for (uint32_t test = 0; test < 100; test++)
+        {
+            const float4 u = float4(NextRandom(seed), NextRandom(seed), NextRandom(seed), NextRandom(seed));
+            CHECK(all(StfCpuMultiTap::GetTapRandom(u, 0, tapCount) == u));
+
+            uint32_t intervals[3] = {};
+            for (uint32_t tap = 0; tap < tapCount; tap++)
+            {
+                const float4 shifted = StfCpuMultiTap::GetTapRandom(u, tap, tapCount);
+                CHECK(shifted.x >= 0.f && shifted.x < 1.f && shifted.y >= 0.f && shifted.y < 1.f && shifted.w >= 0.f && shifted.w < 1.f);
+
+                // Relative to the first tap, so the bits do not depend on where u falls
+                intervals[0] |= 1u << uint32_t(std::fmod(shifted.x - u.x + 1.f, 1.f) * float(tapCount) + 0.5f) % tapCount;
+                intervals[1] |= 1u << uint32_t(std::fmod(shifted.y - u.y + 1.f, 1.f) * float(tapCount) + 0.5f) % tapCount;
+                intervals[2] |= 1u << uint32_t(std::fmod(shifted.w - u.w + 1.f, 1.f) * float(tapCount) + 0.5f) % tapCount;
+            }
+
+            const uint32_t everyInterval = (1u << tapCount) - 1;
+            CHECK(intervals[0] == everyInterval && intervals[1] == everyInterval && intervals[2] == everyInterval);
+        }
+    }
+}
+
+UNIT_TEST(StfMultiTap, VarianceReduction)
+{
+    const StfCpuTexture texture = CreateNoiseTexture(16, 16, 12);
+
+    // A linear filter on mip 0 is unbiased against the bilinear filter, more taps reduce the error around it
+    StfCpuSamplerState state;
+    state.filterType = STF_FILTER_TYPE_LINEAR;
+
+    uint32_t seed = 21;
+    double squaredErrors[3] = {};
+    float4 sums[3] = { float4(0.f), float4(0.f), float4(0.f) };
+    const uint32_t sampleCount = 4000;
+    const float2 uv = float2(5.3f, 9.7f) / 16.f;
+    const float4 reference = SampleHardwareLevel(texture, uv, 0.f);
+
+    for (uint32_t sample = 0; sample < sampleCount; sample++)
+    {
+        state.u = float4(NextRandom(seed), NextRandom(seed), NextRandom(seed), NextRandom(seed));
+        const float4 first = texture.Load(state.GetTapLevel(texture, uv, 0.f));
+
+        const uint32_t tapCounts[3] = { 1, 2, 4 };
+        for (int i = 0; i < 3; i++)
+        {
+            uint32_t tapCount = tapCounts[i];
+            const float4 value = StfCpuMultiTap::AddTapsLevel(state, state.u, first, tapCount, texture, uv, 0.f);
+            CHECK(tapCount == tapCounts[i]);
+
+            const float4 error = value - reference;
+            squaredErrors[i] += double(dot(error, error));
+            sums[i] += value;
+        }
+    }
+
+    for (int i = 0; i < 3; i++)
+        CHECK(length(sums[i] / float(sampleCount) - reference) < 0.02f);
+    CHECK(squaredErrors[1] < 0.6 * squaredErrors[0]);
+    CHECK(squaredErrors[2] < 0.5 * squaredErrors[1]);
+
+    // A constant footprint keeps its single fetch
+    CpuImage flat;
+    flat.width = 16;
+    flat.height = 16;
+    flat.rgba.assign(16 * 16 * 4, 77);
+    const StfCpuTexture flatTexture(std::move(flat));
+
+    state.constantFootprints = true;
+    uint32_t tapCount = 4;
+    const float4 value = StfCpuMultiTap::AddTapsLevel(state, state.u, flatTexture.Load(0, int2(0, 0)), tapCount, flatTexture, uv, 0.f);
+    CHECK(tapCount == 1 && all(value == flatTexture.Load(0, int2(0, 0))));
+}
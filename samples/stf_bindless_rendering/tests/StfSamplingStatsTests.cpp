@@ -0,0 +1,125 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../StfCpuSampler.h"
+#include "../StfSamplingStats.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace donut::math;
+
+static StfSamplingCounters MakeCounters(uint64_t samples, uint64_t magnified, uint64_t fallback, uint64_t texels, uint64_t waves,
+    uint64_t distinct)
+{
+    StfSamplingCounters counters;
+    counters.samples = samples;
+    counters.magnifiedSamples = magnified;
+    counters.fallbackSamples = fallback;
+    counters.texelsFetched = texels;
+    counters.waves = waves;
+    counters.distinctTexels = distinct;
+    return counters;
+}
+
+UNIT_TEST(StfSamplingStats, Totals)
+{
+    // Nothing sampled gives rates of 0 rather than NaN
+    const StfSamplingCounters empty;
+    CHECK(empty.GetFallbackRate() == 0.0 && empty.GetTexelsPerSample() == 0.0 && empty.GetDistinctTexelsPerWave() == 0.0);
+    CHECK(empty.GetConstantRate() == 0.0 && empty.GetTapsPerSample() == 0.0);
+
+    StfSamplingStats stats;
+    CHECK(stats.IsEmpty());
+    stats.Add(0, STF_MAGNIFICATION_METHOD_NONE, MakeCounters(100, 40, 40, 100, 4, 90));
+    stats.Add(1, STF_MAGNIFICATION_METHOD_NONE, MakeCounters(50, 10, 10, 50, 2, 50));
+    stats.Add(0, STF_MAGNIFICATION_METHOD_MIN_MAX, MakeCounters(100, 40, 10, 130, 4, 60));
+    stats.Add(0, STF_MAGNIFICATION_METHOD_MIN_MAX, MakeCounters(100, 40, 30, 110, 4, 80));
+    CHECK(stats.GetEntries().size() == 3);
+
+    // Entries of one texture and method accumulate
+    const StfSamplingCounters& minMax = stats.GetEntries().at({ 0, STF_MAGNIFICATION_METHOD_MIN_MAX });
+    CHECK(minMax.samples == 200 && minMax.fallbackSamples == 40 && minMax.waves == 8);
+    CHECK(minMax.GetFallbackRate() == 0.5 && minMax.GetTexelsPerSample() == 1.2 && minMax.GetDistinctTexelsPerWave() == 17.5);
+
+    const StfSamplingCounters none = stats.GetTotal(STF_MAGNIFICATION_METHOD_NONE);
+    CHECK(none.samples == 150 && none.magnifiedSamples == 50 && none.GetFallbackRate() == 1.0);
+
+    const StfSamplingCounters total = stats.GetTotal();
+    CHECK(total.samples == 350 && total.texelsFetched == 390 && total.waves == 14 && total.distinctTexels == 280);
+
+    stats.Clear();
+    CHECK(stats.IsEmpty() && stats.GetTotal().samples == 0);
+}
+
+UNIT_TEST(StfSamplingStats, WriteCsv)
+{
+    StfSamplingStats stats;
+    stats.Add(3, STF_MAGNIFICATION_METHOD_2x2_QUAD, MakeCounters(8, 8, 2, 10, 1, 6));
+    stats.Add(7, STF_MAGNIFICATION_METHOD_MIN_MAX_V2_HELPER, MakeCounters(4, 0, 0, 4, 1, 4));
+
+    const std::filesystem::path fileName = GetUnitTestDirectory("StfSamplingStatsCsv") / "stats.csv";
+    REQUIRE(stats.WriteCsv(fileName, [](uint32_t texture) { return texture == 3 ? std::string("albedo.png") : std::string(); }));
+
+    // A header and one row per texture and method, with the index where there is no name
+    std::ifstream file(fileName);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);)
+        lines.push_back(line);
+
+    REQUIRE(lines.size() == 3);
+    CHECK(lines[0].rfind("texture,magMethod,samples,", 0) == 0);
+    CHECK(lines[1].rfind("albedo.png,Quad2x2,8,8,0,0,2,10,", 0) == 0);
+    CHECK(lines[2].rfind("7,MinMaxV2Helper,4,0,", 0) == 0);
+
+    CHECK(std::string(GetStfMagMethodName(STF_MAGNIFICATION_METHOD_NONE)) == "Default");
+    CHECK(std::string(GetStfMagMethodName(100)) == "Unknown");
+}
+
+UNIT_TEST(StfSamplingStats, WaveCounters)
+{
+    // A quad minifying a 4x4 texture down to its 1x1 mip: one tap per lane, all of the same texel
+    CpuImage image;
+    image.width = 4;
+    image.height = 4;
+    image.rgba.assign(4 * 4 * 4, 128);
+    const StfCpuTexture texture(std::move(image));
+
+    StfCpuSamplerState states[4];
+    StfCpuWaveLane lanes[4];
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        lanes[i].state = &states[i];
+        lanes[i].uv = float2(0.125f + 0.25f * float(i), 0.5f);
+        lanes[i].ddx = float2(1.f, 0.f);
+        lanes[i].ddy = float2(0.f, 1.f);
+    }
+    lanes[3].helper = true;
+
+    // Helper lanes fetch but are not samples, and a texel fetched by several lanes is one distinct texel of the wave
+    StfSamplingCounters counters;
+    std::vector<StfCpuTap> fetches;
+    StfCpuSampleWaveGrad(texture, STF_MAGNIFICATION_METHOD_MIN_MAX, false, lanes, 4, counters, &fetches);
+    CHECK(counters.samples == 3 && counters.magnifiedSamples == 0 && counters.fallbackSamples == 0);
+    CHECK(counters.texelsFetched == 4 && fetches.size() == 4);
+    CHECK(counters.waves == 1 && counters.distinctTexels == 1);
+    CHECK(counters.GetTexelsPerSample() == 4.0 / 3.0);
+
+    // A wave without STF lanes is not counted
+    StfSamplingCounters hardware;
+    for (StfCpuWaveLane& lane : lanes)
+        lane.stfEnabled = false;
+    StfCpuSampleWaveGrad(texture, STF_MAGNIFICATION_METHOD_MIN_MAX, false, lanes, 4, hardware);
+    CHECK(hardware.samples == 0 && hardware.waves == 0 && hardware.texelsFetched == 0);
+}
@@ -0,0 +1,92 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+
+#include <donut/core/math/math.h>
+
+#include <cmath>
+
+using namespace donut::math;
+
+#include "../stf_sigma_lod.h"
+
+static bool IsNear(float a, float b, float tolerance = 1e-5f)
+{
+    return std::abs(a - b) <= tolerance;
+}
+
+UNIT_TEST(StfSigmaLod, Enabled)
+{
+    CHECK(IsStfSigmaLodEnabled(STF_FILTER_TYPE_GAUSSIAN, 2.f, 1.f));
+    CHECK(!IsStfSigmaLodEnabled(STF_FILTER_TYPE_GAUSSIAN, 1.f, 1.f));
+    CHECK(!IsStfSigmaLodEnabled(STF_FILTER_TYPE_GAUSSIAN, 2.f, 0.f));
+    CHECK(!IsStfSigmaLodEnabled(STF_FILTER_TYPE_LINEAR, 2.f, 1.f));
+}
+
+UNIT_TEST(StfSigmaLod, BiasReachesTarget)
+{
+    // Sigmas up to the target stay on the mip of the footprint
+    CHECK(GetStfSigmaLodBias(0.5f, 1.f) == 0.f);
+    CHECK(GetStfSigmaLodBias(1.f, 1.f) == 0.f);
+
+    // Four times the variance of the target including the texel box is one level up
+    const float targetSigma = 0.7f;
+    const float variance = 4.f * (targetSigma * targetSigma + STF_SIGMA_LOD_TEXEL_VARIANCE);
+    const float sigma = std::sqrt(variance - STF_SIGMA_LOD_TEXEL_VARIANCE);
+    CHECK(IsNear(GetStfSigmaLodBias(sigma, targetSigma), 1.f));
+
+    // On the mip the bias moves to, the kernel has the target sigma
+    for (float wide : { 1.5f, 3.f, 8.f, 40.f })
+    {
+        const float bias = GetStfSigmaLodBias(wide, targetSigma);
+        CHECK(bias > 0.f);
+        CHECK(IsNear(GetStfSigmaLodMipSigma(wide, bias), targetSigma, 1e-4f));
+    }
+}
+
+UNIT_TEST(StfSigmaLod, MipSigmaKeepsVariance)
+{
+    // The kernel in texels of mip 0 is the same on every mip: sigma^2 + 1/12 scales with the squared texel size
+    const float sigma = 6.f;
+    for (float mipOffset : { 0.f, 0.5f, 1.f, 2.f })
+    {
+        const float mipSigma = GetStfSigmaLodMipSigma(sigma, mipOffset);
+        const float texelSize = std::exp2(mipOffset);
+        const float variance = (mipSigma * mipSigma + STF_SIGMA_LOD_TEXEL_VARIANCE) * texelSize * texelSize;
+        CHECK(IsNear(variance, sigma * sigma + STF_SIGMA_LOD_TEXEL_VARIANCE, 1e-3f));
+    }
+    CHECK(GetStfSigmaLodMipSigma(sigma, 0.f) == sigma);
+
+    // Mips whose texel box alone is wider than the kernel sample it with sigma 0
+    CHECK(GetStfSigmaLodMipSigma(0.5f, 4.f) == 0.f);
+}
+
+UNIT_TEST(StfSigmaLod, MipSelection)
+{
+    const float sigma = 3.f;
+    const float targetSigma = 1.f;
+    const float lod = 1.25f + GetStfSigmaLodBias(sigma, targetSigma);
+    const float lower = std::floor(lod);
+
+    // The two mips around the biased level of detail, the upper one with the probability of the fractional part
+    constexpr uint32_t sampleCount = 1000;
+    float meanMip = 0.f;
+    for (uint32_t i = 0; i < sampleCount; i++)
+    {
+        const float mip = SelectStfSigmaLodMip(1.25f, sigma, targetSigma, 10.f, (float(i) + 0.5f) / sampleCount);
+        CHECK(mip == lower || mip == lower + 1.f);
+        meanMip += mip / sampleCount;
+    }
+    CHECK(IsNear(meanMip, lod, 1e-3f));
+
+    // The last mip when the level of detail moves beyond it
+    CHECK(SelectStfSigmaLodMip(3.5f, 40.f, targetSigma, 5.f, 0.f) == 4.f);
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+
+#include <donut/core/math/math.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+using namespace donut::math;
+
+#include "../stf_temporal_strata.h"
+
+static float NextRandom(uint32_t& seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return float(seed >> 8) / float(1u << 24);
+}
+
+// Bit i set when one of the values is in [i / strata, (i + 1) / strata)
+static uint32_t GetOccupiedStrata(const float* values, uint32_t count, uint32_t strata)
+{
+    uint32_t occupied = 0;
+    for (uint32_t i = 0; i < count; i++)
+        occupied |= 1u << std::min(uint32_t(values[i] * float(strata)), strata - 1);
+    return occupied;
+}
+
+UNIT_TEST(StfTemporalStrata, Frames)
+{
+    // One noise frame per cycle, none with a single stratum
+    CHECK(GetStfTemporalStrataFrame(13, 1) == 13);
+    CHECK(GetStfTemporalStrataFrame(13, 4) == 12 && GetStfTemporalStrataFrame(15, 4) == 12 && GetStfTemporalStrataFrame(16, 4) == 16);
+    CHECK(GetStfTemporalStrataFrame(0, 16) == 0 && GetStfTemporalStrataFrame(47, 16) == 32);
+
+    const float3 u = float3(0.3f, 0.6f, 0.9f);
+    CHECK(all(StratifyStfRandom(u, 7, 1, 1) == u));
+    CHECK(all(StratifyStfRandom(u, 8, 4, 1) == u));
+}
+
+UNIT_TEST(StfTemporalStrata, Generators)
+{
+    // Coprime with the strata, so the lattice is a permutation in every dimension, and the Fibonacci-like
+    // lattices where they exist
+    for (uint32_t strata = 2; strata <= STF_TEMPORAL_STRATA_MAX; strata++)
+        CHECK(std::gcd(GetStfTemporalStrataGenerator(strata), strata) == 1);
+
+    CHECK(GetStfTemporalStrataGenerator(2) == 1);
+    CHECK(GetStfTemporalStrataGenerator(5) == 2);
+    CHECK(GetStfTemporalStrataGenerator(8) == 3);
+    CHECK(GetStfTemporalStrataGenerator(13) == 5);
+}
+
+UNIT_TEST(StfTemporalStrata, Stratification)
+{
+    // Over a cycle, every random number of a pixel visits each of the N intervals once, whatever the noise of the pixel
+    uint32_t seed = 17;
+    for (uint32_t strata = 2; strata <= STF_TEMPORAL_STRATA_MAX; strata++)
+    {
+        const uint32_t generator = GetStfTemporalStrataGenerator(strata);
+        bool stratified = true;
+        bool inRange = true;
+        for (uint32_t pixel = 0; pixel < 32; pixel++)
+        {
+            const float3 u = float3(NextRandom(seed), NextRandom(seed), NextRandom(seed));
+            const uint32_t cycleStart = strata * (pixel + 3);
+
+            float values[3][STF_TEMPORAL_STRATA_MAX];
+            for (uint32_t frame = 0; frame < strata; frame++)
+            {
+                const float3 shifted = StratifyStfRandom(u, cycleStart + frame, strata, generator);
+                inRange = inRange && shifted.x >= 0.f && shifted.y >= 0.f && shifted.z >= 0.f &&
+                    shifted.x < 1.f && shifted.y < 1.f && shifted.z < 1.f;
+                values[0][frame] = shifted.x;
+                values[1][frame] = shifted.y;
+                values[2][frame] = shifted.z;
+            }
+
+            // Relative to the noise of the pixel, one value per interval means the N values are N distinct shifts
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                float shifts[STF_TEMPORAL_STRATA_MAX];
+                for (uint32_t frame = 0; frame < strata; frame++)
+                {
+                    const float shift = values[axis][frame] - u[axis] + 1.f + 0.5f / float(strata);
+                    shifts[frame] = shift - float(uint32_t(shift));
+                }
+                stratified = stratified && GetOccupiedStrata(shifts, strata, strata) == (1u << strata) - 1;
+            }
+        }
+        CHECK(stratified);
+        CHECK(inRange);
+    }
+
+    // The first frame of a cycle keeps the noise, so strata do not change the first frame's spatial pattern
+    const float3 u = float3(0.1f, 0.2f, 0.3f);
+    CHECK(all(StratifyStfRandom(u, 32, 8, GetStfTemporalStrataGenerator(8)) == u));
+}
@@ -0,0 +1,304 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../SweepConfig.h"
+#include "../UserInterface.h"
+
+#include <json/json.h>
+
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+
+static bool ParseSweepText(const std::string& text, SweepSpec& spec, std::string& error)
+{
+    Json::CharReaderBuilder builder;
+    Json::Value root;
+    std::istringstream stream(text);
+    if (!Json::parseFromStream(builder, stream, &root, &error))
+        return false;
+
+    return ParseSweepSpec(root, spec, error);
+}
+
+static bool IsCartesianOrder(const std::vector<SweepConfiguration>& configs)
+{
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+        if (configs[i].index != i || (i > 0 && !(configs[i - 1].valueIndices < configs[i].valueIndices)))
+            return false;
+    }
+    return true;
+}
+
+UNIT_TEST(SweepConfig, Parse)
+{
+    SweepSpec spec;
+    std::string error;
+    REQUIRE(ParseSweepText(R"({
+        "name": "test", "output": "out.json", "warmupFrames": 2, "frames": 3,
+        "base": { "samplerType": "STF", "stfLoad": true },
+        "axes": { "filterMode": [ "Linear", "Gaussian" ], "sigma": [ 0.7, 2 ], "groupSize": [ 0, "16x16" ] },
+        "camera": { "keyframes": [ { "position": [ 0, 1, 0 ], "target": [ 1, 1, 0 ] }, { "position": [ 2, 1, 0 ], "target": [ 3, 1, 0 ] } ] }
+    })", spec, error));
+
+    CHECK(spec.name == "test");
+    CHECK(spec.output == "out.json");
+    CHECK(spec.mode == SweepMode::Cartesian);
+    CHECK(spec.warmupFrames == 2 && spec.measureFrames == 3);
+    CHECK(spec.base.size() == 2);
+    REQUIRE(spec.axes.size() == 3);
+    CHECK(GetSweepConfigurationCount(spec) == 8);
+    CHECK(spec.camera.keyframes.size() == 2);
+    CHECK(spec.camera.Evaluate(0.5f).position.x == 1.f);
+
+    // Enum values by name or index get the canonical label
+    const int groupSize = FindSweepField("groupSize");
+    for (const SweepAxis& axis : spec.axes)
+    {
+        if (axis.field == groupSize)
+            CHECK(axis.values[0].label == "8x8" && axis.values[1].label == "16x16");
+    }
+}
+
+UNIT_TEST(SweepConfig, Validate)
+{
+    const char* const invalidSpecs[] = {
+        R"([])",
+        R"({ "mode": "grid" })",
+        R"({ "mode": "random" })",
+        R"({ "mode": "random", "samples": 0 })",
+        R"({ "mode": "random", "samples": 1000000 })",
+        R"({ "frames": 0 })",
+        R"({ "axes": { "unknownField": [ 1, 2 ] } })",
+        R"({ "axes": { "filterMode": [ "Linear", "Linear" ] } })",
+        R"({ "axes": { "filterMode": [ "Box" ] } })",
+        R"({ "axes": { "filterMode": [] } })",
+        R"({ "axes": { "sigma": [ -1 ] } })",
+        R"({ "axes": { "stfLoad": [ "yes" ] } })",
+        R"({ "base": { "sigma": [ 1, 2 ] } })",
+        R"({ "base": { "sigma": 1 }, "axes": { "sigma": [ 2, 3 ] } })",
+        R"({ "camera": { "keyframes": [ { "position": [ 0, 1 ] } ] } })",
+        R"({ "reference": [ "HW" ] })",
+        R"({ "reference": {} })",
+        R"({ "reference": { "sigma": [ 1, 2 ] } })",
+        R"({ "frames": 2, "qualityFrames": 3 })",
+        R"({ "qualityFrames": 0 })",
+        // 4 * 13 * 6 * 4 * 3 * 3 * 3 * 64 * 16 configurations
+        R"({ "axes": { "groupSize": [ 0, 1, 2, 3 ], "magMethod": [ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 ],
+            "minMethod": [ 0, 1, 2, 3, 4, 5 ], "filterKernel": [ 0, 1, 2, 3 ], "addressMode": [ 0, 1, 2 ],
+            "pipelineType": [ 0, 1, 2 ], "samplerType": [ 0, 1, 2 ],
+            "swizzleSize": [ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32,
+                33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64 ],
+            "temporalStrata": [ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 ] } })",
+    };
+
+    for (const char* text : invalidSpecs)
+    {
+        SweepSpec spec;
+        std::string error;
+        const bool parsed = ParseSweepText(text, spec, error);
+        CHECK(!parsed);
+        CHECK(!error.empty());
+        if (parsed)
+            fprintf(stderr, "Accepted invalid spec %s\n", text);
+    }
+}
+
+UNIT_TEST(SweepConfig, EnumerateCartesian)
+{
+    SweepSpec spec;
+    std::string error;
+    REQUIRE(ParseSweepText(R"({
+        "base": { "samplerType": "STF" },
+        "axes": { "filterMode": [ "Linear", "Gaussian" ], "sigma": [ 0.7, 2 ], "reseedOnSample": [ false, true ] }
+    })", spec, error));
+
+    // Sigma only matters for the Gaussian: 2 linear and 4 Gaussian configurations
+    const std::vector<SweepConfiguration> configs = EnumerateSweep(spec);
+    CHECK(configs.size() == 6);
+    CHECK(IsCartesianOrder(configs));
+
+    // With the hardware sampler none of the STF settings matter
+    REQUIRE(ParseSweepText(R"({
+        "base": { "samplerType": "HW" },
+        "axes": { "filterMode": [ "Linear", "Gaussian" ], "sigma": [ 0.7, 2 ] }
+    })", spec, error));
+    CHECK(EnumerateSweep(spec).size() == 1);
+
+    REQUIRE(ParseSweepText(R"({ "axes": {} })", spec, error));
+    CHECK(EnumerateSweep(spec).size() == 1);
+}
+
+UNIT_TEST(SweepConfig, EnumerateRandom)
+{
+    SweepSpec spec;
+    std::string error;
+    REQUIRE(ParseSweepText(R"({
+        "mode": "random", "samples": 4, "seed": 7,
+        "base": { "samplerType": "STF" },
+        "axes": { "filterMode": [ "Linear", "Gaussian" ], "sigma": [ 0.7, 2 ], "reseedOnSample": [ false, true ] }
+    })", spec, error));
+
+    // Samples from the distinct configurations, reproducibly
+    const std::vector<SweepConfiguration> configs = EnumerateSweep(spec);
+    CHECK(configs.size() == 4);
+    CHECK(IsCartesianOrder(configs));
+
+    const std::vector<SweepConfiguration> again = EnumerateSweep(spec);
+    REQUIRE(again.size() == configs.size());
+    for (size_t i = 0; i < configs.size(); i++)
+        CHECK(again[i].valueIndices == configs[i].valueIndices);
+
+    // More samples than distinct configurations returns all of them
+    spec.sampleCount = 100;
+    CHECK(EnumerateSweep(spec).size() == 6);
+}
+
+UNIT_TEST(SweepConfig, EnumerateRandomLargeSpace)
+{
+    // Far more configurations than can be listed, most of them distinct on the compute pipeline
+    SweepSpec spec;
+    std::string error;
+    REQUIRE(ParseSweepText(R"({
+        "mode": "random", "samples": 500, "seed": 1,
+        "base": { "samplerType": "STF", "stfLoad": true, "pipelineType": "Compute", "groupSwizzle": "Morton" },
+        "axes": {
+            "groupSize": [ 0, 1, 2, 3 ],
+            "magMethod": [ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 ],
+            "addressMode": [ 0, 1, 2 ],
+            "reseedOnSample": [ false, true ],
+            "useWhiteNoise": [ false, true ],
+            "swizzleSize": [ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32,
+                33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64 ],
+            "temporalStrata": [ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 ]
+        }
+    })", spec, error));
+    REQUIRE(GetSweepConfigurationCount(spec) > MaxSweepConfigurations);
+
+    const std::vector<SweepConfiguration> configs = EnumerateSweep(spec);
+    CHECK(configs.size() == 500);
+    CHECK(IsCartesianOrder(configs));
+
+    // Every value of every axis shows up, the first axes included
+    for (size_t axis = 0; axis < spec.axes.size(); axis++)
+    {
+        std::set<uint32_t> values;
+        for (const SweepConfiguration& config : configs)
+            values.insert(config.valueIndices[axis]);
+        CHECK(values.size() == spec.axes[axis].values.size());
+    }
+
+    // A large product with few distinct configurations: with the hardware sampler only the pipeline matters
+    REQUIRE(ParseSweepText(R"({
+        "mode": "random", "samples": 50, "seed": 3,
+        "base": { "samplerType": "HW" },
+        "axes": {
+            "pipelineType": [ "RayGen", "Raster" ],
+            "magMethod": [ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 ],
+            "addressMode": [ 0, 1, 2 ],
+            "swizzleSize": [ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32,
+                33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64 ],
+            "temporalStrata": [ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 ],
+            "maxTaps": [ 1, 2, 3, 4 ]
+        }
+    })", spec, error));
+    REQUIRE(GetSweepConfigurationCount(spec) > MaxSweepConfigurations);
+    CHECK(EnumerateSweep(spec).size() == 2);
+}
+
+UNIT_TEST(SweepConfig, QualityFrames)
+{
+    SweepSpec spec;
+    std::string error;
+    REQUIRE(ParseSweepText(R"({
+        "warmupFrames": 2, "frames": 12, "qualityFrames": 3,
+        "base": { "samplerType": "STF" },
+        "reference": { "samplerType": "HW" },
+        "axes": { "filterMode": [ "Linear", "Gaussian" ] }
+    })", spec, error));
+    REQUIRE(spec.reference.size() == 1);
+
+    // The last frame of each third of the measured frames
+    std::vector<uint32_t> frames;
+    for (uint32_t frame = 0; frame < 20; frame++)
+    {
+        if (IsSweepQualityFrame(spec, frame))
+            frames.push_back(frame);
+    }
+    CHECK((frames == std::vector<uint32_t>{ 5, 9, 13 }));
+
+    // The reference overrides the base, the configurations keep it
+    UIData ui;
+    ApplySweepReference(spec, ui);
+    CHECK(ui.samplerType == SamplerType::HW);
+    ui.stfPipelineUpdate = false;
+    ApplySweepConfiguration(spec, EnumerateSweep(spec)[0], ui);
+    CHECK(ui.samplerType == SamplerType::STF);
+    CHECK(ui.stfPipelineUpdate);
+
+    // Without a reference there is nothing to compare
+    spec.reference.clear();
+    for (uint32_t frame = 0; frame < 20; frame++)
+        CHECK(!IsSweepQualityFrame(spec, frame));
+}
+
+static std::vector<std::string> ReadLines(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);)
+        lines.push_back(line);
+    return lines;
+}
+
+UNIT_TEST(SweepConfig, ReportQuality)
+{
+    SweepSpec spec;
+    std::string error;
+    REQUIRE(ParseSweepText(R"({
+        "reference": { "samplerType": "HW" },
+        "axes": { "filterMode": [ "Linear", "Gaussian" ] }
+    })", spec, error));
+
+    std::vector<SweepResult> results(2);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        results[i].config = EnumerateSweep(spec)[i];
+        results[i].frames.gpuMilliseconds = { 2.f, 4.f };
+        results[i].frames.cpuMilliseconds = { 1.f, 1.f };
+    }
+    results[0].frames.psnr = { 30.f, 40.f };
+    results[0].frames.ssim = { 0.5f, 1.f };
+    results[0].frames.flip = { 0.25f, 0.5f };
+
+    // The means of the quality frames follow the times, empty for the configuration that was not compared
+    const std::filesystem::path csvName = GetUnitTestDirectory("SweepReportQuality") / "report.csv";
+    REQUIRE(WriteSweepReport(csvName, spec, results, error));
+    const std::vector<std::string> lines = ReadLines(csvName);
+    REQUIRE(lines.size() == 3);
+    CHECK(lines[0] == "index,filterMode,frames,gpu_mean_ms,gpu_median_ms,gpu_p95_ms,gpu_min_ms,gpu_max_ms,cpu_mean_ms,cpu_median_ms,"
+        "quality_frames,psnr_db,ssim,flip");
+    CHECK(lines[1] == "0,Linear,2,3,4,4,2,4,1,1,2,35,0.75,0.375");
+    CHECK(lines[2] == "1,Gaussian,2,3,4,4,2,4,1,1,0,,,");
+
+    const std::filesystem::path jsonName = csvName.parent_path() / "report.json";
+    REQUIRE(WriteSweepReport(jsonName, spec, results, error));
+    Json::CharReaderBuilder builder;
+    Json::Value root;
+    std::ifstream file(jsonName);
+    REQUIRE(Json::parseFromStream(builder, file, &root, &error));
+    CHECK(root["reference"]["samplerType"].asString() == "HW");
+    CHECK(root["results"][0]["quality"]["frames"].asUInt() == 2);
+    CHECK(root["results"][0]["quality"]["flip"].asDouble() == 0.375);
+    CHECK(!root["results"][1].isMember("quality"));
+}
@@ -0,0 +1,119 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../TaskGraph.h"
+#include "../TextureProcessing.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+UNIT_TEST(TaskGraph, ParallelFor)
+{
+    ThreadPool pool(4);
+    CHECK(pool.GetThreadCount() == 4);
+
+    // Every index exactly once, also with fewer indices than threads and none at all
+    for (uint32_t count : { 0u, 1u, 3u, 10000u })
+    {
+        std::vector<std::atomic<uint32_t>> visits(count);
+        pool.ParallelFor(count, [&](uint32_t i) { visits[i]++; });
+
+        bool once = true;
+        for (const std::atomic<uint32_t>& visit : visits)
+            once = once && visit == 1;
+        CHECK(once);
+    }
+}
+
+UNIT_TEST(TaskGraph, Dependencies)
+{
+    ThreadPool pool(4);
+    TaskGraph graph(pool);
+
+    // A diamond: two decodes after the parse, the upload after both
+    std::mutex mutex;
+    std::vector<int> order;
+    auto record = [&](int step) { return [&, step]() { std::lock_guard<std::mutex> lock(mutex); order.push_back(step); }; };
+
+    const TaskGraph::TaskId parse = graph.AddTask("parse", record(0));
+    const TaskGraph::TaskId decodeA = graph.AddTask("decode a", record(1), { parse }, 2.0);
+    const TaskGraph::TaskId decodeB = graph.AddTask("decode b", record(1), { parse }, 2.0);
+    graph.AddTask("upload", record(2), { decodeA, decodeB });
+    graph.Wait();
+
+    REQUIRE(order.size() == 4);
+    CHECK(order[0] == 0 && order[1] == 1 && order[2] == 1 && order[3] == 2);
+    CHECK(graph.GetTaskCount() == 4 && graph.GetFinishedTaskCount() == 4);
+    CHECK(graph.GetProgress() == 1.f);
+
+    // Dependencies that have finished already do not hold a new task back
+    std::atomic<bool> ran { false };
+    graph.AddTask("late", [&]() { ran = true; }, { parse });
+    graph.Wait();
+    CHECK(ran);
+}
+
+UNIT_TEST(TaskGraph, DynamicTasks)
+{
+    ThreadPool pool(4);
+    TaskGraph graph(pool);
+
+    // A parse task adding one decode task per image it finds, Wait() covers them too
+    const uint32_t imageCount = 64;
+    std::atomic<uint32_t> decoded { 0 };
+    graph.AddTask("parse", [&]()
+    {
+        for (uint32_t image = 0; image < imageCount; image++)
+            graph.AddTask("decode", [&]() { decoded++; }, {}, 3.0);
+    });
+    graph.Wait();
+
+    CHECK(decoded == imageCount);
+    CHECK(graph.GetTaskCount() == imageCount + 1);
+    CHECK(graph.GetFinishedTaskCount() == imageCount + 1);
+    CHECK(graph.GetProgress() == 1.f);
+}
+
+UNIT_TEST(TaskGraph, MipChain)
+{
+    // 5x3 with a linear ramp: levels of 2x1 and 1x1, the last column and row clamped
+    CpuImage base;
+    base.width = 5;
+    base.height = 3;
+    for (uint32_t y = 0; y < base.height; y++)
+        for (uint32_t x = 0; x < base.width; x++)
+            base.rgba.insert(base.rgba.end(), { uint8_t(x * 40), uint8_t(y * 40), 0, 255 });
+
+    std::vector<CpuImage> mips;
+    GenerateMipChain(base, mips);
+    REQUIRE(mips.size() == 2);
+    CHECK(mips[0].width == 2 && mips[0].height == 1);
+    CHECK(mips[1].width == 1 && mips[1].height == 1);
+
+    // Texel (1, 0) averages columns 2 and 3, rows 0 and 1, rounded to nearest
+    CHECK(mips[0].rgba[4] == 100 && mips[0].rgba[5] == 20 && mips[0].rgba[7] == 255);
+    CHECK(mips[1].rgba[0] == 60 && mips[1].rgba[1] == 20);
+
+    // sRGB images average in linear space: black and white give 50% linear, not 50% encoded
+    CpuImage checker;
+    checker.width = 2;
+    checker.height = 2;
+    checker.sRGB = true;
+    checker.rgba = { 0, 0, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255, 0, 0, 0, 0 };
+    GenerateMipChain(checker, mips);
+    REQUIRE(mips.size() == 1);
+    CHECK(mips[0].rgba[0] == 188 && mips[0].rgba[3] == 128);
+    CHECK(std::abs(Srgb8ToLinear(mips[0].rgba[0]) - 0.5f) < 0.01f);
+    CHECK(Srgb8ToLinear(0) == 0.f && Srgb8ToLinear(255) == 1.f);
+}
@@ -0,0 +1,144 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../TexelShadingCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace donut::math;
+
+// A value per key, to tell entries apart and see torn ones
+static CpuScene::DecodedMaterial GetDecoded(uint64_t key)
+{
+    CpuScene::DecodedMaterial decoded;
+    decoded.diffuseAlbedo = float3(float(key & 0xfff), float((key >> 12) & 0xfff), float((key >> 24) & 0xfff));
+    decoded.specularF0 = decoded.diffuseAlbedo + 1.f;
+    decoded.emissiveColor = decoded.diffuseAlbedo + 2.f;
+    decoded.localNormal = decoded.diffuseAlbedo + 3.f;
+    decoded.roughness = float(key >> 44);
+    decoded.opacity = float(key >> 48);
+    return decoded;
+}
+
+static bool Matches(const CpuScene::DecodedMaterial& a, const CpuScene::DecodedMaterial& b)
+{
+    return all(a.diffuseAlbedo == b.diffuseAlbedo) && all(a.specularF0 == b.specularF0) && all(a.emissiveColor == b.emissiveColor) &&
+        all(a.localNormal == b.localNormal) && a.roughness == b.roughness && a.opacity == b.opacity;
+}
+
+UNIT_TEST(TexelShadingCache, MakeKey)
+{
+    std::set<uint64_t> keys;
+    for (uint32_t material : { 0u, 1u, 1000u })
+        for (uint32_t mip : { 0u, 1u, 15u })
+            for (int2 texel : { int2(0, 0), int2(1, 0), int2(0, 1), int2(4000000, 3) })
+                keys.insert(TexelShadingCache::MakeKey(material, mip, texel));
+
+    CHECK(keys.size() == 3 * 3 * 4);
+    CHECK(keys.count(0) == 0);
+}
+
+UNIT_TEST(TexelShadingCache, Collisions)
+{
+    // 16 slots: every key collides with others, and the probes reach the whole table
+    TexelShadingCache cache(5);
+    REQUIRE(cache.GetCapacity() == 16);
+
+    std::vector<uint64_t> keys;
+    for (int i = 0; i < 17; i++)
+        keys.push_back(TexelShadingCache::MakeKey(3, 0, int2(i * 7, i)));
+
+    for (int i = 0; i < 16; i++)
+        CHECK(cache.Insert(keys[i], GetDecoded(keys[i]), 2));
+    CHECK(cache.GetSize() == 16);
+
+    // Full, and present keys are not inserted twice
+    CHECK(!cache.Insert(keys[16], GetDecoded(keys[16]), 2));
+    CHECK(!cache.Insert(keys[0], GetDecoded(keys[1]), 3));
+    CHECK(cache.GetSize() == 16);
+
+    CpuScene::DecodedMaterial decoded;
+    uint32_t frame = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        CHECK(cache.Find(keys[i], decoded, frame));
+        CHECK(Matches(decoded, GetDecoded(keys[i])) && frame == 2);
+    }
+    CHECK(!cache.Find(keys[16], decoded, frame));
+
+    cache.Clear();
+    CHECK(cache.GetSize() == 0);
+    CHECK(!cache.Find(keys[0], decoded, frame));
+    CHECK(cache.Insert(keys[16], GetDecoded(keys[16]), 4));
+    CHECK(cache.Find(keys[16], decoded, frame) && frame == 4);
+}
+
+UNIT_TEST(TexelShadingCache, ConcurrentInsertFind)
+{
+    const uint32_t keyCount = 20000;
+    const uint32_t threadCount = 8;
+
+    // Room for all keys at a load that keeps the probes short
+    TexelShadingCache cache(2 * keyCount);
+
+    std::vector<uint64_t> keys;
+    for (uint32_t i = 0; i < keyCount; i++)
+        keys.push_back(TexelShadingCache::MakeKey(i % 7, i % 3, int2(int(i), int(i / 5))));
+
+    // Every thread inserts and looks up all keys in its own order, like pixels of one frame picking the same texels
+    std::atomic<uint32_t> inserted { 0 };
+    std::atomic<uint32_t> found { 0 };
+    std::atomic<uint32_t> wrong { 0 };
+    std::vector<std::thread> threads;
+    for (uint32_t thread = 0; thread < threadCount; thread++)
+    {
+        threads.emplace_back([&, thread]()
+        {
+            std::vector<uint64_t> order = keys;
+            std::shuffle(order.begin(), order.end(), std::mt19937(thread));
+
+            CpuScene::DecodedMaterial decoded;
+            uint32_t frame = 0;
+            for (uint64_t key : order)
+            {
+                if (cache.Find(key, decoded, frame))
+                {
+                    found++;
+                    if (!Matches(decoded, GetDecoded(key)) || frame >= threadCount)
+                        wrong++;
+                }
+                else if (cache.Insert(key, GetDecoded(key), thread))
+                    inserted++;
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    // Each key is inserted by exactly one thread, no lookup saw another key's entry or one half written
+    CHECK(inserted == keyCount);
+    CHECK(cache.GetSize() == keyCount);
+    CHECK(wrong == 0);
+    CHECK(found > 0);
+
+    CpuScene::DecodedMaterial decoded;
+    uint32_t frame = 0;
+    uint32_t complete = 0;
+    for (uint64_t key : keys)
+        complete += cache.Find(key, decoded, frame) && Matches(decoded, GetDecoded(key)) ? 1 : 0;
+    CHECK(complete == keyCount);
+}
@@ -0,0 +1,117 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+#include "../TextureCacheSimulator.h"
+
+#include <cstdint>
+
+// 4 byte texels, 32 per 128 byte line
+static const uint32_t TexelsPerLine = 32;
+
+UNIT_TEST(TextureCacheSimulator, LruReplacement)
+{
+    // 2 sets of 2 ways of 64 byte lines, even lines map to set 0
+    SetAssociativeCache cache({ 256, 64, 2 });
+
+    CHECK(!cache.Access(0));
+    CHECK(!cache.Access(128));
+    CHECK(cache.Access(63));        // same line as 0
+    CHECK(!cache.Access(64));       // set 1 leaves set 0 alone
+    CHECK(cache.Access(128));
+
+    // Line 4 evicts the least recently used line of set 0, line 0
+    CHECK(!cache.Access(256));
+    CHECK(cache.Access(128));
+    CHECK(!cache.Access(0));
+    CHECK(!cache.Access(256));      // evicted by line 0, line 2 was used after it
+    CHECK(cache.Access(64));
+}
+
+UNIT_TEST(TextureCacheSimulator, CoalescedRequests)
+{
+    TexelTrace trace;
+
+    // A wave reading 32 texels of one line, twice, and then texels of 4 lines
+    for (uint32_t repeat = 0; repeat < 2; repeat++)
+    {
+        trace.BeginRequest(0);
+        for (uint32_t texel = 0; texel < TexelsPerLine; texel++)
+            trace.Add(texel);
+    }
+    trace.BeginRequest(0);
+    for (uint32_t texel = 0; texel < 4 * TexelsPerLine; texel += 8)
+        trace.Add(texel);
+
+    const TextureCacheResult result = SimulateTextureCache(trace, TextureCacheConfig());
+    CHECK(result.requests == 3);
+    CHECK(result.fetches == 2 * TexelsPerLine + 16);
+
+    // One lookup per distinct line of a request: line 0 misses once and hits twice, lines 1 to 3 miss
+    CHECK(result.l1Accesses == 6);
+    CHECK(result.l1Hits == 2);
+    CHECK(result.l2Accesses == 4 && result.l2Hits == 0);
+    CHECK(result.dramBytes == 4 * 128);
+    CHECK(result.GetL1HitRate() == 2.0 / 6.0);
+}
+
+UNIT_TEST(TextureCacheSimulator, Streaming)
+{
+    // Every line read once: nothing hits and every line comes from DRAM
+    TexelTrace trace;
+    const uint32_t lineCount = 4096;
+    for (uint32_t line = 0; line < lineCount; line++)
+    {
+        trace.BeginRequest(line);
+        trace.Add(line * TexelsPerLine + line % TexelsPerLine);
+    }
+
+    const TextureCacheResult result = SimulateTextureCache(trace, TextureCacheConfig());
+    CHECK(result.l1Accesses == lineCount && result.l1Hits == 0);
+    CHECK(result.l2Accesses == lineCount && result.l2Hits == 0);
+    CHECK(result.dramBytes == uint64_t(lineCount) * 128);
+    CHECK(result.GetL2HitRate() == 0.0);
+}
+
+UNIT_TEST(TextureCacheSimulator, SharedL2)
+{
+    TextureCacheConfig config;
+    config.l1Count = 2;
+
+    // Groups 0 and 2 run on the first SM, group 1 on the second: it misses its L1 and hits the L2
+    TexelTrace trace;
+    for (uint32_t group : { 0u, 1u, 2u })
+    {
+        trace.BeginRequest(group);
+        trace.Add(5);
+    }
+
+    TextureCacheResult result = SimulateTextureCache(trace, config);
+    CHECK(result.l1Accesses == 3 && result.l1Hits == 1);
+    CHECK(result.l2Accesses == 2 && result.l2Hits == 1);
+    CHECK(result.dramBytes == 128);
+
+    // A working set larger than the L1 but inside the L2: the second pass misses the L1 and hits the L2
+    trace.Clear();
+    const uint32_t lineCount = 2 * config.l1.sizeBytes / config.l1.lineBytes;
+    for (uint32_t pass = 0; pass < 2; pass++)
+    {
+        for (uint32_t line = 0; line < lineCount; line++)
+        {
+            trace.BeginRequest(0);
+            trace.Add(line * TexelsPerLine);
+        }
+    }
+
+    result = SimulateTextureCache(trace, config);
+    CHECK(result.l1Hits == 0);
+    CHECK(result.l2Accesses == 2 * lineCount && result.l2Hits == lineCount);
+    CHECK(result.dramBytes == uint64_t(lineCount) * 128);
+}
@@ -0,0 +1,50 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+// Minimal test registry for the device-free parts of the sample. Each suite is one CTest test, run as
+// "stf_bindless_rendering_tests <suite>"; without arguments every suite runs.
+struct UnitTestCase
+{
+    const char* suite;
+    const char* name;
+    void (*function)();
+};
+
+std::vector<UnitTestCase>& GetUnitTestCases();
+void ReportUnitTestFailure(const char* file, int line, const char* expression);
+
+// An empty directory under the system temp directory, for tests that write files
+std::filesystem::path GetUnitTestDirectory(const char* name);
+
+struct UnitTestRegistration
+{
+    UnitTestRegistration(const char* suite, const char* name, void (*function)())
+    {
+        GetUnitTestCases().push_back({ suite, name, function });
+    }
+};
+
+#define UNIT_TEST(suite, name) \
+    static void suite##_##name(); \
+    static UnitTestRegistration s_##suite##_##name##_Registration(#suite, #name, suite##_##name); \
+    static void suite##_##name()
+
+// Reports the failure and continues the test
+#define CHECK(expression) \
+    do { if (!(expression)) ReportUnitTestFailure(__FILE__, __LINE__, #expression); } while (false)
+
+// Reports the failure and returns from the test, for checks the rest of the test depends on
+#define REQUIRE(expression) \
+    do { if (!(expression)) { ReportUnitTestFailure(__FILE__, __LINE__, #expression); return; } } while (false)
@@ -0,0 +1,69 @@
+/***************************************************************************
+ # Copyright (c) 2025, NVIDIA CORPORATION.  All rights reserved.
+ #
+ # NVIDIA CORPORATION and its licensors retain all intellectual property
+ # and proprietary rights in and to this software, related documentation
+ # and any modifications thereto.  Any use, reproduction, disclosure or
+ # distribution of this software and related documentation without an express
+ # license agreement from NVIDIA CORPORATION is strictly prohibited.
+ **************************************************************************/
+
+#include "UnitTest.h"
+
+#include <cstdio>
+#include <cstring>
+
+static int g_Failures = 0;
+
+std::vector<UnitTestCase>& GetUnitTestCases()
+{
+    static std::vector<UnitTestCase> cases;
+    return cases;
+}
+
+void ReportUnitTestFailure(const char* file, int line, const char* expression)
+{
+    fprintf(stderr, "%s(%d): CHECK(%s) failed\n", file, line, expression);
+    g_Failures++;
+}
+
+std::filesystem::path GetUnitTestDirectory(const char* name)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "stf_bindless_rendering_tests" / name;
+
+    std::error_code ec;
+    std::filesystem::remove_all(directory, ec);
+    std::filesystem::create_directories(directory, ec);
+    return directory;
+}
+
+int main(int argc, char** argv)
+{
+    const char* suite = argc > 1 ? argv[1] : nullptr;
+
+    int testCount = 0;
+    int failedCount = 0;
+    for (const UnitTestCase& testCase : GetUnitTestCases())
+    {
+        if (suite && strcmp(suite, testCase.suite) != 0)
+            continue;
+
+        const int failures = g_Failures;
+        testCase.function();
+        testCount++;
+
+        const bool passed = g_Failures == failures;
+        if (!passed)
+            failedCount++;
+        printf("[%s] %s.%s\n", passed ? "  OK  " : "FAILED", testCase.suite, testCase.name);
+    }
+
+    if (testCount == 0)
+    {
+        fprintf(stderr, "No tests in suite '%s'\n", suite ? suite : "");
+        return 1;
+    }
+
+    printf("%d of %d tests passed\n", testCount - failedCount, testCount);
+    return failedCount == 0 ? 0 : 1;
+}